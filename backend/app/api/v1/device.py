@@ -118,4 +118,6 @@ async def control_device(
     设备必须在线才能接收控制指令。
     """
     # TODO: 实现设备控制逻辑
+    #   查询设备并确认在线后，用 message_service.encode_control() 按设备当前编码生成
+    #   主题和消息内容，再经 MQTT 客户端发布
     pass
@@ -50,6 +50,8 @@ class Settings(BaseSettings):
     MQTT_USERNAME: Optional[str] = None
     # MQTT 密码
     MQTT_PASSWORD: Optional[str] = None
+    # 是否允许设备使用紧凑二进制编码，关闭后下行一律使用 JSON，便于抓包调试
+    MQTT_BINARY_PAYLOAD_ENABLED: bool = True
     
     # ========== AI 服务配置 ==========
     # 通义千问 API Key，用于调用阿里云 AI 服务
@@ -35,7 +35,8 @@ async def lifespan(app: FastAPI):
     
     # TODO: 初始化数据库连接池
     # TODO: 初始化 Redis 连接
-    # TODO: 初始化 MQTT 客户端
+    # TODO: 初始化 MQTT 客户端（订阅 device/+/status 与 device/+/heartbeat，
+    #       收到的消息交给 services.device.message_service.decode_device_message 解码）
     # TODO: 加载 AI 模型（如果是本地部署）
     
     print(f"✅ {settings.APP_NAME} 启动完成")
@@ -8,4 +8,6 @@
         - 设备状态管理
         - 设备控制指令下发
         - 设备在线状态监控
+        - 设备消息编解码（JSON / 紧凑二进制，见 payload_codec）
+        - 设备 MQTT 消息收发（状态、心跳解码与控制命令编码，见 message_service）
 """
@@ -0,0 +1,117 @@
+# -*- coding: utf-8 -*-
+"""
+设备 MQTT 消息收发
+
+功能说明：
+    MQTT 客户端收到设备消息、下发控制命令时统一经过这里编解码：
+        - 上行：device/{device_id}/status、device/{device_id}/heartbeat，
+          按首字节识别 JSON / 紧凑二进制，同时记录设备使用的编码
+        - 下行：device/{device_id}/control，沿用设备最近一次上报的编码
+
+    编码细节见 payload_codec。
+"""
+
+from dataclasses import dataclass
+from typing import Optional
+
+from app.services.device.payload_codec import PayloadNegotiator
+
+
+# 主题前缀与消息类型
+TOPIC_PREFIX = "device"
+KIND_STATUS = "status"
+KIND_HEARTBEAT = "heartbeat"
+KIND_CONTROL = "control"
+
+# 设备上报的消息类型
+UPLINK_KINDS = (KIND_STATUS, KIND_HEARTBEAT)
+
+# 全局编码协商器，记录每个设备最近一次上报的编码
+negotiator = PayloadNegotiator()
+
+
+@dataclass
+class DeviceMessage:
+    """
+    解码后的设备上行消息
+
+    属性：
+        device_id: 设备 ID
+        kind: 消息类型，status 或 heartbeat
+        data: 消息内容
+    """
+    device_id: str
+    kind: str
+    data: dict
+
+
+def parse_topic(topic: str) -> Optional[tuple[str, str]]:
+    """
+    解析设备主题
+
+    参数：
+        topic: MQTT 主题，如 device/purifier_001/status
+
+    返回：
+        (设备 ID, 消息类型)，不是设备主题时返回 None
+    """
+    parts = topic.split("/")
+    if len(parts) != 3 or parts[0] != TOPIC_PREFIX or not parts[1]:
+        return None
+    return parts[1], parts[2]
+
+
+def control_topic(device_id: str) -> str:
+    """
+    设备控制主题
+
+    参数：
+        device_id: 设备 ID
+
+    返回：
+        device/{device_id}/control
+    """
+    return f"{TOPIC_PREFIX}/{device_id}/{KIND_CONTROL}"
+
+
+def decode_device_message(topic: str, device_type: str, payload: bytes) -> DeviceMessage:
+    """
+    解码设备上行消息（状态或心跳）
+
+    参数：
+        topic: MQTT 主题
+        device_type: 设备类型（由设备 ID 查询得到），二进制编码按该类型的键表解码
+        payload: MQTT 消息内容
+
+    返回：
+        解码后的消息
+
+    异常：
+        ValueError: 不是设备上行主题
+        PayloadDecodeError: 消息无法解码
+    """
+    parsed = parse_topic(topic)
+    if parsed is None or parsed[1] not in UPLINK_KINDS:
+        raise ValueError(f"不是设备上行主题: {topic}")
+    device_id, kind = parsed
+    data = negotiator.observe(device_id, device_type, payload)
+    return DeviceMessage(device_id=device_id, kind=kind, data=data)
+
+
+def encode_control(device_id: str, device_type: str, command: str,
+                   params: Optional[dict] = None) -> tuple[str, bytes]:
+    """
+    编码控制命令
+
+    参数：
+        device_id: 设备 ID
+        device_type: 设备类型
+        command: 控制命令，如 power_on
+        params: 命令参数
+
+    返回：
+        (主题, 消息内容)，消息按设备最近一次上报的编码，未收到过上报时为 JSON
+    """
+    data = {"command": command, "params": params or {}}
+    return control_topic(device_id), negotiator.encode_for(device_id, device_type, data)
+
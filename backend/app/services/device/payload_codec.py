@@ -0,0 +1,190 @@
+# -*- coding: utf-8 -*-
+"""
+设备消息编解码
+
+功能说明：
+    设备 MQTT 消息支持两种编码：
+        - JSON：默认格式，便于调试
+        - 紧凑二进制：[魔数 0xC1][键表版本][MessagePack]
+          MessagePack 中对象的键名按设备类型的键表替换为序号字符串（如 "power" -> "2"），
+          不在键表中的键保留原名，新增字段无需同步升级键表。
+
+    0xC1 在 MessagePack 中保留未用，也不可能是 JSON 的首字符，
+    因此收到消息时根据首字节即可区分编码，两种格式可以混用。
+
+    协商方式：
+        - 只有在 DEVICE_KEY_TABLES 中有键表的设备类型才能使用二进制编码
+        - 设备自行决定上报用哪种编码
+        - 服务器下发控制命令时沿用该设备最近一次上报的编码
+"""
+
+import json
+from typing import Any
+
+import msgpack
+from loguru import logger
+
+from app.core.config import settings
+
+
+# 二进制帧魔数
+BINARY_MAGIC = 0xC1
+# 当前键表版本，键表只允许在末尾追加，删除或调整顺序时必须升级版本
+KEY_TABLE_VERSION = 1
+
+# 各设备类型共用的控制命令键，固定占用序号 0、1
+_COMMON_KEYS = ("command", "params")
+
+# 设备类型 -> 键表，与设备端 common/payload_codec.h 保持一致
+DEVICE_KEY_TABLES: dict[str, tuple[str, ...]] = {
+    "purifier": _COMMON_KEYS + (
+        "power", "mode", "pm25", "filter_hours",
+    ),
+    "fish_feeder": _COMMON_KEYS + (
+        "last_feed_time", "food_level", "feed_count_today", "feed_duration",
+        "schedules", "hour", "minute", "duration",
+    ),
+}
+
+
+class PayloadDecodeError(ValueError):
+    """消息无法解码（格式错误或键表版本不匹配）"""
+
+
+def is_binary(payload: bytes) -> bool:
+    """
+    判断消息是否为二进制编码
+
+    参数：
+        payload: MQTT 消息内容
+
+    返回：
+        首字节为魔数时返回 True
+    """
+    return len(payload) > 0 and payload[0] == BINARY_MAGIC
+
+
+def supports_binary(device_type: str) -> bool:
+    """
+    设备类型是否支持二进制编码
+
+    参数：
+        device_type: 设备类型，如 purifier
+
+    返回：
+        全局开关打开且该类型有键表时返回 True
+    """
+    return settings.MQTT_BINARY_PAYLOAD_ENABLED and device_type in DEVICE_KEY_TABLES
+
+
+def _map_keys(value: Any, mapping: dict[str, str]) -> Any:
+    """
+    递归替换对象的键名，数组逐项处理，其他值原样返回
+    """
+    if isinstance(value, dict):
+        return {mapping.get(k, k): _map_keys(v, mapping) for k, v in value.items()}
+    if isinstance(value, list):
+        return [_map_keys(v, mapping) for v in value]
+    return value
+
+
+def encode_payload(device_type: str, data: dict, binary: bool = False) -> bytes:
+    """
+    编码消息
+
+    参数：
+        device_type: 设备类型
+        data: 消息内容
+        binary: 是否使用二进制编码，设备类型不支持时退回 JSON
+
+    返回：
+        编码后的消息内容
+    """
+    if not binary or not supports_binary(device_type):
+        return json.dumps(data, ensure_ascii=False, separators=(",", ":")).encode("utf-8")
+
+    keys = DEVICE_KEY_TABLES[device_type]
+    mapping = {name: str(i) for i, name in enumerate(keys)}
+    body = msgpack.packb(_map_keys(data, mapping), use_bin_type=True)
+    return bytes((BINARY_MAGIC, KEY_TABLE_VERSION)) + body
+
+
+def decode_payload(device_type: str, payload: bytes) -> dict:
+    """
+    解码消息，根据首字节自动识别编码
+
+    参数：
+        device_type: 设备类型
+        payload: MQTT 消息内容
+
+    返回：
+        消息内容
+
+    异常：
+        PayloadDecodeError: 格式错误、键表版本不匹配或设备类型没有键表
+    """
+    if not is_binary(payload):
+        try:
+            data = json.loads(payload.decode("utf-8"))
+        except ValueError as e:
+            raise PayloadDecodeError(f"JSON 解析失败: {e}") from e
+    else:
+        if len(payload) < 2 or payload[1] != KEY_TABLE_VERSION:
+            raise PayloadDecodeError("键表版本不匹配")
+        keys = DEVICE_KEY_TABLES.get(device_type)
+        if keys is None:
+            raise PayloadDecodeError(f"设备类型 {device_type} 不支持二进制编码")
+        try:
+            data = msgpack.unpackb(payload[2:], raw=False)
+        except (msgpack.UnpackException, ValueError) as e:
+            raise PayloadDecodeError(f"MessagePack 解析失败: {e}") from e
+        data = _map_keys(data, {str(i): name for i, name in enumerate(keys)})
+
+    if not isinstance(data, dict):
+        raise PayloadDecodeError("消息根节点必须是对象")
+    return data
+
+
+class PayloadNegotiator:
+    """
+    记录每个设备最近一次上报使用的编码
+
+    下发控制命令时沿用设备的编码：设备切回 JSON 调试时，下行也随之切回。
+    """
+
+    def __init__(self):
+        # 设备 ID -> 是否使用二进制编码
+        self._binary: dict[str, bool] = {}
+
+    def observe(self, device_id: str, device_type: str, payload: bytes) -> dict:
+        """
+        解码一条上报消息并记录其编码
+
+        参数：
+            device_id: 设备 ID
+            device_type: 设备类型
+            payload: MQTT 消息内容
+
+        返回：
+            消息内容
+        """
+        data = decode_payload(device_type, payload)
+        binary = is_binary(payload)
+        if self._binary.get(device_id) != binary:
+            logger.info(f"设备 {device_id} 使用 {'二进制' if binary else 'JSON'} 编码")
+            self._binary[device_id] = binary
+        return data
+
+    def encode_for(self, device_id: str, device_type: str, data: dict) -> bytes:
+        """
+        按设备当前编码编码下行消息，未收到过上报时使用 JSON
+
+        参数：
+            device_id: 设备 ID
+            device_type: 设备类型
+            data: 消息内容
+
+        返回：
+            编码后的消息内容
+        """
+        return encode_payload(device_type, data, self._binary.get(device_id, False))
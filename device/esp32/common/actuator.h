@@ -0,0 +1,130 @@
+/**
+ * 定时输出（电机、继电器等执行器）
+ *
+ * 功能说明：
+ *   打开一个输出引脚，到时自动关闭，期间不阻塞主循环。
+ *   代替 "digitalWrite(HIGH); delay(duration); digitalWrite(LOW);"，
+ *   执行器运行时 MQTT 消息和心跳照常处理，也可以随时提前停止。
+ *
+ * 使用方法：
+ *   TimedOutput motor(PIN_MOTOR);
+ *   motor.begin();
+ *   motor.runFor(2000, onFeedDone);
+ *
+ *   void loop() {
+ *       mqtt.loop();
+ *       motor.loop();
+ *       delay(motor.idleTime(LOOP_IDLE_MAX_MS));
+ *   }
+ *
+ * 注意：
+ *   关闭时刻的误差为主循环的一轮休眠时间，即不超过 LOOP_IDLE_MAX_MS。
+ */
+
+#ifndef ACTUATOR_H
+#define ACTUATOR_H
+
+#include <Arduino.h>
+#include "scheduler.h"
+
+class TimedOutput {
+public:
+    /**
+     * 构造函数
+     *
+     * 参数：
+     *   pin: 输出引脚
+     *   activeHigh: true 高电平有效，false 低电平有效
+     */
+    TimedOutput(uint8_t pin, bool activeHigh = true)
+        : _pin(pin), _activeHigh(activeHigh), _running(false), _until(0), _onDone(nullptr) {}
+
+    /**
+     * 初始化引脚并保持关闭
+     */
+    void begin() {
+        pinMode(_pin, OUTPUT);
+        write(false);
+    }
+
+    /**
+     * 打开输出，durationMs 后自动关闭
+     *
+     * 参数：
+     *   durationMs: 运行时长（毫秒）
+     *   onDone: 到时关闭后的回调，可选
+     *
+     * 返回：
+     *   true 已开始，false 正在运行（不叠加时长）
+     */
+    bool runFor(unsigned long durationMs, SchedulerCallback onDone = nullptr) {
+        if (_running) {
+            return false;
+        }
+        _running = true;
+        _until = millis() + durationMs;
+        _onDone = onDone;
+        write(true);
+        return true;
+    }
+
+    /**
+     * 立即关闭，不调用 onDone
+     */
+    void stop() {
+        write(false);
+        _running = false;
+        _onDone = nullptr;
+    }
+
+    /**
+     * 是否正在运行
+     */
+    bool isRunning() const {
+        return _running;
+    }
+
+    /**
+     * 到时关闭输出，需要在 loop() 中调用
+     */
+    void loop() {
+        if (!_running || (long)(millis() - _until) < 0) {
+            return;
+        }
+        write(false);
+        _running = false;
+        SchedulerCallback onDone = _onDone;
+        _onDone = nullptr;
+        if (onDone != nullptr) {
+            onDone();
+        }
+    }
+
+    /**
+     * 距关闭时刻的时间，不超过 maxMs；未运行时返回 maxMs
+     */
+    unsigned long idleTime(unsigned long maxMs) const {
+        if (!_running) {
+            return maxMs;
+        }
+        long remaining = (long)(_until - millis());
+        if (remaining <= 0) {
+            return 0;
+        }
+        return ((unsigned long)remaining < maxMs) ? remaining : maxMs;
+    }
+
+private:
+    uint8_t _pin;                   // 输出引脚
+    bool _activeHigh;               // 高电平有效
+    bool _running;                  // 正在运行
+    unsigned long _until;           // 关闭时间（millis）
+    SchedulerCallback _onDone;      // 关闭后的回调
+
+    // 按有效电平写引脚
+    void write(bool on) {
+        digitalWrite(_pin, (on == _activeHigh) ? HIGH : LOW);
+    }
+};
+
+#endif // ACTUATOR_H
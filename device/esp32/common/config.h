@@ -24,6 +24,13 @@
 // MQTT 密码（可选）
 #define MQTT_PASSWORD ""
 
+// ========== 通信链路配置 ==========
+#define DEVICE_LINK_MQTT 0
+#define DEVICE_LINK_ESPNOW 1
+// DEVICE_LINK_MQTT：直连 MQTT 服务器
+// DEVICE_LINK_ESPNOW：经 ESP-NOW 由网关（xn_esp32_web_manager 开启网关功能）转发，设备仍需连接网关所在的 AP
+#define DEVICE_LINK DEVICE_LINK_MQTT
+
 // ========== 心跳配置 ==========
 // 心跳间隔（毫秒），默认 30 秒
 #define HEARTBEAT_INTERVAL 30000
@@ -31,6 +38,26 @@
 // ========== 状态上报配置 ==========
 // 状态上报间隔（毫秒），默认 60 秒
 #define STATUS_REPORT_INTERVAL 60000
+// 读数变化触发的上报最小间隔（毫秒），限制读数频繁变化时的上报次数
+#define STATUS_REPORT_MIN_INTERVAL 5000
+
+// ========== 主循环配置 ==========
+// 主循环每轮最长休眠时间（毫秒），决定控制命令的最大响应延迟和定时输出的关闭误差
+#define LOOP_IDLE_MAX_MS 10
+
+// ========== 传感器采样配置 ==========
+// 每次采样的过采样次数（求平均）
+#define SENSOR_OVERSAMPLE 64
+// ADC 连续模式的采样频率（Hz），ESP32 最低 20000
+#define SENSOR_ADC_SAMPLE_HZ 20000
+// 中值滤波窗口（次采样），取奇数
+#define SENSOR_MEDIAN_SIZE 5
+// 指数平滑系数（0-1），越小越平稳、响应越慢
+#define SENSOR_EMA_ALPHA 0.3f
+
+// ========== 消息编码配置 ==========
+// 上报消息的编码：PAYLOAD_FORMAT_JSON（便于调试）或 PAYLOAD_FORMAT_BINARY（紧凑二进制）
+#define MQTT_PAYLOAD_FORMAT PAYLOAD_FORMAT_JSON
 
 // ========== 调试配置 ==========
 // 是否开启串口调试输出
@@ -0,0 +1,28 @@
+/**
+ * 设备通信链路选择
+ *
+ * 功能说明：
+ *   按 config.h 的 DEVICE_LINK 选择设备与知境中枢的通信方式，
+ *   设备代码统一使用 DeviceLink，切换链路不需要修改设备代码：
+ *   - DEVICE_LINK_MQTT：直连 MQTT 服务器（MqttClientWrapper）
+ *   - DEVICE_LINK_ESPNOW：经 ESP-NOW 由附近的网关转发（EspNowLink）
+ *
+ * 使用方法：
+ *   DeviceLink mqtt(DEVICE_ID, DEVICE_TYPE);
+ *   mqtt.begin(MQTT_BROKER, MQTT_PORT, MQTT_USERNAME, MQTT_PASSWORD);
+ */
+
+#ifndef DEVICE_LINK_H
+#define DEVICE_LINK_H
+
+#include "config.h"
+#include "mqtt_client.h"
+
+#if DEVICE_LINK == DEVICE_LINK_ESPNOW
+#include "espnow_link.h"
+typedef EspNowLink DeviceLink;
+#else
+typedef MqttClientWrapper DeviceLink;
+#endif
+
+#endif // DEVICE_LINK_H
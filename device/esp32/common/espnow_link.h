@@ -0,0 +1,438 @@
+/**
+ * ESP-NOW 网关链路
+ *
+ * 功能说明：
+ *   经 ESP-NOW 把状态和心跳发给附近的网关（xn_esp32_web_manager 开启
+ *   CONFIG_XN_GATEWAY_ENABLE），由网关代为发布到 MQTT；网关把
+ *   device/{device_id}/control 转发回本设备。设备不再维持 TCP/MQTT 连接，
+ *   服务器看到的主题和消息内容与 MqttClientWrapper 直连时相同。
+ *
+ *   接口与 MqttClientWrapper 一致，通过 device_link.h 的 DeviceLink 切换。
+ *
+ * 发现网关：
+ *   未找到网关时每 ESPNOW_DISCOVER_INTERVAL 毫秒广播一次心跳，收到网关
+ *   的 ACK 后记下网关地址，之后按 HEARTBEAT_INTERVAL 单播心跳；连续
+ *   ESPNOW_GATEWAY_LOST_BEATS 个心跳周期没有 ACK 时回到广播。
+ *
+ * 报文格式（与 components/xn_gateway/include/xn_gateway.h 保持一致）：
+ *   [0xE5][版本 2][类型][设备ID长度 n][设备ID][接收方会话随机数][帧计数][负载][认证码 8 字节]
+ *
+ * 认证：
+ *   每帧带 HMAC-SHA256(ESPNOW_DEVICE_KEY, 发送方MAC + 报文) 的前 8 字节。
+ *   只接受通过认证、带有本次启动会话随机数且帧计数递增的 ACK；控制命令
+ *   还必须来自已绑定的网关地址，其他设备伪造或重放的命令被丢弃。
+ *
+ * 注意：
+ *   ESP-NOW 使用 WiFi 当前信道，设备需先连接与网关相同的 AP。
+ *   单帧最大 250 字节，状态较大时请使用紧凑二进制编码。
+ *   begin() 关闭 WiFi 省电，否则睡眠期间会丢失网关下发的报文。
+ *   设备代码需定义 ESPNOW_DEVICE_KEY，未配置时不启动。
+ */
+
+#ifndef ESPNOW_LINK_H
+#define ESPNOW_LINK_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include <mbedtls/md.h>
+#include <ArduinoJson.h>
+#include "config.h"
+#include "payload_codec.h"
+#include "mqtt_client.h"
+
+// 报文格式
+#define ESPNOW_MAGIC 0xE5
+#define ESPNOW_VERSION 2
+#define ESPNOW_FRAME_MAX 250
+#define ESPNOW_ID_MAX 32
+#define ESPNOW_KEY_LEN 16
+#define ESPNOW_TAG_LEN 8
+#define ESPNOW_SEQ_LEN 8
+#define ESPNOW_FRAME_HEARTBEAT 0x01
+#define ESPNOW_FRAME_STATUS 0x02
+#define ESPNOW_FRAME_ACK 0x03
+#define ESPNOW_FRAME_CONTROL 0x04
+
+// 未找到网关时的广播心跳间隔（毫秒）
+#define ESPNOW_DISCOVER_INTERVAL 2000
+// 连续多少个心跳周期没有 ACK 视为网关丢失
+#define ESPNOW_GATEWAY_LOST_BEATS 3
+// 收包缓冲的报文数
+#define ESPNOW_RX_SLOTS 4
+
+// 设备密钥（32 位十六进制），在设备代码中与 DEVICE_ID 一起定义，见 README「网关模式」
+extern const char ESPNOW_DEVICE_KEY[];
+
+class EspNowLink {
+public:
+    /**
+     * 构造函数
+     *
+     * 参数：
+     *   deviceId: 设备唯一标识（不超过 32 字节）
+     *   deviceType: 设备类型，如 purifier、fish_feeder
+     */
+    EspNowLink(const char* deviceId, const char* deviceType)
+        : _deviceId(deviceId), _deviceType(deviceType), _controlCallback(nullptr),
+          _payloadFormat(PAYLOAD_FORMAT_JSON), _keyTable(payloadKeyTable(deviceType)),
+          _started(false), _hasGateway(false), _lastHeartbeat(0), _lastAck(0),
+          _nonce(0), _gwNonce(0), _gwCounter(0), _txCounter(0), _rxHead(0), _rxTail(0) {
+        snprintf(_controlTopic, sizeof(_controlTopic), "device/%s/control", deviceId);
+    }
+
+    /**
+     * 初始化 ESP-NOW，需在 WiFi 连接后调用
+     *
+     * 参数与 MqttClientWrapper::begin 相同，便于切换，均不使用。
+     */
+    void begin(const char* broker = nullptr, int port = 1883,
+               const char* username = nullptr, const char* password = nullptr) {
+        (void)broker;
+        (void)port;
+        (void)username;
+        (void)password;
+
+        if (!parseKey(ESPNOW_DEVICE_KEY, _key)) {
+            DEBUG_PRINTLN("ESPNOW_DEVICE_KEY 未配置（32 位十六进制），ESP-NOW 未启动");
+            return;
+        }
+        esp_wifi_get_mac(WIFI_IF_STA, _mac);
+        do {
+            _nonce = esp_random();
+        } while (_nonce == 0);  // 0 表示尚未得知会话随机数
+
+        WiFi.setSleep(false);
+        if (esp_now_init() != ESP_OK) {
+            DEBUG_PRINTLN("ESP-NOW 初始化失败");
+            return;
+        }
+        instance() = this;
+        esp_now_register_recv_cb(recvCallback);
+
+        static const uint8_t broadcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+        addPeer(broadcast);
+        _started = true;
+        _lastHeartbeat = millis() - ESPNOW_DISCOVER_INTERVAL;  // 下一次 loop() 立即发现网关
+    }
+
+    /**
+     * 需要在 loop() 中调用
+     *
+     * 功能：
+     *   - 处理网关的 ACK 和控制命令
+     *   - 发送心跳，网关丢失时回到广播发现
+     */
+    void loop() {
+        if (!_started) {
+            return;
+        }
+        while (_rxTail != _rxHead) {
+            RxFrame& frame = _rx[_rxTail];
+            handleFrame(frame);
+            _rxTail = (_rxTail + 1) % ESPNOW_RX_SLOTS;
+        }
+
+        unsigned long now = millis();
+        if (_hasGateway &&
+            now - _lastAck > (unsigned long)HEARTBEAT_INTERVAL * ESPNOW_GATEWAY_LOST_BEATS) {
+            DEBUG_PRINTLN("网关丢失，重新发现");
+            esp_now_del_peer(_gateway);
+            _hasGateway = false;
+        }
+        unsigned long interval = _hasGateway ? HEARTBEAT_INTERVAL : ESPNOW_DISCOVER_INTERVAL;
+        if (now - _lastHeartbeat >= interval) {
+            _lastHeartbeat = now;
+            sendHeartbeat();
+        }
+    }
+
+    /**
+     * 上报设备状态，未找到网关时丢弃
+     */
+    void reportStatus(JsonDocument& status) {
+        if (!_hasGateway) {
+            return;
+        }
+        uint8_t frame[ESPNOW_FRAME_MAX];
+        size_t head = writeHeader(frame, ESPNOW_FRAME_STATUS);
+        size_t len = payloadEncode(status, _payloadFormat, _keyTable, frame + head,
+                                   sizeof(frame) - head - ESPNOW_TAG_LEN);
+        if (len == 0) {
+            DEBUG_PRINTLN("状态超出 ESP-NOW 单帧长度");
+            return;
+        }
+        esp_now_send(_gateway, frame, sign(frame, head + len));
+    }
+
+    /**
+     * 设置控制命令回调，topic 参数为 device/{device_id}/control
+     */
+    void onControl(MqttMessageCallback callback) {
+        _controlCallback = callback;
+    }
+
+    /**
+     * 设置上报消息的编码，同 MqttClientWrapper::setPayloadFormat
+     */
+    void setPayloadFormat(PayloadFormat format) {
+        _payloadFormat = format;
+    }
+
+    /**
+     * 是否已找到网关
+     */
+    bool isConnected() {
+        return _hasGateway;
+    }
+
+private:
+    // 收包缓冲项
+    struct RxFrame {
+        uint8_t mac[6];                     // 发送方地址
+        uint8_t len;                        // 报文长度
+        uint8_t data[ESPNOW_FRAME_MAX];     // 报文
+    };
+
+    const char* _deviceId;                  // 设备 ID
+    const char* _deviceType;                // 设备类型
+    MqttMessageCallback _controlCallback;   // 控制命令回调
+    PayloadFormat _payloadFormat;           // 上报消息的编码
+    const PayloadKeyTable* _keyTable;       // 设备类型的键表，nullptr 表示只支持 JSON
+    bool _started;                          // ESP-NOW 已初始化
+    bool _hasGateway;                       // 已找到网关
+    uint8_t _gateway[6];                    // 网关地址（只由通过认证的 ACK 更新）
+    unsigned long _lastHeartbeat;           // 上次心跳时间
+    unsigned long _lastAck;                 // 上次收到 ACK 的时间
+    uint8_t _key[ESPNOW_KEY_LEN];           // 设备密钥
+    uint8_t _mac[6];                        // 本机 STA 地址
+    uint32_t _nonce;                        // 本次启动的会话随机数
+    uint32_t _gwNonce;                      // 网关的会话随机数
+    uint32_t _gwCounter;                    // 网关本会话最近接受的帧计数
+    uint32_t _txCounter;                    // 发送帧计数
+    char _controlTopic[64];                 // 传给控制回调的主题
+
+    // 收包环形缓冲：WiFi 任务写入 _rxHead，loop() 读取 _rxTail，满时丢弃新报文
+    RxFrame _rx[ESPNOW_RX_SLOTS];
+    volatile uint8_t _rxHead;
+    volatile uint8_t _rxTail;
+
+    // 收包回调使用的实例
+    static EspNowLink*& instance() {
+        static EspNowLink* self = nullptr;
+        return self;
+    }
+
+    // 登记 ESP-NOW 对端（当前信道，链路层不加密，报文由认证码保护）
+    static bool addPeer(const uint8_t* mac) {
+        if (esp_now_is_peer_exist(mac)) {
+            return true;
+        }
+        esp_now_peer_info_t peer = {};
+        memcpy(peer.peer_addr, mac, 6);
+        peer.channel = 0;
+        peer.ifidx = WIFI_IF_STA;
+        peer.encrypt = false;
+        return esp_now_add_peer(&peer) == ESP_OK;
+    }
+
+    static uint32_t getU32(const uint8_t* p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    static void putU32(uint8_t* p, uint32_t v) {
+        p[0] = (uint8_t)v;
+        p[1] = (uint8_t)(v >> 8);
+        p[2] = (uint8_t)(v >> 16);
+        p[3] = (uint8_t)(v >> 24);
+    }
+
+    // 解析 32 位十六进制密钥
+    static bool parseKey(const char* hex, uint8_t* key) {
+        if (strlen(hex) != ESPNOW_KEY_LEN * 2) {
+            return false;
+        }
+        for (size_t i = 0; i < ESPNOW_KEY_LEN * 2; i++) {
+            char c = hex[i];
+            uint8_t v;
+            if (c >= '0' && c <= '9') {
+                v = c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                v = c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                v = c - 'A' + 10;
+            } else {
+                return false;
+            }
+            key[i / 2] = (i % 2) ? (key[i / 2] | v) : (uint8_t)(v << 4);
+        }
+        return true;
+    }
+
+    // 认证码：HMAC-SHA256(设备密钥, 发送方MAC + 报文) 的前 ESPNOW_TAG_LEN 字节
+    void computeTag(const uint8_t* mac, const uint8_t* frame, size_t len, uint8_t* tag) {
+        uint8_t out[32];
+        mbedtls_md_context_t ctx;
+        mbedtls_md_init(&ctx);
+        if (mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1) != 0 ||
+            mbedtls_md_hmac_starts(&ctx, _key, ESPNOW_KEY_LEN) != 0 ||
+            mbedtls_md_hmac_update(&ctx, mac, 6) != 0 ||
+            mbedtls_md_hmac_update(&ctx, frame, len) != 0 ||
+            mbedtls_md_hmac_finish(&ctx, out) != 0) {
+            memset(out, 0, sizeof(out));    // 失败时发出的报文对端校验不过
+        }
+        mbedtls_md_free(&ctx);
+        memcpy(tag, out, ESPNOW_TAG_LEN);
+    }
+
+    // 在报文末尾追加认证码，返回总长度
+    size_t sign(uint8_t* frame, size_t len) {
+        computeTag(_mac, frame, len, frame + len);
+        return len + ESPNOW_TAG_LEN;
+    }
+
+    // 常量时间比较认证码
+    static bool tagEqual(const uint8_t* a, const uint8_t* b) {
+        uint8_t diff = 0;
+        for (size_t i = 0; i < ESPNOW_TAG_LEN; i++) {
+            diff |= a[i] ^ b[i];
+        }
+        return diff == 0;
+    }
+
+    // 写入报文头（含网关会话随机数与帧计数），返回长度
+    size_t writeHeader(uint8_t* frame, uint8_t type) {
+        size_t idLen = strnlen(_deviceId, ESPNOW_ID_MAX);
+        frame[0] = ESPNOW_MAGIC;
+        frame[1] = ESPNOW_VERSION;
+        frame[2] = type;
+        frame[3] = (uint8_t)idLen;
+        memcpy(frame + 4, _deviceId, idLen);
+        putU32(frame + 4 + idLen, _hasGateway ? _gwNonce : 0);
+        putU32(frame + 8 + idLen, ++_txCounter);
+        return 4 + idLen + ESPNOW_SEQ_LEN;
+    }
+
+    // 心跳：未找到网关时广播，否则单播到网关
+    void sendHeartbeat() {
+        static const uint8_t broadcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+        uint8_t frame[4 + ESPNOW_ID_MAX + ESPNOW_SEQ_LEN + 1 + 16 + 4 + ESPNOW_TAG_LEN];
+        size_t len = writeHeader(frame, ESPNOW_FRAME_HEARTBEAT);
+        size_t typeLen = strnlen(_deviceType, 16);
+        frame[len++] = (uint8_t)typeLen;
+        memcpy(frame + len, _deviceType, typeLen);
+        len += typeLen;
+        putU32(frame + len, _nonce);    // 网关据此在 ACK 和控制命令中回带
+        len += 4;
+        esp_now_send(_hasGateway ? _gateway : broadcast, frame, sign(frame, len));
+    }
+
+    // 处理一个报文：只接受发给本设备、通过认证且未重放的 ACK 和控制命令
+    void handleFrame(const RxFrame& frame) {
+        if (frame.len < 4 || frame.data[0] != ESPNOW_MAGIC || frame.data[1] != ESPNOW_VERSION) {
+            return;
+        }
+        uint8_t idLen = frame.data[3];
+        if (4 + idLen + ESPNOW_SEQ_LEN + ESPNOW_TAG_LEN > frame.len ||
+            idLen != strnlen(_deviceId, ESPNOW_ID_MAX) ||
+            memcmp(frame.data + 4, _deviceId, idLen) != 0) {
+            return;
+        }
+        uint8_t type = frame.data[2];
+        if (type != ESPNOW_FRAME_ACK && type != ESPNOW_FRAME_CONTROL) {
+            return;
+        }
+        // 控制命令只接受已绑定网关发出的，网关地址只由通过认证的 ACK 更新
+        bool fromGateway = _hasGateway && memcmp(_gateway, frame.mac, 6) == 0;
+        if (type == ESPNOW_FRAME_CONTROL && !fromGateway) {
+            return;
+        }
+
+        size_t signedLen = frame.len - ESPNOW_TAG_LEN;
+        uint8_t tag[ESPNOW_TAG_LEN];
+        computeTag(frame.mac, frame.data, signedLen, tag);
+        if (!tagEqual(tag, frame.data + signedLen)) {
+            DEBUG_PRINTLN("ESP-NOW 报文认证失败");
+            return;
+        }
+        uint32_t echo = getU32(frame.data + 4 + idLen);
+        uint32_t counter = getU32(frame.data + 8 + idLen);
+        if (echo != _nonce) {
+            return;     // 本次启动之前的报文
+        }
+        const uint8_t* body = frame.data + 4 + idLen + ESPNOW_SEQ_LEN;
+        size_t bodyLen = signedLen - 4 - idLen - ESPNOW_SEQ_LEN;
+
+        if (type == ESPNOW_FRAME_ACK) {
+            if (bodyLen != 4) {
+                return;
+            }
+            uint32_t gwNonce = getU32(body);
+            if (fromGateway && gwNonce == _gwNonce && counter <= _gwCounter) {
+                return;     // 重放
+            }
+            _lastAck = millis();
+            _gwNonce = gwNonce;     // 网关重启后随机数变化，重新开始计数
+            _gwCounter = counter;
+            if (!fromGateway) {
+                if (_hasGateway) {
+                    esp_now_del_peer(_gateway);
+                }
+                _hasGateway = false;
+                if (!addPeer(frame.mac)) {
+                    return;
+                }
+                memcpy(_gateway, frame.mac, 6);
+                _hasGateway = true;
+                DEBUG_PRINTF("已找到网关 %02X:%02X:%02X:%02X:%02X:%02X\n",
+                             frame.mac[0], frame.mac[1], frame.mac[2],
+                             frame.mac[3], frame.mac[4], frame.mac[5]);
+            }
+        } else {
+            if (counter <= _gwCounter) {
+                return;     // 重放
+            }
+            _gwCounter = counter;
+            if (_controlCallback == nullptr) {
+                return;
+            }
+            JsonDocument doc;
+            if (payloadDecode(body, bodyLen, _keyTable, doc)) {
+                _controlCallback(_controlTopic, doc);
+            } else {
+                DEBUG_PRINTLN("控制命令解码失败");
+            }
+        }
+    }
+
+    // 在 WiFi 任务中执行：只拷贝报文
+    static void enqueue(const uint8_t* mac, const uint8_t* data, int len) {
+        EspNowLink* self = instance();
+        if (self == nullptr || len <= 0 || len > ESPNOW_FRAME_MAX) {
+            return;
+        }
+        uint8_t next = (self->_rxHead + 1) % ESPNOW_RX_SLOTS;
+        if (next == self->_rxTail) {
+            return;
+        }
+        RxFrame& frame = self->_rx[self->_rxHead];
+        memcpy(frame.mac, mac, 6);
+        memcpy(frame.data, data, len);
+        frame.len = (uint8_t)len;
+        __sync_synchronize();   // 报文写完后再发布
+        self->_rxHead = next;
+    }
+
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    static void recvCallback(const esp_now_recv_info_t* info, const uint8_t* data, int len) {
+        enqueue(info->src_addr, data, len);
+    }
+#else
+    static void recvCallback(const uint8_t* mac, const uint8_t* data, int len) {
+        enqueue(mac, data, len);
+    }
+#endif
+};
+
+#endif // ESPNOW_LINK_H
@@ -9,6 +9,14 @@
  *   - 设备上报主题：device/{device_id}/status
  *   - 设备控制主题：device/{device_id}/control
  *   - 心跳主题：device/{device_id}/heartbeat
+ *
+ * 消息编码：
+ *   默认 JSON；调用 setPayloadFormat() 后状态和心跳改用紧凑二进制编码
+ *   （见 payload_codec.h）。控制命令按首字节自动识别编码。
+ *
+ * 注意：
+ *   实现全部在头文件中（Arduino 不编译 sketch 目录以外的源文件），
+ *   只支持一个实例，PubSubClient 的消息回调通过 instance() 找到它。
  */
 
 #ifndef MQTT_CLIENT_H
@@ -16,11 +24,19 @@
 
 #include <Arduino.h>
 #include <PubSubClient.h>
+#include <WiFi.h>
 #include <WiFiClient.h>
 #include <ArduinoJson.h>
+#include "config.h"
+#include "payload_codec.h"
+
+// 断线后的重连间隔（毫秒）
+#define MQTT_RECONNECT_INTERVAL 5000
+// 编码缓冲与 PubSubClient 收发缓冲大小（字节）
+#define MQTT_PAYLOAD_MAX 512
 
 // MQTT 消息回调函数类型
-// 参数：主题、消息内容（JSON 格式）
+// 参数：主题、消息内容（已解码，与编码格式无关）
 typedef void (*MqttMessageCallback)(const char* topic, JsonDocument& doc);
 
 class MqttClientWrapper {
@@ -32,7 +48,15 @@ public:
      *   deviceId: 设备唯一标识，用于构建 MQTT 主题
      *   deviceType: 设备类型，如 purifier、fish_feeder
      */
-    MqttClientWrapper(const char* deviceId, const char* deviceType);
+    MqttClientWrapper(const char* deviceId, const char* deviceType)
+        : _deviceId(deviceId), _deviceType(deviceType), _mqttClient(_wifiClient),
+          _controlCallback(nullptr), _lastHeartbeat(0), _lastReconnect(0),
+          _payloadFormat(PAYLOAD_FORMAT_JSON), _keyTable(payloadKeyTable(deviceType)),
+          _username(nullptr), _password(nullptr) {
+        snprintf(_statusTopic, sizeof(_statusTopic), "device/%s/status", deviceId);
+        snprintf(_controlTopic, sizeof(_controlTopic), "device/%s/control", deviceId);
+        snprintf(_heartbeatTopic, sizeof(_heartbeatTopic), "device/%s/heartbeat", deviceId);
+    }
     
     /**
      * 初始化 MQTT 连接
@@ -44,7 +68,16 @@ public:
      *   password: 密码，可选
      */
     void begin(const char* broker, int port = 1883, 
-               const char* username = nullptr, const char* password = nullptr);
+               const char* username = nullptr, const char* password = nullptr) {
+        // 空字符串视为匿名连接（config.h 默认值）
+        _username = (username != nullptr && username[0] != '\0') ? username : nullptr;
+        _password = (password != nullptr && password[0] != '\0') ? password : nullptr;
+        instance() = this;
+        _mqttClient.setServer(broker, port);
+        _mqttClient.setBufferSize(MQTT_PAYLOAD_MAX);
+        _mqttClient.setCallback(messageCallback);
+        connect();
+    }
     
     /**
      * 保持连接，需要在 loop() 中调用
@@ -54,7 +87,23 @@ public:
      *   - 处理接收到的消息
      *   - 发送心跳包
      */
-    void loop();
+    void loop() {
+        unsigned long now = millis();
+        if (!_mqttClient.connected()) {
+            if (now - _lastReconnect < MQTT_RECONNECT_INTERVAL) {
+                return;
+            }
+            connect();
+            if (!_mqttClient.connected()) {
+                return;
+            }
+        }
+        _mqttClient.loop();
+        if (now - _lastHeartbeat >= HEARTBEAT_INTERVAL) {
+            _lastHeartbeat = now;
+            sendHeartbeat();
+        }
+    }
     
     /**
      * 上报设备状态
@@ -68,7 +117,11 @@ public:
      *   doc["mode"] = "auto";
      *   mqtt.reportStatus(doc);
      */
-    void reportStatus(JsonDocument& status);
+    void reportStatus(JsonDocument& status) {
+        if (!publishPayload(_statusTopic, status)) {
+            DEBUG_PRINTLN("状态上报失败");
+        }
+    }
     
     /**
      * 设置控制命令回调
@@ -76,12 +129,30 @@ public:
      * 当收到控制命令时，会调用此回调函数。
      * 设备需要在回调中处理具体的控制逻辑。
      */
-    void onControl(MqttMessageCallback callback);
+    void onControl(MqttMessageCallback callback) {
+        _controlCallback = callback;
+    }
+    
+    /**
+     * 设置上报消息的编码
+     * 
+     * 参数：
+     *   format: PAYLOAD_FORMAT_JSON 或 PAYLOAD_FORMAT_BINARY
+     * 
+     * 说明：
+     *   设备类型没有键表时始终使用 JSON。
+     *   服务器下发控制命令时沿用设备最近一次上报的编码。
+     */
+    void setPayloadFormat(PayloadFormat format) {
+        _payloadFormat = format;
+    }
     
     /**
      * 检查是否已连接
      */
-    bool isConnected();
+    bool isConnected() {
+        return _mqttClient.connected();
+    }
 
 private:
     const char* _deviceId;      // 设备 ID
@@ -90,20 +161,71 @@ private:
     PubSubClient _mqttClient;   // MQTT 客户端
     MqttMessageCallback _controlCallback;  // 控制命令回调
     unsigned long _lastHeartbeat;  // 上次心跳时间
+    unsigned long _lastReconnect;  // 上次尝试连接的时间
+    PayloadFormat _payloadFormat;  // 上报消息的编码
+    const PayloadKeyTable* _keyTable;  // 设备类型的键表，nullptr 表示只支持 JSON
+    const char* _username;      // 用户名，nullptr 表示匿名
+    const char* _password;      // 密码
     
     // MQTT 主题
     char _statusTopic[64];      // 状态上报主题
     char _controlTopic[64];     // 控制命令主题
     char _heartbeatTopic[64];   // 心跳主题
     
-    // 连接到 MQTT 服务器
-    void connect();
+    // 消息回调使用的实例
+    static MqttClientWrapper*& instance() {
+        static MqttClientWrapper* self = nullptr;
+        return self;
+    }
+    
+    // 连接到 MQTT 服务器并订阅控制主题，客户端 ID 使用设备 ID
+    void connect() {
+        _lastReconnect = millis();
+        if (!_mqttClient.connect(_deviceId, _username, _password)) {
+            DEBUG_PRINTF("MQTT 连接失败，状态 %d\n", _mqttClient.state());
+            return;
+        }
+        _mqttClient.subscribe(_controlTopic);
+        DEBUG_PRINTLN("MQTT 已连接");
+        _lastHeartbeat = millis() - HEARTBEAT_INTERVAL;  // 连接后立即发送一次心跳
+    }
+    
+    // 发送心跳：运行时间与信号强度，编码同状态上报
+    void sendHeartbeat() {
+        JsonDocument doc;
+        doc["uptime"] = millis() / 1000;
+        doc["rssi"] = WiFi.RSSI();
+        publishPayload(_heartbeatTopic, doc);
+    }
     
-    // 发送心跳
-    void sendHeartbeat();
+    // 按当前编码发布消息
+    bool publishPayload(const char* topic, JsonDocument& doc) {
+        if (!_mqttClient.connected()) {
+            return false;
+        }
+        uint8_t buf[MQTT_PAYLOAD_MAX];
+        size_t len = payloadEncode(doc, _payloadFormat, _keyTable, buf, sizeof(buf));
+        if (len == 0) {
+            DEBUG_PRINTLN("消息超出编码缓冲");
+            return false;
+        }
+        return _mqttClient.publish(topic, buf, (unsigned int)len);
+    }
     
-    // 静态消息回调（PubSubClient 要求）
-    static void messageCallback(char* topic, byte* payload, unsigned int length);
+    // 静态消息回调（PubSubClient 要求）：控制命令按首字节识别编码后交给设备回调
+    static void messageCallback(char* topic, byte* payload, unsigned int length) {
+        MqttClientWrapper* self = instance();
+        if (self == nullptr || self->_controlCallback == nullptr ||
+            strcmp(topic, self->_controlTopic) != 0) {
+            return;
+        }
+        JsonDocument doc;
+        if (payloadDecode(payload, length, self->_keyTable, doc)) {
+            self->_controlCallback(topic, doc);
+        } else {
+            DEBUG_PRINTLN("控制命令解码失败");
+        }
+    }
 };
 
 #endif // MQTT_CLIENT_H
@@ -0,0 +1,175 @@
+/**
+ * MQTT 消息编解码
+ *
+ * 功能说明：
+ *   设备消息支持两种编码：
+ *   - JSON：默认格式，便于串口和抓包调试
+ *   - 紧凑二进制：[魔数 0xC1][键表版本][MessagePack]
+ *     对象的键名按设备类型的键表替换为序号字符串（如 "power" -> "2"），
+ *     不在键表中的键保留原名。
+ *
+ *   0xC1 在 MessagePack 中保留未用，也不可能是 JSON 的首字符，
+ *   收到消息时按首字节自动识别编码，两种格式可以混用。
+ *
+ * 注意：
+ *   键表与服务器端 app/services/device/payload_codec.py 保持一致，
+ *   只允许在末尾追加；删除或调整顺序时必须升级 PAYLOAD_KEY_TABLE_VERSION。
+ */
+
+#ifndef PAYLOAD_CODEC_H
+#define PAYLOAD_CODEC_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// 二进制帧魔数
+#define PAYLOAD_BINARY_MAGIC 0xC1
+// 当前键表版本
+#define PAYLOAD_KEY_TABLE_VERSION 1
+
+// 消息编码
+enum PayloadFormat {
+    PAYLOAD_FORMAT_JSON = 0,    // JSON
+    PAYLOAD_FORMAT_BINARY = 1,  // 紧凑二进制
+};
+
+// 设备类型的键表
+struct PayloadKeyTable {
+    const char* deviceType;     // 设备类型
+    const char* const* keys;    // 键名，下标即序号
+    uint8_t count;              // 键数量
+};
+
+// 各设备类型的键表，序号 0、1 固定为控制命令的 command、params
+static const char* const PAYLOAD_KEYS_PURIFIER[] = {
+    "command", "params",
+    "power", "mode", "pm25", "filter_hours",
+};
+static const char* const PAYLOAD_KEYS_FISH_FEEDER[] = {
+    "command", "params",
+    "last_feed_time", "food_level", "feed_count_today", "feed_duration",
+    "schedules", "hour", "minute", "duration",
+};
+static const PayloadKeyTable PAYLOAD_KEY_TABLES[] = {
+    {"purifier", PAYLOAD_KEYS_PURIFIER, sizeof(PAYLOAD_KEYS_PURIFIER) / sizeof(PAYLOAD_KEYS_PURIFIER[0])},
+    {"fish_feeder", PAYLOAD_KEYS_FISH_FEEDER, sizeof(PAYLOAD_KEYS_FISH_FEEDER) / sizeof(PAYLOAD_KEYS_FISH_FEEDER[0])},
+};
+
+/**
+ * 查找设备类型的键表
+ *
+ * 返回：
+ *   键表，设备类型不支持二进制编码时返回 nullptr
+ */
+inline const PayloadKeyTable* payloadKeyTable(const char* deviceType) {
+    for (const PayloadKeyTable& table : PAYLOAD_KEY_TABLES) {
+        if (strcmp(table.deviceType, deviceType) == 0) {
+            return &table;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * 递归拷贝并替换对象键名
+ *
+ * 参数：
+ *   src: 源数据
+ *   dst: 目标位置
+ *   table: 键表
+ *   toIndex: true 键名 -> 序号（编码），false 序号 -> 键名（解码）
+ */
+inline void payloadMapKeys(JsonVariantConst src, JsonVariant dst,
+                           const PayloadKeyTable* table, bool toIndex) {
+    if (src.is<JsonObjectConst>()) {
+        JsonObject obj = dst.to<JsonObject>();
+        for (JsonPairConst kv : src.as<JsonObjectConst>()) {
+            const char* key = kv.key().c_str();
+            String mapped = key;
+            if (toIndex) {
+                for (uint8_t i = 0; i < table->count; i++) {
+                    if (strcmp(key, table->keys[i]) == 0) {
+                        mapped = String(i);
+                        break;
+                    }
+                }
+            } else {
+                char* end = nullptr;
+                long i = strtol(key, &end, 10);
+                if (key[0] != '\0' && *end == '\0' && i >= 0 && i < table->count) {
+                    mapped = table->keys[i];
+                }
+            }
+            payloadMapKeys(kv.value(), obj[mapped].to<JsonVariant>(), table, toIndex);
+        }
+    } else if (src.is<JsonArrayConst>()) {
+        JsonArray arr = dst.to<JsonArray>();
+        for (JsonVariantConst item : src.as<JsonArrayConst>()) {
+            payloadMapKeys(item, arr.add<JsonVariant>(), table, toIndex);
+        }
+    } else {
+        dst.set(src);
+    }
+}
+
+/**
+ * 编码消息
+ *
+ * 参数：
+ *   doc: 消息内容
+ *   format: 编码，设备类型没有键表时退回 JSON
+ *   table: 键表，可为 nullptr
+ *   out: 输出缓冲区
+ *   outSize: 缓冲区大小
+ *
+ * 返回：
+ *   编码后的长度，缓冲区不足时返回 0
+ */
+inline size_t payloadEncode(JsonDocument& doc, PayloadFormat format, const PayloadKeyTable* table,
+                            uint8_t* out, size_t outSize) {
+    if (format == PAYLOAD_FORMAT_JSON || table == nullptr) {
+        size_t len = serializeJson(doc, out, outSize);
+        return (len < outSize) ? len : 0;
+    }
+    if (outSize < 3) {
+        return 0;
+    }
+
+    JsonDocument mapped;
+    payloadMapKeys(doc.as<JsonVariantConst>(), mapped.to<JsonVariant>(), table, true);
+    out[0] = PAYLOAD_BINARY_MAGIC;
+    out[1] = PAYLOAD_KEY_TABLE_VERSION;
+    size_t len = serializeMsgPack(mapped, out + 2, outSize - 2);
+    return (len > 0 && len < outSize - 2) ? len + 2 : 0;
+}
+
+/**
+ * 解码消息，按首字节自动识别编码
+ *
+ * 参数：
+ *   data: 消息内容
+ *   len: 消息长度
+ *   table: 键表，可为 nullptr（此时只能解码 JSON）
+ *   doc: 输出
+ *
+ * 返回：
+ *   true 解码成功
+ */
+inline bool payloadDecode(const uint8_t* data, size_t len, const PayloadKeyTable* table,
+                          JsonDocument& doc) {
+    if (len == 0 || data[0] != PAYLOAD_BINARY_MAGIC) {
+        return deserializeJson(doc, data, len) == DeserializationError::Ok;
+    }
+    if (table == nullptr || len < 2 || data[1] != PAYLOAD_KEY_TABLE_VERSION) {
+        return false;
+    }
+
+    JsonDocument raw;
+    if (deserializeMsgPack(raw, data + 2, len - 2) != DeserializationError::Ok) {
+        return false;
+    }
+    payloadMapKeys(raw.as<JsonVariantConst>(), doc.to<JsonVariant>(), table, false);
+    return true;
+}
+
+#endif // PAYLOAD_CODEC_H
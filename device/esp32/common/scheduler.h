@@ -0,0 +1,153 @@
+/**
+ * 协作式作业调度
+ *
+ * 功能说明：
+ *   在 loop() 中按 millis() 执行周期作业和单次作业，代替 delay() 和手写的
+ *   "millis() - lastXxx > INTERVAL" 判断，主循环不再阻塞，MQTT 和 WiFi
+ *   每一轮都能得到处理。
+ *
+ * 使用方法：
+ *   Scheduler scheduler;
+ *   scheduler.every(1000, samplePM25);   // 每秒采样
+ *   scheduler.after(500, onTimeout);     // 500ms 后执行一次
+ *
+ *   void loop() {
+ *       mqtt.loop();
+ *       scheduler.loop();
+ *       delay(scheduler.idleTime(LOOP_IDLE_MAX_MS));
+ *   }
+ *
+ * 注意：
+ *   作业在 loop() 中依次执行，回调里不要调用 delay()；
+ *   需要等待的动作拆成多个作业，或使用 actuator.h 的定时输出。
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// 作业回调
+typedef void (*SchedulerCallback)();
+
+// 最多同时存在的作业数
+#define SCHEDULER_MAX_JOBS 8
+
+class Scheduler {
+public:
+    /**
+     * 添加周期作业
+     *
+     * 参数：
+     *   intervalMs: 执行间隔（毫秒）
+     *   callback: 回调
+     *   runNow: true 时下一次 loop() 立即执行一次，否则一个间隔后第一次执行
+     *
+     * 返回：
+     *   作业号，作业数已满时返回 -1
+     */
+    int8_t every(unsigned long intervalMs, SchedulerCallback callback, bool runNow = false) {
+        return add(runNow ? 0 : intervalMs, intervalMs, callback);
+    }
+
+    /**
+     * 添加单次作业
+     *
+     * 参数：
+     *   delayMs: 延时（毫秒）
+     *   callback: 回调
+     *
+     * 返回：
+     *   作业号，作业数已满时返回 -1
+     */
+    int8_t after(unsigned long delayMs, SchedulerCallback callback) {
+        return add(delayMs, 0, callback);
+    }
+
+    /**
+     * 取消作业，回调中可以取消自己
+     */
+    void cancel(int8_t id) {
+        if (id >= 0 && id < SCHEDULER_MAX_JOBS) {
+            _jobs[id].callback = nullptr;
+        }
+    }
+
+    /**
+     * 执行到期的作业，需要在 loop() 中调用
+     *
+     * 周期作业按间隔累加到期时间，不因回调耗时漂移；落后超过一个间隔时不补执行。
+     */
+    void loop() {
+        for (uint8_t i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+            Job& job = _jobs[i];
+            unsigned long now = millis();
+            if (job.callback == nullptr || (long)(now - job.due) < 0) {
+                continue;
+            }
+
+            SchedulerCallback callback = job.callback;
+            if (job.interval > 0) {
+                job.due += job.interval;
+                if ((long)(now - job.due) >= 0) {
+                    job.due = now + job.interval;
+                }
+            } else {
+                job.callback = nullptr;
+            }
+            callback();
+        }
+    }
+
+    /**
+     * 距下一个作业到期的时间
+     *
+     * 参数：
+     *   maxMs: 上限，决定主循环处理 MQTT 消息的最大延迟
+     *
+     * 返回：
+     *   可以休眠的毫秒数，不超过 maxMs
+     */
+    unsigned long idleTime(unsigned long maxMs) const {
+        unsigned long now = millis();
+        unsigned long idle = maxMs;
+        for (uint8_t i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+            if (_jobs[i].callback == nullptr) {
+                continue;
+            }
+            long remaining = (long)(_jobs[i].due - now);
+            if (remaining <= 0) {
+                return 0;
+            }
+            if ((unsigned long)remaining < idle) {
+                idle = remaining;
+            }
+        }
+        return idle;
+    }
+
+private:
+    struct Job {
+        SchedulerCallback callback;     // 回调，nullptr 表示空闲槽位
+        unsigned long due;              // 到期时间（millis）
+        unsigned long interval;         // 周期（毫秒），0 表示单次
+    };
+    Job _jobs[SCHEDULER_MAX_JOBS] = {};
+
+    // 占用一个空闲槽位
+    int8_t add(unsigned long delayMs, unsigned long intervalMs, SchedulerCallback callback) {
+        for (int8_t i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+            if (_jobs[i].callback == nullptr) {
+                _jobs[i].callback = callback;
+                _jobs[i].due = millis() + delayMs;
+                _jobs[i].interval = intervalMs;
+                return i;
+            }
+        }
+        DEBUG_PRINTLN("作业数已满");
+        return -1;
+    }
+};
+
+#endif // SCHEDULER_H
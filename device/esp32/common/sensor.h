@@ -0,0 +1,221 @@
+/**
+ * 模拟传感器采样与滤波
+ *
+ * 功能说明：
+ *   单次 analogRead 噪声大，直接用来判断档位或告警会来回跳变。
+ *   AnalogSensor 每次采样取一组过采样的平均值，再经过中值滤波（去掉偶发尖峰）
+ *   和指数平滑（压低随机噪声），得到稳定的读数。
+ *   LevelHysteresis 把读数按阈值分级，阈值附近留出回差，读数在阈值上下
+ *   小幅波动时级别不变。
+ *
+ * 过采样方式：
+ *   Arduino-ESP32 3.x 使用 ADC 连续模式，由 DMA 在后台转换并求平均，
+ *   sample() 只取最近一帧的结果，不占用 CPU 等待转换；
+ *   连续模式不可用（2.x 内核，或已被其他传感器占用）时，退回为
+ *   连续调用 SENSOR_OVERSAMPLE 次 analogRead 求平均。
+ *
+ * 使用方法：
+ *   AnalogSensor pm25Sensor(PIN_PM25_SENSOR);
+ *   pm25Sensor.begin();
+ *   scheduler.every(1000, samplePM25);   // 回调中调用 pm25Sensor.sample()
+ *
+ *   const int limits[] = {35, 75};
+ *   LevelHysteresis level(limits, 2, 5);
+ *   uint8_t lv = level.update(pm25);     // 0 / 1 / 2
+ *
+ * 注意：
+ *   ADC 连续模式全局只有一组配置，每个固件只有一个传感器能使用，
+ *   其余传感器自动退回 analogRead 过采样。
+ */
+
+#ifndef SENSOR_H
+#define SENSOR_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+#define SENSOR_HAS_CONTINUOUS 1
+#else
+#define SENSOR_HAS_CONTINUOUS 0
+#endif
+
+class AnalogSensor {
+public:
+    /**
+     * 构造函数
+     *
+     * 参数：
+     *   pin: 模拟输入引脚（连续模式只支持 ADC1 引脚）
+     */
+    AnalogSensor(uint8_t pin)
+        : _pin(pin), _continuous(false), _count(0), _next(0), _ema(0), _value(0) {}
+
+    /**
+     * 初始化引脚，能用时启动 ADC 连续模式
+     */
+    void begin() {
+        pinMode(_pin, INPUT);
+#if SENSOR_HAS_CONTINUOUS
+        uint8_t pins[1] = {_pin};
+        if (analogContinuous(pins, 1, SENSOR_OVERSAMPLE, SENSOR_ADC_SAMPLE_HZ, nullptr) &&
+            analogContinuousStart()) {
+            _continuous = true;
+        } else {
+            DEBUG_PRINTF("引脚 %d 无法使用 ADC 连续模式，改为 analogRead 过采样\n", _pin);
+        }
+#endif
+    }
+
+    /**
+     * 采样一次并更新滤波结果，由周期作业调用
+     *
+     * 返回：
+     *   滤波后的原始值（0-4095）
+     */
+    int sample() {
+        int raw;
+        if (!readOversampled(raw)) {
+            return _value;  // 连续模式尚无新数据，保持上次结果
+        }
+
+        // 中值滤波：窗口未填满时按已有样本计算
+        _window[_next] = raw;
+        _next = (_next + 1) % SENSOR_MEDIAN_SIZE;
+        if (_count < SENSOR_MEDIAN_SIZE) {
+            _count++;
+        }
+        int median = medianOfWindow();
+
+        // 指数平滑：第一次采样直接取中值
+        if (_count == 1) {
+            _ema = median;
+        } else {
+            _ema += SENSOR_EMA_ALPHA * (median - _ema);
+        }
+        _value = (int)(_ema + 0.5f);
+        return _value;
+    }
+
+    /**
+     * 最近一次的滤波结果（0-4095），未采样时为 0
+     */
+    int value() const {
+        return _value;
+    }
+
+    /**
+     * 是否使用 ADC 连续模式
+     */
+    bool isContinuous() const {
+        return _continuous;
+    }
+
+private:
+    uint8_t _pin;                           // 模拟输入引脚
+    bool _continuous;                       // 使用 ADC 连续模式
+    int _window[SENSOR_MEDIAN_SIZE] = {};   // 中值滤波窗口
+    uint8_t _count;                         // 窗口中的样本数
+    uint8_t _next;                          // 下一个写入位置
+    float _ema;                             // 指数平滑状态
+    int _value;                             // 滤波结果
+
+    // 取一组过采样的平均值，没有新数据时返回 false
+    bool readOversampled(int& raw) {
+#if SENSOR_HAS_CONTINUOUS
+        if (_continuous) {
+            adc_continuous_data_t* result = nullptr;
+            if (!analogContinuousRead(&result, 0) || result == nullptr) {
+                return false;
+            }
+            raw = result[0].avg_read_raw;
+            return true;
+        }
+#endif
+        long sum = 0;
+        for (uint8_t i = 0; i < SENSOR_OVERSAMPLE; i++) {
+            sum += analogRead(_pin);
+        }
+        raw = (int)(sum / SENSOR_OVERSAMPLE);
+        return true;
+    }
+
+    // 窗口中已有样本的中值（插入排序，窗口很小）
+    int medianOfWindow() const {
+        int sorted[SENSOR_MEDIAN_SIZE];
+        for (uint8_t i = 0; i < _count; i++) {
+            int v = _window[i];
+            int8_t j = i - 1;
+            while (j >= 0 && sorted[j] > v) {
+                sorted[j + 1] = sorted[j];
+                j--;
+            }
+            sorted[j + 1] = v;
+        }
+        return sorted[_count / 2];
+    }
+};
+
+class LevelHysteresis {
+public:
+    /**
+     * 构造函数
+     *
+     * 参数：
+     *   thresholds: 升序的阈值数组（需长期有效），count 个阈值分出 count+1 级
+     *   count: 阈值个数
+     *   band: 回差，读数超过阈值 + band 才升级，低于阈值 - band 才降级
+     */
+    LevelHysteresis(const int* thresholds, uint8_t count, int band)
+        : _thresholds(thresholds), _count(count), _band(band), _level(0), _valid(false) {}
+
+    /**
+     * 按新读数更新级别
+     *
+     * 第一次调用不考虑回差，直接按阈值分级。
+     *
+     * 返回：
+     *   当前级别（0 - count）
+     */
+    uint8_t update(int value) {
+        if (!_valid) {
+            _valid = true;
+            _level = 0;
+            while (_level < _count && value >= _thresholds[_level]) {
+                _level++;
+            }
+            return _level;
+        }
+        while (_level < _count && value >= _thresholds[_level] + _band) {
+            _level++;
+        }
+        while (_level > 0 && value < _thresholds[_level - 1] - _band) {
+            _level--;
+        }
+        return _level;
+    }
+
+    /**
+     * 当前级别
+     */
+    uint8_t level() const {
+        return _level;
+    }
+
+    /**
+     * 清除状态，下一次 update() 重新直接分级
+     */
+    void reset() {
+        _valid = false;
+        _level = 0;
+    }
+
+private:
+    const int* _thresholds;     // 升序阈值
+    uint8_t _count;             // 阈值个数
+    int _band;                  // 回差
+    uint8_t _level;             // 当前级别
+    bool _valid;                // 已有读数
+};
+
+#endif // SENSOR_H
@@ -18,13 +18,18 @@
 #include <ArduinoJson.h>
 #include "../common/config.h"
 #include "../common/wifi_manager.h"
-#include "../common/mqtt_client.h"
+#include "../common/device_link.h"
+#include "../common/scheduler.h"
+#include "../common/actuator.h"
+#include "../common/sensor.h"
 
 // ========== 设备配置 ==========
 // 设备唯一标识，每个设备必须不同
 #define DEVICE_ID "fish_feeder_001"
 // 设备类型
 #define DEVICE_TYPE "fish_feeder"
+// ESP-NOW 设备密钥（DEVICE_LINK 为 DEVICE_LINK_ESPNOW 时使用），由网关主密钥和 DEVICE_ID 派生
+const char ESPNOW_DEVICE_KEY[] = "";
 
 // WiFi 配置（根据实际情况修改）
 #define WIFI_SSID "your-wifi-ssid"
@@ -42,6 +47,18 @@
 // 最小投喂时长
 #define MIN_FEED_DURATION 500
 
+// ========== 采样配置 ==========
+// 余粮采样间隔（毫秒）
+#define FOOD_SAMPLE_INTERVAL 1000
+// 余粮告警阈值（百分比）
+#define FOOD_LOW_LEVEL 20
+// 余粮告警回差（百分比），余粮回升到阈值 + 回差以上才解除告警
+#define FOOD_LEVEL_HYSTERESIS 5
+// 余粮变化超过该值时提前上报（百分比）
+#define FOOD_REPORT_DELTA 5
+// 定时投喂检查间隔（毫秒）
+#define SCHEDULE_CHECK_INTERVAL 60000
+
 // ========== 设备状态 ==========
 // 上次投喂时间（时间戳）
 unsigned long lastFeedTime = 0;
@@ -51,6 +68,14 @@ int foodLevel = 100;
 int feedCountToday = 0;
 // 当前投喂量设置（毫秒）
 int feedDuration = DEFAULT_FEED_DURATION;
+// 余粮不足已告警，回升后重新告警
+bool foodLowWarned = false;
+// 上次上报的余粮和上报时间，用于变化触发的上报
+int reportedFoodLevel = -1;
+unsigned long lastReportTime = 0;
+
+// 余粮分级：0 不足，1 正常
+const int foodThresholds[] = {FOOD_LOW_LEVEL};
 
 // ========== 定时投喂配置 ==========
 // 最多支持 5 个定时任务
@@ -64,27 +89,16 @@ struct FeedSchedule {
 FeedSchedule schedules[MAX_SCHEDULES];
 
 // ========== 全局对象 ==========
-MqttClientWrapper mqtt(DEVICE_ID, DEVICE_TYPE);
-unsigned long lastStatusReport = 0;
-unsigned long lastScheduleCheck = 0;
+DeviceLink mqtt(DEVICE_ID, DEVICE_TYPE);
+Scheduler scheduler;
+TimedOutput motor(PIN_MOTOR);
+AnalogSensor foodSensor(PIN_FOOD_SENSOR);
+LevelHysteresis foodLevelState(foodThresholds, 1, FOOD_LEVEL_HYSTERESIS);
 
 /**
- * 执行投喂
- * 
- * 参数：
- *   duration: 投喂时长（毫秒），控制投喂量
+ * 投喂完成（电机到时关闭后调用）
  */
-void feed(int duration = DEFAULT_FEED_DURATION) {
-    // 限制投喂时长范围
-    duration = constrain(duration, MIN_FEED_DURATION, MAX_FEED_DURATION);
-    
-    DEBUG_PRINTF("开始投喂，时长: %d ms\n", duration);
-    
-    // 启动电机
-    digitalWrite(PIN_MOTOR, HIGH);
-    delay(duration);
-    digitalWrite(PIN_MOTOR, LOW);
-    
+void onFeedDone() {
     // 更新状态
     lastFeedTime = millis();
     feedCountToday++;
@@ -95,6 +109,30 @@ void feed(int duration = DEFAULT_FEED_DURATION) {
     reportStatus();
 }
 
+/**
+ * 执行投喂
+ * 
+ * 参数：
+ *   duration: 投喂时长（毫秒），控制投喂量
+ * 
+ * 说明：
+ *   电机在后台运行，到时自动关闭，期间主循环照常处理 MQTT。
+ * 
+ * 返回：
+ *   true 已开始投喂，false 上一次投喂尚未结束
+ */
+bool feed(int duration = DEFAULT_FEED_DURATION) {
+    // 限制投喂时长范围
+    duration = constrain(duration, MIN_FEED_DURATION, MAX_FEED_DURATION);
+    
+    if (!motor.runFor(duration, onFeedDone)) {
+        DEBUG_PRINTLN("正在投喂，忽略本次投喂");
+        return false;
+    }
+    DEBUG_PRINTF("开始投喂，时长: %d ms\n", duration);
+    return true;
+}
+
 /**
  * 读取余粮百分比
  * 
@@ -102,13 +140,37 @@ void feed(int duration = DEFAULT_FEED_DURATION) {
  *   余粮百分比（0-100）
  */
 int readFoodLevel() {
-    // 读取模拟值并转换为百分比
+    // 过采样并滤波后转换为百分比
     // 具体转换根据传感器类型调整
-    int rawValue = analogRead(PIN_FOOD_SENSOR);
+    int rawValue = foodSensor.sample();
     int level = map(rawValue, 0, 4095, 0, 100);
     return constrain(level, 0, 100);
 }
 
+/**
+ * 采样余粮，低于阈值时告警一次
+ * 
+ * 告警状态变化或余粮变化超过 FOOD_REPORT_DELTA 时提前上报，
+ * 两次提前上报至少间隔 STATUS_REPORT_MIN_INTERVAL。
+ */
+void sampleFoodLevel() {
+    foodLevel = readFoodLevel();
+    
+    bool low = foodLevelState.update(foodLevel) == 0;
+    bool changed = low != foodLowWarned;
+    if (low && !foodLowWarned) {
+        DEBUG_PRINTLN("警告：余粮不足！");
+        // TODO: 发送告警通知
+    }
+    foodLowWarned = low;
+    
+    if (changed || abs(foodLevel - reportedFoodLevel) >= FOOD_REPORT_DELTA) {
+        if (millis() - lastReportTime >= STATUS_REPORT_MIN_INTERVAL) {
+            reportStatus();
+        }
+    }
+}
+
 /**
  * 上报设备状态
  */
@@ -131,6 +193,8 @@ void reportStatus() {
     }
     
     mqtt.reportStatus(doc);
+    reportedFoodLevel = foodLevel;
+    lastReportTime = millis();
     DEBUG_PRINTLN("状态已上报");
 }
 
@@ -224,12 +288,9 @@ void setup() {
     Serial.begin(115200);
     DEBUG_PRINTLN("喂鱼器启动中...");
     
-    // 初始化引脚
-    pinMode(PIN_MOTOR, OUTPUT);
-    pinMode(PIN_FOOD_SENSOR, INPUT);
-    
-    // 默认关闭电机
-    digitalWrite(PIN_MOTOR, LOW);
+    // 初始化引脚，默认关闭电机
+    motor.begin();
+    foodSensor.begin();
     
     // 初始化定时任务
     for (int i = 0; i < MAX_SCHEDULES; i++) {
@@ -247,6 +308,12 @@ void setup() {
     // 初始化 MQTT
     mqtt.begin(MQTT_BROKER, MQTT_PORT, MQTT_USERNAME, MQTT_PASSWORD);
     mqtt.onControl(handleControl);
+    mqtt.setPayloadFormat(MQTT_PAYLOAD_FORMAT);
+    
+    // 周期作业
+    scheduler.every(FOOD_SAMPLE_INTERVAL, sampleFoodLevel, true);
+    scheduler.every(SCHEDULE_CHECK_INTERVAL, checkSchedules);
+    scheduler.every(STATUS_REPORT_INTERVAL, reportStatus);
     
     DEBUG_PRINTLN("喂鱼器启动完成");
 }
@@ -258,29 +325,16 @@ void loop() {
     // 保持 WiFi 连接
     WiFiManager::loop();
     
-    // 保持 MQTT 连接
+    // 保持 MQTT 连接，每轮都处理收到的消息
     mqtt.loop();
     
-    // 读取余粮
-    foodLevel = readFoodLevel();
+    // 电机到时关闭
+    motor.loop();
     
-    // 余粮不足告警（低于 20%）
-    if (foodLevel < 20) {
-        DEBUG_PRINTLN("警告：余粮不足！");
-        // TODO: 发送告警通知
-    }
-    
-    // 检查定时任务（每分钟检查一次）
-    if (millis() - lastScheduleCheck > 60000) {
-        checkSchedules();
-        lastScheduleCheck = millis();
-    }
-    
-    // 定时上报状态
-    if (millis() - lastStatusReport > STATUS_REPORT_INTERVAL) {
-        reportStatus();
-        lastStatusReport = millis();
-    }
+    // 余粮采样、定时投喂检查、状态上报
+    scheduler.loop();
     
-    delay(100);
+    // 休眠到下一个到期时刻，最长 LOOP_IDLE_MAX_MS
+    unsigned long idle = min(scheduler.idleTime(LOOP_IDLE_MAX_MS), motor.idleTime(LOOP_IDLE_MAX_MS));
+    delay(idle);
 }
@@ -21,13 +21,17 @@
 #include <ArduinoJson.h>
 #include "../common/config.h"
 #include "../common/wifi_manager.h"
-#include "../common/mqtt_client.h"
+#include "../common/device_link.h"
+#include "../common/scheduler.h"
+#include "../common/sensor.h"
 
 // ========== 设备配置 ==========
 // 设备唯一标识，每个设备必须不同
 #define DEVICE_ID "purifier_001"
 // 设备类型
 #define DEVICE_TYPE "purifier"
+// ESP-NOW 设备密钥（DEVICE_LINK 为 DEVICE_LINK_ESPNOW 时使用），由网关主密钥和 DEVICE_ID 派生
+const char ESPNOW_DEVICE_KEY[] = "";
 
 // WiFi 配置（根据实际情况修改）
 #define WIFI_SSID "your-wifi-ssid"
@@ -40,42 +44,83 @@
 #define PIN_HIGH_SPEED 18 // 高档
 #define PIN_PM25_SENSOR 34 // PM2.5 传感器
 
+// ========== 采样配置 ==========
+// PM2.5 采样间隔（毫秒）
+#define PM25_SAMPLE_INTERVAL 1000
+// 自动档位阈值（μg/m³）：低于 35 低档，35-75 中档，高于 75 高档
+#define PM25_MID_LEVEL 35
+#define PM25_HIGH_LEVEL 75
+// 自动档位回差（μg/m³），PM2.5 在阈值附近波动时不切换档位
+#define PM25_HYSTERESIS 5
+// PM2.5 变化超过该值时提前上报（μg/m³）
+#define PM25_REPORT_DELTA 10
+
 // ========== 设备状态 ==========
 // 电源状态：true=开启，false=关闭
 bool powerOn = false;
 // 当前档位：off/low/mid/high/auto
 String currentMode = "off";
+// 实际运行的档位：off/low/mid/high（自动档位下由 PM2.5 决定）
+String currentSpeed = "off";
 // PM2.5 数值
 int pm25Value = 0;
 // 滤芯使用时长（小时）
 int filterHours = 0;
+// 上次上报的 PM2.5 和上报时间，用于变化触发的上报
+int reportedPm25 = -1;
+unsigned long lastReportTime = 0;
+
+// 自动档位：按 PM2.5 分为三级，依次对应低/中/高档
+const int pm25Thresholds[] = {PM25_MID_LEVEL, PM25_HIGH_LEVEL};
+const char* const autoSpeeds[] = {"low", "mid", "high"};
 
 // ========== 全局对象 ==========
-MqttClientWrapper mqtt(DEVICE_ID, DEVICE_TYPE);
-unsigned long lastStatusReport = 0;
+DeviceLink mqtt(DEVICE_ID, DEVICE_TYPE);
+Scheduler scheduler;
+AnalogSensor pm25Sensor(PIN_PM25_SENSOR);
+LevelHysteresis pm25Level(pm25Thresholds, 2, PM25_HYSTERESIS);
+
+bool autoAdjustMode();
 
 /**
- * 设置档位
+ * 驱动档位继电器
  * 
  * 参数：
- *   mode: 档位名称（off/low/mid/high）
+ *   speed: 实际档位（off/low/mid/high）
  */
-void setMode(const String& mode) {
+void applySpeed(const String& speed) {
     // 先关闭所有档位
     digitalWrite(PIN_LOW_SPEED, LOW);
     digitalWrite(PIN_MID_SPEED, LOW);
     digitalWrite(PIN_HIGH_SPEED, LOW);
     
     // 设置对应档位
-    if (mode == "low") {
+    if (speed == "low") {
         digitalWrite(PIN_LOW_SPEED, HIGH);
-    } else if (mode == "mid") {
+    } else if (speed == "mid") {
         digitalWrite(PIN_MID_SPEED, HIGH);
-    } else if (mode == "high") {
+    } else if (speed == "high") {
         digitalWrite(PIN_HIGH_SPEED, HIGH);
     }
     
+    currentSpeed = speed;
+}
+
+/**
+ * 设置档位
+ * 
+ * 参数：
+ *   mode: 档位名称（off/low/mid/high/auto）
+ */
+void setMode(const String& mode) {
     currentMode = mode;
+    if (mode == "auto") {
+        // 按当前 PM2.5 重新分级，立即生效
+        pm25Level.reset();
+        autoAdjustMode();
+    } else {
+        applySpeed(mode);
+    }
     DEBUG_PRINTF("档位设置为: %s\n", mode.c_str());
 }
 
@@ -103,12 +148,12 @@ void powerOffDevice() {
  * 读取 PM2.5 数值
  * 
  * 返回：
- *   PM2.5 浓度（μg/m³）
+ *   滤波后的 PM2.5 浓度（μg/m³）
  */
 int readPM25() {
-    // 读取模拟值并转换为 PM2.5 浓度
+    // 过采样并滤波后转换为 PM2.5 浓度
     // 具体转换公式根据传感器型号调整
-    int rawValue = analogRead(PIN_PM25_SENSOR);
+    int rawValue = pm25Sensor.sample();
     int pm25 = map(rawValue, 0, 4095, 0, 500);
     return pm25;
 }
@@ -116,20 +161,39 @@ int readPM25() {
 /**
  * 自动档位调节
  * 
- * 根据 PM2.5 数值自动调节档位：
+ * 根据 PM2.5 数值自动调节档位，阈值两侧各留 PM25_HYSTERESIS 的回差：
  *   - PM2.5 < 35: 低档
  *   - PM2.5 35-75: 中档
  *   - PM2.5 > 75: 高档
+ * 
+ * 返回：
+ *   true 档位发生了切换
  */
-void autoAdjustMode() {
-    if (!powerOn || currentMode != "auto") return;
+bool autoAdjustMode() {
+    if (!powerOn || currentMode != "auto") return false;
     
-    if (pm25Value < 35) {
-        setMode("low");
-    } else if (pm25Value < 75) {
-        setMode("mid");
-    } else {
-        setMode("high");
+    const char* speed = autoSpeeds[pm25Level.update(pm25Value)];
+    if (currentSpeed == speed) return false;
+    
+    applySpeed(speed);
+    DEBUG_PRINTF("自动档位切换为: %s\n", speed);
+    return true;
+}
+
+/**
+ * 采样 PM2.5 并按需调节档位
+ * 
+ * 档位切换或 PM2.5 变化超过 PM25_REPORT_DELTA 时提前上报，
+ * 两次提前上报至少间隔 STATUS_REPORT_MIN_INTERVAL。
+ */
+void samplePM25() {
+    pm25Value = readPM25();
+    bool changed = autoAdjustMode();
+    
+    if (changed || abs(pm25Value - reportedPm25) >= PM25_REPORT_DELTA) {
+        if (millis() - lastReportTime >= STATUS_REPORT_MIN_INTERVAL) {
+            reportStatus();
+        }
     }
 }
 
@@ -144,6 +208,8 @@ void reportStatus() {
     doc["filter_hours"] = filterHours;
     
     mqtt.reportStatus(doc);
+    reportedPm25 = pm25Value;
+    lastReportTime = millis();
     DEBUG_PRINTLN("状态已上报");
 }
 
@@ -187,7 +253,7 @@ void setup() {
     pinMode(PIN_LOW_SPEED, OUTPUT);
     pinMode(PIN_MID_SPEED, OUTPUT);
     pinMode(PIN_HIGH_SPEED, OUTPUT);
-    pinMode(PIN_PM25_SENSOR, INPUT);
+    pm25Sensor.begin();
     
     // 默认关闭所有输出
     digitalWrite(PIN_POWER, LOW);
@@ -206,6 +272,11 @@ void setup() {
     // 初始化 MQTT
     mqtt.begin(MQTT_BROKER, MQTT_PORT, MQTT_USERNAME, MQTT_PASSWORD);
     mqtt.onControl(handleControl);
+    mqtt.setPayloadFormat(MQTT_PAYLOAD_FORMAT);
+    
+    // 周期作业
+    scheduler.every(PM25_SAMPLE_INTERVAL, samplePM25, true);
+    scheduler.every(STATUS_REPORT_INTERVAL, reportStatus);
     
     DEBUG_PRINTLN("净化器启动完成");
 }
@@ -217,20 +288,12 @@ void loop() {
     // 保持 WiFi 连接
     WiFiManager::loop();
     
-    // 保持 MQTT 连接
+    // 保持 MQTT 连接，每轮都处理收到的消息
     mqtt.loop();
     
-    // 读取 PM2.5
-    pm25Value = readPM25();
-    
-    // 自动档位调节
-    autoAdjustMode();
-    
-    // 定时上报状态
-    if (millis() - lastStatusReport > STATUS_REPORT_INTERVAL) {
-        reportStatus();
-        lastStatusReport = millis();
-    }
+    // PM2.5 采样与自动档位、状态上报
+    scheduler.loop();
     
-    delay(100);
+    // 休眠到下一个到期时刻，最长 LOOP_IDLE_MAX_MS
+    delay(scheduler.idleTime(LOOP_IDLE_MAX_MS));
 }
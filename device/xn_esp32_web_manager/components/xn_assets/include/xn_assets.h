@@ -0,0 +1,114 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-29 14:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-29 14:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_assets\include\xn_assets.h
+ * @Description: 分区图片组件 - 从 assets 数据分区内存映射读取预转换的 RGB565 图片，供 LVGL 直接绘制
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_ASSETS_H
+#define XN_ASSETS_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ *                          类型定义
+ *===========================================================================*/
+
+/**
+ * @brief 图片资源配置结构
+ */
+typedef struct {
+    const char *partition_label;    ///< 图片分区名（partitions.csv 中的 Name）
+} xn_assets_config_t;
+
+/**
+ * @brief 图片资源信息
+ */
+typedef struct {
+    uint32_t image_count;           ///< 图片数量
+    uint32_t image_size;            ///< 镜像大小（字节）
+    uint32_t pixel_bytes;           ///< 像素数据总字节数
+    uint32_t lookup_misses;         ///< 按名称查找失败次数
+} xn_assets_info_t;
+
+/*===========================================================================
+ *                          API
+ *===========================================================================*/
+
+/**
+ * @brief 获取默认配置
+ *
+ * @return xn_assets_config_t 默认配置
+ */
+xn_assets_config_t xn_assets_get_default_config(void);
+
+/**
+ * @brief 加载分区图片
+ *
+ * 执行流程：
+ * - 查找图片分区并整体内存映射（只占用 MMU 页，不占内部 RAM）
+ * - 校验镜像头和 CRC
+ * - 为每张图片生成指向映射地址的 lv_image_dsc_t
+ *
+ * 镜像由 tools/assets/build_assets.py 生成，像素已转换为显示的渲染格式
+ * （RGB565，带透明度的图片为 RGB565A8），LVGL 绘制时直接从 flash 拷贝，
+ * 不经过图片解码器，也不占用图片缓存。
+ *
+ * @param config 配置
+ * @return esp_err_t
+ *         - ESP_OK: 加载成功
+ *         - ESP_ERR_INVALID_ARG: 参数无效
+ *         - ESP_ERR_NOT_FOUND: 找不到图片分区
+ *         - ESP_ERR_INVALID_VERSION: 镜像版本不支持
+ *         - ESP_ERR_INVALID_CRC: 镜像为空或已损坏
+ *         - ESP_ERR_NO_MEM: 内存不足
+ */
+esp_err_t xn_assets_init(const xn_assets_config_t *config);
+
+/**
+ * @brief 卸载分区图片
+ *
+ * 调用前必须确保没有 LVGL 对象仍在使用其中的图片
+ *
+ * @return esp_err_t
+ *         - ESP_OK: 卸载成功
+ */
+esp_err_t xn_assets_deinit(void);
+
+/**
+ * @brief 按名称获取图片
+ *
+ * 名称为生成镜像时的文件名（不含扩展名）。返回的描述符在卸载前一直有效，
+ * 可直接传给 lv_image_set_src；加载后只读，可在任意任务中调用。
+ *
+ * @param name 图片名称
+ * @return const lv_image_dsc_t* 图片，未加载或不存在时返回 NULL
+ */
+const lv_image_dsc_t *xn_assets_get(const char *name);
+
+/**
+ * @brief 获取图片资源信息
+ *
+ * @param[out] info 输出信息
+ * @return esp_err_t
+ *         - ESP_OK: 成功
+ *         - ESP_ERR_INVALID_STATE: 未加载
+ *         - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t xn_assets_get_info(xn_assets_info_t *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XN_ASSETS_H */
@@ -0,0 +1,300 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-29 14:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-29 14:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_assets\src\xn_assets.c
+ * @Description: 分区图片组件实现 - 镜像格式见 tools/assets/build_assets.py
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "xn_assets.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+static const char *TAG = "xn_assets";
+
+/*===========================================================================
+ *                          镜像格式
+ *===========================================================================*/
+
+#define XN_ASSETS_MAGIC         "XNAS"      ///< 镜像魔数
+#define XN_ASSETS_VERSION       1           ///< 镜像版本
+#define XN_ASSETS_NAME_MAX      32          ///< 名称字段长度（含结束符）
+
+/**
+ * @brief 镜像文件头（32 字节）
+ */
+typedef struct __attribute__((packed)) {
+    char magic[4];                          ///< "XNAS"
+    uint16_t version;                       ///< 镜像版本
+    uint16_t flags;                         ///< 保留
+    uint32_t image_count;                   ///< 图片数量
+    uint32_t data_size;                     ///< 像素区大小
+    uint32_t crc32;                         ///< 图片表 + 像素区的 CRC32
+    uint32_t reserved[3];                   ///< 保留
+} xn_assets_header_t;
+
+/**
+ * @brief 图片表项（48 字节，按名称升序）
+ */
+typedef struct __attribute__((packed)) {
+    char name[XN_ASSETS_NAME_MAX];          ///< 名称，'\0' 填充
+    uint16_t width;                         ///< 宽度
+    uint16_t height;                        ///< 高度
+    uint8_t cf;                             ///< LVGL 颜色格式（LV_COLOR_FORMAT_RGB565 / RGB565A8）
+    uint8_t reserved;                       ///< 保留
+    uint16_t stride;                        ///< RGB565 平面行跨度（字节）
+    uint32_t offset;                        ///< 像素在像素区中的偏移（4 字节对齐）
+    uint32_t size;                          ///< 像素字节数
+} xn_assets_entry_t;
+
+_Static_assert(sizeof(xn_assets_header_t) == 32, "assets header must be 32 bytes");
+_Static_assert(sizeof(xn_assets_entry_t) == 48, "assets entry must be 48 bytes");
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+typedef struct {
+    bool initialized;                       ///< 初始化标志
+    esp_partition_mmap_handle_t mmap_handle;///< 映射句柄
+    uint32_t image_size;                    ///< 镜像大小
+    const xn_assets_header_t *header;       ///< 文件头（映射地址）
+    const xn_assets_entry_t *entries;       ///< 图片表（映射地址）
+    lv_image_dsc_t *images;                 ///< 与图片表一一对应的 LVGL 描述符
+    uint32_t lookup_misses;                 ///< 查找失败次数
+} xn_assets_ctx_t;
+
+static xn_assets_ctx_t s_ctx = {0};
+
+/*===========================================================================
+ *                          内部函数声明
+ *===========================================================================*/
+
+static bool entry_valid(const xn_assets_entry_t *e, uint32_t data_size);
+static int32_t entry_find(const char *name);
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+xn_assets_config_t xn_assets_get_default_config(void)
+{
+    xn_assets_config_t config = {
+        .partition_label = "assets",
+    };
+    return config;
+}
+
+esp_err_t xn_assets_init(const xn_assets_config_t *config)
+{
+    if (s_ctx.initialized) {
+        ESP_LOGW(TAG, "Assets already initialized");
+        return ESP_OK;
+    }
+
+    if (config == NULL || config->partition_label == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           ESP_PARTITION_SUBTYPE_ANY,
+                                                           config->partition_label);
+    if (part == NULL) {
+        ESP_LOGE(TAG, "Assets partition '%s' not found", config->partition_label);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // 整个分区映射到数据地址空间，LVGL 绘制时直接经 flash cache 读取像素
+    const void *image = NULL;
+    esp_err_t ret = esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA,
+                                       &image, &s_ctx.mmap_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to mmap assets partition: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // 校验文件头，未烧录的分区全为 0xFF
+    const xn_assets_header_t *header = (const xn_assets_header_t *)image;
+    if (part->size < sizeof(xn_assets_header_t) ||
+        memcmp(header->magic, XN_ASSETS_MAGIC, sizeof(header->magic)) != 0) {
+        ESP_LOGE(TAG, "Assets partition is empty or not an assets image");
+        ret = ESP_ERR_INVALID_CRC;
+        goto err;
+    }
+    if (header->version != XN_ASSETS_VERSION) {
+        ESP_LOGE(TAG, "Unsupported assets image version %u", header->version);
+        ret = ESP_ERR_INVALID_VERSION;
+        goto err;
+    }
+    uint64_t body_size = (uint64_t)header->image_count * sizeof(xn_assets_entry_t) + header->data_size;
+    if (sizeof(xn_assets_header_t) + body_size > part->size) {
+        ESP_LOGE(TAG, "Assets image larger than partition");
+        ret = ESP_ERR_INVALID_CRC;
+        goto err;
+    }
+    const uint8_t *body = (const uint8_t *)image + sizeof(xn_assets_header_t);
+    if (esp_rom_crc32_le(0, body, (uint32_t)body_size) != header->crc32) {
+        ESP_LOGE(TAG, "Assets image CRC mismatch");
+        ret = ESP_ERR_INVALID_CRC;
+        goto err;
+    }
+
+    const xn_assets_entry_t *entries = (const xn_assets_entry_t *)body;
+    const uint8_t *data = body + header->image_count * sizeof(xn_assets_entry_t);
+    for (uint32_t i = 0; i < header->image_count; i++) {
+        if (!entry_valid(&entries[i], header->data_size)) {
+            ESP_LOGE(TAG, "Invalid assets entry %lu", (unsigned long)i);
+            ret = ESP_ERR_INVALID_CRC;
+            goto err;
+        }
+    }
+
+    // 描述符放在 RAM 中，data 指向映射地址；像素格式与显示一致，绘制时不需要解码
+    s_ctx.images = calloc(header->image_count > 0 ? header->image_count : 1, sizeof(lv_image_dsc_t));
+    if (s_ctx.images == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate image descriptors");
+        ret = ESP_ERR_NO_MEM;
+        goto err;
+    }
+    uint32_t pixel_bytes = 0;
+    for (uint32_t i = 0; i < header->image_count; i++) {
+        const xn_assets_entry_t *e = &entries[i];
+        lv_image_dsc_t *dsc = &s_ctx.images[i];
+        dsc->header.magic = LV_IMAGE_HEADER_MAGIC;
+        dsc->header.cf = e->cf;
+        dsc->header.w = e->width;
+        dsc->header.h = e->height;
+        dsc->header.stride = e->stride;
+        dsc->data_size = e->size;
+        dsc->data = data + e->offset;
+        pixel_bytes += e->size;
+    }
+
+    s_ctx.header = header;
+    s_ctx.entries = entries;
+    s_ctx.image_size = sizeof(xn_assets_header_t) + (uint32_t)body_size;
+    s_ctx.lookup_misses = 0;
+    s_ctx.initialized = true;
+
+    ESP_LOGI(TAG, "Assets loaded: %lu images, %lu pixel bytes, image %lu bytes",
+             (unsigned long)header->image_count, (unsigned long)pixel_bytes,
+             (unsigned long)s_ctx.image_size);
+
+    return ESP_OK;
+
+err:
+    free(s_ctx.images);
+    s_ctx.images = NULL;
+    esp_partition_munmap(s_ctx.mmap_handle);
+    return ret;
+}
+
+esp_err_t xn_assets_deinit(void)
+{
+    if (!s_ctx.initialized) {
+        return ESP_OK;
+    }
+
+    s_ctx.initialized = false;
+    free(s_ctx.images);
+    s_ctx.images = NULL;
+    esp_partition_munmap(s_ctx.mmap_handle);
+
+    s_ctx.header = NULL;
+    s_ctx.entries = NULL;
+
+    return ESP_OK;
+}
+
+const lv_image_dsc_t *xn_assets_get(const char *name)
+{
+    if (!s_ctx.initialized || name == NULL) {
+        return NULL;
+    }
+
+    int32_t index = entry_find(name);
+    if (index < 0) {
+        s_ctx.lookup_misses++;  // 多任务并发时为近似值
+        ESP_LOGW(TAG, "Image '%s' not in assets partition", name);
+        return NULL;
+    }
+
+    return &s_ctx.images[index];
+}
+
+esp_err_t xn_assets_get_info(xn_assets_info_t *info)
+{
+    if (info == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    info->image_count = s_ctx.header->image_count;
+    info->image_size = s_ctx.image_size;
+    info->pixel_bytes = 0;
+    for (uint32_t i = 0; i < s_ctx.header->image_count; i++) {
+        info->pixel_bytes += s_ctx.entries[i].size;
+    }
+    info->lookup_misses = s_ctx.lookup_misses;
+
+    return ESP_OK;
+}
+
+/*===========================================================================
+ *                          内部函数实现
+ *===========================================================================*/
+
+/**
+ * @brief 检查图片表项：名称有结束符、格式受支持、像素大小与尺寸一致且不越界
+ */
+static bool entry_valid(const xn_assets_entry_t *e, uint32_t data_size)
+{
+    if (memchr(e->name, '\0', sizeof(e->name)) == NULL || e->width == 0 || e->height == 0 ||
+        e->stride < (uint32_t)e->width * 2 || (e->offset & 3) != 0) {
+        return false;
+    }
+
+    uint32_t expected = (uint32_t)e->stride * e->height;
+    if (e->cf == LV_COLOR_FORMAT_RGB565A8) {
+        expected += (uint32_t)(e->stride / 2) * e->height;  // A8 平面紧跟 RGB565 平面，行跨度为 stride / 2
+    } else if (e->cf != LV_COLOR_FORMAT_RGB565) {
+        return false;
+    }
+
+    return e->size == expected && (uint64_t)e->offset + e->size <= data_size;
+}
+
+/**
+ * @brief 在图片表中二分查找名称
+ *
+ * @return int32_t 图片表下标，未找到返回 -1
+ */
+static int32_t entry_find(const char *name)
+{
+    int32_t lo = 0;
+    int32_t hi = (int32_t)s_ctx.header->image_count - 1;
+
+    while (lo <= hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(s_ctx.entries[mid].name, name);
+        if (cmp == 0) {
+            return mid;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,184 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-25 16:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-25 16:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_audio\include\xn_audio.h
+ * @Description: 音频采集组件头文件 - I2S 麦克风采集、定点 VAD、零拷贝 PCM 帧池
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_AUDIO_H
+#define XN_AUDIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ *                          类型定义
+ *===========================================================================*/
+
+#define XN_AUDIO_MAX_CONSUMERS  4       ///< 最多注册的帧消费者数
+
+/**
+ * @brief PCM 帧（16 位单声道），来自固定大小的帧池
+ *
+ * 消费者回调返回后帧即被回收；需要在回调之外继续使用时先调用 xn_audio_frame_retain，
+ * 用完后 xn_audio_frame_release。帧内容只读。
+ */
+typedef struct {
+    const int16_t *pcm;                 ///< 采样数据
+    size_t samples;                     ///< 采样数
+    uint32_t seq;                       ///< 帧序号（丢帧时不连续）
+    int64_t timestamp_us;               ///< 帧内第一个采样的估计采集时间
+    uint32_t energy;                    ///< 帧能量（采样平方均值）
+    bool speech;                        ///< VAD 判定本帧处于语音段
+} xn_audio_frame_t;
+
+/**
+ * @brief 帧消费者回调（在采集任务中执行，耗时计入端到端延迟，不能阻塞）
+ */
+typedef void (*xn_audio_frame_cb_t)(const xn_audio_frame_t *frame, void *user_data);
+
+/**
+ * @brief 语音起止回调（在采集任务中执行）
+ * @param speech true 语音开始，false 语音结束
+ * @param duration_ms 语音结束时为语音段时长，开始时为0
+ */
+typedef void (*xn_audio_vad_cb_t)(bool speech, uint32_t duration_ms, void *user_data);
+
+/**
+ * @brief 采集统计
+ */
+typedef struct {
+    uint32_t frames;                    ///< 已分发帧数
+    uint32_t dropped;                   ///< 帧池耗尽丢弃的帧数
+    uint32_t dma_overflows;             ///< DMA 环形缓冲区溢出次数（采集任务来不及读取）
+    uint32_t latency_avg_us;            ///< 平均端到端延迟（DMA 写入到全部消费者处理完）
+    uint32_t latency_max_us;            ///< 最大端到端延迟
+    uint32_t consumer_max_us;           ///< 单帧消费者回调最大耗时
+    uint32_t latency_bound_us;          ///< 理论延迟上界：DMA 缓冲深度 + 一帧时长
+    uint32_t noise_floor;               ///< 当前噪声底（帧能量）
+} xn_audio_stats_t;
+
+/**
+ * @brief 音频采集配置
+ */
+typedef struct {
+    // I2S 配置
+    int i2s_port;                       ///< I2S 端口号
+    int pin_bclk;                       ///< BCLK 引脚
+    int pin_ws;                         ///< WS(LRCLK) 引脚
+    int pin_din;                        ///< 数据输入引脚
+    uint32_t sample_rate;               ///< 采样率（默认16000）
+    uint8_t sample_shift;               ///< 32 位槽数据右移位数转为 16 位（默认14，INMP441 等 24 位麦克风）
+    bool right_slot;                    ///< 麦克风 L/R 接高电平（右声道）
+
+    // 缓冲配置
+    uint16_t frame_ms;                  ///< 帧时长(ms)（默认20）
+    uint8_t dma_desc_num;               ///< DMA 描述符数（默认4），与 dma_frame_num 一起决定环形缓冲深度
+    uint16_t dma_frame_num;             ///< 每个 DMA 描述符的采样数（默认 1/2 帧）
+    uint8_t pool_frames;                ///< 帧池大小（默认8），决定消费者可持有的帧数
+
+    // 采集任务
+    int task_core;                      ///< 运行核心（默认0，tskNO_AFFINITY 不绑定）
+    uint8_t task_priority;              ///< 任务优先级（默认18，高于网络与界面）
+    uint32_t task_stack_size;           ///< 任务栈大小（默认4096）
+
+    // VAD 配置
+    uint32_t vad_min_energy;            ///< 语音最低能量（默认 2000，约 -57dBFS）
+    uint8_t vad_ratio;                  ///< 语音能量相对噪声底的倍数（默认4）
+    uint16_t vad_start_ms;              ///< 连续超过阈值多久判定开始（默认60）
+    uint16_t vad_hangover_ms;           ///< 连续低于阈值多久判定结束（默认500）
+    xn_audio_vad_cb_t vad_cb;           ///< 语音起止回调，可为NULL
+    void *vad_user_data;                ///< 语音起止回调用户数据
+} xn_audio_config_t;
+
+/*===========================================================================
+ *                          API
+ *===========================================================================*/
+
+/**
+ * @brief 获取默认配置（引脚需由调用者填写）
+ */
+xn_audio_config_t xn_audio_get_default_config(void);
+
+/**
+ * @brief 初始化音频采集：创建 I2S 通道、帧池与采集任务（不开始采集）
+ *
+ * @param config 配置
+ * @return esp_err_t
+ *      - ESP_OK: 成功
+ *      - ESP_ERR_INVALID_STATE: 已初始化
+ *      - ESP_ERR_INVALID_ARG: 配置无效
+ *      - ESP_ERR_NO_MEM: 内存不足
+ */
+esp_err_t xn_audio_init(const xn_audio_config_t *config);
+
+/**
+ * @brief 反初始化，停止采集并释放资源（消费者不得再持有帧）
+ */
+esp_err_t xn_audio_deinit(void);
+
+/**
+ * @brief 开始采集
+ */
+esp_err_t xn_audio_start(void);
+
+/**
+ * @brief 停止采集（语音段进行中时先上报语音结束）
+ */
+esp_err_t xn_audio_stop(void);
+
+/**
+ * @brief 注册帧消费者
+ *
+ * @param cb 帧回调
+ * @param user_data 用户数据
+ * @return esp_err_t ESP_ERR_NO_MEM 表示已达 XN_AUDIO_MAX_CONSUMERS
+ */
+esp_err_t xn_audio_register_consumer(xn_audio_frame_cb_t cb, void *user_data);
+
+/**
+ * @brief 注销帧消费者
+ */
+esp_err_t xn_audio_unregister_consumer(xn_audio_frame_cb_t cb, void *user_data);
+
+/**
+ * @brief 在回调之外继续持有帧（引用计数加一）
+ */
+void xn_audio_frame_retain(const xn_audio_frame_t *frame);
+
+/**
+ * @brief 释放持有的帧，最后一个引用释放时帧回到帧池（任意任务可调用）
+ */
+void xn_audio_frame_release(const xn_audio_frame_t *frame);
+
+/**
+ * @brief 当前是否处于语音段
+ */
+bool xn_audio_is_speech(void);
+
+/**
+ * @brief 读取采集统计
+ */
+esp_err_t xn_audio_get_stats(xn_audio_stats_t *stats);
+
+/**
+ * @brief 清零统计（延迟上界和噪声底保留）
+ */
+void xn_audio_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // XN_AUDIO_H
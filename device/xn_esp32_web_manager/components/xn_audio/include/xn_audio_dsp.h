@@ -0,0 +1,148 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-26 18:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-26 18:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_audio\include\xn_audio_dsp.h
+ * @Description: 音频 DSP 内核头文件 - FIR/抽取、双二阶 IIR、能量与格式转换
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_AUDIO_DSP_H
+#define XN_AUDIO_DSP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ *                          类型定义
+ *===========================================================================*/
+
+/*
+ * 开启 CONFIG_XN_AUDIO_DSP_SIMD 时滤波与浮点能量走 esp-dsp（S3 上为向量指令），
+ * 否则走可移植 C 实现。向量路径按 16 字节访问内存，输入输出缓冲区应使用
+ * heap_caps_aligned_alloc(16, ...) 分配，帧长取 4 的倍数。
+ */
+
+/**
+ * @brief FIR 滤波器（可带整数倍抽取），内部系数与延迟线按 16 字节对齐
+ */
+typedef struct xn_audio_fir xn_audio_fir_t;
+
+/**
+ * @brief 双二阶 IIR 滤波器，系数格式 {b0, b1, b2, a1, a2}（a0 归一化为1）
+ */
+typedef struct {
+    float coeffs[5];                    ///< 滤波器系数
+    float w[2];                         ///< 状态（直接 II 型）
+} xn_audio_biquad_t;
+
+/*===========================================================================
+ *                          滤波 API
+ *===========================================================================*/
+
+/**
+ * @brief 创建 FIR 滤波器
+ *
+ * @param coeffs 系数，coeffs[0] 作用于最新采样
+ * @param taps 抽头数（内部补零到 4 的倍数）
+ * @param decim 抽取倍数，1 为普通滤波
+ * @param[out] fir 滤波器句柄
+ * @return esp_err_t ESP_ERR_INVALID_ARG / ESP_ERR_NO_MEM
+ */
+esp_err_t xn_audio_fir_create(const float *coeffs, uint16_t taps, uint8_t decim, xn_audio_fir_t **fir);
+
+/**
+ * @brief 创建抽取滤波器（如 48k→16k），窗函数法低通，截止频率为输出奈奎斯特频率的 90%
+ *
+ * @param in_rate 输入采样率
+ * @param out_rate 输出采样率，in_rate 必须是其整数倍
+ * @param taps 抽头数（建议 16 x 抽取倍数）
+ * @param[out] fir 滤波器句柄
+ */
+esp_err_t xn_audio_fir_create_decimator(uint32_t in_rate, uint32_t out_rate, uint16_t taps,
+                                        xn_audio_fir_t **fir);
+
+/**
+ * @brief 删除 FIR 滤波器
+ */
+void xn_audio_fir_delete(xn_audio_fir_t *fir);
+
+/**
+ * @brief FIR 滤波（可原地处理）
+ *
+ * @param fir 滤波器
+ * @param in 输入
+ * @param out 输出，长度 in_len / decim
+ * @param in_len 输入采样数，必须是抽取倍数的整数倍
+ * @return int 输出采样数，参数错误返回 -1
+ */
+int xn_audio_fir_process(xn_audio_fir_t *fir, const float *in, float *out, size_t in_len);
+
+/**
+ * @brief 计算高通双二阶系数并清零状态（RBJ 公式）
+ *
+ * @param bq 滤波器
+ * @param freq_hz 截止频率
+ * @param sample_rate 采样率
+ * @param q 品质因数（0.707 为巴特沃斯）
+ */
+esp_err_t xn_audio_biquad_highpass(xn_audio_biquad_t *bq, float freq_hz, uint32_t sample_rate, float q);
+
+/**
+ * @brief 计算低通双二阶系数并清零状态（RBJ 公式）
+ */
+esp_err_t xn_audio_biquad_lowpass(xn_audio_biquad_t *bq, float freq_hz, uint32_t sample_rate, float q);
+
+/**
+ * @brief 双二阶滤波（可原地处理）
+ */
+void xn_audio_biquad_process(xn_audio_biquad_t *bq, const float *in, float *out, size_t len);
+
+/*===========================================================================
+ *                          能量与格式转换 API
+ *===========================================================================*/
+
+/**
+ * @brief int16 采样平方均值（与 xn_audio_frame_t.energy 同一量纲）
+ */
+uint32_t xn_audio_energy_s16(const int16_t *in, size_t len);
+
+/**
+ * @brief 浮点采样平方均值，RMS 为其平方根
+ */
+float xn_audio_energy_f32(const float *in, size_t len);
+
+/**
+ * @brief int16 转浮点（满量程对应 ±1.0）
+ */
+void xn_audio_s16_to_f32(const int16_t *in, float *out, size_t len);
+
+/**
+ * @brief 浮点转 int16（四舍五入，超出满量程时饱和）
+ */
+void xn_audio_f32_to_s16(const float *in, int16_t *out, size_t len);
+
+/**
+ * @brief 按帧长测量各内核的 CPU 周期数，分别给出 esp-dsp 与 C 实现的结果并打印到日志
+ *
+ * 需开启 CONFIG_XN_AUDIO_DSP_BENCHMARK，否则返回 ESP_ERR_NOT_SUPPORTED。
+ * 每个内核重复多次取最小值与平均值，同时给出占一帧时长的 CPU 比例。
+ *
+ * @param sample_rate 采样率（抽取内核的输入为其3倍）
+ * @param frame_ms 帧时长
+ */
+esp_err_t xn_audio_dsp_benchmark(uint32_t sample_rate, uint16_t frame_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // XN_AUDIO_DSP_H
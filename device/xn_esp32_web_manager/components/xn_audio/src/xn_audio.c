@@ -0,0 +1,653 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-25 16:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-25 16:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_audio\src\xn_audio.c
+ * @Description: 音频采集组件实现 - I2S DMA 环形缓冲读取、定点能量 VAD、引用计数帧池
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "xn_audio.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "driver/i2s_std.h"
+
+static const char *TAG = "xn_audio";
+
+/*
+ * 数据流：
+ *   麦克风 → I2S DMA 环形缓冲（dma_desc_num × dma_frame_num）→ 采集任务按帧读取
+ *   → 转为 16 位写入帧池中的空闲帧 → 计算能量并更新 VAD → 依次调用消费者 → 释放引用
+ *
+ * 延迟测量：DMA 接收中断累计写入字节数并记录时间，采集任务处理完一帧后，
+ * 用“最近一次 DMA 写入距今的时间 + 尚未读取的字节数对应的时长”得到本帧最后一个采样的年龄。
+ * 采集任务跟得上时延迟不超过 DMA 缓冲深度加一帧，超过时 DMA 溢出并计数。
+ */
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+/**
+ * @brief 帧池中的帧（对外结构必须在首位，句柄直接互转）
+ */
+typedef struct {
+    xn_audio_frame_t pub;               ///< 对外帧信息
+    int16_t *buf;                       ///< 采样缓冲区
+    uint8_t refs;                       ///< 引用计数（s_ctx.lock 保护）
+} frame_slot_t;
+
+/**
+ * @brief 帧消费者
+ */
+typedef struct {
+    xn_audio_frame_cb_t cb;             ///< 帧回调
+    void *user_data;                    ///< 用户数据
+} consumer_t;
+
+typedef struct {
+    bool initialized;                   ///< 初始化标志
+    volatile bool running;              ///< 采集中
+    volatile bool exit;                 ///< 采集任务退出请求
+    xn_audio_config_t config;           ///< 配置信息
+    size_t frame_samples;               ///< 每帧采样数
+    uint32_t byte_rate;                 ///< DMA 字节率（32 位槽）
+
+    i2s_chan_handle_t rx;               ///< I2S 接收通道
+    TaskHandle_t task;                  ///< 采集任务
+    SemaphoreHandle_t idle_sem;         ///< 采集任务空闲令牌（可用表示任务未在读取）
+    QueueHandle_t free_q;               ///< 空闲帧队列
+    frame_slot_t *slots;                ///< 帧池
+    int16_t *pcm_mem;                   ///< 帧池采样内存
+    int32_t *raw;                       ///< I2S 读取缓冲区（32 位槽数据）
+    consumer_t consumers[XN_AUDIO_MAX_CONSUMERS]; ///< 消费者表
+    portMUX_TYPE lock;                  ///< 引用计数、消费者表与 DMA 计数保护锁
+    uint32_t seq;                       ///< 下一帧序号
+
+    // DMA 进度（中断中更新）
+    volatile uint32_t dma_bytes;        ///< DMA 累计写入字节数
+    volatile int64_t dma_time_us;       ///< 最近一次 DMA 写入完成时间
+    volatile uint32_t dma_overflows;    ///< DMA 溢出次数
+    uint32_t read_bytes;                ///< 采集任务累计读取字节数
+
+    // VAD 状态（只在采集任务中访问）
+    volatile bool speech;               ///< 语音段进行中
+    uint32_t noise_floor;               ///< 噪声底
+    uint16_t above_ms;                  ///< 连续高于阈值的时长
+    uint16_t below_ms;                  ///< 连续低于阈值的时长
+    int64_t speech_start_us;            ///< 语音段起点
+
+    // 统计
+    uint32_t frames;                    ///< 已分发帧数
+    uint32_t dropped;                   ///< 丢弃帧数
+    uint64_t latency_total_us;          ///< 延迟累计
+    uint32_t latency_max_us;            ///< 最大延迟
+    uint32_t consumer_max_us;           ///< 消费者最大耗时
+} xn_audio_ctx_t;
+
+static xn_audio_ctx_t s_ctx = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+/*===========================================================================
+ *                          I2S 中断回调
+ *===========================================================================*/
+
+/**
+ * @brief DMA 接收完成：累计写入字节数并记录时间
+ */
+static IRAM_ATTR bool i2s_on_recv(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
+{
+    portENTER_CRITICAL_ISR(&s_ctx.lock);
+    s_ctx.dma_bytes += event->size;
+    s_ctx.dma_time_us = esp_timer_get_time();
+    portEXIT_CRITICAL_ISR(&s_ctx.lock);
+    return false;
+}
+
+/**
+ * @brief DMA 接收队列溢出：最旧的数据被覆盖
+ */
+static IRAM_ATTR bool i2s_on_recv_q_ovf(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
+{
+    s_ctx.dma_overflows++;
+    return false;
+}
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 计算本帧最后一个采样距今的时间
+ */
+static uint32_t sample_age_us(int64_t now_us)
+{
+    portENTER_CRITICAL(&s_ctx.lock);
+    uint32_t dma_bytes = s_ctx.dma_bytes;
+    int64_t dma_time_us = s_ctx.dma_time_us;
+    portEXIT_CRITICAL(&s_ctx.lock);
+
+    // DMA 溢出时被覆盖的数据永远不会被读取，积压不超过环形缓冲深度
+    uint32_t ring_bytes = (uint32_t)s_ctx.config.dma_desc_num * s_ctx.config.dma_frame_num * sizeof(int32_t);
+    uint32_t backlog = dma_bytes - s_ctx.read_bytes;
+    if (backlog > ring_bytes) {
+        s_ctx.read_bytes = dma_bytes - ring_bytes;
+        backlog = ring_bytes;
+    }
+    return (uint32_t)(now_us - dma_time_us) + (uint32_t)((uint64_t)backlog * 1000000 / s_ctx.byte_rate);
+}
+
+/**
+ * @brief 32 位槽数据转为 16 位并计算能量（dst 可与 raw 重叠）
+ */
+static uint32_t convert_frame(const int32_t *raw, int16_t *dst, size_t samples, uint8_t shift)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < samples; i++) {
+        int32_t s = raw[i] >> shift;
+        if (s > INT16_MAX) {
+            s = INT16_MAX;
+        } else if (s < INT16_MIN) {
+            s = INT16_MIN;
+        }
+        dst[i] = (int16_t)s;
+        sum += (uint64_t)((int64_t)s * s);
+    }
+    return (uint32_t)(sum / samples);
+}
+
+/**
+ * @brief 更新 VAD：自适应噪声底 + 起止时长滞回
+ * @return bool 本帧是否处于语音段
+ */
+static bool vad_update(uint32_t energy, int64_t frame_time_us)
+{
+    const xn_audio_config_t *cfg = &s_ctx.config;
+    uint64_t threshold = (uint64_t)s_ctx.noise_floor * cfg->vad_ratio;
+    if (threshold < cfg->vad_min_energy) {
+        threshold = cfg->vad_min_energy;
+    }
+
+    if (energy > threshold) {
+        s_ctx.above_ms += (s_ctx.above_ms < UINT16_MAX - cfg->frame_ms) ? cfg->frame_ms : 0;
+        s_ctx.below_ms = 0;
+        // 持续不变的背景噪声高于阈值时极慢地抬高噪声底（1/4096，约 20 秒后才会截断持续声音），避免语音段永不结束
+        s_ctx.noise_floor += (energy - s_ctx.noise_floor) >> 12;
+    } else {
+        s_ctx.below_ms += (s_ctx.below_ms < UINT16_MAX - cfg->frame_ms) ? cfg->frame_ms : 0;
+        s_ctx.above_ms = 0;
+        // 噪声底只在静音帧上学习：下降快（1/4），上升慢（1/64）
+        if (!s_ctx.speech) {
+            if (energy < s_ctx.noise_floor) {
+                s_ctx.noise_floor -= (s_ctx.noise_floor - energy) >> 2;
+            } else {
+                s_ctx.noise_floor += (energy - s_ctx.noise_floor) >> 6;
+            }
+        }
+    }
+
+    if (!s_ctx.speech && s_ctx.above_ms >= cfg->vad_start_ms) {
+        s_ctx.speech = true;
+        s_ctx.speech_start_us = frame_time_us - (int64_t)(s_ctx.above_ms - cfg->frame_ms) * 1000;
+        if (cfg->vad_cb) {
+            cfg->vad_cb(true, 0, cfg->vad_user_data);
+        }
+    } else if (s_ctx.speech && s_ctx.below_ms >= cfg->vad_hangover_ms) {
+        s_ctx.speech = false;
+        if (cfg->vad_cb) {
+            int64_t end_us = frame_time_us - (int64_t)(s_ctx.below_ms - cfg->frame_ms) * 1000;
+            cfg->vad_cb(false, (uint32_t)((end_us - s_ctx.speech_start_us) / 1000), cfg->vad_user_data);
+        }
+    }
+    return s_ctx.speech;
+}
+
+/**
+ * @brief 停止采集时结束进行中的语音段
+ */
+static void vad_flush(void)
+{
+    if (s_ctx.speech) {
+        s_ctx.speech = false;
+        if (s_ctx.config.vad_cb) {
+            uint32_t duration = (uint32_t)((esp_timer_get_time() - s_ctx.speech_start_us) / 1000);
+            s_ctx.config.vad_cb(false, duration, s_ctx.config.vad_user_data);
+        }
+    }
+    s_ctx.above_ms = 0;
+    s_ctx.below_ms = 0;
+}
+
+/**
+ * @brief 把帧分发给全部消费者
+ */
+static void dispatch_frame(frame_slot_t *slot)
+{
+    consumer_t consumers[XN_AUDIO_MAX_CONSUMERS];
+    portENTER_CRITICAL(&s_ctx.lock);
+    memcpy(consumers, s_ctx.consumers, sizeof(consumers));
+    portEXIT_CRITICAL(&s_ctx.lock);
+
+    for (int i = 0; i < XN_AUDIO_MAX_CONSUMERS; i++) {
+        if (consumers[i].cb == NULL) {
+            continue;
+        }
+        int64_t start_us = esp_timer_get_time();
+        consumers[i].cb(&slot->pub, consumers[i].user_data);
+        uint32_t cost_us = (uint32_t)(esp_timer_get_time() - start_us);
+        if (cost_us > s_ctx.consumer_max_us) {
+            s_ctx.consumer_max_us = cost_us;
+        }
+    }
+}
+
+/**
+ * @brief 采集任务
+ */
+static void capture_task(void *arg)
+{
+    const size_t frame_bytes = s_ctx.frame_samples * sizeof(int32_t);
+    const uint32_t frame_us = (uint32_t)s_ctx.config.frame_ms * 1000;
+
+    for (;;) {
+        if (!s_ctx.running) {
+            vad_flush();
+            xSemaphoreGive(s_ctx.idle_sem);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            if (s_ctx.exit) {
+                break;
+            }
+            continue;
+        }
+
+        // 读满一帧；停止时最多等待几帧时长后返回
+        size_t got = 0;
+        esp_err_t ret = i2s_channel_read(s_ctx.rx, s_ctx.raw, frame_bytes, &got,
+                                         pdMS_TO_TICKS(s_ctx.config.frame_ms * 4));
+        if (ret != ESP_OK || got != frame_bytes) {
+            continue;
+        }
+        s_ctx.read_bytes += got;
+
+        int64_t read_us = esp_timer_get_time();
+        int64_t frame_time_us = read_us - sample_age_us(read_us) - frame_us;
+
+        // 帧池耗尽时原地转换，只用于 VAD，不分发
+        frame_slot_t *slot = NULL;
+        xQueueReceive(s_ctx.free_q, &slot, 0);
+        int16_t *dst = slot ? slot->buf : (int16_t *)s_ctx.raw;
+        uint32_t energy = convert_frame(s_ctx.raw, dst, s_ctx.frame_samples, s_ctx.config.sample_shift);
+        bool speech = vad_update(energy, frame_time_us);
+
+        if (slot == NULL) {
+            s_ctx.dropped++;
+            s_ctx.seq++;
+            continue;
+        }
+
+        slot->pub.samples = s_ctx.frame_samples;
+        slot->pub.seq = s_ctx.seq++;
+        slot->pub.timestamp_us = frame_time_us;
+        slot->pub.energy = energy;
+        slot->pub.speech = speech;
+        slot->refs = 1;
+        dispatch_frame(slot);
+        xn_audio_frame_release(&slot->pub);
+
+        uint32_t latency_us = sample_age_us(esp_timer_get_time());
+        s_ctx.frames++;
+        s_ctx.latency_total_us += latency_us;
+        if (latency_us > s_ctx.latency_max_us) {
+            s_ctx.latency_max_us = latency_us;
+        }
+    }
+
+    xSemaphoreGive(s_ctx.idle_sem);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 创建并配置 I2S 接收通道
+ */
+static esp_err_t i2s_rx_init(void)
+{
+    const xn_audio_config_t *cfg = &s_ctx.config;
+
+    i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG((i2s_port_t)cfg->i2s_port, I2S_ROLE_MASTER);
+    chan_cfg.dma_desc_num = cfg->dma_desc_num;
+    chan_cfg.dma_frame_num = cfg->dma_frame_num;
+    esp_err_t ret = i2s_new_channel(&chan_cfg, NULL, &s_ctx.rx);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    i2s_std_config_t std_cfg = {
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(cfg->sample_rate),
+        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_32BIT, I2S_SLOT_MODE_MONO),
+        .gpio_cfg = {
+            .mclk = I2S_GPIO_UNUSED,
+            .bclk = cfg->pin_bclk,
+            .ws = cfg->pin_ws,
+            .dout = I2S_GPIO_UNUSED,
+            .din = cfg->pin_din,
+        },
+    };
+    std_cfg.slot_cfg.slot_mask = cfg->right_slot ? I2S_STD_SLOT_RIGHT : I2S_STD_SLOT_LEFT;
+    ret = i2s_channel_init_std_mode(s_ctx.rx, &std_cfg);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    i2s_event_callbacks_t cbs = {
+        .on_recv = i2s_on_recv,
+        .on_recv_q_ovf = i2s_on_recv_q_ovf,
+    };
+    return i2s_channel_register_event_callback(s_ctx.rx, &cbs, NULL);
+}
+
+/**
+ * @brief 分配帧池
+ */
+static esp_err_t pool_init(void)
+{
+    uint8_t n = s_ctx.config.pool_frames;
+
+    s_ctx.slots = calloc(n, sizeof(frame_slot_t));
+    s_ctx.pcm_mem = malloc(n * s_ctx.frame_samples * sizeof(int16_t));
+    s_ctx.raw = malloc(s_ctx.frame_samples * sizeof(int32_t));
+    s_ctx.free_q = xQueueCreate(n, sizeof(frame_slot_t *));
+    if (s_ctx.slots == NULL || s_ctx.pcm_mem == NULL || s_ctx.raw == NULL || s_ctx.free_q == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (uint8_t i = 0; i < n; i++) {
+        frame_slot_t *slot = &s_ctx.slots[i];
+        slot->buf = s_ctx.pcm_mem + (size_t)i * s_ctx.frame_samples;
+        slot->pub.pcm = slot->buf;
+        xQueueSend(s_ctx.free_q, &slot, 0);
+    }
+    return ESP_OK;
+}
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+xn_audio_config_t xn_audio_get_default_config(void)
+{
+    xn_audio_config_t config = {
+        .i2s_port = 0,
+        .pin_bclk = -1,
+        .pin_ws = -1,
+        .pin_din = -1,
+        .sample_rate = 16000,
+        .sample_shift = 14,
+        .right_slot = false,
+        .frame_ms = 20,
+        .dma_desc_num = 4,
+        .dma_frame_num = 0,
+        .pool_frames = 8,
+        .task_core = 0,
+        .task_priority = 18,
+        .task_stack_size = 4096,
+        .vad_min_energy = 2000,
+        .vad_ratio = 4,
+        .vad_start_ms = 60,
+        .vad_hangover_ms = 500,
+        .vad_cb = NULL,
+        .vad_user_data = NULL,
+    };
+    return config;
+}
+
+esp_err_t xn_audio_init(const xn_audio_config_t *config)
+{
+    if (s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (config == NULL || config->pin_bclk < 0 || config->pin_ws < 0 || config->pin_din < 0 ||
+        config->sample_rate == 0 || config->frame_ms == 0 || config->pool_frames == 0 ||
+        config->dma_desc_num < 2 || config->sample_shift > 16) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_ctx.config = *config;
+    s_ctx.frame_samples = (size_t)config->sample_rate * config->frame_ms / 1000;
+    s_ctx.byte_rate = config->sample_rate * sizeof(int32_t);
+    if (s_ctx.config.dma_frame_num == 0) {
+        s_ctx.config.dma_frame_num = s_ctx.frame_samples / 2;
+    }
+    // 单个 DMA 描述符最多 4092 字节
+    if (s_ctx.frame_samples == 0 || s_ctx.config.dma_frame_num * sizeof(int32_t) > 4092) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = pool_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to allocate frame pool");
+        goto err;
+    }
+
+    ret = i2s_rx_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to init I2S: %s", esp_err_to_name(ret));
+        goto err;
+    }
+
+    // 空闲令牌由采集任务启动后给出
+    s_ctx.idle_sem = xSemaphoreCreateBinary();
+    if (s_ctx.idle_sem == NULL) {
+        ret = ESP_ERR_NO_MEM;
+        goto err;
+    }
+
+    s_ctx.running = false;
+    s_ctx.exit = false;
+    s_ctx.noise_floor = config->vad_min_energy / (config->vad_ratio ? config->vad_ratio : 1);
+    if (xTaskCreatePinnedToCore(capture_task, "audio_cap", config->task_stack_size, NULL,
+                                config->task_priority, &s_ctx.task, config->task_core) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create capture task");
+        ret = ESP_ERR_NO_MEM;
+        goto err;
+    }
+
+    s_ctx.initialized = true;
+    ESP_LOGI(TAG, "Audio initialized: %u Hz, %u ms frames, latency bound %u us",
+             (unsigned)config->sample_rate, (unsigned)config->frame_ms,
+             (unsigned)((uint64_t)s_ctx.config.dma_desc_num * s_ctx.config.dma_frame_num * 1000000 /
+                        config->sample_rate + config->frame_ms * 1000));
+    return ESP_OK;
+
+err:
+    s_ctx.initialized = true;
+    xn_audio_deinit();
+    return ret;
+}
+
+esp_err_t xn_audio_deinit(void)
+{
+    if (!s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xn_audio_stop();
+    if (s_ctx.task) {
+        // 等待任务空闲后请求退出，退出前再次给出令牌
+        xSemaphoreTake(s_ctx.idle_sem, portMAX_DELAY);
+        s_ctx.exit = true;
+        xTaskNotifyGive(s_ctx.task);
+        xSemaphoreTake(s_ctx.idle_sem, portMAX_DELAY);
+        s_ctx.task = NULL;
+    }
+    if (s_ctx.idle_sem) {
+        vSemaphoreDelete(s_ctx.idle_sem);
+        s_ctx.idle_sem = NULL;
+    }
+    if (s_ctx.rx) {
+        i2s_del_channel(s_ctx.rx);
+        s_ctx.rx = NULL;
+    }
+    if (s_ctx.free_q) {
+        vQueueDelete(s_ctx.free_q);
+        s_ctx.free_q = NULL;
+    }
+    free(s_ctx.slots);
+    free(s_ctx.pcm_mem);
+    free(s_ctx.raw);
+    s_ctx.slots = NULL;
+    s_ctx.pcm_mem = NULL;
+    s_ctx.raw = NULL;
+    memset(s_ctx.consumers, 0, sizeof(s_ctx.consumers));
+    s_ctx.initialized = false;
+    return ESP_OK;
+}
+
+esp_err_t xn_audio_start(void)
+{
+    if (!s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_ctx.running) {
+        return ESP_OK;
+    }
+
+    // 取走空闲令牌：任务此时一定阻塞在通知上
+    xSemaphoreTake(s_ctx.idle_sem, portMAX_DELAY);
+    esp_err_t ret = i2s_channel_enable(s_ctx.rx);
+    if (ret != ESP_OK) {
+        xSemaphoreGive(s_ctx.idle_sem);
+        return ret;
+    }
+
+    portENTER_CRITICAL(&s_ctx.lock);
+    s_ctx.dma_bytes = 0;
+    s_ctx.dma_time_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&s_ctx.lock);
+    s_ctx.read_bytes = 0;
+    s_ctx.running = true;
+    xTaskNotifyGive(s_ctx.task);
+    return ESP_OK;
+}
+
+esp_err_t xn_audio_stop(void)
+{
+    if (!s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!s_ctx.running) {
+        return ESP_OK;
+    }
+
+    // 等任务退出读取循环后才能关闭通道
+    s_ctx.running = false;
+    xSemaphoreTake(s_ctx.idle_sem, portMAX_DELAY);
+    i2s_channel_disable(s_ctx.rx);
+    xSemaphoreGive(s_ctx.idle_sem);
+    return ESP_OK;
+}
+
+esp_err_t xn_audio_register_consumer(xn_audio_frame_cb_t cb, void *user_data)
+{
+    if (cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    portENTER_CRITICAL(&s_ctx.lock);
+    for (int i = 0; i < XN_AUDIO_MAX_CONSUMERS; i++) {
+        if (s_ctx.consumers[i].cb == NULL) {
+            s_ctx.consumers[i].cb = cb;
+            s_ctx.consumers[i].user_data = user_data;
+            ret = ESP_OK;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_ctx.lock);
+    return ret;
+}
+
+esp_err_t xn_audio_unregister_consumer(xn_audio_frame_cb_t cb, void *user_data)
+{
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    portENTER_CRITICAL(&s_ctx.lock);
+    for (int i = 0; i < XN_AUDIO_MAX_CONSUMERS; i++) {
+        if (s_ctx.consumers[i].cb == cb && s_ctx.consumers[i].user_data == user_data) {
+            s_ctx.consumers[i].cb = NULL;
+            s_ctx.consumers[i].user_data = NULL;
+            ret = ESP_OK;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_ctx.lock);
+    return ret;
+}
+
+void xn_audio_frame_retain(const xn_audio_frame_t *frame)
+{
+    if (frame == NULL) {
+        return;
+    }
+    frame_slot_t *slot = (frame_slot_t *)frame;
+    portENTER_CRITICAL(&s_ctx.lock);
+    slot->refs++;
+    portEXIT_CRITICAL(&s_ctx.lock);
+}
+
+void xn_audio_frame_release(const xn_audio_frame_t *frame)
+{
+    if (frame == NULL) {
+        return;
+    }
+    frame_slot_t *slot = (frame_slot_t *)frame;
+    portENTER_CRITICAL(&s_ctx.lock);
+    uint8_t refs = --slot->refs;
+    portEXIT_CRITICAL(&s_ctx.lock);
+    if (refs == 0) {
+        xQueueSend(s_ctx.free_q, &slot, 0);
+    }
+}
+
+bool xn_audio_is_speech(void)
+{
+    return s_ctx.speech;
+}
+
+esp_err_t xn_audio_get_stats(xn_audio_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    stats->frames = s_ctx.frames;
+    stats->dropped = s_ctx.dropped;
+    stats->dma_overflows = s_ctx.dma_overflows;
+    stats->latency_avg_us = s_ctx.frames ? (uint32_t)(s_ctx.latency_total_us / s_ctx.frames) : 0;
+    stats->latency_max_us = s_ctx.latency_max_us;
+    stats->consumer_max_us = s_ctx.consumer_max_us;
+    stats->latency_bound_us = (uint32_t)((uint64_t)s_ctx.config.dma_desc_num * s_ctx.config.dma_frame_num *
+                                         1000000 / s_ctx.config.sample_rate) + s_ctx.config.frame_ms * 1000;
+    stats->noise_floor = s_ctx.noise_floor;
+    return ESP_OK;
+}
+
+void xn_audio_reset_stats(void)
+{
+    s_ctx.frames = 0;
+    s_ctx.dropped = 0;
+    s_ctx.dma_overflows = 0;
+    s_ctx.latency_total_us = 0;
+    s_ctx.latency_max_us = 0;
+    s_ctx.consumer_max_us = 0;
+}
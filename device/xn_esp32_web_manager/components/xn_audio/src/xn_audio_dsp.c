@@ -0,0 +1,478 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-26 18:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-26 18:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_audio\src\xn_audio_dsp.c
+ * @Description: 音频 DSP 内核实现 - esp-dsp 向量路径与可移植 C 路径
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "xn_audio_dsp.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "sdkconfig.h"
+
+#if CONFIG_XN_AUDIO_DSP_SIMD
+#include "esp_dsp.h"
+#endif
+
+#if CONFIG_XN_AUDIO_DSP_BENCHMARK
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#endif
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+#define DSP_ALIGN               16      ///< 向量指令访问对齐
+
+#if CONFIG_XN_AUDIO_DSP_SIMD
+#define DSP_USE_SIMD            true    ///< 默认实现路径
+#else
+#define DSP_USE_SIMD            false
+#endif
+
+// 只有 C 路径或基准测试用到的内核
+#define DSP_NEED_C_KERNELS      (!CONFIG_XN_AUDIO_DSP_SIMD || CONFIG_XN_AUDIO_DSP_BENCHMARK)
+
+/**
+ * @brief FIR 滤波器
+ *
+ * 系数按 esp-dsp 的顺序存放：coeffs[0] 作用于最旧采样（即用户系数逆序），
+ * 补零的抽头位于最旧一端，不引入额外延迟。两条路径共用系数与延迟线布局。
+ */
+struct xn_audio_fir {
+    float *coeffs;                      ///< 逆序系数（taps 个）
+    float *delay;                       ///< 延迟线（taps + 4 个，多出的部分供向量实现越界读取）
+    uint16_t taps;                      ///< 补齐到 4 的倍数后的抽头数
+    uint8_t decim;                      ///< 抽取倍数
+    uint16_t pos;                       ///< C 路径：下一个写入位置（即最旧采样）
+    bool simd;                          ///< 使用 esp-dsp 路径
+#if CONFIG_XN_AUDIO_DSP_SIMD
+    fir_f32_t dsp;                      ///< esp-dsp 滤波器状态
+#endif
+};
+
+/*===========================================================================
+ *                          C 实现
+ *===========================================================================*/
+
+/**
+ * @brief FIR/抽取滤波 C 实现：每输出一个采样先写入 decim 个输入
+ */
+static int fir_process_c(xn_audio_fir_t *fir, const float *in, float *out, int out_len)
+{
+    for (int i = 0; i < out_len; i++) {
+        for (int d = 0; d < fir->decim; d++) {
+            fir->delay[fir->pos] = *in++;
+            fir->pos = (fir->pos + 1 == fir->taps) ? 0 : fir->pos + 1;
+        }
+
+        // pos 指向最旧采样，与逆序系数逐项相乘
+        float acc = 0;
+        int k = 0;
+        for (int n = fir->pos; n < fir->taps; n++) {
+            acc += fir->coeffs[k++] * fir->delay[n];
+        }
+        for (int n = 0; n < fir->pos; n++) {
+            acc += fir->coeffs[k++] * fir->delay[n];
+        }
+        out[i] = acc;
+    }
+    return out_len;
+}
+
+#if DSP_NEED_C_KERNELS
+/**
+ * @brief 双二阶滤波 C 实现（直接 II 型，与 esp-dsp 状态格式一致）
+ */
+static void biquad_process_c(const float *in, float *out, size_t len, const float *coeffs, float *w)
+{
+    for (size_t i = 0; i < len; i++) {
+        float d0 = in[i] - coeffs[3] * w[0] - coeffs[4] * w[1];
+        out[i] = coeffs[0] * d0 + coeffs[1] * w[0] + coeffs[2] * w[1];
+        w[1] = w[0];
+        w[0] = d0;
+    }
+}
+
+/**
+ * @brief 浮点平方和 C 实现
+ */
+static float sum_squares_c(const float *in, size_t len)
+{
+    float acc = 0;
+    for (size_t i = 0; i < len; i++) {
+        acc += in[i] * in[i];
+    }
+    return acc;
+}
+#endif
+
+/*===========================================================================
+ *                          滤波 API 实现
+ *===========================================================================*/
+
+/**
+ * @brief 创建滤波器并选择实现路径
+ */
+static esp_err_t fir_create(const float *coeffs, uint16_t taps, uint8_t decim, bool simd, xn_audio_fir_t **out)
+{
+    if (coeffs == NULL || taps == 0 || decim == 0 || out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xn_audio_fir_t *fir = calloc(1, sizeof(xn_audio_fir_t));
+    if (fir == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    fir->taps = (taps + 3) & ~3;
+    fir->decim = decim;
+    fir->simd = simd;
+    fir->coeffs = heap_caps_aligned_calloc(DSP_ALIGN, fir->taps, sizeof(float), MALLOC_CAP_DEFAULT);
+    fir->delay = heap_caps_aligned_calloc(DSP_ALIGN, fir->taps + 4, sizeof(float), MALLOC_CAP_DEFAULT);
+    if (fir->coeffs == NULL || fir->delay == NULL) {
+        xn_audio_fir_delete(fir);
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (uint16_t k = 0; k < taps; k++) {
+        fir->coeffs[fir->taps - 1 - k] = coeffs[k];
+    }
+
+#if CONFIG_XN_AUDIO_DSP_SIMD
+    if (simd) {
+        esp_err_t ret = (decim == 1)
+                        ? dsps_fir_init_f32(&fir->dsp, fir->coeffs, fir->delay, fir->taps)
+                        : dsps_fird_init_f32(&fir->dsp, fir->coeffs, fir->delay, fir->taps, decim);
+        if (ret != ESP_OK) {
+            xn_audio_fir_delete(fir);
+            return ret;
+        }
+    }
+#endif
+
+    *out = fir;
+    return ESP_OK;
+}
+
+esp_err_t xn_audio_fir_create(const float *coeffs, uint16_t taps, uint8_t decim, xn_audio_fir_t **fir)
+{
+    return fir_create(coeffs, taps, decim, DSP_USE_SIMD, fir);
+}
+
+/**
+ * @brief 窗函数法（Hamming）低通系数，直流增益归一化为1
+ */
+static float *lowpass_coeffs(uint32_t in_rate, uint32_t out_rate, uint16_t taps)
+{
+    float *h = malloc(taps * sizeof(float));
+    if (h == NULL) {
+        return NULL;
+    }
+
+    float fc = 0.45f * (float)out_rate / (float)in_rate;
+    float center = (taps - 1) / 2.0f;
+    float sum = 0;
+    for (uint16_t i = 0; i < taps; i++) {
+        float t = i - center;
+        float sinc = (t == 0) ? 2 * fc : sinf(2 * (float)M_PI * fc * t) / ((float)M_PI * t);
+        float window = (taps > 1) ? 0.54f - 0.46f * cosf(2 * (float)M_PI * i / (taps - 1)) : 1.0f;
+        h[i] = sinc * window;
+        sum += h[i];
+    }
+    for (uint16_t i = 0; i < taps; i++) {
+        h[i] /= sum;
+    }
+    return h;
+}
+
+static esp_err_t decimator_create(uint32_t in_rate, uint32_t out_rate, uint16_t taps, bool simd,
+                                  xn_audio_fir_t **fir)
+{
+    if (out_rate == 0 || in_rate % out_rate != 0 || in_rate / out_rate > UINT8_MAX || taps == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    float *h = lowpass_coeffs(in_rate, out_rate, taps);
+    if (h == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t ret = fir_create(h, taps, (uint8_t)(in_rate / out_rate), simd, fir);
+    free(h);
+    return ret;
+}
+
+esp_err_t xn_audio_fir_create_decimator(uint32_t in_rate, uint32_t out_rate, uint16_t taps,
+                                        xn_audio_fir_t **fir)
+{
+    return decimator_create(in_rate, out_rate, taps, DSP_USE_SIMD, fir);
+}
+
+void xn_audio_fir_delete(xn_audio_fir_t *fir)
+{
+    if (fir == NULL) {
+        return;
+    }
+    heap_caps_free(fir->coeffs);
+    heap_caps_free(fir->delay);
+    free(fir);
+}
+
+int xn_audio_fir_process(xn_audio_fir_t *fir, const float *in, float *out, size_t in_len)
+{
+    if (fir == NULL || in == NULL || out == NULL || in_len % fir->decim != 0) {
+        return -1;
+    }
+
+    int out_len = (int)(in_len / fir->decim);
+#if CONFIG_XN_AUDIO_DSP_SIMD
+    if (fir->simd) {
+        if (fir->decim == 1) {
+            dsps_fir_f32(&fir->dsp, in, out, out_len);
+            return out_len;
+        }
+        // esp-dsp 1.5 起 len 为输出采样数
+        return dsps_fird_f32(&fir->dsp, in, out, out_len);
+    }
+#endif
+    return fir_process_c(fir, in, out, out_len);
+}
+
+/**
+ * @brief RBJ 双二阶系数：高通与低通只有分子不同
+ */
+static esp_err_t biquad_design(xn_audio_biquad_t *bq, float freq_hz, uint32_t sample_rate, float q, bool highpass)
+{
+    if (bq == NULL || sample_rate == 0 || freq_hz <= 0 || freq_hz >= sample_rate / 2.0f || q <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    float w0 = 2 * (float)M_PI * freq_hz / (float)sample_rate;
+    float c = cosf(w0);
+    float alpha = sinf(w0) / (2 * q);
+    float a0 = 1 + alpha;
+
+    float b1 = highpass ? -(1 + c) : (1 - c);
+    bq->coeffs[0] = fabsf(b1) / 2 / a0;
+    bq->coeffs[1] = b1 / a0;
+    bq->coeffs[2] = bq->coeffs[0];
+    bq->coeffs[3] = -2 * c / a0;
+    bq->coeffs[4] = (1 - alpha) / a0;
+    bq->w[0] = 0;
+    bq->w[1] = 0;
+    return ESP_OK;
+}
+
+esp_err_t xn_audio_biquad_highpass(xn_audio_biquad_t *bq, float freq_hz, uint32_t sample_rate, float q)
+{
+    return biquad_design(bq, freq_hz, sample_rate, q, true);
+}
+
+esp_err_t xn_audio_biquad_lowpass(xn_audio_biquad_t *bq, float freq_hz, uint32_t sample_rate, float q)
+{
+    return biquad_design(bq, freq_hz, sample_rate, q, false);
+}
+
+void xn_audio_biquad_process(xn_audio_biquad_t *bq, const float *in, float *out, size_t len)
+{
+#if CONFIG_XN_AUDIO_DSP_SIMD
+    dsps_biquad_f32(in, out, (int)len, bq->coeffs, bq->w);
+#else
+    biquad_process_c(in, out, len, bq->coeffs, bq->w);
+#endif
+}
+
+/*===========================================================================
+ *                          能量与格式转换 API 实现
+ *===========================================================================*/
+
+uint32_t xn_audio_energy_s16(const int16_t *in, size_t len)
+{
+    if (len == 0) {
+        return 0;
+    }
+
+    // esp-dsp 的 int16 点积结果为 16 位，放不下平方和；这里用 64 位累加
+    uint64_t acc = 0;
+    for (size_t i = 0; i < len; i++) {
+        acc += (uint32_t)((int32_t)in[i] * in[i]);
+    }
+    return (uint32_t)(acc / len);
+}
+
+float xn_audio_energy_f32(const float *in, size_t len)
+{
+    if (len == 0) {
+        return 0;
+    }
+
+#if CONFIG_XN_AUDIO_DSP_SIMD
+    float acc = 0;
+    dsps_dotprod_f32(in, in, &acc, (int)len);
+#else
+    float acc = sum_squares_c(in, len);
+#endif
+    return acc / (float)len;
+}
+
+void xn_audio_s16_to_f32(const int16_t *in, float *out, size_t len)
+{
+    const float scale = 1.0f / 32768.0f;
+    for (size_t i = 0; i < len; i++) {
+        out[i] = in[i] * scale;
+    }
+}
+
+void xn_audio_f32_to_s16(const float *in, int16_t *out, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        float v = in[i] * 32768.0f;
+        if (v >= 32767.0f) {
+            out[i] = INT16_MAX;
+        } else if (v <= -32768.0f) {
+            out[i] = INT16_MIN;
+        } else {
+            out[i] = (int16_t)lrintf(v);
+        }
+    }
+}
+
+/*===========================================================================
+ *                          基准测试
+ *===========================================================================*/
+
+#if CONFIG_XN_AUDIO_DSP_BENCHMARK
+
+static const char *TAG = "xn_audio_dsp";
+
+#define BENCH_ROUNDS            32      ///< 每个内核的重复次数
+
+/**
+ * @brief 重复执行 expr，记录最小与平均周期数后打印
+ */
+#define BENCH_RUN(kernel, path, expr)                                       \
+    do {                                                                    \
+        uint32_t best = UINT32_MAX;                                         \
+        uint64_t total = 0;                                                 \
+        for (int r = 0; r < BENCH_ROUNDS; r++) {                            \
+            uint32_t start = esp_cpu_get_cycle_count();                     \
+            expr;                                                           \
+            uint32_t cycles = esp_cpu_get_cycle_count() - start;            \
+            total += cycles;                                                \
+            if (cycles < best) {                                            \
+                best = cycles;                                              \
+            }                                                               \
+        }                                                                   \
+        bench_print(kernel, path, best, (uint32_t)(total / BENCH_ROUNDS), frame_us); \
+    } while (0)
+
+static void bench_print(const char *kernel, const char *path, uint32_t best, uint32_t avg, uint32_t frame_us)
+{
+    uint32_t mhz = esp_rom_get_cpu_ticks_per_us();
+    uint32_t us = best / mhz;
+    // 占一帧时长的比例，单位 0.01%
+    uint32_t load = (uint32_t)((uint64_t)best * 10000 / ((uint64_t)frame_us * mhz));
+    ESP_LOGI(TAG, "%-16s %-6s %9u %9u %7u %3u.%02u%%", kernel, path, (unsigned)best, (unsigned)avg,
+             (unsigned)us, (unsigned)(load / 100), (unsigned)(load % 100));
+}
+
+esp_err_t xn_audio_dsp_benchmark(uint32_t sample_rate, uint16_t frame_ms)
+{
+    const size_t n = (size_t)sample_rate * frame_ms / 1000;
+    const size_t n_in = n * 3;
+    const uint32_t frame_us = (uint32_t)frame_ms * 1000;
+    if (n == 0 || (n & 3) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int16_t *s16 = heap_caps_aligned_alloc(DSP_ALIGN, n * sizeof(int16_t), MALLOC_CAP_DEFAULT);
+    float *in = heap_caps_aligned_alloc(DSP_ALIGN, n_in * sizeof(float), MALLOC_CAP_DEFAULT);
+    float *out = heap_caps_aligned_alloc(DSP_ALIGN, n_in * sizeof(float), MALLOC_CAP_DEFAULT);
+    float *taps = malloc(32 * sizeof(float));
+    xn_audio_fir_t *fir_c = NULL;
+    xn_audio_fir_t *decim_c = NULL;
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    if (s16 == NULL || in == NULL || out == NULL || taps == NULL) {
+        goto done;
+    }
+
+    // 测试信号：两个正弦叠加，覆盖正常幅度范围
+    for (size_t i = 0; i < n_in; i++) {
+        in[i] = 0.4f * sinf(2 * (float)M_PI * 440 * i / (sample_rate * 3.0f)) +
+                0.2f * sinf(2 * (float)M_PI * 3100 * i / (sample_rate * 3.0f));
+    }
+    xn_audio_f32_to_s16(in, s16, n);
+    for (int i = 0; i < 32; i++) {
+        taps[i] = 1.0f / 32;
+    }
+
+    xn_audio_biquad_t bq;
+    xn_audio_biquad_highpass(&bq, 100, sample_rate, 0.707f);
+    ret = fir_create(taps, 32, 1, false, &fir_c);
+    if (ret == ESP_OK) {
+        ret = decimator_create(sample_rate * 3, sample_rate, 48, false, &decim_c);
+    }
+    if (ret != ESP_OK) {
+        goto done;
+    }
+
+    ESP_LOGI(TAG, "DSP benchmark: %u samples per %u ms frame, %u MHz", (unsigned)n, frame_ms,
+             (unsigned)esp_rom_get_cpu_ticks_per_us());
+    ESP_LOGI(TAG, "%-16s %-6s %9s %9s %7s %8s", "kernel", "path", "min_cyc", "avg_cyc", "us", "load");
+
+    volatile uint32_t sink_u32;
+    volatile float sink_f32;
+    BENCH_RUN("s16_to_f32", "c", xn_audio_s16_to_f32(s16, out, n));
+    BENCH_RUN("f32_to_s16", "c", xn_audio_f32_to_s16(in, s16, n));
+    BENCH_RUN("energy_s16", "c", sink_u32 = xn_audio_energy_s16(s16, n));
+    BENCH_RUN("energy_f32", "c", sink_f32 = sum_squares_c(in, n) / n);
+    BENCH_RUN("biquad_hpf", "c", biquad_process_c(in, out, n, bq.coeffs, bq.w));
+    BENCH_RUN("fir_32", "c", fir_process_c(fir_c, in, out, (int)n));
+    BENCH_RUN("decim_48k_16k", "c", fir_process_c(decim_c, in, out, (int)n));
+
+#if CONFIG_XN_AUDIO_DSP_SIMD
+    xn_audio_fir_t *fir_v = NULL;
+    xn_audio_fir_t *decim_v = NULL;
+    ret = fir_create(taps, 32, 1, true, &fir_v);
+    if (ret == ESP_OK) {
+        ret = decimator_create(sample_rate * 3, sample_rate, 48, true, &decim_v);
+    }
+    if (ret == ESP_OK) {
+        BENCH_RUN("energy_f32", "dsp", sink_f32 = xn_audio_energy_f32(in, n));
+        BENCH_RUN("biquad_hpf", "dsp", xn_audio_biquad_process(&bq, in, out, n));
+        BENCH_RUN("fir_32", "dsp", xn_audio_fir_process(fir_v, in, out, n));
+        BENCH_RUN("decim_48k_16k", "dsp", xn_audio_fir_process(decim_v, in, out, n_in));
+    }
+    xn_audio_fir_delete(fir_v);
+    xn_audio_fir_delete(decim_v);
+#endif
+    (void)sink_u32;
+    (void)sink_f32;
+
+done:
+    xn_audio_fir_delete(fir_c);
+    xn_audio_fir_delete(decim_c);
+    heap_caps_free(s16);
+    heap_caps_free(in);
+    heap_caps_free(out);
+    free(taps);
+    return ret;
+}
+
+#else
+
+esp_err_t xn_audio_dsp_benchmark(uint32_t sample_rate, uint16_t frame_ms)
+{
+    (void)sample_rate;
+    (void)frame_ms;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif /* CONFIG_XN_AUDIO_DSP_BENCHMARK */
@@ -22,6 +22,16 @@ extern "C" { // 使用C链接约定
 // 前置声明 BluFi实例结构体
 typedef struct xn_blufi_s xn_blufi_t;
 
+/**
+ * @brief 压缩后的扫描结果（每个SSID一条，保留信号最强的BSSID）
+ */
+typedef struct {
+    char ssid[33]; // SSID
+    int8_t rssi; // 最强BSSID的信号强度
+    uint8_t bssid[6]; // 最强BSSID，连接时可直接锁定
+    uint8_t channel; // 最强BSSID所在信道
+} xn_blufi_ap_t;
+
 /**
  * @brief BluFi回调函数集结构体定义
  */
@@ -92,22 +102,68 @@ void xn_blufi_destroy(xn_blufi_t *blufi); // 销毁实例函数声明
 /**
  * @brief 初始化并启动BluFi服务
  * 
+ * 依次启动蓝牙控制器、NimBLE协议栈和BluFi服务并开始广播。
+ * 中途失败时已启动的部分会被关闭，不残留内存占用。
+ * 
  * @param blufi 实例指针
  * @param callbacks 回调函数结构体指针
- * @return esp_err_t 返回ESP_OK表示成功，其他表示失败
+ * @return esp_err_t 
+ *         - ESP_OK: 启动成功
+ *         - ESP_ERR_INVALID_STATE: 已经启动
+ *         - ESP_ERR_NOT_SUPPORTED: 蓝牙内存已通过 xn_blufi_release_memory 释放
+ *         - 其他: 蓝牙栈启动失败
  */
 esp_err_t xn_blufi_init(xn_blufi_t *blufi, xn_blufi_callbacks_t *callbacks); // 初始化函数声明
 
 /**
  * @brief 停止并反初始化BluFi服务
  * 
+ * 停止NimBLE Host任务，释放BluFi协议层，关闭并反初始化控制器，
+ * 控制器运行内存归还给堆。之后可再次调用 xn_blufi_init 启动。
+ * 不能在BluFi回调（NimBLE Host任务）中调用。
+ * 
  * @param blufi 实例指针
- * @return esp_err_t 返回ESP_OK表示成功，其他表示失败
+ * @return esp_err_t 返回ESP_OK表示成功，ESP_ERR_INVALID_STATE表示未启动
  */
 esp_err_t xn_blufi_deinit(xn_blufi_t *blufi); // 反初始化函数声明
 
 /**
- * @brief 发送WiFi扫描结果给手机
+ * @brief 永久释放蓝牙内存
+ * 
+ * 把控制器和NimBLE协议栈的静态内存归还给堆，供WiFi/TLS和显示使用。
+ * 释放后直到重启都不能再启动BluFi，需在 xn_blufi_deinit 之后调用。
+ * 
+ * @return esp_err_t 返回ESP_OK表示成功，ESP_ERR_INVALID_STATE表示BluFi仍在运行
+ */
+esp_err_t xn_blufi_release_memory(void); // 永久释放蓝牙内存函数声明
+
+/**
+ * @brief 压缩扫描结果
+ * 
+ * 去掉隐藏SSID，同名SSID只保留信号最强的BSSID，按信号从强到弱排序，最多保留 max 条。
+ * 
+ * @param ap_count AP数量
+ * @param ap_list ESP-IDF wifi_ap_record_t 数组指针
+ * @param out 输出数组（至少 max 条）
+ * @param max 最多输出条数
+ * @return uint16_t 输出条数
+ */
+uint16_t xn_blufi_compact_ap_list(uint16_t ap_count, const void *ap_list, xn_blufi_ap_t *out, uint16_t max); // 压缩扫描结果函数声明
+
+/**
+ * @brief 发送压缩后的WiFi列表给手机
+ * 
+ * 按顺序发送，累计长度（每条 SSID 长度 + 2 字节）超过 CONFIG_XN_BLUFI_WIFI_LIST_MAX_BYTES 时截断，
+ * 列表越短，手机越早拿到完整结果。
+ * 
+ * @param aps 压缩后的列表（已按信号从强到弱排序）
+ * @param count 条数
+ * @return esp_err_t 返回ESP_OK表示成功，其他表示失败
+ */
+esp_err_t xn_blufi_send_ap_list(const xn_blufi_ap_t *aps, uint16_t count); // 发送压缩列表函数声明
+
+/**
+ * @brief 发送WiFi扫描结果给手机（先压缩再发送）
  * 
  * @param ap_count AP数量
  * @param ap_list ESP-IDF wifi_ap_record_t 数组指针
@@ -143,6 +199,14 @@ esp_err_t xn_blufi_send_custom_data(uint8_t *data, size_t len); // 发送自定
  */
 bool xn_blufi_is_ble_connected(xn_blufi_t *blufi); // 检查蓝牙连接状态函数声明
 
+/**
+ * @brief 获取当前连接的ATT MTU
+ * 
+ * @param blufi 实例指针
+ * @return uint16_t ATT MTU（未交换MTU时为23），未连接返回0
+ */
+uint16_t xn_blufi_get_mtu(xn_blufi_t *blufi); // 获取ATT MTU函数声明
+
 #ifdef __cplusplus // 如果是C++编译器
 }
 #endif // 结束C++编译器判断
@@ -0,0 +1,127 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-28 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-28 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_blufi\include\xn_blufi_xfer.h
+ * @Description: BluFi批量传输 - 基于自定义数据通道的分块、滑动窗口确认传输，边收边写入目标
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved.
+ */
+
+#pragma once // 防止头文件重复包含
+
+#include "esp_err.h" // 包含ESP错误码定义
+#include "xn_blufi.h" // 包含BluFi实例定义
+#include <stdint.h> // 包含标准整型定义
+#include <stdbool.h> // 包含布尔类型定义
+#include <stddef.h> // 包含size_t定义
+
+#ifdef __cplusplus // 如果是C++编译器
+extern "C" { // 使用C链接约定
+#endif // 结束C++编译器判断
+
+/*
+ * 报文格式（自定义数据，多字节整数为小端）：
+ *
+ *   START     手机->设备 [0x10][id][target][window][total u32][crc32 u32][chunk_max u16][name_len][name]
+ *   START_ACK 设备->手机 [0x11][id][status][window][chunk u16]
+ *   DATA      手机->设备 [0x12][id][offset u32][data ...]          data 长度不超过 chunk
+ *   ACK       设备->手机 [0x13][id][status][next u32]
+ *   END       手机->设备 [0x14][id]
+ *   DONE      设备->手机 [0x15][id][status]
+ *   ABORT     双向       [0x16][id][status]
+ *
+ * 流程：START 协商分块大小（不超过 ATT MTU 能单包承载的长度）和窗口（未确认分块数上限）；
+ * 手机连续发送 DATA，设备每收到半个窗口回一次 ACK，手机收到 ACK 后窗口前移。
+ * 偏移不连续时设备回 ACK(SEQ) 携带期望偏移，手机从该偏移重发（回退N帧）。
+ * END 后设备校验长度与 CRC32（IEEE，与 esp_rom_crc32_le 一致），提交目标并回 DONE。
+ * DATA 的数据直接交给目标写入，不在内存中暂存整个负载。
+ */
+
+#define XN_BLUFI_XFER_TYPE_FIRST    0x10 // 批量传输报文类型下界
+#define XN_BLUFI_XFER_TYPE_LAST     0x1F // 批量传输报文类型上界
+
+// 报文类型
+typedef enum {
+    XN_BLUFI_XFER_START     = 0x10, // 开始传输
+    XN_BLUFI_XFER_START_ACK = 0x11, // 开始应答
+    XN_BLUFI_XFER_DATA      = 0x12, // 数据分块
+    XN_BLUFI_XFER_ACK       = 0x13, // 窗口确认
+    XN_BLUFI_XFER_END       = 0x14, // 数据发送完毕
+    XN_BLUFI_XFER_DONE      = 0x15, // 校验并提交完成
+    XN_BLUFI_XFER_ABORT     = 0x16, // 中止
+} xn_blufi_xfer_type_t;
+
+// 状态码
+typedef enum {
+    XN_BLUFI_XFER_OK = 0, // 成功
+    XN_BLUFI_XFER_ERR_BUSY, // 已有传输进行中
+    XN_BLUFI_XFER_ERR_TARGET, // 目标或名称不允许
+    XN_BLUFI_XFER_ERR_SIZE, // 长度超出目标容量或与声明不符
+    XN_BLUFI_XFER_ERR_WRITE, // 写入目标失败
+    XN_BLUFI_XFER_ERR_CRC, // CRC 校验失败
+    XN_BLUFI_XFER_ERR_SEQ, // 偏移不连续，ACK 携带期望偏移（不中止传输）
+    XN_BLUFI_XFER_ERR_PROTO, // 报文格式错误或传输ID不符
+    XN_BLUFI_XFER_ERR_ABORTED, // 被对端中止或蓝牙断开
+} xn_blufi_xfer_status_t;
+
+// 传输目标
+typedef enum {
+    XN_BLUFI_XFER_TARGET_NVS = 1, // NVS 键（name 为键名）
+    XN_BLUFI_XFER_TARGET_PARTITION = 2, // flash 数据分区（name 为分区标签）
+} xn_blufi_xfer_target_t;
+
+/**
+ * @brief 传输写入目标（由应用层实现，在 NimBLE Host 任务中调用）
+ */
+typedef struct {
+    /**
+     * @brief 开始传输：检查目标与容量并做好写入准备
+     * @return XN_BLUFI_XFER_OK 或错误状态码
+     */
+    xn_blufi_xfer_status_t (*begin)(uint8_t target, const char *name, uint32_t total, void *user_data);
+
+    /**
+     * @brief 按顺序写入一个分块（offset 连续递增，data 指向收到的报文，返回后失效）
+     * @return XN_BLUFI_XFER_OK 或错误状态码
+     */
+    xn_blufi_xfer_status_t (*write)(uint32_t offset, const uint8_t *data, size_t len, void *user_data);
+
+    /**
+     * @brief 结束传输：ok 为 true 时提交，为 false 时丢弃已写入的内容
+     * @return XN_BLUFI_XFER_OK 或错误状态码（仅提交时有意义）
+     */
+    xn_blufi_xfer_status_t (*end)(bool ok, void *user_data);
+
+    void *user_data; // 回调用户数据
+} xn_blufi_xfer_sink_t;
+
+/**
+ * @brief 设置写入目标（在 BluFi 启动前调用）
+ *
+ * @param sink 写入目标，内容被拷贝
+ */
+void xn_blufi_xfer_set_sink(const xn_blufi_xfer_sink_t *sink); // 设置写入目标函数声明
+
+/**
+ * @brief 处理一个自定义数据报文
+ *
+ * 在 on_recv_custom_data 回调中先调用，类型在 0x10~0x1F 时由本模块处理并回复。
+ *
+ * @param blufi 实例指针（用于查询 MTU）
+ * @param data 报文
+ * @param len 报文长度
+ * @return true 是批量传输报文（已处理）
+ * @return false 不是，由调用者继续处理
+ */
+bool xn_blufi_xfer_handle(xn_blufi_t *blufi, const uint8_t *data, size_t len); // 处理报文函数声明
+
+/**
+ * @brief 中止进行中的传输（蓝牙断开或退出配网时调用），丢弃已写入的内容
+ */
+void xn_blufi_xfer_abort(void); // 中止传输函数声明
+
+#ifdef __cplusplus // 如果是C++编译器
+}
+#endif // 结束C++编译器判断
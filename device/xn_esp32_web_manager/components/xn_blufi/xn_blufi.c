@@ -11,6 +11,7 @@
 
 #include "xn_blufi.h" // 包含组件头文件
 #include "esp_log.h" // 包含日志库
+#include "sdkconfig.h" // 包含工程配置
 #include "esp_blufi_api.h" // 包含BluFi API
 #include "esp_blufi.h" // 包含BluFi定义
 #include "esp_bt.h" // 包含BT定义
@@ -31,6 +32,7 @@ static const char *TAG = "XN_BLUFI";
 struct xn_blufi_s {
     char device_name[32]; // 设备名称
     bool ble_connected; // BLE连接状态
+    uint16_t conn_handle; // BLE连接句柄，用于查询ATT MTU
     xn_blufi_callbacks_t callbacks; // 回调函数集
     // 缓存待连接的SSID/PWD
     char pending_ssid[33]; 
@@ -39,6 +41,20 @@ struct xn_blufi_s {
 
 static xn_blufi_t *g_blufi_instance = NULL; // 全局单例指针
 
+// 蓝牙栈启动进度，反初始化（或启动中途失败）时按相反顺序逐级关闭
+typedef enum {
+    STACK_OFF = 0, // 未启动
+    STACK_CTRL_INIT, // 控制器已初始化
+    STACK_CTRL_ENABLED, // 控制器已使能
+    STACK_NIMBLE_INIT, // NimBLE协议栈已初始化
+    STACK_BLUFI_INIT, // BluFi GATT服务与协议层已初始化
+    STACK_RUNNING, // Host任务已运行
+} stack_stage_t;
+
+static stack_stage_t s_stack_stage = STACK_OFF; // 当前启动进度
+static bool s_classic_released = false; // 经典蓝牙内存已释放（只需一次）
+static bool s_mem_released = false; // 蓝牙内存已永久释放，重启前不能再启动
+
 /* ---------------- Internal Helpers ---------------- */
 
 // BluFi事件内部回调 - 处理底层BluFi协议栈的各种事件
@@ -65,6 +81,7 @@ static void blufi_event_callback(esp_blufi_cb_event_t event, esp_blufi_cb_param_
         ESP_LOGI(TAG, "BLUFI ble connect");
         // 更新内部连接状态标志
         blufi->ble_connected = true;
+        blufi->conn_handle = param->connect.conn_id; // NimBLE 下即连接句柄
         // 连接建立后停止广播，此时不可被其他设备搜索到
         esp_blufi_adv_stop();
         break;
@@ -134,7 +151,7 @@ static void blufi_event_callback(esp_blufi_cb_event_t event, esp_blufi_cb_param_
 
     case ESP_BLUFI_EVENT_RECV_CUSTOM_DATA:
         // 接收到用户自定义数据（非标准Blufi协议数据）
-        ESP_LOGI(TAG, "Recv Custom Data len=%d", param->custom_data.data_len);
+        ESP_LOGD(TAG, "Recv Custom Data len=%d", (int)param->custom_data.data_len); // 批量传输时每个分块一次，不打 INFO
         // 透传给应用层进行解析处理
         if (blufi->callbacks.on_recv_custom_data) {
             blufi->callbacks.on_recv_custom_data(blufi, param->custom_data.data, param->custom_data.data_len);
@@ -173,6 +190,36 @@ static void xn_blufi_host_task(void *param) {
     nimble_port_freertos_deinit();
 }
 
+// 按启动进度逐级关闭蓝牙栈，完成后控制器内存（数十KB）归还给堆
+static void stack_teardown(void)
+{
+    if (s_stack_stage >= STACK_RUNNING) {
+        esp_blufi_adv_stop(); // 停止广播
+    }
+    if (s_stack_stage >= STACK_BLUFI_INIT) {
+        esp_blufi_gatt_svr_deinit(); // 注销BluFi GATT服务
+    }
+    if (s_stack_stage >= STACK_NIMBLE_INIT) {
+        // 停止Host任务（任务退出前自行删除），之后才能释放协议栈
+        if (s_stack_stage < STACK_RUNNING || nimble_port_stop() == 0) {
+            esp_nimble_deinit();
+        } else {
+            ESP_LOGE(TAG, "NimBLE host stop failed");
+        }
+    }
+    if (s_stack_stage >= STACK_BLUFI_INIT) {
+        esp_blufi_profile_deinit(); // 释放BluFi协议层
+        esp_blufi_btc_deinit();
+    }
+    if (s_stack_stage >= STACK_CTRL_ENABLED) {
+        esp_bt_controller_disable(); // 关闭控制器
+    }
+    if (s_stack_stage >= STACK_CTRL_INIT) {
+        esp_bt_controller_deinit(); // 释放控制器运行内存
+    }
+    s_stack_stage = STACK_OFF;
+}
+
 /* ---------------- Public API ---------------- */
 
 // 创建BluFi实例
@@ -202,22 +249,35 @@ void xn_blufi_destroy(xn_blufi_t *blufi)
 esp_err_t xn_blufi_init(xn_blufi_t *blufi, xn_blufi_callbacks_t *callbacks)
 {
     if (!blufi || !callbacks) return ESP_ERR_INVALID_ARG;
+    if (s_mem_released) return ESP_ERR_NOT_SUPPORTED; // 内存已永久释放
+    if (s_stack_stage != STACK_OFF) return ESP_ERR_INVALID_STATE; // 已启动
 
     blufi->callbacks = *callbacks;
+    blufi->ble_connected = false;
     g_blufi_instance = blufi; // 设置全局实例用于回调
 
     // 释放经典蓝牙内存，节省资源
-    ESP_ERROR_CHECK(esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT));
+    if (!s_classic_released) {
+        esp_err_t ret = esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT);
+        if (ret != ESP_OK) {
+            g_blufi_instance = NULL;
+            return ret;
+        }
+        s_classic_released = true;
+    }
     
     esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
     esp_err_t ret = esp_bt_controller_init(&bt_cfg);
-    if (ret) return ret;
+    if (ret) goto fail;
+    s_stack_stage = STACK_CTRL_INIT;
 
     ret = esp_bt_controller_enable(ESP_BT_MODE_BLE);
-    if (ret) return ret;
+    if (ret) goto fail;
+    s_stack_stage = STACK_CTRL_ENABLED;
 
     ret = esp_nimble_init();
-    if (ret) return ret;
+    if (ret) goto fail;
+    s_stack_stage = STACK_NIMBLE_INIT;
 
     // 配置NimBLE回调
     ble_hs_cfg.reset_cb = xn_blufi_on_reset;
@@ -226,54 +286,129 @@ esp_err_t xn_blufi_init(xn_blufi_t *blufi, xn_blufi_callbacks_t *callbacks)
     ble_hs_cfg.store_status_cb = ble_store_util_status_rr;
 
     ret = esp_blufi_gatt_svr_init();
-    if (ret) return ret;
+    if (ret) goto fail;
+    s_stack_stage = STACK_BLUFI_INIT;
 
     ret = ble_svc_gap_device_name_set(blufi->device_name);
-    if (ret) return ret;
+    if (ret) goto fail;
 
     esp_blufi_btc_init();
     ret = esp_blufi_register_callbacks(&s_esp_blufi_callbacks);
-    if (ret) return ret;
+    if (ret) goto fail;
 
     ret = esp_nimble_enable(xn_blufi_host_task);
-    if (ret) return ret;
+    if (ret) goto fail;
+    s_stack_stage = STACK_RUNNING;
 
     return ESP_OK;
+
+fail:
+    ESP_LOGE(TAG, "BluFi start failed at stage %d: %d", s_stack_stage, ret);
+    stack_teardown(); // 回退已启动的部分
+    g_blufi_instance = NULL;
+    return ret;
 }
 
 // 反初始化BluFi服务
 esp_err_t xn_blufi_deinit(xn_blufi_t *blufi)
 {
-    esp_blufi_gatt_svr_deinit();
-    esp_nimble_deinit();
-    esp_blufi_profile_deinit();
-    esp_blufi_btc_deinit();
+    (void)blufi;
+    if (s_stack_stage == STACK_OFF) return ESP_ERR_INVALID_STATE; // 未启动
+
+    stack_teardown(); // 关闭Host、BluFi协议层和控制器
     g_blufi_instance = NULL;
+    ESP_LOGI(TAG, "BluFi stopped, BT controller released");
     return ESP_OK;
 }
 
-// 发送WiFi列表
-esp_err_t xn_blufi_send_wifi_list(uint16_t ap_count, void *ap_list)
+// 永久释放蓝牙内存
+esp_err_t xn_blufi_release_memory(void)
 {
-    // 需要将 wifi_ap_record_t 转换为 esp_blufi_ap_record_t
-    // 这里因为解耦，我们假设传入的就是系统标准的 wifi_ap_record_t 数组
-    // 但 blufi 需要特殊的结构体，所以需要转换
-    if (ap_count > 0 && ap_list) {
-        esp_blufi_ap_record_t *blufi_ap_list = malloc(sizeof(esp_blufi_ap_record_t) * ap_count);
-        if (!blufi_ap_list) return ESP_ERR_NO_MEM;
-
-        wifi_ap_record_t *src_list = (wifi_ap_record_t *)ap_list;
-        for (int i = 0; i < ap_count; i++) {
-            memcpy(blufi_ap_list[i].ssid, src_list[i].ssid, sizeof(blufi_ap_list[i].ssid)); // 拷贝SSID
-            blufi_ap_list[i].rssi = src_list[i].rssi; // 拷贝RSSI
+    if (s_mem_released) return ESP_OK; // 已释放
+    if (s_stack_stage != STACK_OFF) return ESP_ERR_INVALID_STATE; // 需先停止
+
+    // 控制器与NimBLE的静态数据段一并归还给堆
+    esp_err_t ret = esp_bt_mem_release(ESP_BT_MODE_BTDM);
+    if (ret != ESP_OK) return ret;
+    s_mem_released = true;
+    ESP_LOGI(TAG, "BT memory released until reboot");
+    return ESP_OK;
+}
+
+// 压缩扫描结果：去掉隐藏SSID、同名只留最强、按信号排序并限制条数
+uint16_t xn_blufi_compact_ap_list(uint16_t ap_count, const void *ap_list, xn_blufi_ap_t *out, uint16_t max)
+{
+    if (ap_list == NULL || out == NULL) return 0;
+
+    const wifi_ap_record_t *src = (const wifi_ap_record_t *)ap_list;
+    uint16_t n = 0;
+    for (uint16_t i = 0; i < ap_count; i++) {
+        const char *ssid = (const char *)src[i].ssid;
+        if (ssid[0] == '\0') continue; // 隐藏网络，手机无法选择
+
+        // 同名SSID：新记录更强时先移除旧记录，再按信号重新插入
+        uint16_t k = 0;
+        while (k < n && strcmp(out[k].ssid, ssid) != 0) k++;
+        if (k < n) {
+            if (src[i].rssi <= out[k].rssi) continue;
+            memmove(&out[k], &out[k + 1], (n - k - 1) * sizeof(xn_blufi_ap_t));
+            n--;
         }
 
-        esp_blufi_send_wifi_list(ap_count, blufi_ap_list);
-        free(blufi_ap_list);
-    } else {
-        esp_blufi_send_wifi_list(0, NULL);
+        uint16_t pos = n;
+        while (pos > 0 && out[pos - 1].rssi < src[i].rssi) pos--;
+        if (pos >= max) continue; // 比已有的都弱且列表已满
+        if (n == max) n--; // 挤掉最弱的一条
+        memmove(&out[pos + 1], &out[pos], (n - pos) * sizeof(xn_blufi_ap_t));
+
+        strlcpy(out[pos].ssid, ssid, sizeof(out[pos].ssid));
+        out[pos].rssi = src[i].rssi;
+        memcpy(out[pos].bssid, src[i].bssid, sizeof(out[pos].bssid));
+        out[pos].channel = src[i].primary;
+        n++;
     }
-    return ESP_OK;
+    return n;
+}
+
+// 发送压缩后的WiFi列表，总长度超过上限时截断
+esp_err_t xn_blufi_send_ap_list(const xn_blufi_ap_t *aps, uint16_t count)
+{
+    if (count == 0 || aps == NULL) return esp_blufi_send_wifi_list(0, NULL);
+
+    esp_blufi_ap_record_t *list = malloc(sizeof(esp_blufi_ap_record_t) * count);
+    if (!list) return ESP_ERR_NO_MEM;
+
+    // BluFi 每条编码为 [长度][RSSI][SSID]，长度字节计入 RSSI
+    size_t bytes = 0;
+    uint16_t n = 0;
+    while (n < count) {
+        size_t len = strlen(aps[n].ssid) + 2;
+        if (bytes + len > CONFIG_XN_BLUFI_WIFI_LIST_MAX_BYTES) break;
+        bytes += len;
+        memcpy(list[n].ssid, aps[n].ssid, sizeof(list[n].ssid)); // 拷贝SSID
+        list[n].rssi = aps[n].rssi; // 拷贝RSSI
+        n++;
+    }
+
+    esp_err_t ret = esp_blufi_send_wifi_list(n, list);
+    free(list);
+    ESP_LOGI(TAG, "WiFi list sent: %d of %d SSIDs, %d bytes", n, count, (int)bytes);
+    return ret;
+}
+
+// 发送WiFi列表（原始扫描结果先压缩）
+esp_err_t xn_blufi_send_wifi_list(uint16_t ap_count, void *ap_list)
+{
+    if (ap_count == 0 || ap_list == NULL) return esp_blufi_send_wifi_list(0, NULL);
+
+    uint16_t max = ap_count < CONFIG_XN_BLUFI_WIFI_LIST_MAX ? ap_count : CONFIG_XN_BLUFI_WIFI_LIST_MAX;
+    xn_blufi_ap_t *aps = malloc(sizeof(xn_blufi_ap_t) * max);
+    if (!aps) return ESP_ERR_NO_MEM;
+
+    uint16_t n = xn_blufi_compact_ap_list(ap_count, ap_list, aps, max);
+    esp_err_t ret = xn_blufi_send_ap_list(aps, n);
+    free(aps);
+    return ret;
 }
 
 // 发送连接报告
@@ -303,3 +438,10 @@ bool xn_blufi_is_ble_connected(xn_blufi_t *blufi)
 {
     return blufi ? blufi->ble_connected : false;
 }
+
+// 获取当前连接的ATT MTU
+uint16_t xn_blufi_get_mtu(xn_blufi_t *blufi)
+{
+    if (!blufi || !blufi->ble_connected) return 0; // 未连接
+    return ble_att_mtu(blufi->conn_handle); // 手机发起MTU交换后更新，未交换时为23
+}
@@ -0,0 +1,262 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-28 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-28 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_blufi\xn_blufi_xfer.c
+ * @Description: BluFi批量传输 - 实现
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved.
+ */
+
+#include "xn_blufi_xfer.h" // 包含组件头文件
+#include "esp_log.h" // 包含日志库
+#include "esp_timer.h" // 包含高精度定时器（统计耗时）
+#include "esp_rom_crc.h" // 包含ROM CRC32
+#include "sdkconfig.h" // 包含工程配置
+#include <string.h> // 包含字符串库
+
+static const char *TAG = "XN_BLUFI_XFER";
+
+// 每个分块除数据外的开销：ATT 写请求头 3 + BluFi 帧头 4 + BluFi 校验 2 + DATA 头 6
+#define XFER_FRAME_OVERHEAD 15
+#define XFER_CHUNK_MIN 8 // MTU 为默认 23 时的分块大小
+#define XFER_START_LEN 15 // START 固定部分长度（不含名称）
+#define XFER_DATA_HDR 6 // DATA 头长度
+#define XFER_NAME_MAX 32 // 目标名称最大长度
+
+// 传输状态，只在 NimBLE Host 任务中访问
+typedef struct {
+    bool active; // 传输进行中
+    uint8_t id; // 传输ID（手机分配）
+    uint8_t window; // 协商的窗口（未确认分块数上限）
+    uint8_t unacked; // 上次 ACK 之后收到的分块数
+    bool nak_sent; // 当前缺口已回过 SEQ，缺口填上之前不再重复
+    uint16_t chunk; // 协商的分块大小
+    uint32_t total; // 声明的总长度
+    uint32_t crc_expect; // 声明的 CRC32
+    uint32_t crc; // 已收数据的 CRC32
+    uint32_t next; // 期望的下一个偏移
+    int64_t start_us; // 开始时间
+} xfer_state_t;
+
+static xn_blufi_xfer_sink_t s_sink; // 写入目标
+static xfer_state_t s_xfer; // 当前传输
+
+/* ---------------- Internal Helpers ---------------- */
+
+// 读取小端 u32
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// 写入小端 u32
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+// 发送三字节状态报文（DONE/ABORT）
+static void send_status(uint8_t type, uint8_t id, uint8_t status)
+{
+    uint8_t buf[3] = {type, id, status};
+    xn_blufi_send_custom_data(buf, sizeof(buf));
+}
+
+// 发送窗口确认，携带期望的下一个偏移
+static void send_ack(uint8_t status)
+{
+    uint8_t buf[7] = {XN_BLUFI_XFER_ACK, s_xfer.id, status};
+    put_u32(&buf[3], s_xfer.next);
+    s_xfer.unacked = 0;
+    xn_blufi_send_custom_data(buf, sizeof(buf));
+}
+
+// 结束传输并通知目标，返回目标提交结果
+static uint8_t finish(bool ok)
+{
+    s_xfer.active = false;
+    if (!s_sink.end) return ok ? XN_BLUFI_XFER_OK : XN_BLUFI_XFER_ERR_ABORTED;
+    return s_sink.end(ok, s_sink.user_data);
+}
+
+// 中止传输并通知手机
+static void fail(uint8_t status)
+{
+    ESP_LOGW(TAG, "Transfer %d aborted at %u/%u: status %d",
+             s_xfer.id, (unsigned)s_xfer.next, (unsigned)s_xfer.total, status);
+    finish(false);
+    send_status(XN_BLUFI_XFER_ABORT, s_xfer.id, status);
+}
+
+// START：检查目标，协商分块大小和窗口
+static void handle_start(xn_blufi_t *blufi, const uint8_t *data, size_t len)
+{
+    uint8_t id = len > 1 ? data[1] : 0;
+    uint8_t resp[6] = {XN_BLUFI_XFER_START_ACK, id, XN_BLUFI_XFER_OK, 0, 0, 0};
+
+    if (len < XFER_START_LEN || data[14] == 0 || data[14] > XFER_NAME_MAX || len < XFER_START_LEN + data[14]) {
+        resp[2] = XN_BLUFI_XFER_ERR_PROTO;
+        xn_blufi_send_custom_data(resp, sizeof(resp));
+        return;
+    }
+    if (s_xfer.active) {
+        // 同一传输重发 START（START_ACK 丢失）且尚未收到数据时重新应答，其他情况视为忙
+        if (id != s_xfer.id || s_xfer.next != 0) resp[2] = XN_BLUFI_XFER_ERR_BUSY;
+        resp[3] = s_xfer.window;
+        resp[4] = (uint8_t)s_xfer.chunk;
+        resp[5] = (uint8_t)(s_xfer.chunk >> 8);
+        xn_blufi_send_custom_data(resp, sizeof(resp));
+        return;
+    }
+
+    uint8_t target = data[2];
+    uint8_t window = data[3];
+    uint32_t total = get_u32(&data[4]);
+    uint32_t crc = get_u32(&data[8]);
+    uint16_t chunk_max = (uint16_t)(data[12] | (data[13] << 8));
+    char name[XFER_NAME_MAX + 1];
+    memcpy(name, &data[XFER_START_LEN], data[14]);
+    name[data[14]] = '\0';
+
+    // 分块大小：一个分块正好放进一次 ATT 写，BluFi 不再分片
+    uint16_t mtu = xn_blufi_get_mtu(blufi);
+    uint16_t chunk = mtu > XFER_FRAME_OVERHEAD + XFER_CHUNK_MIN ? mtu - XFER_FRAME_OVERHEAD : XFER_CHUNK_MIN;
+    if (chunk > CONFIG_XN_BLUFI_XFER_CHUNK_MAX) chunk = CONFIG_XN_BLUFI_XFER_CHUNK_MAX;
+    if (chunk_max != 0 && chunk > chunk_max) chunk = chunk_max;
+    if (window == 0 || window > CONFIG_XN_BLUFI_XFER_WINDOW) window = CONFIG_XN_BLUFI_XFER_WINDOW;
+
+    uint8_t status = s_sink.begin ? s_sink.begin(target, name, total, s_sink.user_data) : XN_BLUFI_XFER_ERR_TARGET;
+    resp[2] = status;
+    resp[3] = window;
+    resp[4] = (uint8_t)chunk;
+    resp[5] = (uint8_t)(chunk >> 8);
+    if (status == XN_BLUFI_XFER_OK) {
+        memset(&s_xfer, 0, sizeof(s_xfer));
+        s_xfer.active = true;
+        s_xfer.id = id;
+        s_xfer.window = window;
+        s_xfer.chunk = chunk;
+        s_xfer.total = total;
+        s_xfer.crc_expect = crc;
+        s_xfer.start_us = esp_timer_get_time();
+        ESP_LOGI(TAG, "Transfer %d start: target %d '%s', %u bytes, chunk %d, window %d (MTU %d)",
+                 id, target, name, (unsigned)total, chunk, window, mtu);
+    } else {
+        ESP_LOGW(TAG, "Transfer %d rejected: target %d '%s', %u bytes, status %d",
+                 id, target, name, (unsigned)total, status);
+    }
+    xn_blufi_send_custom_data(resp, sizeof(resp));
+}
+
+// DATA：按偏移顺序写入目标，每半个窗口确认一次
+static void handle_data(const uint8_t *data, size_t len)
+{
+    if (!s_xfer.active || len < XFER_DATA_HDR || data[1] != s_xfer.id) {
+        send_status(XN_BLUFI_XFER_ABORT, len > 1 ? data[1] : 0, XN_BLUFI_XFER_ERR_PROTO);
+        return;
+    }
+
+    uint32_t offset = get_u32(&data[2]);
+    size_t n = len - XFER_DATA_HDR;
+    if (n == 0 || n > s_xfer.chunk || offset > s_xfer.total || n > s_xfer.total - offset) {
+        fail(XN_BLUFI_XFER_ERR_SIZE);
+        return;
+    }
+    if (offset != s_xfer.next) {
+        // 缺口或重复：告诉手机从期望偏移重发，同一缺口只回一次
+        if (!s_xfer.nak_sent) {
+            s_xfer.nak_sent = true;
+            send_ack(XN_BLUFI_XFER_ERR_SEQ);
+        }
+        return;
+    }
+    s_xfer.nak_sent = false;
+
+    // 直接写入收到的报文内容，不拷贝
+    uint8_t status = s_sink.write(offset, &data[XFER_DATA_HDR], n, s_sink.user_data);
+    if (status != XN_BLUFI_XFER_OK) {
+        fail(status);
+        return;
+    }
+    s_xfer.crc = esp_rom_crc32_le(s_xfer.crc, &data[XFER_DATA_HDR], (uint32_t)n);
+    s_xfer.next += n;
+
+    if (++s_xfer.unacked >= (s_xfer.window + 1) / 2 || s_xfer.next == s_xfer.total) {
+        send_ack(XN_BLUFI_XFER_OK);
+    }
+}
+
+// END：校验长度与 CRC 后提交
+static void handle_end(const uint8_t *data, size_t len)
+{
+    if (!s_xfer.active || len < 2 || data[1] != s_xfer.id) {
+        send_status(XN_BLUFI_XFER_DONE, len > 1 ? data[1] : 0, XN_BLUFI_XFER_ERR_PROTO);
+        return;
+    }
+
+    uint8_t status = XN_BLUFI_XFER_OK;
+    if (s_xfer.next != s_xfer.total) {
+        status = XN_BLUFI_XFER_ERR_SIZE;
+    } else if (s_xfer.crc != s_xfer.crc_expect) {
+        status = XN_BLUFI_XFER_ERR_CRC;
+    }
+    uint8_t commit = finish(status == XN_BLUFI_XFER_OK);
+    if (status == XN_BLUFI_XFER_OK) status = commit;
+
+    int64_t elapsed_ms = (esp_timer_get_time() - s_xfer.start_us) / 1000;
+    ESP_LOGI(TAG, "Transfer %d done: %u bytes in %d ms (%d B/s), status %d",
+             s_xfer.id, (unsigned)s_xfer.next, (int)elapsed_ms,
+             (int)(elapsed_ms > 0 ? (int64_t)s_xfer.next * 1000 / elapsed_ms : 0), status);
+    send_status(XN_BLUFI_XFER_DONE, s_xfer.id, status);
+}
+
+/* ---------------- Public API ---------------- */
+
+// 设置写入目标
+void xn_blufi_xfer_set_sink(const xn_blufi_xfer_sink_t *sink)
+{
+    if (sink) s_sink = *sink;
+}
+
+// 处理自定义数据报文
+bool xn_blufi_xfer_handle(xn_blufi_t *blufi, const uint8_t *data, size_t len)
+{
+    if (data == NULL || len == 0 || data[0] < XN_BLUFI_XFER_TYPE_FIRST || data[0] > XN_BLUFI_XFER_TYPE_LAST) {
+        return false;
+    }
+
+    switch (data[0]) {
+    case XN_BLUFI_XFER_START:
+        handle_start(blufi, data, len);
+        break;
+    case XN_BLUFI_XFER_DATA:
+        handle_data(data, len);
+        break;
+    case XN_BLUFI_XFER_END:
+        handle_end(data, len);
+        break;
+    case XN_BLUFI_XFER_ABORT:
+        // 手机中止：丢弃已写入的内容，不再回复
+        if (s_xfer.active && len > 1 && data[1] == s_xfer.id) {
+            ESP_LOGW(TAG, "Transfer %d aborted by phone at %u/%u", s_xfer.id, (unsigned)s_xfer.next, (unsigned)s_xfer.total);
+            finish(false);
+        }
+        break;
+    default:
+        break; // 设备发出的类型或保留类型，忽略
+    }
+    return true;
+}
+
+// 中止进行中的传输
+void xn_blufi_xfer_abort(void)
+{
+    if (!s_xfer.active) return;
+    ESP_LOGW(TAG, "Transfer %d dropped at %u/%u", s_xfer.id, (unsigned)s_xfer.next, (unsigned)s_xfer.total);
+    finish(false);
+}
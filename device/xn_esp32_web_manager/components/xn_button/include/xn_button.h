@@ -0,0 +1,108 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-25 14:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-25 14:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_button\include\xn_button.h
+ * @Description: 按键驱动组件头文件 - GPIO中断 + esp_timer 消抖与手势识别
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#pragma once // 防止头文件重复包含
+
+#include "esp_err.h" // 包含ESP错误码定义
+#include "driver/gpio.h" // 包含GPIO定义
+#include <stdint.h> // 包含标准整型定义
+#include <stdbool.h> // 包含布尔类型定义
+#include <stddef.h> // 包含size_t定义
+
+#ifdef __cplusplus // 如果是C++编译器
+extern "C" { // 使用C链接约定
+#endif // 结束C++编译器判断
+
+/*
+ * 没有扫描任务：电平变化触发GPIO中断，中断里只关闭该引脚中断并启动消抖定时器，
+ * 消抖和手势判定都在 esp_timer 任务中完成。空闲时CPU不被唤醒，引脚同时配置为
+ * GPIO唤醒源，开启自动 light sleep 时按下和松开都能唤醒芯片。
+ */
+
+/**
+ * @brief 按键事件类型
+ */
+typedef enum {
+    XN_BUTTON_EVT_PRESS = 0, // 按下（消抖后）
+    XN_BUTTON_EVT_RELEASE, // 松开，duration 为按住时长
+    XN_BUTTON_EVT_CLICK, // 单击（启用双击时在双击窗口结束后才确认）
+    XN_BUTTON_EVT_DOUBLE_CLICK, // 双击
+    XN_BUTTON_EVT_LONG_PRESS, // 长按达到阈值（按住期间触发一次）
+    XN_BUTTON_EVT_HOLD_REPEAT, // 长按后继续按住，按固定间隔重复触发
+} xn_button_event_t; // 按键事件类型定义
+
+/**
+ * @brief 单个按键配置，时间参数为0表示关闭对应手势
+ */
+typedef struct {
+    gpio_num_t gpio; // 按键GPIO
+    uint8_t active_level; // 按下时的电平
+    bool pull_up; // 启用内部上拉（低电平有效的按键）
+    uint16_t debounce_ms; // 消抖时间
+    uint16_t long_press_ms; // 长按阈值，0不检测长按
+    uint16_t repeat_ms; // 长按后的重复间隔，0不重复
+    uint16_t double_click_ms; // 双击窗口，0不检测双击（松开即报单击）
+} xn_button_config_t; // 按键配置类型定义
+
+/**
+ * @brief 默认按键配置（低电平有效、内部上拉）
+ */
+#define XN_BUTTON_DEFAULT_CONFIG(_gpio) \
+    (xn_button_config_t) { \
+        .gpio = (_gpio), \
+        .active_level = 0, \
+        .pull_up = true, \
+        .debounce_ms = 20, \
+        .long_press_ms = 1000, \
+        .repeat_ms = 0, \
+        .double_click_ms = 300, \
+    }
+
+/**
+ * @brief 按键事件回调（在 esp_timer 任务中调用，不能阻塞）
+ * 
+ * @param id 按键在配置表中的下标
+ * @param event 事件类型
+ * @param duration_ms 按住时长(ms)，按下事件为0
+ * @param user_data 用户数据
+ */
+typedef void (*xn_button_cb_t)(uint8_t id, xn_button_event_t event, uint32_t duration_ms, void *user_data); // 回调类型定义
+
+/**
+ * @brief 初始化按键驱动
+ * 
+ * @param buttons 按键配置表
+ * @param count 按键数量
+ * @param cb 事件回调
+ * @param user_data 传给回调的用户数据
+ * @return esp_err_t 返回ESP_OK表示成功，ESP_ERR_INVALID_STATE表示已初始化，其他表示失败
+ */
+esp_err_t xn_button_init(const xn_button_config_t *buttons, size_t count, xn_button_cb_t cb, void *user_data); // 初始化函数声明
+
+/**
+ * @brief 反初始化按键驱动，移除中断并删除定时器
+ * 
+ * @return esp_err_t 返回ESP_OK表示成功，ESP_ERR_INVALID_STATE表示未初始化
+ */
+esp_err_t xn_button_deinit(void); // 反初始化函数声明
+
+/**
+ * @brief 查询按键当前是否按下（消抖后的状态）
+ * 
+ * @param id 按键下标
+ * @return true 按下
+ * @return false 松开或下标无效
+ */
+bool xn_button_is_pressed(uint8_t id); // 查询按键状态函数声明
+
+#ifdef __cplusplus // 如果是C++编译器
+}
+#endif // 结束C++编译器判断
@@ -0,0 +1,355 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-25 14:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-25 14:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_button\xn_button.c
+ * @Description: 按键驱动组件实现 - GPIO电平中断唤醒 + esp_timer 消抖与手势状态机
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved.
+ */
+
+#include "xn_button.h" // 包含组件头文件
+#include "esp_log.h" // 包含日志库
+#include "esp_timer.h" // 包含高精度定时器
+#include "esp_sleep.h" // 包含睡眠唤醒配置
+#include <stdlib.h> // 包含内存分配
+#include <string.h> // 包含字符串处理库
+
+static const char *TAG = "XN_BUTTON"; // 定义日志标签
+
+/*
+ * 中断模型：
+ *   - 引脚使用电平中断，触发电平始终是“与当前稳定状态相反”的电平，
+ *     同一配置也作为 light sleep 的GPIO唤醒条件
+ *   - 中断里关闭该引脚中断并启动消抖定时器，抖动期间不会再进中断
+ *   - 消抖到期后读取电平：状态变化则推进手势状态机，然后改为等待相反电平并重新开中断；
+ *     电平未变（毛刺）则按原电平重新开中断
+ *   - 两个定时器的回调都在 esp_timer 任务中串行执行，按键状态不需要加锁
+ */
+
+// 手势阶段
+typedef enum {
+    PHASE_IDLE = 0, // 无待定手势
+    PHASE_WAIT_LONG, // 按住中，等待长按阈值
+    PHASE_REPEAT, // 长按已触发，按重复间隔计时
+    PHASE_WAIT_SECOND, // 单击已松开，等待双击窗口内的第二次按下
+} gesture_phase_t;
+
+// 单个按键运行状态
+typedef struct {
+    xn_button_config_t cfg; // 按键配置
+    uint8_t id; // 按键下标
+    esp_timer_handle_t debounce_timer; // 消抖定时器
+    esp_timer_handle_t gesture_timer; // 长按/重复/双击窗口定时器
+    volatile bool pressed; // 消抖后的按下状态
+    gesture_phase_t phase; // 当前手势阶段
+    uint8_t clicks; // 双击窗口内已完成的单击次数
+    bool long_fired; // 本次按下已触发长按（松开不再计为单击）
+    bool isr_added; // 已注册中断处理函数
+    int64_t press_us; // 按下时刻
+    uint32_t last_duration_ms; // 上一次按住时长（延迟确认单击时上报）
+} button_t;
+
+static button_t *s_buttons = NULL; // 按键状态数组
+static size_t s_count = 0; // 按键数量
+static xn_button_cb_t s_cb = NULL; // 事件回调
+static void *s_user_data = NULL; // 回调用户数据
+static bool s_initialized = false; // 初始化标志
+
+/**
+ * @brief 上报按键事件
+ */
+static void button_emit(button_t *btn, xn_button_event_t event, uint32_t duration_ms)
+{
+    if (s_cb) { // 如果注册了回调
+        s_cb(btn->id, event, duration_ms, s_user_data); // 调用回调
+    }
+}
+
+/**
+ * @brief 当前按住时长(ms)
+ */
+static uint32_t button_held_ms(const button_t *btn)
+{
+    return (uint32_t)((esp_timer_get_time() - btn->press_us) / 1000); // 换算为毫秒
+}
+
+/**
+ * @brief 重新启动手势定时器
+ */
+static void gesture_timer_arm(button_t *btn, gesture_phase_t phase, uint32_t timeout_ms)
+{
+    esp_timer_stop(btn->gesture_timer); // 先停止，运行中的定时器不能再次启动
+    btn->phase = phase; // 切换阶段
+    esp_timer_start_once(btn->gesture_timer, (uint64_t)timeout_ms * 1000); // 启动单次定时
+}
+
+/**
+ * @brief 等待与当前稳定状态相反的电平并开中断
+ */
+static void button_arm_level(button_t *btn)
+{
+    int active = btn->cfg.active_level ? 1 : 0; // 按下电平
+    int wait_level = btn->pressed ? !active : active; // 等待的电平
+    // 电平中断同时作为 light sleep 唤醒条件
+    gpio_wakeup_enable(btn->cfg.gpio, wait_level ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL); // 设置触发电平
+    gpio_intr_enable(btn->cfg.gpio); // 开中断
+}
+
+/**
+ * @brief 处理消抖后的按下
+ */
+static void button_on_press(button_t *btn)
+{
+    btn->press_us = esp_timer_get_time(); // 记录按下时刻
+    btn->long_fired = false; // 清除长按标志
+    button_emit(btn, XN_BUTTON_EVT_PRESS, 0); // 上报按下
+
+    if (btn->cfg.long_press_ms) { // 如果启用长按
+        gesture_timer_arm(btn, PHASE_WAIT_LONG, btn->cfg.long_press_ms); // 等待长按阈值
+    } else { // 不检测长按
+        esp_timer_stop(btn->gesture_timer); // 停止双击窗口计时，第二次按下在松开时判定
+        btn->phase = PHASE_IDLE; // 清除阶段
+    }
+}
+
+/**
+ * @brief 处理消抖后的松开
+ */
+static void button_on_release(button_t *btn)
+{
+    esp_timer_stop(btn->gesture_timer); // 停止长按/重复计时
+    btn->phase = PHASE_IDLE; // 清除阶段
+
+    uint32_t duration = button_held_ms(btn); // 本次按住时长
+    btn->last_duration_ms = duration; // 保存时长
+    button_emit(btn, XN_BUTTON_EVT_RELEASE, duration); // 上报松开
+
+    if (btn->long_fired) { // 长按后松开不计为单击
+        btn->clicks = 0; // 清除单击计数
+        return; // 直接返回
+    }
+
+    btn->clicks++; // 单击计数加一
+    if (btn->clicks >= 2) { // 双击窗口内第二次单击
+        btn->clicks = 0; // 清除单击计数
+        button_emit(btn, XN_BUTTON_EVT_DOUBLE_CLICK, duration); // 上报双击
+    } else if (btn->cfg.double_click_ms == 0) { // 不检测双击
+        btn->clicks = 0; // 清除单击计数
+        button_emit(btn, XN_BUTTON_EVT_CLICK, duration); // 立即上报单击
+    } else { // 等待可能的第二次单击
+        gesture_timer_arm(btn, PHASE_WAIT_SECOND, btn->cfg.double_click_ms); // 启动双击窗口
+    }
+}
+
+/**
+ * @brief 手势定时器回调（esp_timer 任务）
+ */
+static void gesture_timer_cb(void *arg)
+{
+    button_t *btn = (button_t *)arg; // 获取按键状态
+
+    switch (btn->phase) { // 根据阶段处理
+        case PHASE_WAIT_LONG: // 达到长按阈值
+            if (btn->clicks) { // 单击后再次按住：先确认前一次单击
+                btn->clicks = 0; // 清除单击计数
+                button_emit(btn, XN_BUTTON_EVT_CLICK, btn->last_duration_ms); // 上报单击
+            }
+            btn->long_fired = true; // 标记已触发长按
+            button_emit(btn, XN_BUTTON_EVT_LONG_PRESS, button_held_ms(btn)); // 上报长按
+            if (btn->cfg.repeat_ms) { // 如果启用重复
+                gesture_timer_arm(btn, PHASE_REPEAT, btn->cfg.repeat_ms); // 开始重复计时
+            } else { // 不重复
+                btn->phase = PHASE_IDLE; // 清除阶段
+            }
+            break;
+        case PHASE_REPEAT: // 按住期间重复
+            button_emit(btn, XN_BUTTON_EVT_HOLD_REPEAT, button_held_ms(btn)); // 上报重复
+            gesture_timer_arm(btn, PHASE_REPEAT, btn->cfg.repeat_ms); // 继续计时
+            break;
+        case PHASE_WAIT_SECOND: // 双击窗口结束
+            btn->phase = PHASE_IDLE; // 清除阶段
+            btn->clicks = 0; // 清除单击计数
+            button_emit(btn, XN_BUTTON_EVT_CLICK, btn->last_duration_ms); // 确认单击
+            break;
+        default: // 空闲（停止与到期竞争时可能出现）
+            break;
+    }
+}
+
+/**
+ * @brief 消抖定时器回调（esp_timer 任务）
+ */
+static void debounce_timer_cb(void *arg)
+{
+    button_t *btn = (button_t *)arg; // 获取按键状态
+    bool pressed = gpio_get_level(btn->cfg.gpio) == btn->cfg.active_level; // 读取当前状态
+
+    if (pressed != btn->pressed) { // 状态确实变化
+        btn->pressed = pressed; // 更新稳定状态
+        if (pressed) { // 按下
+            button_on_press(btn); // 处理按下
+        } else { // 松开
+            button_on_release(btn); // 处理松开
+        }
+    }
+    button_arm_level(btn); // 等待下一次电平变化
+}
+
+/**
+ * @brief GPIO中断处理：关中断并启动消抖
+ */
+static void button_isr_handler(void *arg)
+{
+    button_t *btn = (button_t *)arg; // 获取按键状态
+    gpio_intr_disable(btn->cfg.gpio); // 关中断，电平中断在消抖结束前不再触发
+    esp_timer_start_once(btn->debounce_timer, (uint64_t)btn->cfg.debounce_ms * 1000); // 启动消抖定时器
+}
+
+/**
+ * @brief 释放单个按键的中断与定时器
+ */
+static void button_release(button_t *btn)
+{
+    if (btn->isr_added) { // 如果已注册中断
+        gpio_intr_disable(btn->cfg.gpio); // 关中断
+        gpio_wakeup_disable(btn->cfg.gpio); // 关闭唤醒
+        gpio_isr_handler_remove(btn->cfg.gpio); // 移除中断处理函数
+        btn->isr_added = false; // 清除标志
+    }
+    if (btn->debounce_timer) { // 如果已创建消抖定时器
+        esp_timer_stop(btn->debounce_timer); // 停止定时器
+        esp_timer_delete(btn->debounce_timer); // 删除定时器
+        btn->debounce_timer = NULL; // 清空句柄
+    }
+    if (btn->gesture_timer) { // 如果已创建手势定时器
+        esp_timer_stop(btn->gesture_timer); // 停止定时器
+        esp_timer_delete(btn->gesture_timer); // 删除定时器
+        btn->gesture_timer = NULL; // 清空句柄
+    }
+}
+
+/**
+ * @brief 配置单个按键
+ */
+static esp_err_t button_setup(button_t *btn)
+{
+    gpio_config_t io_conf = { // GPIO配置
+        .pin_bit_mask = (1ULL << btn->cfg.gpio), // 引脚掩码
+        .mode = GPIO_MODE_INPUT, // 输入模式
+        .pull_up_en = btn->cfg.pull_up ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE, // 上拉
+        .pull_down_en = GPIO_PULLDOWN_DISABLE, // 不下拉
+        .intr_type = GPIO_INTR_DISABLE, // 先关中断，注册处理函数后再开启
+    };
+    esp_err_t ret = gpio_config(&io_conf); // 配置GPIO
+    if (ret != ESP_OK) { // 如果失败
+        return ret; // 返回错误
+    }
+
+    esp_timer_create_args_t args = { // 定时器参数
+        .callback = debounce_timer_cb, // 消抖回调
+        .arg = btn, // 回调参数
+        .dispatch_method = ESP_TIMER_TASK, // 在定时器任务中执行
+        .name = "btn_debounce", // 定时器名称
+    };
+    ret = esp_timer_create(&args, &btn->debounce_timer); // 创建消抖定时器
+    if (ret != ESP_OK) { // 如果失败
+        return ret; // 返回错误
+    }
+    args.callback = gesture_timer_cb; // 手势回调
+    args.name = "btn_gesture"; // 定时器名称
+    ret = esp_timer_create(&args, &btn->gesture_timer); // 创建手势定时器
+    if (ret != ESP_OK) { // 如果失败
+        return ret; // 返回错误
+    }
+
+    // 上电时已按住的按键视为稳定按下，松开前不产生手势
+    btn->pressed = gpio_get_level(btn->cfg.gpio) == btn->cfg.active_level; // 读取初始状态
+    btn->long_fired = btn->pressed; // 松开时不计为单击
+    btn->press_us = esp_timer_get_time(); // 初始化按下时刻
+
+    ret = gpio_isr_handler_add(btn->cfg.gpio, button_isr_handler, btn); // 注册中断处理函数
+    if (ret != ESP_OK) { // 如果失败
+        return ret; // 返回错误
+    }
+    btn->isr_added = true; // 标记已注册
+    button_arm_level(btn); // 等待第一次电平变化
+    return ESP_OK; // 返回成功
+}
+
+esp_err_t xn_button_init(const xn_button_config_t *buttons, size_t count, xn_button_cb_t cb, void *user_data)
+{
+    if (s_initialized) { // 如果已经初始化
+        return ESP_ERR_INVALID_STATE; // 返回状态错误
+    }
+    if (buttons == NULL || count == 0 || count > UINT8_MAX || cb == NULL) { // 检查参数
+        return ESP_ERR_INVALID_ARG; // 返回参数错误
+    }
+
+    s_buttons = calloc(count, sizeof(button_t)); // 分配按键状态
+    if (s_buttons == NULL) { // 如果分配失败
+        return ESP_ERR_NO_MEM; // 返回内存不足
+    }
+    s_count = count; // 保存数量
+    s_cb = cb; // 保存回调
+    s_user_data = user_data; // 保存用户数据
+
+    esp_err_t ret = gpio_install_isr_service(0); // 安装GPIO中断服务
+    if (ret == ESP_ERR_INVALID_STATE) { // 其他模块已安装
+        ret = ESP_OK; // 共用已有服务
+    }
+
+    for (size_t i = 0; i < count && ret == ESP_OK; i++) { // 逐个配置按键
+        s_buttons[i].cfg = buttons[i]; // 拷贝配置
+        s_buttons[i].id = (uint8_t)i; // 设置下标
+        ret = button_setup(&s_buttons[i]); // 配置按键
+        if (ret != ESP_OK) { // 如果失败
+            ESP_LOGE(TAG, "Failed to setup button %u (GPIO %d): %s", (unsigned)i, buttons[i].gpio,
+                     esp_err_to_name(ret)); // 打印错误日志
+        }
+    }
+
+    if (ret == ESP_OK) { // 全部配置成功
+        ret = esp_sleep_enable_gpio_wakeup(); // 允许GPIO唤醒 light sleep
+    }
+    if (ret != ESP_OK) { // 如果失败
+        for (size_t i = 0; i < count; i++) { // 释放已配置的按键
+            button_release(&s_buttons[i]); // 释放资源
+        }
+        free(s_buttons); // 释放状态数组
+        s_buttons = NULL; // 清空指针
+        s_count = 0; // 清空数量
+        return ret; // 返回错误
+    }
+
+    s_initialized = true; // 标记已初始化
+    ESP_LOGI(TAG, "Button driver initialized (%u buttons)", (unsigned)count); // 打印信息日志
+    return ESP_OK; // 返回成功
+}
+
+esp_err_t xn_button_deinit(void)
+{
+    if (!s_initialized) { // 如果未初始化
+        return ESP_ERR_INVALID_STATE; // 返回状态错误
+    }
+
+    for (size_t i = 0; i < s_count; i++) { // 逐个释放按键
+        button_release(&s_buttons[i]); // 释放资源
+    }
+    free(s_buttons); // 释放状态数组
+    s_buttons = NULL; // 清空指针
+    s_count = 0; // 清空数量
+    s_cb = NULL; // 清空回调
+    s_user_data = NULL; // 清空用户数据
+    s_initialized = false; // 清除初始化标志
+    return ESP_OK; // 返回成功
+}
+
+bool xn_button_is_pressed(uint8_t id)
+{
+    if (!s_initialized || id >= s_count) { // 未初始化或下标无效
+        return false; // 返回松开
+    }
+    return s_buttons[id].pressed; // 返回稳定状态
+}
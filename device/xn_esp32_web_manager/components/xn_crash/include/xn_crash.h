@@ -0,0 +1,140 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-28 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-28 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_crash\include\xn_crash.h
+ * @Description: 崩溃信息组件头文件 - 复位原因、flash 中的 coredump 摘要与压缩分片读取
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_CRASH_H
+#define XN_CRASH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_system.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ *                          类型定义
+ *===========================================================================*/
+
+#define XN_CRASH_CHUNK_MAGIC    0x44434E58  ///< 分片头魔数，小端字节序为 "XNCD"
+#define XN_CRASH_CHUNK_MAX      2048        ///< 单个分片最大原始字节数
+#define XN_CRASH_FLAG_LZ4       0x01        ///< 分片数据为 LZ4 块（否则为原始数据）
+#define XN_CRASH_TASK_NAME_LEN  16          ///< 崩溃任务名最大长度（含结尾 '\0'）
+#define XN_CRASH_BT_MAX         16          ///< 回溯最大深度
+
+/**
+ * @brief coredump 分片头（小端，紧随其后为 data_len 字节数据）
+ *
+ * 接收端按 offset 把解压后的 raw_len 字节写回，offset + raw_len == total 时收齐。
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;                     ///< XN_CRASH_CHUNK_MAGIC
+    uint32_t total;                     ///< coredump 总字节数
+    uint32_t offset;                    ///< 本分片在 coredump 中的偏移
+    uint16_t raw_len;                   ///< 本分片原始字节数
+    uint16_t data_len;                  ///< 分片头之后的数据字节数
+    uint8_t flags;                      ///< XN_CRASH_FLAG_*
+    uint8_t reserved[3];                ///< 保留，为0
+} xn_crash_chunk_header_t;
+
+#define XN_CRASH_PACKET_MAX     (sizeof(xn_crash_chunk_header_t) + XN_CRASH_CHUNK_MAX) ///< 单个分片包最大长度
+
+/**
+ * @brief coredump 摘要（崩溃任务、异常地址与回溯）
+ */
+typedef struct {
+    char task[XN_CRASH_TASK_NAME_LEN];  ///< 崩溃时运行的任务名
+    uint32_t pc;                        ///< 异常 PC
+    uint32_t cause;                     ///< 异常原因（Xtensa EXCCAUSE / RISC-V mcause）
+    uint32_t vaddr;                     ///< 异常访问地址（Xtensa EXCVADDR / RISC-V mtval）
+    uint32_t backtrace[XN_CRASH_BT_MAX]; ///< 回溯 PC（仅 Xtensa）
+    uint8_t depth;                      ///< 回溯深度
+    bool corrupted;                     ///< 回溯因栈损坏提前结束
+} xn_crash_summary_t;
+
+/*===========================================================================
+ *                          API
+ *===========================================================================*/
+
+/**
+ * @brief 复位原因名称
+ *
+ * @param reason esp_reset_reason() 的返回值
+ * @return const char* 名称（如 "panic"、"task_wdt"），未知值返回 "unknown"
+ */
+const char *xn_crash_reset_reason_name(esp_reset_reason_t reason);
+
+/**
+ * @brief 复位原因是否属于异常复位（panic、看门狗、掉电）
+ */
+bool xn_crash_reset_is_abnormal(esp_reset_reason_t reason);
+
+/**
+ * @brief 查询 flash 中是否有完整的 coredump
+ *
+ * @param[out] size coredump 字节数
+ * @return esp_err_t
+ *      - ESP_OK: 有，且校验通过
+ *      - ESP_ERR_NOT_FOUND: 没有或校验失败
+ *      - ESP_ERR_NOT_SUPPORTED: 未开启 CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH
+ */
+esp_err_t xn_crash_coredump_size(size_t *size);
+
+/**
+ * @brief 读取 coredump 摘要（需 ELF 格式）
+ *
+ * @param[out] summary 摘要
+ * @return esp_err_t
+ *      - ESP_OK: 成功
+ *      - ESP_ERR_NOT_FOUND: 没有 coredump
+ *      - ESP_ERR_NO_MEM: 内存不足
+ *      - ESP_ERR_NOT_SUPPORTED: 未开启写入 flash 或不是 ELF 格式
+ *      - 其他: 解析失败
+ */
+esp_err_t xn_crash_get_summary(xn_crash_summary_t *summary);
+
+/**
+ * @brief 读取一个 coredump 分片并压缩，输出分片头 + 数据
+ *
+ * 从 offset 开始读取最多 XN_CRASH_CHUNK_MAX 字节，LZ4 压缩后更短则输出压缩数据
+ * 并置 XN_CRASH_FLAG_LZ4，否则输出原始数据。调用期间临时分配约 6KB 工作内存。
+ *
+ * @param offset coredump 内偏移，从0开始，下一片为 offset + 分片头中的 raw_len
+ * @param[out] packet 输出缓冲区
+ * @param cap 输出缓冲区长度，不小于 XN_CRASH_PACKET_MAX
+ * @param[out] len 分片包长度
+ * @return esp_err_t
+ *      - ESP_OK: 成功
+ *      - ESP_ERR_INVALID_ARG: 参数无效或 offset 超出 coredump
+ *      - ESP_ERR_NOT_FOUND: 没有 coredump
+ *      - ESP_ERR_NO_MEM: 内存不足
+ *      - ESP_ERR_NOT_SUPPORTED: 未开启 CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH
+ *      - 其他: flash 读取失败
+ */
+esp_err_t xn_crash_read_chunk(size_t offset, uint8_t *packet, size_t cap, size_t *len);
+
+/**
+ * @brief 擦除 flash 中的 coredump（上传完成后调用）
+ *
+ * @return esp_err_t
+ *      - ESP_OK: 成功
+ *      - ESP_ERR_NOT_SUPPORTED: 未开启 CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH
+ *      - 其他: 擦除失败
+ */
+esp_err_t xn_crash_erase(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // XN_CRASH_H
@@ -0,0 +1,224 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-28 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-28 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_crash\src\xn_crash.c
+ * @Description: 崩溃信息组件实现 - 复位原因、coredump 摘要与压缩分片读取
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "xn_crash.h"
+#include "xn_crash_lz4.h"
+
+#if CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH
+#include "esp_core_dump.h"
+#include "esp_partition.h"
+#endif
+
+static const char *TAG = "xn_crash";
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+/**
+ * @brief 分片压缩的工作内存
+ */
+typedef struct {
+    uint8_t raw[XN_CRASH_CHUNK_MAX];            ///< 从 flash 读出的原始数据
+    uint16_t table[XN_CRASH_LZ4_TABLE_SIZE];    ///< LZ4 哈希表
+} chunk_work_t;
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+#if CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH
+/**
+ * @brief 定位 coredump：所在分区与分区内偏移
+ * @return esp_err_t ESP_OK 或 ESP_ERR_NOT_FOUND
+ */
+static esp_err_t locate(const esp_partition_t **part, size_t *part_offset, size_t *size)
+{
+    size_t addr = 0;
+    if (esp_core_dump_image_check() != ESP_OK ||
+        esp_core_dump_image_get(&addr, size) != ESP_OK || *size == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_COREDUMP, NULL);
+    if (*part == NULL || addr < (*part)->address || addr + *size > (*part)->address + (*part)->size) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *part_offset = addr - (*part)->address;
+    return ESP_OK;
+}
+#endif
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+const char *xn_crash_reset_reason_name(esp_reset_reason_t reason)
+{
+    switch (reason) {
+    case ESP_RST_POWERON:   return "poweron";
+    case ESP_RST_EXT:       return "ext";
+    case ESP_RST_SW:        return "sw";
+    case ESP_RST_PANIC:     return "panic";
+    case ESP_RST_INT_WDT:   return "int_wdt";
+    case ESP_RST_TASK_WDT:  return "task_wdt";
+    case ESP_RST_WDT:       return "wdt";
+    case ESP_RST_DEEPSLEEP: return "deepsleep";
+    case ESP_RST_BROWNOUT:  return "brownout";
+    case ESP_RST_SDIO:      return "sdio";
+    default:                return "unknown";
+    }
+}
+
+bool xn_crash_reset_is_abnormal(esp_reset_reason_t reason)
+{
+    switch (reason) {
+    case ESP_RST_PANIC:
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+    case ESP_RST_BROWNOUT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+esp_err_t xn_crash_coredump_size(size_t *size)
+{
+    if (size == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *size = 0;
+#if CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH
+    const esp_partition_t *part;
+    size_t part_offset;
+    return locate(&part, &part_offset, size);
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t xn_crash_get_summary(xn_crash_summary_t *summary)
+{
+    if (summary == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(summary, 0, sizeof(*summary));
+#if CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH && CONFIG_ESP_COREDUMP_DATA_FORMAT_ELF
+    if (esp_core_dump_image_check() != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // 摘要结构含栈转储，约数百字节，放在堆上
+    esp_core_dump_summary_t *s = malloc(sizeof(esp_core_dump_summary_t));
+    if (s == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t ret = esp_core_dump_get_summary(s);
+    if (ret == ESP_OK) {
+        strlcpy(summary->task, s->exc_task, sizeof(summary->task));
+        summary->pc = s->exc_pc;
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+        summary->cause = s->ex_info.exc_cause;
+        summary->vaddr = s->ex_info.exc_vaddr;
+        uint32_t depth = s->exc_bt_info.depth;
+        if (depth > XN_CRASH_BT_MAX) {
+            depth = XN_CRASH_BT_MAX;
+        }
+        memcpy(summary->backtrace, s->exc_bt_info.bt, depth * sizeof(uint32_t));
+        summary->depth = (uint8_t)depth;
+        summary->corrupted = s->exc_bt_info.corrupted;
+#else
+        summary->cause = s->ex_info.mcause;
+        summary->vaddr = s->ex_info.mtval;
+#endif
+    } else {
+        ESP_LOGW(TAG, "Coredump summary failed: %s", esp_err_to_name(ret));
+    }
+    free(s);
+    return ret;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t xn_crash_read_chunk(size_t offset, uint8_t *packet, size_t cap, size_t *len)
+{
+    if (packet == NULL || len == NULL || cap < XN_CRASH_PACKET_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+#if CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH
+    const esp_partition_t *part;
+    size_t part_offset;
+    size_t total;
+    esp_err_t ret = locate(&part, &part_offset, &total);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (offset >= total) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    chunk_work_t *work = malloc(sizeof(chunk_work_t));
+    if (work == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    size_t raw_len = total - offset;
+    if (raw_len > XN_CRASH_CHUNK_MAX) {
+        raw_len = XN_CRASH_CHUNK_MAX;
+    }
+    ret = esp_partition_read(part, part_offset + offset, work->raw, raw_len);
+    if (ret != ESP_OK) {
+        free(work);
+        return ret;
+    }
+
+    // 只接受比原始数据短的压缩结果
+    xn_crash_chunk_header_t hdr = {
+        .magic = XN_CRASH_CHUNK_MAGIC,
+        .total = (uint32_t)total,
+        .offset = (uint32_t)offset,
+        .raw_len = (uint16_t)raw_len,
+    };
+    uint8_t *data = packet + sizeof(hdr);
+    size_t comp_len = xn_crash_lz4_compress(work->raw, raw_len, data, raw_len - 1, work->table);
+    if (comp_len > 0) {
+        hdr.data_len = (uint16_t)comp_len;
+        hdr.flags = XN_CRASH_FLAG_LZ4;
+    } else {
+        memcpy(data, work->raw, raw_len);
+        hdr.data_len = (uint16_t)raw_len;
+    }
+    memcpy(packet, &hdr, sizeof(hdr));
+    *len = sizeof(hdr) + hdr.data_len;
+
+    free(work);
+    return ESP_OK;
+#else
+    (void)offset;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t xn_crash_erase(void)
+{
+#if CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH
+    return esp_core_dump_image_erase();
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
@@ -0,0 +1,146 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-28 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-28 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_crash\src\xn_crash_lz4.c
+ * @Description: LZ4 块格式压缩实现 - 贪心哈希匹配，coredump 中大量的零填充与重复栈帧压缩效果明显
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <string.h>
+#include "xn_crash_lz4.h"
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+#define LZ4_MIN_MATCH       4       ///< 最短匹配长度
+#define LZ4_LAST_LITERALS   5       ///< 块末尾必须是字面量的字节数
+#define LZ4_MF_LIMIT        12      ///< 最后一个匹配必须在块末尾之前这么多字节开始
+#define LZ4_MAX_OFFSET      0xFFFF  ///< 最大回溯距离
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 非对齐读取 4 字节
+ */
+static inline uint32_t read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+ * @brief 4 字节序列的哈希（Knuth 乘法哈希）
+ */
+static inline uint32_t hash32(uint32_t v)
+{
+    return (v * 2654435761u) >> (32 - XN_CRASH_LZ4_HASH_LOG);
+}
+
+/**
+ * @brief 写出长度扩展字节（token 中的 4 位字段为 15 时使用）
+ * @return uint8_t* 写入后的位置
+ */
+static uint8_t *write_length(uint8_t *op, size_t len)
+{
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+/**
+ * @brief 写出一个序列：字面量 + 可选的匹配（match_len 为 0 表示块末尾的纯字面量序列）
+ * @return uint8_t* 写入后的位置，输出空间不足时返回 NULL
+ */
+static uint8_t *write_sequence(uint8_t *op, const uint8_t *op_end,
+                               const uint8_t *lit, size_t lit_len,
+                               uint16_t offset, size_t match_len)
+{
+    // 最坏情况长度：token + 字面量长度扩展 + 字面量 + 偏移 + 匹配长度扩展
+    size_t need = 1 + lit_len / 255 + 1 + lit_len + (match_len ? 2 + match_len / 255 + 1 : 0);
+    if (need > (size_t)(op_end - op)) {
+        return NULL;
+    }
+
+    size_t ml = match_len ? match_len - LZ4_MIN_MATCH : 0;
+    uint8_t *token = op++;
+    *token = (uint8_t)(((lit_len < 15) ? lit_len : 15) << 4);
+    if (lit_len >= 15) {
+        op = write_length(op, lit_len - 15);
+    }
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+
+    if (match_len) {
+        *op++ = (uint8_t)(offset & 0xFF);
+        *op++ = (uint8_t)(offset >> 8);
+        *token |= (uint8_t)((ml < 15) ? ml : 15);
+        if (ml >= 15) {
+            op = write_length(op, ml - 15);
+        }
+    }
+    return op;
+}
+
+/*===========================================================================
+ *                          内部接口实现
+ *===========================================================================*/
+
+size_t xn_crash_lz4_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap, uint16_t *table)
+{
+    if (len > XN_CRASH_LZ4_MAX_INPUT) {
+        return 0;
+    }
+
+    const uint8_t *op_end = dst + cap;
+    uint8_t *op = dst;
+    size_t anchor = 0;
+
+    if (len > LZ4_MF_LIMIT) {
+        memset(table, 0, XN_CRASH_LZ4_TABLE_SIZE * sizeof(uint16_t));
+        const size_t match_start_limit = len - LZ4_MF_LIMIT;
+        const size_t match_end_limit = len - LZ4_LAST_LITERALS;
+        size_t ip = 0;
+
+        while (ip < match_start_limit) {
+            uint32_t seq = read32(src + ip);
+            uint32_t h = hash32(seq);
+            size_t ref = table[h];
+            table[h] = (uint16_t)ip;
+
+            // 表项初值为 0，靠内容比较排除无效的候选
+            if (ref >= ip || ip - ref > LZ4_MAX_OFFSET || read32(src + ref) != seq) {
+                ip++;
+                continue;
+            }
+
+            size_t match_len = LZ4_MIN_MATCH;
+            while (ip + match_len < match_end_limit && src[ref + match_len] == src[ip + match_len]) {
+                match_len++;
+            }
+
+            op = write_sequence(op, op_end, src + anchor, ip - anchor, (uint16_t)(ip - ref), match_len);
+            if (op == NULL) {
+                return 0;
+            }
+            ip += match_len;
+            anchor = ip;
+        }
+    }
+
+    // 剩余部分全部作为字面量
+    op = write_sequence(op, op_end, src + anchor, len - anchor, 0, 0);
+    if (op == NULL) {
+        return 0;
+    }
+    return (size_t)(op - dst);
+}
@@ -0,0 +1,44 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-28 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-28 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_crash\src\xn_crash_lz4.h
+ * @Description: LZ4 块格式压缩 - 崩溃组件内部使用
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_CRASH_LZ4_H
+#define XN_CRASH_LZ4_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define XN_CRASH_LZ4_HASH_LOG       11                              ///< 哈希表位数
+#define XN_CRASH_LZ4_TABLE_SIZE     (1u << XN_CRASH_LZ4_HASH_LOG)   ///< 哈希表条目数（每条 2 字节）
+#define XN_CRASH_LZ4_MAX_INPUT      0xFFFFu                         ///< 单块最大输入长度（位置以 16 位记录）
+
+/**
+ * @brief 压缩为 LZ4 块（不含帧头），可用 LZ4_decompress_safe 或 lz4 工具解压
+ *
+ * 贪心匹配，只换压缩率不换内存：工作内存只有调用者提供的哈希表。
+ *
+ * @param src 输入数据
+ * @param len 输入长度（不超过 XN_CRASH_LZ4_MAX_INPUT）
+ * @param dst 输出缓冲区
+ * @param cap 输出缓冲区长度
+ * @param table 哈希表，XN_CRASH_LZ4_TABLE_SIZE 个条目，内容无需初始化
+ * @return size_t 压缩后的长度，输出超出 cap 时返回 0
+ */
+size_t xn_crash_lz4_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap, uint16_t *table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XN_CRASH_LZ4_H */
@@ -43,6 +43,67 @@ typedef enum {
     XN_DISPLAY_RGB_ORDER_BGR,   ///< BGR 顺序
 } xn_display_rgb_order_t;
 
+/**
+ * @brief LVGL 渲染模式
+ */
+typedef enum {
+    XN_DISPLAY_RENDER_PARTIAL,  ///< 分块：缓冲区为 lvgl_buffer_size 像素，脏区域按条带逐块刷新
+    XN_DISPLAY_RENDER_FULL,     ///< 整帧：缓冲区为整屏大小，每次重绘整屏并整帧发送
+    XN_DISPLAY_RENDER_DIRECT,   ///< 直接：缓冲区为整屏大小，只重绘脏区域，每个脏区域一次窗口传输
+} xn_display_render_mode_t;
+
+/**
+ * @brief 显示缓冲区所在内存
+ */
+typedef enum {
+    XN_DISPLAY_BUF_INTERNAL,    ///< 内部 DMA 内存
+    XN_DISPLAY_BUF_PSRAM,       ///< PSRAM（需开启 CONFIG_SPIRAM），适合整屏缓冲区
+} xn_display_buf_mem_t;
+
+#define XN_DISPLAY_HIST_BUCKETS 8   ///< 耗时直方图桶数，上界依次为 500us/1ms/2ms/5ms/10ms/20ms/50ms/无穷
+
+/**
+ * @brief 一类耗时的统计
+ */
+typedef struct {
+    uint32_t count;                         ///< 样本数
+    uint32_t hist[XN_DISPLAY_HIST_BUCKETS]; ///< 耗时直方图
+    uint32_t max_us;                        ///< 最大耗时(us)
+    uint64_t total_us;                      ///< 累计耗时(us)
+} xn_display_timing_t;
+
+/**
+ * @brief 显示性能统计（需开启 CONFIG_XN_DISPLAY_STATS）
+ */
+typedef struct {
+    xn_display_timing_t render;             ///< 帧渲染时间（有刷新的 lv_timer_handler 调用，含等待 DMA）
+    xn_display_timing_t flush;              ///< 单次刷新时间（提交 draw_bitmap 到传输完成）
+    xn_display_timing_t lock_wait;          ///< xn_display_lock 等待时间
+    uint64_t flush_bytes;                   ///< 经 SPI 推送的像素字节数
+    uint32_t lock_timeouts;                 ///< xn_display_lock 超时次数
+    uint32_t spi_clk_hz;                    ///< SPI 时钟
+    uint32_t window_ms;                     ///< 统计窗口（自初始化或上次清零）
+} xn_display_stats_t;
+
+/**
+ * @brief LVGL 内存池统计（lv_malloc 使用的 TLSF 池）
+ */
+typedef struct {
+    uint32_t total_size;                    ///< 池总大小(字节)，含扩展的部分
+    uint32_t free_size;                     ///< 空闲字节数
+    uint32_t free_biggest;                  ///< 最大空闲块(字节)
+    uint32_t max_used;                      ///< 启动以来的峰值用量(字节)
+    uint32_t used_cnt;                      ///< 已分配块数
+    uint8_t used_pct;                       ///< 使用率(%)
+    uint8_t frag_pct;                       ///< 碎片率(%)，100 - 最大空闲块 / 空闲字节
+    bool psram;                             ///< 池位于 PSRAM
+} xn_display_mem_stats_t;
+
+/**
+ * @brief 帧前回调（在 LVGL 任务中执行，已持有 LVGL 锁）
+ */
+typedef void (*xn_display_frame_cb_t)(void *user_data);
+
 /**
  * @brief 显示配置结构
  */
@@ -62,6 +123,7 @@ typedef struct {
     int pin_bckl;                        ///< 背光引脚
     uint32_t spi_clk_hz;                 ///< SPI 时钟频率
     uint8_t spi_mode;                    ///< SPI 模式 (0-3)
+    uint8_t spi_trans_queue_depth;       ///< SPI 事务队列深度（默认10），决定可同时排队的 DMA 传输数
     
     // 显示配置
     bool mirror_x;                       ///< X 轴镜像
@@ -74,10 +136,13 @@ typedef struct {
     bool backlight_output_invert;        ///< 背光输出反转
     
     // LVGL 配置
-    uint32_t lvgl_tick_period_ms;        ///< LVGL tick 周期（默认5ms）
+    uint32_t lvgl_tick_period_ms;        ///< 保留字段：tick 改为读取 esp_timer_get_time，不再使用
     uint32_t lvgl_task_stack_size;       ///< LVGL 任务栈大小（默认4096）
     uint8_t lvgl_task_priority;          ///< LVGL 任务优先级（默认5）
-    uint32_t lvgl_buffer_size;           ///< LVGL 缓冲区大小（像素数，默认width*10）
+    uint32_t lvgl_buffer_size;           ///< LVGL 缓冲区大小（像素数，默认width*10），仅分块模式使用
+    uint8_t lvgl_buffer_count;           ///< 缓冲区个数（1 或 2，默认2），2 个时渲染与传输并行
+    xn_display_render_mode_t render_mode; ///< 渲染模式（默认分块）
+    xn_display_buf_mem_t buffer_mem;     ///< 缓冲区所在内存（默认内部 DMA 内存）
 } xn_display_config_t;
 
 /*===========================================================================
@@ -169,6 +234,77 @@ bool xn_display_lock(uint32_t timeout_ms);
  */
 void xn_display_unlock(void);
 
+/**
+ * @brief 唤醒 LVGL 任务
+ * 
+ * LVGL 任务在界面没有变化时无限期休眠。区域失效和 xn_display_unlock
+ * 会自动唤醒；输入设备等在 LVGL 之外产生事件的来源需要调用本函数。
+ * 可在任意任务中调用（不可在中断中调用）。
+ */
+void xn_display_wakeup(void);
+
+/**
+ * @brief 注册帧前回调
+ * 
+ * 回调在 LVGL 任务中、每次 lv_timer_handler 之前执行，已持有 LVGL 锁，
+ * 可直接操作 LVGL 对象。用于把其他任务写入的数据集中到每帧应用一次，
+ * 生产者只需写数据并调用 xn_display_wakeup()，无需持锁。
+ * 只支持一个回调，重复注册会覆盖；传 NULL 取消。
+ * 
+ * @param cb 回调函数
+ * @param user_data 传递给回调的用户数据
+ */
+void xn_display_set_frame_cb(xn_display_frame_cb_t cb, void *user_data);
+
+/**
+ * @brief 读取 LVGL 内存池统计
+ * 
+ * 不依赖 CONFIG_XN_DISPLAY_STATS。内部会获取 LVGL 锁，
+ * 不能在已持有 xn_display_lock 或帧前回调中调用。
+ * 
+ * @param[out] stats 统计输出
+ * @return esp_err_t 
+ *         - ESP_OK: 获取成功
+ *         - ESP_ERR_INVALID_ARG: 参数无效
+ *         - ESP_ERR_INVALID_STATE: 显示未初始化
+ *         - ESP_ERR_TIMEOUT: 100ms 内未拿到 LVGL 锁
+ */
+esp_err_t xn_display_mem_get(xn_display_mem_stats_t *stats);
+
+/**
+ * @brief 读取显示性能统计
+ * 
+ * 刷新期间 SPI 实际吞吐 = flush_bytes / flush.total_us，
+ * 与 spi_clk_hz / 8 比较可判断时钟是否还有余量；
+ * flush.total_us / window_ms 为链路占用率。
+ * 
+ * @param[out] stats 统计输出
+ * @return esp_err_t 
+ *         - ESP_OK: 获取成功
+ *         - ESP_ERR_INVALID_ARG: 参数无效
+ *         - ESP_ERR_NOT_SUPPORTED: 未开启 CONFIG_XN_DISPLAY_STATS
+ */
+esp_err_t xn_display_stats_get(xn_display_stats_t *stats);
+
+/**
+ * @brief 清空显示性能统计
+ */
+void xn_display_stats_reset(void);
+
+/**
+ * @brief 打印显示性能统计到日志
+ */
+void xn_display_stats_dump(void);
+
+/**
+ * @brief 将显示性能统计格式化为JSON，便于经MQTT上报
+ * 
+ * @param buf 输出缓冲区
+ * @param len 缓冲区长度
+ * @return int 写入的字节数（不含结束符），缓冲区不足或未开启统计时返回 -1
+ */
+int xn_display_stats_to_json(char *buf, size_t len);
+
 /**
  * @brief 获取默认配置
  * 
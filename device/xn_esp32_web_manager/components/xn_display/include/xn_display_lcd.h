@@ -30,12 +30,16 @@ extern "C" {
  * @brief 初始化 ST7789 LCD
  * 
  * @param config 显示配置
+ * @param on_trans_done 颜色数据 DMA 传输完成回调（在中断中调用），可为 NULL
+ * @param user_ctx 传给 on_trans_done 的用户数据
  * @param out_panel 输出 LCD 面板句柄
  * @param out_io 输出 LCD IO 句柄
  * @return esp_err_t 初始化结果
  */
 esp_err_t lcd_st7789_init(
     const xn_display_config_t *config,
+    esp_lcd_panel_io_color_trans_done_cb_t on_trans_done,
+    void *user_ctx,
     esp_lcd_panel_handle_t *out_panel,
     esp_lcd_panel_io_handle_t *out_io
 );
@@ -21,6 +21,8 @@ static const char *TAG = "lcd_st7789";
 
 esp_err_t lcd_st7789_init(
     const xn_display_config_t *config,
+    esp_lcd_panel_io_color_trans_done_cb_t on_trans_done,
+    void *user_ctx,
     esp_lcd_panel_handle_t *out_panel,
     esp_lcd_panel_io_handle_t *out_io)
 {
@@ -61,7 +63,9 @@ esp_err_t lcd_st7789_init(
         .lcd_cmd_bits = 8,
         .lcd_param_bits = 8,
         .spi_mode = config->spi_mode,
-        .trans_queue_depth = 10,
+        .trans_queue_depth = (config->spi_trans_queue_depth > 0) ? config->spi_trans_queue_depth : 10,
+        .on_color_trans_done = on_trans_done,  // 颜色数据传输完成后在中断中回调
+        .user_ctx = user_ctx,
     };
     
     ret = esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)config->spi_host, &io_config, out_io);
@@ -11,12 +11,23 @@
 
 #include "xn_display.h"
 #include "xn_display_lcd.h"
+#include "xn_display_stats.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "driver/ledc.h"
+#include "driver/spi_master.h"
+#include "sdkconfig.h"
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+#if CONFIG_XN_DISPLAY_LV_MEM_PSRAM
+#include "lvgl_private.h"   // lv_draw_buf_handlers_t 的定义
+#endif
 
 static const char *TAG = "xn_display";
 
@@ -33,8 +44,20 @@ typedef struct {
     lv_color_t *buf1;                       ///< 缓冲区1
     lv_color_t *buf2;                       ///< 缓冲区2
     SemaphoreHandle_t lvgl_mutex;           ///< LVGL 互斥锁
+    SemaphoreHandle_t flush_done_sem;       ///< DMA 传输完成信号（中断中释放）
+    volatile bool flush_pending;            ///< 是否有已提交、尚未传输完成的刷新
     TaskHandle_t lvgl_task_handle;          ///< LVGL 任务句柄
-    esp_timer_handle_t lvgl_tick_timer;     ///< LVGL tick 定时器
+    xn_display_frame_cb_t frame_cb;         ///< 帧前回调
+    void *frame_cb_user_data;               ///< 帧前回调用户数据
+    bool lv_mem_psram;                      ///< LVGL 内存池实际位于 PSRAM
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_handle_t pm_lock;           ///< 渲染/传输期间禁止 light sleep
+#endif
+#if CONFIG_XN_DISPLAY_STATS
+    int64_t flush_start_us;                 ///< 当前刷新提交时间
+    uint32_t flush_bytes;                   ///< 当前刷新的像素字节数
+    uint32_t flush_count;                   ///< 已提交刷新次数，用于判断一次循环是否渲染了帧
+#endif
     
     // LCD 相关
     esp_lcd_panel_handle_t panel_handle;    ///< LCD 面板句柄
@@ -52,9 +75,14 @@ static xn_display_ctx_t s_ctx = {0};
  *                          内部函数声明
  *===========================================================================*/
 
-static void lvgl_tick_timer_cb(void *arg);
+static uint32_t lvgl_tick_get_cb(void);
+static void lvgl_invalidate_cb(lv_event_t *e);
 static void lvgl_task(void *arg);
 static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map);  // LVGL 9.x API
+static void lvgl_flush_wait_cb(lv_display_t *disp);
+static bool lcd_trans_done_cb(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx);
+static esp_err_t display_buffers_alloc(size_t buf_size);
+static void lvgl_mem_init(void);
 static esp_err_t backlight_init(void);
 static esp_err_t backlight_set_duty(uint8_t brightness);
 
@@ -78,6 +106,7 @@ xn_display_config_t xn_display_get_default_config(void)
         .pin_bckl = GPIO_NUM_45,
         .spi_clk_hz = 20 * 1000 * 1000,
         .spi_mode = 3,
+        .spi_trans_queue_depth = 10,
         
         .mirror_x = true,
         .mirror_y = false,
@@ -92,6 +121,9 @@ xn_display_config_t xn_display_get_default_config(void)
         .lvgl_task_stack_size = 4096,
         .lvgl_task_priority = 5,
         .lvgl_buffer_size = 0,  // 0 表示使用默认值 width * 10
+        .lvgl_buffer_count = 2,
+        .render_mode = XN_DISPLAY_RENDER_PARTIAL,
+        .buffer_mem = XN_DISPLAY_BUF_INTERNAL,
     };
     return config;
 }
@@ -108,21 +140,42 @@ esp_err_t xn_display_init(const xn_display_config_t *config)
         return ESP_ERR_INVALID_ARG;
     }
     
+    if (config->render_mode > XN_DISPLAY_RENDER_DIRECT) {
+        ESP_LOGE(TAG, "Invalid render mode: %d", config->render_mode);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
     ESP_LOGI(TAG, "Initializing display...");
     
     // 保存配置
     memcpy(&s_ctx.config, config, sizeof(xn_display_config_t));
     
-    // 设置默认缓冲区大小
-    if (s_ctx.config.lvgl_buffer_size == 0) {
+    // 设置默认缓冲区大小：整帧/直接模式固定为整屏
+    if (s_ctx.config.render_mode != XN_DISPLAY_RENDER_PARTIAL) {
+        s_ctx.config.lvgl_buffer_size = (uint32_t)s_ctx.config.width * s_ctx.config.height;
+    } else if (s_ctx.config.lvgl_buffer_size == 0) {
         s_ctx.config.lvgl_buffer_size = s_ctx.config.width * 10;
     }
+    if (s_ctx.config.lvgl_buffer_count == 0 || s_ctx.config.lvgl_buffer_count > 2) {
+        s_ctx.config.lvgl_buffer_count = 2;
+    }
     
     esp_err_t ret;
     
+    STATS_INIT(config->spi_clk_hz);
+    
+    // 传输完成信号需先于 LCD IO 创建，中断回调会用到
+    s_ctx.flush_pending = false;
+    s_ctx.flush_done_sem = xSemaphoreCreateBinary();
+    if (s_ctx.flush_done_sem == NULL) {
+        ESP_LOGE(TAG, "Failed to create flush semaphore");
+        ret = ESP_ERR_NO_MEM;
+        goto err;
+    }
+    
     // 1. 初始化 LCD 驱动
     ESP_LOGI(TAG, "Initializing LCD driver (ST7789)...");
-    ret = lcd_st7789_init(config, &s_ctx.panel_handle, &s_ctx.io_handle);
+    ret = lcd_st7789_init(config, lcd_trans_done_cb, NULL, &s_ctx.panel_handle, &s_ctx.io_handle);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize LCD driver: %s", esp_err_to_name(ret));
         goto err;
@@ -139,6 +192,10 @@ esp_err_t xn_display_init(const xn_display_config_t *config)
     // 3. 初始化 LVGL
     ESP_LOGI(TAG, "Initializing LVGL...");
     lv_init();
+    lvgl_mem_init();
+    
+    // tick 直接读取系统时间，不需要周期定时器唤醒 CPU
+    lv_tick_set_cb(lvgl_tick_get_cb);
     
     // 4. 创建 LVGL 互斥锁
     s_ctx.lvgl_mutex = xSemaphoreCreateMutex();
@@ -148,17 +205,7 @@ esp_err_t xn_display_init(const xn_display_config_t *config)
         goto err;
     }
     
-    // 5. 分配显示缓冲区
-    size_t buf_size = s_ctx.config.lvgl_buffer_size * sizeof(lv_color_t);
-    s_ctx.buf1 = heap_caps_malloc(buf_size, MALLOC_CAP_DMA);
-    s_ctx.buf2 = heap_caps_malloc(buf_size, MALLOC_CAP_DMA);
-    if (s_ctx.buf1 == NULL || s_ctx.buf2 == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate display buffer");
-        ret = ESP_ERR_NO_MEM;
-        goto err;
-    }
-    
-    // 6. 创建显示对象 (LVGL 9.x 新 API)
+    // 5. 创建显示对象 (LVGL 9.x 新 API)
     s_ctx.disp = lv_display_create(s_ctx.config.width, s_ctx.config.height);
     if (s_ctx.disp == NULL) {
         ESP_LOGE(TAG, "Failed to create display");
@@ -166,28 +213,39 @@ esp_err_t xn_display_init(const xn_display_config_t *config)
         goto err;
     }
     
+    // 6. 分配显示缓冲区（按显示的颜色格式计算字节数）
+    lv_color_format_t cf = lv_display_get_color_format(s_ctx.disp);
+    size_t buf_size = s_ctx.config.lvgl_buffer_size * lv_color_format_get_size(cf);
+    ret = display_buffers_alloc(buf_size);
+    if (ret != ESP_OK) {
+        goto err;
+    }
+    
     // 7. 设置显示缓冲区 (LVGL 9.x 新 API)
-    lv_display_set_buffers(s_ctx.disp, s_ctx.buf1, s_ctx.buf2, buf_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    static const lv_display_render_mode_t render_modes[] = {
+        [XN_DISPLAY_RENDER_PARTIAL] = LV_DISPLAY_RENDER_MODE_PARTIAL,
+        [XN_DISPLAY_RENDER_FULL]    = LV_DISPLAY_RENDER_MODE_FULL,
+        [XN_DISPLAY_RENDER_DIRECT]  = LV_DISPLAY_RENDER_MODE_DIRECT,
+    };
+    lv_display_set_buffers(s_ctx.disp, s_ctx.buf1, s_ctx.buf2, buf_size, render_modes[s_ctx.config.render_mode]);
     
     // 8. 设置刷新回调 (LVGL 9.x 新 API)
+    // 刷新异步完成：flush_cb 只提交 DMA，传输完成中断里通知 LVGL，
+    // 期间 LVGL 可以向另一个缓冲区渲染下一块区域
     lv_display_set_flush_cb(s_ctx.disp, lvgl_flush_cb);
+    lv_display_set_flush_wait_cb(s_ctx.disp, lvgl_flush_wait_cb);
     
-    // 9. 创建 LVGL tick 定时器
-    const esp_timer_create_args_t timer_args = {
-        .callback = lvgl_tick_timer_cb,
-        .name = "lvgl_tick"
-    };
-    ret = esp_timer_create(&timer_args, &s_ctx.lvgl_tick_timer);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create LVGL tick timer: %s", esp_err_to_name(ret));
-        goto err;
-    }
+    // 有区域失效时唤醒空闲中的 LVGL 任务
+    lv_display_add_event_cb(s_ctx.disp, lvgl_invalidate_cb, LV_EVENT_INVALIDATE_AREA, NULL);
     
-    ret = esp_timer_start_periodic(s_ctx.lvgl_tick_timer, s_ctx.config.lvgl_tick_period_ms * 1000);
+    // 9. 创建电源管理锁（仅在渲染和传输期间持有）
+#if CONFIG_PM_ENABLE
+    ret = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "xn_display", &s_ctx.pm_lock);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to start LVGL tick timer: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "Failed to create PM lock: %s", esp_err_to_name(ret));
         goto err;
     }
+#endif
     
     // 10. 创建 LVGL 任务
     BaseType_t task_ret = xTaskCreate(
@@ -224,17 +282,33 @@ esp_err_t xn_display_deinit(void)
 {
     ESP_LOGI(TAG, "Deinitializing display...");
     
-    // 停止 LVGL tick 定时器
-    if (s_ctx.lvgl_tick_timer) {
-        esp_timer_stop(s_ctx.lvgl_tick_timer);
-        esp_timer_delete(s_ctx.lvgl_tick_timer);
-        s_ctx.lvgl_tick_timer = NULL;
-    }
-    
-    // 删除 LVGL 任务
+    // 删除 LVGL 任务：先拿到 LVGL 锁，保证任务不在渲染中途被删除
     if (s_ctx.lvgl_task_handle) {
+        bool locked = xSemaphoreTake(s_ctx.lvgl_mutex, portMAX_DELAY) == pdTRUE;
         vTaskDelete(s_ctx.lvgl_task_handle);
         s_ctx.lvgl_task_handle = NULL;
+        if (locked) {
+            xSemaphoreGive(s_ctx.lvgl_mutex);
+        }
+    }
+    
+    // 先释放 LCD 资源：删除 IO 时会等待排队中的 DMA 传输结束，之后才能释放缓冲区
+    if (s_ctx.panel_handle) {
+        esp_lcd_panel_del(s_ctx.panel_handle);
+        s_ctx.panel_handle = NULL;
+    }
+    if (s_ctx.io_handle) {
+        esp_lcd_panel_io_del(s_ctx.io_handle);
+        s_ctx.io_handle = NULL;
+        // 释放 SPI 总线，之后可以用不同的 spi_clk_hz 重新初始化
+        spi_bus_free((spi_host_device_t)s_ctx.config.spi_host);
+    }
+    s_ctx.flush_pending = false;
+    
+    // 删除显示对象
+    if (s_ctx.disp) {
+        lv_display_delete(s_ctx.disp);
+        s_ctx.disp = NULL;
     }
     
     // 释放显示缓冲区
@@ -252,17 +326,22 @@ esp_err_t xn_display_deinit(void)
         vSemaphoreDelete(s_ctx.lvgl_mutex);
         s_ctx.lvgl_mutex = NULL;
     }
-    
-    // 释放 LCD 资源
-    if (s_ctx.panel_handle) {
-        esp_lcd_panel_del(s_ctx.panel_handle);
-        s_ctx.panel_handle = NULL;
+    if (s_ctx.flush_done_sem) {
+        vSemaphoreDelete(s_ctx.flush_done_sem);
+        s_ctx.flush_done_sem = NULL;
     }
-    if (s_ctx.io_handle) {
-        esp_lcd_panel_io_del(s_ctx.io_handle);
-        s_ctx.io_handle = NULL;
+    
+#if CONFIG_PM_ENABLE
+    // 任务删除时可能持有锁，esp_pm_lock_delete 要求锁已释放
+    if (s_ctx.pm_lock) {
+        esp_pm_lock_release(s_ctx.pm_lock);
+        esp_pm_lock_delete(s_ctx.pm_lock);
+        s_ctx.pm_lock = NULL;
     }
+#endif
     
+    s_ctx.frame_cb = NULL;
+    s_ctx.frame_cb_user_data = NULL;
     s_ctx.initialized = false;
     
     ESP_LOGI(TAG, "Display deinitialized");
@@ -323,7 +402,14 @@ bool xn_display_lock(uint32_t timeout_ms)
         return false;
     }
     
+#if CONFIG_XN_DISPLAY_STATS
+    int64_t t0 = esp_timer_get_time();
+    bool acquired = xSemaphoreTake(s_ctx.lvgl_mutex, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+    STATS_LOCK((uint32_t)(esp_timer_get_time() - t0), acquired);
+    return acquired;
+#else
     return xSemaphoreTake(s_ctx.lvgl_mutex, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+#endif
 }
 
 void xn_display_unlock(void)
@@ -331,6 +417,58 @@ void xn_display_unlock(void)
     if (s_ctx.lvgl_mutex) {
         xSemaphoreGive(s_ctx.lvgl_mutex);
     }
+    
+    // 调用者可能修改了 UI 或创建了 LVGL 定时器，唤醒 LVGL 任务重新计算等待时间
+    xn_display_wakeup();
+}
+
+void xn_display_wakeup(void)
+{
+    if (s_ctx.lvgl_task_handle != NULL && xTaskGetCurrentTaskHandle() != s_ctx.lvgl_task_handle) {
+        xTaskNotifyGive(s_ctx.lvgl_task_handle);
+    }
+}
+
+esp_err_t xn_display_mem_get(xn_display_mem_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_ctx.lvgl_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // 直接取锁，不经过 xn_display_lock：不计入锁等待统计，也不唤醒 LVGL 任务
+    if (xSemaphoreTake(s_ctx.lvgl_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    xSemaphoreGive(s_ctx.lvgl_mutex);
+    
+    stats->total_size = (uint32_t)mon.total_size;
+    stats->free_size = (uint32_t)mon.free_size;
+    stats->free_biggest = (uint32_t)mon.free_biggest_size;
+    stats->max_used = (uint32_t)mon.max_used;
+    stats->used_cnt = (uint32_t)mon.used_cnt;
+    stats->used_pct = mon.used_pct;
+    stats->frag_pct = mon.frag_pct;
+    stats->psram = s_ctx.lv_mem_psram;
+    return ESP_OK;
+}
+
+void xn_display_set_frame_cb(xn_display_frame_cb_t cb, void *user_data)
+{
+    if (s_ctx.lvgl_mutex == NULL) {
+        return;
+    }
+    
+    // 与 LVGL 任务读取回调互斥，避免拿到新回调配旧参数
+    xSemaphoreTake(s_ctx.lvgl_mutex, portMAX_DELAY);
+    s_ctx.frame_cb = cb;
+    s_ctx.frame_cb_user_data = user_data;
+    xSemaphoreGive(s_ctx.lvgl_mutex);
+    xn_display_wakeup();
 }
 
 /*===========================================================================
@@ -338,35 +476,77 @@ void xn_display_unlock(void)
  *===========================================================================*/
 
 /**
- * @brief LVGL tick 定时器回调
+ * @brief LVGL tick 回调（毫秒）
+ */
+static uint32_t lvgl_tick_get_cb(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+/**
+ * @brief 显示区域失效回调（在修改 UI 的任务中调用，调用者持有 LVGL 锁）
  */
-static void lvgl_tick_timer_cb(void *arg)
+static void lvgl_invalidate_cb(lv_event_t *e)
 {
-    lv_tick_inc(s_ctx.config.lvgl_tick_period_ms);
+    (void)e;
+    xn_display_wakeup();
 }
 
 /**
  * @brief LVGL 任务
+ *
+ * 由事件驱动：没有待执行的 LVGL 定时器（界面无失效区域、无动画）时无限期休眠，
+ * 直到区域失效、其他任务解锁 LVGL 或 xn_display_wakeup 唤醒
  */
 static void lvgl_task(void *arg)
 {
     ESP_LOGI(TAG, "LVGL task started");
     
     while (1) {
-        // 锁定 LVGL
-        if (xn_display_lock(portMAX_DELAY)) {
+        uint32_t task_delay_ms = LV_NO_TIMER_READY;
+#if CONFIG_XN_DISPLAY_STATS
+        int64_t frame_start_us = esp_timer_get_time();
+        uint32_t flush_count = s_ctx.flush_count;
+#endif
+        
+#if CONFIG_PM_ENABLE
+        esp_pm_lock_acquire(s_ctx.pm_lock);
+#endif
+        // 锁定 LVGL（直接操作互斥锁，避免 xn_display_unlock 唤醒自己）
+        if (xSemaphoreTake(s_ctx.lvgl_mutex, portMAX_DELAY) == pdTRUE) {
+            // 先应用其他任务提交的界面数据，本帧一起渲染
+            if (s_ctx.frame_cb != NULL) {
+                s_ctx.frame_cb(s_ctx.frame_cb_user_data);
+            }
+            
             // 处理 LVGL 任务
-            uint32_t task_delay_ms = lv_timer_handler();
+            task_delay_ms = lv_timer_handler();
             
             // 解锁 LVGL
-            xn_display_unlock();
-            
-            // 延时
-            if (task_delay_ms > 500) {
-                task_delay_ms = 500;
+            xSemaphoreGive(s_ctx.lvgl_mutex);
+        }
+        
+        // 最后一块的 DMA 传输结束后才能放开 light sleep
+        lvgl_flush_wait_cb(s_ctx.disp);
+#if CONFIG_PM_ENABLE
+        esp_pm_lock_release(s_ctx.pm_lock);
+#endif
+#if CONFIG_XN_DISPLAY_STATS
+        // 只统计真正刷新了屏幕的循环，空转的定时器处理不计入帧时间
+        if (s_ctx.flush_count != flush_count) {
+            STATS_RENDER((uint32_t)(esp_timer_get_time() - frame_start_us));
+        }
+#endif
+        
+        // 没有定时器就绪时无限期等待；至少让出一个 tick，避免空转
+        TickType_t wait = portMAX_DELAY;
+        if (task_delay_ms != LV_NO_TIMER_READY) {
+            wait = pdMS_TO_TICKS(task_delay_ms);
+            if (wait == 0) {
+                wait = 1;
             }
-            vTaskDelay(pdMS_TO_TICKS(task_delay_ms));
         }
+        ulTaskNotifyTake(pdTRUE, wait);
     }
 }
 
@@ -380,11 +560,146 @@ static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px
     int offsety1 = area->y1;
     int offsety2 = area->y2;
     
-    // 绘制位图到 LCD
-    esp_lcd_panel_draw_bitmap(s_ctx.panel_handle, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1, px_map);
+    // 直接模式下 px_map 是整屏缓冲区：脏区域覆盖的整行在内存中连续，
+    // 按整行窗口一次发送，省去拷贝
+    if (s_ctx.config.render_mode == XN_DISPLAY_RENDER_DIRECT) {
+        uint32_t stride = lv_draw_buf_width_to_stride(s_ctx.config.width, lv_display_get_color_format(disp));
+        px_map += (size_t)offsety1 * stride;
+        offsetx1 = 0;
+        offsetx2 = s_ctx.config.width - 1;
+    }
+    
+    // 提交 DMA 传输，完成后由 lcd_trans_done_cb 通知 LVGL
+#if CONFIG_XN_DISPLAY_STATS
+    s_ctx.flush_bytes = (uint32_t)(offsetx2 - offsetx1 + 1) * (offsety2 - offsety1 + 1) *
+                        lv_color_format_get_size(lv_display_get_color_format(disp));
+    s_ctx.flush_count++;
+    s_ctx.flush_start_us = esp_timer_get_time();
+#endif
+    s_ctx.flush_pending = true;
+    esp_err_t ret = esp_lcd_panel_draw_bitmap(s_ctx.panel_handle, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1, px_map);
+    if (ret != ESP_OK) {
+        // 没有传输就不会有完成中断，直接结束本次刷新
+        ESP_LOGW(TAG, "draw_bitmap failed: %s", esp_err_to_name(ret));
+        s_ctx.flush_pending = false;
+        lv_display_flush_ready(disp);
+    }
+}
+
+/**
+ * @brief LVGL 等待刷新完成回调
+ *
+ * LVGL 在复用正在传输的缓冲区前调用，阻塞等待传输完成中断而不是忙等
+ */
+static void lvgl_flush_wait_cb(lv_display_t *disp)
+{
+    (void)disp;
+    while (s_ctx.flush_pending) {
+        // 超时只是兜底，防止信号与标志错过时永久阻塞
+        xSemaphoreTake(s_ctx.flush_done_sem, pdMS_TO_TICKS(100));
+    }
+}
+
+/**
+ * @brief 颜色数据 DMA 传输完成回调（SPI 中断上下文）
+ */
+static bool lcd_trans_done_cb(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
+{
+    (void)io;
+    (void)edata;
+    (void)user_ctx;
+
+    BaseType_t need_yield = pdFALSE;
+    if (s_ctx.flush_pending) {
+        s_ctx.flush_pending = false;
+#if CONFIG_XN_DISPLAY_STATS
+        STATS_FLUSH_ISR(s_ctx.flush_bytes, (uint32_t)(esp_timer_get_time() - s_ctx.flush_start_us));
+#endif
+        if (s_ctx.disp != NULL) {
+            lv_display_flush_ready(s_ctx.disp);
+        }
+        xSemaphoreGiveFromISR(s_ctx.flush_done_sem, &need_yield);
+    }
+    return need_yield == pdTRUE;
+}
+
+#if CONFIG_XN_DISPLAY_LV_MEM_PSRAM
+/**
+ * @brief 绘制缓冲区分配：优先内部 RAM，不足时退回 LVGL 内存池
+ *
+ * 与 LVGL 默认实现一样多分配 LV_DRAW_BUF_ALIGN - 1 字节，由 align_pointer_cb 对齐
+ */
+static void *lvgl_draw_buf_malloc_cb(size_t size, lv_color_format_t cf)
+{
+    (void)cf;
+    size += LV_DRAW_BUF_ALIGN - 1;
+    void *buf = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    return buf ? buf : lv_malloc(size);
+}
+
+/**
+ * @brief 绘制缓冲区释放：按地址判断来自内部 RAM 还是 LVGL 内存池（PSRAM）
+ */
+static void lvgl_draw_buf_free_cb(void *buf)
+{
+    if (esp_ptr_external_ram(buf)) {
+        lv_free(buf);
+    } else {
+        heap_caps_free(buf);
+    }
+}
+#endif
+
+/**
+ * @brief 确认 LVGL 内存池位置，池在 PSRAM 时把绘制图层改为从内部 RAM 分配
+ *
+ * 对象、样式放在 PSRAM 不影响渲染速度，软件渲染反复读写的图层留在内部 RAM，
+ * 只在渲染期间短暂占用
+ */
+static void lvgl_mem_init(void)
+{
+    // PSRAM 不足时 LV_MEM_POOL_ALLOC 会退回内部 RAM，按实际地址判断
+    void *probe = lv_malloc(1);
+    s_ctx.lv_mem_psram = (probe != NULL) && esp_ptr_external_ram(probe);
+    lv_free(probe);
+
+#if CONFIG_XN_DISPLAY_LV_MEM_PSRAM
+    if (s_ctx.lv_mem_psram) {
+        lv_draw_buf_handlers_t *handlers = lv_draw_buf_get_handlers();
+        handlers->buf_malloc_cb = lvgl_draw_buf_malloc_cb;
+        handlers->buf_free_cb = lvgl_draw_buf_free_cb;
+    } else {
+        ESP_LOGW(TAG, "Not enough PSRAM for LVGL memory pool, using internal RAM");
+    }
+#endif
+
+    ESP_LOGI(TAG, "LVGL memory pool: %u KB in %s", (unsigned)CONFIG_XN_DISPLAY_LV_MEM_KB,
+             s_ctx.lv_mem_psram ? "PSRAM" : "internal RAM");
+}
+
+/**
+ * @brief 按配置的内存类型分配显示缓冲区
+ */
+static esp_err_t display_buffers_alloc(size_t buf_size)
+{
+    bool psram = (s_ctx.config.buffer_mem == XN_DISPLAY_BUF_PSRAM);
+    uint32_t caps = psram ? (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT) : (MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
     
-    // 通知 LVGL 刷新完成 (LVGL 9.x 新 API)
-    lv_display_flush_ready(disp);
+    // PSRAM 缓冲区按 cache line 对齐，DMA 读取前的 cache 回写不会波及相邻数据
+    size_t align = psram ? 64 : 4;
+    s_ctx.buf1 = heap_caps_aligned_alloc(align, buf_size, caps);
+    if (s_ctx.config.lvgl_buffer_count > 1) {
+        s_ctx.buf2 = heap_caps_aligned_alloc(align, buf_size, caps);
+    }
+    if (s_ctx.buf1 == NULL || (s_ctx.config.lvgl_buffer_count > 1 && s_ctx.buf2 == NULL)) {
+        ESP_LOGE(TAG, "Failed to allocate display buffer (%u bytes x %u, %s)", (unsigned)buf_size,
+                 (unsigned)s_ctx.config.lvgl_buffer_count, psram ? "PSRAM" : "internal");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    ESP_LOGI(TAG, "Display buffers: %u bytes x %u in %s", (unsigned)buf_size,
+             (unsigned)s_ctx.config.lvgl_buffer_count, psram ? "PSRAM" : "internal RAM");
+    return ESP_OK;
 }
 
 /**
@@ -0,0 +1,260 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-24 20:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-24 20:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_display\src\xn_display_stats.c
+ * @Description: 显示性能统计实现 - 渲染/刷新/锁等待时间直方图与SPI字节数
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "xn_display.h"
+#include "xn_display_stats.h"
+
+#if CONFIG_XN_DISPLAY_STATS
+
+static const char *TAG = "xn_display_stats";
+
+/*===========================================================================
+ *                          内部数据
+ *===========================================================================*/
+
+// 直方图桶上界(us)，最后一个桶收纳所有更大的值；刷新在中断中记录，放在 DRAM
+static const DRAM_ATTR uint32_t s_bucket_edges_us[XN_DISPLAY_HIST_BUCKETS - 1] = {
+    500, 1000, 2000, 5000, 10000, 20000, 50000,
+};
+
+static xn_display_stats_t s_stats;                                  ///< 统计数据
+static int64_t s_window_start_us = 0;                               ///< 统计窗口起点
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;    ///< 统计数据保护锁（刷新在中断中记录）
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 计算耗时所属的直方图桶
+ * @param us 耗时(us)
+ * @return int 桶下标
+ */
+static IRAM_ATTR int bucket_of(uint32_t us)
+{
+    int i = 0;
+    while (i < XN_DISPLAY_HIST_BUCKETS - 1 && us >= s_bucket_edges_us[i]) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief 累加一个耗时样本（需持有 s_stats_lock）
+ * @param t 统计项
+ * @param us 耗时(us)
+ */
+static IRAM_ATTR void timing_add(xn_display_timing_t *t, uint32_t us)
+{
+    t->count++;
+    t->hist[bucket_of(us)]++;
+    t->total_us += us;
+    if (us > t->max_us) {
+        t->max_us = us;
+    }
+}
+
+/*===========================================================================
+ *                          内部API实现
+ *===========================================================================*/
+
+/* 初始化统计并清零 */
+void xn_display_stats_init(uint32_t spi_clk_hz)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.spi_clk_hz = spi_clk_hz;
+    s_window_start_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+/* 记录一帧渲染时间 */
+void xn_display_stats_record_render(uint32_t us)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    timing_add(&s_stats.render, us);
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+/* 记录一次刷新（SPI 中断上下文） */
+void IRAM_ATTR xn_display_stats_record_flush_isr(uint32_t bytes, uint32_t us)
+{
+    portENTER_CRITICAL_ISR(&s_stats_lock);
+    timing_add(&s_stats.flush, us);
+    s_stats.flush_bytes += bytes;
+    portEXIT_CRITICAL_ISR(&s_stats_lock);
+}
+
+/* 记录一次 xn_display_lock 等待 */
+void xn_display_stats_record_lock(uint32_t us, bool acquired)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    timing_add(&s_stats.lock_wait, us);
+    if (!acquired) {
+        s_stats.lock_timeouts++;
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+/**
+ * @brief 向 JSON 缓冲区追加一个耗时统计项
+ * @param buf 缓冲区
+ * @param len 缓冲区长度
+ * @param off 当前写入位置，成功时前移
+ * @param name 字段名
+ * @param t 统计项
+ * @return bool 空间不足时返回 false
+ */
+static bool json_add_timing(char *buf, size_t len, size_t *off, const char *name, const xn_display_timing_t *t)
+{
+    int w = snprintf(buf + *off, len - *off, ",\"%s\":{\"n\":%u,\"max\":%u,\"total\":%llu,\"hist\":[",
+                     name, (unsigned)t->count, (unsigned)t->max_us, (unsigned long long)t->total_us);
+    if (w < 0 || (size_t)w >= len - *off) {
+        return false;
+    }
+    *off += w;
+    for (int b = 0; b < XN_DISPLAY_HIST_BUCKETS; b++) {
+        w = snprintf(buf + *off, len - *off, "%s%u%s", (b > 0) ? "," : "", (unsigned)t->hist[b],
+                     (b == XN_DISPLAY_HIST_BUCKETS - 1) ? "]}" : "");
+        if (w < 0 || (size_t)w >= len - *off) {
+            return false;
+        }
+        *off += w;
+    }
+    return true;
+}
+
+#endif /* CONFIG_XN_DISPLAY_STATS */
+
+/*===========================================================================
+ *                          公共API实现
+ *===========================================================================*/
+
+/* 读取显示性能统计 */
+esp_err_t xn_display_stats_get(xn_display_stats_t *stats)
+{
+#if CONFIG_XN_DISPLAY_STATS
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    stats->window_ms = (uint32_t)((now - s_window_start_us) / 1000);
+    portEXIT_CRITICAL(&s_stats_lock);
+    return ESP_OK;
+#else
+    (void)stats;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/* 清空显示性能统计 */
+void xn_display_stats_reset(void)
+{
+#if CONFIG_XN_DISPLAY_STATS
+    portENTER_CRITICAL(&s_stats_lock);
+    uint32_t spi_clk_hz = s_stats.spi_clk_hz;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.spi_clk_hz = spi_clk_hz;
+    s_window_start_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&s_stats_lock);
+#endif
+}
+
+/* 打印显示性能统计到日志 */
+void xn_display_stats_dump(void)
+{
+#if CONFIG_XN_DISPLAY_STATS
+    xn_display_stats_t s;
+    xn_display_stats_get(&s);
+
+    // 刷新期间的实际吞吐与链路占用率
+    uint32_t kbps = s.flush.total_us ? (uint32_t)(s.flush_bytes * 8000ULL / s.flush.total_us) : 0;
+    uint32_t busy_pct = s.window_ms ? (uint32_t)(s.flush.total_us / 10ULL / s.window_ms) : 0;
+
+    ESP_LOGI(TAG, "window=%ums frames=%u render_max=%uus render_avg=%uus",
+             (unsigned)s.window_ms, (unsigned)s.render.count, (unsigned)s.render.max_us,
+             s.render.count ? (unsigned)(s.render.total_us / s.render.count) : 0);
+    ESP_LOGI(TAG, "flushes=%u bytes=%llu flush_max=%uus spi=%ukbps/%ukbps busy=%u%%",
+             (unsigned)s.flush.count, (unsigned long long)s.flush_bytes, (unsigned)s.flush.max_us,
+             (unsigned)kbps, (unsigned)(s.spi_clk_hz / 1000), (unsigned)busy_pct);
+    ESP_LOGI(TAG, "lock n=%u max=%uus timeouts=%u",
+             (unsigned)s.lock_wait.count, (unsigned)s.lock_wait.max_us, (unsigned)s.lock_timeouts);
+
+    xn_display_mem_stats_t m;
+    if (xn_display_mem_get(&m) == ESP_OK) {
+        ESP_LOGI(TAG, "lv_mem %s total=%u free=%u biggest=%u peak=%u blocks=%u used=%u%% frag=%u%%",
+                 m.psram ? "psram" : "internal", (unsigned)m.total_size, (unsigned)m.free_size,
+                 (unsigned)m.free_biggest, (unsigned)m.max_used, (unsigned)m.used_cnt,
+                 (unsigned)m.used_pct, (unsigned)m.frag_pct);
+    }
+#endif
+}
+
+/* 将显示性能统计格式化为JSON */
+int xn_display_stats_to_json(char *buf, size_t len)
+{
+#if CONFIG_XN_DISPLAY_STATS
+    xn_display_stats_t s;
+
+    if (buf == NULL || len == 0) {
+        return -1;
+    }
+    xn_display_stats_get(&s);
+
+    size_t off = 0;
+    int w = snprintf(buf, len, "{\"window_ms\":%u,\"spi_clk_hz\":%u,\"bytes\":%llu,\"lock_timeouts\":%u,"
+                     "\"edges_us\":[500,1000,2000,5000,10000,20000,50000]",
+                     (unsigned)s.window_ms, (unsigned)s.spi_clk_hz,
+                     (unsigned long long)s.flush_bytes, (unsigned)s.lock_timeouts);
+    if (w < 0 || (size_t)w >= len) {
+        return -1;
+    }
+    off = w;
+
+    if (!json_add_timing(buf, len, &off, "render", &s.render) ||
+        !json_add_timing(buf, len, &off, "flush", &s.flush) ||
+        !json_add_timing(buf, len, &off, "lock", &s.lock_wait)) {
+        return -1;
+    }
+
+    // LVGL 内存池：峰值为启动以来，不随 reset 清零
+    xn_display_mem_stats_t m;
+    if (xn_display_mem_get(&m) == ESP_OK) {
+        w = snprintf(buf + off, len - off, ",\"lv_mem\":{\"psram\":%s,\"total\":%u,\"free\":%u,"
+                     "\"biggest\":%u,\"peak\":%u,\"blocks\":%u,\"frag\":%u}",
+                     m.psram ? "true" : "false", (unsigned)m.total_size, (unsigned)m.free_size,
+                     (unsigned)m.free_biggest, (unsigned)m.max_used, (unsigned)m.used_cnt,
+                     (unsigned)m.frag_pct);
+        if (w < 0 || (size_t)w >= len - off) {
+            return -1;
+        }
+        off += w;
+    }
+
+    w = snprintf(buf + off, len - off, "}");
+    if (w < 0 || (size_t)w >= len - off) {
+        return -1;
+    }
+    return (int)(off + w);
+#else
+    (void)buf;
+    (void)len;
+    return -1;
+#endif
+}
@@ -0,0 +1,69 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-24 20:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-24 20:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_display\src\xn_display_stats.h
+ * @Description: 显示性能统计 - xn_display 内部使用
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_DISPLAY_STATS_INTERNAL_H
+#define XN_DISPLAY_STATS_INTERNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_XN_DISPLAY_STATS
+
+/**
+ * @brief 初始化统计并清零
+ * @param spi_clk_hz SPI 时钟，用于计算链路利用率
+ */
+void xn_display_stats_init(uint32_t spi_clk_hz);
+
+/**
+ * @brief 记录一帧渲染时间
+ * @param us lv_timer_handler 中包含刷新的一次调用耗时(us)
+ */
+void xn_display_stats_record_render(uint32_t us);
+
+/**
+ * @brief 记录一次刷新（SPI 中断上下文）
+ * @param bytes 推送的像素字节数
+ * @param us 提交 draw_bitmap 到传输完成的时间(us)
+ */
+void xn_display_stats_record_flush_isr(uint32_t bytes, uint32_t us);
+
+/**
+ * @brief 记录一次 xn_display_lock 等待
+ * @param us 等待时间(us)
+ * @param acquired 是否拿到锁（false 为超时）
+ */
+void xn_display_stats_record_lock(uint32_t us, bool acquired);
+
+#define STATS_INIT(hz)                  xn_display_stats_init((hz))
+#define STATS_RENDER(us)                xn_display_stats_record_render((us))
+#define STATS_FLUSH_ISR(bytes, us)      xn_display_stats_record_flush_isr((bytes), (us))
+#define STATS_LOCK(us, acquired)        xn_display_stats_record_lock((us), (acquired))
+
+#else
+
+#define STATS_INIT(hz)                  do { } while (0)
+#define STATS_RENDER(us)                do { } while (0)
+#define STATS_FLUSH_ISR(bytes, us)      do { } while (0)
+#define STATS_LOCK(us, acquired)        do { } while (0)
+
+#endif /* CONFIG_XN_DISPLAY_STATS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XN_DISPLAY_STATS_INTERNAL_H */
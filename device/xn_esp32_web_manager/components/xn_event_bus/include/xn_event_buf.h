@@ -0,0 +1,89 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-25 14:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-25 14:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_event_bus\include\xn_event_buf.h
+ * @Description: 引用计数事件缓冲区 - 多订阅者共享同一份负载，最后一个引用释放时回收
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_EVENT_BUF_H
+#define XN_EVENT_BUF_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ *                          数据类型
+ *===========================================================================*/
+
+/**
+ * @brief 引用计数缓冲区句柄（不透明类型）
+ *
+ * 用法约定：
+ * - xn_event_buf_alloc 返回的缓冲区持有 1 个引用，归调用者所有；
+ * - 通过 xn_event_post_buf 发布后，该引用转交给事件总线；
+ * - 订阅者在回调中拿到的是借用视图（event->data），回调返回后即失效；
+ *   如需在回调之外继续使用，先对 event->buf 调用 xn_event_buf_retain，
+ *   用完后再调用 xn_event_buf_release；
+ * - 最后一个引用释放时缓冲区被回收。
+ */
+typedef struct xn_event_buf xn_event_buf_t;
+
+/*===========================================================================
+ *                          API
+ *===========================================================================*/
+
+/**
+ * @brief 分配引用计数缓冲区
+ *
+ * 数据区按8字节对齐，可直接存放负载结构体。
+ * 小缓冲区优先从事件负载内存池分配，超尺寸时回退堆分配。
+ *
+ * @param len 数据区字节数
+ * @return xn_event_buf_t* 缓冲区句柄（引用计数为1），失败返回 NULL
+ */
+xn_event_buf_t *xn_event_buf_alloc(size_t len);
+
+/**
+ * @brief 增加一个引用
+ *
+ * @param buf 缓冲区句柄，NULL 时忽略
+ * @return xn_event_buf_t* 同一个句柄，便于链式使用
+ */
+xn_event_buf_t *xn_event_buf_retain(xn_event_buf_t *buf);
+
+/**
+ * @brief 释放一个引用，计数归零时回收缓冲区
+ *
+ * @param buf 缓冲区句柄，NULL 时忽略
+ */
+void xn_event_buf_release(xn_event_buf_t *buf);
+
+/**
+ * @brief 获取数据区指针
+ *
+ * @param buf 缓冲区句柄
+ * @return void* 数据区指针，buf 为 NULL 时返回 NULL
+ */
+void *xn_event_buf_data(const xn_event_buf_t *buf);
+
+/**
+ * @brief 获取数据区长度
+ *
+ * @param buf 缓冲区句柄
+ * @return size_t 数据区字节数，buf 为 NULL 时返回 0
+ */
+size_t xn_event_buf_len(const xn_event_buf_t *buf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XN_EVENT_BUF_H */
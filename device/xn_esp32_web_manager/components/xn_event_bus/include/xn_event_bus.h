@@ -15,7 +15,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "esp_err.h"
+#include "sdkconfig.h"
 #include "xn_event_types.h"
+#include "xn_event_buf.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,11 +28,27 @@ extern "C" {
  *===========================================================================*/
 
 #ifndef XN_EVENT_QUEUE_SIZE
-#define XN_EVENT_QUEUE_SIZE         32  ///< 事件队列深度，决定可以缓冲多少个未处理事件
+#define XN_EVENT_QUEUE_SIZE         32  ///< 普通优先级队列深度，决定可以缓冲多少个未处理事件
+#endif
+
+#ifndef XN_EVENT_QUEUE_SIZE_CRITICAL
+#define XN_EVENT_QUEUE_SIZE_CRITICAL 16 ///< 关键优先级队列深度
+#endif
+
+#ifndef XN_EVENT_QUEUE_SIZE_BULK
+#define XN_EVENT_QUEUE_SIZE_BULK    16  ///< 批量优先级队列深度
+#endif
+
+#ifndef XN_EVENT_PRIO_OVERRIDE_MAX
+#define XN_EVENT_PRIO_OVERRIDE_MAX  16  ///< 按事件ID覆盖优先级的最大条目数
 #endif
 
 #ifndef XN_EVENT_MAX_SUBSCRIBERS
-#define XN_EVENT_MAX_SUBSCRIBERS    16  ///< 最大订阅者数量限制（注意：当前实现使用链表，此宏可能未实际限制链表长度，取决于具体实现）
+#define XN_EVENT_MAX_SUBSCRIBERS    16  ///< 预期订阅者数量（仅用于日志提示；订阅表为按需扩展的连续快照，不做硬性限制）
+#endif
+
+#ifndef XN_EVENT_POLICY_MAX
+#define XN_EVENT_POLICY_MAX         16  ///< 可注册投递策略的事件ID最大数量
 #endif
 
 #ifndef XN_EVENT_TASK_STACK_SIZE
@@ -41,10 +59,48 @@ extern "C" {
 #define XN_EVENT_TASK_PRIORITY      5    ///< 事件分发任务的优先级
 #endif
 
+#ifndef XN_EVENT_DRAIN_BATCH
+#define XN_EVENT_DRAIN_BATCH        8    ///< 分发任务每次唤醒最多批量取出的事件数
+#endif
+
+#ifndef XN_EVENT_WORKER_COUNT
+#define XN_EVENT_WORKER_COUNT       1    ///< 分发任务数量，大于1时不再保证事件间的处理顺序
+#endif
+
+#ifndef XN_EVENT_WORKER_PIN_CORE
+#define XN_EVENT_WORKER_PIN_CORE    1    ///< 多个分发任务时是否按核轮流绑定(1:绑定 0:不绑定)
+#endif
+
+#ifndef XN_EVENT_SUB_TASK_STACK_SIZE
+#define XN_EVENT_SUB_TASK_STACK_SIZE 4096 ///< 独立任务订阅者的默认堆栈大小(字节)
+#endif
+
+#ifndef XN_EVENT_SUB_TASK_PRIORITY
+#define XN_EVENT_SUB_TASK_PRIORITY  (XN_EVENT_TASK_PRIORITY - 1) ///< 独立任务订阅者的默认优先级
+#endif
+
+#ifndef XN_EVENT_SUB_QUEUE_SIZE
+#define XN_EVENT_SUB_QUEUE_SIZE     16   ///< 独立任务订阅者的默认邮箱深度
+#endif
+
 /*===========================================================================
  *                          数据类型
  *===========================================================================*/
 
+/**
+ * @brief 事件优先级（分发通道）
+ * 
+ * 每个优先级对应独立的队列，分发任务总是先取高优先级通道中的事件，
+ * 低优先级通道满时不会挤占高优先级事件的队列空间。
+ * 默认按事件类别归类：系统/WiFi 为关键，传感器/音频为批量，其余为普通。
+ */
+typedef enum {
+    XN_EVENT_PRIO_CRITICAL = 0,     ///< 关键：系统与网络状态事件
+    XN_EVENT_PRIO_NORMAL,           ///< 普通：命令、按键、MQTT等
+    XN_EVENT_PRIO_BULK,             ///< 批量：遥测、进度等高频数据
+    XN_EVENT_PRIO_MAX,
+} xn_event_priority_t;
+
 /**
  * @brief 事件结构体
  * 
@@ -57,6 +113,10 @@ typedef struct {
     void *data;             ///< 数据指针，指向携带的负载数据
     size_t data_len;        ///< 数据长度(字节)
     bool auto_free;         ///< 标志位：是否由事件总线自动释放data内存
+    xn_event_buf_t *buf;    ///< 引用计数缓冲区，非NULL时data指向其数据区，分发完成后总线释放一个引用
+#if CONFIG_XN_EVENT_BUS_TRACE
+    uint32_t queued_us;     ///< 入队时刻(us，esp_timer 低32位)，总线内部用于统计等待时间，发布者无需填写
+#endif
 } xn_event_t;
 
 /**
@@ -67,6 +127,100 @@ typedef struct {
  */
 typedef void (*xn_event_handler_t)(const xn_event_t *event, void *user_data);
 
+/**
+ * @brief 事件总线统计信息
+ * 
+ * 负载内存池相关计数来自 xn_event_post_data 的分配路径。
+ */
+typedef struct {
+    uint32_t published;         ///< 已发布事件计数
+    uint32_t delivered;         ///< 已投递(处理)事件计数
+    uint32_t dropped;           ///< 丢弃事件计数(队列满，含独立任务订阅者邮箱满)
+    uint32_t lane_dropped[XN_EVENT_PRIO_MAX]; ///< 按优先级通道统计的队列满丢弃计数
+    uint32_t pool_hits;         ///< 负载从静态内存池分配的次数
+    uint32_t pool_misses;       ///< 负载回退到堆分配的次数（超尺寸或池耗尽）
+    uint32_t pool_in_use;       ///< 当前占用的池块数量
+    uint32_t pool_high_water;   ///< 池块占用历史最高值
+} xn_event_bus_stats_t;
+
+/**
+ * @brief 事件投递策略类型
+ */
+typedef enum {
+    XN_EVENT_POLICY_DEFAULT = 0,        ///< 默认：非阻塞入队，队列满则丢弃
+    XN_EVENT_POLICY_LATEST_ONLY,        ///< 只保留最新值：已有待分发事件时原地替换，不占新队列位
+    XN_EVENT_POLICY_RATE_LIMIT,         ///< 限速：每秒最多 rate_per_sec 个，超出丢弃
+    XN_EVENT_POLICY_BLOCK_WITH_TIMEOUT, ///< 阻塞：队列满时最多等待 timeout_ms 再丢弃
+} xn_event_policy_type_t;
+
+/**
+ * @brief 事件投递策略
+ */
+typedef struct {
+    xn_event_policy_type_t type;    ///< 策略类型
+    uint32_t rate_per_sec;          ///< RATE_LIMIT：每秒允许的事件数（同时为突发上限）
+    uint32_t timeout_ms;            ///< BLOCK_WITH_TIMEOUT：队列满时的最长等待时间(ms)
+} xn_event_policy_t;
+
+#define XN_EVENT_POLICY_LATEST()        ((xn_event_policy_t){ .type = XN_EVENT_POLICY_LATEST_ONLY })
+#define XN_EVENT_POLICY_RATE(n)         ((xn_event_policy_t){ .type = XN_EVENT_POLICY_RATE_LIMIT, .rate_per_sec = (n) })
+#define XN_EVENT_POLICY_BLOCK(ms)       ((xn_event_policy_t){ .type = XN_EVENT_POLICY_BLOCK_WITH_TIMEOUT, .timeout_ms = (ms) })
+
+/**
+ * @brief 单个事件ID的策略统计
+ */
+typedef struct {
+    uint32_t published;             ///< 异步发布次数
+    uint32_t dropped;               ///< 丢弃次数（限速或队列满）
+    uint32_t coalesced;             ///< 被更新值原地替换的次数（LATEST_ONLY）
+    uint32_t pending;               ///< 当前槽位中待分发的事件数（0或1）
+} xn_event_policy_stats_t;
+
+#define XN_EVENT_HIST_BUCKETS   8   ///< 延迟直方图桶数，上界依次为 100us/1ms/5ms/20ms/50ms/200ms/1s/无穷
+
+/**
+ * @brief 单个事件ID的延迟统计（需开启 CONFIG_XN_EVENT_BUS_TRACE）
+ */
+typedef struct {
+    uint16_t event_id;                              ///< 事件ID，0xFFFF 表示超出跟踪数量的事件合并条目
+    uint32_t count;                                 ///< 经队列分发的次数
+    uint32_t wait_hist[XN_EVENT_HIST_BUCKETS];      ///< 队列等待时间直方图（发布到开始分发，us精度）
+    uint32_t handler_hist[XN_EVENT_HIST_BUCKETS];   ///< 订阅者回调执行时间直方图（每个订阅者计一次）
+    uint32_t wait_max_us;                           ///< 最长队列等待时间(us)
+    uint32_t handler_max_us;                        ///< 最长回调执行时间(us)
+    xn_event_handler_t slowest_handler;             ///< 最长执行时间对应的回调函数地址
+} xn_event_trace_entry_t;
+
+/**
+ * @brief 分发历史条目（需开启 CONFIG_XN_EVENT_BUS_HISTORY）
+ */
+typedef struct {
+    uint16_t event_id;                              ///< 事件ID
+    uint16_t source;                                ///< 事件源
+    uint32_t timestamp;                             ///< 事件产生的时间戳(ms)
+} xn_event_history_entry_t;
+
+/**
+ * @brief 独立任务订阅者配置
+ */
+typedef struct {
+    uint32_t stack_size;        ///< 任务堆栈大小(字节)
+    uint32_t priority;          ///< 任务优先级
+    uint16_t queue_size;        ///< 邮箱深度，满时丢弃并计入 dropped
+    int core_id;                ///< 绑定的CPU核，-1 表示不绑定
+} xn_event_sub_task_cfg_t;
+
+/**
+ * @brief 独立任务订阅者默认配置
+ */
+#define XN_EVENT_SUB_TASK_DEFAULT_CONFIG()              \
+    (xn_event_sub_task_cfg_t){                          \
+        .stack_size = XN_EVENT_SUB_TASK_STACK_SIZE,     \
+        .priority   = XN_EVENT_SUB_TASK_PRIORITY,       \
+        .queue_size = XN_EVENT_SUB_QUEUE_SIZE,          \
+        .core_id    = -1,                               \
+    }
+
 /*===========================================================================
  *                          核心API
  *===========================================================================*/
@@ -98,18 +252,37 @@ esp_err_t xn_event_bus_deinit(void);
 /**
  * @brief 发布事件（异步）
  * 
- * 将事件放入队列，由后台任务异步分发给订阅者。
- * 如果队列已满，此函数可能会失败或阻塞（取决于实现）。
+ * 将事件放入其优先级对应的队列，由后台任务异步分发给订阅者。
+ * 如果该优先级队列已满，事件被丢弃并返回失败；注册了投递策略的事件
+ * 按策略合并、限速或阻塞等待（见 xn_event_set_policy）。
  * 
  * @param event 指向要发布的事件结构体
  * @return esp_err_t 
  *      - ESP_OK: 发布成功入队
  *      - ESP_ERR_INVALID_STATE: 总线未初始化
  *      - ESP_ERR_INVALID_ARG: 参数无效
- *      - ESP_FAIL: 队列满
+ *      - ESP_FAIL: 队列满或被限速丢弃
  */
 esp_err_t xn_event_publish(const xn_event_t *event);
 
+/**
+ * @brief 批量发布事件（异步）
+ * 
+ * 整组事件依次入队后一次性唤醒分发任务，适合状态+数据+后续命令这类突发。
+ * 发布前检查各优先级队列的剩余空间，不足时整组丢弃；同一通道内的事件
+ * 保持数组顺序。各事件的投递策略照常生效，但 BLOCK_WITH_TIMEOUT 不等待。
+ * 与 xn_event_publish 相同，事件携带的数据（auto_free / buf）无论成败均由总线接管。
+ * 
+ * @param events 事件数组
+ * @param n 事件数量
+ * @return esp_err_t 
+ *      - ESP_OK: 全部发布成功
+ *      - ESP_ERR_INVALID_STATE: 总线未初始化
+ *      - ESP_ERR_INVALID_ARG: 参数无效
+ *      - ESP_FAIL: 队列空间不足整组丢弃，或个别事件被限速/竞争丢弃
+ */
+esp_err_t xn_event_publish_batch(const xn_event_t *events, size_t n);
+
 /**
  * @brief 发布事件（同步）
  * 
@@ -139,6 +312,8 @@ esp_err_t xn_event_post(uint16_t event_id, uint16_t source);
  * @brief 快速发布带数据事件（自动拷贝）
  * 
  * 辅助函数，会分配新内存并拷贝数据，设置 auto_free=true。
+ * 负载优先从总线内置的固定块内存池分配（尺寸等级见 xn_event_pool.h），
+ * 超尺寸或池耗尽时回退到堆分配。
  * 
  * @param event_id 事件ID
  * @param source 事件源
@@ -149,6 +324,24 @@ esp_err_t xn_event_post(uint16_t event_id, uint16_t source);
 esp_err_t xn_event_post_data(uint16_t event_id, uint16_t source, 
                               const void *data, size_t len);
 
+/**
+ * @brief 发布引用计数缓冲区事件（零拷贝）
+ * 
+ * 不拷贝数据，事件的 data/data_len 指向 buf 的数据区。
+ * 调用者持有的一个引用转交给总线：无论成功与否，调用返回后调用者
+ * 都不应再释放该引用；分发完成或发布失败时由总线释放。
+ * 订阅者如需在回调之外持有数据，应对 event->buf 调用 xn_event_buf_retain。
+ * 
+ * @param event_id 事件ID
+ * @param source 事件源
+ * @param buf 引用计数缓冲区
+ * @return esp_err_t 
+ *      - ESP_OK: 发布成功入队
+ *      - ESP_ERR_INVALID_ARG: buf 为 NULL
+ *      - 其余见 xn_event_publish 返回值
+ */
+esp_err_t xn_event_post_buf(uint16_t event_id, uint16_t source, xn_event_buf_t *buf);
+
 /**
  * @brief 订阅事件
  * 
@@ -166,6 +359,71 @@ esp_err_t xn_event_post_data(uint16_t event_id, uint16_t source,
 esp_err_t xn_event_subscribe(uint16_t event_id, xn_event_handler_t handler, 
                               void *user_data);
 
+/**
+ * @brief 订阅事件（在订阅者独立任务中回调）
+ * 
+ * 为该订阅创建专用邮箱和任务，分发任务只把事件投递到邮箱即返回，
+ * 回调在独立任务中执行，慢速订阅者（如需要持有LVGL锁的显示模块）
+ * 不会阻塞其他订阅者。投递时携带的数据会被保留：引用计数缓冲区增加引用，
+ * 其他数据拷贝一份，回调返回后自动释放。
+ * 使用 xn_event_unsubscribe / xn_event_unsubscribe_all 取消，邮箱中已有事件
+ * 处理完毕后任务自行退出。
+ * 
+ * @param event_id 要订阅的事件ID，使用 XN_EVT_ANY 订阅所有事件
+ * @param handler 回调函数
+ * @param user_data 传递给回调的用户数据
+ * @param cfg 任务配置，NULL 使用 XN_EVENT_SUB_TASK_DEFAULT_CONFIG
+ * @return esp_err_t 
+ *      - ESP_OK: 订阅成功
+ *      - ESP_ERR_INVALID_STATE: 总线未初始化
+ *      - ESP_ERR_INVALID_ARG: 参数无效
+ *      - ESP_ERR_NO_MEM: 内存不足
+ */
+esp_err_t xn_event_subscribe_on_task(uint16_t event_id, xn_event_handler_t handler,
+                                     void *user_data, const xn_event_sub_task_cfg_t *cfg);
+
+/**
+ * @brief 设置事件的分发优先级
+ * 
+ * 覆盖按类别推导的默认优先级，最多 XN_EVENT_PRIO_OVERRIDE_MAX 条。
+ * 
+ * @param event_id 事件ID
+ * @param prio 优先级
+ * @return esp_err_t 
+ *      - ESP_OK: 设置成功
+ *      - ESP_ERR_INVALID_ARG: 参数无效
+ *      - ESP_ERR_NO_MEM: 覆盖表已满
+ */
+esp_err_t xn_event_set_priority(uint16_t event_id, xn_event_priority_t prio);
+
+/**
+ * @brief 设置事件的投递策略
+ * 
+ * 策略只作用于异步发布（xn_event_publish 及 post 系列），同步发布不受影响。
+ * 应在该事件开始发布前注册；重复调用可修改策略。
+ * 
+ * @param event_id 事件ID
+ * @param policy 投递策略，如 XN_EVENT_POLICY_LATEST()、XN_EVENT_POLICY_RATE(10)
+ * @return esp_err_t 
+ *      - ESP_OK: 设置成功
+ *      - ESP_ERR_INVALID_ARG: 参数无效
+ *      - ESP_ERR_INVALID_STATE: LATEST_ONLY 槽位中仍有待分发事件，不能切换为其他策略
+ *      - ESP_ERR_NO_MEM: 策略表已满(XN_EVENT_POLICY_MAX)
+ */
+esp_err_t xn_event_set_policy(uint16_t event_id, const xn_event_policy_t *policy);
+
+/**
+ * @brief 获取指定事件ID的策略统计
+ * 
+ * @param event_id 事件ID
+ * @param[out] stats 统计信息输出
+ * @return esp_err_t 
+ *      - ESP_OK: 获取成功
+ *      - ESP_ERR_INVALID_ARG: 参数无效
+ *      - ESP_ERR_NOT_FOUND: 该事件未注册策略
+ */
+esp_err_t xn_event_get_policy_stats(uint16_t event_id, xn_event_policy_stats_t *stats);
+
 /**
  * @brief 取消订阅
  * 
@@ -193,10 +451,115 @@ esp_err_t xn_event_unsubscribe_all(xn_event_handler_t handler);
 /**
  * @brief 获取待处理事件数量
  * 
- * @return uint32_t 队列中等待分发的事件数量
+ * @return uint32_t 所有优先级队列中等待分发的事件总数
  */
 uint32_t xn_event_pending_count(void);
 
+/**
+ * @brief 获取事件总线统计信息
+ * 
+ * @param[out] stats 统计信息输出
+ * @return esp_err_t 
+ *      - ESP_OK: 获取成功
+ *      - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t xn_event_bus_get_stats(xn_event_bus_stats_t *stats);
+
+/*===========================================================================
+ *                          延迟统计API（CONFIG_XN_EVENT_BUS_TRACE）
+ *===========================================================================*/
+
+/**
+ * @brief 运行时打开或关闭延迟统计
+ * 
+ * 统计默认打开。关闭后入队与分发不再取时间戳，已有统计保留，
+ * 关闭期间入队的事件在重新打开后也不计入等待时间。
+ * 
+ * @param enable true 打开，false 关闭
+ * @return esp_err_t 
+ *      - ESP_OK: 设置成功
+ *      - ESP_ERR_NOT_SUPPORTED: 未开启 CONFIG_XN_EVENT_BUS_TRACE
+ */
+esp_err_t xn_event_bus_trace_enable(bool enable);
+
+/**
+ * @brief 读取所有事件ID的延迟统计
+ * 
+ * @param[out] entries 统计条目输出数组
+ * @param max 数组容量
+ * @param[out] count 实际输出的条目数
+ * @return esp_err_t 
+ *      - ESP_OK: 获取成功
+ *      - ESP_ERR_INVALID_ARG: 参数无效
+ *      - ESP_ERR_NOT_SUPPORTED: 未开启 CONFIG_XN_EVENT_BUS_TRACE
+ */
+esp_err_t xn_event_trace_snapshot(xn_event_trace_entry_t *entries, size_t max, size_t *count);
+
+/**
+ * @brief 读取各优先级队列的占用高水位
+ * 
+ * @param[out] high_water 各通道历史最大排队数
+ * @return esp_err_t 
+ *      - ESP_OK: 获取成功
+ *      - ESP_ERR_INVALID_ARG: 参数无效
+ *      - ESP_ERR_NOT_SUPPORTED: 未开启 CONFIG_XN_EVENT_BUS_TRACE
+ */
+esp_err_t xn_event_trace_get_high_water(uint32_t high_water[XN_EVENT_PRIO_MAX]);
+
+/**
+ * @brief 清空延迟统计与队列高水位
+ */
+void xn_event_trace_reset(void);
+
+/**
+ * @brief 打印延迟统计到日志（不可重入）
+ */
+void xn_event_trace_dump(void);
+
+/**
+ * @brief 将延迟统计格式化为JSON，便于经MQTT上报（不可重入）
+ * 
+ * @param buf 输出缓冲区
+ * @param len 缓冲区长度
+ * @return int 写入的字节数（不含结束符），缓冲区不足或未开启统计时返回 -1
+ */
+int xn_event_trace_to_json(char *buf, size_t len);
+
+/*===========================================================================
+ *                          分发历史API（CONFIG_XN_EVENT_BUS_HISTORY）
+ *===========================================================================*/
+
+/**
+ * @brief 读取本次运行最近分发的事件（按时间从旧到新）
+ * 
+ * 历史保存在 RTC 内存中，软件复位、panic 与看门狗复位后由 xn_event_bus_init
+ * 转存，可通过 xn_event_history_get_previous 读回，用于定位崩溃前的事件序列。
+ * 
+ * @param[out] entries 历史条目输出数组
+ * @param max 数组容量，历史更长时保留最新的 max 条
+ * @param[out] count 实际输出的条目数
+ * @return esp_err_t 
+ *      - ESP_OK: 获取成功
+ *      - ESP_ERR_INVALID_ARG: 参数无效
+ *      - ESP_ERR_NOT_SUPPORTED: 未开启 CONFIG_XN_EVENT_BUS_HISTORY
+ */
+esp_err_t xn_event_history_snapshot(xn_event_history_entry_t *entries, size_t max, size_t *count);
+
+/**
+ * @brief 读取上次运行（复位前）最后分发的事件（按时间从旧到新）
+ * 
+ * 上电或掉电复位后 RTC 内存无效，count 为 0。
+ * 
+ * @param[out] entries 历史条目输出数组
+ * @param max 数组容量，历史更长时保留最新的 max 条
+ * @param[out] count 实际输出的条目数
+ * @return esp_err_t 
+ *      - ESP_OK: 获取成功
+ *      - ESP_ERR_INVALID_ARG: 参数无效
+ *      - ESP_ERR_NOT_SUPPORTED: 未开启 CONFIG_XN_EVENT_BUS_HISTORY
+ */
+esp_err_t xn_event_history_get_previous(xn_event_history_entry_t *entries, size_t max, size_t *count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -51,10 +51,26 @@ typedef enum {
     XN_EVT_SYSTEM_INIT_DONE     = 0x0001,   ///< 系统初始化完成
     XN_EVT_SYSTEM_READY         = 0x0002,   ///< 系统准备就绪（所有服务已启动）
     XN_EVT_SYSTEM_ERROR         = 0x0003,   ///< 系统级错误
-    XN_EVT_SYSTEM_LOW_MEMORY    = 0x0004,   ///< 内存不足警告
+    XN_EVT_SYSTEM_LOW_MEMORY    = 0x0004,   ///< 内存不足警告（携带 xn_evt_low_memory_t）
     XN_EVT_SYSTEM_REBOOT        = 0x0005,   ///< 系统即将重启
+    XN_EVT_SYSTEM_STATE_TIMEOUT = 0x0006,   ///< 应用状态机停留某状态超时
+    XN_EVT_SYSTEM_OTA_STAGED    = 0x0007,   ///< 新固件已在后台下载完成，等待重启生效
+    XN_EVT_SYSTEM_OTA_CHECK_DONE = 0x0008,  ///< 应用状态机的 OTA 检查完成，无需激活或升级
+    XN_EVT_SYSTEM_OTA_REBOOT_SKIPPED = 0x0009,  ///< 待生效固件已不存在，取消重启
 } xn_event_system_t;
 
+/**
+ * @brief 内存不足事件数据
+ *
+ * 某类堆内存的最大可分配块低于阈值时发布一次，恢复到阈值以上后才会再次发布。
+ */
+typedef struct {
+    uint32_t caps;          ///< 堆内存类型（MALLOC_CAP_INTERNAL / MALLOC_CAP_DMA / MALLOC_CAP_SPIRAM）
+    uint32_t free;          ///< 当前空闲字节数
+    uint32_t largest;       ///< 当前最大可分配块字节数
+    uint32_t threshold;     ///< 触发阈值（字节）
+} xn_evt_low_memory_t;
+
 /*===========================================================================
  *                          WiFi事件 (0x0100 - 0x01FF)
  *===========================================================================*/
@@ -70,6 +86,8 @@ typedef enum {
     XN_EVT_WIFI_GOT_IP          = 0x0105,   ///< 已获取IP地址（携带 xn_evt_wifi_got_ip_t）
     XN_EVT_WIFI_LOST_IP         = 0x0106,   ///< 丢失IP地址
     XN_EVT_WIFI_PROV_REQUIRED   = 0x0107,   ///< 需要进行配网（无配置或连接失败）
+    XN_EVT_WIFI_LINK_QUALITY    = 0x0108,   ///< 链路质量采样（携带 xn_evt_wifi_link_t，只保留最新值）
+    XN_EVT_WIFI_ROAMING         = 0x0109,   ///< 链路变弱，开始切换到更好的AP（携带 xn_evt_wifi_connected_t 目标AP）
     XN_EVT_WIFI_SCAN_DONE       = 0x0110,   ///< WiFi扫描完成
 } xn_event_wifi_t;
 
@@ -83,6 +101,21 @@ typedef struct {
     uint8_t channel;        ///< 信道
 } xn_evt_wifi_connected_t;
 
+/**
+ * @brief WiFi链路质量事件数据
+ *
+ * 平滑值为指数加权移动平均，偏差为平滑后的 |采样 - 平均|，反映信号抖动。
+ */
+typedef struct {
+    int8_t rssi;            ///< 本次采样的信号强度(dBm)
+    int8_t rssi_avg;        ///< 平滑后的信号强度(dBm)
+    uint8_t rssi_dev;       ///< 平滑后的平均偏差(dB)
+    uint8_t channel;        ///< 信道
+    uint8_t phy;            ///< PHY模式位：bit0 11b、bit1 11g、bit2 11n、bit3 LR
+    uint8_t weak_samples;   ///< 平滑值连续低于漫游阈值的采样数
+    uint32_t samples;       ///< 本次连接以来的采样数
+} xn_evt_wifi_link_t;
+
 /**
  * @brief WiFi断开连接事件数据
  */
@@ -113,6 +146,7 @@ typedef enum {
     XN_EVT_BLUFI_DISCONNECTED   = 0x0204,   ///< 蓝牙已断开
     XN_EVT_BLUFI_RECV_CONFIG    = 0x0210,   ///< 收到配网配置（携带 xn_evt_blufi_config_t）
     XN_EVT_BLUFI_CONFIG_DONE    = 0x0211,   ///< 配网完成
+    XN_EVT_BLUFI_XFER_DONE      = 0x0212,   ///< 批量传输已校验并写入（携带 xn_evt_blufi_xfer_t）
 } xn_event_blufi_t;
 
 /**
@@ -123,6 +157,15 @@ typedef struct {
     uint8_t password[65];   ///< 配置的密码
 } xn_evt_blufi_config_t;
 
+/**
+ * @brief BluFi批量传输完成数据
+ */
+typedef struct {
+    uint8_t target;         ///< 目标：1 NVS 键，2 数据分区
+    char name[33];          ///< NVS 键名或分区标签
+    uint32_t size;          ///< 写入的字节数
+} xn_evt_blufi_xfer_t;
+
 /*===========================================================================
  *                          MQTT事件 (0x0300 - 0x03FF)
  *===========================================================================*/
@@ -142,11 +185,15 @@ typedef enum {
 
 /**
  * @brief MQTT消息数据
+ * 
+ * 随 XN_EVT_MQTT_DATA 以引用计数缓冲区发布，topic/data 指向同一缓冲区内部，
+ * 均以 '\0' 结尾。回调返回后失效，需要延长生命周期时对 event->buf 调用
+ * xn_event_buf_retain。
  */
 typedef struct {
     char *topic;            ///< 消息主题
     uint16_t topic_len;     ///< 主题长度
-    char *data;             ///< 消息内容
+    char *data;             ///< 消息内容（分片消息已拼装完整）
     uint32_t data_len;      ///< 内容长度
     int msg_id;             ///< 消息ID
 } xn_evt_mqtt_data_t;
@@ -171,8 +218,17 @@ typedef enum {
     XN_CMD_DISPLAY_UPDATE       = 0x0831,   ///< 请求更新显示
     XN_CMD_DISPLAY_TOAST        = 0x0832,   ///< 请求显示Toast
     XN_CMD_DISPLAY_BRIGHTNESS   = 0x0833,   ///< 请求设置亮度
+    XN_CMD_DISPLAY_SLEEP        = 0x0834,   ///< 请求熄屏（关闭背光与显示）
+    XN_CMD_DISPLAY_WAKEUP       = 0x0835,   ///< 请求亮屏
 } xn_event_cmd_t;
 
+/**
+ * @brief 设置亮度命令数据
+ */
+typedef struct {
+    uint8_t brightness;     ///< 亮度 0-100
+} xn_cmd_display_brightness_t;
+
 /*===========================================================================
  *                          按键事件 (0x0400 - 0x04FF)
  *===========================================================================*/
@@ -186,6 +242,7 @@ typedef enum {
     XN_EVT_BUTTON_CLICK         = 0x0403,   ///< 单击
     XN_EVT_BUTTON_DOUBLE_CLICK  = 0x0404,   ///< 双击
     XN_EVT_BUTTON_LONG_PRESS    = 0x0405,   ///< 长按
+    XN_EVT_BUTTON_HOLD_REPEAT   = 0x0406,   ///< 长按后持续按住（按固定间隔重复）
 } xn_event_button_t;
 
 /**
@@ -196,6 +253,54 @@ typedef struct {
     uint32_t duration_ms;   ///< 按下持续时间(ms)
 } xn_evt_button_t;
 
+/*===========================================================================
+ *                          音频事件 (0x0600 - 0x06FF)
+ *===========================================================================*/
+
+/**
+ * @brief 音频事件ID定义（PCM 数据经 xn_audio 帧池分发，不走事件总线）
+ */
+typedef enum {
+    XN_EVT_AUDIO_SPEECH_START   = 0x0601,   ///< 检测到语音开始
+    XN_EVT_AUDIO_SPEECH_END     = 0x0602,   ///< 语音结束
+    XN_EVT_AUDIO_PLAYBACK_START = 0x0603,   ///< 下行语音开始播放（首音延迟有效）
+    XN_EVT_AUDIO_PLAYBACK_UNDERRUN = 0x0604, ///< 播放缓冲耗尽，重新预缓冲
+    XN_EVT_AUDIO_PLAYBACK_END   = 0x0605,   ///< 下行语音播放结束
+    XN_EVT_AUDIO_WAKE_WORD      = 0x0606,   ///< 本地检测到唤醒词，开始等待命令词
+    XN_EVT_AUDIO_COMMAND        = 0x0607,   ///< 本地识别到命令词
+    XN_EVT_AUDIO_COMMAND_TIMEOUT = 0x0608,  ///< 唤醒后未识别到命令词
+} xn_event_audio_t;
+
+/**
+ * @brief 语音事件数据
+ */
+typedef struct {
+    uint32_t duration_ms;   ///< 语音段时长(ms)，开始事件为0
+} xn_evt_audio_speech_t;
+
+/**
+ * @brief 播放事件数据（计数为本语音段截至事件时的累计值）
+ */
+typedef struct {
+    uint16_t session;           ///< 下行语音段编号
+    uint32_t frames_played;     ///< 已播放帧数
+    uint32_t underruns;         ///< 缓冲耗尽次数
+    uint32_t overruns;          ///< 超出缓冲容量丢弃的帧数
+    uint32_t late;              ///< 迟到丢弃的帧数
+    uint32_t lost;              ///< 缺失补静音的帧数
+    uint32_t first_audio_ms;    ///< 首包到达至开始播放(ms)
+    uint32_t buffer_max_ms;     ///< 抖动缓冲最高水位(ms)
+} xn_evt_audio_playback_t;
+
+/**
+ * @brief 本地识别事件数据
+ */
+typedef struct {
+    int command_id;             ///< 命令 ID（仅命令事件有效）
+    float prob;                 ///< 命令词置信度（仅命令事件有效）
+    uint32_t latency_ms;        ///< 送入识别的最后一个采样被采集到给出结果(ms)
+} xn_evt_audio_command_t;
+
 /*===========================================================================
  *                          显示事件 (0x0700 - 0x07FF)
  *===========================================================================*/
@@ -227,6 +332,8 @@ typedef enum {
     XN_EVT_SRC_BLUFI    = 3,    ///< BluFi组件
     XN_EVT_SRC_MQTT     = 4,    ///< MQTT客户端
     XN_EVT_SRC_BUTTON   = 5,    ///< 按键驱动
+    XN_EVT_SRC_AUDIO    = 6,    ///< 音频采集与播放
+    XN_EVT_SRC_FSM      = 7,    ///< 状态机超时与异步完成，data 为 uint32_t 事件标签
     XN_EVT_SRC_USER     = 100,  ///< 用户应用起始源ID
 } xn_event_source_t;
 
@@ -0,0 +1,77 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-25 14:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-25 14:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_event_bus\src\xn_event_buf.c
+ * @Description: 引用计数事件缓冲区实现
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <stdatomic.h>
+#include "xn_event_buf.h"
+#include "xn_event_pool.h"
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+/**
+ * @brief 缓冲区头部，数据区紧随其后
+ */
+struct xn_event_buf {
+    atomic_uint refcount;           ///< 引用计数
+    uint32_t len;                   ///< 数据区长度
+    uint64_t data[];                ///< 数据区（uint64_t 保证8字节对齐）
+};
+
+/*===========================================================================
+ *                          API实现
+ *===========================================================================*/
+
+/* 分配引用计数缓冲区 */
+xn_event_buf_t *xn_event_buf_alloc(size_t len)
+{
+    // 头部与数据区一次分配，小缓冲区可命中负载内存池
+    xn_event_buf_t *buf = xn_event_pool_alloc(sizeof(xn_event_buf_t) + len);
+    if (buf == NULL) {
+        return NULL;
+    }
+    atomic_init(&buf->refcount, 1);
+    buf->len = (uint32_t)len;
+    return buf;
+}
+
+/* 增加一个引用 */
+xn_event_buf_t *xn_event_buf_retain(xn_event_buf_t *buf)
+{
+    if (buf != NULL) {
+        atomic_fetch_add_explicit(&buf->refcount, 1, memory_order_relaxed);
+    }
+    return buf;
+}
+
+/* 释放一个引用 */
+void xn_event_buf_release(xn_event_buf_t *buf)
+{
+    if (buf == NULL) {
+        return;
+    }
+    // 最后一个引用释放时回收整块内存
+    if (atomic_fetch_sub_explicit(&buf->refcount, 1, memory_order_acq_rel) == 1) {
+        xn_event_pool_free(buf);
+    }
+}
+
+/* 获取数据区指针 */
+void *xn_event_buf_data(const xn_event_buf_t *buf)
+{
+    return (buf != NULL) ? (void *)buf->data : NULL;
+}
+
+/* 获取数据区长度 */
+size_t xn_event_buf_len(const xn_event_buf_t *buf)
+{
+    return (buf != NULL) ? buf->len : 0;
+}
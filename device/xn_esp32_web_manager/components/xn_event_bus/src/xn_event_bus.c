@@ -9,6 +9,7 @@
  * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved. 
  */
 
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include "freertos/FreeRTOS.h"
@@ -18,6 +19,10 @@
 #include "esp_timer.h"
 #include "esp_log.h"
 #include "xn_event_bus.h"
+#include "xn_event_pool.h"
+#include "xn_event_policy.h"
+#include "xn_event_trace.h"
+#include "xn_event_history.h"
 
 static const char *TAG = "xn_event_bus";
 
@@ -26,35 +31,88 @@ static const char *TAG = "xn_event_bus";
  *===========================================================================*/
 
 /**
- * @brief 订阅者节点结构体
- * 使用链表存储每个事件ID的订阅者
+ * @brief 独立任务订阅者邮箱
+ *
+ * 由包含它的订阅表快照计数引用，最后一个快照释放时向邮箱投递停止标记，
+ * 邮箱任务处理完已有事件后自行回收。
  */
-typedef struct subscriber_node {
+typedef struct {
+    QueueHandle_t queue;            ///< 待处理事件队列
+    xn_event_handler_t handler;     ///< 回调函数指针
+    void *user_data;                ///< 用户数据，调用回调时传回
+    uint32_t refs;                  ///< 引用该邮箱的快照数量（受 s_table_lock 保护）
+} sub_mailbox_t;
+
+/**
+ * @brief 订阅表条目
+ */
+typedef struct {
     uint16_t event_id;              ///< 订阅的事件ID (XN_EVT_ANY 表示所有事件)
     xn_event_handler_t handler;     ///< 回调函数指针
     void *user_data;                ///< 用户数据，调用回调时传回
-    struct subscriber_node *next;   ///< 链表下一节点
-} subscriber_node_t;
+    sub_mailbox_t *mailbox;         ///< 独立任务邮箱，NULL 表示在分发任务中直接回调
+} sub_entry_t;
+
+#define MAILBOX_STOP_ID     XN_EVT_ANY  ///< 邮箱停止标记（XN_EVT_ANY 不会作为真实事件发布）
+
+#define SUB_CAT_SLOTS       256     ///< 类别索引槽数（事件ID高字节）
+
+/**
+ * @brief 订阅表快照（创建后只读）
+ *
+ * 写者复制当前快照、修改后原子替换（写时复制）；分发方只持有快照引用，
+ * 不持有订阅锁。条目布局：
+ * - entries[0, any_count)：XN_EVT_ANY 通配订阅
+ * - entries[any_count, count)：具体ID订阅，按 event_id 升序，同ID后订阅者在前
+ * cat_index[c] 为类别 c 的首条目下标，cat_index[c + 1] 为其结束下标。
+ */
+typedef struct {
+    uint32_t readers;                       ///< 正在使用该快照的分发方数量
+    bool retired;                           ///< 已被新快照替换，最后一个读者负责释放
+    uint16_t count;                         ///< 条目总数
+    uint16_t any_count;                     ///< 通配订阅条目数
+    uint16_t cat_index[SUB_CAT_SLOTS + 1];  ///< 按类别(高字节)的条目下标索引
+    sub_entry_t entries[];                  ///< 连续存放的订阅条目
+} sub_table_t;
 
 /**
  * @brief 事件总线管理结构体
  */
 typedef struct {
     bool initialized;                   ///< 初始化标志
-    QueueHandle_t event_queue;          ///< 异步事件队列句柄
-    TaskHandle_t dispatcher_task;       ///< 事件分发任务句柄
-    SemaphoreHandle_t subscriber_mutex; ///< 订阅者链表保护互斥锁
-    subscriber_node_t *subscribers;     ///< 订阅者链表头指针
+    QueueHandle_t lane_queue[XN_EVENT_PRIO_MAX];        ///< 各优先级异步事件队列句柄
+    SemaphoreHandle_t pending_sem;      ///< 计数信号量，等于所有队列中的事件总数
+    TaskHandle_t workers[XN_EVENT_WORKER_COUNT];        ///< 事件分发任务句柄
+    SemaphoreHandle_t subscriber_mutex; ///< 写者互斥锁，串行化订阅表的修改
+    sub_table_t *table;                 ///< 当前订阅表快照，NULL 表示无订阅者
+    
+    // 按事件ID覆盖的优先级
+    struct {
+        uint16_t event_id;              ///< 事件ID
+        uint8_t prio;                   ///< 覆盖后的优先级
+    } prio_override[XN_EVENT_PRIO_OVERRIDE_MAX];
+    uint8_t prio_override_count;        ///< 覆盖表有效条目数
     
     // 统计信息
     uint32_t stats_published;           ///< 已发布事件计数
     uint32_t stats_delivered;           ///< 已投递(处理)事件计数
     uint32_t stats_dropped;             ///< 丢弃事件计数(队列满)
+    uint32_t stats_lane_dropped[XN_EVENT_PRIO_MAX];     ///< 各优先级队列满丢弃计数
 } event_bus_t;
 
+// 各优先级队列深度
+static const uint16_t s_lane_size[XN_EVENT_PRIO_MAX] = {
+    XN_EVENT_QUEUE_SIZE_CRITICAL,
+    XN_EVENT_QUEUE_SIZE,
+    XN_EVENT_QUEUE_SIZE_BULK,
+};
+
 // 全局唯一的事件总线实例
 static event_bus_t s_bus = {0};
 
+// 快照指针与读者计数保护锁，临界区内只做指针和计数操作
+static portMUX_TYPE s_table_lock = portMUX_INITIALIZER_UNLOCKED;
+
 /*===========================================================================
  *                          内部函数
  *===========================================================================*/
@@ -70,55 +128,395 @@ static uint32_t get_timestamp_ms(void)
 }
 
 /**
- * @brief 执行事件分发
- * 遍历订阅者链表，找到匹配的订阅者并调用回调
- * @param event 待分发的事件
+ * @brief 释放事件携带的数据
+ * 引用计数缓冲区释放一个引用；auto_free 数据归还内存（池块或堆）
+ * @param event 事件
  */
-static void dispatch_event(const xn_event_t *event)
+static void release_event_data(const xn_event_t *event)
 {
-    // 锁定订阅者链表，防止分发过程中链表被修改
-    xSemaphoreTake(s_bus.subscriber_mutex, portMAX_DELAY);
+    if (event->buf != NULL) {
+        xn_event_buf_release(event->buf);
+    } else if (event->auto_free && event->data != NULL) {
+        xn_event_pool_free(event->data);
+    }
+}
+
+/**
+ * @brief 计算事件所属的优先级通道
+ * 先查按ID覆盖表，未命中时按事件类别归类
+ * @param event_id 事件ID
+ * @return xn_event_priority_t 优先级
+ */
+static xn_event_priority_t event_lane(uint16_t event_id)
+{
+    for (uint8_t i = 0; i < s_bus.prio_override_count; i++) {
+        if (s_bus.prio_override[i].event_id == event_id) {
+            return (xn_event_priority_t)s_bus.prio_override[i].prio;
+        }
+    }
     
-    subscriber_node_t *node = s_bus.subscribers;
-    // 遍历所有订阅者
-    while (node != NULL) {
-        // 匹配规则：订阅了 XN_EVT_ANY 或 事件ID完全匹配
-        if (node->event_id == XN_EVT_ANY || node->event_id == event->id) {
-            if (node->handler != NULL) {
-                // 调用回调函数
-                node->handler(event, node->user_data);
-                s_bus.stats_delivered++;
-            }
+    switch (event_id & 0xFF00) {
+        case XN_EVT_CAT_SYSTEM:         // 系统事件
+        case XN_EVT_CAT_WIFI:           // 网络状态事件
+            return XN_EVENT_PRIO_CRITICAL;
+        case XN_EVT_CAT_SENSOR:         // 传感器遥测
+        case XN_EVT_CAT_AUDIO:          // 音频数据
+            return XN_EVENT_PRIO_BULK;
+        default:
+            return XN_EVENT_PRIO_NORMAL;
+    }
+}
+
+/**
+ * @brief 邮箱任务：逐个处理投递到邮箱的事件
+ * @param arg 邮箱指针
+ */
+static void mailbox_task(void *arg)
+{
+    sub_mailbox_t *mb = (sub_mailbox_t *)arg;
+    xn_event_t event;
+    
+    while (1) {
+        if (xQueueReceive(mb->queue, &event, portMAX_DELAY) != pdTRUE) {
+            continue;
         }
-        node = node->next;
+        // 收到停止标记，之后不会再有新事件投递
+        if (event.id == MAILBOX_STOP_ID && event.data == NULL) {
+            break;
+        }
+        // 在本任务上下文中调用回调，随后释放投递时保留的数据
+#if CONFIG_XN_EVENT_BUS_TRACE
+        if (TRACE_ACTIVE()) {
+            int64_t t0 = esp_timer_get_time();
+            mb->handler(&event, mb->user_data);
+            TRACE_HANDLER(event.id, mb->handler, (uint32_t)(esp_timer_get_time() - t0));
+        } else {
+            mb->handler(&event, mb->user_data);
+        }
+#else
+        mb->handler(&event, mb->user_data);
+#endif
+        release_event_data(&event);
     }
     
-    // 释放锁
-    xSemaphoreGive(s_bus.subscriber_mutex);
+    // 回收邮箱资源并退出任务
+    vQueueDelete(mb->queue);
+    free(mb);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 释放快照对邮箱的引用，最后一个引用释放时通知邮箱任务退出
+ * @param mb 邮箱
+ */
+static void mailbox_put(sub_mailbox_t *mb)
+{
+    portENTER_CRITICAL(&s_table_lock);
+    bool stop = (--mb->refs == 0);
+    portEXIT_CRITICAL(&s_table_lock);
     
-    // 如果设置了自动释放且数据指针不为空，则释放数据内存
-    if (event->auto_free && event->data != NULL) {
-        free(event->data);
+    if (stop) {
+        // 停止标记排在已投递事件之后，保证已入邮箱的事件都被处理
+        const xn_event_t stop_evt = { .id = MAILBOX_STOP_ID };
+        xQueueSend(mb->queue, &stop_evt, portMAX_DELAY);
+    }
+}
+
+/**
+ * @brief 投递事件到邮箱
+ * 引用计数缓冲区增加引用，其他数据拷贝一份，保证回调执行时数据仍有效
+ * @param mb 邮箱
+ * @param event 事件
+ */
+static void mailbox_deliver(sub_mailbox_t *mb, const xn_event_t *event)
+{
+    xn_event_t copy = *event;
+    if (copy.buf != NULL) {
+        xn_event_buf_retain(copy.buf);
+    } else if (copy.data != NULL && copy.data_len > 0) {
+        copy.data = xn_event_pool_alloc(copy.data_len);
+        if (copy.data == NULL) {
+            s_bus.stats_dropped++;
+            return;
+        }
+        memcpy(copy.data, event->data, event->data_len);
+        copy.auto_free = true;
+    } else {
+        copy.auto_free = false;
+    }
+    
+    // 邮箱满时丢弃，不阻塞分发任务
+    if (xQueueSend(mb->queue, &copy, 0) != pdTRUE) {
+        s_bus.stats_dropped++;
+        ESP_LOGW(TAG, "Subscriber mailbox full, dropped event 0x%04x", event->id);
+        release_event_data(&copy);
+        return;
+    }
+    s_bus.stats_delivered++;
+}
+
+/**
+ * @brief 分配订阅表快照
+ * @param count 条目数量
+ * @return sub_table_t* 快照指针，失败返回 NULL
+ */
+static sub_table_t *table_alloc(uint16_t count)
+{
+    sub_table_t *t = malloc(sizeof(sub_table_t) + sizeof(sub_entry_t) * count);
+    if (t != NULL) {
+        t->readers = 0;
+        t->retired = false;
+        t->count = count;
+        t->any_count = 0;
+    }
+    return t;
+}
+
+/**
+ * @brief 重建快照的类别索引
+ * 要求具体ID条目已按 event_id 升序排列
+ * @param t 快照
+ */
+static void table_reindex(sub_table_t *t)
+{
+    uint16_t idx = t->any_count;
+    // 对每个类别记录第一个不小于该类别起始ID的条目下标
+    for (int c = 0; c <= SUB_CAT_SLOTS; c++) {
+        while (idx < t->count && (t->entries[idx].event_id >> 8) < c) {
+            idx++;
+        }
+        t->cat_index[c] = idx;
     }
 }
 
+/**
+ * @brief 为快照中的邮箱条目增加引用（新快照构建完成后调用）
+ * @param t 快照
+ */
+static void table_retain_mailboxes(sub_table_t *t)
+{
+    portENTER_CRITICAL(&s_table_lock);
+    for (uint16_t i = 0; i < t->count; i++) {
+        if (t->entries[i].mailbox != NULL) {
+            t->entries[i].mailbox->refs++;
+        }
+    }
+    portEXIT_CRITICAL(&s_table_lock);
+}
+
+/**
+ * @brief 回收快照，并释放其对邮箱的引用
+ * @param t 快照
+ */
+static void table_free(sub_table_t *t)
+{
+    for (uint16_t i = 0; i < t->count; i++) {
+        if (t->entries[i].mailbox != NULL) {
+            mailbox_put(t->entries[i].mailbox);
+        }
+    }
+    free(t);
+}
+
+/**
+ * @brief 获取当前快照的读引用
+ * @return sub_table_t* 快照指针，无订阅者时返回 NULL
+ */
+static sub_table_t *table_acquire(void)
+{
+    portENTER_CRITICAL(&s_table_lock);
+    sub_table_t *t = s_bus.table;
+    if (t != NULL) {
+        t->readers++;
+    }
+    portEXIT_CRITICAL(&s_table_lock);
+    return t;
+}
+
+/**
+ * @brief 释放快照的读引用，已退役且无读者时回收
+ * @param t 快照指针
+ */
+static void table_release(sub_table_t *t)
+{
+    if (t == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_table_lock);
+    t->readers--;
+    bool reclaim = t->retired && t->readers == 0;
+    portEXIT_CRITICAL(&s_table_lock);
+    // 不可在临界区内调用free
+    if (reclaim) {
+        table_free(t);
+    }
+}
+
+/**
+ * @brief 发布新快照并退役旧快照（需持有写者互斥锁）
+ * @param t 新快照，NULL 表示清空订阅
+ */
+static void table_publish(sub_table_t *t)
+{
+    portENTER_CRITICAL(&s_table_lock);
+    sub_table_t *old = s_bus.table;
+    s_bus.table = t;
+    bool reclaim = false;
+    if (old != NULL) {
+        // 仍有分发方在使用旧快照时，由最后一个读者回收
+        old->retired = true;
+        reclaim = (old->readers == 0);
+    }
+    portEXIT_CRITICAL(&s_table_lock);
+    if (reclaim) {
+        table_free(old);
+    }
+}
+
+/**
+ * @brief 调用条目区间内匹配的订阅者
+ * @param t 快照
+ * @param begin 起始下标
+ * @param end 结束下标（不含）
+ * @param event 待分发的事件
+ * @param match_id 是否需要比对事件ID（通配区间无需比对）
+ */
+static void invoke_range(const sub_table_t *t, uint16_t begin, uint16_t end,
+                         const xn_event_t *event, bool match_id)
+{
+    for (uint16_t i = begin; i < end; i++) {
+        const sub_entry_t *e = &t->entries[i];
+        if (match_id) {
+            // 条目按ID升序，越过目标ID即可提前结束
+            if (e->event_id > event->id) {
+                break;
+            }
+            if (e->event_id != event->id) {
+                continue;
+            }
+        }
+        if (e->mailbox != NULL) {
+            // 独立任务订阅者：只投递到邮箱
+            mailbox_deliver(e->mailbox, event);
+            continue;
+        }
+        // 调用回调函数
+#if CONFIG_XN_EVENT_BUS_TRACE
+        if (TRACE_ACTIVE()) {
+            int64_t t0 = esp_timer_get_time();
+            e->handler(event, e->user_data);
+            TRACE_HANDLER(event->id, e->handler, (uint32_t)(esp_timer_get_time() - t0));
+        } else {
+            e->handler(event, e->user_data);
+        }
+#else
+        e->handler(event, e->user_data);
+#endif
+        s_bus.stats_delivered++;
+    }
+}
+
+/**
+ * @brief 执行事件分发
+ * 通过类别索引定位订阅者并调用回调，再调用通配订阅者。
+ * 分发期间只持有快照读引用，不持有订阅锁，回调中可安全地订阅/取消订阅；
+ * 回调中取消的订阅仍可能收到本次正在分发的事件。
+ * @param event 待分发的事件
+ */
+static void dispatch_event(const xn_event_t *event)
+{
+    HISTORY_RECORD(event);
+
+    sub_table_t *t = table_acquire();
+    if (t != NULL) {
+        uint8_t cat = event->id >> 8;
+        // 具体ID订阅者：只扫描所属类别的条目
+        invoke_range(t, t->cat_index[cat], t->cat_index[cat + 1], event, true);
+        // 通配订阅者
+        invoke_range(t, 0, t->any_count, event, false);
+        table_release(t);
+    }
+    
+    release_event_data(event);
+}
+
 /**
  * @brief 事件分发任务函数
- * 持续从队列中取出事件并分发
+ * 每次唤醒最多批量取出 XN_EVENT_DRAIN_BATCH 个事件，总是优先从高优先级通道取
  * @param arg 任务参数（未使用）
  */
 static void dispatcher_task(void *arg)
 {
-    xn_event_t event;
+    xn_event_t batch[XN_EVENT_DRAIN_BATCH];
     
     // 打印任务启动日志
     ESP_LOGI(TAG, "Dispatcher task started");
     
     while (1) {
-        // 阻塞等待队列中有新事件
-        if (xQueueReceive(s_bus.event_queue, &event, portMAX_DELAY) == pdTRUE) {
-            // 分发事件
-            dispatch_event(&event);
+        // 阻塞等待任一通道中有新事件
+        if (xSemaphoreTake(s_bus.pending_sem, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        // 非阻塞领取更多计数，每个计数对应一个已入队的事件
+        uint32_t credits = 1;
+        while (credits < XN_EVENT_DRAIN_BATCH && xSemaphoreTake(s_bus.pending_sem, 0) == pdTRUE) {
+            credits++;
+        }
+        
+        // 按优先级从高到低一次取出 credits 个事件
+        uint32_t n = 0;
+        for (int lane = 0; lane < XN_EVENT_PRIO_MAX && n < credits; lane++) {
+            while (n < credits && xQueueReceive(s_bus.lane_queue[lane], &batch[n], 0) == pdTRUE) {
+                n++;
+            }
+        }
+        
+        // 依次分发本批事件
+        for (uint32_t i = 0; i < n; i++) {
+            // 最新值占位替换为槽位中的事件后再分发
+            if (xn_event_policy_resolve(&batch[i])) {
+#if CONFIG_XN_EVENT_BUS_TRACE
+                // 记录入队到开始分发的等待时间（入队时未统计的事件跳过）
+                if (TRACE_ACTIVE() && batch[i].queued_us != 0) {
+                    TRACE_WAIT(batch[i].id, (uint32_t)esp_timer_get_time() - batch[i].queued_us);
+                }
+#endif
+                dispatch_event(&batch[i]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief 删除已创建的队列与信号量（初始化失败或反初始化时使用）
+ */
+static void bus_delete_queues(void)
+{
+    for (int lane = 0; lane < XN_EVENT_PRIO_MAX; lane++) {
+        if (s_bus.lane_queue[lane] != NULL) {
+            vQueueDelete(s_bus.lane_queue[lane]);
+            s_bus.lane_queue[lane] = NULL;
+        }
+    }
+    if (s_bus.pending_sem != NULL) {
+        vSemaphoreDelete(s_bus.pending_sem);
+        s_bus.pending_sem = NULL;
+    }
+    if (s_bus.subscriber_mutex != NULL) {
+        vSemaphoreDelete(s_bus.subscriber_mutex);
+        s_bus.subscriber_mutex = NULL;
+    }
+}
+
+/**
+ * @brief 删除已创建的分发任务
+ */
+static void bus_delete_workers(void)
+{
+    for (int i = 0; i < XN_EVENT_WORKER_COUNT; i++) {
+        if (s_bus.workers[i] != NULL) {
+            vTaskDelete(s_bus.workers[i]);
+            s_bus.workers[i] = NULL;
         }
     }
 }
@@ -136,47 +534,68 @@ esp_err_t xn_event_bus_init(void)
         return ESP_ERR_INVALID_STATE;
     }
     
-    // 创建事件队列
-    s_bus.event_queue = xQueueCreate(XN_EVENT_QUEUE_SIZE, sizeof(xn_event_t));
-    if (s_bus.event_queue == NULL) {
-        ESP_LOGE(TAG, "Failed to create event queue");
-        return ESP_ERR_NO_MEM;
+    // 构建负载内存池的空闲链表
+    xn_event_pool_init();
+    
+    // 转存上次运行的分发历史，开始记录本次运行
+    HISTORY_INIT();
+    
+    // 创建各优先级事件队列
+    UBaseType_t total = 0;
+    for (int lane = 0; lane < XN_EVENT_PRIO_MAX; lane++) {
+        s_bus.lane_queue[lane] = xQueueCreate(s_lane_size[lane], sizeof(xn_event_t));
+        if (s_bus.lane_queue[lane] == NULL) {
+            bus_delete_queues();
+            ESP_LOGE(TAG, "Failed to create event queue");
+            return ESP_ERR_NO_MEM;
+        }
+        total += s_lane_size[lane];
     }
     
-    // 创建互斥锁
+    // 创建待处理事件计数信号量与互斥锁
+    s_bus.pending_sem = xSemaphoreCreateCounting(total, 0);
     s_bus.subscriber_mutex = xSemaphoreCreateMutex();
-    if (s_bus.subscriber_mutex == NULL) {
-        vQueueDelete(s_bus.event_queue);
+    if (s_bus.pending_sem == NULL || s_bus.subscriber_mutex == NULL) {
+        bus_delete_queues();
         ESP_LOGE(TAG, "Failed to create mutex");
         return ESP_ERR_NO_MEM;
     }
     
-    // 创建分发任务
-    BaseType_t ret = xTaskCreate(
-        dispatcher_task,
-        "event_dispatcher",
-        XN_EVENT_TASK_STACK_SIZE,
-        NULL,
-        XN_EVENT_TASK_PRIORITY,
-        &s_bus.dispatcher_task
-    );
-    
-    if (ret != pdPASS) {
-        vSemaphoreDelete(s_bus.subscriber_mutex);
-        vQueueDelete(s_bus.event_queue);
-        ESP_LOGE(TAG, "Failed to create dispatcher task");
-        return ESP_ERR_NO_MEM;
+    // 创建分发任务，多个任务时按核轮流绑定
+    for (int i = 0; i < XN_EVENT_WORKER_COUNT; i++) {
+        char name[16] = "event_dispatcher";
+        BaseType_t ret;
+        if (XN_EVENT_WORKER_COUNT > 1) {
+            snprintf(name, sizeof(name), "event_disp%d", i);
+        }
+        if (XN_EVENT_WORKER_COUNT > 1 && XN_EVENT_WORKER_PIN_CORE) {
+            ret = xTaskCreatePinnedToCore(dispatcher_task, name, XN_EVENT_TASK_STACK_SIZE, NULL,
+                                          XN_EVENT_TASK_PRIORITY, &s_bus.workers[i],
+                                          i % portNUM_PROCESSORS);
+        } else {
+            ret = xTaskCreate(dispatcher_task, name, XN_EVENT_TASK_STACK_SIZE, NULL,
+                              XN_EVENT_TASK_PRIORITY, &s_bus.workers[i]);
+        }
+        if (ret != pdPASS) {
+            s_bus.workers[i] = NULL;
+            bus_delete_workers();
+            bus_delete_queues();
+            ESP_LOGE(TAG, "Failed to create dispatcher task");
+            return ESP_ERR_NO_MEM;
+        }
     }
     
     // 初始化状态
-    s_bus.subscribers = NULL;
+    s_bus.table = NULL;
     s_bus.stats_published = 0;
     s_bus.stats_delivered = 0;
     s_bus.stats_dropped = 0;
+    memset(s_bus.stats_lane_dropped, 0, sizeof(s_bus.stats_lane_dropped));
     s_bus.initialized = true;
     
-    ESP_LOGI(TAG, "Event bus initialized (queue=%d, max_subs=%d)", 
-             XN_EVENT_QUEUE_SIZE, XN_EVENT_MAX_SUBSCRIBERS);
+    ESP_LOGI(TAG, "Event bus initialized (queue=%d/%d/%d, workers=%d, max_subs=%d)", 
+             XN_EVENT_QUEUE_SIZE_CRITICAL, XN_EVENT_QUEUE_SIZE, XN_EVENT_QUEUE_SIZE_BULK,
+             XN_EVENT_WORKER_COUNT, XN_EVENT_MAX_SUBSCRIBERS);
     
     return ESP_OK;
 }
@@ -189,33 +608,27 @@ esp_err_t xn_event_bus_deinit(void)
     }
     
     // 停止并删除分发任务
-    if (s_bus.dispatcher_task != NULL) {
-        vTaskDelete(s_bus.dispatcher_task);
-        s_bus.dispatcher_task = NULL;
-    }
+    bus_delete_workers();
     
-    // 清理所有订阅者节点
+    // 清空订阅表（分发任务已停止，旧快照无读者时立即回收，独立任务订阅者随之退出）
     xSemaphoreTake(s_bus.subscriber_mutex, portMAX_DELAY);
-    subscriber_node_t *node = s_bus.subscribers;
-    while (node != NULL) {
-        subscriber_node_t *next = node->next;
-        free(node); // 释放节点内存
-        node = next;
-    }
-    s_bus.subscribers = NULL;
+    table_publish(NULL);
     xSemaphoreGive(s_bus.subscriber_mutex);
     
-    // 清理队列中剩余的未处理事件，如果是auto_free的需要释放数据
+    // 清理队列中剩余的未处理事件，释放其携带的数据
     xn_event_t event;
-    while (xQueueReceive(s_bus.event_queue, &event, 0) == pdTRUE) {
-        if (event.auto_free && event.data != NULL) {
-            free(event.data);
+    for (int lane = 0; lane < XN_EVENT_PRIO_MAX; lane++) {
+        while (xQueueReceive(s_bus.lane_queue[lane], &event, 0) == pdTRUE) {
+            release_event_data(&event);
         }
     }
+    // 最新值槽位中尚未分发的事件
+    while (xn_event_policy_take_pending(&event)) {
+        release_event_data(&event);
+    }
     
     // 删除同步原语
-    vSemaphoreDelete(s_bus.subscriber_mutex);
-    vQueueDelete(s_bus.event_queue);
+    bus_delete_queues();
     
     s_bus.initialized = false;
     ESP_LOGI(TAG, "Event bus deinitialized");
@@ -223,6 +636,70 @@ esp_err_t xn_event_bus_deinit(void)
     return ESP_OK;
 }
 
+/**
+ * @brief 按投递策略将事件放入所属优先级队列
+ * @param evt 事件副本（时间戳已填充），失败时其数据已被释放
+ * @param in_batch 是否为批量发布：批量发布不等待队列空间，也不唤醒分发任务（由调用者统一补发）
+ * @param[out] queued 事件是否实际入队（合并到最新值槽位时为 false）
+ * @return esp_err_t ESP_OK / ESP_FAIL
+ */
+static esp_err_t enqueue_event(xn_event_t *evt, bool in_batch, bool *queued)
+{
+    *queued = false;
+#if CONFIG_XN_EVENT_BUS_TRACE
+    // 等待时间按 us 计算，毫秒时间戳分辨不出亚毫秒的排队；运行时关闭统计时记 0
+    evt->queued_us = TRACE_ACTIVE() ? (uint32_t)esp_timer_get_time() : 0;
+#endif
+    
+    // 按投递策略准入：合并到最新值槽位、限速丢弃或确定阻塞时长
+    xn_event_t replaced;
+    bool has_replaced = false;
+    TickType_t wait = 0;
+    policy_admit_t admit = xn_event_policy_admit(evt, &replaced, &has_replaced, &wait);
+    if (admit == POLICY_ADMIT_COALESCED) {
+        // 被替换的旧值不再分发，释放其数据
+        if (has_replaced) {
+            release_event_data(&replaced);
+        }
+        s_bus.stats_published++;
+        return ESP_OK;
+    }
+    if (admit == POLICY_ADMIT_REJECT) {
+        s_bus.stats_dropped++;
+        release_event_data(evt);
+        return ESP_FAIL;
+    }
+    
+    // 发送到所属优先级队列，队列满时按策略等待（默认不等待）后丢弃
+    xn_event_priority_t lane = event_lane(evt->id);
+    if (xQueueSend(s_bus.lane_queue[lane], evt, in_batch ? 0 : wait) != pdTRUE) {
+        s_bus.stats_dropped++;
+        s_bus.stats_lane_dropped[lane]++;
+        ESP_LOGW(TAG, "Event queue %d full, dropped event 0x%04x", lane, evt->id);
+        // 如果发送失败，携带的数据必须在这里释放，否则内存泄漏
+        release_event_data(evt);
+        // 最新值占位未能入队时，收回槽位中的事件一并释放
+        if (xn_event_policy_enqueue_failed(evt, &replaced)) {
+            release_event_data(&replaced);
+        }
+        return ESP_FAIL;
+    }
+    
+    // 唤醒一个分发任务
+    if (!in_batch) {
+        xSemaphoreGive(s_bus.pending_sem);
+    }
+    if (TRACE_ACTIVE()) {
+        TRACE_DEPTH(lane, uxQueueMessagesWaiting(s_bus.lane_queue[lane]));
+    }
+    
+    *queued = true;
+    s_bus.stats_published++;
+    ESP_LOGD(TAG, "Published event 0x%04x", evt->id);
+    
+    return ESP_OK;
+}
+
 /* 发布事件（异步） */
 esp_err_t xn_event_publish(const xn_event_t *event)
 {
@@ -242,21 +719,68 @@ esp_err_t xn_event_publish(const xn_event_t *event)
         evt_copy.timestamp = get_timestamp_ms();
     }
     
-    // 发送到队列，如果队列满则丢弃（非阻塞发送）
-    if (xQueueSend(s_bus.event_queue, &evt_copy, 0) != pdTRUE) {
-        s_bus.stats_dropped++;
-        ESP_LOGW(TAG, "Event queue full, dropped event 0x%04x", event->id);
-        // 如果发送失败且需要自动释放，这里必须释放，否则内存泄漏
-        if (evt_copy.auto_free && evt_copy.data) {
-             free(evt_copy.data);
+    bool queued;
+    return enqueue_event(&evt_copy, false, &queued);
+}
+
+/* 批量发布事件（异步） */
+esp_err_t xn_event_publish_batch(const xn_event_t *events, size_t n)
+{
+    // 检查初始化状态
+    if (!s_bus.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // 检查参数
+    if (events == NULL || n == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 统计每个优先级通道需要的队列空间
+    UBaseType_t need[XN_EVENT_PRIO_MAX] = {0};
+    for (size_t i = 0; i < n; i++) {
+        need[event_lane(events[i].id)]++;
+    }
+    
+    // 任一通道空间不足则整批拒绝，避免只投递出半组事件
+    for (int lane = 0; lane < XN_EVENT_PRIO_MAX; lane++) {
+        if (need[lane] > 0 && uxQueueSpacesAvailable(s_bus.lane_queue[lane]) < need[lane]) {
+            ESP_LOGW(TAG, "Event queue %d full, dropped batch of %u", lane, (unsigned)n);
+            for (size_t i = 0; i < n; i++) {
+                release_event_data(&events[i]);
+                s_bus.stats_lane_dropped[event_lane(events[i].id)]++;
+            }
+            s_bus.stats_dropped += n;
+            return ESP_FAIL;
         }
-        return ESP_FAIL;
     }
     
-    s_bus.stats_published++;
-    ESP_LOGD(TAG, "Published event 0x%04x", event->id);
+    // 全部入队但暂不唤醒，整组共用同一时间戳
+    uint32_t now = get_timestamp_ms();
+    UBaseType_t queued_count = 0;
+    esp_err_t ret = ESP_OK;
+    for (size_t i = 0; i < n; i++) {
+        xn_event_t evt_copy = events[i];
+        if (evt_copy.timestamp == 0) {
+            evt_copy.timestamp = now;
+        }
+        bool queued;
+        // 与其他发布方竞争导致个别事件入队失败时，继续投递其余事件
+        if (enqueue_event(&evt_copy, true, &queued) != ESP_OK) {
+            ret = ESP_FAIL;
+        }
+        if (queued) {
+            queued_count++;
+        }
+    }
     
-    return ESP_OK;
+    // 挂起调度器后一次性补发唤醒，恢复调度时分发任务只被切换一次
+    vTaskSuspendAll();
+    for (UBaseType_t i = 0; i < queued_count; i++) {
+        xSemaphoreGive(s_bus.pending_sem);
+    }
+    xTaskResumeAll();
+    
+    return ret;
 }
 
 /* 发布事件（同步） */
@@ -293,6 +817,7 @@ esp_err_t xn_event_post(uint16_t event_id, uint16_t source)
         .data = NULL,
         .data_len = 0,
         .auto_free = false,
+        .buf = NULL,
     };
     return xn_event_publish(&event);
 }
@@ -306,8 +831,8 @@ esp_err_t xn_event_post_data(uint16_t event_id, uint16_t source,
         return xn_event_post(event_id, source);
     }
     
-    // 分配新内存并拷贝数据
-    void *data_copy = malloc(len);
+    // 从负载内存池分配并拷贝数据（超尺寸时内部回退堆分配）
+    void *data_copy = xn_event_pool_alloc(len);
     if (data_copy == NULL) {
         return ESP_ERR_NO_MEM;
     }
@@ -320,7 +845,8 @@ esp_err_t xn_event_post_data(uint16_t event_id, uint16_t source,
         .timestamp = get_timestamp_ms(),
         .data = data_copy,
         .data_len = len,
-        .auto_free = true, // 重要：让总线处理完后自动free
+        .auto_free = true, // 重要：让总线处理完后自动归还内存
+        .buf = NULL,
     };
     
     // 发布事件
@@ -332,6 +858,84 @@ esp_err_t xn_event_post_data(uint16_t event_id, uint16_t source,
     return ret;
 }
 
+/* 发布引用计数缓冲区事件（零拷贝） */
+esp_err_t xn_event_post_buf(uint16_t event_id, uint16_t source, xn_event_buf_t *buf)
+{
+    if (buf == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 事件直接借用缓冲区数据区，不做拷贝
+    xn_event_t event = {
+        .id = event_id,
+        .source = source,
+        .timestamp = get_timestamp_ms(),
+        .data = xn_event_buf_data(buf),
+        .data_len = xn_event_buf_len(buf),
+        .auto_free = false,
+        .buf = buf, // 调用者的引用转交总线，分发完成后释放
+    };
+    
+    // 未初始化时publish不会接管引用，这里负责释放
+    if (!s_bus.initialized) {
+        xn_event_buf_release(buf);
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    return xn_event_publish(&event);
+}
+
+/**
+ * @brief 插入订阅条目并发布新快照
+ * @param entry 订阅条目
+ * @return esp_err_t ESP_OK / ESP_ERR_NO_MEM
+ */
+static esp_err_t table_insert(const sub_entry_t *entry)
+{
+    xSemaphoreTake(s_bus.subscriber_mutex, portMAX_DELAY);
+    
+    // 写者独占，可直接读取当前快照
+    const sub_table_t *old = s_bus.table;
+    uint16_t old_count = (old != NULL) ? old->count : 0;
+    uint16_t old_any = (old != NULL) ? old->any_count : 0;
+    
+    // 复制出多一个条目的新快照
+    sub_table_t *t = table_alloc(old_count + 1);
+    if (t == NULL) {
+        xSemaphoreGive(s_bus.subscriber_mutex);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // 插入位置：通配订阅放在通配区首位；具体ID放在同ID条目之前，保持升序
+    uint16_t pos = 0;
+    if (entry->event_id != XN_EVT_ANY) {
+        pos = old_any;
+        while (pos < old_count && old->entries[pos].event_id < entry->event_id) {
+            pos++;
+        }
+    }
+    
+    // 拷贝插入点前后的条目
+    if (pos > 0) {
+        memcpy(&t->entries[0], &old->entries[0], sizeof(sub_entry_t) * pos);
+    }
+    t->entries[pos] = *entry;
+    if (old_count > pos) {
+        memcpy(&t->entries[pos + 1], &old->entries[pos], sizeof(sub_entry_t) * (old_count - pos));
+    }
+    t->any_count = old_any + ((entry->event_id == XN_EVT_ANY) ? 1 : 0);
+    table_reindex(t);
+    table_retain_mailboxes(t);
+    
+    // 原子替换快照
+    table_publish(t);
+    xSemaphoreGive(s_bus.subscriber_mutex);
+    
+    ESP_LOGD(TAG, "Subscribed to event 0x%04x", entry->event_id);
+    
+    return ESP_OK;
+}
+
 /* 订阅事件 */
 esp_err_t xn_event_subscribe(uint16_t event_id, xn_event_handler_t handler, 
                               void *user_data)
@@ -345,24 +949,165 @@ esp_err_t xn_event_subscribe(uint16_t event_id, xn_event_handler_t handler,
         return ESP_ERR_INVALID_ARG;
     }
     
-    // 分配新的订阅者节点
-    subscriber_node_t *new_node = malloc(sizeof(subscriber_node_t));
-    if (new_node == NULL) {
+    const sub_entry_t entry = {
+        .event_id = event_id,
+        .handler = handler,
+        .user_data = user_data,
+        .mailbox = NULL,
+    };
+    return table_insert(&entry);
+}
+
+/* 订阅事件（在订阅者独立任务中回调） */
+esp_err_t xn_event_subscribe_on_task(uint16_t event_id, xn_event_handler_t handler,
+                                     void *user_data, const xn_event_sub_task_cfg_t *cfg)
+{
+    // 检查初始化状态
+    if (!s_bus.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // 检查参数
+    if (handler == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    xn_event_sub_task_cfg_t task_cfg = (cfg != NULL) ? *cfg : XN_EVENT_SUB_TASK_DEFAULT_CONFIG();
+    if (task_cfg.queue_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 创建邮箱与队列
+    sub_mailbox_t *mb = calloc(1, sizeof(sub_mailbox_t));
+    if (mb == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    mb->handler = handler;
+    mb->user_data = user_data;
+    mb->queue = xQueueCreate(task_cfg.queue_size, sizeof(xn_event_t));
+    if (mb->queue == NULL) {
+        free(mb);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // 创建邮箱任务
+    BaseType_t ret;
+    if (task_cfg.core_id >= 0) {
+        ret = xTaskCreatePinnedToCore(mailbox_task, "evt_sub", task_cfg.stack_size, mb,
+                                      task_cfg.priority, NULL, task_cfg.core_id);
+    } else {
+        ret = xTaskCreate(mailbox_task, "evt_sub", task_cfg.stack_size, mb,
+                          task_cfg.priority, NULL);
+    }
+    if (ret != pdPASS) {
+        vQueueDelete(mb->queue);
+        free(mb);
         return ESP_ERR_NO_MEM;
     }
     
-    new_node->event_id = event_id;
-    new_node->handler = handler;
-    new_node->user_data = user_data;
+    const sub_entry_t entry = {
+        .event_id = event_id,
+        .handler = handler,
+        .user_data = user_data,
+        .mailbox = mb,
+    };
+    esp_err_t err = table_insert(&entry);
+    if (err != ESP_OK) {
+        // 邮箱未被任何快照引用，直接通知任务退出
+        mb->refs = 1;
+        mailbox_put(mb);
+    }
+    return err;
+}
+
+/* 设置事件的分发优先级 */
+esp_err_t xn_event_set_priority(uint16_t event_id, xn_event_priority_t prio)
+{
+    if (prio >= XN_EVENT_PRIO_MAX || event_id == XN_EVT_ANY) {
+        return ESP_ERR_INVALID_ARG;
+    }
     
-    // 头插法插入链表，需加锁保护
-    xSemaphoreTake(s_bus.subscriber_mutex, portMAX_DELAY);
-    new_node->next = s_bus.subscribers;
-    s_bus.subscribers = new_node;
-    xSemaphoreGive(s_bus.subscriber_mutex);
+    // 已存在则原地更新
+    for (uint8_t i = 0; i < s_bus.prio_override_count; i++) {
+        if (s_bus.prio_override[i].event_id == event_id) {
+            s_bus.prio_override[i].prio = prio;
+            return ESP_OK;
+        }
+    }
+    
+    if (s_bus.prio_override_count >= XN_EVENT_PRIO_OVERRIDE_MAX) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // 先写条目再增加计数，发布方读到的条目总是完整的
+    s_bus.prio_override[s_bus.prio_override_count].event_id = event_id;
+    s_bus.prio_override[s_bus.prio_override_count].prio = prio;
+    s_bus.prio_override_count++;
+    return ESP_OK;
+}
+
+/**
+ * @brief 移除匹配的订阅条目（需持有写者互斥锁）
+ * @param event_id 事件ID，match_id 为 false 时忽略
+ * @param handler 回调函数
+ * @param match_id 是否同时比对事件ID
+ * @param remove_all 是否移除全部匹配项（否则只移除第一个）
+ * @return esp_err_t ESP_OK / ESP_ERR_NOT_FOUND / ESP_ERR_NO_MEM
+ */
+static esp_err_t table_remove(uint16_t event_id, xn_event_handler_t handler,
+                              bool match_id, bool remove_all)
+{
+    const sub_table_t *old = s_bus.table;
+    if (old == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
     
-    ESP_LOGD(TAG, "Subscribed to event 0x%04x", event_id);
+    // 先统计需要保留的条目数
+    uint16_t removed = 0;
+    for (uint16_t i = 0; i < old->count; i++) {
+        const sub_entry_t *e = &old->entries[i];
+        if (e->handler == handler && (!match_id || e->event_id == event_id)) {
+            removed++;
+            if (!remove_all) {
+                break;
+            }
+        }
+    }
+    if (removed == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
     
+    // 全部移除时直接清空快照
+    uint16_t keep = old->count - removed;
+    if (keep == 0) {
+        table_publish(NULL);
+        return ESP_OK;
+    }
+    
+    sub_table_t *t = table_alloc(keep);
+    if (t == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // 拷贝保留的条目，相对顺序不变
+    uint16_t n = 0;
+    uint16_t skipped = 0;
+    for (uint16_t i = 0; i < old->count; i++) {
+        const sub_entry_t *e = &old->entries[i];
+        bool hit = e->handler == handler && (!match_id || e->event_id == event_id);
+        if (hit && skipped < removed) {
+            skipped++;
+            continue;
+        }
+        t->entries[n++] = *e;
+        // 通配区仍位于数组头部
+        if (e->event_id == XN_EVT_ANY) {
+            t->any_count++;
+        }
+    }
+    table_reindex(t);
+    table_retain_mailboxes(t);
+    
+    table_publish(t);
     return ESP_OK;
 }
 
@@ -374,31 +1119,12 @@ esp_err_t xn_event_unsubscribe(uint16_t event_id, xn_event_handler_t handler)
         return ESP_ERR_INVALID_STATE;
     }
     
+    // 找到匹配的条目（ID和Handler都必须匹配）并生成新快照
     xSemaphoreTake(s_bus.subscriber_mutex, portMAX_DELAY);
-    
-    subscriber_node_t *prev = NULL;
-    subscriber_node_t *curr = s_bus.subscribers;
-    
-    while (curr != NULL) {
-        // 找到匹配的节点（ID和Handler都必须匹配）
-        if (curr->event_id == event_id && curr->handler == handler) {
-            if (prev == NULL) {
-                // 删除头节点
-                s_bus.subscribers = curr->next;
-            } else {
-                // 删除中间节点
-                prev->next = curr->next;
-            }
-            free(curr);
-            xSemaphoreGive(s_bus.subscriber_mutex);
-            return ESP_OK;
-        }
-        prev = curr;
-        curr = curr->next;
-    }
-    
+    esp_err_t ret = table_remove(event_id, handler, true, false);
     xSemaphoreGive(s_bus.subscriber_mutex);
-    return ESP_ERR_NOT_FOUND;
+    
+    return ret;
 }
 
 /* 取消handler的所有订阅 */
@@ -409,31 +1135,13 @@ esp_err_t xn_event_unsubscribe_all(xn_event_handler_t handler)
         return ESP_ERR_INVALID_STATE;
     }
     
+    // 只要handler匹配就删除
     xSemaphoreTake(s_bus.subscriber_mutex, portMAX_DELAY);
-    
-    subscriber_node_t *prev = NULL;
-    subscriber_node_t *curr = s_bus.subscribers;
-    
-    while (curr != NULL) {
-        // 只要handler匹配就删除
-        if (curr->handler == handler) {
-            subscriber_node_t *to_free = curr;
-            if (prev == NULL) {
-                s_bus.subscribers = curr->next;
-                curr = s_bus.subscribers; // 重置curr
-            } else {
-                prev->next = curr->next;
-                curr = curr->next; // 移动curr
-            }
-            free(to_free);
-        } else {
-            prev = curr;
-            curr = curr->next;
-        }
-    }
-    
+    esp_err_t ret = table_remove(0, handler, false, true);
     xSemaphoreGive(s_bus.subscriber_mutex);
-    return ESP_OK;
+    
+    // 没有任何订阅也视为成功
+    return (ret == ESP_ERR_NOT_FOUND) ? ESP_OK : ret;
 }
 
 /* 获取待处理事件数量 */
@@ -443,7 +1151,33 @@ uint32_t xn_event_pending_count(void)
         return 0;
     }
     
-    // 返回队列中消息数量
-    return uxQueueMessagesWaiting(s_bus.event_queue);
+    // 累加各优先级队列中的消息数量
+    uint32_t total = 0;
+    for (int lane = 0; lane < XN_EVENT_PRIO_MAX; lane++) {
+        total += uxQueueMessagesWaiting(s_bus.lane_queue[lane]);
+    }
+    return total;
 }
 
+/* 获取事件总线统计信息 */
+esp_err_t xn_event_bus_get_stats(xn_event_bus_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 读取负载内存池统计
+    xn_event_pool_stats_t pool_stats;
+    xn_event_pool_get_stats(&pool_stats);
+    
+    stats->published = s_bus.stats_published;
+    stats->delivered = s_bus.stats_delivered;
+    stats->dropped = s_bus.stats_dropped;
+    memcpy(stats->lane_dropped, s_bus.stats_lane_dropped, sizeof(stats->lane_dropped));
+    stats->pool_hits = pool_stats.hits;
+    stats->pool_misses = pool_stats.misses;
+    stats->pool_in_use = pool_stats.in_use;
+    stats->pool_high_water = pool_stats.high_water;
+    
+    return ESP_OK;
+}
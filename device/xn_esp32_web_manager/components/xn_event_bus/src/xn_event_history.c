@@ -0,0 +1,144 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-28 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-28 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_event_bus\src\xn_event_history.c
+ * @Description: 事件总线分发历史实现 - RTC 内存中的最近事件环形缓冲，复位后可读回
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "xn_event_history.h"
+
+#if CONFIG_XN_EVENT_BUS_HISTORY
+
+/*===========================================================================
+ *                          内部数据
+ *===========================================================================*/
+
+#define HISTORY_LEN         CONFIG_XN_EVENT_BUS_HISTORY_LEN
+#define HISTORY_MAGIC       0x58454831  ///< "XEH1"，上电后 RTC 内存为随机值，用于区分有效数据
+
+/**
+ * @brief RTC 内存中的环形缓冲
+ *
+ * 软件复位、panic 与看门狗复位后内容保留，上电与掉电复位后无效（magic 不匹配）。
+ * head 为累计写入次数，不回绕取模，读取时据此判断是否已写满一圈。
+ */
+typedef struct {
+    uint32_t magic;                                 ///< HISTORY_MAGIC 表示内容有效
+    uint32_t head;                                  ///< 累计写入次数
+    xn_event_history_entry_t entries[HISTORY_LEN];  ///< 环形缓冲
+} history_ring_t;
+
+static RTC_NOINIT_ATTR history_ring_t s_ring;                   // 本次运行的历史（复位后保留）
+static xn_event_history_entry_t s_previous[HISTORY_LEN];        // 上次运行的历史（按时间从旧到新）
+static size_t s_previous_count = 0;                             // 上次运行的历史条数
+static portMUX_TYPE s_history_lock = portMUX_INITIALIZER_UNLOCKED; // 环形缓冲保护锁
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 按时间从旧到新拷出环形缓冲（需持有 s_history_lock 或环形缓冲未在写入）
+ * @param ring 环形缓冲
+ * @param entries 输出数组
+ * @param max 数组容量，超出时保留最新的 max 条
+ * @return size_t 拷出的条数
+ */
+static size_t ring_copy(const history_ring_t *ring, xn_event_history_entry_t *entries, size_t max)
+{
+    uint32_t head = ring->head;
+    size_t n = head < HISTORY_LEN ? head : HISTORY_LEN;
+    if (n > max) {
+        n = max;
+    }
+    for (size_t i = 0; i < n; i++) {
+        entries[i] = ring->entries[(head - n + i) % HISTORY_LEN];
+    }
+    return n;
+}
+
+/*===========================================================================
+ *                          内部接口实现
+ *===========================================================================*/
+
+void xn_event_history_init(void)
+{
+    s_previous_count = 0;
+    if (s_ring.magic == HISTORY_MAGIC) {
+        s_previous_count = ring_copy(&s_ring, s_previous, HISTORY_LEN);
+    }
+
+    memset(&s_ring, 0, sizeof(s_ring));
+    s_ring.magic = HISTORY_MAGIC;
+}
+
+void xn_event_history_record(const xn_event_t *event)
+{
+    portENTER_CRITICAL(&s_history_lock);
+    xn_event_history_entry_t *e = &s_ring.entries[s_ring.head % HISTORY_LEN];
+    e->event_id = event->id;
+    e->source = event->source;
+    e->timestamp = event->timestamp;
+    s_ring.head++;
+    portEXIT_CRITICAL(&s_history_lock);
+}
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+esp_err_t xn_event_history_snapshot(xn_event_history_entry_t *entries, size_t max, size_t *count)
+{
+    if (entries == NULL || count == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_history_lock);
+    *count = ring_copy(&s_ring, entries, max);
+    portEXIT_CRITICAL(&s_history_lock);
+    return ESP_OK;
+}
+
+esp_err_t xn_event_history_get_previous(xn_event_history_entry_t *entries, size_t max, size_t *count)
+{
+    if (entries == NULL || count == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 保留最新的 max 条
+    size_t n = s_previous_count < max ? s_previous_count : max;
+    memcpy(entries, &s_previous[s_previous_count - n], n * sizeof(xn_event_history_entry_t));
+    *count = n;
+    return ESP_OK;
+}
+
+#else
+
+esp_err_t xn_event_history_snapshot(xn_event_history_entry_t *entries, size_t max, size_t *count)
+{
+    (void)entries;
+    (void)max;
+    if (count != NULL) {
+        *count = 0;
+    }
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t xn_event_history_get_previous(xn_event_history_entry_t *entries, size_t max, size_t *count)
+{
+    (void)entries;
+    (void)max;
+    if (count != NULL) {
+        *count = 0;
+    }
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif /* CONFIG_XN_EVENT_BUS_HISTORY */
@@ -0,0 +1,49 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-28 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-28 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_event_bus\src\xn_event_history.h
+ * @Description: 事件总线分发历史 - 事件总线内部使用
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_EVENT_HISTORY_INTERNAL_H
+#define XN_EVENT_HISTORY_INTERNAL_H
+
+#include "sdkconfig.h"
+#include "xn_event_bus.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_XN_EVENT_BUS_HISTORY
+
+/**
+ * @brief 保存上次运行留在 RTC 内存中的历史并清空环形缓冲，总线初始化时调用
+ */
+void xn_event_history_init(void);
+
+/**
+ * @brief 记录一次分发
+ * @param event 开始分发的事件
+ */
+void xn_event_history_record(const xn_event_t *event);
+
+#define HISTORY_INIT()                  xn_event_history_init()
+#define HISTORY_RECORD(event)           xn_event_history_record(event)
+
+#else
+
+#define HISTORY_INIT()                  do { } while (0)
+#define HISTORY_RECORD(event)           do { } while (0)
+
+#endif /* CONFIG_XN_EVENT_BUS_HISTORY */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XN_EVENT_HISTORY_INTERNAL_H */
@@ -0,0 +1,272 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-26 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-26 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_event_bus\src\xn_event_policy.c
+ * @Description: 事件投递策略实现 - 最新值合并、限速、阻塞超时
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "xn_event_policy.h"
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+/**
+ * @brief 单个事件ID的策略槽位
+ */
+typedef struct {
+    uint16_t event_id;              ///< 事件ID
+    xn_event_policy_t policy;       ///< 投递策略
+
+    // LATEST_ONLY 状态
+    bool pending;                   ///< 槽位中是否有待分发事件（队列中有其占位）
+    xn_event_t latest;              ///< 最新待分发事件
+
+    // RATE_LIMIT 状态（令牌桶，令牌数放大1000倍以支持小数补充）
+    uint32_t tokens_milli;          ///< 当前令牌数 x1000
+    TickType_t last_refill;         ///< 上次补充令牌的时刻
+
+    xn_event_policy_stats_t stats;  ///< 统计信息
+} policy_slot_t;
+
+static policy_slot_t s_slots[XN_EVENT_POLICY_MAX];                  // 策略槽位表
+static uint8_t s_slot_count = 0;                                    // 已注册槽位数量
+static portMUX_TYPE s_policy_lock = portMUX_INITIALIZER_UNLOCKED;   // 槽位状态保护锁
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 按事件ID查找策略槽位
+ * @param event_id 事件ID
+ * @return policy_slot_t* 槽位，未注册返回 NULL
+ */
+static policy_slot_t *find_slot(uint16_t event_id)
+{
+    uint8_t count = s_slot_count;
+    for (uint8_t i = 0; i < count; i++) {
+        if (s_slots[i].event_id == event_id) {
+            return &s_slots[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 令牌桶取一个令牌（需持有 s_policy_lock）
+ * @param slot 槽位
+ * @return true 取到令牌
+ */
+static bool take_token(policy_slot_t *slot)
+{
+    const uint32_t cap = slot->policy.rate_per_sec * 1000;
+    TickType_t now = xTaskGetTickCount();
+    uint32_t elapsed_ms = pdTICKS_TO_MS(now - slot->last_refill);
+
+    // 按流逝时间补充令牌：每毫秒补充 rate_per_sec 个千分之一令牌
+    if (elapsed_ms > 0) {
+        uint64_t refill = (uint64_t)elapsed_ms * slot->policy.rate_per_sec;
+        uint64_t tokens = slot->tokens_milli + refill;
+        slot->tokens_milli = (tokens > cap) ? cap : (uint32_t)tokens;
+        slot->last_refill = now;
+    }
+
+    if (slot->tokens_milli < 1000) {
+        return false;
+    }
+    slot->tokens_milli -= 1000;
+    return true;
+}
+
+/*===========================================================================
+ *                          内部API实现
+ *===========================================================================*/
+
+/* 发布前按策略准入 */
+policy_admit_t xn_event_policy_admit(xn_event_t *event, xn_event_t *replaced,
+                                     bool *has_replaced, TickType_t *wait)
+{
+    *has_replaced = false;
+    *wait = 0;
+
+    policy_slot_t *slot = find_slot(event->id);
+    if (slot == NULL) {
+        return POLICY_ADMIT_ENQUEUE;
+    }
+
+    policy_admit_t result = POLICY_ADMIT_ENQUEUE;
+    portENTER_CRITICAL(&s_policy_lock);
+    slot->stats.published++;
+    switch (slot->policy.type) {
+        case XN_EVENT_POLICY_LATEST_ONLY:
+            if (slot->pending) {
+                // 已有待分发事件：原地替换为最新值，旧值交给调用者释放
+                *replaced = slot->latest;
+                *has_replaced = true;
+                slot->latest = *event;
+                slot->stats.coalesced++;
+                result = POLICY_ADMIT_COALESCED;
+            } else {
+                // 首次发布：事件存入槽位，队列中只放不带数据的占位
+                slot->latest = *event;
+                slot->pending = true;
+                event->data = NULL;
+                event->data_len = 0;
+                event->auto_free = false;
+                event->buf = NULL;
+            }
+            break;
+
+        case XN_EVENT_POLICY_RATE_LIMIT:
+            // 令牌不足则丢弃
+            if (!take_token(slot)) {
+                slot->stats.dropped++;
+                result = POLICY_ADMIT_REJECT;
+            }
+            break;
+
+        case XN_EVENT_POLICY_BLOCK_WITH_TIMEOUT:
+            // 队列满时最多等待 timeout_ms
+            *wait = pdMS_TO_TICKS(slot->policy.timeout_ms);
+            break;
+
+        default:
+            break;
+    }
+    portEXIT_CRITICAL(&s_policy_lock);
+
+    return result;
+}
+
+/* 入队失败时回收策略状态 */
+bool xn_event_policy_enqueue_failed(const xn_event_t *event, xn_event_t *reclaimed)
+{
+    policy_slot_t *slot = find_slot(event->id);
+    if (slot == NULL) {
+        return false;
+    }
+
+    bool has = false;
+    portENTER_CRITICAL(&s_policy_lock);
+    slot->stats.dropped++;
+    // 占位未能入队，槽位中的事件永远不会被取走，必须在这里收回
+    if (slot->policy.type == XN_EVENT_POLICY_LATEST_ONLY && slot->pending) {
+        *reclaimed = slot->latest;
+        slot->pending = false;
+        has = true;
+    }
+    portEXIT_CRITICAL(&s_policy_lock);
+
+    return has;
+}
+
+/* 分发前解析占位事件 */
+bool xn_event_policy_resolve(xn_event_t *event)
+{
+    // 占位事件不带数据，带数据的事件直接分发
+    if (event->data != NULL || event->buf != NULL) {
+        return true;
+    }
+
+    policy_slot_t *slot = find_slot(event->id);
+    if (slot == NULL || slot->policy.type != XN_EVENT_POLICY_LATEST_ONLY) {
+        return true;
+    }
+
+    bool has = false;
+    portENTER_CRITICAL(&s_policy_lock);
+    // 取走槽位中的最新值，之后的发布重新入队占位
+    if (slot->pending) {
+        *event = slot->latest;
+        slot->pending = false;
+        has = true;
+    }
+    portEXIT_CRITICAL(&s_policy_lock);
+
+    return has;
+}
+
+/* 取出一个仍在槽位中待处理的事件 */
+bool xn_event_policy_take_pending(xn_event_t *event)
+{
+    bool has = false;
+    portENTER_CRITICAL(&s_policy_lock);
+    for (uint8_t i = 0; i < s_slot_count && !has; i++) {
+        if (s_slots[i].pending) {
+            *event = s_slots[i].latest;
+            s_slots[i].pending = false;
+            has = true;
+        }
+    }
+    portEXIT_CRITICAL(&s_policy_lock);
+    return has;
+}
+
+/*===========================================================================
+ *                          公共API实现
+ *===========================================================================*/
+
+/* 设置事件的投递策略 */
+esp_err_t xn_event_set_policy(uint16_t event_id, const xn_event_policy_t *policy)
+{
+    if (policy == NULL || event_id == XN_EVT_ANY || policy->type > XN_EVENT_POLICY_BLOCK_WITH_TIMEOUT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (policy->type == XN_EVENT_POLICY_RATE_LIMIT && policy->rate_per_sec == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&s_policy_lock);
+    policy_slot_t *slot = find_slot(event_id);
+    if (slot != NULL) {
+        // 已注册：有待分发事件时不允许切走 LATEST_ONLY，否则槽位中的事件会丢失
+        if (slot->pending && policy->type != XN_EVENT_POLICY_LATEST_ONLY) {
+            ret = ESP_ERR_INVALID_STATE;
+        } else {
+            slot->policy = *policy;
+        }
+    } else if (s_slot_count >= XN_EVENT_POLICY_MAX) {
+        ret = ESP_ERR_NO_MEM;
+    } else {
+        // 新槽位：先填写内容再增加计数，查找方读到的槽位总是完整的
+        slot = &s_slots[s_slot_count];
+        memset(slot, 0, sizeof(*slot));
+        slot->event_id = event_id;
+        slot->policy = *policy;
+        slot->tokens_milli = policy->rate_per_sec * 1000;   // 令牌桶初始为满
+        slot->last_refill = xTaskGetTickCount();
+        s_slot_count++;
+    }
+    portEXIT_CRITICAL(&s_policy_lock);
+
+    return ret;
+}
+
+/* 获取指定事件ID的策略统计 */
+esp_err_t xn_event_get_policy_stats(uint16_t event_id, xn_event_policy_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    policy_slot_t *slot = find_slot(event_id);
+    if (slot == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    portENTER_CRITICAL(&s_policy_lock);
+    *stats = slot->stats;
+    stats->pending = slot->pending ? 1 : 0;
+    portEXIT_CRITICAL(&s_policy_lock);
+
+    return ESP_OK;
+}
@@ -0,0 +1,83 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-26 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-26 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_event_bus\src\xn_event_policy.h
+ * @Description: 事件投递策略 - 事件总线内部使用
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_EVENT_POLICY_INTERNAL_H
+#define XN_EVENT_POLICY_INTERNAL_H
+
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "xn_event_bus.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ *                          数据类型
+ *===========================================================================*/
+
+/**
+ * @brief 发布准入结果
+ */
+typedef enum {
+    POLICY_ADMIT_ENQUEUE = 0,   ///< 按 wait 时长入队（LATEST_ONLY 首次发布时事件已被替换为占位）
+    POLICY_ADMIT_COALESCED,     ///< 已合并到待处理槽位，无需入队
+    POLICY_ADMIT_REJECT,        ///< 被限速丢弃
+} policy_admit_t;
+
+/*===========================================================================
+ *                          内部API
+ *===========================================================================*/
+
+/**
+ * @brief 发布前按策略准入
+ *
+ * @param[in,out] event 待发布事件；LATEST_ONLY 首次发布时改写为不带数据的占位事件
+ * @param[out] replaced 被合并替换掉的旧事件（需由调用者释放其数据）
+ * @param[out] has_replaced 是否输出了 replaced
+ * @param[out] wait 入队等待时长(tick)
+ * @return policy_admit_t 准入结果
+ */
+policy_admit_t xn_event_policy_admit(xn_event_t *event, xn_event_t *replaced,
+                                     bool *has_replaced, TickType_t *wait);
+
+/**
+ * @brief 入队失败时回收策略状态
+ *
+ * LATEST_ONLY 占位入队失败时取回槽位中的事件，并计入该ID的丢弃计数。
+ *
+ * @param event 入队失败的事件
+ * @param[out] reclaimed 从槽位取回的事件（需由调用者释放其数据）
+ * @return true 输出了 reclaimed
+ */
+bool xn_event_policy_enqueue_failed(const xn_event_t *event, xn_event_t *reclaimed);
+
+/**
+ * @brief 分发前解析占位事件
+ *
+ * @param[in,out] event 从队列取出的事件，LATEST_ONLY 占位被替换为槽位中最新的事件
+ * @return true 需要分发；false 占位对应的槽位已空，跳过
+ */
+bool xn_event_policy_resolve(xn_event_t *event);
+
+/**
+ * @brief 取出一个仍在槽位中待处理的事件（反初始化时逐个清理）
+ *
+ * @param[out] event 取出的事件
+ * @return true 取出成功；false 已无待处理事件
+ */
+bool xn_event_policy_take_pending(xn_event_t *event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XN_EVENT_POLICY_INTERNAL_H */
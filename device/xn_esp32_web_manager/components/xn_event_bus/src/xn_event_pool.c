@@ -0,0 +1,171 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-25 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-25 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_event_bus\src\xn_event_pool.c
+ * @Description: 事件负载固定块内存池实现 - 静态区分配，超尺寸回退堆
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "xn_event_pool.h"
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+/**
+ * @brief 空闲块链表节点（复用空闲块自身的存储空间）
+ */
+typedef struct pool_block {
+    struct pool_block *next;        ///< 下一个空闲块
+} pool_block_t;
+
+/**
+ * @brief 单个尺寸等级描述
+ */
+typedef struct {
+    size_t block_size;              ///< 块尺寸(字节)
+    uint32_t block_count;           ///< 块数量
+    uint8_t *base;                  ///< 该等级在静态区中的起始地址
+    pool_block_t *free_list;        ///< 空闲块链表头
+} pool_class_t;
+
+#define POOL_CLASS_COUNT    3       ///< 尺寸等级数量
+
+// 各尺寸等级的静态区，按8字节对齐以满足任意负载结构体的对齐要求
+static uint8_t s_arena_small[XN_EVENT_POOL_SMALL_SIZE * XN_EVENT_POOL_SMALL_COUNT] __attribute__((aligned(8)));
+static uint8_t s_arena_medium[XN_EVENT_POOL_MEDIUM_SIZE * XN_EVENT_POOL_MEDIUM_COUNT] __attribute__((aligned(8)));
+static uint8_t s_arena_large[XN_EVENT_POOL_LARGE_SIZE * XN_EVENT_POOL_LARGE_COUNT] __attribute__((aligned(8)));
+
+// 尺寸等级表，按块尺寸升序排列，分配时取第一个能容纳的等级
+static pool_class_t s_classes[POOL_CLASS_COUNT] = {
+    {XN_EVENT_POOL_SMALL_SIZE,  XN_EVENT_POOL_SMALL_COUNT,  s_arena_small,  NULL},
+    {XN_EVENT_POOL_MEDIUM_SIZE, XN_EVENT_POOL_MEDIUM_COUNT, s_arena_medium, NULL},
+    {XN_EVENT_POOL_LARGE_SIZE,  XN_EVENT_POOL_LARGE_COUNT,  s_arena_large,  NULL},
+};
+
+static portMUX_TYPE s_pool_lock = portMUX_INITIALIZER_UNLOCKED; // 空闲链表与统计保护锁
+static xn_event_pool_stats_t s_stats = {0};                     // 统计信息
+static bool s_pool_ready = false;                               // 空闲链表是否已构建
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 根据地址查找所属尺寸等级
+ * @param ptr 内存指针
+ * @return pool_class_t* 所属等级，不在静态区内返回 NULL
+ */
+static pool_class_t *find_class_by_addr(const void *ptr)
+{
+    const uint8_t *p = (const uint8_t *)ptr;
+    for (int i = 0; i < POOL_CLASS_COUNT; i++) {
+        pool_class_t *cls = &s_classes[i];
+        // 判断地址是否落在该等级的静态区范围内
+        if (p >= cls->base && p < cls->base + cls->block_size * cls->block_count) {
+            return cls;
+        }
+    }
+    return NULL;
+}
+
+/*===========================================================================
+ *                          内部API实现
+ *===========================================================================*/
+
+/* 初始化内存池 */
+void xn_event_pool_init(void)
+{
+    portENTER_CRITICAL(&s_pool_lock);
+    for (int i = 0; i < POOL_CLASS_COUNT; i++) {
+        pool_class_t *cls = &s_classes[i];
+        cls->free_list = NULL;
+        // 逆序串联所有块，使链表头指向最低地址的块
+        for (int32_t j = (int32_t)cls->block_count - 1; j >= 0; j--) {
+            pool_block_t *blk = (pool_block_t *)(cls->base + cls->block_size * j);
+            blk->next = cls->free_list;
+            cls->free_list = blk;
+        }
+    }
+    // 只重置占用计数，命中/未命中统计跨初始化累计
+    s_stats.in_use = 0;
+    s_pool_ready = true;
+    portEXIT_CRITICAL(&s_pool_lock);
+}
+
+/* 分配负载内存 */
+void *xn_event_pool_alloc(size_t len)
+{
+    if (len == 0) {
+        return NULL;
+    }
+
+    portENTER_CRITICAL(&s_pool_lock);
+    if (s_pool_ready) {
+        for (int i = 0; i < POOL_CLASS_COUNT; i++) {
+            pool_class_t *cls = &s_classes[i];
+            // 跳过容纳不下的等级以及已耗尽的等级
+            if (len > cls->block_size || cls->free_list == NULL) {
+                continue;
+            }
+            // 从空闲链表头摘下一块
+            pool_block_t *blk = cls->free_list;
+            cls->free_list = blk->next;
+            s_stats.hits++;
+            s_stats.in_use++;
+            // 更新占用高水位
+            if (s_stats.in_use > s_stats.high_water) {
+                s_stats.high_water = s_stats.in_use;
+            }
+            portEXIT_CRITICAL(&s_pool_lock);
+            return blk;
+        }
+    }
+    s_stats.misses++;
+    portEXIT_CRITICAL(&s_pool_lock);
+
+    // 超尺寸或池耗尽，回退到堆分配（不可在临界区内调用malloc）
+    return malloc(len);
+}
+
+/* 释放负载内存 */
+void xn_event_pool_free(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+
+    pool_class_t *cls = find_class_by_addr(ptr);
+    if (cls == NULL) {
+        // 不属于静态池，说明来自堆分配
+        free(ptr);
+        return;
+    }
+
+    portENTER_CRITICAL(&s_pool_lock);
+    // 归还到所属等级的空闲链表头
+    pool_block_t *blk = (pool_block_t *)ptr;
+    blk->next = cls->free_list;
+    cls->free_list = blk;
+    if (s_stats.in_use > 0) {
+        s_stats.in_use--;
+    }
+    portEXIT_CRITICAL(&s_pool_lock);
+}
+
+/* 读取统计信息 */
+void xn_event_pool_get_stats(xn_event_pool_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_pool_lock);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_pool_lock);
+}
@@ -0,0 +1,111 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-25 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-25 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_event_bus\src\xn_event_pool.h
+ * @Description: 事件负载固定块内存池 - 事件总线内部使用
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_EVENT_POOL_H
+#define XN_EVENT_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ *                          配置宏
+ *===========================================================================*/
+
+/*
+ * 尺寸等级按 xn_event_types.h 中的负载结构体划分：
+ * - 小块：xn_evt_wifi_disconnected_t / xn_evt_wifi_got_ip_t / xn_evt_button_t
+ * - 中块：xn_evt_wifi_connected_t / xn_evt_mqtt_data_t
+ * - 大块：xn_evt_blufi_config_t
+ * 超过大块尺寸的负载回退到堆分配。
+ */
+
+#ifndef XN_EVENT_POOL_SMALL_SIZE
+#define XN_EVENT_POOL_SMALL_SIZE    16  ///< 小块尺寸(字节)
+#endif
+
+#ifndef XN_EVENT_POOL_SMALL_COUNT
+#define XN_EVENT_POOL_SMALL_COUNT   32  ///< 小块数量
+#endif
+
+#ifndef XN_EVENT_POOL_MEDIUM_SIZE
+#define XN_EVENT_POOL_MEDIUM_SIZE   48  ///< 中块尺寸(字节)
+#endif
+
+#ifndef XN_EVENT_POOL_MEDIUM_COUNT
+#define XN_EVENT_POOL_MEDIUM_COUNT  16  ///< 中块数量
+#endif
+
+#ifndef XN_EVENT_POOL_LARGE_SIZE
+#define XN_EVENT_POOL_LARGE_SIZE    128 ///< 大块尺寸(字节)
+#endif
+
+#ifndef XN_EVENT_POOL_LARGE_COUNT
+#define XN_EVENT_POOL_LARGE_COUNT   8   ///< 大块数量
+#endif
+
+/*===========================================================================
+ *                          数据类型
+ *===========================================================================*/
+
+/**
+ * @brief 内存池统计信息
+ */
+typedef struct {
+    uint32_t hits;          ///< 从静态池分配成功的次数
+    uint32_t misses;        ///< 回退到堆分配的次数（超尺寸或池耗尽）
+    uint32_t in_use;        ///< 当前占用的池块数量
+    uint32_t high_water;    ///< 池块占用历史最高值
+} xn_event_pool_stats_t;
+
+/*===========================================================================
+ *                          内部API
+ *===========================================================================*/
+
+/**
+ * @brief 初始化内存池（构建各尺寸等级的空闲链表）
+ */
+void xn_event_pool_init(void);
+
+/**
+ * @brief 分配负载内存
+ *
+ * 优先从能容纳 len 的最小尺寸等级分配，池耗尽或超尺寸时回退 malloc。
+ *
+ * @param len 需要的字节数
+ * @return void* 内存指针，失败返回 NULL
+ */
+void *xn_event_pool_alloc(size_t len);
+
+/**
+ * @brief 释放负载内存
+ *
+ * 根据地址判断归属：位于静态池内则归还空闲链表，否则调用 free。
+ *
+ * @param ptr 内存指针，NULL 时忽略
+ */
+void xn_event_pool_free(void *ptr);
+
+/**
+ * @brief 读取内存池统计信息
+ *
+ * @param[out] stats 统计信息输出
+ */
+void xn_event_pool_get_stats(xn_event_pool_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XN_EVENT_POOL_H */
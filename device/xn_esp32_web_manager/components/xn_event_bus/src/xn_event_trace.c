@@ -0,0 +1,275 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-26 15:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-26 15:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_event_bus\src\xn_event_trace.c
+ * @Description: 事件总线延迟统计实现 - 按事件ID的等待/执行时间直方图
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "xn_event_trace.h"
+
+#if CONFIG_XN_EVENT_BUS_TRACE
+
+static const char *TAG = "xn_event_trace";
+
+/*===========================================================================
+ *                          内部数据
+ *===========================================================================*/
+
+// 直方图桶上界(us)，最后一个桶收纳所有更大的值
+static const uint32_t s_bucket_edges_us[XN_EVENT_HIST_BUCKETS - 1] = {
+    100, 1000, 5000, 20000, 50000, 200000, 1000000,
+};
+
+static xn_event_trace_entry_t s_entries[CONFIG_XN_EVENT_BUS_TRACE_MAX_IDS]; // 各事件ID统计条目
+static uint16_t s_entry_count = 0;                                          // 已使用条目数
+static uint32_t s_lane_high_water[XN_EVENT_PRIO_MAX] = {0};                 // 各通道队列高水位
+static portMUX_TYPE s_trace_lock = portMUX_INITIALIZER_UNLOCKED;           // 统计数据保护锁
+static volatile bool s_trace_enabled = true;                                // 运行时统计开关
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 计算耗时所属的直方图桶
+ * @param us 耗时(us)
+ * @return int 桶下标
+ */
+static int bucket_of(uint32_t us)
+{
+    int i = 0;
+    while (i < XN_EVENT_HIST_BUCKETS - 1 && us >= s_bucket_edges_us[i]) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief 查找或分配事件ID的统计条目（需持有 s_trace_lock）
+ * 条目用完后，新的事件ID统一计入最后一个条目（event_id 记为 XN_EVT_ANY）
+ * @param event_id 事件ID
+ * @return xn_event_trace_entry_t* 统计条目
+ */
+static xn_event_trace_entry_t *entry_of(uint16_t event_id)
+{
+    for (uint16_t i = 0; i < s_entry_count; i++) {
+        if (s_entries[i].event_id == event_id) {
+            return &s_entries[i];
+        }
+    }
+    if (s_entry_count < CONFIG_XN_EVENT_BUS_TRACE_MAX_IDS) {
+        xn_event_trace_entry_t *e = &s_entries[s_entry_count++];
+        memset(e, 0, sizeof(*e));
+        // 最后一个条目保留给溢出的事件ID
+        e->event_id = (s_entry_count == CONFIG_XN_EVENT_BUS_TRACE_MAX_IDS) ? XN_EVT_ANY : event_id;
+        return e;
+    }
+    return &s_entries[CONFIG_XN_EVENT_BUS_TRACE_MAX_IDS - 1];
+}
+
+/*===========================================================================
+ *                          内部API实现
+ *===========================================================================*/
+
+/* 运行时是否正在统计 */
+bool xn_event_trace_active(void)
+{
+    return s_trace_enabled;
+}
+
+/* 记录一次队列等待时间 */
+void xn_event_trace_record_wait(uint16_t event_id, uint32_t wait_us)
+{
+    portENTER_CRITICAL(&s_trace_lock);
+    xn_event_trace_entry_t *e = entry_of(event_id);
+    e->count++;
+    e->wait_hist[bucket_of(wait_us)]++;
+    if (wait_us > e->wait_max_us) {
+        e->wait_max_us = wait_us;
+    }
+    portEXIT_CRITICAL(&s_trace_lock);
+}
+
+/* 记录一次订阅者回调执行时间 */
+void xn_event_trace_record_handler(uint16_t event_id, xn_event_handler_t handler, uint32_t exec_us)
+{
+    portENTER_CRITICAL(&s_trace_lock);
+    xn_event_trace_entry_t *e = entry_of(event_id);
+    e->handler_hist[bucket_of(exec_us)]++;
+    // 记录最慢的回调，便于通过地址定位具体订阅者
+    if (exec_us > e->handler_max_us) {
+        e->handler_max_us = exec_us;
+        e->slowest_handler = handler;
+    }
+    portEXIT_CRITICAL(&s_trace_lock);
+}
+
+/* 记录入队后的队列深度 */
+void xn_event_trace_record_depth(int lane, uint32_t depth)
+{
+    portENTER_CRITICAL(&s_trace_lock);
+    if (depth > s_lane_high_water[lane]) {
+        s_lane_high_water[lane] = depth;
+    }
+    portEXIT_CRITICAL(&s_trace_lock);
+}
+
+#endif /* CONFIG_XN_EVENT_BUS_TRACE */
+
+/*===========================================================================
+ *                          公共API实现
+ *===========================================================================*/
+
+/* 读取所有事件ID的延迟统计 */
+esp_err_t xn_event_trace_snapshot(xn_event_trace_entry_t *entries, size_t max, size_t *count)
+{
+#if CONFIG_XN_EVENT_BUS_TRACE
+    if (count == NULL || (entries == NULL && max > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&s_trace_lock);
+    size_t n = (s_entry_count < max) ? s_entry_count : max;
+    memcpy(entries, s_entries, sizeof(xn_event_trace_entry_t) * n);
+    *count = n;
+    portEXIT_CRITICAL(&s_trace_lock);
+    return ESP_OK;
+#else
+    (void)entries;
+    (void)max;
+    (void)count;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/* 读取各优先级队列高水位 */
+esp_err_t xn_event_trace_get_high_water(uint32_t high_water[XN_EVENT_PRIO_MAX])
+{
+#if CONFIG_XN_EVENT_BUS_TRACE
+    if (high_water == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&s_trace_lock);
+    memcpy(high_water, s_lane_high_water, sizeof(s_lane_high_water));
+    portEXIT_CRITICAL(&s_trace_lock);
+    return ESP_OK;
+#else
+    (void)high_water;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/* 运行时打开或关闭延迟统计 */
+esp_err_t xn_event_bus_trace_enable(bool enable)
+{
+#if CONFIG_XN_EVENT_BUS_TRACE
+    s_trace_enabled = enable;
+    return ESP_OK;
+#else
+    (void)enable;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/* 清空延迟统计 */
+void xn_event_trace_reset(void)
+{
+#if CONFIG_XN_EVENT_BUS_TRACE
+    portENTER_CRITICAL(&s_trace_lock);
+    s_entry_count = 0;
+    memset(s_lane_high_water, 0, sizeof(s_lane_high_water));
+    portEXIT_CRITICAL(&s_trace_lock);
+#endif
+}
+
+/* 打印延迟统计到日志 */
+void xn_event_trace_dump(void)
+{
+#if CONFIG_XN_EVENT_BUS_TRACE
+    static xn_event_trace_entry_t snap[CONFIG_XN_EVENT_BUS_TRACE_MAX_IDS];     // 快照缓冲，避免占用调用者栈
+    uint32_t hw[XN_EVENT_PRIO_MAX];
+    size_t n = 0;
+
+    xn_event_trace_snapshot(snap, CONFIG_XN_EVENT_BUS_TRACE_MAX_IDS, &n);
+    xn_event_trace_get_high_water(hw);
+
+    ESP_LOGI(TAG, "queue high water: critical=%u normal=%u bulk=%u",
+             (unsigned)hw[0], (unsigned)hw[1], (unsigned)hw[2]);
+    for (size_t i = 0; i < n; i++) {
+        const xn_event_trace_entry_t *e = &snap[i];
+        ESP_LOGI(TAG, "0x%04x n=%u wait_max=%uus handler_max=%uus slowest=%p",
+                 e->event_id, (unsigned)e->count, (unsigned)e->wait_max_us,
+                 (unsigned)e->handler_max_us, (void *)e->slowest_handler);
+    }
+#endif
+}
+
+/* 将延迟统计格式化为JSON */
+int xn_event_trace_to_json(char *buf, size_t len)
+{
+#if CONFIG_XN_EVENT_BUS_TRACE
+    static xn_event_trace_entry_t snap[CONFIG_XN_EVENT_BUS_TRACE_MAX_IDS];     // 快照缓冲，避免占用调用者栈
+    uint32_t hw[XN_EVENT_PRIO_MAX];
+    size_t n = 0;
+
+    if (buf == NULL || len == 0) {
+        return -1;
+    }
+
+    xn_event_trace_snapshot(snap, CONFIG_XN_EVENT_BUS_TRACE_MAX_IDS, &n);
+    xn_event_trace_get_high_water(hw);
+
+    // 逐段追加，空间不足时返回-1
+    size_t off = 0;
+    int w = snprintf(buf, len, "{\"hw\":[%u,%u,%u],\"edges_us\":[100,1000,5000,20000,50000,200000,1000000],\"ids\":[",
+                     (unsigned)hw[0], (unsigned)hw[1], (unsigned)hw[2]);
+    if (w < 0 || (size_t)w >= len) {
+        return -1;
+    }
+    off = w;
+
+    for (size_t i = 0; i < n; i++) {
+        const xn_event_trace_entry_t *e = &snap[i];
+        w = snprintf(buf + off, len - off, "%s{\"id\":%u,\"n\":%u,\"wait_max\":%u,\"hdl_max\":%u,\"slowest\":\"%p\",\"wait\":[",
+                     (i > 0) ? "," : "", e->event_id, (unsigned)e->count, (unsigned)e->wait_max_us,
+                     (unsigned)e->handler_max_us, (void *)e->slowest_handler);
+        if (w < 0 || (size_t)w >= len - off) {
+            return -1;
+        }
+        off += w;
+        // 等待时间与执行时间直方图
+        for (int pass = 0; pass < 2; pass++) {
+            const uint32_t *hist = (pass == 0) ? e->wait_hist : e->handler_hist;
+            for (int b = 0; b < XN_EVENT_HIST_BUCKETS; b++) {
+                w = snprintf(buf + off, len - off, "%s%u", (b > 0) ? "," : "", (unsigned)hist[b]);
+                if (w < 0 || (size_t)w >= len - off) {
+                    return -1;
+                }
+                off += w;
+            }
+            w = snprintf(buf + off, len - off, (pass == 0) ? "],\"hdl\":[" : "]}");
+            if (w < 0 || (size_t)w >= len - off) {
+                return -1;
+            }
+            off += w;
+        }
+    }
+
+    w = snprintf(buf + off, len - off, "]}");
+    if (w < 0 || (size_t)w >= len - off) {
+        return -1;
+    }
+    return (int)(off + w);
+#else
+    (void)buf;
+    (void)len;
+    return -1;
+#endif
+}
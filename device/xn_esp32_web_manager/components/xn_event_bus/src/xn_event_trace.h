@@ -0,0 +1,72 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-26 15:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-26 15:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_event_bus\src\xn_event_trace.h
+ * @Description: 事件总线延迟统计 - 事件总线内部使用
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_EVENT_TRACE_INTERNAL_H
+#define XN_EVENT_TRACE_INTERNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "xn_event_bus.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_XN_EVENT_BUS_TRACE
+
+/**
+ * @brief 运行时是否正在统计
+ * @return true 统计中，调用者才需取时间戳并调用 TRACE_* 记录
+ */
+bool xn_event_trace_active(void);
+
+/**
+ * @brief 记录一次队列等待时间
+ * @param event_id 事件ID
+ * @param wait_us 从发布到开始分发的时间(us)
+ */
+void xn_event_trace_record_wait(uint16_t event_id, uint32_t wait_us);
+
+/**
+ * @brief 记录一次订阅者回调执行时间
+ * @param event_id 事件ID
+ * @param handler 回调函数
+ * @param exec_us 执行时间(us)
+ */
+void xn_event_trace_record_handler(uint16_t event_id, xn_event_handler_t handler, uint32_t exec_us);
+
+/**
+ * @brief 记录入队后的队列深度
+ * @param lane 优先级通道
+ * @param depth 队列中的事件数量
+ */
+void xn_event_trace_record_depth(int lane, uint32_t depth);
+
+#define TRACE_ACTIVE()                  xn_event_trace_active()
+#define TRACE_WAIT(id, us)              xn_event_trace_record_wait((id), (us))
+#define TRACE_HANDLER(id, h, us)        xn_event_trace_record_handler((id), (h), (us))
+#define TRACE_DEPTH(lane, depth)        xn_event_trace_record_depth((lane), (depth))
+
+#else
+
+#define TRACE_ACTIVE()                  false
+#define TRACE_WAIT(id, us)              do { } while (0)
+#define TRACE_HANDLER(id, h, us)        do { } while (0)
+#define TRACE_DEPTH(lane, depth)        do { } while (0)
+
+#endif /* CONFIG_XN_EVENT_BUS_TRACE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XN_EVENT_TRACE_INTERNAL_H */
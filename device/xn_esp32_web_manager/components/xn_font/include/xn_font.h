@@ -0,0 +1,115 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-24 20:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-24 20:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_font\include\xn_font.h
+ * @Description: 分区字体组件 - 从 font 数据分区内存映射读取压缩字形，供 LVGL 使用
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_FONT_H
+#define XN_FONT_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ *                          类型定义
+ *===========================================================================*/
+
+/**
+ * @brief 字体配置结构
+ */
+typedef struct {
+    const char *partition_label;    ///< 字体分区名（partitions.csv 中的 Name）
+    uint16_t cache_size;            ///< 解码字形缓存条数（LRU）
+    const lv_font_t *fallback;      ///< 缺字时的回退字体（可为 NULL）
+} xn_font_config_t;
+
+/**
+ * @brief 字体信息与缓存统计
+ */
+typedef struct {
+    uint32_t glyph_count;           ///< 字形数量
+    uint32_t image_size;            ///< 镜像大小（字节）
+    uint8_t bpp;                    ///< 每像素位数
+    uint16_t line_height;           ///< 行高
+    uint32_t cache_hits;            ///< 缓存命中次数
+    uint32_t cache_misses;          ///< 缓存未命中（解码）次数
+} xn_font_info_t;
+
+/*===========================================================================
+ *                          API
+ *===========================================================================*/
+
+/**
+ * @brief 获取默认配置
+ *
+ * @return xn_font_config_t 默认配置
+ */
+xn_font_config_t xn_font_get_default_config(void);
+
+/**
+ * @brief 加载分区字体
+ *
+ * 执行流程：
+ * - 查找字体分区并整体内存映射（只占用 MMU 页，不占内部 RAM）
+ * - 校验镜像头和 CRC
+ * - 分配解码字形缓存
+ *
+ * 镜像由 tools/font/build_font.py 生成，单独烧录到字体分区，
+ * 更新字体不需要重新烧录应用固件。
+ *
+ * @param config 字体配置
+ * @return esp_err_t
+ *         - ESP_OK: 加载成功
+ *         - ESP_ERR_INVALID_ARG: 参数无效
+ *         - ESP_ERR_NOT_FOUND: 找不到字体分区
+ *         - ESP_ERR_INVALID_VERSION: 镜像版本不支持
+ *         - ESP_ERR_INVALID_CRC: 镜像为空或已损坏
+ *         - ESP_ERR_NO_MEM: 内存不足
+ */
+esp_err_t xn_font_init(const xn_font_config_t *config);
+
+/**
+ * @brief 卸载分区字体
+ *
+ * 调用前必须确保没有 LVGL 对象仍在使用该字体
+ *
+ * @return esp_err_t
+ *         - ESP_OK: 卸载成功
+ */
+esp_err_t xn_font_deinit(void);
+
+/**
+ * @brief 获取 LVGL 字体
+ *
+ * 字形查询和解码在 LVGL 任务中执行，与其他 LVGL 调用一样受 xn_display_lock 保护
+ *
+ * @return const lv_font_t* 字体，未加载时返回 NULL
+ */
+const lv_font_t *xn_font_get(void);
+
+/**
+ * @brief 获取字体信息与缓存统计
+ *
+ * @param[out] info 输出信息
+ * @return esp_err_t
+ *         - ESP_OK: 成功
+ *         - ESP_ERR_INVALID_STATE: 未加载
+ *         - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t xn_font_get_info(xn_font_info_t *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XN_FONT_H */
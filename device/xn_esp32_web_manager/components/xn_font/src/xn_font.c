@@ -0,0 +1,488 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-24 20:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-24 20:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_font\src\xn_font.c
+ * @Description: 分区字体组件实现 - 镜像格式见 tools/font/build_font.py
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "xn_font.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+static const char *TAG = "xn_font";
+
+/*===========================================================================
+ *                          镜像格式
+ *===========================================================================*/
+
+#define XN_FONT_MAGIC           "XNFT"      ///< 镜像魔数
+#define XN_FONT_VERSION         1           ///< 镜像版本
+#define XN_FONT_GLYPH_RLE       0x01        ///< 字形标志：游程编码
+#define XN_FONT_CACHE_DEFAULT   32          ///< 默认缓存条数
+
+/**
+ * @brief 镜像文件头（32 字节）
+ */
+typedef struct __attribute__((packed)) {
+    char magic[4];                          ///< "XNFT"
+    uint16_t version;                       ///< 镜像版本
+    uint8_t bpp;                            ///< 每像素位数（1~4）
+    uint8_t flags;                          ///< 保留
+    uint16_t line_height;                   ///< 行高
+    int16_t base_line;                      ///< 基线距行底距离
+    int8_t underline_position;              ///< 下划线位置
+    int8_t underline_thickness;             ///< 下划线粗细
+    uint16_t reserved0;                     ///< 保留
+    uint32_t glyph_count;                   ///< 字形数量
+    uint32_t bitmap_size;                   ///< 位图区大小
+    uint32_t crc32;                         ///< 字形表 + 位图区的 CRC32
+    uint32_t reserved1;                     ///< 保留
+} xn_font_header_t;
+
+/**
+ * @brief 字形表项（16 字节，按 unicode 升序）
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t unicode;                       ///< 码位
+    uint32_t offset;                        ///< 位图在位图区中的偏移
+    uint16_t length;                        ///< 位图字节数
+    uint8_t adv_w;                          ///< 步进宽度
+    uint8_t box_w;                          ///< 位图宽度
+    uint8_t box_h;                          ///< 位图高度
+    int8_t ofs_x;                           ///< 位图左侧相对原点的偏移
+    int8_t ofs_y;                           ///< 位图底部相对基线的偏移
+    uint8_t flags;                          ///< XN_FONT_GLYPH_*
+} xn_font_glyph_t;
+
+_Static_assert(sizeof(xn_font_header_t) == 32, "font header must be 32 bytes");
+_Static_assert(sizeof(xn_font_glyph_t) == 16, "font glyph entry must be 16 bytes");
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+/**
+ * @brief 解码字形缓存项
+ */
+typedef struct {
+    uint32_t glyph_index;                   ///< 字形表下标，UINT32_MAX 表示空
+    uint32_t last_use;                      ///< 最近使用时刻（LRU）
+    uint8_t *a8;                            ///< 解码后的 A8 位图（box_w * box_h）
+} font_cache_entry_t;
+
+typedef struct {
+    bool initialized;                       ///< 初始化标志
+    esp_partition_mmap_handle_t mmap_handle;///< 映射句柄
+    uint32_t image_size;                    ///< 镜像大小
+    const xn_font_header_t *header;         ///< 文件头（映射地址）
+    const xn_font_glyph_t *glyphs;          ///< 字形表（映射地址）
+    const uint8_t *bitmaps;                 ///< 位图区（映射地址）
+    lv_font_t font;                         ///< LVGL 字体
+
+    font_cache_entry_t *cache;              ///< 缓存项
+    uint8_t *cache_pool;                    ///< 缓存位图内存
+    uint16_t cache_size;                    ///< 缓存条数
+    uint32_t use_clock;                     ///< LRU 计数
+    uint32_t cache_hits;                    ///< 命中次数
+    uint32_t cache_misses;                  ///< 未命中次数
+    uint8_t opa_table[16];                  ///< 像素值 -> 透明度
+} xn_font_ctx_t;
+
+static xn_font_ctx_t s_ctx = {0};
+
+/**
+ * @brief 高位在前的位流读取器
+ */
+typedef struct {
+    const uint8_t *data;                    ///< 数据
+    uint32_t bit_len;                       ///< 总位数
+    uint32_t bit;                           ///< 当前位置
+} bit_reader_t;
+
+/*===========================================================================
+ *                          内部函数声明
+ *===========================================================================*/
+
+static bool font_get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc,
+                               uint32_t letter, uint32_t letter_next);
+static const void *font_get_glyph_bitmap(lv_font_glyph_dsc_t *dsc, lv_draw_buf_t *draw_buf);
+static int32_t glyph_find(uint32_t unicode);
+static const uint8_t *glyph_cache_get(uint32_t glyph_index);
+static bool glyph_decode(const xn_font_glyph_t *g, uint8_t *out);
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+xn_font_config_t xn_font_get_default_config(void)
+{
+    xn_font_config_t config = {
+        .partition_label = "font",
+        .cache_size = XN_FONT_CACHE_DEFAULT,
+        .fallback = NULL,
+    };
+    return config;
+}
+
+esp_err_t xn_font_init(const xn_font_config_t *config)
+{
+    if (s_ctx.initialized) {
+        ESP_LOGW(TAG, "Font already initialized");
+        return ESP_OK;
+    }
+
+    if (config == NULL || config->partition_label == NULL || config->cache_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           ESP_PARTITION_SUBTYPE_ANY,
+                                                           config->partition_label);
+    if (part == NULL) {
+        ESP_LOGE(TAG, "Font partition '%s' not found", config->partition_label);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // 整个分区映射到数据地址空间，字形直接从 flash cache 读取
+    const void *image = NULL;
+    esp_err_t ret = esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA,
+                                       &image, &s_ctx.mmap_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to mmap font partition: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // 校验文件头，未烧录的分区全为 0xFF
+    const xn_font_header_t *header = (const xn_font_header_t *)image;
+    if (part->size < sizeof(xn_font_header_t) ||
+        memcmp(header->magic, XN_FONT_MAGIC, sizeof(header->magic)) != 0) {
+        ESP_LOGE(TAG, "Font partition is empty or not a font image");
+        ret = ESP_ERR_INVALID_CRC;
+        goto err;
+    }
+    if (header->version != XN_FONT_VERSION || header->bpp < 1 || header->bpp > 4) {
+        ESP_LOGE(TAG, "Unsupported font image: version %u, %u bpp", header->version, header->bpp);
+        ret = ESP_ERR_INVALID_VERSION;
+        goto err;
+    }
+    uint64_t body_size = (uint64_t)header->glyph_count * sizeof(xn_font_glyph_t) + header->bitmap_size;
+    if (sizeof(xn_font_header_t) + body_size > part->size) {
+        ESP_LOGE(TAG, "Font image larger than partition");
+        ret = ESP_ERR_INVALID_CRC;
+        goto err;
+    }
+    const uint8_t *body = (const uint8_t *)image + sizeof(xn_font_header_t);
+    if (esp_rom_crc32_le(0, body, (uint32_t)body_size) != header->crc32) {
+        ESP_LOGE(TAG, "Font image CRC mismatch");
+        ret = ESP_ERR_INVALID_CRC;
+        goto err;
+    }
+
+    s_ctx.header = header;
+    s_ctx.glyphs = (const xn_font_glyph_t *)body;
+    s_ctx.bitmaps = body + header->glyph_count * sizeof(xn_font_glyph_t);
+    s_ctx.image_size = sizeof(xn_font_header_t) + (uint32_t)body_size;
+
+    // 按最大字形分配缓存，每条缓存固定大小，替换时无需重新分配
+    uint32_t max_pixels = 1;
+    for (uint32_t i = 0; i < header->glyph_count; i++) {
+        uint32_t pixels = (uint32_t)s_ctx.glyphs[i].box_w * s_ctx.glyphs[i].box_h;
+        if (pixels > max_pixels) {
+            max_pixels = pixels;
+        }
+    }
+    s_ctx.cache_size = config->cache_size;
+    s_ctx.cache = calloc(s_ctx.cache_size, sizeof(font_cache_entry_t));
+    s_ctx.cache_pool = malloc((size_t)s_ctx.cache_size * max_pixels);
+    if (s_ctx.cache == NULL || s_ctx.cache_pool == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate glyph cache");
+        ret = ESP_ERR_NO_MEM;
+        goto err;
+    }
+    for (uint16_t i = 0; i < s_ctx.cache_size; i++) {
+        s_ctx.cache[i].glyph_index = UINT32_MAX;
+        s_ctx.cache[i].a8 = s_ctx.cache_pool + (size_t)i * max_pixels;
+    }
+    s_ctx.use_clock = 0;
+    s_ctx.cache_hits = 0;
+    s_ctx.cache_misses = 0;
+
+    // 像素值按 bpp 线性映射到 0~255
+    uint8_t max_value = (1 << header->bpp) - 1;
+    for (uint8_t v = 0; v <= max_value; v++) {
+        s_ctx.opa_table[v] = (uint8_t)((v * 255 + max_value / 2) / max_value);
+    }
+
+    memset(&s_ctx.font, 0, sizeof(s_ctx.font));
+    s_ctx.font.get_glyph_dsc = font_get_glyph_dsc;
+    s_ctx.font.get_glyph_bitmap = font_get_glyph_bitmap;
+    s_ctx.font.line_height = header->line_height;
+    s_ctx.font.base_line = header->base_line;
+    s_ctx.font.subpx = LV_FONT_SUBPX_NONE;
+    s_ctx.font.underline_position = header->underline_position;
+    s_ctx.font.underline_thickness = header->underline_thickness;
+    s_ctx.font.fallback = config->fallback;
+
+    s_ctx.initialized = true;
+
+    ESP_LOGI(TAG, "Font loaded: %lu glyphs, %u bpp, line height %u, image %lu bytes, cache %u x %lu bytes",
+             (unsigned long)header->glyph_count, header->bpp, header->line_height,
+             (unsigned long)s_ctx.image_size, s_ctx.cache_size, (unsigned long)max_pixels);
+
+    return ESP_OK;
+
+err:
+    free(s_ctx.cache);
+    free(s_ctx.cache_pool);
+    s_ctx.cache = NULL;
+    s_ctx.cache_pool = NULL;
+    esp_partition_munmap(s_ctx.mmap_handle);
+    return ret;
+}
+
+esp_err_t xn_font_deinit(void)
+{
+    if (!s_ctx.initialized) {
+        return ESP_OK;
+    }
+
+    free(s_ctx.cache);
+    free(s_ctx.cache_pool);
+    s_ctx.cache = NULL;
+    s_ctx.cache_pool = NULL;
+    esp_partition_munmap(s_ctx.mmap_handle);
+
+    s_ctx.header = NULL;
+    s_ctx.glyphs = NULL;
+    s_ctx.bitmaps = NULL;
+    s_ctx.initialized = false;
+
+    return ESP_OK;
+}
+
+const lv_font_t *xn_font_get(void)
+{
+    return s_ctx.initialized ? &s_ctx.font : NULL;
+}
+
+esp_err_t xn_font_get_info(xn_font_info_t *info)
+{
+    if (info == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    info->glyph_count = s_ctx.header->glyph_count;
+    info->image_size = s_ctx.image_size;
+    info->bpp = s_ctx.header->bpp;
+    info->line_height = s_ctx.header->line_height;
+    info->cache_hits = s_ctx.cache_hits;
+    info->cache_misses = s_ctx.cache_misses;
+
+    return ESP_OK;
+}
+
+/*===========================================================================
+ *                          内部函数实现
+ *===========================================================================*/
+
+/**
+ * @brief LVGL 字形信息回调
+ */
+static bool font_get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc,
+                               uint32_t letter, uint32_t letter_next)
+{
+    (void)letter_next;  // 镜像不含字距调整
+
+    int32_t index = glyph_find(letter);
+    if (index < 0) {
+        return false;   // LVGL 会继续查找 fallback 字体
+    }
+
+    const xn_font_glyph_t *g = &s_ctx.glyphs[index];
+    dsc->resolved_font = font;
+    dsc->adv_w = g->adv_w;
+    dsc->box_w = g->box_w;
+    dsc->box_h = g->box_h;
+    dsc->ofs_x = g->ofs_x;
+    dsc->ofs_y = g->ofs_y;
+    dsc->format = LV_FONT_GLYPH_FORMAT_A8;
+    dsc->is_placeholder = 0;
+    dsc->gid.index = (uint32_t)index;
+
+    return true;
+}
+
+/**
+ * @brief LVGL 字形位图回调：从缓存取 A8 位图，按目标缓冲区的行跨度拷贝
+ */
+static const void *font_get_glyph_bitmap(lv_font_glyph_dsc_t *dsc, lv_draw_buf_t *draw_buf)
+{
+    const uint8_t *a8 = glyph_cache_get(dsc->gid.index);
+    if (a8 == NULL || draw_buf == NULL) {
+        return a8;
+    }
+
+    uint32_t stride = draw_buf->header.stride;
+    for (uint16_t y = 0; y < dsc->box_h; y++) {
+        memcpy(draw_buf->data + y * stride, a8 + y * dsc->box_w, dsc->box_w);
+    }
+
+    return draw_buf;
+}
+
+/**
+ * @brief 在字形表中二分查找码位
+ *
+ * @return int32_t 字形表下标，未找到返回 -1
+ */
+static int32_t glyph_find(uint32_t unicode)
+{
+    int32_t lo = 0;
+    int32_t hi = (int32_t)s_ctx.header->glyph_count - 1;
+
+    while (lo <= hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        uint32_t code = s_ctx.glyphs[mid].unicode;
+        if (code == unicode) {
+            return mid;
+        }
+        if (code < unicode) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief 取解码后的字形，未命中时解码并替换最久未用的缓存项
+ */
+static const uint8_t *glyph_cache_get(uint32_t glyph_index)
+{
+    if (glyph_index >= s_ctx.header->glyph_count) {
+        return NULL;
+    }
+
+    font_cache_entry_t *victim = &s_ctx.cache[0];
+    for (uint16_t i = 0; i < s_ctx.cache_size; i++) {
+        font_cache_entry_t *e = &s_ctx.cache[i];
+        if (e->glyph_index == glyph_index) {
+            e->last_use = ++s_ctx.use_clock;
+            s_ctx.cache_hits++;
+            return e->a8;
+        }
+        if (e->last_use < victim->last_use) {
+            victim = e;
+        }
+    }
+
+    s_ctx.cache_misses++;
+    victim->glyph_index = UINT32_MAX;
+    if (!glyph_decode(&s_ctx.glyphs[glyph_index], victim->a8)) {
+        ESP_LOGW(TAG, "Corrupted glyph U+%04lX", (unsigned long)s_ctx.glyphs[glyph_index].unicode);
+        return NULL;
+    }
+    victim->glyph_index = glyph_index;
+    victim->last_use = ++s_ctx.use_clock;
+
+    return victim->a8;
+}
+
+/**
+ * @brief 读取 n 位（高位在前），越界时置 r->bit 为 UINT32_MAX
+ */
+static uint32_t bits_read(bit_reader_t *r, uint8_t n)
+{
+    uint32_t value = 0;
+
+    if (r->bit > r->bit_len || r->bit_len - r->bit < n) {
+        r->bit = UINT32_MAX;
+        return 0;
+    }
+    for (uint8_t i = 0; i < n; i++, r->bit++) {
+        value = (value << 1) | ((r->data[r->bit >> 3] >> (7 - (r->bit & 7))) & 1);
+    }
+
+    return value;
+}
+
+/**
+ * @brief 把字形解码为 A8 位图
+ *
+ * 编码与 tools/font/build_font.py 的 pack_raw / pack_rle 对应
+ *
+ * @return true 解码成功，false 位图越界或游程长度不符
+ */
+static bool glyph_decode(const xn_font_glyph_t *g, uint8_t *out)
+{
+    uint32_t count = (uint32_t)g->box_w * g->box_h;
+    uint8_t bpp = s_ctx.header->bpp;
+
+    if ((uint64_t)g->offset + g->length > s_ctx.header->bitmap_size) {
+        return false;
+    }
+
+    bit_reader_t r = {
+        .data = s_ctx.bitmaps + g->offset,
+        .bit_len = (uint32_t)g->length * 8,
+        .bit = 0,
+    };
+
+    if (!(g->flags & XN_FONT_GLYPH_RLE)) {
+        for (uint32_t i = 0; i < count; i++) {
+            out[i] = (uint8_t)bits_read(&r, bpp);
+        }
+    } else {
+        // 先得到行间异或后的像素值
+        uint32_t pos = 0;
+        uint8_t value = (bpp == 1 && count > 0) ? (uint8_t)bits_read(&r, 1) : 0;
+        while (pos < count && r.bit != UINT32_MAX) {
+            if (bpp != 1) {
+                value = (uint8_t)bits_read(&r, bpp);
+            }
+            uint32_t q = 0;
+            while (bits_read(&r, 1) == 1) {
+                q++;
+            }
+            uint32_t run = (q << 1) + bits_read(&r, 1) + 1;
+            if (run > count - pos) {
+                return false;
+            }
+            memset(out + pos, value, run);
+            pos += run;
+            if (bpp == 1) {
+                value ^= 1;
+            }
+        }
+        if (pos != count) {
+            return false;
+        }
+
+        // 还原行间异或
+        for (uint32_t i = g->box_w; i < count; i++) {
+            out[i] ^= out[i - g->box_w];
+        }
+    }
+    if (r.bit == UINT32_MAX) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = s_ctx.opa_table[out[i]];
+    }
+
+    return true;
+}
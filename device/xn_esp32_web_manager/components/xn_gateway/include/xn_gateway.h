@@ -0,0 +1,197 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-29 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-29 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_gateway\include\xn_gateway.h
+ * @Description: 边缘网关组件头文件 - ESP-NOW 收发子设备报文，维护设备表，状态去重，心跳汇总
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_GATEWAY_H
+#define XN_GATEWAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ *                          报文格式
+ *===========================================================================*/
+
+/*
+ * ESP-NOW 报文（与 device/esp32/common/espnow_link.h 保持一致），多字节字段均为小端：
+ *
+ *   [0] 魔数 XN_GATEWAY_MAGIC
+ *   [1] 版本 XN_GATEWAY_VERSION
+ *   [2] 类型 XN_GATEWAY_FRAME_*
+ *   [3] 设备ID长度 n（1 ~ XN_GATEWAY_ID_MAX）
+ *   [4 .. 4+n) 设备ID：上行为发送设备，下行为目标设备
+ *   [4+n .. 8+n) 接收方的会话随机数 u32，尚未得知时为 0
+ *   [8+n .. 12+n) 发送方的帧计数 u32，同一会话内严格递增
+ *   之后按类型：
+ *   - HEARTBEAT：[类型长度 m][设备类型][设备会话随机数 u32]
+ *   - ACK：[网关会话随机数 u32]
+ *   - STATUS / CONTROL：负载，与 MQTT 消息内容相同（JSON 或紧凑二进制）
+ *   最后 XN_GATEWAY_TAG_LEN 字节：HMAC-SHA256(设备密钥, 发送方MAC + 之前的全部字节) 的前 8 字节
+ *
+ * 认证：
+ * - 设备密钥 = HMAC-SHA256(网关主密钥, 设备ID) 的前 XN_GATEWAY_KEY_LEN 字节，写入子设备的
+ *   config.h；网关只保存主密钥，单个子设备泄露密钥不能冒充其他设备
+ * - 双方每次启动生成会话随机数，经 HEARTBEAT / ACK 交换；STATUS、ACK、CONTROL 必须带有接收方
+ *   当前的会话随机数，且帧计数大于上次接受的值，重放的旧报文被丢弃
+ * - 认证码覆盖发送方 MAC，设备ID与地址的绑定只能由通过认证的报文更新；
+ *   子设备只接受已绑定网关地址发出的 CONTROL
+ *
+ * 子设备先向广播地址发送 HEARTBEAT，收到网关的 ACK 后改为单播到网关。
+ * 报文只认证不加密，状态内容在附近可被监听。
+ */
+
+#define XN_GATEWAY_MAGIC            0xE5    ///< 报文魔数
+#define XN_GATEWAY_VERSION          2       ///< 报文格式版本
+#define XN_GATEWAY_ID_MAX           32      ///< 设备ID最大长度
+#define XN_GATEWAY_TYPE_MAX         16      ///< 设备类型最大长度
+#define XN_GATEWAY_FRAME_MAX        250     ///< ESP-NOW 单帧最大长度
+#define XN_GATEWAY_KEY_LEN          16      ///< 主密钥与设备密钥长度
+#define XN_GATEWAY_TAG_LEN          8       ///< 报文认证码长度
+
+#define XN_GATEWAY_FRAME_HEARTBEAT  0x01    ///< 子设备 → 网关：心跳（携带设备类型）
+#define XN_GATEWAY_FRAME_STATUS     0x02    ///< 子设备 → 网关：状态上报
+#define XN_GATEWAY_FRAME_ACK        0x03    ///< 网关 → 子设备：心跳应答，子设备据此得知网关地址
+#define XN_GATEWAY_FRAME_CONTROL    0x04    ///< 网关 → 子设备：控制命令
+
+/*===========================================================================
+ *                          类型定义
+ *===========================================================================*/
+
+/**
+ * @brief 状态转发回调（在调用 xn_gateway_process 的任务中执行）
+ *
+ * @param device_id 设备ID
+ * @param payload 状态负载（原样转发）
+ * @param len 负载长度
+ * @param user_data 用户数据
+ */
+typedef void (*xn_gateway_status_cb_t)(const char *device_id, const uint8_t *payload, size_t len,
+                                       void *user_data);
+
+/**
+ * @brief 收包通知回调（在 WiFi 任务中执行，只做唤醒，不要阻塞）
+ */
+typedef void (*xn_gateway_notify_cb_t)(void *user_data);
+
+/**
+ * @brief 网关配置
+ */
+typedef struct {
+    uint8_t key[XN_GATEWAY_KEY_LEN];    ///< 网关主密钥，全 0 视为未配置
+    uint16_t max_devices;               ///< 设备表容量（默认64）
+    uint8_t rx_queue_len;               ///< 收包队列深度（默认16），队列满时丢弃新报文
+    uint32_t offline_ms;                ///< 超过该时间未收到报文视为离线（默认90000）
+    uint32_t status_refresh_ms;         ///< 状态未变化时最长转发间隔（默认600000），0 表示未变化时从不转发
+    xn_gateway_status_cb_t status_cb;   ///< 状态转发回调
+    xn_gateway_notify_cb_t notify_cb;   ///< 收包通知回调，收到后应尽快调用 xn_gateway_process
+    void *user_data;                    ///< 回调用户数据
+} xn_gateway_config_t;
+
+/**
+ * @brief 网关统计
+ */
+typedef struct {
+    uint16_t devices;                   ///< 设备表中的设备数（离线设备在下次汇总心跳时移除）
+    uint32_t rx_frames;                 ///< 收到的有效报文数
+    uint32_t rx_dropped;                ///< 收包队列满丢弃的报文数
+    uint32_t rx_invalid;                ///< 格式错误的报文数
+    uint32_t rx_rejected;               ///< 认证失败或重放而丢弃的报文数
+    uint32_t status_forwarded;          ///< 转发的状态数
+    uint32_t status_deduped;            ///< 未变化而丢弃的状态数
+    uint32_t control_sent;              ///< 下发的控制命令数
+    uint32_t table_full;                ///< 设备表满拒绝的新设备数
+} xn_gateway_stats_t;
+
+/*===========================================================================
+ *                          API
+ *===========================================================================*/
+
+/**
+ * @brief 获取默认配置
+ */
+xn_gateway_config_t xn_gateway_get_default_config(void);
+
+/**
+ * @brief 初始化：分配设备表，初始化 ESP-NOW 并注册收发回调
+ *
+ * 需要在 WiFi 启动后调用，ESP-NOW 工作在 STA 当前信道上，
+ * 子设备连接同一 AP 即处于同一信道。
+ *
+ * @param config 配置
+ * @return esp_err_t
+ *      - ESP_OK: 成功
+ *      - ESP_ERR_INVALID_STATE: 已初始化
+ *      - ESP_ERR_INVALID_ARG: 配置无效（含未配置主密钥）
+ *      - ESP_ERR_NO_MEM: 内存不足
+ *      - 其他: esp_now_init 失败
+ */
+esp_err_t xn_gateway_init(const xn_gateway_config_t *config);
+
+/**
+ * @brief 反初始化：注销回调，释放 ESP-NOW 与设备表
+ */
+esp_err_t xn_gateway_deinit(void);
+
+/**
+ * @brief 处理收包队列中的报文
+ *
+ * 校验认证码与帧计数，更新设备表、应答心跳；状态与上次转发的内容不同，或距上次转发超过
+ * status_refresh_ms 时调用 status_cb，否则丢弃。只能由一个任务调用。
+ */
+void xn_gateway_process(void);
+
+/**
+ * @brief 向子设备下发控制命令
+ *
+ * 可在任意任务中调用（不可在中断中调用）。
+ *
+ * @param device_id 设备ID
+ * @param payload 控制负载（原样下发）
+ * @param len 负载长度
+ * @return esp_err_t
+ *      - ESP_OK: 已提交发送
+ *      - ESP_ERR_NOT_FOUND: 设备不在本网关的设备表中
+ *      - ESP_ERR_INVALID_SIZE: 负载超出单帧长度
+ *      - ESP_ERR_INVALID_STATE: 未初始化
+ *      - 其他: esp_now_send 失败
+ */
+esp_err_t xn_gateway_send_control(const char *device_id, const uint8_t *payload, size_t len);
+
+/**
+ * @brief 生成汇总心跳 JSON，并移除离线设备
+ *
+ * 格式：{"gateway":"<id>","devices":[{"id":..,"type":..,"rssi":..,"age":秒}],"offline":[..]}
+ * offline 列出本次判定离线的设备，每个设备只出现一次。与 xn_gateway_process 由同一任务调用。
+ *
+ * @param gateway_id 网关标识
+ * @param buf 输出缓冲区
+ * @param len 缓冲区长度，建议不小于 max_devices * 96 + 64
+ * @return int 写入的字节数（不含结束符），缓冲区不足或未初始化时返回 -1（离线设备仍被移除）
+ */
+int xn_gateway_heartbeat_to_json(const char *gateway_id, char *buf, size_t len);
+
+/**
+ * @brief 读取统计
+ *
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_ARG 参数为空，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t xn_gateway_get_stats(xn_gateway_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XN_GATEWAY_H */
@@ -0,0 +1,647 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-29 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-29 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_gateway\src\xn_gateway.c
+ * @Description: 边缘网关组件实现 - ESP-NOW 收包队列、报文认证、设备表、peer LRU、状态去重与心跳汇总
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_now.h"
+#include "esp_wifi.h"
+#include "esp_timer.h"
+#include "esp_rom_crc.h"
+#include "esp_random.h"
+#include "mbedtls/md.h"
+#include "xn_gateway.h"
+
+static const char *TAG = "xn_gateway";
+
+#define GW_HDR_LEN 4    // 魔数、版本、类型、ID长度
+#define GW_SEQ_LEN 8    // 接收方会话随机数、发送方帧计数
+
+/*===========================================================================
+ *                          内部数据
+ *===========================================================================*/
+
+/**
+ * @brief 收包队列元素（WiFi 任务中拷贝，处理任务中解析）
+ */
+typedef struct {
+    uint8_t mac[ESP_NOW_ETH_ALEN];          ///< 发送方地址
+    int8_t rssi;                            ///< 信号强度
+    uint8_t len;                            ///< 报文长度
+    uint8_t data[XN_GATEWAY_FRAME_MAX];     ///< 报文
+} gw_rx_frame_t;
+
+/**
+ * @brief 设备表项
+ */
+typedef struct {
+    bool used;                              ///< 表项已占用
+    bool peer;                              ///< 已登记为 ESP-NOW peer
+    bool status_valid;                      ///< 已转发过状态
+    int8_t rssi;                            ///< 最近一次报文的信号强度
+    uint8_t mac[ESP_NOW_ETH_ALEN];          ///< 设备地址（只由通过认证的报文更新）
+    uint8_t key[XN_GATEWAY_KEY_LEN];        ///< 设备密钥（由主密钥派生）
+    uint32_t peer_nonce;                    ///< 设备当前的会话随机数
+    uint32_t rx_counter;                    ///< 设备本会话最近接受的帧计数
+    char id[XN_GATEWAY_ID_MAX + 1];         ///< 设备ID
+    char type[XN_GATEWAY_TYPE_MAX + 1];     ///< 设备类型（心跳中携带）
+    uint32_t status_crc;                    ///< 上次转发的状态 CRC32
+    int64_t status_at_us;                   ///< 上次转发状态的时间
+    int64_t last_seen_us;                   ///< 最近一次收到报文的时间
+    int64_t peer_used_us;                   ///< 最近一次向其发送的时间（peer 淘汰用）
+} gw_device_t;
+
+static bool s_initialized = false;                  ///< 初始化标志
+static xn_gateway_config_t s_cfg;                   ///< 配置副本
+static gw_device_t *s_devices = NULL;               ///< 设备表
+static QueueHandle_t s_rx_queue = NULL;             ///< 收包队列
+static SemaphoreHandle_t s_lock = NULL;             ///< 设备表与统计保护锁
+static xn_gateway_stats_t s_stats;                  ///< 统计（rx_dropped 在 WiFi 任务中累加）
+static gw_rx_frame_t s_rx_frame;                    ///< 处理中的报文，只在 xn_gateway_process 中使用
+static uint8_t s_mac[ESP_NOW_ETH_ALEN];             ///< 本机 STA 地址（计算下行认证码）
+static uint32_t s_nonce;                            ///< 本次启动的会话随机数
+static uint32_t s_tx_counter;                       ///< 下行帧计数（需持有 s_lock）
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 检查设备ID/类型字符：只允许字母、数字与 "_-."，可直接用于 MQTT Topic 和 JSON
+ */
+static bool gw_name_valid(const uint8_t *s, size_t n, size_t max)
+{
+    if (n == 0 || n > max) {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        uint8_t c = s[i];
+        bool ok = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                  c == '_' || c == '-' || c == '.';
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint32_t gw_get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void gw_put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/**
+ * @brief 计算报文认证码：HMAC-SHA256(key, mac + frame) 的前 XN_GATEWAY_TAG_LEN 字节
+ */
+static void gw_tag(const uint8_t *key, size_t key_len, const uint8_t *mac,
+                   const uint8_t *frame, size_t len, uint8_t *tag)
+{
+    uint8_t out[32];
+    mbedtls_md_context_t ctx;
+    mbedtls_md_init(&ctx);
+    if (mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1) != 0 ||
+        mbedtls_md_hmac_starts(&ctx, key, key_len) != 0 ||
+        mbedtls_md_hmac_update(&ctx, mac, ESP_NOW_ETH_ALEN) != 0 ||
+        mbedtls_md_hmac_update(&ctx, frame, len) != 0 ||
+        mbedtls_md_hmac_finish(&ctx, out) != 0) {
+        memset(out, 0, sizeof(out));    // 失败时给出固定值，下行帧对端校验不过，上行帧几乎不可能与之相等
+    }
+    mbedtls_md_free(&ctx);
+    memcpy(tag, out, XN_GATEWAY_TAG_LEN);
+}
+
+/**
+ * @brief 常量时间比较认证码
+ */
+static bool gw_tag_equal(const uint8_t *a, const uint8_t *b)
+{
+    uint8_t diff = 0;
+    for (size_t i = 0; i < XN_GATEWAY_TAG_LEN; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+/**
+ * @brief 由主密钥派生设备密钥：HMAC-SHA256(主密钥, 设备ID) 的前 XN_GATEWAY_KEY_LEN 字节
+ */
+static void gw_derive_key(const char *id, uint8_t *key)
+{
+    uint8_t out[32];
+    if (mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), s_cfg.key, sizeof(s_cfg.key),
+                        (const uint8_t *)id, strlen(id), out) != 0) {
+        memset(out, 0, sizeof(out));
+    }
+    memcpy(key, out, XN_GATEWAY_KEY_LEN);
+}
+
+/**
+ * @brief 按ID查找设备（需持有 s_lock）
+ */
+static gw_device_t *gw_find(const char *id)
+{
+    for (uint16_t i = 0; i < s_cfg.max_devices; i++) {
+        if (s_devices[i].used && strcmp(s_devices[i].id, id) == 0) {
+            return &s_devices[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 占用一个空闲表项（需持有 s_lock）
+ */
+static gw_device_t *gw_alloc(const char *id)
+{
+    for (uint16_t i = 0; i < s_cfg.max_devices; i++) {
+        if (!s_devices[i].used) {
+            gw_device_t *d = &s_devices[i];
+            memset(d, 0, sizeof(*d));
+            d->used = true;
+            strlcpy(d->id, id, sizeof(d->id));
+            return d;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 移除设备，登记过的 peer 一并删除（需持有 s_lock）
+ */
+static void gw_remove(gw_device_t *d)
+{
+    if (d->peer) {
+        esp_now_del_peer(d->mac);
+    }
+    d->used = false;
+    d->peer = false;
+}
+
+/**
+ * @brief 确保设备已登记为 peer；peer 数达到上限时淘汰最久未发送的设备（需持有 s_lock）
+ *
+ * ESP-NOW 的 peer 数有限（约20个），设备表可以更大，只有需要下发的设备占用 peer
+ */
+static esp_err_t gw_ensure_peer(gw_device_t *d, int64_t now)
+{
+    d->peer_used_us = now;
+    if (d->peer) {
+        return ESP_OK;
+    }
+
+    esp_now_peer_info_t peer = {
+        .channel = 0,           // 跟随 STA 当前信道
+        .ifidx = WIFI_IF_STA,
+        .encrypt = false,
+    };
+    memcpy(peer.peer_addr, d->mac, ESP_NOW_ETH_ALEN);
+
+    esp_err_t ret = esp_now_add_peer(&peer);
+    if (ret == ESP_ERR_ESPNOW_FULL) {
+        gw_device_t *lru = NULL;
+        for (uint16_t i = 0; i < s_cfg.max_devices; i++) {
+            gw_device_t *c = &s_devices[i];
+            if (c->used && c->peer && (lru == NULL || c->peer_used_us < lru->peer_used_us)) {
+                lru = c;
+            }
+        }
+        if (lru == NULL) {
+            return ret;
+        }
+        esp_now_del_peer(lru->mac);
+        lru->peer = false;
+        ret = esp_now_add_peer(&peer);
+    }
+    if (ret == ESP_OK || ret == ESP_ERR_ESPNOW_EXIST) {
+        d->peer = true;
+        return ESP_OK;
+    }
+    return ret;
+}
+
+/**
+ * @brief 向设备发送一帧（需持有 s_lock）
+ */
+static esp_err_t gw_send(gw_device_t *d, uint8_t type, const uint8_t *payload, size_t len)
+{
+    uint8_t frame[XN_GATEWAY_FRAME_MAX];
+    size_t n = strlen(d->id);
+    size_t body = GW_HDR_LEN + n + GW_SEQ_LEN;
+    if (body + len + XN_GATEWAY_TAG_LEN > sizeof(frame)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    esp_err_t ret = gw_ensure_peer(d, esp_timer_get_time());
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    frame[0] = XN_GATEWAY_MAGIC;
+    frame[1] = XN_GATEWAY_VERSION;
+    frame[2] = type;
+    frame[3] = (uint8_t)n;
+    memcpy(&frame[GW_HDR_LEN], d->id, n);
+    gw_put_u32(&frame[GW_HDR_LEN + n], d->peer_nonce);
+    gw_put_u32(&frame[GW_HDR_LEN + n + 4], ++s_tx_counter);
+    if (len > 0) {
+        memcpy(&frame[body], payload, len);
+    }
+    gw_tag(d->key, sizeof(d->key), s_mac, frame, body + len, &frame[body + len]);
+    return esp_now_send(d->mac, frame, body + len + XN_GATEWAY_TAG_LEN);
+}
+
+/**
+ * @brief 解析并处理一帧上行报文
+ *
+ * 认证通过之前不改动设备表：未知设备ID用派生密钥校验，通过后才占用表项，
+ * 已知设备的地址只随通过认证的报文更新。
+ */
+static void gw_handle_frame(const gw_rx_frame_t *f)
+{
+    const uint8_t *p = f->data;
+    uint8_t n = (f->len >= GW_HDR_LEN) ? p[3] : 0;
+    if (f->len < GW_HDR_LEN || p[1] != XN_GATEWAY_VERSION ||
+        f->len < GW_HDR_LEN + n + GW_SEQ_LEN + XN_GATEWAY_TAG_LEN ||
+        !gw_name_valid(&p[GW_HDR_LEN], n, XN_GATEWAY_ID_MAX)) {
+        s_stats.rx_invalid++;
+        return;
+    }
+    uint8_t type = p[2];
+    if (type != XN_GATEWAY_FRAME_HEARTBEAT && type != XN_GATEWAY_FRAME_STATUS) {
+        return;     // 其他网关发出的下行报文
+    }
+
+    char id[XN_GATEWAY_ID_MAX + 1];
+    memcpy(id, &p[GW_HDR_LEN], n);
+    id[n] = '\0';
+    uint32_t echo = gw_get_u32(&p[GW_HDR_LEN + n]);
+    uint32_t counter = gw_get_u32(&p[GW_HDR_LEN + n + 4]);
+    size_t signed_len = f->len - XN_GATEWAY_TAG_LEN;
+    const uint8_t *body = &p[GW_HDR_LEN + n + GW_SEQ_LEN];
+    size_t body_len = signed_len - GW_HDR_LEN - n - GW_SEQ_LEN;
+
+    // 心跳中的设备类型与会话随机数
+    uint32_t device_nonce = 0;
+    if (type == XN_GATEWAY_FRAME_HEARTBEAT) {
+        if (body_len < 1 || body_len != 1u + body[0] + 4 ||
+            !gw_name_valid(&body[1], body[0], XN_GATEWAY_TYPE_MAX)) {
+            s_stats.rx_invalid++;
+            return;
+        }
+        device_nonce = gw_get_u32(&body[1 + body[0]]);
+    }
+
+    int64_t now = esp_timer_get_time();
+    bool forward = false;
+    uint8_t key[XN_GATEWAY_KEY_LEN];
+    uint8_t tag[XN_GATEWAY_TAG_LEN];
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    gw_device_t *d = gw_find(id);
+    if (d != NULL) {
+        memcpy(key, d->key, sizeof(key));
+    } else {
+        gw_derive_key(id, key);
+    }
+    gw_tag(key, sizeof(key), f->mac, p, signed_len, tag);
+    if (!gw_tag_equal(tag, &p[signed_len])) {
+        s_stats.rx_rejected++;
+        xSemaphoreGive(s_lock);
+        ESP_LOGD(TAG, "Rejected frame for %s from " MACSTR ": bad tag", id, MAC2STR(f->mac));
+        return;
+    }
+
+    // 重放检查：心跳可以开启新会话（子设备重启），其余报文必须属于当前会话且计数递增
+    if (type == XN_GATEWAY_FRAME_HEARTBEAT) {
+        if (d != NULL && device_nonce == d->peer_nonce && counter <= d->rx_counter) {
+            s_stats.rx_rejected++;
+            xSemaphoreGive(s_lock);
+            return;
+        }
+    } else if (d == NULL || echo != s_nonce || counter <= d->rx_counter) {
+        s_stats.rx_rejected++;
+        xSemaphoreGive(s_lock);
+        return;     // 网关重启前的会话或重放，子设备下次心跳后恢复
+    }
+
+    s_stats.rx_frames++;
+    if (d == NULL) {
+        d = gw_alloc(id);
+        if (d == NULL) {
+            s_stats.table_full++;
+            xSemaphoreGive(s_lock);
+            ESP_LOGW(TAG, "Device table full, ignoring %s", id);
+            return;
+        }
+        memcpy(d->key, key, sizeof(d->key));
+        memcpy(d->mac, f->mac, ESP_NOW_ETH_ALEN);
+        ESP_LOGI(TAG, "Device joined: %s (" MACSTR ")", id, MAC2STR(f->mac));
+    } else if (memcmp(d->mac, f->mac, ESP_NOW_ETH_ALEN) != 0) {
+        // 认证码覆盖发送方地址，只有持有设备密钥的设备能更换地址；旧 peer 失效
+        ESP_LOGI(TAG, "Device %s moved to " MACSTR, id, MAC2STR(f->mac));
+        if (d->peer) {
+            esp_now_del_peer(d->mac);
+            d->peer = false;
+        }
+        memcpy(d->mac, f->mac, ESP_NOW_ETH_ALEN);
+    }
+    if (type == XN_GATEWAY_FRAME_HEARTBEAT) {
+        d->peer_nonce = device_nonce;
+    }
+    d->rx_counter = counter;
+    d->rssi = f->rssi;
+    d->last_seen_us = now;
+
+    if (type == XN_GATEWAY_FRAME_HEARTBEAT) {
+        memcpy(d->type, &body[1], body[0]);
+        d->type[body[0]] = '\0';
+        uint8_t ack[4];
+        gw_put_u32(ack, s_nonce);
+        esp_err_t ret = gw_send(d, XN_GATEWAY_FRAME_ACK, ack, sizeof(ack));
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "ACK to %s failed: %s", id, esp_err_to_name(ret));
+        }
+    } else {
+        // 状态去重：内容未变化且未到刷新间隔时丢弃
+        uint32_t crc = esp_rom_crc32_le(0, body, (uint32_t)body_len);
+        bool stale = s_cfg.status_refresh_ms > 0 &&
+                     now - d->status_at_us >= (int64_t)s_cfg.status_refresh_ms * 1000;
+        if (d->status_valid && crc == d->status_crc && !stale) {
+            s_stats.status_deduped++;
+        } else {
+            d->status_valid = true;
+            d->status_crc = crc;
+            d->status_at_us = now;
+            s_stats.status_forwarded++;
+            forward = true;
+        }
+    }
+    xSemaphoreGive(s_lock);
+
+    // 回调在锁外执行，回调中可以调用 xn_gateway_send_control
+    if (forward && s_cfg.status_cb) {
+        s_cfg.status_cb(id, body, body_len, s_cfg.user_data);
+    }
+}
+
+/**
+ * @brief ESP-NOW 收包回调（WiFi 任务）：只拷贝到队列并通知处理任务
+ */
+static void gw_recv_cb(const esp_now_recv_info_t *info, const uint8_t *data, int len)
+{
+    if (info == NULL || data == NULL || len < GW_HDR_LEN || len > XN_GATEWAY_FRAME_MAX ||
+        data[0] != XN_GATEWAY_MAGIC) {
+        return;     // 不是本协议的报文
+    }
+
+    gw_rx_frame_t f;
+    memcpy(f.mac, info->src_addr, ESP_NOW_ETH_ALEN);
+    f.rssi = info->rx_ctrl ? (int8_t)info->rx_ctrl->rssi : 0;
+    f.len = (uint8_t)len;
+    memcpy(f.data, data, len);
+    if (xQueueSend(s_rx_queue, &f, 0) != pdTRUE) {
+        s_stats.rx_dropped++;
+        return;
+    }
+    if (s_cfg.notify_cb) {
+        s_cfg.notify_cb(s_cfg.user_data);
+    }
+}
+
+/**
+ * @brief 向 JSON 缓冲区追加内容，空间不足时置 ok 为 false，之后的追加不再写入
+ */
+static void gw_json_append(char *buf, size_t len, size_t *off, bool *ok, const char *fmt, ...)
+{
+    if (!*ok) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    int w = vsnprintf(buf + *off, len - *off, fmt, ap);
+    va_end(ap);
+    if (w < 0 || (size_t)w >= len - *off) {
+        *ok = false;
+        return;
+    }
+    *off += w;
+}
+
+/*===========================================================================
+ *                          公共API实现
+ *===========================================================================*/
+
+/* 获取默认配置 */
+xn_gateway_config_t xn_gateway_get_default_config(void)
+{
+    xn_gateway_config_t config = {
+        .max_devices = 64,
+        .rx_queue_len = 16,
+        .offline_ms = 90000,
+        .status_refresh_ms = 600000,
+        .status_cb = NULL,
+        .notify_cb = NULL,
+        .user_data = NULL,
+    };
+    return config;
+}
+
+/* 初始化网关 */
+esp_err_t xn_gateway_init(const xn_gateway_config_t *config)
+{
+    if (s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (config == NULL || config->max_devices == 0 || config->rx_queue_len == 0 || config->offline_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint8_t key_set = 0;
+    for (size_t i = 0; i < sizeof(config->key); i++) {
+        key_set |= config->key[i];
+    }
+    if (key_set == 0) {
+        ESP_LOGE(TAG, "Gateway key not configured");
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_cfg = *config;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_tx_counter = 0;
+    do {
+        s_nonce = esp_random();
+    } while (s_nonce == 0);     // 0 表示尚未得知会话随机数
+
+    s_devices = calloc(s_cfg.max_devices, sizeof(gw_device_t));
+    s_rx_queue = xQueueCreate(s_cfg.rx_queue_len, sizeof(gw_rx_frame_t));
+    s_lock = xSemaphoreCreateMutex();
+    if (s_devices == NULL || s_rx_queue == NULL || s_lock == NULL) {
+        xn_gateway_deinit();
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = esp_wifi_get_mac(WIFI_IF_STA, s_mac);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "esp_wifi_get_mac failed: %s", esp_err_to_name(ret));
+        xn_gateway_deinit();
+        return ret;
+    }
+
+    ret = esp_now_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "esp_now_init failed: %s", esp_err_to_name(ret));
+        xn_gateway_deinit();
+        return ret;
+    }
+    esp_now_register_recv_cb(gw_recv_cb);
+
+    s_initialized = true;
+    ESP_LOGI(TAG, "Gateway ready: %u devices, offline %u ms, status refresh %u ms",
+             (unsigned)s_cfg.max_devices, (unsigned)s_cfg.offline_ms, (unsigned)s_cfg.status_refresh_ms);
+    return ESP_OK;
+}
+
+/* 反初始化网关 */
+esp_err_t xn_gateway_deinit(void)
+{
+    if (s_initialized) {
+        esp_now_unregister_recv_cb();
+        esp_now_deinit();   // 同时删除所有 peer
+        s_initialized = false;
+    }
+    if (s_rx_queue) {
+        vQueueDelete(s_rx_queue);
+        s_rx_queue = NULL;
+    }
+    if (s_lock) {
+        vSemaphoreDelete(s_lock);
+        s_lock = NULL;
+    }
+    if (s_devices) {
+        memset(s_devices, 0, (size_t)s_cfg.max_devices * sizeof(gw_device_t));    // 清除设备密钥
+    }
+    free(s_devices);
+    s_devices = NULL;
+    memset(s_cfg.key, 0, sizeof(s_cfg.key));
+    return ESP_OK;
+}
+
+/* 处理收包队列 */
+void xn_gateway_process(void)
+{
+    if (!s_initialized) {
+        return;
+    }
+    while (xQueueReceive(s_rx_queue, &s_rx_frame, 0) == pdTRUE) {
+        gw_handle_frame(&s_rx_frame);
+    }
+}
+
+/* 下发控制命令 */
+esp_err_t xn_gateway_send_control(const char *device_id, const uint8_t *payload, size_t len)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (device_id == NULL || (payload == NULL && len > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    gw_device_t *d = gw_find(device_id);
+    if (d != NULL) {
+        ret = gw_send(d, XN_GATEWAY_FRAME_CONTROL, payload, len);
+        if (ret == ESP_OK) {
+            s_stats.control_sent++;
+        }
+    }
+    xSemaphoreGive(s_lock);
+    return ret;
+}
+
+/* 生成汇总心跳 */
+int xn_gateway_heartbeat_to_json(const char *gateway_id, char *buf, size_t len)
+{
+    if (!s_initialized || buf == NULL || len == 0) {
+        return -1;
+    }
+
+    int64_t now = esp_timer_get_time();
+    int64_t offline_us = (int64_t)s_cfg.offline_ms * 1000;
+    size_t off = 0;
+    bool ok = true;
+    bool first = true;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    gw_json_append(buf, len, &off, &ok, "{\"gateway\":\"%s\",\"devices\":[", gateway_id ? gateway_id : "");
+    for (uint16_t i = 0; i < s_cfg.max_devices; i++) {
+        const gw_device_t *d = &s_devices[i];
+        if (!d->used || now - d->last_seen_us > offline_us) {
+            continue;
+        }
+        gw_json_append(buf, len, &off, &ok, "%s{\"id\":\"%s\",\"type\":\"%s\",\"rssi\":%d,\"age\":%u}",
+                       first ? "" : ",", d->id, d->type, d->rssi,
+                       (unsigned)((now - d->last_seen_us) / 1000000));
+        first = false;
+    }
+
+    // 离线设备列出一次后移除，释放表项与 peer
+    gw_json_append(buf, len, &off, &ok, "],\"offline\":[");
+    first = true;
+    for (uint16_t i = 0; i < s_cfg.max_devices; i++) {
+        gw_device_t *d = &s_devices[i];
+        if (!d->used || now - d->last_seen_us <= offline_us) {
+            continue;
+        }
+        gw_json_append(buf, len, &off, &ok, "%s\"%s\"", first ? "" : ",", d->id);
+        first = false;
+        ESP_LOGI(TAG, "Device offline: %s", d->id);
+        gw_remove(d);
+    }
+    gw_json_append(buf, len, &off, &ok, "]}");
+    xSemaphoreGive(s_lock);
+
+    return ok ? (int)off : -1;
+}
+
+/* 读取统计 */
+esp_err_t xn_gateway_get_stats(xn_gateway_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    stats->devices = 0;
+    for (uint16_t i = 0; i < s_cfg.max_devices; i++) {
+        if (s_devices[i].used) {
+            stats->devices++;
+        }
+    }
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
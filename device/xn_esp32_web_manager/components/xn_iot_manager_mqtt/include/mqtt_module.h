@@ -57,6 +57,29 @@ typedef void (*mqtt_module_message_cb_t)(const char  *topic,
                                          const uint8_t *payload,
                                          int          payload_len);
 
+/**
+ * @brief MQTT 模块收到数据分片时的回调函数原型
+ *
+ * 超过 esp-mqtt 接收缓冲区的大消息会被拆成多个 MQTT_EVENT_DATA 分片上报，
+ * 该回调透传每个分片在整条消息中的偏移与消息总长，便于上层一次分配、
+ * 原地拼装。未分片的消息 offset 为 0 且 data_len 等于 total_len。
+ *
+ * @param topic      消息所属 Topic 指针（仅首个分片有效，后续分片为 NULL）
+ * @param topic_len  Topic 长度（后续分片为 0）
+ * @param data       本分片数据指针（仅在回调期间有效）
+ * @param data_len   本分片长度（字节数）
+ * @param offset     本分片在整条消息中的偏移
+ * @param total_len  整条消息的总长度
+ * @param msg_id     消息ID（QoS0 时为 0）
+ */
+typedef void (*mqtt_module_data_cb_t)(const char    *topic,
+                                      int            topic_len,
+                                      const uint8_t *data,
+                                      int            data_len,
+                                      int            offset,
+                                      int            total_len,
+                                      int            msg_id);
+
 /* -------------------------------------------------------------------------- */
 /*                                   配置体                                    */
 /* -------------------------------------------------------------------------- */
@@ -72,14 +95,23 @@ typedef struct {
     const char           *username;      ///< 用户名，可为 NULL 表示匿名登录
     const char           *password;      ///< 密码，可为 NULL 表示无密码
     int                   keepalive_sec; ///< keepalive 保活时间（秒），<=0 使用内部默认(60s)
+    bool                  disable_auto_reconnect; ///< 关闭客户端内部的固定间隔重连，由上层调用 mqtt_module_reconnect
+    uint32_t              data_log_per_sec; ///< 每秒最多打印的收包日志条数，0 表示不打印
     mqtt_module_event_cb_t  event_cb;    ///< 连接事件回调，可为 NULL 表示不关心
     mqtt_module_message_cb_t message_cb; ///< 消息回调，可为 NULL 表示不关心
+    mqtt_module_data_cb_t    data_cb;    ///< 分片数据回调，非 NULL 时取代 message_cb
 } mqtt_module_config_t;
 
 /* -------------------------------------------------------------------------- */
 /*                                  默认配置                                   */
 /* -------------------------------------------------------------------------- */
 
+#define MQTT_MODULE_SUBSCRIBE_BATCH_MAX  16        ///< mqtt_module_subscribe_multiple 单次最多 Topic 数
+#define MQTT_MODULE_DATA_LOG_PER_SEC     5         ///< 默认每秒最多打印的收包日志条数
+#define MQTT_MODULE_STATS_TOPICS         16        ///< 分 Topic 统计的表项数，超出的 Topic 只计入总数
+#define MQTT_MODULE_STATS_TOPIC_LEN      64        ///< 统计表中 Topic 的最大长度（含结束符），超长的按截断后归并
+#define MQTT_MODULE_STATS_INFLIGHT       16        ///< 同时跟踪应答延迟的 QoS1/2 消息数
+
 /**
  * @brief MQTT 模块默认配置宏
  */
@@ -90,10 +122,50 @@ typedef struct {
         .username      = NULL,                      \
         .password      = NULL,                      \
         .keepalive_sec = 60,                        \
+        .disable_auto_reconnect = false,            \
+        .data_log_per_sec = MQTT_MODULE_DATA_LOG_PER_SEC, \
         .event_cb      = NULL,                      \
         .message_cb    = NULL,                      \
+        .data_cb       = NULL,                      \
     }
 
+/* -------------------------------------------------------------------------- */
+/*                                  统计数据                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief 单个 Topic 的收发计数
+ */
+typedef struct {
+    char     topic[MQTT_MODULE_STATS_TOPIC_LEN]; ///< Topic
+    uint32_t msgs_in;                    ///< 收到的消息数
+    uint32_t bytes_in;                   ///< 收到的负载字节数
+    uint32_t msgs_out;                   ///< 提交发送的消息数
+    uint32_t bytes_out;                  ///< 提交发送的负载字节数
+} mqtt_module_topic_stats_t;
+
+/**
+ * @brief MQTT 数据通路统计
+ *
+ * 计数从 mqtt_module_init 或 mqtt_module_reset_stats 起累计。
+ */
+typedef struct {
+    uint32_t msgs_in;                    ///< 收到的消息总数
+    uint32_t bytes_in;                   ///< 收到的负载总字节数
+    uint32_t msgs_out;                   ///< 提交发送的消息总数
+    uint32_t bytes_out;                  ///< 提交发送的负载总字节数
+    uint32_t publish_failed;             ///< 提交发送失败次数
+    uint32_t acked;                      ///< 收到应答（PUBACK/PUBCOMP）的 QoS1/2 消息数
+    uint32_t ack_untracked;              ///< 未计入延迟的应答数（已被挤出跟踪表，或应答早于发布调用返回）
+    uint32_t ack_latency_avg_ms;         ///< 发布到应答的平均延迟（ms）
+    uint32_t ack_latency_max_ms;         ///< 发布到应答的最大延迟（ms）
+    uint32_t inflight;                   ///< 当前等待应答的消息数
+    int      outbox_bytes;               ///< esp-mqtt 内部 outbox 占用的字节数
+    uint32_t data_log_suppressed;        ///< 被限速丢弃的收包日志条数
+    int      topic_count;                ///< topics 中的有效表项数
+    mqtt_module_topic_stats_t topics[MQTT_MODULE_STATS_TOPICS]; ///< 分 Topic 计数
+} mqtt_module_stats_t;
+
 /* -------------------------------------------------------------------------- */
 /*                                  对外接口                                   */
 /* -------------------------------------------------------------------------- */
@@ -136,6 +208,19 @@ esp_err_t mqtt_module_start(void);
  */
 esp_err_t mqtt_module_stop(void);
 
+/**
+ * @brief 立即重新连接服务器
+ *
+ * 用于 disable_auto_reconnect 为 true 时由上层决定重连时机；
+ * 客户端尚未启动时等同于 mqtt_module_start。
+ *
+ * @return
+ *      - ESP_OK               : 已发起重连
+ *      - ESP_ERR_INVALID_STATE: 未初始化
+ *      - ESP_FAIL             : 客户端当前不在等待重连状态（如正在连接）
+ */
+esp_err_t mqtt_module_reconnect(void);
+
 /**
  * @brief 发布一条 MQTT 消息
  *
@@ -157,6 +242,35 @@ esp_err_t mqtt_module_publish(const char *topic,
                               int         qos,
                               bool        retain);
 
+/**
+ * @brief 把一条消息放入客户端 outbox，由 MQTT 任务异步发出（不阻塞调用者）
+ *
+ * 适合实时数据流：调用者结合 mqtt_module_get_outbox_size 自行做背压，
+ * 链路变差时丢弃新数据，而不是阻塞在 socket 写入上。
+ *
+ * @param topic   目标 Topic 字符串
+ * @param payload 负载数据指针（内部会拷贝）
+ * @param len     负载长度（字节）
+ * @param qos     MQTT QoS 等级（0/1/2）
+ *
+ * @return
+ *      - ESP_OK              : 已放入 outbox
+ *      - ESP_ERR_INVALID_ARG : 参数非法
+ *      - ESP_ERR_INVALID_STATE : 客户端未初始化
+ *      - ESP_FAIL            : 入队失败（内存不足等）
+ */
+esp_err_t mqtt_module_enqueue(const char *topic,
+                              const void *payload,
+                              int         len,
+                              int         qos);
+
+/**
+ * @brief 获取客户端 outbox 当前占用的字节数
+ *
+ * @return int 字节数，未初始化时返回0
+ */
+int mqtt_module_get_outbox_size(void);
+
 /**
  * @brief 订阅指定 Topic
  *
@@ -171,6 +285,21 @@ esp_err_t mqtt_module_publish(const char *topic,
  */
 esp_err_t mqtt_module_subscribe(const char *topic, int qos);
 
+/**
+ * @brief 在一个 SUBSCRIBE 报文中订阅多个 Topic
+ *
+ * @param topics Topic 过滤器数组
+ * @param qos    与 topics 一一对应的 QoS 等级数组
+ * @param count  Topic 数量
+ *
+ * @return
+ *      - ESP_OK               : 已成功提交订阅请求
+ *      - ESP_ERR_INVALID_ARG  : 参数非法
+ *      - ESP_ERR_INVALID_STATE: 客户端未初始化或未启动
+ *      - ESP_FAIL             : 底层返回订阅失败
+ */
+esp_err_t mqtt_module_subscribe_multiple(const char *const *topics, const int *qos, int count);
+
 /**
  * @brief 取消订阅指定 Topic
  *
@@ -184,6 +313,30 @@ esp_err_t mqtt_module_subscribe(const char *topic, int qos);
  */
 esp_err_t mqtt_module_unsubscribe(const char *topic);
 
+/**
+ * @brief 获取数据通路统计
+ *
+ * @param[out] stats 统计数据
+ *
+ * @return
+ *      - ESP_OK               : 成功
+ *      - ESP_ERR_INVALID_ARG  : stats 为 NULL
+ *      - ESP_ERR_INVALID_STATE: 未初始化
+ */
+esp_err_t mqtt_module_get_stats(mqtt_module_stats_t *stats);
+
+/**
+ * @brief 清零数据通路统计（等待应答的消息继续跟踪）
+ */
+void mqtt_module_reset_stats(void);
+
+/**
+ * @brief 运行时调整收包日志限速
+ *
+ * @param per_sec 每秒最多打印的条数，0 表示不打印
+ */
+void mqtt_module_set_data_log_rate(uint32_t per_sec);
+
 #ifdef __cplusplus
 }
 #endif
@@ -12,7 +12,9 @@
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "mqtt_client.h"
 #include "mqtt_module.h"
 
@@ -23,6 +25,167 @@ static const char *TAG = "mqtt_module";           ///< 本模块日志 TAG
 static mqtt_module_config_t   s_mqtt_cfg;          ///< 保存一份配置副本
 static bool                   s_mqtt_inited = false; ///< 是否已初始化
 static esp_mqtt_client_handle_t s_mqtt_client = NULL; ///< MQTT 客户端句柄
+static bool                   s_mqtt_started = false; ///< 客户端任务是否已启动
+
+/**
+ * @brief 等待应答的 QoS1/2 消息
+ */
+typedef struct {
+    int                       msg_id;              ///< 消息 ID，0 表示空闲
+    int64_t                   sent_us;             ///< 提交发送的时间
+} mqtt_module_inflight_t;
+
+/* 数据通路统计：收包在客户端任务中更新，发包在调用者任务中更新 */
+static SemaphoreHandle_t      s_stats_lock = NULL; ///< 统计数据保护锁
+static mqtt_module_stats_t    s_stats;             ///< 统计数据（avg/inflight/outbox 在读取时计算）
+static uint64_t               s_ack_latency_sum_ms = 0; ///< 应答延迟累计，用于求平均
+static uint32_t               s_ack_samples = 0;   ///< 计入延迟的应答数
+static mqtt_module_inflight_t s_inflight[MQTT_MODULE_STATS_INFLIGHT]; ///< 等待应答的消息
+static int                    s_rx_slot = -1;      ///< 当前分片消息所属的 Topic 表项，-1 表示不在表中
+
+/* 收包日志限速，仅在客户端任务中访问 */
+static volatile uint32_t      s_log_rate = MQTT_MODULE_DATA_LOG_PER_SEC; ///< 每秒最多打印条数
+static TickType_t             s_log_window = 0;    ///< 当前限速窗口起点
+static uint32_t               s_log_count = 0;     ///< 当前窗口已打印条数
+static uint32_t               s_log_dropped = 0;   ///< 当前窗口被丢弃条数
+static volatile uint32_t      s_log_suppressed = 0; ///< 累计被丢弃条数
+
+/**
+ * @brief 查找或登记 Topic 统计表项（调用者持有 s_stats_lock）
+ *
+ * @return 表项下标，表已满时返回 -1
+ */
+static int mqtt_module_stats_slot(const char *topic, int topic_len)
+{
+    if (topic == NULL || topic_len <= 0) {
+        return -1;
+    }
+    // 超长的 Topic 按截断后的前缀归并
+    size_t len = (topic_len < MQTT_MODULE_STATS_TOPIC_LEN) ? (size_t)topic_len : MQTT_MODULE_STATS_TOPIC_LEN - 1;
+    for (int i = 0; i < s_stats.topic_count; i++) {
+        const char *name = s_stats.topics[i].topic;
+        if (strncmp(name, topic, len) == 0 && name[len] == '\0') {
+            return i;
+        }
+    }
+    if (s_stats.topic_count >= MQTT_MODULE_STATS_TOPICS) {
+        return -1;
+    }
+    mqtt_module_topic_stats_t *slot = &s_stats.topics[s_stats.topic_count];
+    memset(slot, 0, sizeof(*slot));
+    memcpy(slot->topic, topic, len);
+    return s_stats.topic_count++;
+}
+
+/**
+ * @brief 统计一个收到的分片
+ */
+static void mqtt_module_stats_rx(esp_mqtt_event_handle_t event)
+{
+    xSemaphoreTake(s_stats_lock, portMAX_DELAY);
+    // Topic 仅在首个分片中携带，后续分片沿用首分片的表项
+    if (event->current_data_offset == 0) {
+        s_rx_slot = mqtt_module_stats_slot(event->topic, event->topic_len);
+        s_stats.msgs_in++;
+        if (s_rx_slot >= 0) {
+            s_stats.topics[s_rx_slot].msgs_in++;
+        }
+    }
+    s_stats.bytes_in += event->data_len;
+    if (s_rx_slot >= 0) {
+        s_stats.topics[s_rx_slot].bytes_in += event->data_len;
+    }
+    xSemaphoreGive(s_stats_lock);
+}
+
+/**
+ * @brief 统计一次发布，QoS1/2 消息登记到应答跟踪表
+ */
+static void mqtt_module_stats_tx(const char *topic, int len, int qos, int msg_id)
+{
+    xSemaphoreTake(s_stats_lock, portMAX_DELAY);
+    if (msg_id < 0) {
+        s_stats.publish_failed++;
+        xSemaphoreGive(s_stats_lock);
+        return;
+    }
+
+    s_stats.msgs_out++;
+    s_stats.bytes_out += len;
+    int slot = mqtt_module_stats_slot(topic, (int)strlen(topic));
+    if (slot >= 0) {
+        s_stats.topics[slot].msgs_out++;
+        s_stats.topics[slot].bytes_out += len;
+    }
+
+    if (qos > 0 && msg_id > 0) {
+        // 表满时挤掉最早的一条，其应答到达时计入 ack_untracked
+        int victim = 0;
+        for (int i = 0; i < MQTT_MODULE_STATS_INFLIGHT; i++) {
+            if (s_inflight[i].msg_id == 0) {
+                victim = i;
+                break;
+            }
+            if (s_inflight[i].sent_us < s_inflight[victim].sent_us) {
+                victim = i;
+            }
+        }
+        s_inflight[victim].msg_id = msg_id;
+        s_inflight[victim].sent_us = esp_timer_get_time();
+    }
+    xSemaphoreGive(s_stats_lock);
+}
+
+/**
+ * @brief 统计一次应答（MQTT_EVENT_PUBLISHED）
+ */
+static void mqtt_module_stats_ack(int msg_id)
+{
+    int64_t now = esp_timer_get_time();
+    xSemaphoreTake(s_stats_lock, portMAX_DELAY);
+    s_stats.acked++;
+    for (int i = 0; i < MQTT_MODULE_STATS_INFLIGHT; i++) {
+        if (s_inflight[i].msg_id == msg_id) {
+            uint32_t ms = (uint32_t)((now - s_inflight[i].sent_us) / 1000);
+            s_ack_latency_sum_ms += ms;
+            s_ack_samples++;
+            if (ms > s_stats.ack_latency_max_ms) {
+                s_stats.ack_latency_max_ms = ms;
+            }
+            s_inflight[i].msg_id = 0;
+            xSemaphoreGive(s_stats_lock);
+            return;
+        }
+    }
+    // 应答早于登记（发布调用尚未返回）或已被挤出跟踪表
+    s_stats.ack_untracked++;
+    xSemaphoreGive(s_stats_lock);
+}
+
+/**
+ * @brief 收包日志限速：每秒最多 s_log_rate 条
+ *
+ * @return true 本条可以打印
+ */
+static bool mqtt_module_data_log_allow(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    if (now - s_log_window >= pdMS_TO_TICKS(1000)) {
+        if (s_log_dropped > 0) {
+            ESP_LOGI(TAG, "%u MQTT data logs suppressed", (unsigned)s_log_dropped);
+        }
+        s_log_window = now;
+        s_log_count = 0;
+        s_log_dropped = 0;
+    }
+    if (s_log_count < s_log_rate) {
+        s_log_count++;
+        return true;
+    }
+    s_log_dropped++;
+    s_log_suppressed++;
+    return false;
+}
 
 /**
  * @brief 内部辅助：统一分发事件到上层回调
@@ -67,13 +230,29 @@ static void mqtt_module_event_handler(void           *handler_args,
         mqtt_module_dispatch_event(MQTT_MODULE_EVENT_ERROR); ///< 上报错误
         break;
 
+    case MQTT_EVENT_PUBLISHED:                     ///< QoS1/2 消息已收到服务器应答
+        mqtt_module_stats_ack(event->msg_id);
+        break;
+
     case MQTT_EVENT_DATA:                          ///< 收到一条 MQTT 消息
-        ESP_LOGI(TAG, "MQTT data: topic=%.*s, len=%d",
-                 event->topic_len,
-                 event->topic,
-                 event->data_len);
+        mqtt_module_stats_rx(event);               ///< 分 Topic 计数
+        if (mqtt_module_data_log_allow()) {        ///< 高频收包时限速打印
+            ESP_LOGI(TAG, "MQTT data: topic=%.*s, len=%d",
+                     event->topic_len,
+                     event->topic,
+                     event->data_len);
+        }
 
-        if (s_mqtt_cfg.message_cb) {                ///< 若配置了消息回调
+        if (s_mqtt_cfg.data_cb) {                   ///< 若配置了分片数据回调
+            s_mqtt_cfg.data_cb(                     ///< 透传分片信息，由上层原地拼装
+                event->topic,                       ///< Topic 指针（仅首分片）
+                (int)event->topic_len,              ///< Topic 长度
+                (const uint8_t *)event->data,       ///< 分片数据指针
+                (int)event->data_len,               ///< 分片长度
+                (int)event->current_data_offset,    ///< 分片偏移
+                (int)event->total_data_len,         ///< 消息总长
+                event->msg_id);                     ///< 消息ID
+        } else if (s_mqtt_cfg.message_cb) {         ///< 若配置了消息回调
             s_mqtt_cfg.message_cb(                  ///< 调用上层回调
                 event->topic,                       ///< Topic 指针
                 (int)event->topic_len,              ///< Topic 长度
@@ -132,10 +311,26 @@ esp_err_t mqtt_module_init(const mqtt_module_config_t *config)
         mqtt_cfg.session.keepalive = 60; // 默认60s
     }
 
+    // 重连时机交给上层时关闭内部自动重连
+    mqtt_cfg.network.disable_auto_reconnect = s_mqtt_cfg.disable_auto_reconnect;
+
+    /* 统计数据 */
+    s_stats_lock = xSemaphoreCreateMutex();
+    if (s_stats_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memset(&s_stats, 0, sizeof(s_stats));
+    memset(s_inflight, 0, sizeof(s_inflight));
+    s_ack_latency_sum_ms = 0;
+    s_ack_samples = 0;
+    s_log_rate = s_mqtt_cfg.data_log_per_sec;
+
     /* 创建 MQTT 客户端实例 */
     s_mqtt_client = esp_mqtt_client_init(&mqtt_cfg);
     if (s_mqtt_client == NULL) {
         ESP_LOGE(TAG, "esp_mqtt_client_init failed");
+        vSemaphoreDelete(s_stats_lock);
+        s_stats_lock = NULL;
         return ESP_ERR_NO_MEM;
     }
 
@@ -150,6 +345,8 @@ esp_err_t mqtt_module_init(const mqtt_module_config_t *config)
         ESP_LOGE(TAG, "esp_mqtt_client_register_event failed: %s", esp_err_to_name(ret));
         esp_mqtt_client_destroy(s_mqtt_client);
         s_mqtt_client = NULL;
+        vSemaphoreDelete(s_stats_lock);
+        s_stats_lock = NULL;
         return ret;
     }
 
@@ -172,10 +369,26 @@ esp_err_t mqtt_module_start(void)
         return ret;
     }
 
+    s_mqtt_started = true;
     ESP_LOGI(TAG, "MQTT module started");
     return ESP_OK;
 }
 
+/* 立即重新连接 */
+esp_err_t mqtt_module_reconnect(void)
+{
+    if (!s_mqtt_inited || s_mqtt_client == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* 客户端任务尚未运行时先启动 */
+    if (!s_mqtt_started) {
+        return mqtt_module_start();
+    }
+
+    return esp_mqtt_client_reconnect(s_mqtt_client);
+}
+
 /* 停止 MQTT 客户端 */
 esp_err_t mqtt_module_stop(void)
 {
@@ -189,6 +402,7 @@ esp_err_t mqtt_module_stop(void)
         ESP_LOGE(TAG, "esp_mqtt_client_stop failed: %s", esp_err_to_name(ret));
         return ret;
     }
+    s_mqtt_started = false;
 
     ESP_LOGI(TAG, "MQTT module stopped");
     return ESP_OK;
@@ -223,6 +437,7 @@ esp_err_t mqtt_module_publish(const char *topic,
         len,
         qos,
         retain);
+    mqtt_module_stats_tx(topic, len, qos, msg_id);
 
     if (msg_id < 0) {
         ESP_LOGE(TAG, "esp_mqtt_client_publish failed, ret=%d", msg_id);
@@ -232,6 +447,71 @@ esp_err_t mqtt_module_publish(const char *topic,
     return ESP_OK; // 成功加入发送队列
 }
 
+/* 放入outbox异步发送 */
+esp_err_t mqtt_module_enqueue(const char *topic,
+                              const void *payload,
+                              int         len,
+                              int         qos)
+{
+    if (!s_mqtt_inited || s_mqtt_client == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (topic == NULL || topic[0] == '\0' || len < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // store=true：QoS0 消息也进入 outbox，由 MQTT 任务发送后删除
+    int msg_id = esp_mqtt_client_enqueue(s_mqtt_client, topic, (const char *)payload, len, qos, false, true);
+    mqtt_module_stats_tx(topic, len, qos, msg_id);
+
+    if (msg_id < 0) {
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+/* 获取outbox占用字节数 */
+int mqtt_module_get_outbox_size(void)
+{
+    if (!s_mqtt_inited || s_mqtt_client == NULL) {
+        return 0;
+    }
+
+    return esp_mqtt_client_get_outbox_size(s_mqtt_client);
+}
+
+/* 一次订阅多个主题 */
+esp_err_t mqtt_module_subscribe_multiple(const char *const *topics, const int *qos, int count)
+{
+    if (!s_mqtt_inited || s_mqtt_client == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (topics == NULL || qos == NULL || count <= 0 || count > MQTT_MODULE_SUBSCRIBE_BATCH_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_mqtt_topic_t list[MQTT_MODULE_SUBSCRIBE_BATCH_MAX];
+    for (int i = 0; i < count; i++) {
+        if (topics[i] == NULL || topics[i][0] == '\0' || qos[i] < 0 || qos[i] > 2) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        list[i].filter = topics[i];
+        list[i].qos = qos[i];
+    }
+
+    // 所有过滤器放在同一个 SUBSCRIBE 报文中
+    int msg_id = esp_mqtt_client_subscribe_multiple(s_mqtt_client, list, count);
+    if (msg_id < 0) {
+        ESP_LOGE(TAG, "esp_mqtt_client_subscribe_multiple failed, ret=%d", msg_id);
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
 /* 订阅主题 */
 esp_err_t mqtt_module_subscribe(const char *topic, int qos)
 {
@@ -286,3 +566,52 @@ esp_err_t mqtt_module_unsubscribe(const char *topic)
     ESP_LOGD(TAG, "Unsubscribed from %s (msg_id=%d)", topic, msg_id);
     return ESP_OK;
 }
+
+/* 获取数据通路统计 */
+esp_err_t mqtt_module_get_stats(mqtt_module_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_mqtt_inited || s_mqtt_client == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_stats_lock, portMAX_DELAY);
+    memcpy(stats, &s_stats, sizeof(*stats));
+    stats->ack_latency_avg_ms = (s_ack_samples > 0) ? (uint32_t)(s_ack_latency_sum_ms / s_ack_samples) : 0;
+    stats->inflight = 0;
+    for (int i = 0; i < MQTT_MODULE_STATS_INFLIGHT; i++) {
+        if (s_inflight[i].msg_id != 0) {
+            stats->inflight++;
+        }
+    }
+    xSemaphoreGive(s_stats_lock);
+
+    stats->outbox_bytes = esp_mqtt_client_get_outbox_size(s_mqtt_client);
+    stats->data_log_suppressed = s_log_suppressed;
+    return ESP_OK;
+}
+
+/* 清零数据通路统计 */
+void mqtt_module_reset_stats(void)
+{
+    if (s_stats_lock == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_stats_lock, portMAX_DELAY);
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_ack_latency_sum_ms = 0;
+    s_ack_samples = 0;
+    s_rx_slot = -1;
+    xSemaphoreGive(s_stats_lock);
+    s_log_suppressed = 0;
+}
+
+/* 运行时调整收包日志限速 */
+void mqtt_module_set_data_log_rate(uint32_t per_sec)
+{
+    s_log_rate = per_sec;
+}
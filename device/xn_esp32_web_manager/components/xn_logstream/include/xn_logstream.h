@@ -0,0 +1,134 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-28 14:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-28 14:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_logstream\include\xn_logstream.h
+ * @Description: 二进制日志组件头文件 - 接管 esp_log 输出，按格式串地址 + 参数编码写入无锁环形缓冲，按标签限速
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_LOGSTREAM_H
+#define XN_LOGSTREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ *                          类型定义
+ *===========================================================================*/
+
+#define XN_LOGSTREAM_BATCH_MAGIC    0x474C4E58  ///< 批次头魔数，小端字节序为 "XNLG"
+#define XN_LOGSTREAM_VERSION        1           ///< 编码格式版本
+#define XN_LOGSTREAM_RECORD_MAX     192         ///< 单条记录最大字节数，参数超出时截断
+
+/**
+ * @brief 批次头（小端，紧随其后为 4 字节对齐的记录）
+ *
+ * 记录格式：
+ * - u32 头：bit0~15 记录总长（含头，4 的倍数），bit28 格式串内联，bit29 参数被截断
+ * - 格式串：未内联时为 u32 地址（在固件 ELF 的只读数据段中查找），内联时同 %s 参数
+ * - 参数：按格式串中的转换顺序排列，无对齐填充
+ *   - 整数、字符、指针、'*' 宽度/精度：4 字节；ll/j 整数与浮点(double)：8 字节
+ *   - %s：首字节 0xFF 后跟 u32 地址（字符串在 flash 只读数据中），0xFE 表示 NULL，
+ *     其他值为内联长度，后跟该长度的字节
+ *
+ * esp_log 的级别字母、时间戳与标签本身就是格式串前缀中的参数，解码时按原格式串还原即得原文。
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;                     ///< XN_LOGSTREAM_BATCH_MAGIC
+    uint8_t version;                    ///< XN_LOGSTREAM_VERSION
+    uint8_t reserved;                   ///< 保留，为0
+    uint16_t count;                     ///< 记录条数
+    uint16_t length;                    ///< 批次总字节数（含批次头）
+    uint16_t reserved2;                 ///< 保留，为0
+    uint32_t seq;                       ///< 批次序号，从0递增，不连续表示批次丢失
+    uint32_t dropped;                   ///< 启动以来因缓冲区满丢弃的记录数
+    uint32_t suppressed;                ///< 启动以来因标签限速丢弃的记录数
+} xn_logstream_batch_header_t;
+
+/**
+ * @brief 二进制日志配置
+ */
+typedef struct {
+    size_t ring_size;                   ///< 环形缓冲字节数，2 的幂（默认8192）
+    uint16_t tag_rate;                  ///< 每个标签每秒最多写入的记录数，0 不限（默认20）
+    uint8_t max_str;                    ///< 内联字符串参数最大字节数，超出截断（默认48）
+    esp_log_level_t uart_level;         ///< 同时输出到原日志通道（UART）的最高级别，ESP_LOG_NONE 不输出（默认 ESP_LOG_VERBOSE）
+} xn_logstream_config_t;
+
+/**
+ * @brief 二进制日志统计
+ */
+typedef struct {
+    uint32_t records;                   ///< 写入环形缓冲的记录数
+    uint32_t dropped;                   ///< 缓冲区满丢弃的记录数
+    uint32_t suppressed;                ///< 标签限速丢弃的记录数
+    uint32_t truncated;                 ///< 参数被截断的记录数
+    uint32_t used;                      ///< 当前占用字节数
+    uint32_t high_water;                ///< 历史最大占用字节数
+} xn_logstream_stats_t;
+
+/*===========================================================================
+ *                          API
+ *===========================================================================*/
+
+/**
+ * @brief 获取默认配置
+ */
+xn_logstream_config_t xn_logstream_get_default_config(void);
+
+/**
+ * @brief 初始化：分配环形缓冲并通过 esp_log_set_vprintf 接管日志输出
+ *
+ * 此后每条日志在调用者任务中编码为二进制记录（不做格式化），多个任务同时写入无锁；
+ * 级别不高于 uart_level 的日志仍交给原输出函数打印。安装后不可卸载。
+ *
+ * @param config 配置
+ * @return esp_err_t
+ *      - ESP_OK: 成功
+ *      - ESP_ERR_INVALID_STATE: 已初始化
+ *      - ESP_ERR_INVALID_ARG: 配置无效（ring_size 不是 2 的幂或小于 1KB）
+ *      - ESP_ERR_NO_MEM: 内存不足
+ */
+esp_err_t xn_logstream_init(const xn_logstream_config_t *config);
+
+/**
+ * @brief 取出最早的记录，组成一个批次（批次头 + 记录）
+ *
+ * 只能由一个任务调用。放不下的记录留在缓冲中，下次再取。
+ *
+ * @param buf 输出缓冲区
+ * @param len 缓冲区长度，不小于 sizeof(xn_logstream_batch_header_t) + XN_LOGSTREAM_RECORD_MAX
+ * @return size_t 批次字节数，没有记录或参数无效时返回 0
+ */
+size_t xn_logstream_read_batch(uint8_t *buf, size_t len);
+
+/**
+ * @brief 丢弃最早的记录，直到占用不超过 keep 字节
+ *
+ * 与 xn_logstream_read_batch 由同一任务调用。周期调用可让缓冲区始终保留最近的日志，
+ * 新记录不会因缓冲区满被丢弃。
+ *
+ * @param keep 保留的最大字节数
+ */
+void xn_logstream_trim(size_t keep);
+
+/**
+ * @brief 读取统计
+ */
+esp_err_t xn_logstream_get_stats(xn_logstream_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // XN_LOGSTREAM_H
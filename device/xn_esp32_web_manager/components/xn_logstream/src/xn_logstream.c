@@ -0,0 +1,483 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-28 14:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-28 14:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_logstream\src\xn_logstream.c
+ * @Description: 二进制日志组件实现 - 格式串驱动的参数编码、多生产者无锁环形缓冲与标签限速
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "esp_memory_utils.h"
+#include "xn_logstream.h"
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+#define REC_LEN_MASK        0x0000FFFFu     ///< 记录头：记录总长
+#define REC_FMT_INLINE      (1u << 28)      ///< 记录头：格式串内联
+#define REC_TRUNCATED       (1u << 29)      ///< 记录头：参数被截断
+#define REC_PAD             (1u << 30)      ///< 记录头：环形缓冲末尾的填充（不输出）
+#define REC_COMMIT          (1u << 31)      ///< 记录头：写入完成（不输出）
+
+#define STR_ADDR            0xFF            ///< %s 参数：后跟 u32 地址
+#define STR_NULL            0xFE            ///< %s 参数：NULL
+
+#define RATE_SLOTS          16              ///< 限速表条目数，用完后新标签共用最后一条
+#define RATE_WINDOW_MS      1000            ///< 限速窗口
+
+/**
+ * @brief 标签限速条目（固定窗口计数，多任务并发时为近似值）
+ */
+typedef struct {
+    const char *tag;                        ///< 标签指针，NULL 表示空闲
+    uint32_t window_start;                  ///< 当前窗口起点(ms)
+    uint32_t count;                         ///< 当前窗口内的记录数
+} rate_slot_t;
+
+/**
+ * @brief 组件运行上下文
+ *
+ * head 与 tail 为累计字节数，取模得缓冲区内位置。生产者以 CAS 推进 head 预留整条记录，
+ * 写完数据后最后写记录头并置 REC_COMMIT；唯一的消费者遇到未提交的记录即停止，
+ * 消费后把整段清零再推进 tail，后续记录头所在位置保证为0。
+ */
+typedef struct {
+    bool initialized;                       ///< 是否已初始化
+    xn_logstream_config_t config;           ///< 配置
+    uint8_t *ring;                          ///< 环形缓冲（4 字节对齐）
+    uint32_t mask;                          ///< ring_size - 1
+    uint32_t head;                          ///< 已预留的累计字节数（生产者）
+    uint32_t tail;                          ///< 已消费的累计字节数（消费者）
+    uint32_t seq;                           ///< 下一个批次序号
+    vprintf_like_t uart_vprintf;            ///< 原日志输出函数
+    rate_slot_t rate[RATE_SLOTS];           ///< 标签限速表
+    xn_logstream_stats_t stats;             ///< 统计（used 读取时计算）
+} logstream_ctx_t;
+
+static logstream_ctx_t s_ctx = {0};
+
+/**
+ * @brief 编码缓冲区
+ */
+typedef struct {
+    uint8_t *p;                             ///< 写入位置
+    uint8_t *end;                           ///< 缓冲区末尾
+    bool truncated;                         ///< 是否有参数放不下
+} enc_t;
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 写入定长参数，放不下时标记截断并停止后续写入
+ */
+static void enc_put(enc_t *e, const void *data, size_t len)
+{
+    if (e->truncated || (size_t)(e->end - e->p) < len) {
+        e->truncated = true;
+        return;
+    }
+    memcpy(e->p, data, len);
+    e->p += len;
+}
+
+static void enc_u32(enc_t *e, uint32_t v)
+{
+    enc_put(e, &v, sizeof(v));
+}
+
+/**
+ * @brief 写入字符串：flash 中的常量只记地址，其余内联
+ * @param max 内联的最大字节数（不超过 0xFD）
+ */
+static void enc_str(enc_t *e, const char *s, size_t max)
+{
+    uint8_t mark;
+    if (s == NULL) {
+        mark = STR_NULL;
+        enc_put(e, &mark, 1);
+        return;
+    }
+    if (esp_ptr_in_drom(s)) {
+        mark = STR_ADDR;
+        enc_put(e, &mark, 1);
+        enc_u32(e, (uint32_t)(uintptr_t)s);
+        return;
+    }
+
+    size_t n = strnlen(s, max);
+    mark = (uint8_t)n;
+    enc_put(e, &mark, 1);
+    enc_put(e, s, n);
+}
+
+/**
+ * @brief 按格式串逐个编码参数
+ *
+ * 只识别 printf 的转换规则，不做格式化：标志、宽度与精度原样留在格式串中，
+ * '*' 对应的 int 参数与其他整数一样编码。
+ *
+ * @return const char* 第一个 %s 参数（esp_log 格式串中为标签），没有时为 NULL
+ */
+static const char *enc_args(enc_t *e, const char *fmt, va_list args)
+{
+    const char *first_str = NULL;
+    bool have_str = false;
+
+    for (const char *f = fmt; *f != '\0'; f++) {
+        if (*f != '%') {
+            continue;
+        }
+        f++;
+        if (*f == '%') {
+            continue;
+        }
+        // 标志、宽度、精度
+        while (*f != '\0' && strchr("-+ #0123456789.*", *f) != NULL) {
+            if (*f == '*') {
+                enc_u32(e, (uint32_t)va_arg(args, int));
+            }
+            f++;
+        }
+        // 长度修饰
+        int longs = 0;
+        while (*f != '\0' && strchr("hlLqjzt", *f) != NULL) {
+            if (*f == 'l' || *f == 'q' || *f == 'j') {
+                longs++;
+            }
+            if (*f == 'q' || *f == 'j') {
+                longs = 2;
+            }
+            f++;
+        }
+
+        switch (*f) {
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+            if (longs >= 2) {
+                uint64_t v = va_arg(args, unsigned long long);
+                enc_put(e, &v, sizeof(v));
+            } else if (longs == 1) {
+                enc_u32(e, (uint32_t)va_arg(args, unsigned long));
+            } else {
+                enc_u32(e, (uint32_t)va_arg(args, unsigned int));
+            }
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+            double v = va_arg(args, double);
+            enc_put(e, &v, sizeof(v));
+            break;
+        }
+        case 's': {
+            const char *s = va_arg(args, const char *);
+            if (!have_str) {
+                have_str = true;
+                first_str = s;
+            }
+            enc_str(e, s, s_ctx.config.max_str);
+            break;
+        }
+        case 'p':
+            enc_u32(e, (uint32_t)(uintptr_t)va_arg(args, void *));
+            break;
+        case 'n':
+            (void)va_arg(args, void *);
+            break;
+        default:
+            // 无法识别的转换：后续参数位置无法确定，截断
+            e->truncated = true;
+            return first_str;
+        }
+    }
+    return first_str;
+}
+
+/**
+ * @brief 从 esp_log 格式串前缀取级别（跳过颜色转义，首字母为 E/W/I/D/V）
+ */
+static esp_log_level_t level_of(const char *fmt)
+{
+    if (fmt[0] == '\033') {
+        const char *m = strchr(fmt, 'm');
+        fmt = (m != NULL) ? m + 1 : fmt;
+    }
+    switch (fmt[0]) {
+    case 'E': return ESP_LOG_ERROR;
+    case 'W': return ESP_LOG_WARN;
+    case 'I': return ESP_LOG_INFO;
+    case 'D': return ESP_LOG_DEBUG;
+    case 'V': return ESP_LOG_VERBOSE;
+    default:  return ESP_LOG_NONE;  // 不是 esp_log 格式（如直接调用 esp_log_write 的原始输出），总是打印
+    }
+}
+
+/**
+ * @brief 标签限速：同一标签每个窗口最多 tag_rate 条
+ * @return bool 本条可以写入
+ */
+static bool rate_allow(const char *tag)
+{
+    if (s_ctx.config.tag_rate == 0) {
+        return true;
+    }
+
+    uint32_t h = ((uint32_t)(uintptr_t)tag >> 2) % RATE_SLOTS;
+    rate_slot_t *slot = &s_ctx.rate[RATE_SLOTS - 1];
+    for (int i = 0; tag != NULL && i < RATE_SLOTS; i++) {
+        rate_slot_t *s = &s_ctx.rate[(h + i) % RATE_SLOTS];
+        const char *cur = __atomic_load_n(&s->tag, __ATOMIC_ACQUIRE);
+        if (cur == NULL) {
+            const char *expected = NULL;
+            if (__atomic_compare_exchange_n(&s->tag, &expected, tag, false,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) || expected == tag) {
+                slot = s;
+                break;
+            }
+            cur = expected;
+        }
+        if (cur == tag) {
+            slot = s;
+            break;
+        }
+    }
+
+    uint32_t now = (uint32_t)(esp_timer_get_time() / 1000);
+    if (now - __atomic_load_n(&slot->window_start, __ATOMIC_RELAXED) >= RATE_WINDOW_MS) {
+        __atomic_store_n(&slot->window_start, now, __ATOMIC_RELAXED);
+        __atomic_store_n(&slot->count, 0, __ATOMIC_RELAXED);
+    }
+    return __atomic_add_fetch(&slot->count, 1, __ATOMIC_RELAXED) <= s_ctx.config.tag_rate;
+}
+
+/**
+ * @brief 预留 len 字节（4 的倍数）的连续空间，缓冲区末尾不够时先写入填充记录
+ * @return uint32_t* 记录头位置，缓冲区满时返回 NULL
+ */
+static uint32_t *ring_reserve(uint32_t len)
+{
+    const uint32_t size = s_ctx.mask + 1;
+    uint32_t head = __atomic_load_n(&s_ctx.head, __ATOMIC_RELAXED);
+    uint32_t pad;
+
+    do {
+        uint32_t tail = __atomic_load_n(&s_ctx.tail, __ATOMIC_ACQUIRE);
+        uint32_t room = size - (head & s_ctx.mask);
+        pad = (room < len) ? room : 0;
+        if (head + pad + len - tail > size) {
+            return NULL;
+        }
+    } while (!__atomic_compare_exchange_n(&s_ctx.head, &head, head + pad + len, true,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    if (pad > 0) {
+        __atomic_store_n((uint32_t *)(s_ctx.ring + (head & s_ctx.mask)), pad | REC_PAD | REC_COMMIT, __ATOMIC_RELEASE);
+        head += pad;
+    }
+
+    uint32_t used = head + len - __atomic_load_n(&s_ctx.tail, __ATOMIC_RELAXED);
+    if (used > s_ctx.stats.high_water) {
+        s_ctx.stats.high_water = used;
+    }
+    return (uint32_t *)(s_ctx.ring + (head & s_ctx.mask));
+}
+
+/**
+ * @brief esp_log 输出函数：编码写入环形缓冲，按级别转发到原输出函数
+ */
+static int logstream_vprintf(const char *fmt, va_list args)
+{
+    int ret = 0;
+    if (s_ctx.uart_vprintf != NULL && s_ctx.config.uart_level != ESP_LOG_NONE &&
+        level_of(fmt) <= s_ctx.config.uart_level) {
+        va_list copy;
+        va_copy(copy, args);
+        ret = s_ctx.uart_vprintf(fmt, copy);
+        va_end(copy);
+    }
+
+    uint8_t rec[XN_LOGSTREAM_RECORD_MAX];
+    enc_t e = {
+        .p = rec + sizeof(uint32_t),
+        .end = rec + sizeof(rec),
+    };
+    uint32_t flags = 0;
+    if (esp_ptr_in_drom(fmt)) {
+        enc_u32(&e, (uint32_t)(uintptr_t)fmt);
+    } else {
+        flags |= REC_FMT_INLINE;
+        enc_str(&e, fmt, STR_NULL - 1);
+    }
+
+    va_list copy;
+    va_copy(copy, args);
+    const char *tag = enc_args(&e, fmt, copy);
+    va_end(copy);
+
+    if (!rate_allow(tag)) {
+        __atomic_add_fetch(&s_ctx.stats.suppressed, 1, __ATOMIC_RELAXED);
+        return ret;
+    }
+    if (e.truncated) {
+        flags |= REC_TRUNCATED;
+        __atomic_add_fetch(&s_ctx.stats.truncated, 1, __ATOMIC_RELAXED);
+    }
+
+    uint32_t len = ((uint32_t)(e.p - rec) + 3) & ~3u;
+    uint32_t *slot = ring_reserve(len);
+    if (slot == NULL) {
+        __atomic_add_fetch(&s_ctx.stats.dropped, 1, __ATOMIC_RELAXED);
+        return ret;
+    }
+    memcpy((uint8_t *)slot + sizeof(uint32_t), rec + sizeof(uint32_t), len - sizeof(uint32_t));
+    __atomic_store_n(slot, len | flags | REC_COMMIT, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&s_ctx.stats.records, 1, __ATOMIC_RELAXED);
+    return ret;
+}
+
+/**
+ * @brief 取出最早一条已提交的记录（消费者）
+ *
+ * @param[out] hdr 记录头
+ * @return uint8_t* 记录位置，没有已提交的记录时返回 NULL
+ */
+static uint8_t *ring_peek(uint32_t *hdr)
+{
+    uint32_t tail = s_ctx.tail;
+    if (tail == __atomic_load_n(&s_ctx.head, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+    uint8_t *p = s_ctx.ring + (tail & s_ctx.mask);
+    *hdr = __atomic_load_n((uint32_t *)p, __ATOMIC_ACQUIRE);
+    return (*hdr & REC_COMMIT) ? p : NULL;
+}
+
+/**
+ * @brief 释放最早一条记录：清零后推进 tail
+ */
+static void ring_pop(uint8_t *p, uint32_t hdr)
+{
+    uint32_t len = hdr & REC_LEN_MASK;
+    memset(p, 0, len);
+    __atomic_store_n(&s_ctx.tail, s_ctx.tail + len, __ATOMIC_RELEASE);
+}
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+xn_logstream_config_t xn_logstream_get_default_config(void)
+{
+    xn_logstream_config_t config = {
+        .ring_size = 8192,
+        .tag_rate = 20,
+        .max_str = 48,
+        .uart_level = ESP_LOG_VERBOSE,
+    };
+    return config;
+}
+
+esp_err_t xn_logstream_init(const xn_logstream_config_t *config)
+{
+    if (s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (config == NULL || config->ring_size < 1024 || config->ring_size > 0x10000 ||
+        (config->ring_size & (config->ring_size - 1)) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_ctx.ring = calloc(1, config->ring_size);
+    if (s_ctx.ring == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_ctx.config = *config;
+    if (s_ctx.config.max_str > XN_LOGSTREAM_RECORD_MAX / 2) {
+        s_ctx.config.max_str = XN_LOGSTREAM_RECORD_MAX / 2;
+    }
+    s_ctx.mask = (uint32_t)config->ring_size - 1;
+    s_ctx.initialized = true;
+
+    // 返回值为原输出函数，之后的日志都经过本组件
+    s_ctx.uart_vprintf = esp_log_set_vprintf(logstream_vprintf);
+    return ESP_OK;
+}
+
+size_t xn_logstream_read_batch(uint8_t *buf, size_t len)
+{
+    if (!s_ctx.initialized || buf == NULL ||
+        len < sizeof(xn_logstream_batch_header_t) + XN_LOGSTREAM_RECORD_MAX) {
+        return 0;
+    }
+    if (len > 0xFFFF) {
+        len = 0xFFFF;
+    }
+
+    size_t off = sizeof(xn_logstream_batch_header_t);
+    uint16_t count = 0;
+    uint32_t hdr;
+    uint8_t *p;
+    while ((p = ring_peek(&hdr)) != NULL) {
+        uint32_t rec_len = hdr & REC_LEN_MASK;
+        if (!(hdr & REC_PAD)) {
+            if (off + rec_len > len) {
+                break;
+            }
+            uint32_t out_hdr = hdr & ~REC_COMMIT;
+            memcpy(buf + off, &out_hdr, sizeof(out_hdr));
+            memcpy(buf + off + sizeof(out_hdr), p + sizeof(out_hdr), rec_len - sizeof(out_hdr));
+            off += rec_len;
+            count++;
+        }
+        ring_pop(p, hdr);
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    xn_logstream_batch_header_t bh = {
+        .magic = XN_LOGSTREAM_BATCH_MAGIC,
+        .version = XN_LOGSTREAM_VERSION,
+        .count = count,
+        .length = (uint16_t)off,
+        .seq = s_ctx.seq++,
+        .dropped = __atomic_load_n(&s_ctx.stats.dropped, __ATOMIC_RELAXED),
+        .suppressed = __atomic_load_n(&s_ctx.stats.suppressed, __ATOMIC_RELAXED),
+    };
+    memcpy(buf, &bh, sizeof(bh));
+    return off;
+}
+
+void xn_logstream_trim(size_t keep)
+{
+    if (!s_ctx.initialized) {
+        return;
+    }
+
+    uint32_t hdr;
+    uint8_t *p;
+    while (__atomic_load_n(&s_ctx.head, __ATOMIC_ACQUIRE) - s_ctx.tail > keep &&
+           (p = ring_peek(&hdr)) != NULL) {
+        ring_pop(p, hdr);
+    }
+}
+
+esp_err_t xn_logstream_get_stats(xn_logstream_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    *stats = s_ctx.stats;
+    stats->used = __atomic_load_n(&s_ctx.head, __ATOMIC_ACQUIRE) - __atomic_load_n(&s_ctx.tail, __ATOMIC_ACQUIRE);
+    return ESP_OK;
+}
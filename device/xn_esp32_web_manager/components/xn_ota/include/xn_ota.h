@@ -24,6 +24,9 @@ extern "C" {
 #define XN_OTA_MAX_VERSION_LEN      32      ///< 版本号最大长度
 #define XN_OTA_MAX_URL_LEN          256     ///< URL 最大长度
 #define XN_OTA_MAX_VERSIONS         10      ///< 最大版本列表数量
+#define XN_OTA_RESUME_CHECKPOINT    (64 * 1024) ///< 断点写入 NVS 的间隔（字节，Flash 扇区大小的整数倍）
+#define XN_OTA_HTTP_POOL_SIZE       2       ///< 保持连接的云端 HTTP 客户端数量（按主机区分）
+#define XN_OTA_HTTP_IDLE_TIMEOUT_MS 30000   ///< 空闲超过该时间的连接不再复用（毫秒）
 
 /* ========================================================================== */
 /*                              类型定义                                        */
@@ -37,8 +40,14 @@ typedef struct {
     char url[XN_OTA_MAX_URL_LEN];           ///< 固件下载地址
     uint32_t size;                          ///< 固件大小（字节）
     char md5[33];                           ///< MD5 校验值
+    char sha256[65];                        ///< SHA-256 校验值（十六进制，空表示未提供）
     bool force;                             ///< 是否强制升级
     char changelog[256];                    ///< 更新日志
+    char patch_url[XN_OTA_MAX_URL_LEN];     ///< 差分补丁下载地址（空表示无补丁）
+    char base_version[XN_OTA_MAX_VERSION_LEN]; ///< 补丁对应的基准版本
+    uint32_t patch_size;                    ///< 补丁大小（字节）
+    uint8_t rollout;                        ///< 灰度发布比例 (0-100)，按设备 ID 分桶
+    char min_version[XN_OTA_MAX_VERSION_LEN]; ///< 允许升级的最低当前版本（空表示不限）
 } xn_ota_version_info_t;
 
 /**
@@ -77,7 +86,7 @@ typedef struct {
  * @brief OTA 升级进度回调函数类型
  * 
  * @param progress 进度百分比 (0-100)
- * @param speed 当前下载速度 (字节/秒)
+ * @param speed 最近一个统计周期的平均下载速度 (字节/秒)
  */
 typedef void (*xn_ota_progress_cb_t)(int progress, size_t speed);
 
@@ -89,6 +98,10 @@ typedef struct {
     const char *device_type;                ///< 设备类型
     xn_ota_progress_cb_t progress_cb;       ///< 升级进度回调
     uint32_t timeout_ms;                    ///< 超时时间（毫秒）
+    uint32_t rx_buffer_size;                ///< 固件下载 HTTP 接收缓冲大小（字节，按16字节对齐）
+    uint8_t max_retries;                    ///< 下载中断后的最大续传次数（服务器不支持 Range 时为从头重下次数）
+    uint32_t retry_delay_ms;                ///< 续传前的等待时间（毫秒，随重试次数线性增加）
+    uint32_t check_jitter_ms;               ///< 检查更新前的随机等待上限（毫秒，0 不等待），错开设备集中请求
 } xn_ota_config_t;
 
 /**
@@ -100,6 +113,10 @@ typedef struct {
         .device_type = "unknown", \
         .progress_cb = NULL, \
         .timeout_ms = 30000, \
+        .rx_buffer_size = 4096, \
+        .max_retries = 5, \
+        .retry_delay_ms = 2000, \
+        .check_jitter_ms = 0, \
     }
 
 /* ========================================================================== */
@@ -146,6 +163,9 @@ esp_err_t xn_ota_get_cloud_versions(xn_ota_version_list_t *version_list);
 /**
  * @brief 检查是否有新版本
  * 
+ * 从云端版本列表中选出本设备可升级的最高版本：当前版本不低于 min_version，
+ * 且设备 ID 分桶落在 rollout 比例内。配置了 check_jitter_ms 时先随机等待再请求。
+ * 
  * @param[out] has_update 是否有更新
  * @param[out] latest_version 最新版本信息（可选，传 NULL 忽略）
  * @return esp_err_t 
@@ -157,15 +177,51 @@ esp_err_t xn_ota_check_update(bool *has_update, xn_ota_version_info_t *latest_ve
 /**
  * @brief 升级到指定版本
  * 
- * @param version 目标版本号，NULL 表示升级到最新版本
+ * 固件按 rx_buffer_size 分块下载并直接写入 OTA 分区，每写入 XN_OTA_RESUME_CHECKPOINT
+ * 字节把断点保存到 NVS。下载中断时用 HTTP Range 请求从断点续传（同一连接复用
+ * TLS 会话），重启后再次升级同一版本时擦除断点之后的区域再从断点继续。服务器不支持 Range 时从头下载。
+ * 
+ * 云端提供 patch_url 且 base_version 与当前固件一致时，先下载差分补丁并基于运行分区
+ * 生成新固件，生成的镜像同样与 sha256/md5 比对；补丁不匹配或应用失败时自动回退到完整固件下载。
+ * 
+ * 完整固件下载时边写入边计算 SHA-256/MD5（中间状态随断点保存），下载完成后与云端
+ * 下发的摘要比对；数据超出声明的 size 时立即中止。
+ * 
+ * @param version 目标版本号，NULL 表示升级到本设备可升级的最新版本（规则同 xn_ota_check_update）
  * @return esp_err_t 
  *      - ESP_OK: 升级成功
  *      - ESP_FAIL: 升级失败
  *      - ESP_ERR_NOT_FOUND: 版本不存在
- *      - ESP_ERR_INVALID_CRC: 校验失败
+ *      - ESP_ERR_INVALID_CRC: 摘要或镜像校验失败
+ *      - ESP_ERR_INVALID_SIZE: 固件大小与声明不符
+ *      - ESP_ERR_TIMEOUT: 续传次数用完仍未下载完成（断点保留，下次继续）
+ *      - ESP_ERR_NOT_SUPPORTED: 服务器不支持 Range，从头重新下载的次数用完
  */
 esp_err_t xn_ota_upgrade(const char *version);
 
+/**
+ * @brief 升级到调用者给出的版本
+ * 
+ * 流程与 xn_ota_upgrade 相同，只使用 target_version 中的信息，不读取内部版本列表。
+ * 调用者在其他任务里可能再次检查更新时，应传入自己持有的副本，下载期间保持不变。
+ * 
+ * @param target_version 目标版本信息（通常来自 xn_ota_check_update 的 latest_version）
+ * @return esp_err_t 同 xn_ota_upgrade；target_version 为 NULL 时返回 ESP_ERR_INVALID_ARG
+ */
+esp_err_t xn_ota_upgrade_to(const xn_ota_version_info_t *target_version);
+
+/**
+ * @brief 设置固件下载限速
+ * 
+ * 对完整固件和差分补丁下载都生效，可在升级过程中随时修改。
+ * 后台升级时用于给业务流量让出带宽。
+ * 
+ * @param bytes_per_sec 每秒最多下载的字节数，0 表示不限速
+ * @return esp_err_t 
+ *      - ESP_OK: 成功
+ */
+esp_err_t xn_ota_set_rate_limit(uint32_t bytes_per_sec);
+
 /**
  * @brief 标记当前固件为有效
  * 
@@ -7,24 +7,42 @@
  */
 
 #include "xn_ota.h"
+#include "xn_ota_delta.h"
+#include "xn_ota_json.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "esp_log.h"
 #include "esp_http_client.h"
-#include "esp_https_ota.h"
 #include "esp_ota_ops.h"
 #include "esp_app_format.h"
 #include "esp_mac.h"
 #include "esp_system.h"
 #include "esp_chip_info.h"
 #include "esp_timer.h"
+#include "esp_random.h"
 #include "cJSON.h"
 #include "nvs_flash.h"
 #include "nvs.h"
+#include "xn_storage.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/md5.h"
 
 /* 日志TAG */
 static const char *TAG = "xn_ota";
 
+/* 断点续传记录（xn_storage 记录，整体读写） */
+#define RESUME_RECORD_KEY       "ota_resume"
+#define RESUME_RECORD_VERSION   1
+
+/* 旧版本按字段保存在 NVS 命名空间 "ota" 中的断点续传键，初始化时删除 */
+static const char *const s_legacy_resume_keys[] = {
+    "dl_ver", "dl_part", "dl_off", "dl_sha", "dl_md5",
+};
+
 /* ========================================================================== */
 /*                              内部变量                                        */
 /* ========================================================================== */
@@ -36,6 +54,32 @@ static xn_ota_device_info_t s_device_info;          // 设备信息
 static char s_activation_code[64] = {0};            // 激活码
 static char s_activation_message[256] = {0};        // 激活消息
 static char s_activation_challenge[256] = {0};      // 激活挑战码
+static volatile uint32_t s_rate_limit = 0;          // 固件下载限速(B/s)，0 不限速
+
+/* 云端请求连接池：同一主机的请求复用 TCP/TLS 连接 */
+typedef struct {
+    char host[96];                              // scheme://host[:port]
+    esp_http_client_handle_t client;            // 保持连接的客户端
+    int64_t last_used;                          // 上次使用时间(us)
+    bool busy;                                  // 是否正在使用
+} http_pool_entry_t;
+
+static http_pool_entry_t s_http_pool[XN_OTA_HTTP_POOL_SIZE];   // 连接池
+static SemaphoreHandle_t s_http_pool_lock = NULL;               // 连接池保护锁
+
+/**
+ * @brief 云端响应数据接收函数
+ * 
+ * 响应体按 HTTP 接收缓冲的大小分段送入，不在内存中拼接完整响应。
+ * data 为 NULL 表示请求换连接重发，之前送入的数据作废。
+ */
+typedef esp_err_t (*http_sink_t)(const char *data, size_t len, void *ctx);
+
+/* 云端响应接收者（由 HTTP 事件回调使用） */
+typedef struct {
+    http_sink_t sink;                           // 数据接收函数
+    void *ctx;                                  // 接收函数上下文
+} http_response_t;
 
 /* ========================================================================== */
 /*                              内部函数                                        */
@@ -114,115 +158,1086 @@ static int compare_version(const char *v1, const char *v2)
     if (minor1 != minor2) return (minor1 > minor2) ? 1 : -1;
     if (patch1 != patch2) return (patch1 > patch2) ? 1 : -1;
     
-    return 0;
+    return 0;
+}
+
+/**
+ * @brief 计算设备在某个版本灰度中的分桶 (0-99)
+ * 
+ * 设备 ID 与版本号一起哈希（FNV-1a）：同一版本扩大比例时已升级的设备保持在内，
+ * 不同版本的首批设备互不相同。
+ */
+static uint8_t rollout_bucket(const char *version)
+{
+    uint32_t hash = 2166136261u;
+    for (const char *p = s_device_info.device_id; *p != '\0'; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    hash = (hash ^ '/') * 16777619u;
+    for (const char *p = version; *p != '\0'; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    return hash % 100;
+}
+
+/**
+ * @brief 本设备是否可以升级到该版本
+ */
+static bool version_eligible(const xn_ota_version_info_t *ver)
+{
+    if (ver->min_version[0] != '\0' &&
+        compare_version(s_device_info.firmware_version, ver->min_version) < 0) {
+        return false;
+    }
+    if (ver->rollout < 100 && rollout_bucket(ver->version) >= ver->rollout) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 从版本列表中选出本设备应升级的版本
+ * 
+ * @return xn_ota_version_info_t* 可升级的最高版本（高于当前版本或强制升级），没有则 NULL
+ */
+static xn_ota_version_info_t *select_update(xn_ota_version_list_t *list)
+{
+    xn_ota_version_info_t *best = NULL;
+    for (int i = 0; i < list->count; i++) {
+        xn_ota_version_info_t *ver = &list->versions[i];
+        if (ver->version[0] == '\0' || ver->url[0] == '\0' || !version_eligible(ver)) {
+            continue;
+        }
+        if (compare_version(ver->version, s_device_info.firmware_version) <= 0 && !ver->force) {
+            continue;
+        }
+        if (best == NULL || compare_version(ver->version, best->version) > 0) {
+            best = ver;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief HTTP 事件处理回调
+ */
+static esp_err_t http_event_handler(esp_http_client_event_t *evt)
+{
+    switch (evt->event_id) {
+        case HTTP_EVENT_ERROR:
+            ESP_LOGE(TAG, "HTTP_EVENT_ERROR");
+            break;
+        case HTTP_EVENT_ON_CONNECTED:
+            ESP_LOGD(TAG, "HTTP_EVENT_ON_CONNECTED");
+            break;
+        case HTTP_EVENT_HEADER_SENT:
+            ESP_LOGD(TAG, "HTTP_EVENT_HEADER_SENT");
+            break;
+        case HTTP_EVENT_ON_HEADER:
+            ESP_LOGD(TAG, "HTTP_EVENT_ON_HEADER, key=%s, value=%s", 
+                     evt->header_key, evt->header_value);
+            break;
+        case HTTP_EVENT_ON_DATA: {
+            ESP_LOGD(TAG, "HTTP_EVENT_ON_DATA, len=%d", evt->data_len);
+            // 响应体直接交给请求方的接收函数流式处理
+            http_response_t *resp = (http_response_t *)evt->user_data;
+            if (resp == NULL || resp->sink == NULL || evt->data_len <= 0) {
+                break;
+            }
+            return resp->sink((const char *)evt->data, evt->data_len, resp->ctx);
+        }
+        case HTTP_EVENT_ON_FINISH:
+            ESP_LOGD(TAG, "HTTP_EVENT_ON_FINISH");
+            break;
+        case HTTP_EVENT_DISCONNECTED:
+            ESP_LOGD(TAG, "HTTP_EVENT_DISCONNECTED");
+            break;
+        default:
+            break;
+    }
+    return ESP_OK;
+}
+
+/* ========================================================================== */
+/*                              云端请求连接池                                   */
+/* ========================================================================== */
+
+/**
+ * @brief 取 URL 的 scheme://host[:port] 部分作为连接池键
+ */
+static void url_to_host(const char *url, char *host, size_t len)
+{
+    const char *p = strstr(url, "://");
+    p = (p != NULL) ? p + 3 : url;
+    const char *end = strchr(p, '/');
+    size_t n = (end != NULL) ? (size_t)(end - url) : strlen(url);
+    if (n >= len) {
+        n = len - 1;
+    }
+    memcpy(host, url, n);
+    host[n] = '\0';
+}
+
+/**
+ * @brief 关闭并释放连接池条目
+ */
+static void http_pool_drop(http_pool_entry_t *entry)
+{
+    if (entry->client != NULL) {
+        esp_http_client_cleanup(entry->client);
+    }
+    entry->client = NULL;
+    entry->host[0] = '\0';
+    entry->busy = false;
+}
+
+/**
+ * @brief 取一个可用于 url 的客户端
+ * 
+ * 优先复用同一主机的空闲连接；没有时占用空槽位或淘汰最久未用的空闲连接。
+ * 
+ * @param url 请求地址
+ * @param[out] reused 是否复用了已有连接
+ * @return http_pool_entry_t* 条目，池已满且全部在用时返回 NULL
+ */
+static http_pool_entry_t *http_pool_acquire(const char *url, bool *reused)
+{
+    char host[sizeof(s_http_pool[0].host)];
+    url_to_host(url, host, sizeof(host));
+    int64_t now = esp_timer_get_time();
+    
+    xSemaphoreTake(s_http_pool_lock, portMAX_DELAY);
+    http_pool_entry_t *entry = NULL;
+    http_pool_entry_t *victim = NULL;
+    for (int i = 0; i < XN_OTA_HTTP_POOL_SIZE; i++) {
+        http_pool_entry_t *e = &s_http_pool[i];
+        if (e->busy) {
+            continue;
+        }
+        // 服务端多半已关闭空闲太久的连接，直接丢弃
+        if (e->client != NULL && now - e->last_used > (int64_t)XN_OTA_HTTP_IDLE_TIMEOUT_MS * 1000) {
+            http_pool_drop(e);
+        }
+        if (e->client != NULL && strcmp(e->host, host) == 0) {
+            entry = e;
+            break;
+        }
+        if (victim == NULL || (victim->client != NULL && 
+            (e->client == NULL || e->last_used < victim->last_used))) {
+            victim = e;
+        }
+    }
+    
+    *reused = (entry != NULL);
+    if (entry == NULL && victim != NULL) {
+        http_pool_drop(victim);
+        entry = victim;
+    }
+    if (entry != NULL) {
+        entry->busy = true;
+    }
+    xSemaphoreGive(s_http_pool_lock);
+    
+    if (entry == NULL) {
+        ESP_LOGE(TAG, "HTTP pool exhausted");
+        return NULL;
+    }
+    
+    if (*reused) {
+        esp_http_client_set_url(entry->client, url);
+        return entry;
+    }
+    
+    esp_http_client_config_t http_config = {
+        .url = url,
+        .event_handler = http_event_handler,
+        .timeout_ms = s_config.timeout_ms,
+        .keep_alive_enable = true,
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+        .save_client_session = true,
+#endif
+    };
+    entry->client = esp_http_client_init(&http_config);
+    if (entry->client == NULL) {
+        ESP_LOGE(TAG, "Failed to init HTTP client");
+        xSemaphoreTake(s_http_pool_lock, portMAX_DELAY);
+        entry->busy = false;
+        xSemaphoreGive(s_http_pool_lock);
+        return NULL;
+    }
+    strcpy(entry->host, host);
+    return entry;
+}
+
+/**
+ * @brief 归还客户端；请求出错时连接状态未知，直接关闭
+ */
+static void http_pool_release(http_pool_entry_t *entry, bool keep)
+{
+    xSemaphoreTake(s_http_pool_lock, portMAX_DELAY);
+    if (keep) {
+        esp_http_client_set_user_data(entry->client, NULL);
+        entry->last_used = esp_timer_get_time();
+        entry->busy = false;
+    } else {
+        http_pool_drop(entry);
+    }
+    xSemaphoreGive(s_http_pool_lock);
+}
+
+/**
+ * @brief 关闭连接池中的所有连接
+ */
+static void http_pool_close_all(void)
+{
+    xSemaphoreTake(s_http_pool_lock, portMAX_DELAY);
+    for (int i = 0; i < XN_OTA_HTTP_POOL_SIZE; i++) {
+        if (!s_http_pool[i].busy) {
+            http_pool_drop(&s_http_pool[i]);
+        }
+    }
+    xSemaphoreGive(s_http_pool_lock);
+}
+
+/**
+ * @brief 通过连接池发送 JSON POST 请求
+ * 
+ * 复用的连接可能已被服务端关闭，此时换新连接重试一次。
+ * 
+ * @param url 请求地址
+ * @param body 请求体（JSON）
+ * @param[out] status_code HTTP 状态码
+ * @param sink 响应体接收函数（可选，传 NULL 丢弃响应体）
+ * @param ctx 接收函数上下文
+ * @return esp_err_t 
+ *      - ESP_OK: 请求完成（状态码由调用者判断）
+ *      - 其他: 网络错误或接收函数返回的错误
+ */
+static esp_err_t http_post_json(const char *url, const char *body, int *status_code,
+                                http_sink_t sink, void *ctx)
+{
+    esp_err_t err = ESP_FAIL;
+    http_response_t resp = {
+        .sink = sink,
+        .ctx = ctx,
+    };
+    
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool reused = false;
+        http_pool_entry_t *entry = http_pool_acquire(url, &reused);
+        if (entry == NULL) {
+            return ESP_FAIL;
+        }
+        if (attempt > 0 && sink != NULL) {
+            sink(NULL, 0, ctx);
+        }
+        
+        esp_http_client_handle_t client = entry->client;
+        esp_http_client_set_user_data(client, &resp);
+        esp_http_client_set_header(client, "Device-Id", s_device_info.device_id);
+        esp_http_client_set_header(client, "Content-Type", "application/json");
+        esp_http_client_set_method(client, HTTP_METHOD_POST);
+        esp_http_client_set_post_field(client, body, strlen(body));
+        
+        err = esp_http_client_perform(client);
+        if (err == ESP_OK) {
+            *status_code = esp_http_client_get_status_code(client);
+        }
+        http_pool_release(entry, err == ESP_OK);
+        
+        if (err == ESP_OK || !reused) {
+            break;
+        }
+        ESP_LOGW(TAG, "Pooled connection failed (%s), reconnecting", esp_err_to_name(err));
+    }
+    
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+/* ========================================================================== */
+/*                              固件下载                                        */
+/* ========================================================================== */
+
+/**
+ * @brief 固件摘要（边下载边计算）
+ */
+typedef struct {
+    mbedtls_sha256_context sha256;          ///< SHA-256 状态
+    mbedtls_md5_context md5;                ///< MD5 状态（兼容旧服务端）
+} ota_digest_t;
+
+/**
+ * @brief 断点续传记录
+ * 
+ * 摘要上下文按原样保存，mbedtls 升级导致结构大小变化时记录长度不符，从头下载。
+ */
+typedef struct {
+    char version[XN_OTA_MAX_VERSION_LEN];   ///< 正在下载的版本号
+    uint32_t part_addr;                     ///< 写入的分区地址
+    uint32_t offset;                        ///< 已写入的字节数
+    ota_digest_t digest;                    ///< 已写入部分的摘要中间状态
+} ota_resume_t;
+
+/**
+ * @brief 固件下载上下文
+ */
+typedef struct {
+    const char *version;                    ///< 目标版本号
+    const esp_partition_t *part;            ///< 目标分区
+    esp_ota_handle_t ota_handle;            ///< OTA 写入句柄
+    uint32_t offset;                        ///< 已写入分区的字节数
+    uint32_t image_size;                    ///< 固件总大小（0 表示未知）
+    uint32_t checkpoint;                    ///< 上次保存断点时的偏移
+    char *buf;                              ///< 接收缓冲
+    size_t buf_size;                        ///< 接收缓冲大小
+    int64_t speed_time;                     ///< 上次统计速度的时刻(us)
+    uint32_t speed_offset;                  ///< 上次统计速度时的偏移
+    ota_digest_t digest;                    ///< 已写入部分的摘要
+} ota_download_t;
+
+/**
+ * @brief 从头开始计算摘要
+ */
+static void digest_reset(ota_digest_t *digest)
+{
+    mbedtls_sha256_init(&digest->sha256);
+    mbedtls_sha256_starts(&digest->sha256, 0);
+    mbedtls_md5_init(&digest->md5);
+    mbedtls_md5_starts(&digest->md5);
+}
+
+/**
+ * @brief 释放摘要状态
+ */
+static void digest_free(ota_digest_t *digest)
+{
+    mbedtls_sha256_free(&digest->sha256);
+    mbedtls_md5_free(&digest->md5);
+}
+
+/**
+ * @brief 摘要输出为小写十六进制字符串
+ */
+static void digest_to_hex(const uint8_t *bin, size_t len, char *hex)
+{
+    for (size_t i = 0; i < len; i++) {
+        sprintf(hex + i * 2, "%02x", bin[i]);
+    }
+}
+
+/**
+ * @brief 结束计算并与云端下发的摘要比对
+ * 
+ * 云端未下发的摘要不比对；sha256 与 md5 都下发时两者都必须一致。
+ * 
+ * @return esp_err_t ESP_OK 一致，ESP_ERR_INVALID_CRC 不一致
+ */
+static esp_err_t digest_verify(ota_digest_t *digest, const xn_ota_version_info_t *target)
+{
+    uint8_t sha[32];
+    uint8_t md5[16];
+    char hex[65];
+    esp_err_t err = ESP_OK;
+    
+    mbedtls_sha256_finish(&digest->sha256, sha);
+    mbedtls_md5_finish(&digest->md5, md5);
+    digest_free(digest);
+    
+    if (target->sha256[0] != '\0') {
+        digest_to_hex(sha, sizeof(sha), hex);
+        if (strcasecmp(hex, target->sha256) != 0) {
+            ESP_LOGE(TAG, "SHA-256 mismatch: got %s, expected %s", hex, target->sha256);
+            err = ESP_ERR_INVALID_CRC;
+        }
+    }
+    if (target->md5[0] != '\0') {
+        digest_to_hex(md5, sizeof(md5), hex);
+        if (strcasecmp(hex, target->md5) != 0) {
+            ESP_LOGE(TAG, "MD5 mismatch: got %s, expected %s", hex, target->md5);
+            err = ESP_ERR_INVALID_CRC;
+        }
+    }
+    return err;
+}
+
+/**
+ * @brief 读取断点续传偏移与摘要状态
+ * 
+ * 记录的版本与目标分区都一致时才续传。摘要状态随偏移一起保存，
+ * 续传时直接恢复，不需要回读 Flash 重新计算。
+ * 
+ * @param version 目标版本号
+ * @param part 目标分区
+ * @param[out] digest 恢复的摘要状态（可选，传 NULL 只查询偏移）
+ * @return uint32_t 续传起始偏移，0 表示从头下载
+ */
+static uint32_t resume_load(const char *version, const esp_partition_t *part, ota_digest_t *digest)
+{
+    ota_resume_t *rec = calloc(1, sizeof(ota_resume_t));
+    if (rec == NULL) {
+        return 0;
+    }
+    
+    uint32_t offset = 0;
+    if (xn_storage_get_record(RESUME_RECORD_KEY, RESUME_RECORD_VERSION, rec, sizeof(*rec), NULL) == ESP_OK) {
+        rec->version[sizeof(rec->version) - 1] = '\0';
+        // 断点只保存在 XN_OTA_RESUME_CHECKPOINT 边界上，续传时从该扇区起擦除；
+        // 不在扇区边界上的记录（旧版本保存或已损坏）从头下载
+        if (rec->offset % XN_OTA_RESUME_CHECKPOINT == 0 && strcmp(rec->version, version) == 0 &&
+            rec->part_addr == part->address) {
+            offset = rec->offset;
+        }
+    }
+    if (offset > 0 && digest != NULL) {
+        *digest = rec->digest;
+    }
+    free(rec);
+    return offset;
+}
+
+/**
+ * @brief 保存断点续传偏移与摘要状态
+ * 
+ * 断点用于掉电后续传，保存后立即提交，不等待存储组件的延迟提交。
+ */
+static void resume_save(const ota_download_t *dl)
+{
+    ota_resume_t *rec = calloc(1, sizeof(ota_resume_t));
+    if (rec == NULL) {
+        return;
+    }
+    
+    // 先复制出独立的摘要状态再保存（硬件加速时中间状态可能还在 SHA 外设中）
+    mbedtls_sha256_init(&rec->digest.sha256);
+    mbedtls_md5_init(&rec->digest.md5);
+    mbedtls_sha256_clone(&rec->digest.sha256, &dl->digest.sha256);
+    mbedtls_md5_clone(&rec->digest.md5, &dl->digest.md5);
+    
+    strlcpy(rec->version, dl->version, sizeof(rec->version));
+    rec->part_addr = dl->part->address;
+    rec->offset = dl->offset;
+    if (xn_storage_set_record(RESUME_RECORD_KEY, RESUME_RECORD_VERSION, rec, sizeof(*rec)) == ESP_OK) {
+        xn_storage_commit();
+    }
+    
+    mbedtls_sha256_free(&rec->digest.sha256);
+    mbedtls_md5_free(&rec->digest.md5);
+    free(rec);
+}
+
+/**
+ * @brief 清除断点续传记录
+ */
+static void resume_clear(void)
+{
+    if (xn_storage_erase(RESUME_RECORD_KEY) == ESP_OK) {
+        xn_storage_commit();
+    }
+}
+
+/**
+ * @brief 擦除断点之后的区域（重启后续传前调用）
+ * 
+ * 镜像大小已知时擦除到镜像末尾所在扇区，否则擦除到分区末尾。
+ */
+static esp_err_t resume_erase(const ota_download_t *dl)
+{
+    uint32_t sector = dl->part->erase_size;
+    uint32_t end = dl->part->size;
+    if (dl->image_size > 0 && dl->image_size < end) {
+        end = (dl->image_size + sector - 1) / sector * sector;
+    }
+    return esp_partition_erase_range(dl->part, dl->offset, end - dl->offset);
+}
+
+/**
+ * @brief 删除旧版本按字段保存的断点续传键（未完成的下载将从头开始）
+ */
+static void resume_drop_legacy(void)
+{
+    nvs_handle_t nvs_handle;
+    if (nvs_open("ota", NVS_READWRITE, &nvs_handle) != ESP_OK) {
+        return;
+    }
+    bool erased = false;
+    for (size_t i = 0; i < sizeof(s_legacy_resume_keys) / sizeof(s_legacy_resume_keys[0]); i++) {
+        if (nvs_erase_key(nvs_handle, s_legacy_resume_keys[i]) == ESP_OK) {
+            erased = true;
+        }
+    }
+    if (erased) {
+        nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+}
+
+/**
+ * @brief 把接收缓冲写入分区并推进偏移
+ * 
+ * 末尾不足16字节时补 0xFF（与擦除状态相同），满足 Flash 加密的对齐要求。
+ */
+static esp_err_t download_flush(ota_download_t *dl, size_t len)
+{
+    size_t padded = (len + 15) & ~(size_t)15;
+    memset(dl->buf + len, 0xFF, padded - len);
+    
+    esp_err_t err = esp_ota_write_with_offset(dl->ota_handle, dl->buf, padded, dl->offset);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "OTA write failed at %u: %s", (unsigned)dl->offset, esp_err_to_name(err));
+        return err;
+    }
+    
+    // 断点只保存在 XN_OTA_RESUME_CHECKPOINT 边界上：边界前的数据计入摘要后保存，
+    // 重启续传时从边界起擦除重写，边界之后已写入的部分重新下载
+    uint32_t end = dl->offset + len;
+    uint32_t mark = end - end % XN_OTA_RESUME_CHECKPOINT;
+    size_t head = 0;
+    if (mark > dl->offset && mark > dl->checkpoint) {
+        head = mark - dl->offset;
+        // 摘要只计算真实数据，不含补齐字节
+        mbedtls_sha256_update(&dl->digest.sha256, (const unsigned char *)dl->buf, head);
+        mbedtls_md5_update(&dl->digest.md5, (const unsigned char *)dl->buf, head);
+        dl->offset = mark;
+        resume_save(dl);
+        dl->checkpoint = mark;
+    }
+    mbedtls_sha256_update(&dl->digest.sha256, (const unsigned char *)dl->buf + head, len - head);
+    mbedtls_md5_update(&dl->digest.md5, (const unsigned char *)dl->buf + head, len - head);
+    dl->offset = end;
+    return ESP_OK;
+}
+
+/**
+ * @brief 按限速要求让出 CPU 和带宽
+ * 
+ * 比较本次请求已接收的字节数与限速下应耗费的时间，下载过快时休眠补足差值。
+ * 
+ * @param start 本次请求开始时间(us)
+ * @param received 本次请求已接收的字节数
+ */
+static void download_throttle(int64_t start, uint32_t received)
+{
+    uint32_t limit = s_rate_limit;
+    if (limit == 0) {
+        return;
+    }
+    int64_t expected = ((int64_t)received * 1000000) / limit;
+    int64_t ahead = expected - (esp_timer_get_time() - start);
+    if (ahead >= 1000) {
+        vTaskDelay(pdMS_TO_TICKS(ahead / 1000) + 1);
+    }
+}
+
+/**
+ * @brief 按实际经过的时间统计下载速度并回调进度
+ */
+static void download_report(ota_download_t *dl)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t elapsed = now - dl->speed_time;
+    if (elapsed < 1000000) {  // 每秒更新一次
+        return;
+    }
+    
+    size_t speed = (size_t)(((int64_t)(dl->offset - dl->speed_offset) * 1000000) / elapsed);
+    int progress = (dl->image_size > 0) ? (int)(((uint64_t)dl->offset * 100) / dl->image_size) : 0;
+    
+    ESP_LOGI(TAG, "Progress: %d%% (%u/%u), Speed: %u B/s", 
+             progress, (unsigned)dl->offset, (unsigned)dl->image_size, (unsigned)speed);
+    
+    if (s_config.progress_cb != NULL) {
+        s_config.progress_cb(progress, speed);
+    }
+    
+    dl->speed_time = now;
+    dl->speed_offset = dl->offset;
+}
+
+/**
+ * @brief 从当前偏移下载剩余固件（一次 HTTP 请求）
+ * 
+ * @return esp_err_t 
+ *      - ESP_OK: 下载完成
+ *      - ESP_ERR_NOT_SUPPORTED: 服务器忽略了 Range 请求，需从头下载
+ *      - 其他: 网络或写入错误，可从 dl->offset 续传
+ */
+static esp_err_t download_range(esp_http_client_handle_t client, ota_download_t *dl)
+{
+    // 续传时请求剩余部分
+    char range[32];
+    if (dl->offset > 0) {
+        snprintf(range, sizeof(range), "bytes=%u-", (unsigned)dl->offset);
+        esp_http_client_set_header(client, "Range", range);
+    } else {
+        esp_http_client_delete_header(client, "Range");
+    }
+    
+    esp_err_t err = esp_http_client_open(client, 0);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "HTTP open failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    
+    int64_t content_length = esp_http_client_fetch_headers(client);
+    int status_code = esp_http_client_get_status_code(client);
+    if (dl->offset > 0 && status_code == 200) {
+        ESP_LOGW(TAG, "Server ignored Range request, restarting download");
+        esp_http_client_close(client);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (status_code != 200 && status_code != 206) {
+        ESP_LOGE(TAG, "HTTP status code: %d", status_code);
+        esp_http_client_close(client);
+        return ESP_FAIL;
+    }
+    if (dl->image_size == 0 && content_length > 0) {
+        dl->image_size = dl->offset + (uint32_t)content_length;
+    }
+    
+    // 攒满接收缓冲再写入分区
+    size_t fill = 0;
+    uint32_t start_offset = dl->offset;
+    int64_t start_time = esp_timer_get_time();
+    err = ESP_OK;
+    while (1) {
+        int n = esp_http_client_read(client, dl->buf + fill, dl->buf_size - fill);
+        if (n < 0) {
+            err = ESP_FAIL;
+            break;
+        }
+        if (n == 0) {
+            // 连接正常结束，还是中途断开
+            if (!esp_http_client_is_complete_data_received(client)) {
+                err = ESP_ERR_INVALID_RESPONSE;
+            }
+            break;
+        }
+        
+        fill += n;
+        // 超过声明的固件大小立即中止，不再继续下载
+        if (dl->image_size > 0 && dl->offset + fill > dl->image_size) {
+            ESP_LOGE(TAG, "Image exceeds declared size %u", (unsigned)dl->image_size);
+            err = ESP_ERR_INVALID_SIZE;
+            break;
+        }
+        if (fill == dl->buf_size) {
+            err = download_flush(dl, fill);
+            fill = 0;
+            if (err != ESP_OK) {
+                break;
+            }
+            download_report(dl);
+        }
+        download_throttle(start_time, dl->offset + fill - start_offset);
+    }
+    
+    // 写入最后不满一个缓冲的数据；中途断开时丢弃，续传时重新下载
+    if (err == ESP_OK && fill > 0) {
+        err = download_flush(dl, fill);
+    }
+    
+    esp_http_client_close(client);
+    return err;
+}
+
+/**
+ * @brief 版本检查响应解析上下文
+ */
+typedef struct {
+    xn_ota_json_t json;                         // 流式解析器
+    xn_ota_version_list_t *list;                // 输出版本列表
+    xn_ota_version_info_t *cur;                 // 正在填充的版本（列表已满时为 NULL）
+    char code[sizeof(s_activation_code)];       // 激活码
+    char message[sizeof(s_activation_message)]; // 激活消息
+    char challenge[sizeof(s_activation_challenge)]; // 激活挑战码
+} version_parse_t;
+
+/**
+ * @brief 复制字符串字段，超长截断
+ */
+static void copy_field(char *dst, size_t size, const char *value)
+{
+    strncpy(dst, value, size - 1);
+    dst[size - 1] = '\0';
+}
+
+/**
+ * @brief 版本检查响应字段回调，直接填入版本信息
+ * 
+ * "firmware" 对象与 "versions" 数组中的每个对象各对应一个版本条目。
+ */
+static void on_version_field(const char *path, const char *value, xn_ota_json_type_t type, void *ctx)
+{
+    version_parse_t *vp = (version_parse_t *)ctx;
+    
+    const char *key = NULL;
+    if (strncmp(path, "firmware", 8) == 0) {
+        key = path + 8;
+    } else if (strncmp(path, "versions", 8) == 0) {
+        key = path + 8;
+    }
+    
+    if (key != NULL && *key == '\0') {
+        if (type != XN_OTA_JSON_OBJECT) {
+            return;
+        }
+        // 新的版本条目，超出数组容量的忽略
+        xn_ota_version_list_t *list = vp->list;
+        vp->cur = NULL;
+        if (list->count < XN_OTA_MAX_VERSIONS) {
+            vp->cur = &list->versions[list->count++];
+            memset(vp->cur, 0, sizeof(*vp->cur));
+            vp->cur->rollout = 100;
+        }
+        return;
+    }
+    
+    if (key != NULL && *key == '.') {
+        xn_ota_version_info_t *ver = vp->cur;
+        key++;
+        if (ver == NULL) {
+            return;
+        }
+        
+        if (type == XN_OTA_JSON_STRING) {
+            if (strcmp(key, "version") == 0) {
+                copy_field(ver->version, sizeof(ver->version), value);
+            } else if (strcmp(key, "url") == 0) {
+                copy_field(ver->url, sizeof(ver->url), value);
+            } else if (strcmp(key, "md5") == 0) {
+                copy_field(ver->md5, sizeof(ver->md5), value);
+            } else if (strcmp(key, "sha256") == 0) {
+                copy_field(ver->sha256, sizeof(ver->sha256), value);
+            } else if (strcmp(key, "changelog") == 0) {
+                copy_field(ver->changelog, sizeof(ver->changelog), value);
+            } else if (strcmp(key, "patch_url") == 0) {
+                copy_field(ver->patch_url, sizeof(ver->patch_url), value);
+            } else if (strcmp(key, "base_version") == 0) {
+                copy_field(ver->base_version, sizeof(ver->base_version), value);
+            } else if (strcmp(key, "min_version") == 0) {
+                copy_field(ver->min_version, sizeof(ver->min_version), value);
+            }
+        } else if (type == XN_OTA_JSON_NUMBER) {
+            if (strcmp(key, "size") == 0) {
+                ver->size = strtoul(value, NULL, 10);
+            } else if (strcmp(key, "patch_size") == 0) {
+                ver->patch_size = strtoul(value, NULL, 10);
+            } else if (strcmp(key, "force") == 0) {
+                ver->force = (atoi(value) == 1);
+            } else if (strcmp(key, "rollout") == 0) {
+                int rollout = atoi(value);
+                ver->rollout = (rollout < 0) ? 0 : (rollout > 100) ? 100 : rollout;
+            }
+        }
+        return;
+    }
+    
+    if (type == XN_OTA_JSON_STRING) {
+        if (strcmp(path, "activation.code") == 0) {
+            copy_field(vp->code, sizeof(vp->code), value);
+        } else if (strcmp(path, "activation.message") == 0) {
+            copy_field(vp->message, sizeof(vp->message), value);
+        } else if (strcmp(path, "activation.challenge") == 0) {
+            copy_field(vp->challenge, sizeof(vp->challenge), value);
+        }
+    }
 }
 
 /**
- * @brief HTTP 事件处理回调
+ * @brief 版本检查响应接收函数：边接收边解析
  */
-static esp_err_t http_event_handler(esp_http_client_event_t *evt)
+static esp_err_t version_sink(const char *data, size_t len, void *ctx)
 {
-    switch (evt->event_id) {
-        case HTTP_EVENT_ERROR:
-            ESP_LOGE(TAG, "HTTP_EVENT_ERROR");
-            break;
-        case HTTP_EVENT_ON_CONNECTED:
-            ESP_LOGD(TAG, "HTTP_EVENT_ON_CONNECTED");
-            break;
-        case HTTP_EVENT_HEADER_SENT:
-            ESP_LOGD(TAG, "HTTP_EVENT_HEADER_SENT");
-            break;
-        case HTTP_EVENT_ON_HEADER:
-            ESP_LOGD(TAG, "HTTP_EVENT_ON_HEADER, key=%s, value=%s", 
-                     evt->header_key, evt->header_value);
-            break;
-        case HTTP_EVENT_ON_DATA:
-            ESP_LOGD(TAG, "HTTP_EVENT_ON_DATA, len=%d", evt->data_len);
-            break;
-        case HTTP_EVENT_ON_FINISH:
-            ESP_LOGD(TAG, "HTTP_EVENT_ON_FINISH");
-            break;
-        case HTTP_EVENT_DISCONNECTED:
-            ESP_LOGD(TAG, "HTTP_EVENT_DISCONNECTED");
-            break;
-        default:
-            break;
+    version_parse_t *vp = (version_parse_t *)ctx;
+    if (data == NULL) {
+        // 换连接重发，丢弃已解析的内容
+        xn_ota_json_init(&vp->json, on_version_field, vp);
+        vp->list->count = 0;
+        vp->cur = NULL;
+        vp->code[0] = vp->message[0] = vp->challenge[0] = '\0';
+        return ESP_OK;
     }
-    return ESP_OK;
+    return xn_ota_json_feed(&vp->json, data, len);
 }
 
 /**
- * @brief 解析云端版本列表响应
+ * @brief 下载完整固件写入 OTA 分区（支持断点续传）
+ * 
+ * @return esp_err_t ESP_OK 表示镜像已写入并通过校验
  */
-static esp_err_t parse_version_list_response(const char *json_str, 
-                                             xn_ota_version_list_t *version_list)
+static esp_err_t upgrade_full(const xn_ota_version_info_t *target, const esp_partition_t *part)
 {
-    cJSON *root = cJSON_Parse(json_str);
-    if (root == NULL) {
-        ESP_LOGE(TAG, "Failed to parse JSON");
-        return ESP_FAIL;
+    // 接收缓冲按16字节对齐，末尾留出补齐空间
+    ota_download_t dl = {
+        .version = target->version,
+        .part = part,
+        .image_size = target->size,
+        .buf_size = s_config.rx_buffer_size & ~(size_t)15,
+    };
+    if (dl.buf_size == 0) {
+        dl.buf_size = 4096;
     }
-    
-    cJSON *firmware = cJSON_GetObjectItem(root, "firmware");
-    if (!cJSON_IsObject(firmware)) {
-        cJSON_Delete(root);
-        return ESP_FAIL;
+    dl.buf = malloc(dl.buf_size + 16);
+    if (dl.buf == NULL) {
+        return ESP_ERR_NO_MEM;
     }
     
-    // 解析单个版本信息
-    version_list->count = 0;
-    xn_ota_version_info_t *ver = &version_list->versions[0];
-    
-    cJSON *version = cJSON_GetObjectItem(firmware, "version");
-    if (cJSON_IsString(version)) {
-        strncpy(ver->version, version->valuestring, XN_OTA_MAX_VERSION_LEN - 1);
+    // 有同一版本的断点时只擦除断点之后的区域，从断点继续写，摘要状态一并恢复
+    dl.offset = resume_load(dl.version, part, &dl.digest);
+    if (dl.image_size > 0 && dl.offset >= dl.image_size) {
+        dl.offset = 0;
+    }
+    if (dl.offset == 0) {
+        digest_reset(&dl.digest);
+    }
+    esp_err_t err = esp_ota_begin(part, (dl.offset > 0) ? OTA_WITH_SEQUENTIAL_WRITES : OTA_SIZE_UNKNOWN, 
+                                  &dl.ota_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "OTA begin failed: %s", esp_err_to_name(err));
+        digest_free(&dl.digest);
+        free(dl.buf);
+        return err;
+    }
+    if (dl.offset > 0) {
+        // SEQUENTIAL 模式不擦除分区，而 esp_ota_write_with_offset 要求目标已擦除：
+        // 断点之后可能有重启前写入的数据，从断点（扇区边界）起擦除到镜像末尾
+        err = resume_erase(&dl);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Erase from resume point failed: %s", esp_err_to_name(err));
+            esp_ota_abort(dl.ota_handle);
+            resume_clear();
+            digest_free(&dl.digest);
+            free(dl.buf);
+            return err;
+        }
+        ESP_LOGI(TAG, "Resuming download from %u bytes", (unsigned)dl.offset);
+    } else {
+        resume_save(&dl);
     }
+    dl.checkpoint = dl.offset;
+    dl.speed_time = esp_timer_get_time();
+    dl.speed_offset = dl.offset;
     
-    cJSON *url = cJSON_GetObjectItem(firmware, "url");
-    if (cJSON_IsString(url)) {
-        strncpy(ver->url, url->valuestring, XN_OTA_MAX_URL_LEN - 1);
+    // 同一个客户端用于所有续传请求，复用连接与 TLS 会话
+    esp_http_client_config_t http_config = {
+        .url = target->url,
+        .timeout_ms = s_config.timeout_ms,
+        .buffer_size = dl.buf_size,
+        .keep_alive_enable = true,
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+        .save_client_session = true,
+#endif
+    };
+    esp_http_client_handle_t client = esp_http_client_init(&http_config);
+    if (client == NULL) {
+        ESP_LOGE(TAG, "Failed to init HTTP client");
+        esp_ota_abort(dl.ota_handle);
+        digest_free(&dl.digest);
+        free(dl.buf);
+        return ESP_FAIL;
     }
     
-    cJSON *size = cJSON_GetObjectItem(firmware, "size");
-    if (cJSON_IsNumber(size)) {
-        ver->size = size->valueint;
+    // 下载中断时等待后从断点续传
+    uint8_t attempt = 0;
+    while (1) {
+        err = download_range(client, &dl);
+        if (err == ESP_OK) {
+            break;
+        }
+        
+        if (err == ESP_ERR_NOT_SUPPORTED) {
+            // 服务器不支持续传：重新擦除分区从头下载；同样计入重试，服务器总是中途断开时不会无限重下
+            if (++attempt > s_config.max_retries) {
+                ESP_LOGE(TAG, "Download failed after %d restarts, server does not support Range", 
+                         s_config.max_retries);
+                resume_clear();
+                break;
+            }
+            esp_ota_abort(dl.ota_handle);
+            err = esp_ota_begin(part, OTA_SIZE_UNKNOWN, &dl.ota_handle);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "OTA begin failed: %s", esp_err_to_name(err));
+                dl.ota_handle = 0;
+                break;
+            }
+            dl.offset = dl.checkpoint = dl.speed_offset = 0;
+            digest_free(&dl.digest);
+            digest_reset(&dl.digest);
+            resume_save(&dl);
+            continue;
+        }
+        
+        if (err == ESP_ERR_INVALID_SIZE) {
+            // 镜像超出声明大小，重试没有意义，清除断点
+            resume_clear();
+            break;
+        }
+        
+        if (++attempt > s_config.max_retries) {
+            // 断点保留在最近的边界上，不保存当前偏移
+            ESP_LOGE(TAG, "Download failed after %d retries, resume point kept at %u bytes", 
+                     s_config.max_retries, (unsigned)dl.checkpoint);
+            err = ESP_ERR_TIMEOUT;
+            break;
+        }
+        ESP_LOGW(TAG, "Download interrupted at %u bytes, retry %d/%d", 
+                 (unsigned)dl.offset, attempt, s_config.max_retries);
+        vTaskDelay(pdMS_TO_TICKS(s_config.retry_delay_ms * attempt));
     }
     
-    cJSON *md5 = cJSON_GetObjectItem(firmware, "md5");
-    if (cJSON_IsString(md5)) {
-        strncpy(ver->md5, md5->valuestring, 32);
+    esp_http_client_cleanup(client);
+    free(dl.buf);
+    
+    if (err != ESP_OK) {
+        if (dl.ota_handle) {
+            esp_ota_abort(dl.ota_handle);
+        }
+        digest_free(&dl.digest);
+        return err;
     }
     
-    cJSON *force = cJSON_GetObjectItem(firmware, "force");
-    ver->force = (cJSON_IsNumber(force) && force->valueint == 1);
+    // 先比对云端摘要再校验镜像；任一失败都清除断点，下次从头下载
+    if (dl.image_size > 0 && dl.offset != dl.image_size) {
+        ESP_LOGE(TAG, "Image size mismatch: got %u, expected %u", 
+                 (unsigned)dl.offset, (unsigned)dl.image_size);
+        err = ESP_ERR_INVALID_SIZE;
+    }
+    if (err == ESP_OK) {
+        err = digest_verify(&dl.digest, target);
+    } else {
+        digest_free(&dl.digest);
+    }
+    if (err != ESP_OK) {
+        esp_ota_abort(dl.ota_handle);
+        resume_clear();
+        return err;
+    }
+    err = esp_ota_end(dl.ota_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "OTA finish failed: %s", esp_err_to_name(err));
+        resume_clear();
+        return (err == ESP_ERR_OTA_VALIDATE_FAILED) ? ESP_ERR_INVALID_CRC : err;
+    }
     
-    cJSON *changelog = cJSON_GetObjectItem(firmware, "changelog");
-    if (cJSON_IsString(changelog)) {
-        strncpy(ver->changelog, changelog->valuestring, 255);
+    return ESP_OK;
+}
+
+/**
+ * @brief 差分输出回调：生成的镜像数据计入摘要
+ */
+static void delta_digest_update(void *ctx, const uint8_t *data, size_t len)
+{
+    ota_digest_t *digest = (ota_digest_t *)ctx;
+    mbedtls_sha256_update(&digest->sha256, data, len);
+    mbedtls_md5_update(&digest->md5, data, len);
+}
+
+/**
+ * @brief 下载差分补丁，边下载边基于运行分区生成新固件
+ * 
+ * 补丁较小，不做断点续传；失败时由调用者回退到完整固件。
+ * 
+ * @return esp_err_t ESP_OK 表示镜像已写入并通过校验
+ */
+static esp_err_t upgrade_delta(const xn_ota_version_info_t *target, const esp_partition_t *part)
+{
+    xn_ota_delta_t *delta = malloc(sizeof(xn_ota_delta_t));
+    ota_download_t dl = {
+        .version = target->version,
+        .part = part,
+        .image_size = target->patch_size,
+        .buf_size = (s_config.rx_buffer_size > 0) ? s_config.rx_buffer_size : 4096,
+        .speed_time = esp_timer_get_time(),
+    };
+    dl.buf = malloc(dl.buf_size);
+    if (delta == NULL || dl.buf == NULL) {
+        free(delta);
+        free(dl.buf);
+        return ESP_ERR_NO_MEM;
     }
     
-    version_list->count = 1;
+    esp_err_t err = esp_ota_begin(part, OTA_SIZE_UNKNOWN, &dl.ota_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "OTA begin failed: %s", esp_err_to_name(err));
+        free(delta);
+        free(dl.buf);
+        return err;
+    }
+    // 分区已被擦除，其他版本的完整固件断点随之失效
+    resume_clear();
+    // 摘要按生成的镜像计算，与完整固件的 sha256/md5 比对
+    digest_reset(&dl.digest);
+    xn_ota_delta_begin(delta, esp_ota_get_running_partition(), dl.ota_handle,
+                       delta_digest_update, &dl.digest);
     
-    // 解析激活信息
-    cJSON *activation = cJSON_GetObjectItem(root, "activation");
-    if (cJSON_IsObject(activation)) {
-        cJSON *code = cJSON_GetObjectItem(activation, "code");
-        if (cJSON_IsString(code)) {
-            strncpy(s_activation_code, code->valuestring, sizeof(s_activation_code) - 1);
+    esp_http_client_config_t http_config = {
+        .url = target->patch_url,
+        .timeout_ms = s_config.timeout_ms,
+        .buffer_size = dl.buf_size,
+    };
+    esp_http_client_handle_t client = esp_http_client_init(&http_config);
+    err = (client != NULL) ? esp_http_client_open(client, 0) : ESP_FAIL;
+    if (err == ESP_OK) {
+        int64_t content_length = esp_http_client_fetch_headers(client);
+        int status_code = esp_http_client_get_status_code(client);
+        if (status_code != 200) {
+            ESP_LOGE(TAG, "Patch HTTP status code: %d", status_code);
+            err = ESP_FAIL;
         }
-        
-        cJSON *message = cJSON_GetObjectItem(activation, "message");
-        if (cJSON_IsString(message)) {
-            strncpy(s_activation_message, message->valuestring, sizeof(s_activation_message) - 1);
+        if (dl.image_size == 0 && content_length > 0) {
+            dl.image_size = (uint32_t)content_length;
         }
-        
-        cJSON *challenge = cJSON_GetObjectItem(activation, "challenge");
-        if (cJSON_IsString(challenge)) {
-            strncpy(s_activation_challenge, challenge->valuestring, sizeof(s_activation_challenge) - 1);
+    }
+    
+    // 收到的补丁数据直接交给解析器，解析出的指令立即写入分区
+    int64_t start_time = esp_timer_get_time();
+    while (err == ESP_OK) {
+        int n = esp_http_client_read(client, dl.buf, dl.buf_size);
+        if (n < 0) {
+            err = ESP_FAIL;
+            break;
+        }
+        if (n == 0) {
+            if (!esp_http_client_is_complete_data_received(client)) {
+                err = ESP_ERR_INVALID_RESPONSE;
+            }
+            break;
         }
+        err = xn_ota_delta_feed(delta, (const uint8_t *)dl.buf, n);
+        dl.offset += n;
+        download_report(&dl);
+        download_throttle(start_time, dl.offset);
+    }
+    if (err == ESP_OK) {
+        err = xn_ota_delta_finish(delta);
+    }
+    if (err == ESP_OK) {
+        err = digest_verify(&dl.digest, target);
+    } else {
+        digest_free(&dl.digest);
     }
     
-    cJSON_Delete(root);
+    if (client != NULL) {
+        esp_http_client_close(client);
+        esp_http_client_cleanup(client);
+    }
+    free(delta);
+    free(dl.buf);
+    
+    if (err != ESP_OK) {
+        esp_ota_abort(dl.ota_handle);
+        return err;
+    }
+    
+    // 摘要一致后再做镜像格式校验
+    err = esp_ota_end(dl.ota_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Patched image invalid: %s", esp_err_to_name(err));
+        return (err == ESP_ERR_OTA_VALIDATE_FAILED) ? ESP_ERR_INVALID_CRC : err;
+    }
     return ESP_OK;
 }
 
@@ -249,6 +1264,22 @@ esp_err_t xn_ota_init(const xn_ota_config_t *config)
         return ESP_ERR_INVALID_ARG;
     }
     
+    // 云端请求连接池
+    if (s_http_pool_lock == NULL) {
+        s_http_pool_lock = xSemaphoreCreateMutex();
+        if (s_http_pool_lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    memset(s_http_pool, 0, sizeof(s_http_pool));
+    
+    // 断点续传记录通过 xn_storage 保存
+    esp_err_t err = xn_storage_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+    resume_drop_legacy();
+    
     // 生成设备信息
     generate_device_info();
     
@@ -269,6 +1300,7 @@ esp_err_t xn_ota_deinit(void)
         return ESP_ERR_INVALID_STATE;
     }
     
+    http_pool_close_all();
     s_initialized = false;
     ESP_LOGI(TAG, "OTA component deinitialized");
     
@@ -286,27 +1318,6 @@ esp_err_t xn_ota_get_cloud_versions(xn_ota_version_list_t *version_list)
         return ESP_ERR_INVALID_ARG;
     }
     
-    // 构建请求 URL
-    char url[512];
-    snprintf(url, sizeof(url), "%s", s_config.server_url);
-    
-    // 配置 HTTP 客户端
-    esp_http_client_config_t http_config = {
-        .url = url,
-        .event_handler = http_event_handler,
-        .timeout_ms = s_config.timeout_ms,
-    };
-    
-    esp_http_client_handle_t client = esp_http_client_init(&http_config);
-    if (client == NULL) {
-        ESP_LOGE(TAG, "Failed to init HTTP client");
-        return ESP_FAIL;
-    }
-    
-    // 设置请求头
-    esp_http_client_set_header(client, "Device-Id", s_device_info.device_id);
-    esp_http_client_set_header(client, "Content-Type", "application/json");
-    
     // 构建请求体
     cJSON *root = cJSON_CreateObject();
     cJSON_AddStringToObject(root, "device_id", s_device_info.device_id);
@@ -317,47 +1328,59 @@ esp_err_t xn_ota_get_cloud_versions(xn_ota_version_list_t *version_list)
     
     char *json_str = cJSON_PrintUnformatted(root);
     cJSON_Delete(root);
+    if (json_str == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
     
-    // 发送 POST 请求
-    esp_http_client_set_method(client, HTTP_METHOD_POST);
-    esp_http_client_set_post_field(client, json_str, strlen(json_str));
+    // 响应边接收边解析，不缓存完整响应体
+    version_parse_t *vp = malloc(sizeof(version_parse_t));
+    if (vp == NULL) {
+        free(json_str);
+        return ESP_ERR_NO_MEM;
+    }
+    vp->list = version_list;
+    version_sink(NULL, 0, vp);
     
-    esp_err_t err = esp_http_client_perform(client);
+    // 发送 POST 请求（复用连接池中的连接）
+    int status_code = 0;
+    esp_err_t err = http_post_json(s_config.server_url, json_str, &status_code, version_sink, vp);
     free(json_str);
     
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(err));
-        esp_http_client_cleanup(client);
-        return err;
-    }
-    
-    int status_code = esp_http_client_get_status_code(client);
-    if (status_code != 200) {
+    if (err == ESP_OK && status_code != 200) {
         ESP_LOGE(TAG, "HTTP status code: %d", status_code);
-        esp_http_client_cleanup(client);
-        return ESP_FAIL;
+        err = ESP_FAIL;
     }
-    
-    // 读取响应
-    int content_length = esp_http_client_get_content_length(client);
-    char *response = malloc(content_length + 1);
-    if (response == NULL) {
-        esp_http_client_cleanup(client);
-        return ESP_ERR_NO_MEM;
+    if (err == ESP_OK && (xn_ota_json_finish(&vp->json) != ESP_OK || version_list->count == 0)) {
+        ESP_LOGE(TAG, "Invalid version response");
+        err = ESP_FAIL;
     }
     
-    int read_len = esp_http_client_read(client, response, content_length);
-    response[read_len] = '\0';
-    
-    ESP_LOGI(TAG, "Response: %s", response);
-    
-    // 解析响应
-    err = parse_version_list_response(response, version_list);
-    
-    free(response);
-    esp_http_client_cleanup(client);
-    
     if (err == ESP_OK) {
+        // 差分补丁只有补丁地址和基准版本都提供时才有效
+        for (int i = 0; i < version_list->count; i++) {
+            xn_ota_version_info_t *ver = &version_list->versions[i];
+            if (ver->patch_url[0] == '\0' || ver->base_version[0] == '\0') {
+                ver->patch_url[0] = '\0';
+                ver->base_version[0] = '\0';
+                ver->patch_size = 0;
+            }
+        }
+        
+        // 激活信息只在响应中提供时更新
+        if (vp->code[0] != '\0') {
+            strcpy(s_activation_code, vp->code);
+        }
+        if (vp->message[0] != '\0') {
+            strcpy(s_activation_message, vp->message);
+        }
+        if (vp->challenge[0] != '\0') {
+            strcpy(s_activation_challenge, vp->challenge);
+        }
+        ESP_LOGI(TAG, "Cloud versions: %d", version_list->count);
+    }
+    free(vp);
+    
+    if (err == ESP_OK && version_list != &s_cloud_versions) {
         // 缓存版本列表
         memcpy(&s_cloud_versions, version_list, sizeof(s_cloud_versions));
     }
@@ -371,29 +1394,29 @@ esp_err_t xn_ota_check_update(bool *has_update, xn_ota_version_info_t *latest_ve
         return ESP_ERR_INVALID_ARG;
     }
     
-    // 获取云端版本列表
-    xn_ota_version_list_t version_list;
-    esp_err_t err = xn_ota_get_cloud_versions(&version_list);
+    // 随机等待，避免大批设备同时请求服务器
+    if (s_config.check_jitter_ms > 0) {
+        uint32_t delay_ms = esp_random() % s_config.check_jitter_ms;
+        ESP_LOGI(TAG, "Update check jitter: %u ms", (unsigned)delay_ms);
+        vTaskDelay(pdMS_TO_TICKS(delay_ms));
+    }
+    
+    // 获取云端版本列表，直接写入内部缓存（列表较大，避免占用调用者栈）
+    esp_err_t err = xn_ota_get_cloud_versions(&s_cloud_versions);
     if (err != ESP_OK) {
         return err;
     }
     
     *has_update = false;
     
-    if (version_list.count == 0) {
-        return ESP_OK;
-    }
-    
-    // 检查是否有新版本
-    const char *current_version = xn_ota_get_local_version();
-    xn_ota_version_info_t *newest = &version_list.versions[0];
-    
-    if (compare_version(newest->version, current_version) > 0 || newest->force) {
+    // 选出本设备可升级的版本
+    xn_ota_version_info_t *newest = select_update(&s_cloud_versions);
+    if (newest != NULL) {
         *has_update = true;
         if (latest_version != NULL) {
             memcpy(latest_version, newest, sizeof(xn_ota_version_info_t));
         }
-        ESP_LOGI(TAG, "New version available: %s", newest->version);
+        ESP_LOGI(TAG, "New version available: %s (rollout %d%%)", newest->version, newest->rollout);
     } else {
         ESP_LOGI(TAG, "Current version is up to date");
     }
@@ -408,94 +1431,83 @@ esp_err_t xn_ota_upgrade(const char *version)
     }
     
     // 如果未指定版本，升级到最新版本
-    xn_ota_version_info_t *target_version = NULL;
+    xn_ota_version_info_t *found = NULL;
     
     if (version == NULL) {
-        // 使用缓存的版本列表
-        if (s_cloud_versions.count == 0) {
+        // 使用缓存的版本列表，按灰度规则选择
+        found = select_update(&s_cloud_versions);
+        if (found == NULL) {
             ESP_LOGE(TAG, "No version available");
             return ESP_ERR_NOT_FOUND;
         }
-        target_version = &s_cloud_versions.versions[0];
     } else {
         // 查找指定版本
         for (int i = 0; i < s_cloud_versions.count; i++) {
             if (strcmp(s_cloud_versions.versions[i].version, version) == 0) {
-                target_version = &s_cloud_versions.versions[i];
+                found = &s_cloud_versions.versions[i];
                 break;
             }
         }
         
-        if (target_version == NULL) {
+        if (found == NULL) {
             ESP_LOGE(TAG, "Version %s not found", version);
             return ESP_ERR_NOT_FOUND;
         }
     }
     
-    ESP_LOGI(TAG, "Starting OTA upgrade to version %s", target_version->version);
-    ESP_LOGI(TAG, "Download URL: %s", target_version->url);
+    // 下载期间版本列表可能被再次检查更新改写，先复制出目标版本
+    xn_ota_version_info_t *target = malloc(sizeof(xn_ota_version_info_t));
+    if (target == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(target, found, sizeof(xn_ota_version_info_t));
     
-    // 配置 HTTPS OTA
-    esp_http_client_config_t http_config = {
-        .url = target_version->url,
-        .timeout_ms = s_config.timeout_ms,
-        .keep_alive_enable = true,
-    };
+    esp_err_t err = xn_ota_upgrade_to(target);
+    free(target);
+    return err;
+}
+
+esp_err_t xn_ota_upgrade_to(const xn_ota_version_info_t *target_version)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (target_version == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
     
-    esp_https_ota_config_t ota_config = {
-        .http_config = &http_config,
-    };
+    ESP_LOGI(TAG, "Starting OTA upgrade to version %s", target_version->version);
+    ESP_LOGI(TAG, "Download URL: %s", target_version->url);
     
-    esp_https_ota_handle_t ota_handle = NULL;
-    esp_err_t err = esp_https_ota_begin(&ota_config, &ota_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "OTA begin failed: %s", esp_err_to_name(err));
-        return err;
+    const esp_partition_t *part = esp_ota_get_next_update_partition(NULL);
+    if (part == NULL) {
+        ESP_LOGE(TAG, "No OTA partition available");
+        return ESP_FAIL;
     }
     
-    // 下载并写入固件
-    size_t total_read = 0;
-    size_t recent_read = 0;
-    int64_t last_calc_time = esp_timer_get_time();
-    
-    while (1) {
-        err = esp_https_ota_perform(ota_handle);
-        if (err != ESP_ERR_HTTPS_OTA_IN_PROGRESS) {
-            break;
-        }
-        
-        // 计算进度和速度
-        int image_len = esp_https_ota_get_image_len_read(ota_handle);
-        recent_read = image_len - total_read;
-        total_read = image_len;
-        
-        int64_t now = esp_timer_get_time();
-        if (now - last_calc_time >= 1000000) {  // 每秒更新一次
-            int progress = (total_read * 100) / target_version->size;
-            size_t speed = recent_read;
-            
-            ESP_LOGI(TAG, "Progress: %d%% (%d/%d), Speed: %d B/s", 
-                     progress, total_read, target_version->size, speed);
-            
-            if (s_config.progress_cb != NULL) {
-                s_config.progress_cb(progress, speed);
-            }
-            
-            last_calc_time = now;
-            recent_read = 0;
+    // 补丁基于当前固件生成时优先差分升级；已有完整固件断点时继续完整下载
+    esp_err_t err = ESP_FAIL;
+    if (target_version->patch_url[0] != '\0' &&
+        strcmp(target_version->base_version, s_device_info.firmware_version) == 0 &&
+        resume_load(target_version->version, part, NULL) == 0) {
+        ESP_LOGI(TAG, "Applying delta patch from %s: %s", 
+                 target_version->base_version, target_version->patch_url);
+        err = upgrade_delta(target_version, part);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Delta upgrade failed (%s), falling back to full image", esp_err_to_name(err));
         }
     }
-    
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "OTA perform failed: %s", esp_err_to_name(err));
-        esp_https_ota_abort(ota_handle);
-        return err;
+        err = upgrade_full(target_version, part);
+        if (err != ESP_OK) {
+            return err;
+        }
     }
     
-    // 完成 OTA
-    err = esp_https_ota_finish(ota_handle);
+    err = esp_ota_set_boot_partition(part);
+    resume_clear();
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "OTA finish failed: %s", esp_err_to_name(err));
+        ESP_LOGE(TAG, "Set boot partition failed: %s", esp_err_to_name(err));
         return err;
     }
     
@@ -504,6 +1516,15 @@ esp_err_t xn_ota_upgrade(const char *version)
     return ESP_OK;
 }
 
+esp_err_t xn_ota_set_rate_limit(uint32_t bytes_per_sec)
+{
+    s_rate_limit = bytes_per_sec;
+    if (bytes_per_sec > 0) {
+        ESP_LOGI(TAG, "Download rate limit: %u B/s", (unsigned)bytes_per_sec);
+    }
+    return ESP_OK;
+}
+
 esp_err_t xn_ota_mark_valid(void)
 {
     const esp_partition_t *partition = esp_ota_get_running_partition();
@@ -578,9 +1599,8 @@ esp_err_t xn_ota_submit_device_info(void)
     }
     
     // 通过 xn_ota_get_cloud_versions 已经提交了设备信息
-    // 这里只是一个包装函数
-    xn_ota_version_list_t version_list;
-    return xn_ota_get_cloud_versions(&version_list);
+    // 这里只是一个包装函数，响应直接解析到内部缓存，避免约 10KB 的栈上列表
+    return xn_ota_get_cloud_versions(&s_cloud_versions);
 }
 
 esp_err_t xn_ota_activate_device(void)
@@ -598,22 +1618,6 @@ esp_err_t xn_ota_activate_device(void)
     char url[512];
     snprintf(url, sizeof(url), "%s/activate", s_config.server_url);
     
-    // 配置 HTTP 客户端
-    esp_http_client_config_t http_config = {
-        .url = url,
-        .event_handler = http_event_handler,
-        .timeout_ms = s_config.timeout_ms,
-    };
-    
-    esp_http_client_handle_t client = esp_http_client_init(&http_config);
-    if (client == NULL) {
-        return ESP_FAIL;
-    }
-    
-    // 设置请求头
-    esp_http_client_set_header(client, "Device-Id", s_device_info.device_id);
-    esp_http_client_set_header(client, "Content-Type", "application/json");
-    
     // 构建激活 Payload（简化版，实际应使用 HMAC 签名）
     cJSON *root = cJSON_CreateObject();
     cJSON_AddStringToObject(root, "device_id", s_device_info.device_id);
@@ -621,22 +1625,19 @@ esp_err_t xn_ota_activate_device(void)
     
     char *json_str = cJSON_PrintUnformatted(root);
     cJSON_Delete(root);
+    if (json_str == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
     
-    // 发送 POST 请求
-    esp_http_client_set_method(client, HTTP_METHOD_POST);
-    esp_http_client_set_post_field(client, json_str, strlen(json_str));
-    
-    esp_err_t err = esp_http_client_perform(client);
+    // 发送 POST 请求；激活轮询期间复用同一连接
+    int status_code = 0;
+    esp_err_t err = http_post_json(url, json_str, &status_code, NULL, NULL);
     free(json_str);
     
     if (err != ESP_OK) {
-        esp_http_client_cleanup(client);
         return err;
     }
     
-    int status_code = esp_http_client_get_status_code(client);
-    esp_http_client_cleanup(client);
-    
     if (status_code == 202) {
         return ESP_ERR_TIMEOUT;  // 激活超时
     } else if (status_code == 200) {
@@ -0,0 +1,245 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-24
+ * @Description: OTA 差分补丁实现 - 流式解析 COPY/INSERT 指令并写入 OTA 分区
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved.
+ */
+
+#include "xn_ota_delta.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+
+/* 日志TAG */
+static const char *TAG = "xn_ota_delta";
+
+/* 解析阶段 */
+enum {
+    DELTA_STAGE_HEADER = 0,     // 读取头部
+    DELTA_STAGE_OPCODE,         // 读取指令
+    DELTA_STAGE_ARGS,           // 读取指令参数
+    DELTA_STAGE_INSERT,         // 写入 INSERT 数据
+    DELTA_STAGE_DONE,           // 已读到 END
+};
+
+/* 指令 */
+#define DELTA_OP_END            0x00    // 补丁结束
+#define DELTA_OP_COPY           0x01    // 从基准分区复制
+#define DELTA_OP_INSERT         0x02    // 写入新数据
+
+/* ========================================================================== */
+/*                              内部函数                                        */
+/* ========================================================================== */
+
+/**
+ * @brief 读取小端 u32
+ */
+static uint32_t get_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief 校验头部并确认基准固件一致
+ */
+static esp_err_t parse_header(xn_ota_delta_t *delta)
+{
+    if (memcmp(delta->field, XN_OTA_DELTA_MAGIC, 4) != 0) {
+        ESP_LOGE(TAG, "Invalid patch magic");
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    delta->base_size = get_le32(delta->field + 4);
+    uint32_t base_crc = get_le32(delta->field + 8);
+    delta->target_size = get_le32(delta->field + 12);
+
+    if (delta->base_size == 0 || delta->base_size > delta->base->size || delta->target_size == 0) {
+        ESP_LOGE(TAG, "Invalid patch sizes: base=%u target=%u",
+                 (unsigned)delta->base_size, (unsigned)delta->target_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // 逐块计算运行分区的 CRC，确认与生成补丁时的基准一致
+    uint32_t crc = 0;
+    for (uint32_t off = 0; off < delta->base_size; off += sizeof(delta->copy_buf)) {
+        uint32_t n = delta->base_size - off;
+        if (n > sizeof(delta->copy_buf)) {
+            n = sizeof(delta->copy_buf);
+        }
+        esp_err_t err = esp_partition_read(delta->base, off, delta->copy_buf, n);
+        if (err != ESP_OK) {
+            return err;
+        }
+        crc = esp_rom_crc32_le(crc, delta->copy_buf, n);
+    }
+    if (crc != base_crc) {
+        ESP_LOGW(TAG, "Base firmware mismatch: crc=0x%08x expected=0x%08x",
+                 (unsigned)crc, (unsigned)base_crc);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    ESP_LOGI(TAG, "Patch header ok: base=%u target=%u",
+             (unsigned)delta->base_size, (unsigned)delta->target_size);
+    return ESP_OK;
+}
+
+/**
+ * @brief 写入目标分区并通知输出回调
+ */
+static esp_err_t write_output(xn_ota_delta_t *delta, const uint8_t *data, size_t len)
+{
+    esp_err_t err = esp_ota_write(delta->ota_handle, data, len);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (delta->on_output) {
+        delta->on_output(delta->output_ctx, data, len);
+    }
+    delta->written += len;
+    return ESP_OK;
+}
+
+/**
+ * @brief 执行 COPY 指令：从基准分区复制到目标分区
+ */
+static esp_err_t apply_copy(xn_ota_delta_t *delta, uint32_t src, uint32_t len)
+{
+    if (src > delta->base_size || len > delta->base_size - src ||
+        len > delta->target_size - delta->written) {
+        ESP_LOGE(TAG, "COPY out of range: src=%u len=%u", (unsigned)src, (unsigned)len);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    while (len > 0) {
+        uint32_t n = (len > sizeof(delta->copy_buf)) ? sizeof(delta->copy_buf) : len;
+        esp_err_t err = esp_partition_read(delta->base, src, delta->copy_buf, n);
+        if (err != ESP_OK) {
+            return err;
+        }
+        err = write_output(delta, delta->copy_buf, n);
+        if (err != ESP_OK) {
+            return err;
+        }
+        src += n;
+        len -= n;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 指令参数读取完成后执行指令
+ */
+static esp_err_t run_op(xn_ota_delta_t *delta)
+{
+    if (delta->op == DELTA_OP_COPY) {
+        delta->stage = DELTA_STAGE_OPCODE;
+        return apply_copy(delta, get_le32(delta->field), get_le32(delta->field + 4));
+    }
+
+    // INSERT：后续 len 字节直接写入目标分区
+    uint32_t len = get_le32(delta->field);
+    if (len > delta->target_size - delta->written) {
+        ESP_LOGE(TAG, "INSERT out of range: len=%u", (unsigned)len);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    delta->remaining = len;
+    delta->stage = (len > 0) ? DELTA_STAGE_INSERT : DELTA_STAGE_OPCODE;
+    return ESP_OK;
+}
+
+/* ========================================================================== */
+/*                              内部API实现                                     */
+/* ========================================================================== */
+
+void xn_ota_delta_begin(xn_ota_delta_t *delta, const esp_partition_t *base, esp_ota_handle_t ota_handle,
+                        xn_ota_delta_output_t on_output, void *output_ctx)
+{
+    memset(delta, 0, sizeof(*delta));
+    delta->base = base;
+    delta->ota_handle = ota_handle;
+    delta->on_output = on_output;
+    delta->output_ctx = output_ctx;
+    delta->stage = DELTA_STAGE_HEADER;
+    delta->field_need = XN_OTA_DELTA_HEADER_SIZE;
+}
+
+esp_err_t xn_ota_delta_feed(xn_ota_delta_t *delta, const uint8_t *data, size_t len)
+{
+    esp_err_t err = ESP_OK;
+
+    while (len > 0 && err == ESP_OK) {
+        switch (delta->stage) {
+            case DELTA_STAGE_HEADER:
+            case DELTA_STAGE_ARGS: {
+                // 头部和参数可能跨越输入分段，先拼接完整
+                size_t n = delta->field_need - delta->field_len;
+                if (n > len) {
+                    n = len;
+                }
+                memcpy(delta->field + delta->field_len, data, n);
+                delta->field_len += n;
+                data += n;
+                len -= n;
+                if (delta->field_len < delta->field_need) {
+                    break;
+                }
+                if (delta->stage == DELTA_STAGE_HEADER) {
+                    err = parse_header(delta);
+                    delta->stage = DELTA_STAGE_OPCODE;
+                } else {
+                    err = run_op(delta);
+                }
+                break;
+            }
+
+            case DELTA_STAGE_OPCODE:
+                delta->op = *data++;
+                len--;
+                delta->field_len = 0;
+                if (delta->op == DELTA_OP_COPY) {
+                    delta->field_need = 8;
+                    delta->stage = DELTA_STAGE_ARGS;
+                } else if (delta->op == DELTA_OP_INSERT) {
+                    delta->field_need = 4;
+                    delta->stage = DELTA_STAGE_ARGS;
+                } else if (delta->op == DELTA_OP_END) {
+                    delta->stage = DELTA_STAGE_DONE;
+                } else {
+                    ESP_LOGE(TAG, "Unknown patch op 0x%02x", delta->op);
+                    err = ESP_ERR_INVALID_RESPONSE;
+                }
+                break;
+
+            case DELTA_STAGE_INSERT: {
+                size_t n = (len < delta->remaining) ? len : delta->remaining;
+                err = write_output(delta, data, n);
+                data += n;
+                len -= n;
+                delta->remaining -= n;
+                if (delta->remaining == 0) {
+                    delta->stage = DELTA_STAGE_OPCODE;
+                }
+                break;
+            }
+
+            default:
+                // END 之后不应再有数据
+                ESP_LOGE(TAG, "Trailing data after END");
+                err = ESP_ERR_INVALID_RESPONSE;
+                break;
+        }
+    }
+
+    return err;
+}
+
+esp_err_t xn_ota_delta_finish(const xn_ota_delta_t *delta)
+{
+    if (delta->stage != DELTA_STAGE_DONE || delta->written != delta->target_size) {
+        ESP_LOGE(TAG, "Patch incomplete: written=%u target=%u",
+                 (unsigned)delta->written, (unsigned)delta->target_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,123 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-24
+ * @Description: OTA 差分补丁 - 边下载边把补丁应用到 OTA 分区（组件内部使用）
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved.
+ */
+
+#ifndef XN_OTA_DELTA_H
+#define XN_OTA_DELTA_H
+
+#include "esp_err.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ========================================================================== */
+/*                              补丁格式                                        */
+/* ========================================================================== */
+
+/*
+ * 补丁按顺序描述目标固件，所有整数均为小端：
+ *
+ *   头部 16 字节: "XNDP" | base_size(u32) | base_crc32(u32) | target_size(u32)
+ *   指令序列:
+ *     0x01 COPY   src_offset(u32) len(u32)   从当前运行分区复制 len 字节
+ *     0x02 INSERT len(u32) data[len]         写入补丁中携带的新数据
+ *     0x00 END                               补丁结束
+ *
+ * base_crc32 为运行分区前 base_size 字节的 CRC32（与 zlib crc32 相同），
+ * 用于确认设备上的固件与生成补丁时的基准固件完全一致。
+ */
+
+#define XN_OTA_DELTA_MAGIC          "XNDP"  ///< 补丁文件标识
+#define XN_OTA_DELTA_HEADER_SIZE    16      ///< 补丁头部长度
+#define XN_OTA_DELTA_COPY_BUF_SIZE  1024    ///< COPY 指令读取基准分区的缓冲大小
+
+/* ========================================================================== */
+/*                              类型定义                                        */
+/* ========================================================================== */
+
+/**
+ * @brief 目标数据输出回调，每段数据写入目标分区成功后调用
+ *
+ * @param ctx 调用 xn_ota_delta_begin 时传入的上下文
+ * @param data 已写入的数据
+ * @param len 数据长度
+ */
+typedef void (*xn_ota_delta_output_t)(void *ctx, const uint8_t *data, size_t len);
+
+/**
+ * @brief 差分补丁应用上下文
+ */
+typedef struct {
+    const esp_partition_t *base;            ///< 基准分区（当前运行分区）
+    esp_ota_handle_t ota_handle;            ///< 目标分区写入句柄
+    xn_ota_delta_output_t on_output;        ///< 输出回调（可为 NULL）
+    void *output_ctx;                       ///< 输出回调上下文
+    uint8_t stage;                          ///< 解析阶段
+    uint8_t op;                             ///< 当前指令
+    uint8_t field[XN_OTA_DELTA_HEADER_SIZE];///< 头部/指令参数拼接缓冲
+    size_t field_len;                       ///< 已拼接的字节数
+    size_t field_need;                      ///< 当前阶段需要的字节数
+    uint32_t base_size;                     ///< 基准固件大小
+    uint32_t target_size;                   ///< 目标固件大小
+    uint32_t remaining;                     ///< INSERT 剩余字节数
+    uint32_t written;                       ///< 已写入目标分区的字节数
+    uint8_t copy_buf[XN_OTA_DELTA_COPY_BUF_SIZE]; ///< COPY 读取缓冲
+} xn_ota_delta_t;
+
+/* ========================================================================== */
+/*                              内部API                                        */
+/* ========================================================================== */
+
+/**
+ * @brief 初始化补丁应用上下文
+ *
+ * @param delta 上下文
+ * @param base 基准分区（当前运行分区）
+ * @param ota_handle 已 esp_ota_begin 的目标分区句柄
+ * @param on_output 输出回调，用于计算生成镜像的摘要（可为 NULL）
+ * @param output_ctx 输出回调上下文
+ */
+void xn_ota_delta_begin(xn_ota_delta_t *delta, const esp_partition_t *base, esp_ota_handle_t ota_handle,
+                        xn_ota_delta_output_t on_output, void *output_ctx);
+
+/**
+ * @brief 输入一段补丁数据，解析出的指令立即写入目标分区
+ *
+ * 数据可以按任意长度分段输入。
+ *
+ * @param delta 上下文
+ * @param data 补丁数据
+ * @param len 数据长度
+ * @return esp_err_t
+ *      - ESP_OK: 成功
+ *      - ESP_ERR_INVALID_VERSION: 基准固件与补丁不匹配
+ *      - ESP_ERR_INVALID_RESPONSE: 补丁格式错误
+ *      - ESP_ERR_INVALID_SIZE: 指令越界
+ *      - 其他: Flash 读写错误
+ */
+esp_err_t xn_ota_delta_feed(xn_ota_delta_t *delta, const uint8_t *data, size_t len);
+
+/**
+ * @brief 检查补丁是否完整应用
+ *
+ * @param delta 上下文
+ * @return esp_err_t
+ *      - ESP_OK: 已读到 END 且写满目标大小
+ *      - ESP_ERR_INVALID_SIZE: 补丁不完整
+ */
+esp_err_t xn_ota_delta_finish(const xn_ota_delta_t *delta);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XN_OTA_DELTA_H */
@@ -0,0 +1,367 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-24
+ * @Description: OTA 流式 JSON 解析实现 - 逐字符状态机，不构建 DOM
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved.
+ */
+
+#include "xn_ota_json.h"
+#include <string.h>
+
+/* 词法状态 */
+enum {
+    JSON_ST_VALUE = 0,          // 等待值
+    JSON_ST_VALUE_OR_END,       // '[' 之后：等待值或 ']'
+    JSON_ST_KEY_OR_END,         // '{' 之后：等待键或 '}'
+    JSON_ST_KEY,                // ',' 之后：等待键
+    JSON_ST_COLON,              // 等待 ':'
+    JSON_ST_COMMA_OR_END,       // 等待 ',' 或容器结束
+    JSON_ST_STRING,             // 字符串内
+    JSON_ST_ESCAPE,             // 转义字符
+    JSON_ST_UNICODE,            // \uXXXX
+    JSON_ST_LITERAL,            // 数字 / true / false / null
+    JSON_ST_DONE,               // 根值已结束
+};
+
+/* ========================================================================== */
+/*                              内部函数                                        */
+/* ========================================================================== */
+
+/**
+ * @brief 是否为空白字符
+ */
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/**
+ * @brief 向当前键/值追加一个字符，超长部分丢弃
+ */
+static void token_put(xn_ota_json_t *json, char c)
+{
+    if (json->token_len < XN_OTA_JSON_TOKEN_MAX - 1) {
+        json->token[json->token_len++] = c;
+    }
+}
+
+/**
+ * @brief 把 \uXXXX 码点按 UTF-8 追加（代理对以 '?' 代替）
+ */
+static void token_put_unicode(xn_ota_json_t *json, uint16_t cp)
+{
+    if (cp < 0x80) {
+        token_put(json, (char)cp);
+    } else if (cp < 0x800) {
+        token_put(json, (char)(0xC0 | (cp >> 6)));
+        token_put(json, (char)(0x80 | (cp & 0x3F)));
+    } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+        token_put(json, '?');
+    } else {
+        token_put(json, (char)(0xE0 | (cp >> 12)));
+        token_put(json, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        token_put(json, (char)(0x80 | (cp & 0x3F)));
+    }
+}
+
+/**
+ * @brief 回调一个字段
+ */
+static void emit(xn_ota_json_t *json, const char *value, xn_ota_json_type_t type)
+{
+    if (json->cb != NULL) {
+        json->cb(json->path, value, type, json->ctx);
+    }
+}
+
+/**
+ * @brief 一个值结束：对象成员恢复父路径，根值结束则文档完成
+ */
+static void value_done(xn_ota_json_t *json)
+{
+    if (json->depth == 0) {
+        json->state = JSON_ST_DONE;
+        return;
+    }
+    if (json->stack[json->depth - 1] == '{') {
+        json->path_len = json->key_mark[json->depth - 1];
+        json->path[json->path_len] = '\0';
+    }
+    json->state = JSON_ST_COMMA_OR_END;
+}
+
+/**
+ * @brief 进入对象或数组
+ */
+static bool container_open(xn_ota_json_t *json, char c)
+{
+    if (json->depth >= XN_OTA_JSON_MAX_DEPTH) {
+        return false;
+    }
+    json->stack[json->depth++] = c;
+    if (c == '{') {
+        emit(json, "", XN_OTA_JSON_OBJECT);
+        json->state = JSON_ST_KEY_OR_END;
+    } else {
+        json->state = JSON_ST_VALUE_OR_END;
+    }
+    return true;
+}
+
+/**
+ * @brief 离开对象或数组，括号必须匹配
+ */
+static bool container_close(xn_ota_json_t *json, char c)
+{
+    char open = (c == '}') ? '{' : '[';
+    if (json->depth == 0 || json->stack[json->depth - 1] != open) {
+        return false;
+    }
+    json->depth--;
+    value_done(json);
+    return true;
+}
+
+/**
+ * @brief 开始读取一个值
+ */
+static bool value_begin(xn_ota_json_t *json, char c)
+{
+    if (c == '{' || c == '[') {
+        return container_open(json, c);
+    }
+    json->token_len = 0;
+    if (c == '"') {
+        json->is_key = false;
+        json->state = JSON_ST_STRING;
+        return true;
+    }
+    if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+        token_put(json, c);
+        json->state = JSON_ST_LITERAL;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 字符串结束：键追加到路径，值直接回调
+ */
+static void string_done(xn_ota_json_t *json)
+{
+    json->token[json->token_len] = '\0';
+    if (!json->is_key) {
+        emit(json, json->token, XN_OTA_JSON_STRING);
+        value_done(json);
+        return;
+    }
+
+    // 路径放不下时截断，截断后的路径不会匹配任何已知字段
+    json->key_mark[json->depth - 1] = json->path_len;
+    size_t room = XN_OTA_JSON_PATH_MAX - 1 - json->path_len;
+    if (json->path_len > 0 && room > 0) {
+        json->path[json->path_len++] = '.';
+        room--;
+    }
+    size_t n = (json->token_len < room) ? json->token_len : room;
+    memcpy(json->path + json->path_len, json->token, n);
+    json->path_len += n;
+    json->path[json->path_len] = '\0';
+    json->state = JSON_ST_COLON;
+}
+
+/**
+ * @brief 数字或字面量结束
+ */
+static bool literal_done(xn_ota_json_t *json)
+{
+    json->token[json->token_len] = '\0';
+    xn_ota_json_type_t type;
+    if (strcmp(json->token, "true") == 0 || strcmp(json->token, "false") == 0) {
+        type = XN_OTA_JSON_BOOL;
+    } else if (strcmp(json->token, "null") == 0) {
+        type = XN_OTA_JSON_NULL;
+    } else if (json->token[0] == '-' || (json->token[0] >= '0' && json->token[0] <= '9')) {
+        type = XN_OTA_JSON_NUMBER;
+    } else {
+        return false;
+    }
+    emit(json, json->token, type);
+    value_done(json);
+    return true;
+}
+
+/**
+ * @brief 十六进制字符转数值，非法返回 -1
+ */
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ * @brief 处理一个字符
+ *
+ * @return int 1 已消费，0 需要在新状态下重新处理，-1 语法错误
+ */
+static int step(xn_ota_json_t *json, char c)
+{
+    switch (json->state) {
+        case JSON_ST_VALUE:
+        case JSON_ST_VALUE_OR_END:
+            if (is_space(c)) {
+                return 1;
+            }
+            if (json->state == JSON_ST_VALUE_OR_END && c == ']') {
+                return container_close(json, c) ? 1 : -1;
+            }
+            return value_begin(json, c) ? 1 : -1;
+
+        case JSON_ST_KEY_OR_END:
+        case JSON_ST_KEY:
+            if (is_space(c)) {
+                return 1;
+            }
+            if (json->state == JSON_ST_KEY_OR_END && c == '}') {
+                return container_close(json, c) ? 1 : -1;
+            }
+            if (c != '"') {
+                return -1;
+            }
+            json->is_key = true;
+            json->token_len = 0;
+            json->state = JSON_ST_STRING;
+            return 1;
+
+        case JSON_ST_COLON:
+            if (is_space(c)) {
+                return 1;
+            }
+            if (c != ':') {
+                return -1;
+            }
+            json->state = JSON_ST_VALUE;
+            return 1;
+
+        case JSON_ST_COMMA_OR_END:
+            if (is_space(c)) {
+                return 1;
+            }
+            if (c == ',') {
+                json->state = (json->stack[json->depth - 1] == '{') ? JSON_ST_KEY : JSON_ST_VALUE;
+                return 1;
+            }
+            if (c == '}' || c == ']') {
+                return container_close(json, c) ? 1 : -1;
+            }
+            return -1;
+
+        case JSON_ST_STRING:
+            if (c == '"') {
+                string_done(json);
+            } else if (c == '\\') {
+                json->state = JSON_ST_ESCAPE;
+            } else if ((unsigned char)c < 0x20) {
+                return -1;
+            } else {
+                token_put(json, c);
+            }
+            return 1;
+
+        case JSON_ST_ESCAPE: {
+            const char *from = "\"\\/bfnrt";
+            const char *to = "\"\\/\b\f\n\r\t";
+            const char *p = (c != '\0') ? strchr(from, c) : NULL;
+            if (c == 'u') {
+                json->unicode = 0;
+                json->unicode_len = 0;
+                json->state = JSON_ST_UNICODE;
+                return 1;
+            }
+            if (p == NULL) {
+                return -1;
+            }
+            token_put(json, to[p - from]);
+            json->state = JSON_ST_STRING;
+            return 1;
+        }
+
+        case JSON_ST_UNICODE: {
+            int v = hex_value(c);
+            if (v < 0) {
+                return -1;
+            }
+            json->unicode = (uint16_t)((json->unicode << 4) | v);
+            if (++json->unicode_len == 4) {
+                token_put_unicode(json, json->unicode);
+                json->state = JSON_ST_STRING;
+            }
+            return 1;
+        }
+
+        case JSON_ST_LITERAL:
+            if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                c == '+' || c == '-' || c == '.') {
+                token_put(json, c);
+                return 1;
+            }
+            // 分隔符结束字面量，分隔符本身在新状态下重新处理
+            return literal_done(json) ? 0 : -1;
+
+        default:
+            // 根值之后只允许空白
+            return is_space(c) ? 1 : -1;
+    }
+}
+
+/* ========================================================================== */
+/*                              内部API实现                                     */
+/* ========================================================================== */
+
+void xn_ota_json_init(xn_ota_json_t *json, xn_ota_json_cb_t cb, void *ctx)
+{
+    memset(json, 0, sizeof(*json));
+    json->cb = cb;
+    json->ctx = ctx;
+    json->state = JSON_ST_VALUE;
+}
+
+esp_err_t xn_ota_json_feed(xn_ota_json_t *json, const char *data, size_t len)
+{
+    if (json->failed) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    size_t i = 0;
+    while (i < len) {
+        int r = step(json, data[i]);
+        if (r < 0) {
+            json->failed = true;
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        i += r;
+    }
+    return ESP_OK;
+}
+
+esp_err_t xn_ota_json_finish(xn_ota_json_t *json)
+{
+    // 根值为数字/字面量时没有后续分隔符，在这里结束
+    if (!json->failed && json->state == JSON_ST_LITERAL && json->depth == 0) {
+        json->failed = !literal_done(json);
+    }
+    if (json->failed || json->state != JSON_ST_DONE) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,116 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-24
+ * @Description: OTA 流式 JSON 解析 - 分段输入、固定内存、按路径回调字段（组件内部使用）
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved.
+ */
+
+#ifndef XN_OTA_JSON_H
+#define XN_OTA_JSON_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ========================================================================== */
+/*                              常量定义                                        */
+/* ========================================================================== */
+
+#define XN_OTA_JSON_MAX_DEPTH       8       ///< 最大嵌套层数
+#define XN_OTA_JSON_PATH_MAX        96      ///< 字段路径最大长度（如 "firmware.version"）
+#define XN_OTA_JSON_TOKEN_MAX       256     ///< 单个键/值最大长度，超出部分截断
+
+/* ========================================================================== */
+/*                              类型定义                                        */
+/* ========================================================================== */
+
+/**
+ * @brief 字段值类型
+ */
+typedef enum {
+    XN_OTA_JSON_STRING = 0,                 ///< 字符串（已去转义）
+    XN_OTA_JSON_NUMBER,                     ///< 数字（原文）
+    XN_OTA_JSON_BOOL,                       ///< true / false
+    XN_OTA_JSON_NULL,                       ///< null
+    XN_OTA_JSON_OBJECT,                     ///< 对象开始（value 为空串）
+} xn_ota_json_type_t;
+
+/**
+ * @brief 字段回调
+ *
+ * 对象成员的路径用 '.' 连接键名；数组元素沿用数组本身的路径。
+ *
+ * @param path 字段路径
+ * @param value 字段值文本
+ * @param type 字段类型
+ * @param ctx 用户上下文
+ */
+typedef void (*xn_ota_json_cb_t)(const char *path, const char *value,
+                                 xn_ota_json_type_t type, void *ctx);
+
+/**
+ * @brief 流式解析器状态
+ */
+typedef struct {
+    xn_ota_json_cb_t cb;                    ///< 字段回调
+    void *ctx;                              ///< 回调上下文
+    uint8_t state;                          ///< 词法状态
+    uint8_t depth;                          ///< 当前嵌套层数
+    bool is_key;                            ///< 正在读取的字符串是否为键
+    bool failed;                            ///< 是否出现语法错误
+    uint8_t unicode_len;                    ///< \uXXXX 已读取的十六进制位数
+    uint16_t unicode;                       ///< \uXXXX 码点
+    char stack[XN_OTA_JSON_MAX_DEPTH];      ///< 容器类型栈 ('{' / '[')
+    uint8_t key_mark[XN_OTA_JSON_MAX_DEPTH];///< 各层对象追加键名前的路径长度
+    char path[XN_OTA_JSON_PATH_MAX];        ///< 当前字段路径
+    size_t path_len;                        ///< 路径长度
+    char token[XN_OTA_JSON_TOKEN_MAX];      ///< 当前键/值
+    size_t token_len;                       ///< 当前键/值长度
+} xn_ota_json_t;
+
+/* ========================================================================== */
+/*                              内部API                                        */
+/* ========================================================================== */
+
+/**
+ * @brief 初始化解析器
+ *
+ * @param json 解析器
+ * @param cb 字段回调
+ * @param ctx 回调上下文
+ */
+void xn_ota_json_init(xn_ota_json_t *json, xn_ota_json_cb_t cb, void *ctx);
+
+/**
+ * @brief 输入一段 JSON 文本，可按任意长度分段
+ *
+ * @param json 解析器
+ * @param data 文本
+ * @param len 长度
+ * @return esp_err_t
+ *      - ESP_OK: 成功
+ *      - ESP_ERR_INVALID_RESPONSE: 语法错误或嵌套过深
+ */
+esp_err_t xn_ota_json_feed(xn_ota_json_t *json, const char *data, size_t len);
+
+/**
+ * @brief 输入结束，检查文档是否完整
+ *
+ * @param json 解析器
+ * @return esp_err_t
+ *      - ESP_OK: 文档完整
+ *      - ESP_ERR_INVALID_RESPONSE: 文档不完整或有语法错误
+ */
+esp_err_t xn_ota_json_finish(xn_ota_json_t *json);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XN_OTA_JSON_H */
@@ -0,0 +1,147 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-26 14:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-26 14:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_player\include\xn_player.h
+ * @Description: 语音播放组件头文件 - 抖动缓冲、Opus 解码与 I2S 输出
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_PLAYER_H
+#define XN_PLAYER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ *                          类型定义
+ *===========================================================================*/
+
+/**
+ * @brief 播放事件
+ */
+typedef enum {
+    XN_PLAYER_EVENT_START,              ///< 语音段首个采样写入 I2S（first_audio_ms 有效）
+    XN_PLAYER_EVENT_UNDERRUN,           ///< 抖动缓冲耗尽，暂停并重新预缓冲
+    XN_PLAYER_EVENT_END,                ///< 语音段播放结束（END 包、空闲超时或被新语音段打断）
+} xn_player_event_t;
+
+/**
+ * @brief 单个语音段的播放统计
+ */
+typedef struct {
+    uint16_t session;                   ///< 语音段编号（来自包头）
+    uint32_t frames_played;             ///< 已播放帧数（含补静音的帧）
+    uint32_t underruns;                 ///< 缓冲耗尽次数
+    uint32_t overruns;                  ///< 超出缓冲容量被丢弃的帧数
+    uint32_t late;                      ///< 晚于播放点到达被丢弃的帧数
+    uint32_t lost;                      ///< 播放时缺失、以静音补齐的帧数
+    uint32_t first_audio_ms;            ///< 首包到达至首个采样写入 I2S 的时间
+    uint32_t buffer_max_ms;             ///< 抖动缓冲最高水位
+} xn_player_stats_t;
+
+/**
+ * @brief 播放事件回调（在播放任务中执行，不能阻塞）
+ */
+typedef void (*xn_player_event_cb_t)(xn_player_event_t event, const xn_player_stats_t *stats, void *user_data);
+
+/**
+ * @brief 播放配置
+ */
+typedef struct {
+    // I2S 配置
+    int i2s_port;                       ///< I2S 端口号（默认1，端口0留给麦克风）
+    int pin_bclk;                       ///< BCLK 引脚
+    int pin_ws;                         ///< WS(LRCLK) 引脚
+    int pin_dout;                       ///< 数据输出引脚
+    uint32_t sample_rate;               ///< 采样率（默认16000）
+    uint16_t frame_ms;                  ///< Opus 帧时长：20/40/60，需与下行包一致（默认20）
+    uint8_t dma_desc_num;               ///< DMA 描述符数（默认4）
+    uint16_t dma_frame_num;             ///< 每个 DMA 描述符的采样数（默认 1/2 帧）
+
+    // 抖动缓冲
+    uint8_t prebuffer_frames;           ///< 缓冲到多少帧开始播放（默认3），决定首音延迟与抗抖动能力
+    uint16_t buffer_frames;             ///< 缓冲容量（默认50），下行快于实时时超出部分丢弃
+    uint16_t max_frame_bytes;           ///< 单个 Opus 帧最大长度（默认256）
+    uint16_t idle_timeout_ms;           ///< 未收到 END 时无新数据多久结束语音段（默认1000）
+
+    // 播放任务
+    int task_core;                      ///< 运行核心（默认1，tskNO_AFFINITY 不绑定）
+    uint8_t task_priority;              ///< 任务优先级（默认15）
+    uint32_t task_stack_size;           ///< 任务栈大小（默认8192）
+
+    xn_player_event_cb_t event_cb;      ///< 播放事件回调，可为NULL
+    void *user_data;                    ///< 播放事件回调用户数据
+} xn_player_config_t;
+
+/*===========================================================================
+ *                          API
+ *===========================================================================*/
+
+/**
+ * @brief 获取默认配置（引脚需由调用者填写）
+ */
+xn_player_config_t xn_player_get_default_config(void);
+
+/**
+ * @brief 初始化播放：创建 I2S 发送通道、Opus 解码器、抖动缓冲与播放任务
+ *
+ * @param config 配置
+ * @return esp_err_t
+ *      - ESP_OK: 成功
+ *      - ESP_ERR_INVALID_STATE: 已初始化
+ *      - ESP_ERR_INVALID_ARG: 配置无效
+ *      - ESP_ERR_NO_MEM: 内存不足
+ *      - ESP_FAIL: 解码器创建失败
+ */
+esp_err_t xn_player_init(const xn_player_config_t *config);
+
+/**
+ * @brief 反初始化，停止播放并释放资源
+ */
+esp_err_t xn_player_deinit(void);
+
+/**
+ * @brief 送入一个下行语音包（格式同 xn_voice.h），拷贝进抖动缓冲后立即返回
+ *
+ * 可在网络接收任务中直接调用。新的语音段编号打断正在播放的语音段；
+ * 旧语音段的迟到包、重复帧、超出容量的帧被丢弃并计数。
+ *
+ * @param packet 包数据
+ * @param len 包长度
+ * @return esp_err_t
+ *      - ESP_OK: 成功（帧可能因迟到或溢出被丢弃，见统计）
+ *      - ESP_ERR_INVALID_STATE: 未初始化
+ *      - ESP_ERR_INVALID_ARG: 包格式错误或帧时长不一致
+ *      - ESP_ERR_INVALID_SIZE: 帧长度超过 max_frame_bytes
+ */
+esp_err_t xn_player_feed(const uint8_t *packet, size_t len);
+
+/**
+ * @brief 停止当前语音段并清空抖动缓冲
+ */
+esp_err_t xn_player_stop(void);
+
+/**
+ * @brief 是否有语音段在缓冲或播放
+ */
+bool xn_player_is_active(void);
+
+/**
+ * @brief 读取当前（或最近一个）语音段的统计
+ */
+esp_err_t xn_player_get_stats(xn_player_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // XN_PLAYER_H
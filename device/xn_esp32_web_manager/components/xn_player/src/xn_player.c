@@ -0,0 +1,650 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-26 14:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-26 14:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_player\src\xn_player.c
+ * @Description: 语音播放组件实现 - 接收侧写入抖动缓冲，播放任务按 I2S DMA 节奏取帧解码输出
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "xn_player.h"
+#include "xn_voice.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "driver/i2s_std.h"
+#include "esp_opus_dec.h"
+
+static const char *TAG = "xn_player";
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+/**
+ * @brief 抖动缓冲槽位，帧序号 index 存放在 index % buffer_frames
+ */
+typedef struct {
+    uint32_t index;                     ///< 帧序号（段内时间戳 / 每帧采样数）
+    uint16_t len;                       ///< Opus 数据长度
+    bool valid;                         ///< 槽位有数据
+} jitter_slot_t;
+
+/**
+ * @brief 播放任务每一步的动作
+ */
+typedef enum {
+    STEP_IDLE,                          ///< 没有语音段，等待数据
+    STEP_WAIT,                          ///< 预缓冲中，等待数据或超时
+    STEP_PLAY,                          ///< 取到一帧，解码输出
+    STEP_SILENCE,                       ///< 本帧缺失，输出静音
+    STEP_UNDERRUN,                      ///< 缓冲耗尽，转入预缓冲
+    STEP_END,                           ///< 语音段结束
+} play_step_t;
+
+typedef struct {
+    bool initialized;                   ///< 初始化标志
+    volatile bool exit;                 ///< 播放任务退出请求
+    xn_player_config_t config;          ///< 配置信息
+    size_t frame_samples;               ///< 每帧采样数
+
+    i2s_chan_handle_t tx;               ///< I2S 发送通道
+    void *decoder;                      ///< Opus 解码器句柄
+    TaskHandle_t task;                  ///< 播放任务
+    SemaphoreHandle_t exit_sem;         ///< 播放任务退出完成
+    SemaphoreHandle_t lock;             ///< 抖动缓冲与统计保护锁
+
+    // 抖动缓冲（lock 保护）
+    jitter_slot_t *slots;               ///< 槽位表
+    uint8_t *data;                      ///< 槽位数据（buffer_frames x max_frame_bytes）
+    uint16_t buffered;                  ///< 有数据的槽位数
+    bool has_session;                   ///< 收到过语音段
+    bool active;                        ///< 语音段缓冲或播放中
+    bool playing;                       ///< 播放中（否则为预缓冲）
+    bool started;                       ///< 已上报 START
+    bool ended;                         ///< 收到 END 包
+    uint16_t session;                   ///< 当前语音段编号
+    uint16_t prev_session;              ///< 上一个语音段编号（丢弃其迟到包）
+    uint32_t play_index;                ///< 下一个播放的帧序号
+    uint32_t end_index;                 ///< END 包之后的帧序号
+    uint32_t max_index;                 ///< 已收到的最大帧序号 + 1
+    int64_t first_rx_us;                ///< 首包到达时间
+    int64_t last_rx_us;                 ///< 最近一包到达时间
+    xn_player_stats_t stats;            ///< 当前语音段统计
+    bool prev_pending;                  ///< 被打断的语音段尚未上报 END
+    xn_player_stats_t prev_stats;       ///< 被打断的语音段统计
+
+    // 播放任务缓冲区
+    uint8_t *frame_buf;                 ///< 取出的 Opus 帧
+    uint16_t frame_len;                 ///< 取出的 Opus 帧长度
+    int16_t *pcm;                       ///< 解码输出
+} xn_player_ctx_t;
+
+static xn_player_ctx_t s_ctx;
+
+/*===========================================================================
+ *                          抖动缓冲（调用者持有 lock）
+ *===========================================================================*/
+
+static uint16_t get_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief 清空抖动缓冲
+ */
+static void jitter_clear(void)
+{
+    for (uint16_t i = 0; i < s_ctx.config.buffer_frames; i++) {
+        s_ctx.slots[i].valid = false;
+    }
+    s_ctx.buffered = 0;
+}
+
+/**
+ * @brief 结束当前语音段，统计留给播放任务上报 END
+ */
+static void session_abort(void)
+{
+    if (!s_ctx.active) {
+        return;
+    }
+    s_ctx.prev_stats = s_ctx.stats;
+    s_ctx.prev_pending = true;
+    s_ctx.active = false;
+    jitter_clear();
+}
+
+/**
+ * @brief 开始新的语音段（打断正在播放的语音段）
+ */
+static void session_begin(uint16_t session, int64_t now_us)
+{
+    session_abort();
+    if (s_ctx.has_session) {
+        s_ctx.prev_session = s_ctx.session;
+    }
+    s_ctx.has_session = true;
+    s_ctx.session = session;
+    s_ctx.active = true;
+    s_ctx.playing = false;
+    s_ctx.started = false;
+    s_ctx.ended = false;
+    s_ctx.play_index = 0;
+    s_ctx.end_index = 0;
+    s_ctx.max_index = 0;
+    s_ctx.first_rx_us = now_us;
+    memset(&s_ctx.stats, 0, sizeof(s_ctx.stats));
+    s_ctx.stats.session = session;
+}
+
+/**
+ * @brief 帧放入抖动缓冲
+ */
+static void jitter_put(uint32_t index, const uint8_t *data, uint16_t len)
+{
+    if (index < s_ctx.play_index) {
+        s_ctx.stats.late++;
+        return;
+    }
+    if (index >= s_ctx.play_index + s_ctx.config.buffer_frames) {
+        s_ctx.stats.overruns++;
+        return;
+    }
+
+    jitter_slot_t *slot = &s_ctx.slots[index % s_ctx.config.buffer_frames];
+    if (slot->valid) {
+        // 同一窗口内一个槽位只对应一个帧序号，有数据即为重复包
+        return;
+    }
+    memcpy(s_ctx.data + (size_t)(index % s_ctx.config.buffer_frames) * s_ctx.config.max_frame_bytes, data, len);
+    slot->index = index;
+    slot->len = len;
+    slot->valid = true;
+    s_ctx.buffered++;
+    if (index + 1 > s_ctx.max_index) {
+        s_ctx.max_index = index + 1;
+    }
+}
+
+/**
+ * @brief 决定播放任务的下一步，PLAY 时帧被拷贝到 frame_buf
+ */
+static play_step_t jitter_take(int64_t now_us)
+{
+    if (!s_ctx.active) {
+        return STEP_IDLE;
+    }
+
+    bool idle = (now_us - s_ctx.last_rx_us) >= (int64_t)s_ctx.config.idle_timeout_ms * 1000;
+    if (!s_ctx.playing) {
+        if (s_ctx.buffered == 0 && (s_ctx.ended || idle)) {
+            s_ctx.active = false;
+            return STEP_END;
+        }
+        if (s_ctx.buffered < s_ctx.config.prebuffer_frames && !s_ctx.ended && !idle) {
+            return STEP_WAIT;
+        }
+        s_ctx.playing = true;
+    }
+
+    if (s_ctx.ended && s_ctx.play_index >= s_ctx.end_index) {
+        s_ctx.active = false;
+        return STEP_END;
+    }
+
+    jitter_slot_t *slot = &s_ctx.slots[s_ctx.play_index % s_ctx.config.buffer_frames];
+    if (slot->valid && slot->index == s_ctx.play_index) {
+        memcpy(s_ctx.frame_buf,
+               s_ctx.data + (size_t)(s_ctx.play_index % s_ctx.config.buffer_frames) * s_ctx.config.max_frame_bytes,
+               slot->len);
+        s_ctx.frame_len = slot->len;
+        slot->valid = false;
+        s_ctx.buffered--;
+        s_ctx.play_index++;
+        s_ctx.stats.frames_played++;
+        return STEP_PLAY;
+    }
+
+    if (s_ctx.buffered == 0 && !s_ctx.ended) {
+        if (idle) {
+            s_ctx.active = false;
+            return STEP_END;
+        }
+        s_ctx.playing = false;
+        s_ctx.stats.underruns++;
+        return STEP_UNDERRUN;
+    }
+
+    // 后面还有帧（或已收到 END）时缺失的帧补静音，不等待
+    s_ctx.play_index++;
+    s_ctx.stats.lost++;
+    s_ctx.stats.frames_played++;
+    return STEP_SILENCE;
+}
+
+/*===========================================================================
+ *                          播放任务
+ *===========================================================================*/
+
+static void notify_event(xn_player_event_t event, const xn_player_stats_t *stats)
+{
+    if (s_ctx.config.event_cb) {
+        s_ctx.config.event_cb(event, stats, s_ctx.config.user_data);
+    }
+}
+
+/**
+ * @brief 解码 frame_buf 到 pcm，失败时输出静音
+ */
+static void decode_frame(void)
+{
+    size_t pcm_bytes = s_ctx.frame_samples * sizeof(int16_t);
+    esp_audio_dec_in_raw_t raw = {
+        .buffer = s_ctx.frame_buf,
+        .len = s_ctx.frame_len,
+    };
+    esp_audio_dec_out_frame_t out = {
+        .buffer = (uint8_t *)s_ctx.pcm,
+        .len = pcm_bytes,
+    };
+    esp_audio_dec_info_t info;
+
+    if (esp_opus_dec_decode(s_ctx.decoder, &raw, &out, &info) != ESP_AUDIO_ERR_OK) {
+        memset(s_ctx.pcm, 0, pcm_bytes);
+        return;
+    }
+    if (out.decoded_size < pcm_bytes) {
+        memset((uint8_t *)s_ctx.pcm + out.decoded_size, 0, pcm_bytes - out.decoded_size);
+    }
+}
+
+/**
+ * @brief 播放任务：I2S 写入阻塞到 DMA 有空位，播放节奏由 DMA 决定
+ */
+static void player_task(void *arg)
+{
+    (void)arg;
+    const size_t pcm_bytes = s_ctx.frame_samples * sizeof(int16_t);
+    TickType_t wait = portMAX_DELAY;
+    xn_player_stats_t stats;
+
+    while (!s_ctx.exit) {
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        for (;;) {
+            if (s_ctx.exit) {
+                break;
+            }
+
+            xSemaphoreTake(s_ctx.lock, portMAX_DELAY);
+            if (s_ctx.prev_pending) {
+                s_ctx.prev_pending = false;
+                stats = s_ctx.prev_stats;
+                xSemaphoreGive(s_ctx.lock);
+                notify_event(XN_PLAYER_EVENT_END, &stats);
+                continue;
+            }
+            play_step_t step = jitter_take(esp_timer_get_time());
+            bool first = !s_ctx.started && (step == STEP_PLAY || step == STEP_SILENCE);
+            if (first) {
+                s_ctx.started = true;
+            }
+            stats = s_ctx.stats;
+            xSemaphoreGive(s_ctx.lock);
+
+            if (step == STEP_IDLE) {
+                wait = portMAX_DELAY;
+                break;
+            }
+            if (step == STEP_WAIT) {
+                // 定时醒来检查空闲超时
+                wait = pdMS_TO_TICKS(s_ctx.config.idle_timeout_ms);
+                break;
+            }
+            if (step == STEP_UNDERRUN || step == STEP_END) {
+                ESP_LOGD(TAG, "Session %u %s", stats.session, step == STEP_END ? "end" : "underrun");
+                notify_event(step == STEP_END ? XN_PLAYER_EVENT_END : XN_PLAYER_EVENT_UNDERRUN, &stats);
+                continue;
+            }
+
+            if (step == STEP_PLAY) {
+                decode_frame();
+            } else {
+                memset(s_ctx.pcm, 0, pcm_bytes);
+            }
+            size_t written = 0;
+            i2s_channel_write(s_ctx.tx, s_ctx.pcm, pcm_bytes, &written, portMAX_DELAY);
+
+            if (first) {
+                xSemaphoreTake(s_ctx.lock, portMAX_DELAY);
+                s_ctx.stats.first_audio_ms = (uint32_t)((esp_timer_get_time() - s_ctx.first_rx_us) / 1000);
+                stats = s_ctx.stats;
+                xSemaphoreGive(s_ctx.lock);
+                notify_event(XN_PLAYER_EVENT_START, &stats);
+            }
+        }
+    }
+
+    xSemaphoreGive(s_ctx.exit_sem);
+    vTaskDelete(NULL);
+}
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 创建并配置 I2S 发送通道（DMA 无数据时自动输出静音）
+ */
+static esp_err_t i2s_tx_init(void)
+{
+    const xn_player_config_t *cfg = &s_ctx.config;
+
+    i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG((i2s_port_t)cfg->i2s_port, I2S_ROLE_MASTER);
+    chan_cfg.dma_desc_num = cfg->dma_desc_num;
+    chan_cfg.dma_frame_num = cfg->dma_frame_num;
+    chan_cfg.auto_clear = true;
+    esp_err_t ret = i2s_new_channel(&chan_cfg, &s_ctx.tx, NULL);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    i2s_std_config_t std_cfg = {
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(cfg->sample_rate),
+        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO),
+        .gpio_cfg = {
+            .mclk = I2S_GPIO_UNUSED,
+            .bclk = cfg->pin_bclk,
+            .ws = cfg->pin_ws,
+            .dout = cfg->pin_dout,
+            .din = I2S_GPIO_UNUSED,
+        },
+    };
+    ret = i2s_channel_init_std_mode(s_ctx.tx, &std_cfg);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return i2s_channel_enable(s_ctx.tx);
+}
+
+/**
+ * @brief 创建 Opus 解码器
+ */
+static esp_err_t decoder_init(void)
+{
+    const xn_player_config_t *cfg = &s_ctx.config;
+    esp_opus_dec_cfg_t opus_cfg = ESP_OPUS_DEC_CONFIG_DEFAULT();
+    opus_cfg.sample_rate = cfg->sample_rate;
+    opus_cfg.channel = 1;
+    switch (cfg->frame_ms) {
+    case 20:
+        opus_cfg.frame_duration = ESP_OPUS_DEC_FRAME_DURATION_20_MS;
+        break;
+    case 40:
+        opus_cfg.frame_duration = ESP_OPUS_DEC_FRAME_DURATION_40_MS;
+        break;
+    default:
+        opus_cfg.frame_duration = ESP_OPUS_DEC_FRAME_DURATION_60_MS;
+        break;
+    }
+    opus_cfg.self_delimited = false;
+
+    if (esp_opus_dec_open(&opus_cfg, sizeof(opus_cfg), &s_ctx.decoder) != ESP_AUDIO_ERR_OK) {
+        s_ctx.decoder = NULL;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+xn_player_config_t xn_player_get_default_config(void)
+{
+    xn_player_config_t config = {
+        .i2s_port = 1,
+        .pin_bclk = -1,
+        .pin_ws = -1,
+        .pin_dout = -1,
+        .sample_rate = 16000,
+        .frame_ms = 20,
+        .dma_desc_num = 4,
+        .dma_frame_num = 0,
+        .prebuffer_frames = 3,
+        .buffer_frames = 50,
+        .max_frame_bytes = 256,
+        .idle_timeout_ms = 1000,
+        .task_core = 1,
+        .task_priority = 15,
+        .task_stack_size = 8192,
+        .event_cb = NULL,
+        .user_data = NULL,
+    };
+    return config;
+}
+
+esp_err_t xn_player_init(const xn_player_config_t *config)
+{
+    if (s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (config == NULL || config->pin_bclk < 0 || config->pin_ws < 0 || config->pin_dout < 0 ||
+        config->sample_rate == 0 || (config->frame_ms != 20 && config->frame_ms != 40 && config->frame_ms != 60) ||
+        config->dma_desc_num < 2 || config->buffer_frames == 0 || config->max_frame_bytes == 0 ||
+        config->prebuffer_frames > config->buffer_frames) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(&s_ctx, 0, sizeof(s_ctx));
+    s_ctx.config = *config;
+    s_ctx.frame_samples = (size_t)config->sample_rate * config->frame_ms / 1000;
+    if (s_ctx.config.dma_frame_num == 0) {
+        s_ctx.config.dma_frame_num = s_ctx.frame_samples / 2;
+    }
+    // 单个 DMA 描述符最多 4092 字节
+    if (s_ctx.frame_samples == 0 || s_ctx.config.dma_frame_num * sizeof(int16_t) > 4092) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_ctx.initialized = true;
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    s_ctx.slots = calloc(config->buffer_frames, sizeof(jitter_slot_t));
+    s_ctx.data = malloc((size_t)config->buffer_frames * config->max_frame_bytes);
+    s_ctx.frame_buf = malloc(config->max_frame_bytes);
+    s_ctx.pcm = malloc(s_ctx.frame_samples * sizeof(int16_t));
+    s_ctx.lock = xSemaphoreCreateMutex();
+    s_ctx.exit_sem = xSemaphoreCreateBinary();
+    if (s_ctx.slots == NULL || s_ctx.data == NULL || s_ctx.frame_buf == NULL || s_ctx.pcm == NULL ||
+        s_ctx.lock == NULL || s_ctx.exit_sem == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate jitter buffer");
+        goto err;
+    }
+
+    ret = decoder_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open Opus decoder");
+        goto err;
+    }
+
+    ret = i2s_tx_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to init I2S: %s", esp_err_to_name(ret));
+        goto err;
+    }
+
+    if (xTaskCreatePinnedToCore(player_task, "xn_player", config->task_stack_size, NULL,
+                                config->task_priority, &s_ctx.task, config->task_core) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create player task");
+        ret = ESP_ERR_NO_MEM;
+        goto err;
+    }
+
+    ESP_LOGI(TAG, "Player initialized: %u Hz, %u ms frames, prebuffer %u, buffer %u frames",
+             (unsigned)config->sample_rate, config->frame_ms, config->prebuffer_frames, config->buffer_frames);
+    return ESP_OK;
+
+err:
+    xn_player_deinit();
+    return ret;
+}
+
+esp_err_t xn_player_deinit(void)
+{
+    if (!s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (s_ctx.task) {
+        s_ctx.exit = true;
+        xTaskNotifyGive(s_ctx.task);
+        xSemaphoreTake(s_ctx.exit_sem, portMAX_DELAY);
+        s_ctx.task = NULL;
+    }
+    if (s_ctx.tx) {
+        i2s_channel_disable(s_ctx.tx);
+        i2s_del_channel(s_ctx.tx);
+        s_ctx.tx = NULL;
+    }
+    if (s_ctx.decoder) {
+        esp_opus_dec_close(s_ctx.decoder);
+        s_ctx.decoder = NULL;
+    }
+    if (s_ctx.lock) {
+        vSemaphoreDelete(s_ctx.lock);
+        s_ctx.lock = NULL;
+    }
+    if (s_ctx.exit_sem) {
+        vSemaphoreDelete(s_ctx.exit_sem);
+        s_ctx.exit_sem = NULL;
+    }
+    free(s_ctx.slots);
+    free(s_ctx.data);
+    free(s_ctx.frame_buf);
+    free(s_ctx.pcm);
+    s_ctx.slots = NULL;
+    s_ctx.data = NULL;
+    s_ctx.frame_buf = NULL;
+    s_ctx.pcm = NULL;
+    s_ctx.initialized = false;
+    return ESP_OK;
+}
+
+esp_err_t xn_player_feed(const uint8_t *packet, size_t len)
+{
+    if (!s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (packet == NULL || len < XN_VOICE_HEADER_SIZE || packet[0] != XN_VOICE_PACKET_MAGIC ||
+        packet[1] != XN_VOICE_PACKET_VERSION || packet[3] != s_ctx.config.frame_ms) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t flags = packet[2];
+    uint16_t session = get_le16(&packet[4]);
+    uint32_t timestamp = get_le32(&packet[8]);
+    uint8_t count = packet[12];
+
+    // 先校验全部帧长度，避免半个包进入缓冲
+    size_t offset = XN_VOICE_HEADER_SIZE;
+    for (uint8_t i = 0; i < count; i++) {
+        if (offset + 2 > len) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        uint16_t frame_len = get_le16(&packet[offset]);
+        if (frame_len > s_ctx.config.max_frame_bytes) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        offset += 2 + frame_len;
+        if (offset > len) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    uint32_t index = timestamp / s_ctx.frame_samples;
+    xSemaphoreTake(s_ctx.lock, portMAX_DELAY);
+
+    if (s_ctx.has_session && (session == s_ctx.prev_session || (session == s_ctx.session && !s_ctx.active))) {
+        // 已结束或被打断的语音段的迟到包
+        xSemaphoreGive(s_ctx.lock);
+        return ESP_OK;
+    }
+    if (!s_ctx.has_session || session != s_ctx.session) {
+        session_begin(session, now_us);
+    }
+
+    offset = XN_VOICE_HEADER_SIZE;
+    for (uint8_t i = 0; i < count; i++) {
+        uint16_t frame_len = get_le16(&packet[offset]);
+        jitter_put(index + i, &packet[offset + 2], frame_len);
+        offset += 2 + frame_len;
+    }
+    if (flags & XN_VOICE_FLAG_END) {
+        s_ctx.ended = true;
+        s_ctx.end_index = index + count;
+    }
+    s_ctx.last_rx_us = now_us;
+
+    uint32_t level_ms = (s_ctx.max_index - s_ctx.play_index) * s_ctx.config.frame_ms;
+    if (s_ctx.max_index > s_ctx.play_index && level_ms > s_ctx.stats.buffer_max_ms) {
+        s_ctx.stats.buffer_max_ms = level_ms;
+    }
+    xSemaphoreGive(s_ctx.lock);
+
+    xTaskNotifyGive(s_ctx.task);
+    return ESP_OK;
+}
+
+esp_err_t xn_player_stop(void)
+{
+    if (!s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_ctx.lock, portMAX_DELAY);
+    session_abort();
+    xSemaphoreGive(s_ctx.lock);
+    xTaskNotifyGive(s_ctx.task);
+    return ESP_OK;
+}
+
+bool xn_player_is_active(void)
+{
+    if (!s_ctx.initialized) {
+        return false;
+    }
+
+    xSemaphoreTake(s_ctx.lock, portMAX_DELAY);
+    bool active = s_ctx.active;
+    xSemaphoreGive(s_ctx.lock);
+    return active;
+}
+
+esp_err_t xn_player_get_stats(xn_player_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_ctx.lock, portMAX_DELAY);
+    *stats = s_ctx.stats;
+    xSemaphoreGive(s_ctx.lock);
+    return ESP_OK;
+}
@@ -0,0 +1,141 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-28 16:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-28 16:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_sched\include\xn_sched.h
+ * @Description: 共享调度器头文件 - 定时轮 + 单工作任务，按到期时间执行延时与周期作业
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_SCHED_H
+#define XN_SCHED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ *                          类型定义
+ *===========================================================================*/
+
+/**
+ * @brief 作业回调（在调度器工作任务中执行）
+ *
+ * 所有作业共用一个任务，回调应尽快返回，不要长时间阻塞；
+ * 需要等待的工作改为在回调中重新安排自己。
+ */
+typedef void (*xn_sched_cb_t)(void *arg);
+
+/**
+ * @brief 作业（由调用者分配，调度器不做动态分配）
+ *
+ * 除 cb/arg/name 外的字段由调度器维护，调用者不要直接访问。
+ */
+typedef struct xn_sched_job {
+    xn_sched_cb_t cb;                   ///< 回调
+    void *arg;                          ///< 回调参数
+    const char *name;                   ///< 名称（慢作业告警与统计用）
+    struct xn_sched_job *next;          ///< 所在链表的下一个作业
+    struct xn_sched_job **pprev;        ///< 指向前一个作业的 next（或链表头），NULL 表示未安排
+    TickType_t expires;                 ///< 到期时刻(tick)
+    TickType_t period;                  ///< 周期(tick)，0 表示单次
+    uint8_t list;                       ///< 所在链表（内部使用）
+} xn_sched_job_t;
+
+/**
+ * @brief 作业静态初始化
+ */
+#define XN_SCHED_JOB_INIT(_cb, _arg, _name) { .cb = (_cb), .arg = (_arg), .name = (_name) }
+
+/**
+ * @brief 调度器统计
+ */
+typedef struct {
+    uint32_t runs;                      ///< 已执行的作业次数
+    uint32_t late;                      ///< 晚于到期时刻一个 tick 以上才执行的次数
+    uint32_t max_run_us;                ///< 单次回调最长耗时(us)
+    const char *max_run_name;           ///< 最长耗时的作业名
+    uint16_t pending;                   ///< 当前已安排的作业数
+} xn_sched_stats_t;
+
+/*===========================================================================
+ *                          API
+ *===========================================================================*/
+
+/**
+ * @brief 初始化调度器并创建工作任务（重复调用直接返回 ESP_OK）
+ *
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_NO_MEM 任务或锁创建失败
+ */
+esp_err_t xn_sched_init(void);
+
+/**
+ * @brief 初始化作业
+ *
+ * @param job 作业
+ * @param cb 回调
+ * @param arg 回调参数
+ * @param name 名称（需长期有效）
+ */
+void xn_sched_job_init(xn_sched_job_t *job, xn_sched_cb_t cb, void *arg, const char *name);
+
+/**
+ * @brief 安排作业在 delay_ms 后执行一次
+ *
+ * 作业已安排时取两者中较早的到期时刻，因此多处可以放心地各自请求"最晚在某时刻执行"；
+ * 周期作业被提前执行后从执行时刻重新计算周期。delay_ms 为 0 时尽快执行（延后工作）。
+ * 可以在任意任务和作业回调中调用，不能在中断中调用。
+ *
+ * @param job 作业
+ * @param delay_ms 延时(ms)，不足一个 tick 的部分向上取整
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t xn_sched_schedule(xn_sched_job_t *job, uint32_t delay_ms);
+
+/**
+ * @brief 按固定周期执行作业，第一次在一个周期后执行
+ *
+ * 到期时刻按周期累加，不因回调耗时漂移；错过的周期不补执行。
+ * 作业已安排时重新开始计时。
+ *
+ * @param job 作业
+ * @param period_ms 周期(ms)，必须大于0
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_ARG 周期为0，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t xn_sched_start_periodic(xn_sched_job_t *job, uint32_t period_ms);
+
+/**
+ * @brief 取消作业（周期作业同时停止）
+ *
+ * 不等待正在执行的回调；回调中调用可以取消自己的下一次执行。
+ *
+ * @param job 作业
+ * @return true 取消前处于已安排状态
+ */
+bool xn_sched_cancel(xn_sched_job_t *job);
+
+/**
+ * @brief 作业是否已安排（等待执行中）
+ */
+bool xn_sched_is_pending(const xn_sched_job_t *job);
+
+/**
+ * @brief 获取统计
+ *
+ * @param stats 输出
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_ARG 参数为空，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t xn_sched_get_stats(xn_sched_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XN_SCHED_H */
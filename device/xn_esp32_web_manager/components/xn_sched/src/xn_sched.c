@@ -0,0 +1,383 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-28 16:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-28 16:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_sched\src\xn_sched.c
+ * @Description: 共享调度器实现 - 近期作业放定时轮、远期作业放有序溢出链表，工作任务睡到最早到期时刻
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include "xn_sched.h"
+#include "sdkconfig.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "xn_sched";
+
+/*===========================================================================
+ *                          内部数据
+ *===========================================================================*/
+
+#define SCHED_SLOTS             (1u << CONFIG_XN_SCHED_WHEEL_BITS)  ///< 定时轮槽数（每槽一个 tick）
+#define SCHED_SLOT_MASK         (SCHED_SLOTS - 1)
+#define SCHED_MAX_DELAY_TICKS   ((TickType_t)0x3FFFFFFF)            ///< 最大延时，保证有符号比较不回绕
+
+/**
+ * @brief 作业所在链表
+ */
+enum {
+    SCHED_LIST_NONE = 0,                ///< 未安排
+    SCHED_LIST_READY,                   ///< 已到期，按先后顺序等待执行
+    SCHED_LIST_WHEEL,                   ///< 定时轮：到期时刻在 [s_cursor, s_cursor + SCHED_SLOTS) 内
+    SCHED_LIST_OVERFLOW,                ///< 溢出链表：更远的作业，按到期时刻排序
+};
+
+static xn_sched_job_t *s_ready = NULL;                      // 已到期链表头
+static xn_sched_job_t **s_ready_tail = &s_ready;            // 已到期链表尾（指向最后一个作业的 next）
+static xn_sched_job_t *s_wheel[SCHED_SLOTS];                // 定时轮，每槽中的作业到期时刻相同
+static xn_sched_job_t *s_overflow = NULL;                   // 溢出链表头（最早到期）
+static uint16_t s_wheel_count = 0;                          // 定时轮中的作业数
+static uint16_t s_pending = 0;                              // 已安排的作业总数
+static TickType_t s_cursor = 0;                             // 定时轮当前 tick，之前的槽已处理完
+
+static TaskHandle_t s_task = NULL;                          // 工作任务
+static SemaphoreHandle_t s_lock = NULL;                     // 链表与统计保护锁
+static bool s_sleeping = false;                             // 工作任务正在等待
+static bool s_wake_forever = false;                         // 等待没有超时
+static TickType_t s_wake_at = 0;                            // 等待的超时时刻
+static xn_sched_stats_t s_stats;                            // 统计
+
+/*===========================================================================
+ *                          内部函数（需持有 s_lock）
+ *===========================================================================*/
+
+/**
+ * @brief a 是否早于 b（tick 回绕安全）
+ */
+static inline bool tick_before(TickType_t a, TickType_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+/**
+ * @brief ms 转 tick，向上取整
+ */
+static TickType_t ms_to_ticks(uint32_t ms)
+{
+    uint64_t ticks = ((uint64_t)ms * configTICK_RATE_HZ + 999) / 1000;
+    return (ticks > SCHED_MAX_DELAY_TICKS) ? SCHED_MAX_DELAY_TICKS : (TickType_t)ticks;
+}
+
+/**
+ * @brief 插入到 *pos 之前
+ */
+static void link_at(xn_sched_job_t **pos, xn_sched_job_t *job)
+{
+    job->next = *pos;
+    if (job->next != NULL) {
+        job->next->pprev = &job->next;
+    }
+    *pos = job;
+    job->pprev = pos;
+}
+
+/**
+ * @brief 从所在链表中摘除
+ */
+static void unlink_job(xn_sched_job_t *job)
+{
+    if (job->list == SCHED_LIST_READY && s_ready_tail == &job->next) {
+        s_ready_tail = job->pprev;
+    }
+    if (job->list == SCHED_LIST_WHEEL) {
+        s_wheel_count--;
+    }
+    *job->pprev = job->next;
+    if (job->next != NULL) {
+        job->next->pprev = job->pprev;
+    }
+    job->next = NULL;
+    job->pprev = NULL;
+    job->list = SCHED_LIST_NONE;
+    s_pending--;
+}
+
+/**
+ * @brief 按到期时刻放入对应链表：已到期的排队，一个轮周期内的进轮，更远的进溢出链表
+ */
+static void place_job(xn_sched_job_t *job, TickType_t now)
+{
+    if (!tick_before(now, job->expires)) {
+        job->next = NULL;
+        job->pprev = s_ready_tail;
+        *s_ready_tail = job;
+        s_ready_tail = &job->next;
+        job->list = SCHED_LIST_READY;
+    } else if ((int32_t)(job->expires - s_cursor) < (int32_t)SCHED_SLOTS) {
+        link_at(&s_wheel[job->expires & SCHED_SLOT_MASK], job);
+        job->list = SCHED_LIST_WHEEL;
+        s_wheel_count++;
+    } else {
+        xn_sched_job_t **pos = &s_overflow;
+        while (*pos != NULL && !tick_before(job->expires, (*pos)->expires)) {
+            pos = &(*pos)->next;
+        }
+        link_at(pos, job);
+        job->list = SCHED_LIST_OVERFLOW;
+    }
+    s_pending++;
+}
+
+/**
+ * @brief 新安排的作业早于工作任务的唤醒时刻时唤醒它
+ */
+static void kick(const xn_sched_job_t *job)
+{
+    if (!s_sleeping || (!s_wake_forever && !tick_before(job->expires, s_wake_at))) {
+        return;
+    }
+    s_wake_forever = false;
+    s_wake_at = job->expires;
+    xTaskNotifyGive(s_task);
+}
+
+/**
+ * @brief 取出一个到期作业，没有时返回 NULL
+ *
+ * 定时轮推进到 now 为止；轮中没有作业时直接跳到 now 之后，不逐槽空转。
+ */
+static xn_sched_job_t *pop_due(TickType_t now)
+{
+    for (;;) {
+        // 溢出链表中进入一个轮周期的作业下放到轮中（已到期的直接排队）
+        while (s_overflow != NULL && (int32_t)(s_overflow->expires - s_cursor) < (int32_t)SCHED_SLOTS) {
+            xn_sched_job_t *job = s_overflow;
+            unlink_job(job);
+            place_job(job, now);
+        }
+
+        if (s_ready != NULL) {
+            xn_sched_job_t *job = s_ready;
+            unlink_job(job);
+            return job;
+        }
+        if (tick_before(now, s_cursor)) {
+            return NULL;
+        }
+
+        xn_sched_job_t *job = s_wheel[s_cursor & SCHED_SLOT_MASK];
+        if (job != NULL) {
+            unlink_job(job);
+            return job;
+        }
+        s_cursor = (s_wheel_count == 0) ? now + 1 : s_cursor + 1;
+    }
+}
+
+/**
+ * @brief 距下一个到期时刻的 tick 数，没有作业时返回 portMAX_DELAY
+ */
+static TickType_t next_wait(TickType_t now)
+{
+    if (s_ready != NULL) {
+        return 0;
+    }
+
+    bool found = false;
+    TickType_t next = 0;
+    for (uint32_t i = 0; s_wheel_count > 0 && i < SCHED_SLOTS; i++) {
+        if (s_wheel[(s_cursor + i) & SCHED_SLOT_MASK] != NULL) {
+            next = s_cursor + i;
+            found = true;
+            break;
+        }
+    }
+    if (s_overflow != NULL && (!found || tick_before(s_overflow->expires, next))) {
+        next = s_overflow->expires;
+        found = true;
+    }
+
+    if (!found) {
+        return portMAX_DELAY;
+    }
+    return tick_before(now, next) ? next - now : 0;
+}
+
+/*===========================================================================
+ *                          工作任务
+ *===========================================================================*/
+
+/**
+ * @brief 工作任务：依次执行到期作业，没有到期作业时睡到最早的到期时刻
+ */
+static void sched_task(void *arg)
+{
+    (void)arg;
+
+    for (;;) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        s_sleeping = false;
+        TickType_t now = xTaskGetTickCount();
+        xn_sched_job_t *job = pop_due(now);
+        if (job == NULL) {
+            TickType_t wait = next_wait(now);
+            s_sleeping = true;
+            s_wake_forever = (wait == portMAX_DELAY);
+            s_wake_at = now + wait;
+            xSemaphoreGive(s_lock);
+            ulTaskNotifyTake(pdTRUE, wait);
+            continue;
+        }
+
+        if (now - job->expires > 1) {
+            s_stats.late++;
+        }
+        // 周期作业先按周期重新安排，回调中可以取消或提前
+        if (job->period > 0) {
+            TickType_t next = job->expires + job->period;
+            job->expires = tick_before(now, next) ? next : now + job->period;
+            place_job(job, now);
+        }
+        xn_sched_cb_t cb = job->cb;
+        void *cb_arg = job->arg;
+        const char *name = job->name;
+        s_stats.runs++;
+        xSemaphoreGive(s_lock);
+
+        int64_t start = esp_timer_get_time();
+        cb(cb_arg);
+        uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start);
+
+        if (elapsed_us > s_stats.max_run_us) {
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            s_stats.max_run_us = elapsed_us;
+            s_stats.max_run_name = name;
+            xSemaphoreGive(s_lock);
+        }
+        if (elapsed_us > CONFIG_XN_SCHED_SLOW_JOB_MS * 1000) {
+            ESP_LOGW(TAG, "Job %s ran %u ms, delaying other jobs",
+                     name ? name : "?", (unsigned)(elapsed_us / 1000));
+        }
+    }
+}
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+esp_err_t xn_sched_init(void)
+{
+    if (s_task != NULL) {
+        return ESP_OK;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_cursor = xTaskGetTickCount();
+
+    if (xTaskCreate(sched_task, "xn_sched", CONFIG_XN_SCHED_TASK_STACK, NULL,
+                    CONFIG_XN_SCHED_TASK_PRIORITY, &s_task) != pdPASS) {
+        vSemaphoreDelete(s_lock);
+        s_lock = NULL;
+        s_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Scheduler started: %u slots x %u ms", (unsigned)SCHED_SLOTS,
+             (unsigned)(1000 / configTICK_RATE_HZ));
+    return ESP_OK;
+}
+
+void xn_sched_job_init(xn_sched_job_t *job, xn_sched_cb_t cb, void *arg, const char *name)
+{
+    *job = (xn_sched_job_t)XN_SCHED_JOB_INIT(cb, arg, name);
+}
+
+esp_err_t xn_sched_schedule(xn_sched_job_t *job, uint32_t delay_ms)
+{
+    if (s_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    TickType_t ticks = ms_to_ticks(delay_ms);
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    TickType_t now = xTaskGetTickCount();
+    TickType_t expires = now + ticks;
+    // 已安排得更早时保持不变
+    if (job->pprev == NULL || tick_before(expires, job->expires)) {
+        if (job->pprev != NULL) {
+            unlink_job(job);
+        }
+        job->expires = expires;
+        place_job(job, now);
+        kick(job);
+    }
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
+
+esp_err_t xn_sched_start_periodic(xn_sched_job_t *job, uint32_t period_ms)
+{
+    if (period_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    TickType_t period = ms_to_ticks(period_ms);
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (job->pprev != NULL) {
+        unlink_job(job);
+    }
+    TickType_t now = xTaskGetTickCount();
+    job->period = period;
+    job->expires = now + period;
+    place_job(job, now);
+    kick(job);
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
+
+bool xn_sched_cancel(xn_sched_job_t *job)
+{
+    if (s_task == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool pending = (job->pprev != NULL);
+    if (pending) {
+        unlink_job(job);
+    }
+    job->period = 0;
+    xSemaphoreGive(s_lock);
+    return pending;
+}
+
+bool xn_sched_is_pending(const xn_sched_job_t *job)
+{
+    return job->pprev != NULL;
+}
+
+esp_err_t xn_sched_get_stats(xn_sched_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    stats->pending = s_pending;
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
@@ -0,0 +1,168 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_speech\include\xn_speech.h
+ * @Description: 本地语音识别组件头文件 - ESP-SR 唤醒词 + 离线命令词，每块处理耗时对照 CPU 预算
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_SPEECH_H
+#define XN_SPEECH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ *                          类型定义
+ *===========================================================================*/
+
+#define XN_SPEECH_MAX_COMMANDS  32      ///< 最多注册的命令词数
+
+/**
+ * @brief 命令词
+ *
+ * phrase 为模型语言对应的写法：中文模型用空格分隔的拼音（如 "guan bi ping mu"），
+ * 英文模型用大写音素串或单词。多个 phrase 可以使用同一个 id。
+ */
+typedef struct {
+    int id;                             ///< 命令 ID（> 0），识别结果原样返回
+    const char *phrase;                 ///< 命令词
+} xn_speech_command_t;
+
+/**
+ * @brief 识别事件
+ */
+typedef enum {
+    XN_SPEECH_EVENT_WAKE = 0,           ///< 检测到唤醒词，进入命令词窗口
+    XN_SPEECH_EVENT_COMMAND,            ///< 识别到命令词，回到唤醒词检测
+    XN_SPEECH_EVENT_TIMEOUT,            ///< 命令词窗口超时，回到唤醒词检测
+} xn_speech_event_t;
+
+/**
+ * @brief 识别结果
+ */
+typedef struct {
+    xn_speech_event_t event;            ///< 事件
+    int command_id;                     ///< 命令 ID（仅 COMMAND 有效）
+    int wake_word;                      ///< 唤醒词序号（仅 WAKE 有效，从1开始）
+    float prob;                         ///< 命令词置信度（仅 COMMAND 有效）
+    uint32_t latency_ms;                ///< 送入识别的最后一个采样被采集到给出结果的时间
+} xn_speech_result_t;
+
+/**
+ * @brief 识别结果回调（在识别任务中执行，应只投递事件）
+ */
+typedef void (*xn_speech_cb_t)(const xn_speech_result_t *result, void *user_data);
+
+/**
+ * @brief 识别统计（读取时计算平均值）
+ */
+typedef struct {
+    uint32_t chunks;                    ///< 已处理的音频块数
+    uint32_t chunk_ms;                  ///< 每块音频时长（由模型决定，16kHz 下通常 32ms）
+    uint32_t budget_us;                 ///< 每块 CPU 预算 = 块时长 x cpu_budget_pct（唤醒词块）
+    uint32_t process_avg_us;            ///< 每块平均处理耗时
+    uint32_t process_max_us;            ///< 每块最大处理耗时
+    uint32_t over_budget;               ///< 处理耗时超出预算的块数
+    uint32_t overflow_samples;          ///< 识别任务来不及处理、在采集侧丢弃的采样数
+    uint32_t wakes;                     ///< 唤醒次数
+    uint32_t commands;                  ///< 识别到的命令数
+    uint32_t timeouts;                  ///< 命令词窗口超时次数
+} xn_speech_stats_t;
+
+/**
+ * @brief 本地语音识别配置
+ */
+typedef struct {
+    // 模型
+    const char *model_partition;        ///< 模型分区名（默认 "model"）
+    const char *wakenet_name;           ///< 唤醒词模型名前缀或全名，NULL 取分区中第一个 WakeNet 模型
+    const char *multinet_language;      ///< 命令词模型语言（默认 "cn"，英文 "en"）
+    bool wake_aggressive;               ///< 唤醒更灵敏（召回高、误唤醒多），默认 false
+    uint16_t command_timeout_ms;        ///< 唤醒后等待命令词的时长（默认6000）
+
+    // 命令词
+    const xn_speech_command_t *commands; ///< 命令词表（init 时拷贝进模型，调用后可释放）
+    size_t command_count;               ///< 命令词数
+
+    // 缓冲与预算
+    uint16_t buffer_ms;                 ///< 采集侧到识别任务的 PCM 缓冲(ms)（默认200）
+    uint8_t cpu_budget_pct;             ///< 每块处理耗时占块时长的预算百分比（默认40）
+
+    // 识别任务
+    int task_core;                      ///< 运行核心（默认1，tskNO_AFFINITY 不绑定）
+    uint8_t task_priority;              ///< 任务优先级（默认8，低于采集与编码任务）
+    uint32_t task_stack_size;           ///< 任务栈大小（默认8192）
+
+    // 输出
+    xn_speech_cb_t result_cb;           ///< 识别结果回调，必填
+    void *user_data;                    ///< 回调用户数据
+} xn_speech_config_t;
+
+/*===========================================================================
+ *                          API
+ *===========================================================================*/
+
+/**
+ * @brief 获取默认配置（命令词表与回调需由调用者填写）
+ */
+xn_speech_config_t xn_speech_get_default_config(void);
+
+/**
+ * @brief 初始化本地识别：从模型分区加载 WakeNet/MultiNet，注册命令词，
+ *        创建识别任务并注册为 xn_audio 帧消费者
+ *
+ * 模型权重在初始化时从 flash 分区载入 PSRAM，需开启 CONFIG_SPIRAM。
+ * 采样率固定 16kHz，需与 xn_audio 一致。
+ *
+ * @param config 配置
+ * @return esp_err_t
+ *      - ESP_OK: 成功
+ *      - ESP_ERR_INVALID_STATE: 已初始化
+ *      - ESP_ERR_INVALID_ARG: 配置无效
+ *      - ESP_ERR_NOT_FOUND: 分区中没有所需模型
+ *      - ESP_ERR_NOT_SUPPORTED: 模型采样率不是 16kHz
+ *      - ESP_ERR_NO_MEM: 内存不足
+ *      - ESP_FAIL: 模型创建或命令词注册失败
+ */
+esp_err_t xn_speech_init(const xn_speech_config_t *config);
+
+/**
+ * @brief 反初始化，注销消费者、停止识别任务并释放模型
+ */
+esp_err_t xn_speech_deinit(void);
+
+/**
+ * @brief 暂停/恢复识别
+ *
+ * 暂停期间采集侧不再写入 PCM，识别任务空闲；恢复后从唤醒词检测重新开始。
+ * 用于本机播放语音时避免自唤醒（无回声消除）。
+ *
+ * @param pause true 暂停，false 恢复
+ */
+void xn_speech_pause(bool pause);
+
+/**
+ * @brief 读取识别统计
+ */
+esp_err_t xn_speech_get_stats(xn_speech_stats_t *stats);
+
+/**
+ * @brief 清零统计（块时长与预算保留）
+ */
+void xn_speech_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // XN_SPEECH_H
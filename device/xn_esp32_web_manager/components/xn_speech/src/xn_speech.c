@@ -0,0 +1,472 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_speech\src\xn_speech.c
+ * @Description: 本地语音识别组件实现 - 采集侧写入流缓冲，识别任务按模型块长运行 WakeNet/MultiNet
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "xn_speech.h"
+#include "xn_audio.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/stream_buffer.h"
+#include "freertos/semphr.h"
+#include "model_path.h"
+#include "esp_wn_iface.h"
+#include "esp_wn_models.h"
+#include "esp_mn_iface.h"
+#include "esp_mn_models.h"
+#include "esp_mn_speech_commands.h"
+
+static const char *TAG = "xn_speech";
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+#define SPEECH_SAMPLE_RATE      16000   ///< ESP-SR 模型输入采样率
+#define SPEECH_POLL_MS          100     ///< 等待 PCM 时检查退出标志的间隔
+
+typedef enum {
+    SPEECH_MODE_WAKE = 0,               ///< 唤醒词检测
+    SPEECH_MODE_COMMAND,                ///< 命令词窗口
+} speech_mode_t;
+
+typedef struct {
+    bool initialized;                   ///< 初始化标志
+    xn_speech_config_t config;          ///< 配置信息（命令词表指针 init 后不再使用）
+    srmodel_list_t *models;             ///< 模型分区中的模型列表
+    const esp_wn_iface_t *wakenet;      ///< WakeNet 接口
+    model_iface_data_t *wn_data;        ///< WakeNet 实例
+    esp_mn_iface_t *multinet;           ///< MultiNet 接口
+    model_iface_data_t *mn_data;        ///< MultiNet 实例
+    size_t wn_chunk;                    ///< WakeNet 每块采样数
+    size_t mn_chunk;                    ///< MultiNet 每块采样数
+    StreamBufferHandle_t stream;        ///< 采集侧到识别任务的 PCM 流缓冲（单写单读）
+    TaskHandle_t task;                  ///< 识别任务
+    SemaphoreHandle_t exit_sem;         ///< 识别任务退出完成
+    volatile bool stop;                 ///< 识别任务退出请求
+    volatile bool paused;               ///< 暂停识别（采集侧与识别任务都检查）
+
+    // 采集侧状态（只在采集任务中写）
+    volatile int64_t last_sample_us;    ///< 最近写入流缓冲的采样的采集时间
+
+    // 识别侧状态（只在识别任务中访问）
+    int16_t *chunk;                     ///< 一块 PCM
+    speech_mode_t mode;                 ///< 当前模式
+    bool was_paused;                    ///< 上一块时处于暂停
+
+    // 统计
+    xn_speech_stats_t stats;            ///< 统计（process_avg_us 读取时计算）
+    uint64_t process_total_us;          ///< 处理耗时累计
+} xn_speech_ctx_t;
+
+static xn_speech_ctx_t s_ctx;
+
+/*===========================================================================
+ *                          采集侧（xn_audio 采集任务中执行，不能阻塞）
+ *===========================================================================*/
+
+/**
+ * @brief 帧消费者：PCM 拷贝进流缓冲，写不下的部分丢弃并计数
+ */
+static void on_frame(const xn_audio_frame_t *frame, void *user_data)
+{
+    (void)user_data;
+
+    if (s_ctx.paused) {
+        return;
+    }
+
+    size_t bytes = frame->samples * sizeof(int16_t);
+    size_t sent = xStreamBufferSend(s_ctx.stream, frame->pcm, bytes, 0);
+    if (sent < bytes) {
+        s_ctx.stats.overflow_samples += (bytes - sent) / sizeof(int16_t);
+    }
+    s_ctx.last_sample_us = frame->timestamp_us +
+                           (int64_t)frame->samples * 1000000 / SPEECH_SAMPLE_RATE;
+}
+
+/*===========================================================================
+ *                          识别侧
+ *===========================================================================*/
+
+/**
+ * @brief 读满一块 PCM
+ *
+ * @return true 读满，false 收到退出或暂停请求（不完整的块丢弃）
+ */
+static bool read_chunk(size_t samples)
+{
+    size_t want = samples * sizeof(int16_t);
+    size_t got = 0;
+
+    while (got < want) {
+        if (s_ctx.stop || s_ctx.paused) {
+            return false;
+        }
+        got += xStreamBufferReceive(s_ctx.stream, (uint8_t *)s_ctx.chunk + got, want - got,
+                                    pdMS_TO_TICKS(SPEECH_POLL_MS));
+    }
+    return true;
+}
+
+/**
+ * @brief 结果延迟：当前时间减去刚处理完的最后一个采样的采集时间
+ *
+ * 流缓冲中尚未处理的采样晚于该采样，按积压时长扣除。
+ */
+static uint32_t result_latency_ms(void)
+{
+    size_t backlog = xStreamBufferBytesAvailable(s_ctx.stream) / sizeof(int16_t);
+    int64_t sample_us = s_ctx.last_sample_us - (int64_t)backlog * 1000000 / SPEECH_SAMPLE_RATE;
+    int64_t latency_us = esp_timer_get_time() - sample_us;
+
+    return latency_us > 0 ? (uint32_t)(latency_us / 1000) : 0;
+}
+
+/**
+ * @brief 切换到唤醒词检测
+ */
+static void enter_wake_mode(void)
+{
+    s_ctx.mode = SPEECH_MODE_WAKE;
+}
+
+/**
+ * @brief 切换到命令词窗口（清空 MultiNet 内部状态，窗口从此刻开始计时）
+ */
+static void enter_command_mode(void)
+{
+    s_ctx.multinet->clean(s_ctx.mn_data);
+    s_ctx.mode = SPEECH_MODE_COMMAND;
+}
+
+/**
+ * @brief 处理一块 PCM
+ */
+static void process_chunk(void)
+{
+    xn_speech_result_t result = {0};
+
+    if (s_ctx.mode == SPEECH_MODE_WAKE) {
+        wakeword_state_t state = s_ctx.wakenet->detect(s_ctx.wn_data, s_ctx.chunk);
+        if (state <= WAKENET_NO_DETECT) {
+            return;
+        }
+        enter_command_mode();
+        s_ctx.stats.wakes++;
+        result.event = XN_SPEECH_EVENT_WAKE;
+        result.wake_word = (int)state;
+    } else {
+        esp_mn_state_t state = s_ctx.multinet->detect(s_ctx.mn_data, s_ctx.chunk);
+        if (state == ESP_MN_STATE_DETECTED) {
+            esp_mn_results_t *mn_result = s_ctx.multinet->get_results(s_ctx.mn_data);
+            s_ctx.stats.commands++;
+            result.event = XN_SPEECH_EVENT_COMMAND;
+            result.command_id = mn_result->command_id[0];
+            result.prob = mn_result->prob[0];
+        } else if (state == ESP_MN_STATE_TIMEOUT) {
+            s_ctx.stats.timeouts++;
+            result.event = XN_SPEECH_EVENT_TIMEOUT;
+        } else {
+            return;
+        }
+        enter_wake_mode();
+    }
+
+    result.latency_ms = result_latency_ms();
+    s_ctx.config.result_cb(&result, s_ctx.config.user_data);
+}
+
+/**
+ * @brief 识别任务：按当前模型的块长读 PCM 并处理，记录每块耗时与超预算次数
+ */
+static void speech_task(void *arg)
+{
+    (void)arg;
+
+    while (!s_ctx.stop) {
+        if (s_ctx.paused) {
+            s_ctx.was_paused = true;
+            vTaskDelay(pdMS_TO_TICKS(SPEECH_POLL_MS));
+            continue;
+        }
+        if (s_ctx.was_paused) {
+            // 暂停前的残留音频与命令词窗口作废
+            s_ctx.was_paused = false;
+            xStreamBufferReset(s_ctx.stream);
+            enter_wake_mode();
+        }
+
+        size_t samples = s_ctx.mode == SPEECH_MODE_WAKE ? s_ctx.wn_chunk : s_ctx.mn_chunk;
+        if (!read_chunk(samples)) {
+            continue;
+        }
+
+        int64_t start = esp_timer_get_time();
+        process_chunk();
+        uint32_t cost = (uint32_t)(esp_timer_get_time() - start);
+
+        s_ctx.stats.chunks++;
+        s_ctx.process_total_us += cost;
+        if (cost > s_ctx.stats.process_max_us) {
+            s_ctx.stats.process_max_us = cost;
+        }
+        // 两个模型块长可能不同，预算按本块时长折算
+        uint32_t budget = (uint32_t)(samples * 1000000ULL / SPEECH_SAMPLE_RATE *
+                                     s_ctx.config.cpu_budget_pct / 100);
+        if (cost > budget) {
+            s_ctx.stats.over_budget++;
+        }
+    }
+
+    xSemaphoreGive(s_ctx.exit_sem);
+    vTaskDelete(NULL);
+}
+
+/*===========================================================================
+ *                          模型加载
+ *===========================================================================*/
+
+/**
+ * @brief 加载 WakeNet 与 MultiNet 并注册命令词
+ */
+static esp_err_t load_models(const xn_speech_config_t *config)
+{
+    s_ctx.models = esp_srmodel_init(config->model_partition);
+    if (s_ctx.models == NULL) {
+        ESP_LOGE(TAG, "No models in partition '%s'", config->model_partition);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    char *wn_name = esp_srmodel_filter(s_ctx.models, ESP_WN_PREFIX, config->wakenet_name);
+    char *mn_name = esp_srmodel_filter(s_ctx.models, ESP_MN_PREFIX, config->multinet_language);
+    if (wn_name == NULL || mn_name == NULL) {
+        ESP_LOGE(TAG, "Model not found: wakenet %s, multinet %s",
+                 wn_name ? wn_name : "-", mn_name ? mn_name : "-");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    s_ctx.wakenet = esp_wn_handle_from_name(wn_name);
+    s_ctx.multinet = esp_mn_handle_from_name(mn_name);
+    if (s_ctx.wakenet == NULL || s_ctx.multinet == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    s_ctx.wn_data = s_ctx.wakenet->create(wn_name, config->wake_aggressive ? DET_MODE_95 : DET_MODE_90);
+    s_ctx.mn_data = s_ctx.multinet->create(mn_name, config->command_timeout_ms);
+    if (s_ctx.wn_data == NULL || s_ctx.mn_data == NULL) {
+        ESP_LOGE(TAG, "Failed to create models");
+        return ESP_FAIL;
+    }
+
+    if (s_ctx.wakenet->get_samp_rate(s_ctx.wn_data) != SPEECH_SAMPLE_RATE) {
+        ESP_LOGE(TAG, "Unsupported wakenet sample rate %d", s_ctx.wakenet->get_samp_rate(s_ctx.wn_data));
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    s_ctx.wn_chunk = (size_t)s_ctx.wakenet->get_samp_chunksize(s_ctx.wn_data);
+    s_ctx.mn_chunk = (size_t)s_ctx.multinet->get_samp_chunksize(s_ctx.mn_data);
+
+    // 命令词写入 MultiNet（拷贝，调用后命令词表可释放）
+    if (esp_mn_commands_alloc(s_ctx.multinet, s_ctx.mn_data) != ESP_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_mn_commands_clear();
+    for (size_t i = 0; i < config->command_count; i++) {
+        if (esp_mn_commands_add(config->commands[i].id, config->commands[i].phrase) != ESP_OK) {
+            ESP_LOGE(TAG, "Invalid command phrase '%s'", config->commands[i].phrase);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    esp_mn_error_t *error = esp_mn_commands_update();
+    if (error != NULL) {
+        for (int i = 0; i < error->num; i++) {
+            ESP_LOGE(TAG, "Command %d '%s' rejected by model",
+                     error->phrases[i]->command_id, error->phrases[i]->string);
+        }
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "Loaded %s (chunk %u) + %s (chunk %u), %u commands",
+             wn_name, (unsigned)s_ctx.wn_chunk, mn_name, (unsigned)s_ctx.mn_chunk,
+             (unsigned)config->command_count);
+    return ESP_OK;
+}
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+xn_speech_config_t xn_speech_get_default_config(void)
+{
+    xn_speech_config_t config = {
+        .model_partition = "model",
+        .wakenet_name = NULL,
+        .multinet_language = ESP_MN_CHINESE,
+        .wake_aggressive = false,
+        .command_timeout_ms = 6000,
+        .commands = NULL,
+        .command_count = 0,
+        .buffer_ms = 200,
+        .cpu_budget_pct = 40,
+        .task_core = 1,
+        .task_priority = 8,
+        .task_stack_size = 8192,
+        .result_cb = NULL,
+        .user_data = NULL,
+    };
+    return config;
+}
+
+esp_err_t xn_speech_init(const xn_speech_config_t *config)
+{
+    if (s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (config == NULL || config->result_cb == NULL || config->model_partition == NULL ||
+        config->commands == NULL || config->command_count == 0 ||
+        config->command_count > XN_SPEECH_MAX_COMMANDS ||
+        config->cpu_budget_pct == 0 || config->cpu_budget_pct > 100) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(&s_ctx, 0, sizeof(s_ctx));
+    s_ctx.config = *config;
+    s_ctx.config.commands = NULL;
+
+    esp_err_t ret = load_models(config);
+    if (ret != ESP_OK) {
+        goto fail;
+    }
+
+    size_t max_chunk = s_ctx.wn_chunk > s_ctx.mn_chunk ? s_ctx.wn_chunk : s_ctx.mn_chunk;
+    size_t chunk_bytes = max_chunk * sizeof(int16_t);
+    size_t buffer_bytes = (size_t)config->buffer_ms * SPEECH_SAMPLE_RATE / 1000 * sizeof(int16_t);
+    if (buffer_bytes < chunk_bytes * 2) {
+        buffer_bytes = chunk_bytes * 2;
+    }
+
+    // 流缓冲与块缓冲放内部 RAM，采集任务写入不受 PSRAM 缓存未命中影响
+    s_ctx.chunk = heap_caps_malloc(chunk_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s_ctx.stream = xStreamBufferCreate(buffer_bytes, sizeof(int16_t));
+    s_ctx.exit_sem = xSemaphoreCreateBinary();
+    if (s_ctx.chunk == NULL || s_ctx.stream == NULL || s_ctx.exit_sem == NULL) {
+        ret = ESP_ERR_NO_MEM;
+        goto fail;
+    }
+
+    s_ctx.stats.chunk_ms = (uint32_t)(s_ctx.wn_chunk * 1000 / SPEECH_SAMPLE_RATE);
+    s_ctx.stats.budget_us = (uint32_t)(s_ctx.wn_chunk * 1000000ULL / SPEECH_SAMPLE_RATE *
+                                       config->cpu_budget_pct / 100);
+    s_ctx.mode = SPEECH_MODE_WAKE;
+
+    BaseType_t ok = xTaskCreatePinnedToCore(speech_task, "xn_speech", config->task_stack_size, NULL,
+                                            config->task_priority, &s_ctx.task,
+                                            config->task_core);
+    if (ok != pdPASS) {
+        s_ctx.task = NULL;
+        ret = ESP_ERR_NO_MEM;
+        goto fail;
+    }
+
+    s_ctx.initialized = true;
+    ret = xn_audio_register_consumer(on_frame, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register audio consumer: %s", esp_err_to_name(ret));
+        xn_speech_deinit();
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Speech initialized: chunk %u ms, budget %u us (%u%%), buffer %u bytes",
+             (unsigned)s_ctx.stats.chunk_ms, (unsigned)s_ctx.stats.budget_us,
+             config->cpu_budget_pct, (unsigned)buffer_bytes);
+    return ESP_OK;
+
+fail:
+    s_ctx.initialized = true;
+    xn_speech_deinit();
+    return ret;
+}
+
+esp_err_t xn_speech_deinit(void)
+{
+    if (!s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xn_audio_unregister_consumer(on_frame, NULL);
+    if (s_ctx.task) {
+        s_ctx.stop = true;
+        xSemaphoreTake(s_ctx.exit_sem, portMAX_DELAY);
+        s_ctx.task = NULL;
+    }
+
+    if (s_ctx.exit_sem) {
+        vSemaphoreDelete(s_ctx.exit_sem);
+        s_ctx.exit_sem = NULL;
+    }
+    if (s_ctx.stream) {
+        vStreamBufferDelete(s_ctx.stream);
+        s_ctx.stream = NULL;
+    }
+    free(s_ctx.chunk);
+    s_ctx.chunk = NULL;
+
+    if (s_ctx.mn_data) {
+        esp_mn_commands_free();
+        s_ctx.multinet->destroy(s_ctx.mn_data);
+        s_ctx.mn_data = NULL;
+    }
+    if (s_ctx.wn_data) {
+        s_ctx.wakenet->destroy(s_ctx.wn_data);
+        s_ctx.wn_data = NULL;
+    }
+    if (s_ctx.models) {
+        esp_srmodel_deinit(s_ctx.models);
+        s_ctx.models = NULL;
+    }
+
+    s_ctx.initialized = false;
+    return ESP_OK;
+}
+
+void xn_speech_pause(bool pause)
+{
+    s_ctx.paused = pause;
+}
+
+esp_err_t xn_speech_get_stats(xn_speech_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    *stats = s_ctx.stats;
+    stats->process_avg_us = s_ctx.stats.chunks ?
+                            (uint32_t)(s_ctx.process_total_us / s_ctx.stats.chunks) : 0;
+    return ESP_OK;
+}
+
+void xn_speech_reset_stats(void)
+{
+    uint32_t chunk_ms = s_ctx.stats.chunk_ms;
+    uint32_t budget_us = s_ctx.stats.budget_us;
+
+    memset(&s_ctx.stats, 0, sizeof(s_ctx.stats));
+    s_ctx.process_total_us = 0;
+    s_ctx.stats.chunk_ms = chunk_ms;
+    s_ctx.stats.budget_us = budget_us;
+}
@@ -4,11 +4,16 @@
  * 
  * 本组件提供了一个基于表驱动的有限状态机(FSM)实现。
  * 特点：
- * - 纯C实现，无操作系统依赖（但在多线程环境需注意同步）
+ * - 纯C实现，除异步任务外无操作系统依赖（但在多线程环境需注意同步）
+ * - 运行到完成(run-to-completion)：回调中投递的事件排队，待当前转换完成后再处理
+ * - 支持在独立任务中执行耗时工作，完成后以事件形式回到状态机
+ * - 支持父子状态（层次状态机），子状态未处理的事件向父状态冒泡
+ * - 支持状态超时，所有状态机共用一个 esp_timer；过期的超时事件按标签丢弃
  * - 支持状态入口(on_enter)、出口(on_exit)和运行(on_run)回调
  * - 支持带条件的转换(Guard)
  * - 支持转换动作(Action)
  * - 调试友好的状态名称支持
+ * - 初始化时将转换表编译为 [状态][事件] 跳转表，事件处理为常数时间查找
  */
 
 #ifndef XN_FSM_H
@@ -27,11 +32,31 @@ extern "C" {
  *===========================================================================*/
 
 #ifndef XN_FSM_MAX_STATES
-#define XN_FSM_MAX_STATES       16      ///< 支持的最大状态数（用于可能的静态分配场景，当前实现主要用于参考）
+#define XN_FSM_MAX_STATES       16      ///< 支持的最大状态数（决定跳转表行数）
+#endif
+
+#ifndef XN_FSM_MAX_EVENTS
+#define XN_FSM_MAX_EVENTS       32      ///< 转换表中不同事件ID的最大数量（决定跳转表列数）
 #endif
 
 #ifndef XN_FSM_MAX_TRANSITIONS
-#define XN_FSM_MAX_TRANSITIONS  32      ///< 支持的最大转换规则数
+#define XN_FSM_MAX_TRANSITIONS  32      ///< 支持的最大转换规则数（须小于 255）
+#endif
+
+#ifndef XN_FSM_EVENT_QUEUE_SIZE
+#define XN_FSM_EVENT_QUEUE_SIZE 8       ///< 转换过程中可排队的事件数
+#endif
+
+#ifndef XN_FSM_ASYNC_STACK_SIZE
+#define XN_FSM_ASYNC_STACK_SIZE 8192    ///< 异步工作任务栈大小（需容纳HTTP/TLS调用）
+#endif
+
+#ifndef XN_FSM_ASYNC_PRIORITY
+#define XN_FSM_ASYNC_PRIORITY   4       ///< 异步工作任务优先级
+#endif
+
+#ifndef XN_FSM_MAX_TIMEOUTS
+#define XN_FSM_MAX_TIMEOUTS     8       ///< 所有状态机同时计时的状态超时总数
 #endif
 
 #ifndef XN_FSM_NAME_LEN
@@ -48,6 +73,12 @@ typedef uint16_t xn_event_id_t;         ///< 事件ID类型
 #define XN_STATE_INVALID    ((xn_state_id_t)0xFFFF) ///< 无效状态ID
 #define XN_STATE_ANY        ((xn_state_id_t)0xFFFE) ///< 通配符状态ID，匹配任意状态
 
+#define XN_FSM_STATE_MAP_SIZE   (XN_FSM_MAX_STATES * 2) ///< 状态ID哈希表大小（负载不超过一半）
+#define XN_FSM_EVENT_MAP_SIZE   (XN_FSM_MAX_EVENTS * 2) ///< 事件ID哈希表大小（负载不超过一半）
+#define XN_FSM_NO_TRANSITION    0xFF                    ///< 跳转表空位标记
+
+#define XN_FSM_TAG_NONE         0u                      ///< 无标签事件，总是处理
+
 struct xn_fsm; // 前向声明
 
 /**
@@ -80,15 +111,54 @@ typedef bool (*xn_fsm_guard_t)(struct xn_fsm *fsm, xn_event_id_t event, void *us
  */
 typedef void (*xn_fsm_action_t)(struct xn_fsm *fsm, xn_event_id_t event, void *user_data);
 
+/**
+ * @brief 事件投递函数类型
+ * 
+ * 状态超时或异步工作完成时调用，可能运行在任意任务中（超时在 esp_timer 任务中）。
+ * 实现应把事件连同 tag 送回驱动状态机的任务（例如作为事件总线负载），
+ * 再由该任务调用 xn_fsm_process_tagged_event。tag 标识事件产生时的状态，
+ * 状态机据此在处理时丢弃已经过期的事件。
+ * @param fsm 状态机实例指针
+ * @param event 事件ID
+ * @param tag 事件标签，原样交回 xn_fsm_process_tagged_event
+ * @param user_data 用户私有数据
+ * @return esp_err_t ESP_OK 或 错误码
+ */
+typedef esp_err_t (*xn_fsm_post_t)(struct xn_fsm *fsm, xn_event_id_t event, uint32_t tag, void *user_data);
+
+/**
+ * @brief 异步工作函数类型
+ * 
+ * 在独立任务中执行，可以阻塞（如HTTP请求）。不得直接操作状态机。
+ * @param fsm 状态机实例指针
+ * @param arg 工作参数
+ * @return esp_err_t 
+ *      - ESP_OK: 成功，投递 done_event
+ *      - ESP_ERR_NOT_FINISHED: 工作已自行发出后续事件，不投递完成事件
+ *      - 其他: 失败，投递 fail_event
+ */
+typedef esp_err_t (*xn_fsm_work_t)(struct xn_fsm *fsm, void *arg);
+
 /**
  * @brief 状态定义结构体
+ * 
+ * 父状态：处于子状态时也视为处于其所有祖先状态。子状态没有匹配的转换时，
+ * 事件依次交给父状态、祖父状态……最后是 XN_STATE_ANY 通配转换。
+ * 进入子状态时先进入尚未进入的祖先状态，离开时按相反顺序退出。
+ * 
+ * 超时：进入状态时开始计时，离开前超时则通过配置的 post 函数投递 timeout_event；
+ * 父状态的超时覆盖其所有子状态停留的总时长。超时事件带有标签，处理时该状态已经退出
+ * 或重新进入过（事件在队列中时发生了转换），事件被丢弃，不会在后一个状态中生效。
  */
-typedef struct {
+typedef struct xn_fsm_state {
     xn_state_id_t id;               ///< 状态ID（必须唯一）
     const char *name;               ///< 状态名称（用于调试）
     xn_fsm_state_cb_t on_enter;     ///< 进入状态回调（可选）
     xn_fsm_state_cb_t on_exit;      ///< 退出状态回调（可选）
     xn_fsm_state_cb_t on_run;       ///< 状态运行回调（可选，通常用于轮询）
+    const struct xn_fsm_state *parent;  ///< 父状态（可选，必须指向同一状态表中的元素）
+    uint32_t timeout_ms;            ///< 状态超时时间(ms)，0 表示不超时
+    xn_event_id_t timeout_event;    ///< 超时后投递的事件
 } xn_fsm_state_t;
 
 /**
@@ -118,7 +188,28 @@ typedef struct xn_fsm {
     const xn_fsm_transition_t *transitions; ///< 转换表指针
     uint8_t transition_count;               ///< 转换数量
     void *user_data;                        ///< 用户私有数据指针
+    xn_fsm_post_t post;                     ///< 超时与异步完成事件投递函数
     bool running;                           ///< 运行标志
+
+    // 运行到完成：处理事件期间到达的事件暂存于此
+    bool processing;                        ///< 是否正在处理事件或执行状态回调
+    uint8_t deferred_head;                  ///< 排队事件队首下标
+    uint8_t deferred_count;                 ///< 排队事件数量
+    xn_event_id_t deferred[XN_FSM_EVENT_QUEUE_SIZE];    ///< 排队事件环形缓冲
+    uint32_t deferred_tag[XN_FSM_EVENT_QUEUE_SIZE];     ///< 排队事件的标签
+    uint32_t generation;                    ///< 状态代数，每次切换状态加一，用于丢弃过期的异步完成事件
+
+    // 以下为 xn_fsm_init 编译生成的查找表，仅供内部使用
+    uint8_t current_index;                  ///< 当前状态在状态表中的下标
+    uint8_t parent_index[XN_FSM_MAX_STATES];            ///< 各状态父状态的下标，无父状态为 XN_FSM_NO_TRANSITION
+    uint32_t timeout_seq[XN_FSM_MAX_STATES];            ///< 各状态的超时计时序号，每次进入加一，用于识别过期的超时事件
+    uint8_t event_count;                    ///< 跳转表列数（不同事件ID数量）
+    xn_state_id_t state_keys[XN_FSM_STATE_MAP_SIZE];    ///< 状态ID哈希表键
+    uint8_t state_index[XN_FSM_STATE_MAP_SIZE];         ///< 状态ID哈希表值（状态表下标）
+    xn_event_id_t event_keys[XN_FSM_EVENT_MAP_SIZE];    ///< 事件ID哈希表键
+    uint8_t event_slot[XN_FSM_EVENT_MAP_SIZE];          ///< 事件ID哈希表值（跳转表列号）
+    uint8_t jump[XN_FSM_MAX_STATES][XN_FSM_MAX_EVENTS]; ///< 跳转表：[状态下标][事件列] -> 转换表下标
+    uint8_t any_row[XN_FSM_MAX_EVENTS];                 ///< XN_STATE_ANY 通配行
 } xn_fsm_t;
 
 /**
@@ -132,6 +223,7 @@ typedef struct {
     const xn_fsm_transition_t *transitions; ///< 转换表
     uint8_t transition_count;               ///< 转换表大小
     void *user_data;                        ///< 用户私有数据
+    xn_fsm_post_t post;                     ///< 超时与异步完成事件投递函数（使用状态超时或 xn_fsm_start_async 时必填）
 } xn_fsm_config_t;
 
 /*===========================================================================
@@ -142,10 +234,18 @@ typedef struct {
  * @brief 初始化状态机
  * 
  * 加载配置，但不启动状态机（不进入初始状态）。
+ * 同时校验状态表与转换表并编译为跳转表：
+ * - 状态ID重复、初始状态或转换的源/目标状态不存在、同一(源状态,事件)重复定义，均视为配置错误
+ * - 从初始状态不可达的状态只打印警告（仍可通过 xn_fsm_set_state 进入）
+ * - 同一事件既有具体源状态又有 XN_STATE_ANY 的转换时，具体源状态优先
+ * - 父状态指针不在状态表内或形成环、设置了超时却未配置 post 函数，均视为配置错误
  * 
  * @param fsm 状态机实例指针
  * @param config 配置结构体指针
- * @return esp_err_t ESP_OK 或 错误码
+ * @return esp_err_t 
+ *      - ESP_OK: 成功
+ *      - ESP_ERR_INVALID_ARG: 参数无效、转换数超过 XN_FSM_MAX_TRANSITIONS 或转换表校验失败
+ *      - ESP_ERR_INVALID_SIZE: 状态数超过 XN_FSM_MAX_STATES 或事件数超过 XN_FSM_MAX_EVENTS
  */
 esp_err_t xn_fsm_init(xn_fsm_t *fsm, const xn_fsm_config_t *config);
 
@@ -175,21 +275,66 @@ esp_err_t xn_fsm_stop(xn_fsm_t *fsm);
  * @brief 处理事件
  * 
  * 查找匹配的转换规则并执行转换。
+ * 在状态回调或转换动作中调用时，事件进入内部队列，待当前转换完成后按顺序处理，
+ * 保证每次转换的 exit/action/enter 不会被打断。
+ * 必须在驱动状态机的同一任务中调用；其他任务应通过事件总线等方式转交。
  * 
  * @param fsm 状态机实例指针
  * @param event 事件ID
  * @return esp_err_t 
- *      - ESP_OK: 转换成功
+ *      - ESP_OK: 转换成功，或已排队等待处理
+ *      - ESP_ERR_NO_MEM: 排队事件已满，事件被丢弃
  *      - ESP_ERR_NOT_FOUND: 无匹配转换（忽略）
  *      - ESP_ERR_NOT_ALLOWED: Guard条件拒绝
  *      - ESP_ERR_INVALID_STATE: 状态机未运行
  */
 esp_err_t xn_fsm_process_event(xn_fsm_t *fsm, xn_event_id_t event);
 
+/**
+ * @brief 处理经 post 函数送回的事件
+ * 
+ * 与 xn_fsm_process_event 相同，但先检查 tag：产生超时事件的状态已退出或重新进入，
+ * 或异步工作启动后状态机切换过状态，事件视为过期并丢弃。检查在事件真正处理时进行，
+ * 排队期间发生的转换同样生效。tag 为 XN_FSM_TAG_NONE 时等同 xn_fsm_process_event。
+ * 
+ * @param fsm 状态机实例指针
+ * @param event 事件ID
+ * @param tag post 函数收到的标签
+ * @return esp_err_t 
+ *      - ESP_ERR_INVALID_VERSION: 事件已过期，被丢弃
+ *      - 其他见 xn_fsm_process_event
+ */
+esp_err_t xn_fsm_process_tagged_event(xn_fsm_t *fsm, xn_event_id_t event, uint32_t tag);
+
+/**
+ * @brief 在独立任务中执行耗时工作
+ * 
+ * 通常在状态 on_enter 中调用。工作完成后通过配置的 post 函数投递 done_event
+ * 或 fail_event，标签为启动时的状态代数；由 xn_fsm_process_tagged_event 处理时
+ * 状态机已切换过状态，完成事件视为过期并丢弃。
+ * 
+ * done_event / fail_event 会经 post 函数广播（例如事件总线），应使用只表示本次工作结果的
+ * 专用事件，不要复用其他模块订阅的通用事件。
+ * 
+ * @param fsm 状态机实例指针
+ * @param work 工作函数
+ * @param arg 工作参数
+ * @param done_event 成功时投递的事件
+ * @param fail_event 失败时投递的事件
+ * @return esp_err_t 
+ *      - ESP_OK: 工作任务已创建
+ *      - ESP_ERR_INVALID_ARG: 参数无效
+ *      - ESP_ERR_NOT_SUPPORTED: 未配置 post 函数
+ *      - ESP_ERR_NO_MEM: 创建任务失败
+ */
+esp_err_t xn_fsm_start_async(xn_fsm_t *fsm, xn_fsm_work_t work, void *arg,
+                             xn_event_id_t done_event, xn_event_id_t fail_event);
+
 /**
  * @brief 强制转换到指定状态
  * 
  * 手动切换状态，会触发原状态 on_exit 和新状态 on_enter。
+ * 运行中切换时与处理事件相同：回调中投递的事件排队，切换完成后再依次处理。
  * 通常不建议直接使用，应优先通过事件驱动。
  * 
  * @param fsm 状态机实例指针
@@ -211,7 +356,7 @@ void xn_fsm_run(xn_fsm_t *fsm);
  * @brief 获取当前状态ID
  * 
  * @param fsm 状态机实例指针
- * @return xn_state_id_t 当前状态ID，未运行时可能返回 XN_STATE_INVALID
+ * @return xn_state_id_t 当前状态ID（最内层子状态），未运行时可能返回 XN_STATE_INVALID
  */
 xn_state_id_t xn_fsm_get_state(const xn_fsm_t *fsm);
 
@@ -228,7 +373,7 @@ const char *xn_fsm_get_state_name(const xn_fsm_t *fsm);
  * 
  * @param fsm 状态机实例指针
  * @param state 待检查的状态ID
- * @return true 处于该状态，false 不处于
+ * @return true 处于该状态或其子状态，false 不处于
  */
 bool xn_fsm_is_in_state(const xn_fsm_t *fsm, xn_state_id_t state);
 
@@ -3,96 +3,508 @@
  * @brief 通用有限状态机实现
  */
 
+#include <stdlib.h>
 #include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "esp_log.h"
 #include "xn_fsm.h"
+#include "xn_fsm_timer.h"
 
 static const char *TAG = "xn_fsm";
 
+// 跳转表以 uint8_t 保存转换下标，0xFF 留作空位标记
+_Static_assert(XN_FSM_MAX_TRANSITIONS < XN_FSM_NO_TRANSITION,
+               "XN_FSM_MAX_TRANSITIONS must be below XN_FSM_NO_TRANSITION");
+
+#define XN_FSM_ASYNC_TAG_INDEX  0xFF    ///< 异步完成事件标签的高 8 位（不是任何状态下标）
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+/**
+ * @brief 异步工作描述
+ */
+typedef struct {
+    xn_fsm_t *fsm;                  ///< 所属状态机
+    xn_fsm_work_t work;             ///< 工作函数
+    void *arg;                      ///< 工作参数
+    xn_event_id_t done_event;       ///< 成功时投递的事件
+    xn_event_id_t fail_event;       ///< 失败时投递的事件
+    uint32_t generation;            ///< 启动时的状态代数
+} fsm_async_job_t;
+
 /*===========================================================================
  *                          内部函数
  *===========================================================================*/
 
+/**
+ * @brief 计算ID在哈希表中的起始位置
+ */
+static inline int map_hash(uint16_t id, int size)
+{
+    // 乘法散列，打散连续分配的ID
+    return (int)(((uint32_t)id * 40503u) >> 4) % size;
+}
+
+/**
+ * @brief 在ID哈希表中查找
+ * @return int 对应的值，未找到返回 -1
+ */
+static int map_find(const uint16_t *keys, const uint8_t *vals, int size, uint16_t id)
+{
+    // 线性探测，遇到空位说明不存在（负载不超过一半，必然有空位）
+    for (int i = map_hash(id, size), n = 0; n < size; i = (i + 1) % size, n++) {
+        if (keys[i] == id) {
+            return vals[i];
+        }
+        if (keys[i] == XN_STATE_INVALID) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 向ID哈希表中插入
+ * @return true 插入成功；false ID已存在
+ */
+static bool map_insert(uint16_t *keys, uint8_t *vals, int size, uint16_t id, uint8_t val)
+{
+    int i = map_hash(id, size);
+    while (keys[i] != XN_STATE_INVALID) {
+        if (keys[i] == id) {
+            return false;
+        }
+        i = (i + 1) % size;
+    }
+    keys[i] = id;
+    vals[i] = val;
+    return true;
+}
+
+/**
+ * @brief 根据ID查找状态在状态表中的下标
+ * @return int 下标，未找到返回 -1
+ */
+static int find_state_index(const xn_fsm_t *fsm, xn_state_id_t state_id)
+{
+    return map_find(fsm->state_keys, fsm->state_index, XN_FSM_STATE_MAP_SIZE, state_id);
+}
+
 /**
  * @brief 根据ID查找状态定义
  */
 static const xn_fsm_state_t *find_state(const xn_fsm_t *fsm, xn_state_id_t state_id)
 {
-    // 线性遍历查找状态
-    for (int i = 0; i < fsm->state_count; i++) {
-        if (fsm->states[i].id == state_id) {
-            return &fsm->states[i];
+    int idx = find_state_index(fsm, state_id);
+    return (idx < 0) ? NULL : &fsm->states[idx];
+}
+
+/**
+ * @brief 判断 ancestor 是否为 idx 的祖先状态（不含自身）
+ */
+static bool is_ancestor(const xn_fsm_t *fsm, int ancestor, int idx)
+{
+    for (int p = fsm->parent_index[idx]; p != XN_FSM_NO_TRANSITION; p = fsm->parent_index[p]) {
+        if (p == ancestor) {
+            return true;
         }
     }
-    return NULL; // 未找到
+    return false;
 }
 
 /**
  * @brief 查找匹配的转换规则
  * 
- * 查找触发事件为event，且源状态匹配当前状态（或为ANY）的规则。
- * 如果有多条匹配，返回表中最先出现的一条。
+ * 从当前状态所在行开始，逐级向父状态冒泡，最后查 XN_STATE_ANY 通配行。
  */
 static const xn_fsm_transition_t *find_transition(const xn_fsm_t *fsm, xn_event_id_t event)
 {
+    int slot = map_find(fsm->event_keys, fsm->event_slot, XN_FSM_EVENT_MAP_SIZE, event);
+    // 转换表中没有出现过的事件
+    if (slot < 0) {
+        return NULL;
+    }
+    
+    uint8_t t = XN_FSM_NO_TRANSITION;
+    for (int s = fsm->current_index; s != XN_FSM_NO_TRANSITION && t == XN_FSM_NO_TRANSITION; 
+         s = fsm->parent_index[s]) {
+        t = fsm->jump[s][slot];
+    }
+    if (t == XN_FSM_NO_TRANSITION) {
+        t = fsm->any_row[slot];
+    }
+    return (t == XN_FSM_NO_TRANSITION) ? NULL : &fsm->transitions[t];
+}
+
+/**
+ * @brief 检查从初始状态不可达的状态并打印警告
+ */
+static void check_reachable(const xn_fsm_t *fsm)
+{
+    bool reached[XN_FSM_MAX_STATES] = {false};
+    // 处于某状态即同时处于其所有祖先状态
+    for (int s = fsm->current_index; s != XN_FSM_NO_TRANSITION; s = fsm->parent_index[s]) {
+        reached[s] = true;
+    }
+    
+    // 反复扩展可达集合直到不再变化
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 0; i < fsm->transition_count; i++) {
+            const xn_fsm_transition_t *t = &fsm->transitions[i];
+            int to = find_state_index(fsm, t->to);
+            if (reached[to]) {
+                continue;
+            }
+            // 通配转换可从任意已到达的状态触发
+            if (t->from == XN_STATE_ANY || reached[find_state_index(fsm, t->from)]) {
+                for (int s = to; s != XN_FSM_NO_TRANSITION; s = fsm->parent_index[s]) {
+                    reached[s] = true;
+                }
+                changed = true;
+            }
+        }
+    }
+    
+    for (int i = 0; i < fsm->state_count; i++) {
+        if (!reached[i]) {
+            ESP_LOGW(TAG, "[%s] State %s is unreachable from initial state", 
+                     fsm->name, fsm->states[i].name);
+        }
+    }
+}
+
+/**
+ * @brief 校验状态表与转换表并编译为跳转表
+ * @param fsm 已加载配置的状态机实例
+ * @param initial_state 初始状态ID
+ * @return esp_err_t 见 xn_fsm_init
+ */
+static esp_err_t compile_tables(xn_fsm_t *fsm, xn_state_id_t initial_state)
+{
+    if (fsm->state_count > XN_FSM_MAX_STATES) {
+        ESP_LOGE(TAG, "[%s] Too many states: %d > %d", fsm->name, fsm->state_count, XN_FSM_MAX_STATES);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (fsm->transitions == NULL && fsm->transition_count > 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (fsm->transition_count > XN_FSM_MAX_TRANSITIONS) {
+        ESP_LOGE(TAG, "[%s] Too many transitions: %d > %d",
+                 fsm->name, fsm->transition_count, XN_FSM_MAX_TRANSITIONS);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 哈希表键全部置为空位，跳转表全部置为无转换
+    memset(fsm->state_keys, 0xFF, sizeof(fsm->state_keys));
+    memset(fsm->event_keys, 0xFF, sizeof(fsm->event_keys));
+    memset(fsm->jump, XN_FSM_NO_TRANSITION, sizeof(fsm->jump));
+    memset(fsm->any_row, XN_FSM_NO_TRANSITION, sizeof(fsm->any_row));
+    fsm->event_count = 0;
+    
+    // 建立状态ID -> 下标映射
+    for (int i = 0; i < fsm->state_count; i++) {
+        xn_state_id_t id = fsm->states[i].id;
+        if (id == XN_STATE_INVALID || id == XN_STATE_ANY ||
+            !map_insert(fsm->state_keys, fsm->state_index, XN_FSM_STATE_MAP_SIZE, id, (uint8_t)i)) {
+            ESP_LOGE(TAG, "[%s] Invalid or duplicate state id: %d", fsm->name, id);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    
+    // 解析父状态指针并检查超时配置
+    for (int i = 0; i < fsm->state_count; i++) {
+        const xn_fsm_state_t *parent = fsm->states[i].parent;
+        fsm->parent_index[i] = XN_FSM_NO_TRANSITION;
+        if (parent != NULL) {
+            if (parent < fsm->states || parent >= fsm->states + fsm->state_count) {
+                ESP_LOGE(TAG, "[%s] State %s has parent outside state table", fsm->name, fsm->states[i].name);
+                return ESP_ERR_INVALID_ARG;
+            }
+            fsm->parent_index[i] = (uint8_t)(parent - fsm->states);
+        }
+        // 超时事件需要 post 函数送回状态机
+        if (fsm->states[i].timeout_ms > 0 && fsm->post == NULL) {
+            ESP_LOGE(TAG, "[%s] State %s has timeout but no post function", fsm->name, fsm->states[i].name);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    
+    // 父状态链不能成环：向上最多走 state_count 步
+    for (int i = 0; i < fsm->state_count; i++) {
+        int depth = 0;
+        for (int p = fsm->parent_index[i]; p != XN_FSM_NO_TRANSITION; p = fsm->parent_index[p]) {
+            if (++depth > fsm->state_count) {
+                ESP_LOGE(TAG, "[%s] Parent cycle at state %s", fsm->name, fsm->states[i].name);
+                return ESP_ERR_INVALID_ARG;
+            }
+        }
+    }
+    
+    // 逐条转换填入跳转表
     for (int i = 0; i < fsm->transition_count; i++) {
         const xn_fsm_transition_t *t = &fsm->transitions[i];
-        // 匹配事件
-        if (t->event == event) {
-            // 匹配源状态 (支持通配 XN_STATE_ANY)
-            if (t->from == XN_STATE_ANY || t->from == fsm->current_state) {
-                return t;
+        
+        // 源状态与目标状态必须存在
+        int from = (t->from == XN_STATE_ANY) ? -1 : find_state_index(fsm, t->from);
+        if ((t->from != XN_STATE_ANY && from < 0) || find_state_index(fsm, t->to) < 0) {
+            ESP_LOGE(TAG, "[%s] Transition #%d has dangling state: %d -> %d", 
+                     fsm->name, i, t->from, t->to);
+            return ESP_ERR_INVALID_ARG;
+        }
+        
+        // 为新出现的事件分配一列（0xFFFF 为哈希表空位标记，不能作为事件ID）
+        if (t->event == XN_STATE_INVALID) {
+            ESP_LOGE(TAG, "[%s] Transition #%d has invalid event 0x%04x", fsm->name, i, t->event);
+            return ESP_ERR_INVALID_ARG;
+        }
+        int slot = map_find(fsm->event_keys, fsm->event_slot, XN_FSM_EVENT_MAP_SIZE, t->event);
+        if (slot < 0) {
+            if (fsm->event_count >= XN_FSM_MAX_EVENTS) {
+                ESP_LOGE(TAG, "[%s] Too many distinct events: > %d", fsm->name, XN_FSM_MAX_EVENTS);
+                return ESP_ERR_INVALID_SIZE;
             }
+            slot = fsm->event_count++;
+            map_insert(fsm->event_keys, fsm->event_slot, XN_FSM_EVENT_MAP_SIZE, t->event, (uint8_t)slot);
+        }
+        
+        // 同一(源状态,事件)只能有一条转换，否则后一条永远不会生效
+        uint8_t *cell = (from < 0) ? &fsm->any_row[slot] : &fsm->jump[from][slot];
+        if (*cell != XN_FSM_NO_TRANSITION) {
+            ESP_LOGE(TAG, "[%s] Duplicate transition #%d and #%d for event 0x%04x", 
+                     fsm->name, *cell, i, t->event);
+            return ESP_ERR_INVALID_ARG;
         }
+        *cell = (uint8_t)i;
     }
-    return NULL;
+    
+    // 初始状态必须存在
+    int initial = find_state_index(fsm, initial_state);
+    if (initial < 0) {
+        ESP_LOGE(TAG, "[%s] Invalid initial state: %d", fsm->name, initial_state);
+        return ESP_ERR_INVALID_ARG;
+    }
+    fsm->current_index = (uint8_t)initial;
+    
+    check_reachable(fsm);
+    
+    // 用到状态超时时准备共享定时器
+    for (int i = 0; i < fsm->state_count; i++) {
+        if (fsm->states[i].timeout_ms > 0) {
+            return xn_fsm_timer_init();
+        }
+    }
+    
+    return ESP_OK;
 }
 
 /**
- * @brief 执行状态转换
+ * @brief 进入单个状态：开始超时计时并调用 on_enter
+ * 
+ * 每次进入都换一个超时序号，之前投递、尚未处理的超时事件随之过期。
+ */
+static void enter_state(xn_fsm_t *fsm, int idx)
+{
+    const xn_fsm_state_t *state = &fsm->states[idx];
+    if (state->timeout_ms > 0) {
+        // 序号只用低 24 位，跳过 0，保证标签不等于 XN_FSM_TAG_NONE
+        uint32_t seq = XN_FSM_TAG_SEQ(fsm->timeout_seq[idx] + 1);
+        fsm->timeout_seq[idx] = (seq == 0) ? 1 : seq;
+        xn_fsm_timer_arm(fsm, (uint8_t)idx);
+    }
+    if (state->on_enter) {
+        state->on_enter(fsm, fsm->user_data);
+    }
+}
+
+/**
+ * @brief 退出单个状态：取消超时计时并调用 on_exit
+ */
+static void exit_state(xn_fsm_t *fsm, int idx)
+{
+    const xn_fsm_state_t *state = &fsm->states[idx];
+    if (state->timeout_ms > 0) {
+        xn_fsm_timer_disarm(fsm, (uint8_t)idx);
+    }
+    if (state->on_exit) {
+        state->on_exit(fsm, fsm->user_data);
+    }
+}
+
+/**
+ * @brief 从 top（不含，XN_FSM_NO_TRANSITION 表示根）向下依次进入到 to
+ */
+static void enter_path(xn_fsm_t *fsm, int top, int to)
+{
+    uint8_t path[XN_FSM_MAX_STATES];
+    int n = 0;
+    
+    // 自下而上收集，再自上而下进入
+    for (int s = to; s != top && s != XN_FSM_NO_TRANSITION; s = fsm->parent_index[s]) {
+        path[n++] = (uint8_t)s;
+    }
+    while (n > 0) {
+        enter_state(fsm, path[--n]);
+    }
+}
+
+/**
+ * @brief 切换到目标状态
  * 
  * 流程：
- * 1. 查找源状态和目标状态定义
- * 2. 如果存在，调用源状态的 on_exit
- * 3. 如果存在，执行转换动作(action)
- * 4. 更新当前状态ID
- * 5. 如果存在，调用目标状态的 on_enter
+ * 1. 从当前状态逐级向上退出，直到遇到目标状态的祖先（共同祖先不退出）
+ * 2. 如果存在，执行转换动作(action)
+ * 3. 更新当前状态ID
+ * 4. 从共同祖先向下逐级进入到目标状态
+ * 
+ * @param to 目标状态下标
+ * @param trans 触发的转换（强制切换时为 NULL）
+ * @param event 触发事件
  */
-static void do_transition(xn_fsm_t *fsm, const xn_fsm_transition_t *trans, xn_event_id_t event)
+static void change_state(xn_fsm_t *fsm, int to, const xn_fsm_transition_t *trans, xn_event_id_t event)
 {
-    const xn_fsm_state_t *from_state = find_state(fsm, fsm->current_state);
-    const xn_fsm_state_t *to_state = find_state(fsm, trans->to);
+    // 退出当前状态及不再处于的祖先状态(前)
+    int s = fsm->current_index;
+    while (s != XN_FSM_NO_TRANSITION && !is_ancestor(fsm, s, to)) {
+        exit_state(fsm, s);
+        s = fsm->parent_index[s];
+    }
     
-    // 目标状态必须存在
-    if (to_state == NULL) {
-        ESP_LOGE(TAG, "[%s] Invalid target state: %d", fsm->name, trans->to);
-        return;
+    // 执行转换动作(中)
+    if (trans && trans->action) {
+        trans->action(fsm, event, fsm->user_data);
     }
     
+    // 更新状态
+    fsm->prev_state = fsm->current_state;
+    fsm->current_state = fsm->states[to].id;
+    fsm->current_index = (uint8_t)to;
+    fsm->generation++;
+    
+    // 进入目标状态及尚未处于的祖先状态(后)
+    enter_path(fsm, s, to);
+}
+
+/**
+ * @brief 执行状态转换
+ */
+static void do_transition(xn_fsm_t *fsm, const xn_fsm_transition_t *trans, xn_event_id_t event)
+{
+    // 目标状态已在初始化时校验，必然存在
+    int to = find_state_index(fsm, trans->to);
+    
     ESP_LOGI(TAG, "[%s] %s -> %s (event=0x%04x)", 
              fsm->name,
-             from_state ? from_state->name : "?",
-             to_state->name,
+             fsm->states[fsm->current_index].name,
+             fsm->states[to].name,
              event);
     
-    // 退出当前状态(前)
-    if (from_state && from_state->on_exit) {
-        from_state->on_exit(fsm, fsm->user_data);
+    change_state(fsm, to, trans, event);
+}
+
+/**
+ * @brief 检查事件标签是否仍然有效
+ * 
+ * - 超时事件的标签指向一个状态及其超时序号：该状态仍处于激活（当前状态或其祖先），
+ *   且之后没有重新进入过，事件才有效
+ * - 异步完成事件的标签为启动工作时的状态代数：其间没有切换过状态，事件才有效
+ */
+static bool tag_valid(const xn_fsm_t *fsm, uint32_t tag)
+{
+    if (tag == XN_FSM_TAG_NONE) {
+        return true;
+    }
+    
+    int idx = XN_FSM_TAG_INDEX(tag);
+    if (idx == XN_FSM_ASYNC_TAG_INDEX) {
+        return XN_FSM_TAG_SEQ(fsm->generation) == XN_FSM_TAG_SEQ(tag);
+    }
+    if (idx >= fsm->state_count || fsm->states[idx].timeout_ms == 0) {
+        return false;
+    }
+    if (idx != fsm->current_index && !is_ancestor(fsm, idx, fsm->current_index)) {
+        return false;
+    }
+    return fsm->timeout_seq[idx] == XN_FSM_TAG_SEQ(tag);
+}
+
+/**
+ * @brief 处理单个事件：检查标签、查找转换、检查 Guard 并执行转换
+ */
+static esp_err_t handle_event(xn_fsm_t *fsm, xn_event_id_t event, uint32_t tag)
+{
+    // 产生事件的状态已经退出或重新进入，事件过期
+    if (!tag_valid(fsm, tag)) {
+        ESP_LOGW(TAG, "[%s] Stale event 0x%04x dropped in state %s", 
+                 fsm->name, event, fsm->states[fsm->current_index].name);
+        return ESP_ERR_INVALID_VERSION;
     }
     
-    // 执行转换动作(中)
-    if (trans->action) {
-        trans->action(fsm, event, fsm->user_data);
+    // 查找转换规则
+    const xn_fsm_transition_t *trans = find_transition(fsm, event);
+    if (trans == NULL) {
+        ESP_LOGD(TAG, "[%s] No transition for event 0x%04x in state %d", 
+                 fsm->name, event, fsm->current_state);
+        return ESP_ERR_NOT_FOUND;
     }
     
-    // 更新状态
-    fsm->prev_state = fsm->current_state;
-    fsm->current_state = trans->to;
+    // 检查 Guard 条件
+    if (trans->guard && !trans->guard(fsm, event, fsm->user_data)) {
+        ESP_LOGD(TAG, "[%s] Transition guard rejected event 0x%04x", 
+                 fsm->name, event);
+        return ESP_ERR_NOT_ALLOWED;
+    }
+    
+    // 执行转换
+    do_transition(fsm, trans, event);
     
-    // 进入新状态(后)
-    if (to_state->on_enter) {
-        to_state->on_enter(fsm, fsm->user_data);
+    return ESP_OK;
+}
+
+/**
+ * @brief 依次处理回调期间排队的事件，结束后退出处理上下文
+ */
+static void drain_deferred(xn_fsm_t *fsm)
+{
+    // 处理过程中可能继续排入新事件，直到队列清空
+    while (fsm->deferred_count > 0 && fsm->running) {
+        xn_event_id_t event = fsm->deferred[fsm->deferred_head];
+        uint32_t tag = fsm->deferred_tag[fsm->deferred_head];
+        fsm->deferred_head = (fsm->deferred_head + 1) % XN_FSM_EVENT_QUEUE_SIZE;
+        fsm->deferred_count--;
+        handle_event(fsm, event, tag);
     }
+    // 已停止的状态机丢弃剩余事件
+    fsm->deferred_count = 0;
+    fsm->processing = false;
+}
+
+/**
+ * @brief 异步工作任务函数
+ * 
+ * 完成事件带上启动时的状态代数，由状态机在处理事件时判断是否过期：
+ * 本任务读到的代数与事件到达状态机时的代数之间仍可能发生转换，不能在这里判断。
+ * 
+ * @param arg 工作描述（任务结束时释放）
+ */
+static void async_task(void *arg)
+{
+    fsm_async_job_t *job = (fsm_async_job_t *)arg;
+    xn_fsm_t *fsm = job->fsm;
+    
+    esp_err_t ret = job->work(fsm, job->arg);
+    
+    if (ret != ESP_ERR_NOT_FINISHED) {
+        uint32_t tag = XN_FSM_MAKE_TAG(XN_FSM_ASYNC_TAG_INDEX, job->generation);
+        fsm->post(fsm, (ret == ESP_OK) ? job->done_event : job->fail_event, tag, fsm->user_data);
+    }
+    
+    free(job);
+    vTaskDelete(NULL);
 }
 
 /*===========================================================================
@@ -120,12 +532,19 @@ esp_err_t xn_fsm_init(xn_fsm_t *fsm, const xn_fsm_config_t *config)
     fsm->transitions = config->transitions;
     fsm->transition_count = config->transition_count;
     fsm->user_data = config->user_data;
+    fsm->post = config->post;
     
     // 设置初始状态，但暂不进入
     fsm->current_state = config->initial_state;
     fsm->prev_state = XN_STATE_INVALID;
     fsm->running = false;
     
+    // 校验并编译跳转表
+    esp_err_t ret = compile_tables(fsm, config->initial_state);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
     ESP_LOGI(TAG, "[%s] Initialized with %d states, %d transitions", 
              fsm->name, fsm->state_count, fsm->transition_count);
     
@@ -143,21 +562,17 @@ esp_err_t xn_fsm_start(xn_fsm_t *fsm)
         return ESP_ERR_INVALID_STATE;
     }
     
-    // 验证初始状态是否存在
-    const xn_fsm_state_t *initial = find_state(fsm, fsm->current_state);
-    if (initial == NULL) {
-        ESP_LOGE(TAG, "[%s] Invalid initial state: %d", fsm->name, fsm->current_state);
-        return ESP_ERR_INVALID_ARG;
-    }
+    // 初始状态已在初始化时校验
+    const xn_fsm_state_t *initial = &fsm->states[fsm->current_index];
     
     fsm->running = true;
     
     ESP_LOGI(TAG, "[%s] Started in state: %s", fsm->name, initial->name);
     
-    // 触发初始状态的进入动作
-    if (initial->on_enter) {
-        initial->on_enter(fsm, fsm->user_data);
-    }
+    // 自上而下进入初始状态及其祖先，期间投递的事件在进入完成后处理
+    fsm->processing = true;
+    enter_path(fsm, XN_FSM_NO_TRANSITION, fsm->current_index);
+    drain_deferred(fsm);
     
     return ESP_OK;
 }
@@ -173,13 +588,13 @@ esp_err_t xn_fsm_stop(xn_fsm_t *fsm)
         return ESP_ERR_INVALID_STATE;
     }
     
-    // 退出当前状态
-    const xn_fsm_state_t *current = find_state(fsm, fsm->current_state);
-    if (current && current->on_exit) {
-        current->on_exit(fsm, fsm->user_data);
+    // 自下而上退出当前状态及其祖先
+    for (int s = fsm->current_index; s != XN_FSM_NO_TRANSITION; s = fsm->parent_index[s]) {
+        exit_state(fsm, s);
     }
     
     fsm->running = false;
+    fsm->generation++;
     
     ESP_LOGI(TAG, "[%s] Stopped", fsm->name);
     
@@ -188,6 +603,12 @@ esp_err_t xn_fsm_stop(xn_fsm_t *fsm)
 
 /* 处理事件 */
 esp_err_t xn_fsm_process_event(xn_fsm_t *fsm, xn_event_id_t event)
+{
+    return xn_fsm_process_tagged_event(fsm, event, XN_FSM_TAG_NONE);
+}
+
+/* 处理经 post 函数送回的事件 */
+esp_err_t xn_fsm_process_tagged_event(xn_fsm_t *fsm, xn_event_id_t event, uint32_t tag)
 {
     if (fsm == NULL) {
         return ESP_ERR_INVALID_ARG;
@@ -198,23 +619,56 @@ esp_err_t xn_fsm_process_event(xn_fsm_t *fsm, xn_event_id_t event)
         return ESP_ERR_INVALID_STATE;
     }
     
-    // 查找转换规则
-    const xn_fsm_transition_t *trans = find_transition(fsm, event);
-    if (trans == NULL) {
-        ESP_LOGD(TAG, "[%s] No transition for event 0x%04x in state %d", 
-                 fsm->name, event, fsm->current_state);
-        return ESP_ERR_NOT_FOUND;
+    // 正在执行回调：排队，待当前转换完成后处理
+    if (fsm->processing) {
+        if (fsm->deferred_count >= XN_FSM_EVENT_QUEUE_SIZE) {
+            ESP_LOGW(TAG, "[%s] Deferred queue full, dropped event 0x%04x", fsm->name, event);
+            return ESP_ERR_NO_MEM;
+        }
+        uint8_t tail = (fsm->deferred_head + fsm->deferred_count) % XN_FSM_EVENT_QUEUE_SIZE;
+        fsm->deferred[tail] = event;
+        fsm->deferred_tag[tail] = tag;
+        fsm->deferred_count++;
+        return ESP_OK;
     }
     
-    // 检查 Guard 条件
-    if (trans->guard && !trans->guard(fsm, event, fsm->user_data)) {
-        ESP_LOGD(TAG, "[%s] Transition guard rejected event 0x%04x", 
-                 fsm->name, event);
-        return ESP_ERR_NOT_ALLOWED;
+    // 处理事件，再处理转换期间排队的事件
+    fsm->processing = true;
+    esp_err_t ret = handle_event(fsm, event, tag);
+    drain_deferred(fsm);
+    
+    return ret;
+}
+
+/* 在独立任务中执行耗时工作 */
+esp_err_t xn_fsm_start_async(xn_fsm_t *fsm, xn_fsm_work_t work, void *arg,
+                             xn_event_id_t done_event, xn_event_id_t fail_event)
+{
+    if (fsm == NULL || work == NULL) {
+        return ESP_ERR_INVALID_ARG;
     }
     
-    // 执行转换
-    do_transition(fsm, trans, event);
+    if (fsm->post == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    fsm_async_job_t *job = malloc(sizeof(fsm_async_job_t));
+    if (job == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    job->fsm = fsm;
+    job->work = work;
+    job->arg = arg;
+    job->done_event = done_event;
+    job->fail_event = fail_event;
+    // 在 on_enter 中调用时，代数已是新状态的代数
+    job->generation = fsm->generation;
+    
+    if (xTaskCreate(async_task, "fsm_async", XN_FSM_ASYNC_STACK_SIZE, job,
+                    XN_FSM_ASYNC_PRIORITY, NULL) != pdPASS) {
+        free(job);
+        return ESP_ERR_NO_MEM;
+    }
     
     return ESP_OK;
 }
@@ -232,24 +686,29 @@ esp_err_t xn_fsm_set_state(xn_fsm_t *fsm, xn_state_id_t state)
         return ESP_ERR_INVALID_ARG;
     }
     
-    const xn_fsm_state_t *from_state = find_state(fsm, fsm->current_state);
+    const xn_fsm_state_t *from_state = &fsm->states[fsm->current_index];
     
     ESP_LOGI(TAG, "[%s] Force state: %s -> %s", 
              fsm->name,
-             from_state ? from_state->name : "?",
+             from_state->name,
              to_state->name);
     
-    // 如果正在运行，需要完整执行状态切换的 exit/enter
-    if (fsm->running && from_state && from_state->on_exit) {
-        from_state->on_exit(fsm, fsm->user_data);
+    // 如果正在运行，需要完整执行状态切换的 exit/enter；与处理事件相同，
+    // 回调中投递的事件排队到切换完成后处理。已在处理上下文中（回调内调用）时由外层统一处理
+    if (fsm->running) {
+        bool nested = fsm->processing;
+        fsm->processing = true;
+        change_state(fsm, (int)(to_state - fsm->states), NULL, 0);
+        if (!nested) {
+            drain_deferred(fsm);
+        }
+        return ESP_OK;
     }
     
     fsm->prev_state = fsm->current_state;
     fsm->current_state = state;
-    
-    if (fsm->running && to_state->on_enter) {
-        to_state->on_enter(fsm, fsm->user_data);
-    }
+    fsm->current_index = (uint8_t)(to_state - fsm->states);
+    fsm->generation++;
     
     return ESP_OK;
 }
@@ -261,8 +720,8 @@ void xn_fsm_run(xn_fsm_t *fsm)
         return;
     }
     
-    const xn_fsm_state_t *current = find_state(fsm, fsm->current_state);
-    if (current && current->on_run) {
+    const xn_fsm_state_t *current = &fsm->states[fsm->current_index];
+    if (current->on_run) {
         current->on_run(fsm, fsm->user_data);
     }
 }
@@ -283,8 +742,11 @@ const char *xn_fsm_get_state_name(const xn_fsm_t *fsm)
         return "NULL";
     }
     
-    const xn_fsm_state_t *state = find_state(fsm, fsm->current_state);
-    return state ? state->name : "UNKNOWN";
+    // 未初始化的实例没有状态表
+    if (fsm->states == NULL) {
+        return "UNKNOWN";
+    }
+    return fsm->states[fsm->current_index].name;
 }
 
 /* 状态判断 */
@@ -293,5 +755,13 @@ bool xn_fsm_is_in_state(const xn_fsm_t *fsm, xn_state_id_t state)
     if (fsm == NULL) {
         return false;
     }
-    return fsm->current_state == state;
+    if (fsm->current_state == state) {
+        return true;
+    }
+    // 处于子状态时也处于其祖先状态
+    if (fsm->states == NULL) {
+        return false;
+    }
+    int idx = find_state_index(fsm, state);
+    return idx >= 0 && is_ancestor(fsm, idx, fsm->current_index);
 }
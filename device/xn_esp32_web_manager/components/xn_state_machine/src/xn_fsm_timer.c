@@ -0,0 +1,172 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_state_machine\src\xn_fsm_timer.c
+ * @Description: 状态超时定时轮实现 - 所有状态机共用一个 esp_timer
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "xn_fsm_timer.h"
+
+static const char *TAG = "xn_fsm_timer";
+
+/*===========================================================================
+ *                          内部数据
+ *===========================================================================*/
+
+/**
+ * @brief 一个正在计时的状态
+ */
+typedef struct {
+    xn_fsm_t *fsm;                  ///< 所属状态机
+    uint8_t state_index;            ///< 状态下标
+    uint32_t seq;                   ///< 开始计时时的超时序号，随事件投递
+    int64_t deadline_us;            ///< 到期时刻(us)
+} fsm_timeout_t;
+
+static fsm_timeout_t s_timeouts[XN_FSM_MAX_TIMEOUTS];  // 计时槽位（无序）
+static uint8_t s_timeout_count = 0;                     // 已使用槽位数
+static esp_timer_handle_t s_timer = NULL;               // 共享定时器，总是指向最早到期的槽位
+static SemaphoreHandle_t s_lock = NULL;                 // 槽位与定时器保护锁
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 按最早到期时刻重新启动共享定时器（需持有 s_lock）
+ */
+static void reschedule(void)
+{
+    esp_timer_stop(s_timer);
+    if (s_timeout_count == 0) {
+        return;
+    }
+    
+    int64_t earliest = s_timeouts[0].deadline_us;
+    for (uint8_t i = 1; i < s_timeout_count; i++) {
+        if (s_timeouts[i].deadline_us < earliest) {
+            earliest = s_timeouts[i].deadline_us;
+        }
+    }
+    
+    // 已经到期的槽位也至少延迟1us，由回调统一处理
+    int64_t delay = earliest - esp_timer_get_time();
+    esp_timer_start_once(s_timer, (delay > 0) ? (uint64_t)delay : 1);
+}
+
+/**
+ * @brief 删除槽位（需持有 s_lock），用最后一个槽位填补空位
+ */
+static void remove_at(uint8_t i)
+{
+    s_timeouts[i] = s_timeouts[--s_timeout_count];
+}
+
+/**
+ * @brief 共享定时器回调（在 esp_timer 任务中执行）
+ */
+static void timer_cb(void *arg)
+{
+    fsm_timeout_t expired[XN_FSM_MAX_TIMEOUTS];
+    uint8_t n = 0;
+    
+    // 取出所有到期槽位
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    int64_t now = esp_timer_get_time();
+    for (uint8_t i = 0; i < s_timeout_count; ) {
+        if (s_timeouts[i].deadline_us <= now) {
+            expired[n++] = s_timeouts[i];
+            remove_at(i);
+        } else {
+            i++;
+        }
+    }
+    reschedule();
+    xSemaphoreGive(s_lock);
+    
+    // 锁外投递超时事件
+    for (uint8_t i = 0; i < n; i++) {
+        xn_fsm_t *fsm = expired[i].fsm;
+        const xn_fsm_state_t *state = &fsm->states[expired[i].state_index];
+        ESP_LOGW(TAG, "[%s] State %s timed out after %ums", 
+                 fsm->name, state->name, (unsigned)state->timeout_ms);
+        fsm->post(fsm, state->timeout_event,
+                  XN_FSM_MAKE_TAG(expired[i].state_index, expired[i].seq), fsm->user_data);
+    }
+}
+
+/*===========================================================================
+ *                          内部API实现
+ *===========================================================================*/
+
+/* 初始化共享定时器 */
+esp_err_t xn_fsm_timer_init(void)
+{
+    if (s_timer != NULL) {
+        return ESP_OK;
+    }
+    
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    const esp_timer_create_args_t args = {
+        .callback = timer_cb,
+        .name = "fsm_timeout",
+    };
+    if (esp_timer_create(&args, &s_timer) != ESP_OK) {
+        vSemaphoreDelete(s_lock);
+        s_lock = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    
+    return ESP_OK;
+}
+
+/* 开始对某个状态计时 */
+esp_err_t xn_fsm_timer_arm(xn_fsm_t *fsm, uint8_t state_index)
+{
+    esp_err_t ret = ESP_OK;
+    
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_timeout_count >= XN_FSM_MAX_TIMEOUTS) {
+        ret = ESP_ERR_NO_MEM;
+    } else {
+        fsm_timeout_t *t = &s_timeouts[s_timeout_count++];
+        t->fsm = fsm;
+        t->state_index = state_index;
+        t->seq = fsm->timeout_seq[state_index];
+        t->deadline_us = esp_timer_get_time() + (int64_t)fsm->states[state_index].timeout_ms * 1000;
+        reschedule();
+    }
+    xSemaphoreGive(s_lock);
+    
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "[%s] No free timeout slot for state %s", 
+                 fsm->name, fsm->states[state_index].name);
+    }
+    return ret;
+}
+
+/* 取消某个状态的计时 */
+void xn_fsm_timer_disarm(xn_fsm_t *fsm, uint8_t state_index)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (uint8_t i = 0; i < s_timeout_count; i++) {
+        if (s_timeouts[i].fsm == fsm && s_timeouts[i].state_index == state_index) {
+            remove_at(i);
+            reschedule();
+            break;
+        }
+    }
+    xSemaphoreGive(s_lock);
+}
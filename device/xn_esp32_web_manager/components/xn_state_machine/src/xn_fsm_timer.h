@@ -0,0 +1,60 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_state_machine\src\xn_fsm_timer.h
+ * @Description: 状态超时定时轮 - 状态机内部使用
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_FSM_TIMER_INTERNAL_H
+#define XN_FSM_TIMER_INTERNAL_H
+
+#include <stdint.h>
+#include "xn_fsm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 事件标签：高 8 位为状态下标，低 24 位为该状态的超时计时序号
+ *
+ * 异步完成事件的高 8 位为 0xFF，低 24 位为启动工作时的状态代数。
+ */
+#define XN_FSM_MAKE_TAG(index, seq)     (((uint32_t)(index) << 24) | ((seq) & 0x00FFFFFFu))
+#define XN_FSM_TAG_INDEX(tag)           ((uint8_t)((tag) >> 24))
+#define XN_FSM_TAG_SEQ(tag)             ((tag) & 0x00FFFFFFu)
+
+/**
+ * @brief 初始化共享定时器（可重复调用）
+ * @return esp_err_t ESP_OK / ESP_ERR_NO_MEM
+ */
+esp_err_t xn_fsm_timer_init(void);
+
+/**
+ * @brief 开始对某个状态计时
+ *
+ * 到期时在 esp_timer 任务中通过 fsm->post 投递该状态的 timeout_event，
+ * 标签为 XN_FSM_MAKE_TAG(state_index, 调用时的 fsm->timeout_seq[state_index])。
+ *
+ * @param fsm 状态机实例
+ * @param state_index 状态在状态表中的下标
+ * @return esp_err_t ESP_OK / ESP_ERR_NO_MEM（计时槽位用完）
+ */
+esp_err_t xn_fsm_timer_arm(xn_fsm_t *fsm, uint8_t state_index);
+
+/**
+ * @brief 取消某个状态的计时（未计时则忽略）
+ * @param fsm 状态机实例
+ * @param state_index 状态在状态表中的下标
+ */
+void xn_fsm_timer_disarm(xn_fsm_t *fsm, uint8_t state_index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XN_FSM_TIMER_INTERNAL_H */
@@ -14,18 +14,51 @@
 #include "esp_err.h" // 包含ESP错误码定义
 #include <stdint.h> // 包含标准整型定义
 #include <stdbool.h> // 包含布尔类型定义
+#include <stddef.h> // 包含size_t定义
 
 #ifdef __cplusplus // 如果是C++编译器
 extern "C" { // 使用C链接约定
 #endif // 结束C++编译器判断
 
+/*
+ * 读操作只查RAM缓存；写/删除只修改缓存，首次修改后 CONFIG_XN_STORAGE_COMMIT_DELAY_MS
+ * 到期或调用 xn_storage_commit() 时一次性写入Flash。提交前掉电会丢失这批修改，
+ * 必须落盘的数据（如配网结果）写完后应立即调用 xn_storage_commit()。
+ */
+
+/**
+ * @brief 记录迁移回调
+ * 
+ * 读到的记录版本与期望版本不一致时调用，把旧版本数据转换为当前结构
+ * 
+ * @param old_version 记录中保存的版本
+ * @param old_data 旧版本数据
+ * @param old_length 旧版本数据长度
+ * @param out 当前版本结构（调用前已清零）
+ * @param length 当前版本结构长度
+ * @return esp_err_t 返回ESP_OK表示迁移成功，结果以当前版本写回；其他表示放弃旧数据
+ */
+typedef esp_err_t (*xn_storage_migrate_cb_t)(uint16_t old_version, const void *old_data, size_t old_length,
+                                             void *out, size_t length); // 记录迁移回调类型定义
+
 /**
  * @brief 初始化存储组件 (NVS)
  * 
+ * 打开命名空间并常驻句柄，一次性把全部键值读入RAM缓存；可重复调用
+ * 
  * @return esp_err_t 返回ESP_OK表示成功，其他表示失败
  */
 esp_err_t xn_storage_init(void); // 初始化存储组件函数声明
 
+/**
+ * @brief 立即写入所有未提交的修改
+ * 
+ * 多次写入后调用一次，整批修改只产生一次提交
+ * 
+ * @return esp_err_t 返回ESP_OK表示成功，失败的修改保留到下次提交重试
+ */
+esp_err_t xn_storage_commit(void); // 提交修改函数声明
+
 /**
  * @brief 存储字符串
  * 
@@ -40,8 +73,8 @@ esp_err_t xn_storage_set_str(const char *key, const char *value); // 存储字
  * 
  * @param key 键名
  * @param out_value 输出缓冲区
- * @param length 缓冲区大小 (输入时为缓冲区大小，输出时为实际读取长度)
- * @return esp_err_t 返回ESP_OK表示成功，其他表示失败
+ * @param length 缓冲区大小 (输入时为缓冲区大小，输出时为实际读取长度)；out_value 为NULL时只返回所需长度
+ * @return esp_err_t 返回ESP_OK表示成功，ESP_ERR_NVS_NOT_FOUND 表示不存在，其他表示失败
  */
 esp_err_t xn_storage_get_str(const char *key, char *out_value, size_t *length); // 读取字符串函数声明
 
@@ -81,6 +114,38 @@ esp_err_t xn_storage_set_i32(const char *key, int32_t value); // 存储int32_t
  */
 esp_err_t xn_storage_get_i32(const char *key, int32_t *out_value); // 读取int32_t函数声明
 
+/**
+ * @brief 存储结构体记录
+ * 
+ * 一个逻辑对象（如WiFi配置列表）整体存为一个blob，带版本号和CRC32，
+ * 启动时一次读取即可恢复，不需要按字段拆成多个键
+ * 
+ * @param key 键名
+ * @param version 结构版本号，结构布局变化时递增
+ * @param data 结构体指针
+ * @param length 结构体长度
+ * @return esp_err_t 返回ESP_OK表示成功，其他表示失败
+ */
+esp_err_t xn_storage_set_record(const char *key, uint16_t version, const void *data, size_t length); // 存储记录函数声明
+
+/**
+ * @brief 读取结构体记录
+ * 
+ * @param key 键名
+ * @param version 期望的结构版本号
+ * @param out 输出结构体
+ * @param length 输出结构体长度
+ * @param migrate 版本不一致时的迁移回调，可为NULL（不迁移）
+ * @return esp_err_t 
+ *         - ESP_OK: 读取成功（含迁移成功）
+ *         - ESP_ERR_NVS_NOT_FOUND: 记录不存在
+ *         - ESP_ERR_INVALID_CRC: 记录已损坏
+ *         - ESP_ERR_INVALID_VERSION: 版本不一致且未能迁移
+ *         - ESP_ERR_INVALID_SIZE: 版本一致但长度不符
+ */
+esp_err_t xn_storage_get_record(const char *key, uint16_t version, void *out, size_t length,
+                                xn_storage_migrate_cb_t migrate); // 读取记录函数声明
+
 /**
  * @brief 删除指定键
  * 
@@ -89,9 +154,25 @@ esp_err_t xn_storage_get_i32(const char *key, int32_t *out_value); // 读取int3
  */
 esp_err_t xn_storage_erase(const char *key); // 删除指定键函数声明
 
-/* 
- * 注意：更复杂的存储需求（如Blob）可后续添加
+/**
+ * @brief 存储二进制数据
+ * 
+ * @param key 键名
+ * @param value 数据指针
+ * @param length 数据长度
+ * @return esp_err_t 返回ESP_OK表示成功，其他表示失败
+ */
+esp_err_t xn_storage_set_blob(const char *key, const void *value, size_t length); // 存储二进制数据函数声明
+
+/**
+ * @brief 读取二进制数据
+ * 
+ * @param key 键名
+ * @param out_value 输出缓冲区
+ * @param length 缓冲区大小 (输入时为缓冲区大小，输出时为实际读取长度)
+ * @return esp_err_t 返回ESP_OK表示成功，其他表示失败
  */
+esp_err_t xn_storage_get_blob(const char *key, void *out_value, size_t *length); // 读取二进制数据函数声明
 
 #ifdef __cplusplus // 如果是C++编译器
 }
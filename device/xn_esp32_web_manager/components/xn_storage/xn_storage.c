@@ -4,138 +4,508 @@
  * @LastEditors: xingnian jixingnian@gmail.com
  * @LastEditTime: 2026-01-23 13:30:00
  * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_storage\xn_storage.c
- * @Description: 通用存储组件实现 - 封装NVS操作
+ * @Description: 通用存储组件实现 - 封装NVS操作（常驻句柄 + RAM缓存 + 延迟批量提交）
  * VX:Jxingnian
- * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ * Copyright (c) 2026 by xingnian, All Rights Reserved.
  */
 
 #include "xn_storage.h" // 包含组件头文件
 #include "esp_log.h" // 包含日志库
+#include "xn_sched.h" // 包含共享调度器
+#include "esp_rom_crc.h" // 包含ROM CRC32
 #include "nvs_flash.h" // 包含NVS Flash库
 #include "nvs.h" // 包含NVS操作库
+#include "freertos/FreeRTOS.h" // 包含FreeRTOS核心
+#include "freertos/semphr.h" // 包含FreeRTOS信号量
+#include "sdkconfig.h" // 包含工程配置
+#include <string.h> // 包含字符串处理库
+#include <stdlib.h> // 包含内存分配
 
 static const char *TAG = "XN_STORAGE"; // 定义日志标签
 #define DEFAULT_NAMESPACE "xn_config" // 定义默认NVS命名空间
 
+/*
+ * 读写模型：
+ *   - 初始化时打开命名空间并一次性把全部键值读入RAM缓存，句柄常驻不关闭
+ *   - 读操作只查缓存，不访问Flash
+ *   - 写/删除只修改缓存并标记为脏，值未变化时直接忽略
+ *   - 脏数据在 xn_storage_commit() 或首次修改后 CONFIG_XN_STORAGE_COMMIT_DELAY_MS 到期时
+ *     一次性写入NVS并提交；延迟提交在共享调度器的工作任务中执行，NVS 擦写不占用 esp_timer 任务
+ */
+
+#define RECORD_MAGIC 0x5258 // 记录头魔数 "XR"
+
+// 记录头，后接 length 字节数据；crc 覆盖 version、length 和数据
+typedef struct {
+    uint16_t magic; // 魔数
+    uint16_t version; // 结构版本号
+    uint32_t length; // 数据长度
+    uint32_t crc; // CRC32
+} record_header_t;
+
+// 缓存条目状态
+typedef enum {
+    ENTRY_CLEAN = 0, // 与Flash一致
+    ENTRY_DIRTY, // 已修改，待写入
+    ENTRY_ERASED, // 已删除，待从Flash删除
+} entry_state_t;
+
+// 缓存条目
+typedef struct {
+    char key[NVS_KEY_NAME_MAX_SIZE]; // 键名
+    nvs_type_t type; // 值类型
+    entry_state_t state; // 条目状态
+    size_t length; // 值长度（字符串含结束符）
+    uint8_t *data; // 值数据
+} cache_entry_t;
+
+static nvs_handle_t s_handle = 0; // 常驻NVS句柄
+static bool s_initialized = false; // 初始化标志
+static SemaphoreHandle_t s_mutex = NULL; // 缓存与句柄保护锁（延迟提交在调度器任务中执行）
+static xn_sched_job_t s_commit_job; // 延迟提交作业
+static bool s_commit_pending = false; // 是否已安排延迟提交
+static cache_entry_t *s_entries = NULL; // 缓存条目数组
+static size_t s_entry_count = 0; // 条目数量
+static size_t s_entry_cap = 0; // 数组容量
+
+// 查找缓存条目（需持有锁），include_erased 为 false 时忽略已删除条目
+static cache_entry_t *find_entry(const char *key, bool include_erased)
+{
+    for (size_t i = 0; i < s_entry_count; i++) { // 遍历缓存
+        if (strcmp(s_entries[i].key, key) == 0) { // 键名匹配
+            if (!include_erased && s_entries[i].state == ENTRY_ERASED) return NULL; // 已删除视为不存在
+            return &s_entries[i]; // 返回条目
+        }
+    }
+    return NULL; // 未找到
+}
+
+// 新增缓存条目（需持有锁）
+static cache_entry_t *add_entry(const char *key)
+{
+    if (strlen(key) >= NVS_KEY_NAME_MAX_SIZE) return NULL; // 键名过长
+    if (s_entry_count == s_entry_cap) { // 容量不足时扩容
+        size_t cap = s_entry_cap ? s_entry_cap * 2 : 16; // 新容量
+        cache_entry_t *p = realloc(s_entries, cap * sizeof(cache_entry_t)); // 重新分配
+        if (p == NULL) return NULL; // 内存不足
+        s_entries = p; // 更新数组
+        s_entry_cap = cap; // 更新容量
+    }
+    cache_entry_t *e = &s_entries[s_entry_count++]; // 取新条目
+    memset(e, 0, sizeof(*e)); // 清零
+    strlcpy(e->key, key, sizeof(e->key)); // 拷贝键名
+    return e; // 返回条目
+}
+
+// 设置条目的值（需持有锁），loaded 为 true 表示从Flash加载，不标记为脏
+static esp_err_t put_entry(const char *key, nvs_type_t type, const void *value, size_t length, bool loaded)
+{
+    cache_entry_t *e = find_entry(key, true); // 查找（含已删除条目，复用其位置）
+    if (e && e->state != ENTRY_ERASED && e->type == type && e->length == length &&
+        memcmp(e->data, value, length) == 0) { // 值未变化
+        return ESP_OK; // 不产生写入
+    }
+
+    uint8_t *data = malloc(length ? length : 1); // 分配新值
+    if (data == NULL) return ESP_ERR_NO_MEM; // 内存不足
+    memcpy(data, value, length); // 拷贝值
+
+    if (e == NULL) { // 新键
+        e = add_entry(key); // 新增条目
+        if (e == NULL) { // 失败
+            free(data); // 释放新值
+            return ESP_ERR_NO_MEM; // 返回错误
+        }
+    }
+    free(e->data); // 释放旧值
+    e->data = data; // 更新值
+    e->type = type; // 更新类型
+    e->length = length; // 更新长度
+    e->state = loaded ? ENTRY_CLEAN : ENTRY_DIRTY; // 更新状态
+    return ESP_OK; // 返回成功
+}
+
+// 读取条目的值（需持有锁），与 nvs_get_* 的错误码一致
+static esp_err_t get_entry(const char *key, nvs_type_t type, void *out_value, size_t *length)
+{
+    cache_entry_t *e = find_entry(key, false); // 查找条目
+    if (e == NULL) return ESP_ERR_NVS_NOT_FOUND; // 不存在
+    if (e->type != type) return ESP_ERR_NVS_TYPE_MISMATCH; // 类型不符
+
+    if (out_value == NULL) { // 只查询长度
+        *length = e->length; // 返回所需长度
+        return ESP_OK; // 返回成功
+    }
+    if (*length < e->length) return ESP_ERR_NVS_INVALID_LENGTH; // 缓冲区不足
+    memcpy(out_value, e->data, e->length); // 拷贝值
+    *length = e->length; // 返回实际长度
+    return ESP_OK; // 返回成功
+}
+
+// 把一个脏条目写入NVS（需持有锁）
+static esp_err_t write_entry(const cache_entry_t *e)
+{
+    switch (e->type) { // 按类型写入
+        case NVS_TYPE_U8: return nvs_set_u8(s_handle, e->key, *(const uint8_t *)e->data); // 写入uint8_t
+        case NVS_TYPE_I32: { // 写入int32_t
+            int32_t v; // 数据可能未对齐，拷贝后写入
+            memcpy(&v, e->data, sizeof(v));
+            return nvs_set_i32(s_handle, e->key, v);
+        }
+        case NVS_TYPE_STR: return nvs_set_str(s_handle, e->key, (const char *)e->data); // 写入字符串
+        case NVS_TYPE_BLOB: return nvs_set_blob(s_handle, e->key, e->data, e->length); // 写入二进制数据
+        default: return ESP_ERR_NOT_SUPPORTED; // 不支持的类型
+    }
+}
+
+// 写入所有脏条目并提交（需持有锁）
+static esp_err_t flush_locked(void)
+{
+    esp_err_t ret = ESP_OK; // 返回值
+    bool changed = false; // 是否有写入
+    size_t i = 0; // 遍历下标
+
+    while (i < s_entry_count) { // 遍历缓存
+        cache_entry_t *e = &s_entries[i]; // 当前条目
+        if (e->state == ENTRY_DIRTY) { // 待写入
+            esp_err_t err = write_entry(e); // 写入NVS
+            if (err == ESP_OK) {
+                e->state = ENTRY_CLEAN; // 已同步
+                changed = true; // 需要提交
+            } else {
+                ESP_LOGE(TAG, "Failed to write key '%s': %s", e->key, esp_err_to_name(err)); // 打印写入失败日志
+                ret = err; // 保留为脏，下次提交重试
+            }
+        } else if (e->state == ENTRY_ERASED) { // 待删除
+            esp_err_t err = nvs_erase_key(s_handle, e->key); // 从NVS删除
+            if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND) {
+                free(e->data); // 释放值
+                s_entries[i] = s_entries[--s_entry_count]; // 末尾条目填补空位
+                changed = true; // 需要提交
+                continue; // 当前位置换成了新条目，重新检查
+            }
+            ESP_LOGE(TAG, "Failed to erase key '%s': %s", e->key, esp_err_to_name(err)); // 打印删除失败日志
+            ret = err; // 保留，下次提交重试
+        }
+        i++; // 下一个条目
+    }
+
+    if (changed) { // 有写入时提交一次
+        esp_err_t err = nvs_commit(s_handle); // 提交更改
+        if (err != ESP_OK) ret = err; // 提交失败
+    }
+    return ret; // 返回结果
+}
+
+// 延迟提交作业（调度器工作任务中执行）
+static void commit_job(void *arg)
+{
+    (void)arg; // 未使用
+    xn_storage_commit(); // 提交脏数据
+}
+
+// 标记有脏数据，安排延迟提交（需持有锁）
+static void schedule_commit(void)
+{
+    if (s_commit_pending) return; // 已安排，随同一批提交
+    if (xn_sched_schedule(&s_commit_job, CONFIG_XN_STORAGE_COMMIT_DELAY_MS) != ESP_OK) { // 安排作业
+        ESP_LOGW(TAG, "Failed to schedule commit, changes kept until xn_storage_commit()"); // 打印安排失败日志
+        return;
+    }
+    s_commit_pending = true; // 标记已安排
+}
+
+// 读取一个NVS条目到缓存（初始化时调用）
+static void load_entry(const nvs_entry_info_t *info)
+{
+    esp_err_t ret = ESP_ERR_NOT_SUPPORTED; // 读取结果
+    switch (info->type) { // 按类型读取
+        case NVS_TYPE_U8: {
+            uint8_t v = 0; // 值
+            ret = nvs_get_u8(s_handle, info->key, &v);
+            if (ret == ESP_OK) ret = put_entry(info->key, info->type, &v, sizeof(v), true);
+            break;
+        }
+        case NVS_TYPE_I32: {
+            int32_t v = 0; // 值
+            ret = nvs_get_i32(s_handle, info->key, &v);
+            if (ret == ESP_OK) ret = put_entry(info->key, info->type, &v, sizeof(v), true);
+            break;
+        }
+        case NVS_TYPE_STR:
+        case NVS_TYPE_BLOB: {
+            size_t len = 0; // 值长度
+            ret = (info->type == NVS_TYPE_STR) ? nvs_get_str(s_handle, info->key, NULL, &len)
+                                               : nvs_get_blob(s_handle, info->key, NULL, &len); // 查询长度
+            if (ret != ESP_OK) break;
+            void *buf = malloc(len ? len : 1); // 临时缓冲区
+            if (buf == NULL) {
+                ret = ESP_ERR_NO_MEM;
+                break;
+            }
+            ret = (info->type == NVS_TYPE_STR) ? nvs_get_str(s_handle, info->key, buf, &len)
+                                               : nvs_get_blob(s_handle, info->key, buf, &len); // 读取值
+            if (ret == ESP_OK) ret = put_entry(info->key, info->type, buf, len, true);
+            free(buf); // 释放临时缓冲区
+            break;
+        }
+        default:
+            break; // 其他类型本组件不写入，忽略
+    }
+    if (ret != ESP_OK && ret != ESP_ERR_NOT_SUPPORTED) {
+        ESP_LOGW(TAG, "Failed to load key '%s': %s", info->key, esp_err_to_name(ret)); // 打印加载失败日志
+    }
+}
+
 // 初始化存储组件
 esp_err_t xn_storage_init(void)
 {
-    // NVS初始化通常在main中调用nvs_flash_init()，这里作为组件可以不做全局init，
-    // 或者为了保险起见，仅仅是LOG一下。实际NVS Flash Init应该由App层负责。
-    // 但为了方便作为一个独立模块使用，我们可以检查并初始化。
+    if (s_initialized) return ESP_OK; // 已初始化，多个模块可重复调用
+
+    // NVS Flash Init 通常由App层负责，这里作为独立模块也检查并初始化
     esp_err_t ret = nvs_flash_init(); // 初始化默认NVS分区
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) { // 如果NVS页面满或版本不同
         ESP_LOGW(TAG, "NVS flash erase and init..."); // 打印擦除日志
         ESP_ERROR_CHECK(nvs_flash_erase()); // 擦除NVS Flash
         ret = nvs_flash_init(); // 重新初始化
     }
-    return ret; // 返回结果
-}
+    if (ret != ESP_OK) return ret; // 初始化失败
 
-// 打开NVS句柄
-static esp_err_t open_nvs(nvs_handle_t *handle, nvs_open_mode_t mode)
-{
-    esp_err_t ret = nvs_open(DEFAULT_NAMESPACE, mode, handle); // 打开NVS命名空间
+    s_mutex = xSemaphoreCreateMutex(); // 创建保护锁
+    if (s_mutex == NULL) return ESP_ERR_NO_MEM; // 内存不足
+
+    ret = xn_sched_init(); // 延迟提交依赖调度器，已初始化时直接返回
+    if (ret != ESP_OK) goto err; // 初始化失败
+    xn_sched_job_init(&s_commit_job, commit_job, NULL, "storage_commit"); // 初始化提交作业
+
+    ret = nvs_open(DEFAULT_NAMESPACE, NVS_READWRITE, &s_handle); // 打开命名空间，句柄常驻
     if (ret != ESP_OK) { // 如果打开失败
         ESP_LOGE(TAG, "Failed to open NVS namespace '%s': %s", DEFAULT_NAMESPACE, esp_err_to_name(ret)); // 打印错误日志
+        goto err;
     }
+
+    // 一次性加载命名空间内全部键值
+    nvs_iterator_t it = NULL; // 条目迭代器
+    esp_err_t res = nvs_entry_find(NVS_DEFAULT_PART_NAME, DEFAULT_NAMESPACE, NVS_TYPE_ANY, &it); // 查找第一个条目
+    while (res == ESP_OK) { // 遍历所有条目
+        nvs_entry_info_t info; // 条目信息
+        nvs_entry_info(it, &info); // 读取条目信息
+        load_entry(&info); // 加载到缓存
+        res = nvs_entry_next(&it); // 下一个条目
+    }
+    nvs_release_iterator(it); // 释放迭代器
+
+    s_initialized = true; // 标记初始化完成
+    ESP_LOGI(TAG, "Loaded %d keys from '%s'", (int)s_entry_count, DEFAULT_NAMESPACE); // 打印加载结果
+    return ESP_OK; // 返回成功
+
+err:
+    vSemaphoreDelete(s_mutex); // 删除保护锁
+    s_mutex = NULL;
+    return ret; // 返回错误
+}
+
+// 提交未写入的修改
+esp_err_t xn_storage_commit(void)
+{
+    if (!s_initialized) return ESP_ERR_INVALID_STATE; // 未初始化
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY); // 加锁
+    xn_sched_cancel(&s_commit_job); // 取消待执行的延迟提交
+    s_commit_pending = false; // 清除标记
+    esp_err_t ret = flush_locked(); // 写入并提交
+    xSemaphoreGive(s_mutex); // 解锁
     return ret; // 返回结果
 }
 
-// 存储字符串
-esp_err_t xn_storage_set_str(const char *key, const char *value)
+// 写入缓存并安排提交
+static esp_err_t storage_set(const char *key, nvs_type_t type, const void *value, size_t length)
 {
-    nvs_handle_t handle; // NVS句柄
-    esp_err_t ret = open_nvs(&handle, NVS_READWRITE); // 打开NVS，读写模式
-    if (ret != ESP_OK) return ret; // 如果失败直接返回
+    if (key == NULL || value == NULL) return ESP_ERR_INVALID_ARG; // 参数检查
+    if (!s_initialized) return ESP_ERR_INVALID_STATE; // 未初始化
 
-    ret = nvs_set_str(handle, key, value); // 写入字符串，键为key
-    if (ret == ESP_OK) { // 如果写入成功
-        ret = nvs_commit(handle); // 提交更改
-    } else {
-        ESP_LOGE(TAG, "Failed to set str key '%s': %s", key, esp_err_to_name(ret)); // 打印写入失败日志
+    xSemaphoreTake(s_mutex, portMAX_DELAY); // 加锁
+    esp_err_t ret = put_entry(key, type, value, length, false); // 更新缓存
+    if (ret == ESP_OK && find_entry(key, false)->state == ENTRY_DIRTY) { // 值有变化
+        schedule_commit(); // 安排延迟提交
+    } else if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set key '%s': %s", key, esp_err_to_name(ret)); // 打印写入失败日志
     }
-    nvs_close(handle); // 关闭NVS句柄
+    xSemaphoreGive(s_mutex); // 解锁
     return ret; // 返回结果
 }
 
-// 读取字符串
-esp_err_t xn_storage_get_str(const char *key, char *out_value, size_t *length)
+// 从缓存读取
+static esp_err_t storage_get(const char *key, nvs_type_t type, void *out_value, size_t *length)
 {
-    nvs_handle_t handle; // NVS句柄
-    esp_err_t ret = open_nvs(&handle, NVS_READONLY); // 打开NVS，只读模式
-    if (ret != ESP_OK) return ret; // 如果失败直接返回
+    if (key == NULL || length == NULL) return ESP_ERR_INVALID_ARG; // 参数检查
+    if (!s_initialized) return ESP_ERR_INVALID_STATE; // 未初始化
 
-    ret = nvs_get_str(handle, key, out_value, length); // 读取字符串
-    nvs_close(handle); // 关闭NVS句柄
+    xSemaphoreTake(s_mutex, portMAX_DELAY); // 加锁
+    esp_err_t ret = get_entry(key, type, out_value, length); // 查缓存
+    xSemaphoreGive(s_mutex); // 解锁
     return ret; // 返回结果
 }
 
+// 存储字符串
+esp_err_t xn_storage_set_str(const char *key, const char *value)
+{
+    if (value == NULL) return ESP_ERR_INVALID_ARG; // 参数检查
+    return storage_set(key, NVS_TYPE_STR, value, strlen(value) + 1); // 含结束符
+}
+
+// 读取字符串
+esp_err_t xn_storage_get_str(const char *key, char *out_value, size_t *length)
+{
+    return storage_get(key, NVS_TYPE_STR, out_value, length); // 查缓存
+}
+
 // 存储uint8_t
 esp_err_t xn_storage_set_u8(const char *key, uint8_t value)
 {
-    nvs_handle_t handle; // NVS句柄
-    esp_err_t ret = open_nvs(&handle, NVS_READWRITE); // 打开NVS，读写模式
-    if (ret != ESP_OK) return ret; // 如果失败直接返回 
-
-    ret = nvs_set_u8(handle, key, value); // 写入uint8_t值
-    if (ret == ESP_OK) { // 如果写入成功
-        ret = nvs_commit(handle); // 提交更改
-    }
-    nvs_close(handle); // 关闭NVS句柄
-    return ret; // 返回结果
+    return storage_set(key, NVS_TYPE_U8, &value, sizeof(value)); // 写入缓存
 }
 
 // 读取uint8_t
 esp_err_t xn_storage_get_u8(const char *key, uint8_t *out_value)
 {
-    nvs_handle_t handle; // NVS句柄
-    esp_err_t ret = open_nvs(&handle, NVS_READONLY); // 打开NVS，只读模式
-    if (ret != ESP_OK) return ret; // 如果失败直接返回
-
-    ret = nvs_get_u8(handle, key, out_value); // 读取uint8_t值
-    nvs_close(handle); // 关闭NVS句柄
-    return ret; // 返回结果
+    if (out_value == NULL) return ESP_ERR_INVALID_ARG; // 参数检查
+    size_t len = sizeof(*out_value); // 值长度
+    return storage_get(key, NVS_TYPE_U8, out_value, &len); // 查缓存
 }
 
 // 存储int32_t
 esp_err_t xn_storage_set_i32(const char *key, int32_t value)
 {
-    nvs_handle_t handle; // NVS句柄
-    esp_err_t ret = open_nvs(&handle, NVS_READWRITE); // 打开NVS，读写模式
-    if (ret != ESP_OK) return ret; // 如果失败直接返回
-
-    ret = nvs_set_i32(handle, key, value); // 写入int32_t值
-    if (ret == ESP_OK) { // 如果写入成功
-        ret = nvs_commit(handle); // 提交更改
-    }
-    nvs_close(handle); // 关闭NVS句柄
-    return ret; // 返回结果
+    return storage_set(key, NVS_TYPE_I32, &value, sizeof(value)); // 写入缓存
 }
 
 // 读取int32_t
 esp_err_t xn_storage_get_i32(const char *key, int32_t *out_value)
 {
-    nvs_handle_t handle; // NVS句柄
-    esp_err_t ret = open_nvs(&handle, NVS_READONLY); // 打开NVS，只读模式
-    if (ret != ESP_OK) return ret; // 如果失败直接返回
+    if (out_value == NULL) return ESP_ERR_INVALID_ARG; // 参数检查
+    size_t len = sizeof(*out_value); // 值长度
+    return storage_get(key, NVS_TYPE_I32, out_value, &len); // 查缓存
+}
+
+// 存储二进制数据
+esp_err_t xn_storage_set_blob(const char *key, const void *value, size_t length)
+{
+    return storage_set(key, NVS_TYPE_BLOB, value, length); // 写入缓存
+}
 
-    ret = nvs_get_i32(handle, key, out_value); // 读取int32_t值
-    nvs_close(handle); // 关闭NVS句柄
+// 读取二进制数据
+esp_err_t xn_storage_get_blob(const char *key, void *out_value, size_t *length)
+{
+    return storage_get(key, NVS_TYPE_BLOB, out_value, length); // 查缓存
+}
+
+// 计算记录CRC
+static uint32_t record_crc(const record_header_t *hdr, const void *data)
+{
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)&hdr->version, sizeof(hdr->version) + sizeof(hdr->length)); // 版本和长度
+    return esp_rom_crc32_le(crc, data, hdr->length); // 数据
+}
+
+// 存储结构体记录
+esp_err_t xn_storage_set_record(const char *key, uint16_t version, const void *data, size_t length)
+{
+    if (data == NULL) return ESP_ERR_INVALID_ARG; // 参数检查
+
+    uint8_t *buf = malloc(sizeof(record_header_t) + length); // 记录缓冲区
+    if (buf == NULL) return ESP_ERR_NO_MEM; // 内存不足
+
+    record_header_t hdr = { // 填充记录头
+        .magic = RECORD_MAGIC,
+        .version = version,
+        .length = length,
+    };
+    hdr.crc = record_crc(&hdr, data); // 计算CRC
+    memcpy(buf, &hdr, sizeof(hdr)); // 拷贝记录头
+    memcpy(buf + sizeof(hdr), data, length); // 拷贝数据
+
+    esp_err_t ret = storage_set(key, NVS_TYPE_BLOB, buf, sizeof(hdr) + length); // 整体写入缓存
+    free(buf); // 释放缓冲区
     return ret; // 返回结果
 }
 
+// 读取结构体记录
+esp_err_t xn_storage_get_record(const char *key, uint16_t version, void *out, size_t length,
+                                xn_storage_migrate_cb_t migrate)
+{
+    if (key == NULL || out == NULL) return ESP_ERR_INVALID_ARG; // 参数检查
+    if (!s_initialized) return ESP_ERR_INVALID_STATE; // 未初始化
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY); // 加锁
+    cache_entry_t *e = find_entry(key, false); // 查找条目
+    if (e == NULL || e->type != NVS_TYPE_BLOB) { // 不存在或不是记录
+        xSemaphoreGive(s_mutex); // 解锁
+        return ESP_ERR_NVS_NOT_FOUND; // 不存在
+    }
+
+    record_header_t hdr; // 记录头
+    if (e->length < sizeof(hdr)) { // 长度不足一个记录头
+        xSemaphoreGive(s_mutex); // 解锁
+        return ESP_ERR_INVALID_CRC; // 视为损坏
+    }
+    memcpy(&hdr, e->data, sizeof(hdr)); // 读取记录头
+    const uint8_t *payload = e->data + sizeof(hdr); // 数据起点
+    if (hdr.magic != RECORD_MAGIC || hdr.length != e->length - sizeof(hdr) ||
+        record_crc(&hdr, payload) != hdr.crc) { // 校验失败
+        xSemaphoreGive(s_mutex); // 解锁
+        ESP_LOGW(TAG, "Record '%s' corrupted", key); // 打印损坏日志
+        return ESP_ERR_INVALID_CRC; // 已损坏
+    }
+
+    if (hdr.version == version) { // 版本一致
+        esp_err_t ret = ESP_OK; // 返回值
+        if (hdr.length == length) {
+            memcpy(out, payload, length); // 拷贝数据
+        } else {
+            ret = ESP_ERR_INVALID_SIZE; // 同版本长度不符，结构改了却没升级版本
+        }
+        xSemaphoreGive(s_mutex); // 解锁
+        return ret; // 返回结果
+    }
+
+    // 版本不一致：复制旧数据后在锁外调用迁移回调
+    if (migrate == NULL) { // 不支持迁移
+        xSemaphoreGive(s_mutex); // 解锁
+        return ESP_ERR_INVALID_VERSION; // 版本不符
+    }
+    uint8_t *old = malloc(hdr.length ? hdr.length : 1); // 旧数据副本
+    if (old == NULL) { // 内存不足
+        xSemaphoreGive(s_mutex); // 解锁
+        return ESP_ERR_NO_MEM; // 返回错误
+    }
+    memcpy(old, payload, hdr.length); // 复制旧数据
+    xSemaphoreGive(s_mutex); // 解锁
+
+    memset(out, 0, length); // 清零输出
+    esp_err_t ret = migrate(hdr.version, old, hdr.length, out, length); // 迁移
+    free(old); // 释放旧数据
+    if (ret != ESP_OK) { // 迁移失败
+        ESP_LOGW(TAG, "Record '%s' v%u -> v%u migration failed", key, hdr.version, version); // 打印迁移失败日志
+        return ESP_ERR_INVALID_VERSION; // 版本不符
+    }
+    ESP_LOGI(TAG, "Record '%s' migrated v%u -> v%u", key, hdr.version, version); // 打印迁移日志
+    return xn_storage_set_record(key, version, out, length); // 以当前版本写回，只迁移一次
+}
+
 // 删除指定键
 esp_err_t xn_storage_erase(const char *key)
 {
-    nvs_handle_t handle; // NVS句柄
-    esp_err_t ret = open_nvs(&handle, NVS_READWRITE); // 打开NVS，读写模式
-    if (ret != ESP_OK) return ret; // 如果失败直接返回
+    if (key == NULL) return ESP_ERR_INVALID_ARG; // 参数检查
+    if (!s_initialized) return ESP_ERR_INVALID_STATE; // 未初始化
 
-    ret = nvs_erase_key(handle, key); // 删除指定键
-    if (ret == ESP_OK) { // 如果删除成功
-        ret = nvs_commit(handle); // 提交更改
+    xSemaphoreTake(s_mutex, portMAX_DELAY); // 加锁
+    esp_err_t ret = ESP_ERR_NVS_NOT_FOUND; // 默认不存在
+    cache_entry_t *e = find_entry(key, false); // 查找条目
+    if (e) {
+        e->state = ENTRY_ERASED; // 标记删除，提交时从Flash删除
+        schedule_commit(); // 安排延迟提交
+        ret = ESP_OK; // 删除成功
     }
-    nvs_close(handle); // 关闭NVS句柄
+    xSemaphoreGive(s_mutex); // 解锁
     return ret; // 返回结果
 }
@@ -0,0 +1,115 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 18:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 18:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_sysmon\include\xn_sysmon.h
+ * @Description: 系统监控组件头文件 - 任务栈水位、任务 CPU 占用与分类堆内存采样
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_SYSMON_H
+#define XN_SYSMON_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ *                          类型定义
+ *===========================================================================*/
+
+#define XN_SYSMON_MAX_TASKS     32      ///< 快照最多记录的任务数（按栈余量从小到大保留）
+#define XN_SYSMON_NAME_LEN      16      ///< 任务名最大长度（含结尾 '\0'）
+#define XN_SYSMON_CPU_UNKNOWN   0xFFFF  ///< 未开启运行时间统计或首次采样时的 CPU 占用
+
+/**
+ * @brief 堆内存类型
+ */
+typedef enum {
+    XN_SYSMON_HEAP_INTERNAL = 0,        ///< 内部 RAM（MALLOC_CAP_INTERNAL）
+    XN_SYSMON_HEAP_DMA,                 ///< DMA 可用内存（MALLOC_CAP_DMA）
+    XN_SYSMON_HEAP_PSRAM,               ///< PSRAM（MALLOC_CAP_SPIRAM，未开启时全为0）
+    XN_SYSMON_HEAP_COUNT,
+} xn_sysmon_heap_type_t;
+
+/**
+ * @brief 单类堆内存状态
+ */
+typedef struct {
+    uint32_t total;                     ///< 总字节数
+    uint32_t free;                      ///< 当前空闲字节数
+    uint32_t min_free;                  ///< 启动以来最低空闲字节数
+    uint32_t largest;                   ///< 当前最大可分配块字节数（反映碎片）
+} xn_sysmon_heap_t;
+
+/**
+ * @brief 单个任务状态
+ */
+typedef struct {
+    char name[XN_SYSMON_NAME_LEN];      ///< 任务名
+    uint32_t stack_free;                ///< 栈历史最小余量（字节），即剩余的高水位
+    uint16_t cpu_permille;              ///< 两次采样之间占全部核心时间的千分比，XN_SYSMON_CPU_UNKNOWN 表示未知
+    uint8_t priority;                   ///< 当前优先级
+} xn_sysmon_task_t;
+
+/**
+ * @brief 系统快照
+ */
+typedef struct {
+    uint32_t uptime_s;                  ///< 运行时间(s)
+    uint32_t window_ms;                 ///< 距上次采样的时间（CPU 占用的统计窗口），首次为0
+    xn_sysmon_heap_t heap[XN_SYSMON_HEAP_COUNT]; ///< 各类堆内存状态
+    uint16_t task_total;                ///< 系统中的任务总数
+    uint16_t task_count;                ///< tasks 中的有效项数（未开启 trace facility 时为0）
+    xn_sysmon_task_t tasks[XN_SYSMON_MAX_TASKS]; ///< 任务状态，按 stack_free 从小到大排序
+} xn_sysmon_snapshot_t;
+
+/*===========================================================================
+ *                          API
+ *===========================================================================*/
+
+/**
+ * @brief 采样一次系统状态
+ *
+ * - 任务列表需要 CONFIG_FREERTOS_USE_TRACE_FACILITY，CPU 占用另需
+ *   CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS，未开启时对应字段为0或未知
+ * - CPU 占用按两次调用之间的运行时间差计算，组件内部保存上次的计数；
+ *   同一时间只应由一个任务调用
+ * - 采样期间临时分配 TaskStatus_t 数组（任务数 x 约40字节）
+ *
+ * @param snap 输出快照（约 900 字节，建议堆上分配）
+ * @return esp_err_t
+ *      - ESP_OK: 成功
+ *      - ESP_ERR_INVALID_ARG: snap 为 NULL
+ *      - ESP_ERR_NO_MEM: 任务列表分配失败（堆内存部分仍然有效）
+ */
+esp_err_t xn_sysmon_sample(xn_sysmon_snapshot_t *snap);
+
+/**
+ * @brief 把快照编码为紧凑 JSON
+ *
+ * 格式：{"up":s,"win":ms,"heap":{"int":[total,free,min,largest],"dma":[...],"psram":[...]},
+ *        "tasks_total":n,"tasks":[["name",stack_free,cpu_permille,prio],...]}，
+ * CPU 未知时为 -1。
+ *
+ * @return int JSON 长度，缓冲区不足时返回 -1
+ */
+int xn_sysmon_to_json(const xn_sysmon_snapshot_t *snap, char *buf, size_t size);
+
+/**
+ * @brief 把快照打印到日志
+ */
+void xn_sysmon_dump(const xn_sysmon_snapshot_t *snap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // XN_SYSMON_H
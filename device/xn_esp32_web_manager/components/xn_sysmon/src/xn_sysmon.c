@@ -0,0 +1,264 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 18:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 18:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_sysmon\src\xn_sysmon.c
+ * @Description: 系统监控组件实现 - 任务栈水位、任务 CPU 占用与分类堆内存采样
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include "xn_sysmon.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "xn_sysmon";
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+#define SYSMON_PREV_MAX     48          ///< 保存上次运行时间计数的任务数上限
+#define SYSMON_STATUS_SLACK 4           ///< 取任务数后到采样之间新建任务的余量
+
+typedef struct {
+    TaskHandle_t handle;                ///< 任务句柄
+    uint32_t runtime;                   ///< 上次采样时的运行时间计数
+} sysmon_prev_t;
+
+typedef struct {
+    int64_t last_us;                    ///< 上次采样时间
+    uint32_t last_total;                ///< 上次采样时的总运行时间计数
+    uint16_t prev_count;                ///< prev 中的有效项数
+    sysmon_prev_t prev[SYSMON_PREV_MAX]; ///< 上次各任务的运行时间计数
+} sysmon_ctx_t;
+
+static sysmon_ctx_t s_ctx = {0};
+
+static const uint32_t s_heap_caps[XN_SYSMON_HEAP_COUNT] = {
+    [XN_SYSMON_HEAP_INTERNAL] = MALLOC_CAP_INTERNAL,
+    [XN_SYSMON_HEAP_DMA]      = MALLOC_CAP_DMA,
+    [XN_SYSMON_HEAP_PSRAM]    = MALLOC_CAP_SPIRAM,
+};
+
+static const char *const s_heap_names[XN_SYSMON_HEAP_COUNT] = {
+    [XN_SYSMON_HEAP_INTERNAL] = "int",
+    [XN_SYSMON_HEAP_DMA]      = "dma",
+    [XN_SYSMON_HEAP_PSRAM]    = "psram",
+};
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 采样各类堆内存
+ */
+static void sample_heap(xn_sysmon_snapshot_t *snap)
+{
+    for (int i = 0; i < XN_SYSMON_HEAP_COUNT; i++) {
+        multi_heap_info_t info;
+        heap_caps_get_info(&info, s_heap_caps[i]);
+        snap->heap[i].total = (uint32_t)heap_caps_get_total_size(s_heap_caps[i]);
+        snap->heap[i].free = (uint32_t)info.total_free_bytes;
+        snap->heap[i].min_free = (uint32_t)info.minimum_free_bytes;
+        snap->heap[i].largest = (uint32_t)info.largest_free_block;
+    }
+}
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+
+static int cmp_stack_free(const void *a, const void *b)
+{
+    const TaskStatus_t *x = (const TaskStatus_t *)a;
+    const TaskStatus_t *y = (const TaskStatus_t *)b;
+    return (x->usStackHighWaterMark > y->usStackHighWaterMark) - (x->usStackHighWaterMark < y->usStackHighWaterMark);
+}
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+/**
+ * @brief 查找任务上次的运行时间计数
+ */
+static bool prev_runtime(TaskHandle_t handle, uint32_t *runtime)
+{
+    for (uint16_t i = 0; i < s_ctx.prev_count; i++) {
+        if (s_ctx.prev[i].handle == handle) {
+            *runtime = s_ctx.prev[i].runtime;
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+/**
+ * @brief 采样任务列表：栈余量与 CPU 占用
+ */
+static esp_err_t sample_tasks(xn_sysmon_snapshot_t *snap)
+{
+    UBaseType_t capacity = uxTaskGetNumberOfTasks() + SYSMON_STATUS_SLACK;
+    TaskStatus_t *status = malloc(capacity * sizeof(TaskStatus_t));
+    if (status == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t n = uxTaskGetSystemState(status, capacity, &total);
+    snap->task_total = (uint16_t)n;
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    // 计数器为单调递增的 32 位值，无符号相减可跨一次回绕；计数覆盖所有核心
+    uint32_t window = (uint32_t)total - s_ctx.last_total;
+    uint64_t capacity_ticks = (uint64_t)window * portNUM_PROCESSORS;
+    bool have_prev = s_ctx.prev_count > 0 && window > 0;
+#endif
+
+    // 先按栈余量排序，任务数超过上限时保留最紧张的
+    qsort(status, n, sizeof(TaskStatus_t), cmp_stack_free);
+
+    snap->task_count = 0;
+    for (UBaseType_t i = 0; i < n && snap->task_count < XN_SYSMON_MAX_TASKS; i++) {
+        xn_sysmon_task_t *t = &snap->tasks[snap->task_count++];
+        strlcpy(t->name, status[i].pcTaskName, sizeof(t->name));
+        t->stack_free = (uint32_t)status[i].usStackHighWaterMark;
+        t->priority = (uint8_t)status[i].uxCurrentPriority;
+        t->cpu_permille = XN_SYSMON_CPU_UNKNOWN;
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+        uint32_t last;
+        if (have_prev && prev_runtime(status[i].xHandle, &last)) {
+            uint32_t used = (uint32_t)status[i].ulRunTimeCounter - last;
+            uint64_t permille = (uint64_t)used * 1000 / capacity_ticks;
+            t->cpu_permille = (uint16_t)(permille > 1000 ? 1000 : permille);
+        }
+#endif
+    }
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    // 保存本次计数，供下次计算差值
+    s_ctx.prev_count = 0;
+    for (UBaseType_t i = 0; i < n && s_ctx.prev_count < SYSMON_PREV_MAX; i++) {
+        s_ctx.prev[s_ctx.prev_count].handle = status[i].xHandle;
+        s_ctx.prev[s_ctx.prev_count].runtime = (uint32_t)status[i].ulRunTimeCounter;
+        s_ctx.prev_count++;
+    }
+    s_ctx.last_total = (uint32_t)total;
+#else
+    (void)total;
+#endif
+
+    free(status);
+    return ESP_OK;
+}
+
+#endif /* CONFIG_FREERTOS_USE_TRACE_FACILITY */
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+esp_err_t xn_sysmon_sample(xn_sysmon_snapshot_t *snap)
+{
+    if (snap == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t now = esp_timer_get_time();
+    snap->uptime_s = (uint32_t)(now / 1000000);
+    snap->window_ms = s_ctx.last_us > 0 ? (uint32_t)((now - s_ctx.last_us) / 1000) : 0;
+    s_ctx.last_us = now;
+
+    sample_heap(snap);
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+    return sample_tasks(snap);
+#else
+    snap->task_total = (uint16_t)uxTaskGetNumberOfTasks();
+    snap->task_count = 0;
+    return ESP_OK;
+#endif
+}
+
+int xn_sysmon_to_json(const xn_sysmon_snapshot_t *snap, char *buf, size_t size)
+{
+    if (snap == NULL || buf == NULL) {
+        return -1;
+    }
+
+    size_t pos = 0;
+    int n = snprintf(buf, size, "{\"up\":%u,\"win\":%u,\"heap\":{",
+                     (unsigned)snap->uptime_s, (unsigned)snap->window_ms);
+    if (n < 0 || (size_t)n >= size) {
+        return -1;
+    }
+    pos = n;
+
+    for (int i = 0; i < XN_SYSMON_HEAP_COUNT; i++) {
+        const xn_sysmon_heap_t *h = &snap->heap[i];
+        n = snprintf(buf + pos, size - pos, "%s\"%s\":[%u,%u,%u,%u]", (i > 0) ? "," : "", s_heap_names[i],
+                     (unsigned)h->total, (unsigned)h->free, (unsigned)h->min_free, (unsigned)h->largest);
+        if (n < 0 || (size_t)n >= size - pos) {
+            return -1;
+        }
+        pos += n;
+    }
+
+    n = snprintf(buf + pos, size - pos, "},\"tasks_total\":%u,\"tasks\":[", (unsigned)snap->task_total);
+    if (n < 0 || (size_t)n >= size - pos) {
+        return -1;
+    }
+    pos += n;
+
+    for (uint16_t i = 0; i < snap->task_count; i++) {
+        const xn_sysmon_task_t *t = &snap->tasks[i];
+        int cpu = (t->cpu_permille == XN_SYSMON_CPU_UNKNOWN) ? -1 : (int)t->cpu_permille;
+        n = snprintf(buf + pos, size - pos, "%s[\"%s\",%u,%d,%u]", (i > 0) ? "," : "",
+                     t->name, (unsigned)t->stack_free, cpu, (unsigned)t->priority);
+        if (n < 0 || (size_t)n >= size - pos) {
+            return -1;
+        }
+        pos += n;
+    }
+
+    n = snprintf(buf + pos, size - pos, "]}");
+    if (n < 0 || (size_t)n >= size - pos) {
+        return -1;
+    }
+    return (int)(pos + n);
+}
+
+void xn_sysmon_dump(const xn_sysmon_snapshot_t *snap)
+{
+    if (snap == NULL) {
+        return;
+    }
+
+    ESP_LOGI(TAG, "uptime %us, window %ums, tasks %u",
+             (unsigned)snap->uptime_s, (unsigned)snap->window_ms, (unsigned)snap->task_total);
+    for (int i = 0; i < XN_SYSMON_HEAP_COUNT; i++) {
+        const xn_sysmon_heap_t *h = &snap->heap[i];
+        if (h->total == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG, "heap %-5s total %7u free %7u min %7u largest %7u", s_heap_names[i],
+                 (unsigned)h->total, (unsigned)h->free, (unsigned)h->min_free, (unsigned)h->largest);
+    }
+    for (uint16_t i = 0; i < snap->task_count; i++) {
+        const xn_sysmon_task_t *t = &snap->tasks[i];
+        if (t->cpu_permille == XN_SYSMON_CPU_UNKNOWN) {
+            ESP_LOGI(TAG, "task %-16s stack_free %5u prio %2u", t->name,
+                     (unsigned)t->stack_free, (unsigned)t->priority);
+        } else {
+            ESP_LOGI(TAG, "task %-16s stack_free %5u prio %2u cpu %3u.%u%%", t->name,
+                     (unsigned)t->stack_free, (unsigned)t->priority,
+                     (unsigned)(t->cpu_permille / 10), (unsigned)(t->cpu_permille % 10));
+        }
+    }
+}
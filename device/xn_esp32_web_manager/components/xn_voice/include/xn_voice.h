@@ -0,0 +1,156 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-26 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-26 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_voice\include\xn_voice.h
+ * @Description: 语音上行组件头文件 - 语音段 Opus 编码与带序号的分包
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef XN_VOICE_H
+#define XN_VOICE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ *                          包格式
+ *===========================================================================*/
+
+/*
+ * 每个包 = 14 字节包头 + frame_count 个 Opus 帧，多字节字段均为小端：
+ *
+ *   偏移  长度  字段
+ *   0     1     magic      'V'
+ *   1     1     version    XN_VOICE_PACKET_VERSION
+ *   2     1     flags      XN_VOICE_FLAG_*
+ *   3     1     frame_ms   每个 Opus 帧的时长
+ *   4     2     session    语音段编号，每段语音加一
+ *   6     2     seq        段内包序号，从0开始
+ *   8     4     timestamp  首帧首采样在本段内的采样偏移（丢帧时跳变，接收端据此补静音）
+ *   12    1     frame_count
+ *   13    1     reserved
+ *   14    ...   frame_count 个 { u16 len, len 字节 Opus 数据 }
+ *
+ * 接收端按 session/seq 排序去重，按 timestamp 放入抖动缓冲；END 包可以不带帧。
+ * 下行语音（xn_player）使用同一格式。
+ */
+
+#define XN_VOICE_PACKET_MAGIC       'V'     ///< 包头魔数
+#define XN_VOICE_PACKET_VERSION     1       ///< 包格式版本
+#define XN_VOICE_HEADER_SIZE        14      ///< 包头长度
+
+#define XN_VOICE_FLAG_START         0x01    ///< 语音段第一个包
+#define XN_VOICE_FLAG_END           0x02    ///< 语音段最后一个包
+#define XN_VOICE_FLAG_DISCONTINUITY 0x04    ///< 本包之前有数据被丢弃（采集或发送背压）
+
+/*===========================================================================
+ *                          类型定义
+ *===========================================================================*/
+
+/**
+ * @brief 发送回调（在编码任务中执行）
+ *
+ * 返回 ESP_OK 以外的值表示本包被丢弃（如链路积压），组件计入统计，
+ * 并在下一个包上置 XN_VOICE_FLAG_DISCONTINUITY。回调不应长时间阻塞，
+ * 否则编码队列积满后在采集侧丢帧。
+ *
+ * @param packet 包数据（回调返回后失效）
+ * @param len 包长度
+ * @param user_data 用户数据
+ */
+typedef esp_err_t (*xn_voice_send_cb_t)(const uint8_t *packet, size_t len, void *user_data);
+
+/**
+ * @brief 上行统计
+ */
+typedef struct {
+    uint32_t sessions;                  ///< 语音段数
+    uint32_t packets_sent;              ///< 发送成功的包数
+    uint32_t packets_dropped;           ///< 发送回调拒绝的包数
+    uint32_t frames_dropped;            ///< 编码队列满时在采集侧丢弃的 PCM 帧数
+    uint32_t bytes_sent;                ///< 发送成功的字节数（含包头）
+    uint32_t encode_avg_us;             ///< 单个 Opus 帧平均编码耗时
+    uint32_t encode_max_us;             ///< 单个 Opus 帧最大编码耗时
+} xn_voice_stats_t;
+
+/**
+ * @brief 语音上行配置
+ */
+typedef struct {
+    // 编码配置
+    uint32_t sample_rate;               ///< 采样率，需与 xn_audio 一致（默认16000）
+    uint16_t frame_ms;                  ///< Opus 帧时长：20/40/60（默认20）
+    uint8_t frames_per_packet;          ///< 每包 Opus 帧数（默认3，即每 60ms 一包）
+    uint32_t bitrate;                   ///< 码率 bps（默认24000）
+    uint8_t complexity;                 ///< 编码复杂度 0~10（默认3，越高越耗 CPU）
+
+    // 缓冲配置
+    uint16_t preroll_ms;                ///< VAD 判定前保留的音频(ms)，补回语音起始（默认100）
+    uint8_t queue_frames;               ///< 等待编码的 PCM 帧队列深度（默认8）
+
+    // 编码任务
+    int task_core;                      ///< 运行核心（默认1，tskNO_AFFINITY 不绑定）
+    uint8_t task_priority;              ///< 任务优先级（默认10，低于采集任务）
+    uint32_t task_stack_size;           ///< 任务栈大小（默认24576，Opus 编码栈占用较大）
+
+    // 输出
+    xn_voice_send_cb_t send_cb;         ///< 发送回调，必填
+    void *user_data;                    ///< 发送回调用户数据
+} xn_voice_config_t;
+
+/*===========================================================================
+ *                          API
+ *===========================================================================*/
+
+/**
+ * @brief 获取默认配置（send_cb 需由调用者填写）
+ */
+xn_voice_config_t xn_voice_get_default_config(void);
+
+/**
+ * @brief 初始化语音上行：创建 Opus 编码器与编码任务，并注册为 xn_audio 帧消费者
+ *
+ * 需在 xn_audio_init 之后调用。语音段（frame->speech）内的帧连同语音开始前
+ * preroll_ms 的帧被持有并交给编码任务，帧池需为 preroll 与队列留出余量。
+ *
+ * @param config 配置
+ * @return esp_err_t
+ *      - ESP_OK: 成功
+ *      - ESP_ERR_INVALID_STATE: 已初始化
+ *      - ESP_ERR_INVALID_ARG: 配置无效
+ *      - ESP_ERR_NO_MEM: 内存不足
+ *      - ESP_FAIL: 编码器创建失败
+ */
+esp_err_t xn_voice_init(const xn_voice_config_t *config);
+
+/**
+ * @brief 反初始化，注销消费者、停止编码任务并释放持有的帧
+ *
+ * 需在 xn_audio_stop 之后、xn_audio_deinit 之前调用。
+ */
+esp_err_t xn_voice_deinit(void);
+
+/**
+ * @brief 读取上行统计
+ */
+esp_err_t xn_voice_get_stats(xn_voice_stats_t *stats);
+
+/**
+ * @brief 清零统计
+ */
+void xn_voice_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // XN_VOICE_H
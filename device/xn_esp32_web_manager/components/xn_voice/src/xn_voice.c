@@ -0,0 +1,598 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-26 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-26 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\components\xn_voice\src\xn_voice.c
+ * @Description: 语音上行组件实现 - 采集侧持有语音帧，编码任务 Opus 编码并分包发送
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "xn_voice.h"
+#include "xn_audio.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_opus_enc.h"
+
+static const char *TAG = "xn_voice";
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+#define PREROLL_MAX_FRAMES      16      ///< preroll 最多持有的帧数
+#define ITEM_FLAG_STOP          0x80    ///< 内部标志：编码任务退出
+
+/**
+ * @brief 编码队列元素
+ *
+ * frame 为 NULL 时只携带标志（语音结束、任务退出）；
+ * flags 使用 XN_VOICE_FLAG_*，START/END 描述语音段边界，DISCONTINUITY 表示之前有帧被丢弃。
+ */
+typedef struct {
+    const xn_audio_frame_t *frame;      ///< 持有的 PCM 帧
+    uint8_t flags;                      ///< 标志
+} voice_item_t;
+
+typedef struct {
+    bool initialized;                   ///< 初始化标志
+    xn_voice_config_t config;           ///< 配置信息
+    QueueHandle_t queue;                ///< 编码队列
+    TaskHandle_t task;                  ///< 编码任务
+    SemaphoreHandle_t exit_sem;         ///< 编码任务退出完成
+    void *encoder;                      ///< Opus 编码器句柄
+
+    // 采集侧状态（只在采集任务中访问）
+    const xn_audio_frame_t *preroll[PREROLL_MAX_FRAMES]; ///< preroll 环形缓冲
+    uint8_t preroll_head;               ///< 最旧一帧下标
+    uint8_t preroll_count;              ///< 持有帧数
+    uint8_t preroll_frames;             ///< preroll 帧数上限（首帧到达时按帧长计算）
+    bool in_speech;                     ///< 语音段进行中
+    uint8_t pending_flags;              ///< 尚未送达编码任务的标志（入队失败时累积）
+
+    // 编码侧状态（只在编码任务中访问）
+    int16_t *pcm;                       ///< 一个 Opus 帧的 PCM 累积缓冲区
+    size_t pcm_samples;                 ///< Opus 帧采样数
+    size_t pcm_fill;                    ///< 已累积采样数
+    uint32_t pcm_ts;                    ///< 累积缓冲区首采样的段内偏移
+    uint32_t next_ts;                   ///< 期望的下一采样段内偏移
+    int opus_max_bytes;                 ///< 单个 Opus 帧最大编码长度
+    uint8_t *packet;                    ///< 包缓冲区
+    size_t packet_len;                  ///< 当前包长度
+    uint8_t packet_frames;              ///< 当前包帧数
+    uint8_t packet_flags;               ///< 当前包标志
+    uint32_t packet_ts;                 ///< 当前包首采样的段内偏移
+    bool active;                        ///< 编码侧处于语音段
+    uint32_t base_seq;                  ///< 语音段首帧的 xn_audio 帧序号
+    uint16_t session;                   ///< 语音段编号
+    uint16_t seq;                       ///< 段内包序号
+
+    // 统计
+    xn_voice_stats_t stats;             ///< 统计（encode_avg_us 读取时计算）
+    uint64_t encode_total_us;           ///< 编码耗时累计
+    uint32_t encode_count;              ///< 编码帧数
+} xn_voice_ctx_t;
+
+static xn_voice_ctx_t s_ctx;
+
+/*===========================================================================
+ *                          采集侧（xn_audio 采集任务中执行，不能阻塞）
+ *===========================================================================*/
+
+/**
+ * @brief 把帧交给编码任务（帧已持有，失败时释放）
+ *
+ * 未送达的标志累积到下一次成功入队，保证语音段边界不会因队列满而丢失。
+ */
+static void enqueue(const xn_audio_frame_t *frame, uint8_t flags)
+{
+    voice_item_t item = {
+        .frame = frame,
+        .flags = s_ctx.pending_flags | flags,
+    };
+
+    if (xQueueSend(s_ctx.queue, &item, 0) == pdTRUE) {
+        s_ctx.pending_flags = 0;
+        return;
+    }
+
+    s_ctx.pending_flags = item.flags;
+    if (frame) {
+        xn_audio_frame_release(frame);
+        s_ctx.stats.frames_dropped++;
+        s_ctx.pending_flags |= XN_VOICE_FLAG_DISCONTINUITY;
+    }
+}
+
+/**
+ * @brief 静音帧放入 preroll 环形缓冲，满时释放最旧一帧
+ */
+static void preroll_push(const xn_audio_frame_t *frame)
+{
+    if (s_ctx.preroll_frames == 0) {
+        return;
+    }
+
+    if (s_ctx.preroll_count == s_ctx.preroll_frames) {
+        xn_audio_frame_release(s_ctx.preroll[s_ctx.preroll_head]);
+        s_ctx.preroll_head = (s_ctx.preroll_head + 1) % s_ctx.preroll_frames;
+        s_ctx.preroll_count--;
+    }
+
+    xn_audio_frame_retain(frame);
+    s_ctx.preroll[(s_ctx.preroll_head + s_ctx.preroll_count) % s_ctx.preroll_frames] = frame;
+    s_ctx.preroll_count++;
+}
+
+/**
+ * @brief 语音开始：preroll 按时间顺序交给编码任务，第一帧携带 START
+ */
+static void preroll_flush(void)
+{
+    uint8_t flags = XN_VOICE_FLAG_START;
+
+    while (s_ctx.preroll_count > 0) {
+        enqueue(s_ctx.preroll[s_ctx.preroll_head], flags);
+        s_ctx.preroll_head = (s_ctx.preroll_head + 1) % s_ctx.preroll_frames;
+        s_ctx.preroll_count--;
+        flags = 0;
+    }
+    s_ctx.preroll_head = 0;
+
+    // preroll 为空时 START 由语音首帧携带
+    s_ctx.pending_flags |= flags;
+}
+
+/**
+ * @brief xn_audio 帧消费者
+ */
+static void on_frame(const xn_audio_frame_t *frame, void *user_data)
+{
+    (void)user_data;
+
+    if (s_ctx.preroll_frames == 0 && s_ctx.config.preroll_ms > 0 && frame->samples > 0) {
+        size_t preroll_samples = (size_t)s_ctx.config.sample_rate * s_ctx.config.preroll_ms / 1000;
+        size_t frames = (preroll_samples + frame->samples - 1) / frame->samples;
+        s_ctx.preroll_frames = frames > PREROLL_MAX_FRAMES ? PREROLL_MAX_FRAMES : frames;
+    }
+
+    if (frame->speech) {
+        if (!s_ctx.in_speech) {
+            s_ctx.in_speech = true;
+            preroll_flush();
+        }
+        xn_audio_frame_retain(frame);
+        enqueue(frame, 0);
+        return;
+    }
+
+    if (s_ctx.in_speech) {
+        s_ctx.in_speech = false;
+        enqueue(NULL, XN_VOICE_FLAG_END);
+    }
+    preroll_push(frame);
+}
+
+/*===========================================================================
+ *                          编码侧（编码任务中执行）
+ *===========================================================================*/
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/**
+ * @brief 填写包头并发送当前包（发送失败的包序号同样占用，接收端可据此发现丢包）
+ */
+static void packet_send(void)
+{
+    uint8_t *hdr = s_ctx.packet;
+
+    if (s_ctx.packet_frames == 0) {
+        s_ctx.packet_ts = s_ctx.next_ts;
+    }
+    hdr[0] = XN_VOICE_PACKET_MAGIC;
+    hdr[1] = XN_VOICE_PACKET_VERSION;
+    hdr[2] = s_ctx.packet_flags;
+    hdr[3] = (uint8_t)s_ctx.config.frame_ms;
+    put_le16(&hdr[4], s_ctx.session);
+    put_le16(&hdr[6], s_ctx.seq);
+    put_le32(&hdr[8], s_ctx.packet_ts);
+    hdr[12] = s_ctx.packet_frames;
+    hdr[13] = 0;
+
+    size_t len = XN_VOICE_HEADER_SIZE + s_ctx.packet_len;
+    esp_err_t ret = s_ctx.config.send_cb(s_ctx.packet, len, s_ctx.config.user_data);
+    s_ctx.seq++;
+    s_ctx.packet_len = 0;
+    s_ctx.packet_frames = 0;
+    if (ret == ESP_OK) {
+        s_ctx.stats.packets_sent++;
+        s_ctx.stats.bytes_sent += len;
+        s_ctx.packet_flags = 0;
+    } else {
+        s_ctx.stats.packets_dropped++;
+        s_ctx.packet_flags = XN_VOICE_FLAG_DISCONTINUITY;
+    }
+}
+
+/**
+ * @brief 编码累积缓冲区中的 Opus 帧（不足一帧时补零），凑满一包即发送
+ */
+static void encode_frame(void)
+{
+    if (s_ctx.pcm_fill == 0) {
+        return;
+    }
+    if (s_ctx.pcm_fill < s_ctx.pcm_samples) {
+        memset(&s_ctx.pcm[s_ctx.pcm_fill], 0, (s_ctx.pcm_samples - s_ctx.pcm_fill) * sizeof(int16_t));
+    }
+
+    if (s_ctx.packet_frames == 0) {
+        s_ctx.packet_ts = s_ctx.pcm_ts;
+    }
+    uint8_t *out = s_ctx.packet + XN_VOICE_HEADER_SIZE + s_ctx.packet_len;
+    esp_audio_enc_in_frame_t in_frame = {
+        .buffer = (uint8_t *)s_ctx.pcm,
+        .len = s_ctx.pcm_samples * sizeof(int16_t),
+    };
+    esp_audio_enc_out_frame_t out_frame = {
+        .buffer = out + 2,
+        .len = s_ctx.opus_max_bytes,
+    };
+
+    int64_t start_us = esp_timer_get_time();
+    esp_audio_err_t err = esp_opus_enc_process(s_ctx.encoder, &in_frame, &out_frame);
+    uint32_t cost_us = (uint32_t)(esp_timer_get_time() - start_us);
+    s_ctx.pcm_fill = 0;
+
+    s_ctx.encode_total_us += cost_us;
+    s_ctx.encode_count++;
+    if (cost_us > s_ctx.stats.encode_max_us) {
+        s_ctx.stats.encode_max_us = cost_us;
+    }
+
+    if (err != ESP_AUDIO_ERR_OK) {
+        // 编码失败的帧按丢弃处理
+        ESP_LOGW(TAG, "Opus encode failed: %d", (int)err);
+        s_ctx.packet_flags |= XN_VOICE_FLAG_DISCONTINUITY;
+        return;
+    }
+
+    put_le16(out, (uint16_t)out_frame.encoded_bytes);
+    s_ctx.packet_len += 2 + out_frame.encoded_bytes;
+    s_ctx.packet_frames++;
+    if (s_ctx.packet_frames >= s_ctx.config.frames_per_packet) {
+        packet_send();
+    }
+}
+
+/**
+ * @brief 开始新的语音段
+ */
+static void session_begin(const xn_audio_frame_t *frame)
+{
+    s_ctx.active = true;
+    s_ctx.session++;
+    s_ctx.seq = 0;
+    s_ctx.base_seq = frame ? frame->seq : 0;
+    s_ctx.pcm_fill = 0;
+    s_ctx.next_ts = 0;
+    s_ctx.packet_len = 0;
+    s_ctx.packet_frames = 0;
+    s_ctx.packet_flags = XN_VOICE_FLAG_START;
+    s_ctx.stats.sessions++;
+}
+
+/**
+ * @brief 结束语音段：编码剩余采样，发送带 END 的包
+ */
+static void session_end(void)
+{
+    encode_frame();
+    s_ctx.packet_flags |= XN_VOICE_FLAG_END;
+    packet_send();
+    s_ctx.active = false;
+}
+
+/**
+ * @brief 帧序号不连续（任一侧丢帧）时结束当前包，下一包按新的时间戳开始
+ */
+static void handle_gap(void)
+{
+    encode_frame();
+    if (s_ctx.packet_frames > 0) {
+        packet_send();
+    }
+    s_ctx.packet_flags |= XN_VOICE_FLAG_DISCONTINUITY;
+}
+
+/**
+ * @brief 把 PCM 帧追加到累积缓冲区，满一个 Opus 帧即编码
+ */
+static void feed_frame(const xn_audio_frame_t *frame)
+{
+    uint32_t ts = (frame->seq - s_ctx.base_seq) * (uint32_t)frame->samples;
+    if (ts != s_ctx.next_ts) {
+        handle_gap();
+    }
+    s_ctx.next_ts = ts + (uint32_t)frame->samples;
+
+    size_t offset = 0;
+    while (offset < frame->samples) {
+        if (s_ctx.pcm_fill == 0) {
+            s_ctx.pcm_ts = ts + (uint32_t)offset;
+        }
+        size_t n = frame->samples - offset;
+        if (n > s_ctx.pcm_samples - s_ctx.pcm_fill) {
+            n = s_ctx.pcm_samples - s_ctx.pcm_fill;
+        }
+        memcpy(&s_ctx.pcm[s_ctx.pcm_fill], &frame->pcm[offset], n * sizeof(int16_t));
+        s_ctx.pcm_fill += n;
+        offset += n;
+        if (s_ctx.pcm_fill == s_ctx.pcm_samples) {
+            encode_frame();
+        }
+    }
+}
+
+/**
+ * @brief 编码任务
+ */
+static void encode_task(void *arg)
+{
+    (void)arg;
+    voice_item_t item;
+
+    while (1) {
+        xQueueReceive(s_ctx.queue, &item, portMAX_DELAY);
+        if (item.flags & ITEM_FLAG_STOP) {
+            break;
+        }
+
+        // 上一段的 END 可能与下一段的 START 合并送达，先结束旧段
+        if ((item.flags & XN_VOICE_FLAG_END) && s_ctx.active) {
+            session_end();
+        }
+        if (item.frame == NULL) {
+            continue;
+        }
+
+        if ((item.flags & XN_VOICE_FLAG_START) || !s_ctx.active) {
+            session_begin(item.frame);
+        } else if (item.flags & XN_VOICE_FLAG_DISCONTINUITY) {
+            handle_gap();
+        }
+        feed_frame(item.frame);
+        xn_audio_frame_release(item.frame);
+    }
+
+    xSemaphoreGive(s_ctx.exit_sem);
+    vTaskDelete(NULL);
+}
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief Opus 帧时长转换为编码器枚举
+ */
+static bool frame_duration(uint16_t frame_ms, esp_opus_enc_frame_duration_t *duration)
+{
+    switch (frame_ms) {
+    case 20:
+        *duration = ESP_OPUS_ENC_FRAME_DURATION_20_MS;
+        return true;
+    case 40:
+        *duration = ESP_OPUS_ENC_FRAME_DURATION_40_MS;
+        return true;
+    case 60:
+        *duration = ESP_OPUS_ENC_FRAME_DURATION_60_MS;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief 创建 Opus 编码器并分配缓冲区
+ */
+static esp_err_t encoder_init(esp_opus_enc_frame_duration_t duration)
+{
+    const xn_voice_config_t *cfg = &s_ctx.config;
+    esp_opus_enc_config_t opus_cfg = ESP_OPUS_ENC_CONFIG_DEFAULT();
+    opus_cfg.sample_rate = cfg->sample_rate;
+    opus_cfg.channel = 1;
+    opus_cfg.bits_per_sample = 16;
+    opus_cfg.bitrate = cfg->bitrate;
+    opus_cfg.frame_duration = duration;
+    opus_cfg.application_mode = ESP_OPUS_ENC_APPLICATION_VOIP;
+    opus_cfg.complexity = cfg->complexity;
+    opus_cfg.enable_fec = false;
+    opus_cfg.enable_dtx = false;
+    opus_cfg.enable_vbr = true;
+
+    if (esp_opus_enc_open(&opus_cfg, sizeof(opus_cfg), &s_ctx.encoder) != ESP_AUDIO_ERR_OK) {
+        ESP_LOGE(TAG, "Failed to open Opus encoder");
+        s_ctx.encoder = NULL;
+        return ESP_FAIL;
+    }
+
+    int in_size = 0;
+    int out_size = 0;
+    esp_opus_enc_get_frame_size(s_ctx.encoder, &in_size, &out_size);
+    s_ctx.pcm_samples = (size_t)cfg->sample_rate * cfg->frame_ms / 1000;
+    if ((size_t)in_size != s_ctx.pcm_samples * sizeof(int16_t) || out_size <= 0 || out_size > UINT16_MAX) {
+        ESP_LOGE(TAG, "Unexpected Opus frame size: in %d, out %d", in_size, out_size);
+        return ESP_FAIL;
+    }
+    s_ctx.opus_max_bytes = out_size;
+
+    s_ctx.pcm = malloc(s_ctx.pcm_samples * sizeof(int16_t));
+    s_ctx.packet = malloc(XN_VOICE_HEADER_SIZE + (size_t)cfg->frames_per_packet * (2 + out_size));
+    if (s_ctx.pcm == NULL || s_ctx.packet == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+xn_voice_config_t xn_voice_get_default_config(void)
+{
+    xn_voice_config_t config = {
+        .sample_rate = 16000,
+        .frame_ms = 20,
+        .frames_per_packet = 3,
+        .bitrate = 24000,
+        .complexity = 3,
+        .preroll_ms = 100,
+        .queue_frames = 8,
+        .task_core = 1,
+        .task_priority = 10,
+        .task_stack_size = 24576,
+        .send_cb = NULL,
+        .user_data = NULL,
+    };
+    return config;
+}
+
+esp_err_t xn_voice_init(const xn_voice_config_t *config)
+{
+    if (s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_opus_enc_frame_duration_t duration;
+    if (config == NULL || config->send_cb == NULL || config->sample_rate == 0 ||
+        !frame_duration(config->frame_ms, &duration) ||
+        config->frames_per_packet == 0 || config->queue_frames == 0 || config->complexity > 10) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(&s_ctx, 0, sizeof(s_ctx));
+    s_ctx.config = *config;
+    s_ctx.initialized = true;
+
+    esp_err_t ret = encoder_init(duration);
+    if (ret != ESP_OK) {
+        goto fail;
+    }
+
+    s_ctx.queue = xQueueCreate(config->queue_frames, sizeof(voice_item_t));
+    s_ctx.exit_sem = xSemaphoreCreateBinary();
+    if (s_ctx.queue == NULL || s_ctx.exit_sem == NULL) {
+        ret = ESP_ERR_NO_MEM;
+        goto fail;
+    }
+
+    if (xTaskCreatePinnedToCore(encode_task, "xn_voice", config->task_stack_size, NULL,
+                                config->task_priority, &s_ctx.task, config->task_core) != pdPASS) {
+        ret = ESP_ERR_NO_MEM;
+        goto fail;
+    }
+
+    ret = xn_audio_register_consumer(on_frame, NULL);
+    if (ret != ESP_OK) {
+        goto fail;
+    }
+
+    ESP_LOGI(TAG, "Voice uplink ready: Opus %u bps, %u ms x %u per packet, preroll %u ms",
+             (unsigned)config->bitrate, config->frame_ms, config->frames_per_packet, config->preroll_ms);
+    return ESP_OK;
+
+fail:
+    xn_voice_deinit();
+    return ret;
+}
+
+esp_err_t xn_voice_deinit(void)
+{
+    if (!s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xn_audio_unregister_consumer(on_frame, NULL);
+    if (s_ctx.task) {
+        voice_item_t stop = {
+            .frame = NULL,
+            .flags = ITEM_FLAG_STOP,
+        };
+        xQueueSend(s_ctx.queue, &stop, portMAX_DELAY);
+        xSemaphoreTake(s_ctx.exit_sem, portMAX_DELAY);
+        s_ctx.task = NULL;
+    }
+
+    // 归还队列与 preroll 中持有的帧
+    if (s_ctx.queue) {
+        voice_item_t item;
+        while (xQueueReceive(s_ctx.queue, &item, 0) == pdTRUE) {
+            if (item.frame) {
+                xn_audio_frame_release(item.frame);
+            }
+        }
+        vQueueDelete(s_ctx.queue);
+        s_ctx.queue = NULL;
+    }
+    while (s_ctx.preroll_count > 0) {
+        xn_audio_frame_release(s_ctx.preroll[s_ctx.preroll_head]);
+        s_ctx.preroll_head = (s_ctx.preroll_head + 1) % s_ctx.preroll_frames;
+        s_ctx.preroll_count--;
+    }
+
+    if (s_ctx.exit_sem) {
+        vSemaphoreDelete(s_ctx.exit_sem);
+        s_ctx.exit_sem = NULL;
+    }
+    if (s_ctx.encoder) {
+        esp_opus_enc_close(s_ctx.encoder);
+        s_ctx.encoder = NULL;
+    }
+    free(s_ctx.pcm);
+    free(s_ctx.packet);
+    s_ctx.pcm = NULL;
+    s_ctx.packet = NULL;
+    s_ctx.initialized = false;
+    return ESP_OK;
+}
+
+esp_err_t xn_voice_get_stats(xn_voice_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_ctx.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    *stats = s_ctx.stats;
+    stats->encode_avg_us = s_ctx.encode_count ? (uint32_t)(s_ctx.encode_total_us / s_ctx.encode_count) : 0;
+    return ESP_OK;
+}
+
+void xn_voice_reset_stats(void)
+{
+    memset(&s_ctx.stats, 0, sizeof(s_ctx.stats));
+    s_ctx.encode_total_us = 0;
+    s_ctx.encode_count = 0;
+}
@@ -35,6 +35,30 @@ typedef void (*xn_wifi_scan_done_cb_t)(uint16_t ap_count, wifi_ap_record_t *ap_l
 // @param status: 当前最新的WiFi状态
 typedef void (*xn_wifi_status_cb_t)(xn_wifi_status_t status);
 
+// 链路信息（快速重连缓存用），IP地址均为网络字节序
+typedef struct {
+    uint8_t bssid[6]; // AP的BSSID
+    uint8_t channel; // AP所在信道
+    uint32_t ip; // IP地址
+    uint32_t netmask; // 子网掩码
+    uint32_t gw; // 网关
+    uint32_t dns; // 主DNS服务器
+} xn_wifi_link_info_t; // 链路信息类型定义
+
+// 链路质量PHY模式位
+#define XN_WIFI_PHY_11B (1 << 0) // 支持802.11b
+#define XN_WIFI_PHY_11G (1 << 1) // 支持802.11g
+#define XN_WIFI_PHY_11N (1 << 2) // 支持802.11n
+#define XN_WIFI_PHY_LR  (1 << 3) // 乐鑫Long Range模式
+
+// 链路质量采样，来自驱动记录的最近一个信标，读取不产生空口收发
+typedef struct {
+    int8_t rssi; // 信号强度(dBm)
+    uint8_t channel; // 主信道
+    uint8_t bssid[6]; // 当前AP的BSSID
+    uint8_t phy; // 与AP共同支持的PHY模式位 XN_WIFI_PHY_*
+} xn_wifi_link_quality_t; // 链路质量类型定义
+
 // WiFi组件句柄结构体前置声明
 typedef struct xn_wifi_s xn_wifi_t;
 
@@ -78,6 +102,43 @@ esp_err_t xn_wifi_deinit(xn_wifi_t *wifi); // 反初始化WiFi组件函数声明
  */
 esp_err_t xn_wifi_connect(xn_wifi_t *wifi, const char *ssid, const char *password); // 连接WiFi函数声明
 
+/**
+ * @brief 按上次成功的链路快速连接WiFi
+ * 
+ * - 锁定BSSID和信道，只在该信道上探测，跳过全信道扫描
+ * - 只使用 link 中的BSSID和信道，IP仍由DHCP获取；开启 CONFIG_LWIP_DHCP_RESTORE_LAST_IP 时
+ *   DHCP客户端直接请求上次租到的地址（INIT-REBOOT），省去 DISCOVER/OFFER
+ * 
+ * 关联失败时上报 XN_WIFI_DISCONNECTED，由调用者决定是否回退到 xn_wifi_connect
+ * 
+ * @param wifi WiFi实例指针
+ * @param ssid WiFi名称
+ * @param password WiFi密码
+ * @param link 上次成功连接的链路信息
+ * @return esp_err_t 返回ESP_OK表示成功发起连接，其他表示失败
+ */
+esp_err_t xn_wifi_connect_fast(xn_wifi_t *wifi, const char *ssid, const char *password, const xn_wifi_link_info_t *link); // 快速连接WiFi函数声明
+
+/**
+ * @brief 获取当前连接的链路信息
+ * 
+ * @param wifi WiFi实例指针
+ * @param info 输出链路信息
+ * @return esp_err_t 成功返回ESP_OK，未获取IP返回ESP_ERR_INVALID_STATE
+ */
+esp_err_t xn_wifi_get_link_info(xn_wifi_t *wifi, xn_wifi_link_info_t *info); // 获取链路信息函数声明
+
+/**
+ * @brief 获取当前链路质量（RSSI、信道、PHY模式）
+ * 
+ * 关联成功后即可读取，不要求已获取IP，可在定时器回调中周期调用。
+ * 
+ * @param wifi WiFi实例指针
+ * @param quality 输出链路质量
+ * @return esp_err_t 成功返回ESP_OK，未关联返回ESP_ERR_INVALID_STATE
+ */
+esp_err_t xn_wifi_get_link_quality(xn_wifi_t *wifi, xn_wifi_link_quality_t *quality); // 获取链路质量函数声明
+
 /**
  * @brief 断开WiFi
  * 
@@ -111,6 +172,19 @@ xn_wifi_status_t xn_wifi_get_status(xn_wifi_t *wifi); // 获取WiFi状态函数
  */
 void xn_wifi_register_status_cb(xn_wifi_t *wifi, xn_wifi_status_cb_t callback); // 注册状态回调函数声明
 
+/**
+ * @brief 设置调制解调器睡眠模式
+ * 
+ * - listen_interval 为0：最小调制解调器睡眠，每个DTIM醒来接收（驱动默认模式）
+ * - listen_interval 大于0：最大调制解调器睡眠，每隔 listen_interval 个信标周期醒来一次，
+ *   下次连接时生效（监听间隔在关联时告知AP）
+ * 
+ * @param wifi WiFi实例指针
+ * @param listen_interval 监听间隔（信标周期数）
+ * @return esp_err_t 返回ESP_OK表示成功，其他表示失败
+ */
+esp_err_t xn_wifi_set_power_save(xn_wifi_t *wifi, uint8_t listen_interval); // 设置睡眠模式函数声明
+
 /**
  * @brief 获取当前连接的SSID
  * 
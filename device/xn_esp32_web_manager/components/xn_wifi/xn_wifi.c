@@ -31,6 +31,7 @@ struct xn_wifi_s {
     wifi_config_t wifi_config; // WiFi配置信息
     bool is_connecting; // 是否正在连接标志
     esp_netif_t *netif; // 网络接口句柄
+    uint8_t listen_interval; // 最大调制解调器睡眠的监听间隔，0使用驱动默认值
 };
 
 // 更新内部状态并触发回调
@@ -45,6 +46,35 @@ static void update_status(xn_wifi_t *wifi, xn_wifi_status_t new_status)
     }
 }
 
+// 发起连接，link 为NULL时走完整扫描
+static esp_err_t start_connect(xn_wifi_t *wifi, const char *ssid, const char *password, const xn_wifi_link_info_t *link)
+{
+    memset(&wifi->wifi_config, 0, sizeof(wifi_config_t)); // 清空配置结构体
+    strlcpy((char*)wifi->wifi_config.sta.ssid, ssid, sizeof(wifi->wifi_config.sta.ssid)); // 拷贝SSID
+    if (password) { // 如果有密码
+        strlcpy((char*)wifi->wifi_config.sta.password, password, sizeof(wifi->wifi_config.sta.password)); // 拷贝密码
+    }
+    if (link) { // 快速连接：锁定BSSID和信道
+        memcpy(wifi->wifi_config.sta.bssid, link->bssid, sizeof(wifi->wifi_config.sta.bssid)); // 拷贝BSSID
+        wifi->wifi_config.sta.bssid_set = true; // 只连接该BSSID
+        wifi->wifi_config.sta.channel = link->channel; // 只在该信道探测
+    }
+    wifi->wifi_config.sta.listen_interval = wifi->listen_interval; // 关联时告知AP的监听间隔
+
+    esp_wifi_disconnect(); // 先断开当前连接
+
+    // IP始终由DHCP获取：开启 CONFIG_LWIP_DHCP_RESTORE_LAST_IP 时客户端以 INIT-REBOOT 方式
+    // 直接请求上次租到的地址，服务器确认后即获得IP，租约仍由服务器登记和续期
+    esp_netif_dhcpc_start(wifi->netif); // 已在运行时返回错误可忽略
+
+    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi->wifi_config)); // 设置WiFi连接配置
+    
+    wifi->is_connecting = true; // 设置连接标志
+    update_status(wifi, XN_WIFI_CONNECTING); // 更新状态为连接中
+    
+    return esp_wifi_connect(); // 发起连接
+}
+
 // WiFi/IP事件处理回调
 static void wifi_event_handler(void* arg, esp_event_base_t event_base,
                                int32_t event_id, void* event_data)
@@ -59,7 +89,7 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
                 
             case WIFI_EVENT_STA_CONNECTED: { // 连接成功事件
                 wifi_event_sta_connected_t *event = (wifi_event_sta_connected_t*)event_data; // 获取事件数据
-                ESP_LOGI(TAG, "Connected to %s", event->ssid); // 打印连接的SSID
+                ESP_LOGI(TAG, "Connected to %s, channel %d", event->ssid, event->channel); // 打印连接的SSID和信道
                 update_status(wifi, XN_WIFI_CONNECTED); // 更新状态为已连接
                 wifi->is_connecting = false; // 清除连接中标志
                 break; // 结束处理
@@ -171,20 +201,61 @@ esp_err_t xn_wifi_deinit(xn_wifi_t *wifi)
 esp_err_t xn_wifi_connect(xn_wifi_t *wifi, const char *ssid, const char *password)
 {
     if (wifi == NULL || ssid == NULL) return ESP_ERR_INVALID_ARG; // 参数检查
-    
-    memset(&wifi->wifi_config, 0, sizeof(wifi_config_t)); // 清空配置结构体
-    strlcpy((char*)wifi->wifi_config.sta.ssid, ssid, sizeof(wifi->wifi_config.sta.ssid)); // 拷贝SSID
-    if (password) { // 如果有密码
-        strlcpy((char*)wifi->wifi_config.sta.password, password, sizeof(wifi->wifi_config.sta.password)); // 拷贝密码
+    return start_connect(wifi, ssid, password, NULL); // 完整扫描 + DHCP
+}
+
+// 快速连接WiFi
+esp_err_t xn_wifi_connect_fast(xn_wifi_t *wifi, const char *ssid, const char *password, const xn_wifi_link_info_t *link)
+{
+    if (wifi == NULL || ssid == NULL || link == NULL) return ESP_ERR_INVALID_ARG; // 参数检查
+    return start_connect(wifi, ssid, password, link); // 指定BSSID/信道
+}
+
+// 获取当前连接的链路信息
+esp_err_t xn_wifi_get_link_info(xn_wifi_t *wifi, xn_wifi_link_info_t *info)
+{
+    if (wifi == NULL || info == NULL) return ESP_ERR_INVALID_ARG; // 参数检查
+    if (wifi->status != XN_WIFI_GOT_IP) return ESP_ERR_INVALID_STATE; // 未获取IP
+
+    wifi_ap_record_t ap; // 当前AP信息
+    esp_err_t ret = esp_wifi_sta_get_ap_info(&ap); // 读取BSSID和信道
+    if (ret != ESP_OK) return ret; // 读取失败
+
+    esp_netif_ip_info_t ip_info; // 当前IP信息
+    ret = esp_netif_get_ip_info(wifi->netif, &ip_info); // 读取IP、掩码、网关
+    if (ret != ESP_OK) return ret; // 读取失败
+
+    memset(info, 0, sizeof(*info)); // 清零输出
+    memcpy(info->bssid, ap.bssid, sizeof(info->bssid)); // 拷贝BSSID
+    info->channel = ap.primary; // 主信道
+    info->ip = ip_info.ip.addr; // IP地址
+    info->netmask = ip_info.netmask.addr; // 子网掩码
+    info->gw = ip_info.gw.addr; // 网关
+
+    esp_netif_dns_info_t dns; // DNS信息
+    if (esp_netif_get_dns_info(wifi->netif, ESP_NETIF_DNS_MAIN, &dns) == ESP_OK &&
+        dns.ip.type == ESP_IPADDR_TYPE_V4) { // 只缓存IPv4 DNS
+        info->dns = dns.ip.u_addr.ip4.addr; // 主DNS
     }
-    
-    esp_wifi_disconnect(); // 先断开当前连接
-    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi->wifi_config)); // 设置WiFi连接配置
-    
-    wifi->is_connecting = true; // 设置连接标志
-    update_status(wifi, XN_WIFI_CONNECTING); // 更新状态为连接中
-    
-    return esp_wifi_connect(); // 发起连接
+    return ESP_OK; // 返回成功
+}
+
+// 获取当前链路质量
+esp_err_t xn_wifi_get_link_quality(xn_wifi_t *wifi, xn_wifi_link_quality_t *quality)
+{
+    if (wifi == NULL || quality == NULL) return ESP_ERR_INVALID_ARG; // 参数检查
+    if (wifi->status != XN_WIFI_CONNECTED && wifi->status != XN_WIFI_GOT_IP) return ESP_ERR_INVALID_STATE; // 未关联
+
+    wifi_ap_record_t ap; // 当前AP信息
+    esp_err_t ret = esp_wifi_sta_get_ap_info(&ap); // 读取最近信标的RSSI
+    if (ret != ESP_OK) return ret; // 读取失败
+
+    quality->rssi = ap.rssi; // 信号强度
+    quality->channel = ap.primary; // 主信道
+    memcpy(quality->bssid, ap.bssid, sizeof(quality->bssid)); // 拷贝BSSID
+    quality->phy = (ap.phy_11b ? XN_WIFI_PHY_11B : 0) | (ap.phy_11g ? XN_WIFI_PHY_11G : 0) |
+                   (ap.phy_11n ? XN_WIFI_PHY_11N : 0) | (ap.phy_lr ? XN_WIFI_PHY_LR : 0); // PHY模式位
+    return ESP_OK; // 返回成功
 }
 
 // 断开WiFi
@@ -199,6 +270,7 @@ esp_err_t xn_wifi_disconnect(xn_wifi_t *wifi)
 esp_err_t xn_wifi_scan(xn_wifi_t *wifi, xn_wifi_scan_done_cb_t callback)
 {
     if (wifi == NULL) return ESP_ERR_INVALID_ARG; // 参数检查
+    xn_wifi_scan_done_cb_t prev = wifi->scan_callback; // 原回调
     wifi->scan_callback = callback; // 保存回调函数
     
     wifi_scan_config_t scan_config = { // 配置扫描参数
@@ -208,7 +280,9 @@ esp_err_t xn_wifi_scan(xn_wifi_t *wifi, xn_wifi_scan_done_cb_t callback)
         .scan_time.active.max = 0 // 默认时间
     };
     
-    return esp_wifi_scan_start(&scan_config, false); // 启动扫描
+    esp_err_t ret = esp_wifi_scan_start(&scan_config, false); // 启动扫描
+    if (ret != ESP_OK) wifi->scan_callback = prev; // 未启动（如已有扫描进行中）时保留原回调，避免抢走对方的结果
+    return ret; // 返回结果
 }
 
 // 获取当前状态
@@ -223,6 +297,15 @@ void xn_wifi_register_status_cb(xn_wifi_t *wifi, xn_wifi_status_cb_t callback)
     if (wifi) wifi->status_callback = callback; // 保存状态回调
 }
 
+// 设置调制解调器睡眠模式
+esp_err_t xn_wifi_set_power_save(xn_wifi_t *wifi, uint8_t listen_interval)
+{
+    if (wifi == NULL) return ESP_ERR_INVALID_ARG; // 参数检查
+
+    wifi->listen_interval = listen_interval; // 保存监听间隔，下次连接时生效
+    return esp_wifi_set_ps(listen_interval ? WIFI_PS_MAX_MODEM : WIFI_PS_MIN_MODEM); // 设置睡眠模式
+}
+
 // 获取当前连接的SSID
 esp_err_t xn_wifi_get_current_ssid(xn_wifi_t *wifi, char *ssid)
 {
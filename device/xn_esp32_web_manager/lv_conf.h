@@ -7,6 +7,7 @@
 #define LV_CONF_H
 
 #include <stdint.h>
+#include "sdkconfig.h"
 
 /*====================
    COLOR SETTINGS
@@ -22,16 +23,27 @@
    MEMORY SETTINGS
  *=========================*/
 
+/* Built-in TLSF allocator for `lv_malloc()`; pool size and location come from menuconfig → XN Display */
+#define LV_USE_STDLIB_MALLOC LV_STDLIB_BUILTIN
+
 /* Size of the memory available for `lv_malloc()` in bytes (>= 2kB) */
-#define LV_MEM_SIZE (48U * 1024U)  /* 48 KB */
+#define LV_MEM_SIZE (CONFIG_XN_DISPLAY_LV_MEM_KB * 1024U)
+
+/* Size of memory expansion for `lv_malloc()` in bytes, added to the pool when it runs out (0: no expansion) */
+#define LV_MEM_POOL_EXPAND_SIZE (CONFIG_XN_DISPLAY_LV_MEM_EXPAND_KB * 1024U)
 
 /* Set an address for the memory pool instead of allocating it as a normal array. Can be in external SRAM too. */
 #define LV_MEM_ADR 0     /* 0: unused */
 
 /* Instead of an address give a memory allocator that will be called to get a memory pool for LVGL. */
-#define LV_MEM_POOL_INCLUDE <stdlib.h>
-#define LV_MEM_POOL_ALLOC   malloc
-#define LV_MEM_POOL_FREE    free
+#define LV_MEM_POOL_INCLUDE "esp_heap_caps.h"
+#if CONFIG_XN_DISPLAY_LV_MEM_PSRAM
+#define LV_MEM_POOL_ALLOC(size) heap_caps_malloc_prefer((size), 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, \
+                                                        MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#else
+#define LV_MEM_POOL_ALLOC(size) heap_caps_malloc((size), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#endif
+#define LV_MEM_POOL_FREE    heap_caps_free
 
 /*====================
    HAL SETTINGS
@@ -295,12 +307,13 @@
  * OTHERS
  *==================*/
 
-/* 1: Show CPU usage and FPS count */
-#define LV_USE_PERF_MONITOR 1
+/* 1: Show CPU usage and FPS count
+ * 关闭：覆盖层本身每帧重绘会干扰测量，改用 xn_display 的 CONFIG_XN_DISPLAY_STATS */
+#define LV_USE_PERF_MONITOR 0
 #define LV_USE_PERF_MONITOR_POS LV_ALIGN_BOTTOM_RIGHT
 
 /* 1: Show the used memory and the memory fragmentation */
-#define LV_USE_MEM_MONITOR 1
+#define LV_USE_MEM_MONITOR 0
 #define LV_USE_MEM_MONITOR_POS LV_ALIGN_BOTTOM_LEFT
 
 /* Draw random colored rectangles over the redrawn areas */
@@ -384,8 +397,12 @@
 /* 1: Enable alpha indexed images */
 #define LV_USE_ALPHA_INDEXED_IMG 1
 
-/* Default image cache size. Image caching keeps the images opened. */
-#define LV_CACHE_DEF_SIZE 4
+/* Default image cache size in bytes, from menuconfig → XN Display. Image caching keeps the images opened.
+ * Images from the xn_assets partition are already in the render format and bypass the cache. */
+#define LV_CACHE_DEF_SIZE (CONFIG_XN_DISPLAY_IMAGE_CACHE_KB * 1024U)
+
+/* Number of image headers to cache, from menuconfig → XN Display */
+#define LV_IMAGE_HEADER_CACHE_DEF_CNT CONFIG_XN_DISPLAY_IMAGE_HEADER_CACHE_CNT
 
 /* Number of stops allowed per gradient. Increase this to allow more stops. */
 #define LV_GRADIENT_MAX_STOPS 2
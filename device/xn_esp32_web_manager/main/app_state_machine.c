@@ -28,9 +28,68 @@ static const char *TAG = "app_fsm";
  *                          状态机实例
  *===========================================================================*/
 
+#define APP_DHCP_TIMEOUT_MS         15000   // 等待分配IP的超时时间
+#define APP_OTA_CHECK_TIMEOUT_MS    60000   // OTA检查超时时间，超时后跳过OTA直接连接MQTT
+#define APP_MQTT_CONNECT_TIMEOUT_MS 30000   // MQTT连接超时时间，超时后重新连接WiFi
+#define APP_STAGED_CHECK_MS         60000   // 新固件待生效时检查能否重启的间隔
+
 static xn_fsm_t s_fsm;              // 状态机核心结构体实例
 static bool s_initialized = false;   // 模块初始化标志位，防止重复初始化
 
+/*===========================================================================
+ *                          异步工作
+ *===========================================================================*/
+
+/**
+ * @brief 状态机超时与异步完成事件投递函数
+ * 
+ * 在 esp_timer 任务或异步工作任务中调用，经事件总线把事件连同标签送回分发任务，
+ * 再由 event_handler 交给状态机，过期的事件在状态机中丢弃。
+ */
+static esp_err_t fsm_post(xn_fsm_t *fsm, xn_event_id_t event, uint32_t tag, void *user_data)
+{
+    // 标签作为负载发布到事件总线
+    return xn_event_post_data(event, XN_EVT_SRC_FSM, &tag, sizeof(tag));
+}
+
+/**
+ * @brief OTA 检查工作（在独立任务中执行）
+ * 
+ * @return esp_err_t 
+ *      - ESP_OK: 检查完成，可以继续连接 MQTT
+ *      - ESP_ERR_NOT_FINISHED: 设备等待激活，OTA Manager 已发布事件驱动状态机进入 OTA_ACTIVATING
+ *      - 其他: OTA 流程失败
+ */
+static esp_err_t ota_check_work(xn_fsm_t *fsm, void *arg)
+{
+    // 执行 OTA 流程（阻塞直到网络请求完成）
+    esp_err_t ret = ota_manager_start();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "OTA manager start failed");
+        return ret;
+    }
+    
+    // 等待激活时不投递完成事件
+    xn_ota_auth_status_t status;
+    if (ota_manager_get_auth_status(&status, NULL, NULL) == ESP_OK && status == XN_OTA_AUTH_PENDING) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+    
+    return ESP_OK;
+}
+
+/**
+ * @brief 重启应用新固件（在独立任务中执行）
+ * 
+ * 重启前发布 XN_EVT_SYSTEM_REBOOT，不能阻塞事件分发任务，否则订阅者收不到。
+ * 
+ * @return esp_err_t 只有没有待生效固件时才返回
+ */
+static esp_err_t staged_reboot_work(xn_fsm_t *fsm, void *arg)
+{
+    return ota_manager_apply_staged();
+}
+
 /*===========================================================================
  *                          状态回调
  *===========================================================================*/
@@ -40,18 +99,19 @@ static bool s_initialized = false;   // 模块初始化标志位，防止重复
  * 
  * 动作：
  * 1. 打印状态日志
- * 2. 发布 XN_EVT_SYSTEM_INIT_DONE 事件
+ * 2. 向状态机投递 XN_EVT_SYSTEM_INIT_DONE 事件
  * 
  * 逻辑：
  * 系统启动后首先进入此状态，完成必要的底层初始化后，
  * 立即触发事件自动跳转到 WIFI_CONNECTING 状态。
+ * 事件在本次进入完成后由状态机内部队列处理，不经过事件总线。
  */
 static void on_enter_init(xn_fsm_t *fsm, void *user_data)
 {
     // 打印日志：进入INIT状态
     ESP_LOGI(TAG, "==> INIT state"); 
-    // 发送事件告知系统初始化已完成，驱动状态机流转
-    xn_event_post(XN_EVT_SYSTEM_INIT_DONE, XN_EVT_SRC_SYSTEM); 
+    // 投递初始化完成事件，待 on_enter 返回后驱动状态机流转
+    xn_fsm_process_event(fsm, XN_EVT_SYSTEM_INIT_DONE); 
 }
 
 /**
@@ -97,19 +157,21 @@ static void on_enter_wifi_connected(xn_fsm_t *fsm, void *user_data)
  * - WiFi 已连接且已获取 IP 地址
  * 
  * 逻辑：
- * 启动 OTA Manager，执行以下流程：
+ * 在独立任务中启动 OTA Manager，执行以下流程：
  * 1. 标记当前固件为有效
  * 2. 检查设备认证状态
  * 3. 检查固件更新
+ * 流程包含多次HTTP请求，不能阻塞事件分发任务；完成后投递
+ * XN_EVT_SYSTEM_OTA_CHECK_DONE（成功）或 XN_EVT_SYSTEM_ERROR（失败）。
+ * 完成事件不用 XN_EVT_SYSTEM_READY：该事件表示系统就绪，会触发崩溃上报与界面提示。
  */
 static void on_enter_ota_checking(xn_fsm_t *fsm, void *user_data)
 {
     ESP_LOGI(TAG, "==> OTA_CHECKING state");
     
-    // 启动 OTA Manager
-    esp_err_t ret = ota_manager_start();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "OTA manager start failed");
+    // 异步启动 OTA 流程
+    if (xn_fsm_start_async(fsm, ota_check_work, NULL, XN_EVT_SYSTEM_OTA_CHECK_DONE, XN_EVT_SYSTEM_ERROR) != ESP_OK) {
+        ESP_LOGE(TAG, "OTA check task start failed");
         xn_event_post(XN_EVT_SYSTEM_ERROR, XN_EVT_SRC_SYSTEM);
     }
 }
@@ -166,7 +228,8 @@ static void on_enter_mqtt_connecting(xn_fsm_t *fsm, void *user_data)
  * 2. MQTT 已连接到服务器
  * 
  * 动作：
- * 发布 XN_EVT_SYSTEM_READY 事件，通知业务层可以开始正常工作。
+ * 1. 发布 XN_EVT_SYSTEM_READY 事件，通知业务层可以开始正常工作。
+ * 2. 有可用更新时启动后台下载；新固件已下载完成则回到 UPDATE_STAGED。
  */
 static void on_enter_ready(xn_fsm_t *fsm, void *user_data)
 {
@@ -174,6 +237,35 @@ static void on_enter_ready(xn_fsm_t *fsm, void *user_data)
     ESP_LOGI(TAG, "==> READY state - System is fully operational"); 
     // 发送系统就绪事件，通知应用层或其他服务
     xn_event_post(XN_EVT_SYSTEM_READY, XN_EVT_SRC_SYSTEM); 
+    
+    // MQTT 重连后回到就绪时，已下载的固件仍待生效
+    if (ota_manager_is_staged()) {
+        xn_event_post(XN_EVT_SYSTEM_OTA_STAGED, XN_EVT_SRC_SYSTEM);
+    } else if (ota_manager_start_background() == ESP_OK) {
+        ESP_LOGI(TAG, "Firmware downloading in background");
+    }
+}
+
+/**
+ * @brief 进入 UPDATE_STAGED 状态动作
+ * 
+ * 说明：
+ * READY 的子状态，业务照常运行。新固件已写入 OTA 分区，
+ * 每隔 APP_STAGED_CHECK_MS 检查一次设备是否空闲（或已推迟到上限），
+ * 允许时在独立任务中重启。
+ */
+static void on_enter_update_staged(xn_fsm_t *fsm, void *user_data)
+{
+    ESP_LOGI(TAG, "==> UPDATE_STAGED state");
+    
+    if (!ota_manager_reboot_allowed()) {
+        ESP_LOGD(TAG, "Device busy, reboot postponed");
+        return;
+    }
+    if (xn_fsm_start_async(fsm, staged_reboot_work, NULL, XN_EVT_SYSTEM_OTA_REBOOT_SKIPPED,
+                           XN_EVT_SYSTEM_OTA_REBOOT_SKIPPED) != ESP_OK) {
+        ESP_LOGE(TAG, "Reboot task start failed");
+    }
 }
 
 /**
@@ -228,19 +320,29 @@ static void on_enter_error(xn_fsm_t *fsm, void *user_data)
  *                          状态定义表
  *===========================================================================*/
 
+// 状态表按 app_state_t 顺序排列，子状态通过下标引用父状态
+#define ONLINE  (&s_states[APP_STATE_ONLINE])
+#define READY   (&s_states[APP_STATE_READY])
+#define TIMEOUT XN_EVT_SYSTEM_STATE_TIMEOUT
+
 static const xn_fsm_state_t s_states[] = {
     {APP_STATE_INIT,            "INIT",             on_enter_init,              NULL, NULL},
     {APP_STATE_WIFI_CONNECTING, "WIFI_CONNECTING",  on_enter_wifi_connecting,   NULL, NULL},
-    {APP_STATE_WIFI_CONNECTED,  "WIFI_CONNECTED",   on_enter_wifi_connected,    NULL, NULL},
-    {APP_STATE_OTA_CHECKING,    "OTA_CHECKING",     on_enter_ota_checking,      NULL, NULL},
-    {APP_STATE_OTA_ACTIVATING,  "OTA_ACTIVATING",   on_enter_ota_activating,    NULL, NULL},
-    {APP_STATE_OTA_UPGRADING,   "OTA_UPGRADING",    on_enter_ota_upgrading,     NULL, NULL},
-    {APP_STATE_MQTT_CONNECTING, "MQTT_CONNECTING",  on_enter_mqtt_connecting,   NULL, NULL},
-    {APP_STATE_READY,           "READY",            on_enter_ready,             NULL, NULL},
+    {APP_STATE_WIFI_CONNECTED,  "WIFI_CONNECTED",   on_enter_wifi_connected,    NULL, NULL, ONLINE, APP_DHCP_TIMEOUT_MS, TIMEOUT},
+    {APP_STATE_OTA_CHECKING,    "OTA_CHECKING",     on_enter_ota_checking,      NULL, NULL, ONLINE, APP_OTA_CHECK_TIMEOUT_MS, TIMEOUT},
+    {APP_STATE_OTA_ACTIVATING,  "OTA_ACTIVATING",   on_enter_ota_activating,    NULL, NULL, ONLINE},
+    {APP_STATE_OTA_UPGRADING,   "OTA_UPGRADING",    on_enter_ota_upgrading,     NULL, NULL, ONLINE},
+    {APP_STATE_MQTT_CONNECTING, "MQTT_CONNECTING",  on_enter_mqtt_connecting,   NULL, NULL, ONLINE, APP_MQTT_CONNECT_TIMEOUT_MS, TIMEOUT},
+    {APP_STATE_READY,           "READY",            on_enter_ready,             NULL, NULL, ONLINE},
     {APP_STATE_BLUFI_CONFIG,    "BLUFI_CONFIG",     on_enter_blufi_config,      on_exit_blufi_config, NULL},
     {APP_STATE_ERROR,           "ERROR",            on_enter_error,             NULL, NULL},
+    {APP_STATE_ONLINE,          "ONLINE",           NULL,                       NULL, NULL},
+    {APP_STATE_UPDATE_STAGED,   "UPDATE_STAGED",    on_enter_update_staged,     NULL, NULL, READY, APP_STAGED_CHECK_MS, TIMEOUT},
 };
 
+#undef ONLINE
+#undef READY
+
 /*===========================================================================
  *                          转换定义表
  *===========================================================================*/
@@ -272,8 +374,8 @@ static const xn_fsm_transition_t s_transitions[] = {
     // 从 WIFI_CONNECTED
     // 成功获取 IP -> 进入 OTA 检查
     {APP_STATE_WIFI_CONNECTED,  XN_EVT_WIFI_GOT_IP,         APP_STATE_OTA_CHECKING,     NULL, NULL},
-    // IP 获取还没完成就断开了 -> 重新连接 WiFi
-    {APP_STATE_WIFI_CONNECTED,  XN_EVT_WIFI_DISCONNECTED,   APP_STATE_WIFI_CONNECTING,  NULL, NULL},
+    // 迟迟分配不到 IP -> 重新连接 WiFi
+    {APP_STATE_WIFI_CONNECTED,  TIMEOUT,                    APP_STATE_WIFI_CONNECTING,  NULL, NULL},
     // 在获取IP过程中，用户长按Boot键 -> 进入配网模式
     {APP_STATE_WIFI_CONNECTED,  XN_EVT_BUTTON_LONG_PRESS,   APP_STATE_BLUFI_CONFIG,     NULL, NULL},
     
@@ -282,11 +384,11 @@ static const xn_fsm_transition_t s_transitions[] = {
     // ============================================================
     // 从 OTA_CHECKING
     // OTA 检查完成，无需更新或认证 -> 连接 MQTT
-    {APP_STATE_OTA_CHECKING,    XN_EVT_SYSTEM_READY,        APP_STATE_MQTT_CONNECTING,  NULL, NULL},
+    {APP_STATE_OTA_CHECKING,    XN_EVT_SYSTEM_OTA_CHECK_DONE, APP_STATE_MQTT_CONNECTING, NULL, NULL},
     // 需要设备激活 -> 进入激活状态
     {APP_STATE_OTA_CHECKING,    XN_EVT_SYSTEM_INIT_DONE,    APP_STATE_OTA_ACTIVATING,   NULL, NULL},
-    // OTA 检查过程中 WiFi 掉线 -> 重新连接 WiFi
-    {APP_STATE_OTA_CHECKING,    XN_EVT_WIFI_DISCONNECTED,   APP_STATE_WIFI_CONNECTING,  NULL, NULL},
+    // OTA 服务器无响应 -> 跳过本次检查，先连接 MQTT
+    {APP_STATE_OTA_CHECKING,    TIMEOUT,                    APP_STATE_MQTT_CONNECTING,  NULL, NULL},
     
     // ============================================================
     // OTA 激活流程
@@ -294,8 +396,6 @@ static const xn_fsm_transition_t s_transitions[] = {
     // 从 OTA_ACTIVATING
     // 激活完成 -> 连接 MQTT
     {APP_STATE_OTA_ACTIVATING,  XN_EVT_SYSTEM_READY,        APP_STATE_MQTT_CONNECTING,  NULL, NULL},
-    // 激活过程中 WiFi 掉线 -> 重新连接 WiFi
-    {APP_STATE_OTA_ACTIVATING,  XN_EVT_WIFI_DISCONNECTED,   APP_STATE_WIFI_CONNECTING,  NULL, NULL},
     
     // ============================================================
     // OTA 升级流程
@@ -304,8 +404,8 @@ static const xn_fsm_transition_t s_transitions[] = {
     // 升级完成 -> 系统重启（由 OTA Manager 处理）
     // 升级失败 -> 错误状态
     {APP_STATE_OTA_UPGRADING,   XN_EVT_SYSTEM_ERROR,        APP_STATE_ERROR,            NULL, NULL},
-    // 升级过程中 WiFi 掉线 -> 错误状态
-    {APP_STATE_OTA_UPGRADING,   XN_EVT_WIFI_DISCONNECTED,   APP_STATE_ERROR,            NULL, NULL},
+    // 升级过程中 WiFi 掉线 -> 保持升级状态（覆盖 ONLINE 的重连规则），重连后从断点续传
+    {APP_STATE_OTA_UPGRADING,   XN_EVT_WIFI_DISCONNECTED,   APP_STATE_OTA_UPGRADING,    NULL, NULL},
     
     // ============================================================
     // MQTT 连接流程
@@ -313,8 +413,8 @@ static const xn_fsm_transition_t s_transitions[] = {
     // 从 MQTT_CONNECTING
     // MQTT 协议握手成功 -> 系统就绪 (READY)
     {APP_STATE_MQTT_CONNECTING, XN_EVT_MQTT_CONNECTED,      APP_STATE_READY,            NULL, NULL},
-    // 如果在连接 MQTT 过程中 WiFi 掉了 -> 回退到 WiFi 连接
-    {APP_STATE_MQTT_CONNECTING, XN_EVT_WIFI_DISCONNECTED,   APP_STATE_WIFI_CONNECTING,  NULL, NULL},
+    // Broker 长时间连不上 -> 重新连接 WiFi
+    {APP_STATE_MQTT_CONNECTING, TIMEOUT,                    APP_STATE_WIFI_CONNECTING,  NULL, NULL},
     // 在连接MQTT过程中，用户长按Boot键 -> 进入配网模式
     {APP_STATE_MQTT_CONNECTING, XN_EVT_BUTTON_LONG_PRESS,   APP_STATE_BLUFI_CONFIG,     NULL, NULL},
     
@@ -322,14 +422,27 @@ static const xn_fsm_transition_t s_transitions[] = {
     // 系统就绪状态 (稳定态)
     // ============================================================
     // 从 READY
-    // 任意时刻 WiFi 掉线 -> 回退到 WiFi 连接
-    {APP_STATE_READY,           XN_EVT_WIFI_DISCONNECTED,   APP_STATE_WIFI_CONNECTING,  NULL, NULL},
     // 仅 MQTT 掉线 (WiFi还在) -> 重新连接 MQTT
     {APP_STATE_READY,           XN_EVT_MQTT_DISCONNECTED,   APP_STATE_MQTT_CONNECTING,  NULL, NULL},
+    // 后台下载的新固件已就绪 -> 等待合适时机重启
+    {APP_STATE_READY,           XN_EVT_SYSTEM_OTA_STAGED,   APP_STATE_UPDATE_STAGED,    NULL, NULL},
     // 在就绪状态下，用户强制配网 -> 进入配网模式
     // REMOVED: 需求变更为仅联网阶段可配网
     // {APP_STATE_READY,           XN_CMD_BLUFI_START,         APP_STATE_BLUFI_CONFIG,     NULL, NULL},
     
+    // 从 UPDATE_STAGED（READY 子状态，MQTT 掉线等事件冒泡到 READY 处理）
+    // 检查间隔到 -> 重新进入本状态，空闲时重启，否则继续等待
+    {APP_STATE_UPDATE_STAGED,   TIMEOUT,                    APP_STATE_UPDATE_STAGED,    NULL, NULL},
+    // 待生效固件已不存在（重启任务直接返回） -> 回到就绪
+    {APP_STATE_UPDATE_STAGED,   XN_EVT_SYSTEM_OTA_REBOOT_SKIPPED, APP_STATE_READY,      NULL, NULL},
+    
+    // ============================================================
+    // 联网阶段 (ONLINE 父状态，子状态未处理的事件冒泡到这里)
+    // ============================================================
+    // 从 WIFI_CONNECTED / OTA_* / MQTT_CONNECTING / READY
+    // 任意子状态下 WiFi 掉线 -> 回退到 WiFi 连接
+    {APP_STATE_ONLINE,          XN_EVT_WIFI_DISCONNECTED,   APP_STATE_WIFI_CONNECTING,  NULL, NULL},
+    
     // ============================================================
     // 配网模式
     // ============================================================
@@ -347,6 +460,8 @@ static const xn_fsm_transition_t s_transitions[] = {
     {XN_STATE_ANY,              XN_EVT_SYSTEM_ERROR,        APP_STATE_ERROR,            NULL, NULL},
 };
 
+#undef TIMEOUT
+
 /*===========================================================================
  *                          事件处理
  *===========================================================================*/
@@ -361,8 +476,13 @@ static const xn_fsm_transition_t s_transitions[] = {
  */
 static void event_handler(const xn_event_t *event, void *user_data)
 {
+    // 状态机自己投递的事件带标签，交回状态机检查是否过期
+    uint32_t tag = XN_FSM_TAG_NONE;
+    if (event->source == XN_EVT_SRC_FSM && event->data_len == sizeof(tag)) {
+        memcpy(&tag, event->data, sizeof(tag));
+    }
     // 调用 FSM 处理函数，将事件 ID 传入状态机
-    esp_err_t ret = xn_fsm_process_event(&s_fsm, event->id); 
+    esp_err_t ret = xn_fsm_process_tagged_event(&s_fsm, event->id, tag); 
     // 如果返回值是 ESP_OK，说明发生了状态转换
     if (ret == ESP_OK) { 
         // 打印调试日志
@@ -390,6 +510,7 @@ esp_err_t app_state_machine_init(void)
         .transitions = s_transitions, // 转换定义表
         .transition_count = sizeof(s_transitions) / sizeof(s_transitions[0]), // 转换数量
         .user_data = NULL,          // 用户数据（此处未用到）
+        .post = fsm_post,           // 超时与异步完成事件经事件总线送回
     };
     
     // 初始化 FSM 实例
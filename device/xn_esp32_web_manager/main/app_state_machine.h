@@ -37,6 +37,8 @@ typedef enum {
     APP_STATE_READY,            ///< 系统就绪：MQTT已连接，可以正常收发业务数据
     APP_STATE_BLUFI_CONFIG,     ///< BluFi配网模式：启动蓝牙配网服务，等待用户配置WiFi信息
     APP_STATE_ERROR,            ///< 错误状态：系统遇到严重错误
+    APP_STATE_ONLINE,           ///< 联网阶段（父状态）：WiFi链路已建立，包含从等待IP到就绪的各子状态
+    APP_STATE_UPDATE_STAGED,    ///< 更新待生效（READY子状态）：新固件已在后台下载完成，等待空闲时重启
     APP_STATE_MAX,              ///< 状态最大值（辅助计数）
 } app_state_t;
 
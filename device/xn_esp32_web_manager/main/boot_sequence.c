@@ -0,0 +1,154 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-25 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-25 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\boot_sequence.c
+ * @Description: 启动编排实现 - 每个阶段一个临时任务，依赖通过事件组同步
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include "boot_sequence.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+
+static const char *TAG = "boot";
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+typedef struct stage_run stage_run_t;
+
+/**
+ * @brief 单个阶段的运行记录
+ */
+struct stage_run {
+    const boot_stage_t *stage;          ///< 阶段描述
+    size_t index;                       ///< 阶段下标
+    EventGroupHandle_t done;            ///< 完成事件组（每个阶段一位，成功失败都置位）
+    const stage_run_t *runs;            ///< 全部阶段的运行记录（查询依赖结果）
+    esp_err_t result;                   ///< 执行结果
+    bool skipped;                       ///< 依赖失败，未执行
+    int core_id;                        ///< 实际运行的核心
+    int64_t start_us;                   ///< 开始时间（自启动起）
+    int64_t end_us;                     ///< 结束时间（自启动起）
+};
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 阶段任务：等待依赖完成，执行初始化，置完成位后删除自身
+ */
+static void stage_task(void *arg)
+{
+    stage_run_t *run = (stage_run_t *)arg;
+    const boot_stage_t *stage = run->stage;
+
+    if (stage->deps != 0) {
+        xEventGroupWaitBits(run->done, stage->deps, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+
+    // 依赖中有失败（或被跳过）的阶段时不执行
+    for (int i = 0; i < BOOT_MAX_STAGES; i++) {
+        if ((stage->deps & BOOT_DEP(i)) && run->runs[i].result != ESP_OK) {
+            run->skipped = true;
+            run->result = ESP_ERR_INVALID_STATE;
+            break;
+        }
+    }
+
+    run->core_id = xPortGetCoreID();
+    run->start_us = esp_timer_get_time();
+    if (!run->skipped) {
+        run->result = stage->init();
+    }
+    run->end_us = esp_timer_get_time();
+
+    // 事件组置位同时保证上面的结果对等待者可见
+    xEventGroupSetBits(run->done, BOOT_DEP(run->index));
+    vTaskDelete(NULL);
+}
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+esp_err_t boot_sequence_run(const boot_stage_t *stages, size_t count)
+{
+    if (stages == NULL || count == 0 || count > BOOT_MAX_STAGES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // 只允许依赖前面的阶段，保证没有环
+    for (size_t i = 0; i < count; i++) {
+        if (stages[i].init == NULL || (stages[i].deps & ~(BOOT_DEP(i) - 1)) != 0) {
+            ESP_LOGE(TAG, "Invalid stage %u (%s)", (unsigned)i, stages[i].name ? stages[i].name : "?");
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    stage_run_t *runs = calloc(count, sizeof(stage_run_t));
+    EventGroupHandle_t done = xEventGroupCreate();
+    if (runs == NULL || done == NULL) {
+        free(runs);
+        if (done) {
+            vEventGroupDelete(done);
+        }
+        return ESP_ERR_NO_MEM;
+    }
+
+    int64_t boot_start_us = esp_timer_get_time();
+    UBaseType_t prio = uxTaskPriorityGet(NULL);
+    for (size_t i = 0; i < count; i++) {
+        stage_run_t *run = &runs[i];
+        run->stage = &stages[i];
+        run->index = i;
+        run->done = done;
+        run->runs = runs;
+        run->result = ESP_ERR_INVALID_STATE;
+        run->core_id = -1;
+
+        uint32_t stack = stages[i].stack_size ? stages[i].stack_size : BOOT_STAGE_STACK;
+        if (xTaskCreatePinnedToCore(stage_task, stages[i].name, stack, run, prio, NULL,
+                                    stages[i].core) != pdPASS) {
+            // 创建失败按阶段失败处理，依赖它的阶段随之跳过
+            ESP_LOGE(TAG, "Failed to create task for stage %s", stages[i].name);
+            run->result = ESP_ERR_NO_MEM;
+            run->start_us = run->end_us = esp_timer_get_time();
+            xEventGroupSetBits(done, BOOT_DEP(i));
+        }
+    }
+
+    xEventGroupWaitBits(done, BOOT_DEP(count) - 1, pdFALSE, pdTRUE, portMAX_DELAY);
+    int64_t boot_end_us = esp_timer_get_time();
+
+    // 各阶段耗时汇总，时间均为自上电起的毫秒数
+    esp_err_t ret = ESP_OK;
+    ESP_LOGI(TAG, "%-12s %8s %8s %5s  %s", "stage", "start", "time", "core", "result");
+    for (size_t i = 0; i < count; i++) {
+        const stage_run_t *run = &runs[i];
+        const char *result = run->skipped ? "skipped" : esp_err_to_name(run->result);
+        if (run->result == ESP_OK) {
+            ESP_LOGI(TAG, "%-12s %6ums %6ums %5d  %s", stages[i].name, (unsigned)(run->start_us / 1000),
+                     (unsigned)((run->end_us - run->start_us) / 1000), run->core_id, result);
+        } else {
+            ESP_LOGW(TAG, "%-12s %6ums %6ums %5d  %s%s", stages[i].name, (unsigned)(run->start_us / 1000),
+                     (unsigned)((run->end_us - run->start_us) / 1000), run->core_id, result,
+                     stages[i].optional ? " (optional)" : "");
+            if (!stages[i].optional && ret == ESP_OK) {
+                ret = run->result;
+            }
+        }
+    }
+    ESP_LOGI(TAG, "Boot stages finished in %ums", (unsigned)((boot_end_us - boot_start_us) / 1000));
+
+    vEventGroupDelete(done);
+    free(runs);
+    return ret;
+}
@@ -0,0 +1,76 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-25 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-25 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\boot_sequence.h
+ * @Description: 启动编排头文件 - 按依赖关系并行执行各模块初始化
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef BOOT_SEQUENCE_H
+#define BOOT_SEQUENCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ *                          类型定义
+ *===========================================================================*/
+
+#define BOOT_MAX_STAGES         24              ///< 最大阶段数（受事件组可用位数限制）
+#define BOOT_DEP(stage)         (1UL << (stage)) ///< 依赖位：stage 为阶段在表中的下标
+#define BOOT_STAGE_STACK        4096            ///< 默认阶段任务栈大小
+
+/**
+ * @brief 阶段初始化函数
+ */
+typedef esp_err_t (*boot_stage_fn_t)(void);
+
+/**
+ * @brief 启动阶段描述
+ *
+ * 依赖全部完成后，阶段在独立任务中执行，没有依赖关系的阶段并行运行。
+ */
+typedef struct {
+    const char *name;                   ///< 阶段名（日志用）
+    boot_stage_fn_t init;               ///< 初始化函数
+    uint32_t deps;                      ///< 依赖的阶段 BOOT_DEP(i) 组合，只能依赖表中排在前面的阶段
+    bool optional;                      ///< 可选阶段：失败不影响启动结果，依赖它的阶段跳过
+    BaseType_t core;                    ///< 运行核心，tskNO_AFFINITY 不绑定
+    uint32_t stack_size;                ///< 任务栈大小，0 使用 BOOT_STAGE_STACK
+} boot_stage_t;
+
+/*===========================================================================
+ *                          API
+ *===========================================================================*/
+
+/**
+ * @brief 执行启动阶段表
+ *
+ * - 每个阶段等待其依赖完成后立即开始，依赖失败（或被跳过）时本阶段跳过
+ * - 阶段任务与调用者同优先级，完成后自行删除
+ * - 全部阶段结束后打印各阶段的开始时间、耗时、运行核心和结果
+ *
+ * @param stages 阶段表
+ * @param count 阶段数量，不超过 BOOT_MAX_STAGES
+ * @return esp_err_t
+ *      - ESP_OK: 所有必需阶段成功
+ *      - ESP_ERR_INVALID_ARG: 阶段表无效（数量超限或依赖了后面的阶段）
+ *      - 其他: 第一个失败的必需阶段的错误码（依赖失败被跳过时为 ESP_ERR_INVALID_STATE）
+ */
+esp_err_t boot_sequence_run(const boot_stage_t *stages, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_SEQUENCE_H
@@ -17,17 +17,35 @@
 #include "nvs_flash.h"
 
 #include "xn_event_bus.h"
+#include "xn_storage.h"
+#include "xn_sched.h"
 #include "app_state_machine.h"
+#include "boot_sequence.h"
 #include "managers/wifi_manager.h"
 #include "managers/mqtt_manager.h"
-#include "managers/mqtt_manager.h"
 #include "managers/blufi_manager.h"
 #include "managers/button_manager.h"
 #include "managers/display_manager.h"
+#include "managers/power_manager.h"
+#include "managers/audio_manager.h"
+#include "managers/voice_manager.h"
+#include "managers/player_manager.h"
+#include "managers/speech_manager.h"
+#include "managers/sysmon_manager.h"
+#include "managers/crash_manager.h"
+#include "managers/log_manager.h"
+#include "managers/gateway_manager.h"
 
 // 模块日志标签
 static const char *TAG = "main";
 
+// 显示阶段所在核心：与 WiFi/协议栈（默认在核心0）分开
+#if CONFIG_FREERTOS_UNICORE
+#define BOOT_CORE_DISPLAY   tskNO_AFFINITY
+#else
+#define BOOT_CORE_DISPLAY   1
+#endif
+
 /**
  * @brief 初始化非易失性存储(NVS)
  * 
@@ -54,6 +72,127 @@ static esp_err_t init_nvs(void)
     return ret;
 }
 
+/*===========================================================================
+ *                          启动阶段
+ *===========================================================================*/
+
+/**
+ * @brief 启动阶段下标（依赖只能指向排在前面的阶段）
+ */
+enum {
+    STAGE_POWER = 0,        ///< 电源管理（DFS 与自动 light sleep）
+    STAGE_NVS,              ///< NVS 与存储缓存
+    STAGE_EVENT_LOOP,       ///< 系统默认事件循环
+    STAGE_EVENT_BUS,        ///< 自定义事件总线
+    STAGE_SCHED,            ///< 共享调度器（MQTT、系统监控、日志上报的定时作业）
+    STAGE_FSM,              ///< 应用状态机
+    STAGE_DISPLAY,          ///< 显示（屏幕复位与 UI 构建最慢，不在 WiFi 的关键路径上）
+    STAGE_WIFI,             ///< WiFi 管理器
+    STAGE_MQTT,             ///< MQTT 管理器
+    STAGE_BLUFI,            ///< BluFi 管理器（只订阅事件，蓝牙栈在进入配网时才启动）
+    STAGE_BUTTON,           ///< 按键管理器
+    STAGE_AUDIO,            ///< 音频采集（可选，未接麦克风时不影响联网）
+    STAGE_VOICE,            ///< 语音上行（可选，依赖音频采集与 MQTT）
+    STAGE_PLAYER,           ///< 下行语音播放（可选，依赖 MQTT）
+    STAGE_SPEECH,           ///< 本地唤醒词与命令词（可选，依赖音频采集）
+    STAGE_SYSMON,           ///< 系统监控（可选，依赖 MQTT 上报）
+    STAGE_CRASH,            ///< 崩溃上报（可选，依赖 MQTT 上报）
+    STAGE_LOG,              ///< 日志上报（可选，依赖 MQTT 上报）
+    STAGE_GATEWAY,          ///< 子设备网关（可选，依赖 MQTT 转发）
+    STAGE_START,            ///< 启动状态机，进入 WIFI_CONNECTING 开始连接
+    STAGE_COUNT,
+};
+
+/**
+ * @brief NVS 与存储缓存（存储缓存在这里统一加载，避免各模块并发初始化）
+ */
+static esp_err_t boot_nvs(void)
+{
+    esp_err_t ret = init_nvs();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return xn_storage_init();
+}
+
+/**
+ * @brief 系统默认事件循环
+ */
+static esp_err_t boot_event_loop(void)
+{
+    return esp_event_loop_create_default();
+}
+
+/**
+ * @brief 配置并初始化 MQTT 管理器
+ */
+static esp_err_t boot_mqtt(void)
+{
+    mqtt_manager_config_t mqtt_cfg = MQTT_MANAGER_DEFAULT_CONFIG(); // 使用默认配置
+    mqtt_cfg.broker_uri = "mqtt://broker.emqx.io:1883";             // 设置MQTT Broker地址
+    mqtt_cfg.base_topic = "xn/device";                              // 设置项目基础Topic
+#if CONFIG_XN_POWER_SAVE
+    mqtt_cfg.keepalive_sec = CONFIG_XN_POWER_MQTT_KEEPALIVE_SEC;    // 低功耗模式延长保活，减少唤醒
+#endif
+    return mqtt_manager_init(&mqtt_cfg);
+}
+
+/**
+ * @brief 启动阶段表
+ *
+ * 状态机启动不等待显示，WiFi 连接与屏幕初始化在两个核心上同时进行；
+ * 显示管理器先订阅事件再初始化屏幕，期间的状态变化不会丢失。
+ */
+static const boot_stage_t s_boot_stages[STAGE_COUNT] = {
+    [STAGE_POWER]      = {"power",      power_manager_init,     0,
+                          false, tskNO_AFFINITY, 0},
+    [STAGE_NVS]        = {"nvs",        boot_nvs,               0,
+                          false, tskNO_AFFINITY, 0},
+    [STAGE_EVENT_LOOP] = {"event_loop", boot_event_loop,        0,
+                          false, tskNO_AFFINITY, 0},
+    [STAGE_EVENT_BUS]  = {"event_bus",  xn_event_bus_init,      0,
+                          false, tskNO_AFFINITY, 0},
+    [STAGE_SCHED]      = {"sched",      xn_sched_init,          0,
+                          false, tskNO_AFFINITY, 0},
+    [STAGE_FSM]        = {"fsm",        app_state_machine_init, BOOT_DEP(STAGE_EVENT_BUS),
+                          false, tskNO_AFFINITY, 0},
+    // 显示初始化失败不影响其他功能，继续运行
+    [STAGE_DISPLAY]    = {"display",    display_manager_init,   BOOT_DEP(STAGE_EVENT_BUS),
+                          true,  BOOT_CORE_DISPLAY, 8192},
+    [STAGE_WIFI]       = {"wifi",       wifi_manager_init,
+                          BOOT_DEP(STAGE_NVS) | BOOT_DEP(STAGE_EVENT_LOOP) | BOOT_DEP(STAGE_EVENT_BUS),
+                          false, tskNO_AFFINITY, 0},
+    [STAGE_MQTT]       = {"mqtt",       boot_mqtt,
+                          BOOT_DEP(STAGE_NVS) | BOOT_DEP(STAGE_EVENT_LOOP) | BOOT_DEP(STAGE_EVENT_BUS) |
+                          BOOT_DEP(STAGE_SCHED),
+                          false, tskNO_AFFINITY, 0},
+    [STAGE_BLUFI]      = {"blufi",      blufi_manager_init,     BOOT_DEP(STAGE_EVENT_BUS),
+                          false, tskNO_AFFINITY, 0},
+    [STAGE_BUTTON]     = {"button",     button_manager_init,    BOOT_DEP(STAGE_EVENT_BUS),
+                          false, tskNO_AFFINITY, 0},
+    [STAGE_AUDIO]      = {"audio",      audio_manager_init,     BOOT_DEP(STAGE_EVENT_BUS),
+                          true,  tskNO_AFFINITY, 0},
+    [STAGE_VOICE]      = {"voice",      voice_manager_init,     BOOT_DEP(STAGE_AUDIO) | BOOT_DEP(STAGE_MQTT),
+                          true,  tskNO_AFFINITY, 0},
+    [STAGE_PLAYER]     = {"player",     player_manager_init,    BOOT_DEP(STAGE_EVENT_BUS) | BOOT_DEP(STAGE_MQTT),
+                          true,  tskNO_AFFINITY, 0},
+    [STAGE_SPEECH]     = {"speech",     speech_manager_init,    BOOT_DEP(STAGE_AUDIO),
+                          true,  tskNO_AFFINITY, 0},
+    [STAGE_SYSMON]     = {"sysmon",     sysmon_manager_init,    BOOT_DEP(STAGE_EVENT_BUS) | BOOT_DEP(STAGE_MQTT),
+                          true,  tskNO_AFFINITY, 0},
+    [STAGE_CRASH]      = {"crash",      crash_manager_init,     BOOT_DEP(STAGE_EVENT_BUS) | BOOT_DEP(STAGE_MQTT),
+                          true,  tskNO_AFFINITY, 0},
+    [STAGE_LOG]        = {"log",        log_manager_init,       BOOT_DEP(STAGE_MQTT),
+                          true,  tskNO_AFFINITY, 0},
+    [STAGE_GATEWAY]    = {"gateway",    gateway_manager_init,
+                          BOOT_DEP(STAGE_EVENT_BUS) | BOOT_DEP(STAGE_SCHED) | BOOT_DEP(STAGE_MQTT),
+                          true,  tskNO_AFFINITY, 0},
+    [STAGE_START]      = {"fsm_start",  app_state_machine_start,
+                          BOOT_DEP(STAGE_FSM) | BOOT_DEP(STAGE_WIFI) | BOOT_DEP(STAGE_MQTT) |
+                          BOOT_DEP(STAGE_BLUFI) | BOOT_DEP(STAGE_BUTTON),
+                          false, tskNO_AFFINITY, 0},
+};
+
 /**
  * @brief 应用程序主入口
  */
@@ -66,61 +205,8 @@ void app_main(void)
     // 打印系统启动分割线日志
     ESP_LOGI(TAG, "========================================");
     
-    // 初始化NVS子系统
-    ESP_ERROR_CHECK(init_nvs());
-    // 打印NVS初始化成功日志
-    ESP_LOGI(TAG, "NVS initialized");
-    
-    // 创建系统默认事件循环
-    ESP_ERROR_CHECK(esp_event_loop_create_default());
-    // 打印事件循环创建成功日志
-    ESP_LOGI(TAG, "Event loop created");
-    
-    // 初始化自定义事件总线
-    ESP_ERROR_CHECK(xn_event_bus_init());
-    // 打印事件总线初始化成功日志
-    ESP_LOGI(TAG, "Event bus initialized");
-    
-    // 初始化应用状态机
-    ESP_ERROR_CHECK(app_state_machine_init());
-    ESP_LOGI(TAG, "App state machine initialized");
-    
-    // 初始化显示管理器
-    esp_err_t ret = display_manager_init();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to initialize display manager: %s", esp_err_to_name(ret));
-        // 显示初始化失败不影响其他功能，继续运行
-    } else {
-        ESP_LOGI(TAG, "Display manager initialized");
-    }
-    
-    // 初始化WiFi管理器
-    ESP_ERROR_CHECK(wifi_manager_init());
-    // 打印WiFi管理器初始化成功日志
-    ESP_LOGI(TAG, "WiFi manager initialized");
-    
-    // 配置MQTT管理器
-    mqtt_manager_config_t mqtt_cfg = MQTT_MANAGER_DEFAULT_CONFIG(); // 使用默认配置
-    mqtt_cfg.broker_uri = "mqtt://broker.emqx.io:1883";             // 设置MQTT Broker地址
-    mqtt_cfg.base_topic = "xn/device";                              // 设置项目基础Topic
-    // 初始化MQTT管理器
-    ESP_ERROR_CHECK(mqtt_manager_init(&mqtt_cfg));
-    // 打印MQTT管理器初始化成功日志
-    ESP_LOGI(TAG, "MQTT manager initialized");
-    
-    // 初始化BluFi配网管理器
-    ESP_ERROR_CHECK(blufi_manager_init());
-    // 打印BluFi管理器初始化成功日志
-    ESP_LOGI(TAG, "BluFi manager initialized");
-
-    // 初始化按键管理器
-    ESP_ERROR_CHECK(button_manager_init());
-    ESP_LOGI(TAG, "Button manager initialized");
-    
-    // 启动应用状态机
-    ESP_ERROR_CHECK(app_state_machine_start());
-    // 打印状态机启动成功日志
-    ESP_LOGI(TAG, "App state machine started");
+    // 按依赖关系并行初始化各模块，任一必需阶段失败时中止
+    ESP_ERROR_CHECK(boot_sequence_run(s_boot_stages, STAGE_COUNT));
     
     // 打印系统初始化完成分割线日志
     ESP_LOGI(TAG, "========================================");
@@ -129,12 +215,5 @@ void app_main(void)
     // 打印系统初始化完成分割线日志
     ESP_LOGI(TAG, "========================================");
     
-    // 进入主循环
-    while (1) {
-        // 延时10秒
-        vTaskDelay(pdMS_TO_TICKS(10000));
-        // 获取并打印当前应用状态机所处状态
-        ESP_LOGI(TAG, "System state: %s", app_state_machine_get_state_name());
-    }
+    // 各模块由事件驱动，主任务到此结束；状态变化由状态机在进入各状态时打印
 }
-
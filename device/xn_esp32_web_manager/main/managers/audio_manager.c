@@ -0,0 +1,79 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-25 16:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-25 16:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\audio_manager.c
+ * @Description: 音频管理器实现 - 按板级引脚启动采集，语音起止转换为事件总线事件
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "xn_audio.h"
+#include "xn_audio_dsp.h"
+#include "xn_event_bus.h"
+#include "audio_manager.h"
+
+static const char *TAG = "audio_manager";
+
+#if CONFIG_XN_AUDIO_ENABLE
+/**
+ * @brief 语音起止回调（采集任务中执行，只投递事件）
+ */
+static void on_speech(bool speech, uint32_t duration_ms, void *user_data)
+{
+    (void)user_data;
+
+    xn_evt_audio_speech_t data = {
+        .duration_ms = duration_ms,
+    };
+    ESP_LOGI(TAG, "Speech %s (%u ms)", speech ? "start" : "end", (unsigned)duration_ms);
+    xn_event_post_data(speech ? XN_EVT_AUDIO_SPEECH_START : XN_EVT_AUDIO_SPEECH_END,
+                       XN_EVT_SRC_AUDIO, &data, sizeof(data));
+}
+#endif
+
+esp_err_t audio_manager_init(void)
+{
+#if CONFIG_XN_AUDIO_DSP_BENCHMARK
+    // 按 16kHz / 20ms 帧测量各 DSP 内核的每帧周期数
+    xn_audio_dsp_benchmark(16000, 20);
+#endif
+
+#if CONFIG_XN_AUDIO_ENABLE
+    xn_audio_config_t config = xn_audio_get_default_config();
+    config.pin_bclk = CONFIG_XN_AUDIO_PIN_BCLK;
+    config.pin_ws = CONFIG_XN_AUDIO_PIN_WS;
+    config.pin_din = CONFIG_XN_AUDIO_PIN_DIN;
+#if CONFIG_FREERTOS_UNICORE
+    config.task_core = 0;
+#else
+    config.task_core = CONFIG_XN_AUDIO_TASK_CORE;
+#endif
+    config.vad_cb = on_speech;
+#if CONFIG_XN_VOICE_ENABLE
+    // 语音上行持有 preroll 与编码队列中的帧，帧池留出余量
+    config.pool_frames = 16;
+#endif
+
+    esp_err_t ret = xn_audio_init(&config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to init audio: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ret = xn_audio_start();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start capture: %s", esp_err_to_name(ret));
+        xn_audio_deinit();
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Audio manager initialized");
+#else
+    ESP_LOGI(TAG, "Audio capture disabled");
+#endif
+    return ESP_OK;
+}
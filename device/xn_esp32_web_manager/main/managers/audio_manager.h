@@ -0,0 +1,37 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-25 16:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-25 16:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\audio_manager.h
+ * @Description: 音频管理器 - 麦克风采集与语音起止事件
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#ifndef AUDIO_MANAGER_H
+#define AUDIO_MANAGER_H
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 初始化音频管理器
+ * 
+ * - 未开启 CONFIG_XN_AUDIO_ENABLE 时直接返回成功
+ * - 按 Kconfig 引脚初始化 xn_audio 并开始采集
+ * - 语音起止投递 XN_EVT_AUDIO_SPEECH_START / XN_EVT_AUDIO_SPEECH_END，
+ *   PCM 帧不经过事件总线，由使用者通过 xn_audio_register_consumer 获取
+ * 
+ * @return esp_err_t 初始化结果
+ */
+esp_err_t audio_manager_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_MANAGER_H */
@@ -10,12 +10,19 @@
  */
 
 #include <string.h> // 包含字符串库
+#include <stdlib.h> // 包含内存分配
 #include "freertos/FreeRTOS.h" // 包含FreeRTOS核心
 #include "freertos/task.h" // 包含FreeRTOS任务
+#include "freertos/semphr.h" // 包含FreeRTOS信号量
+#include "esp_timer.h" // 包含高精度定时器
+#include "sdkconfig.h" // 包含工程配置
 #include "esp_log.h" // 包含日志库
 #include "xn_event_bus.h" // 包含事件总线库
 #include "blufi_manager.h" // 包含Blufi管理器库
 #include "xn_blufi.h" // 包含Blufi组件库
+#include "xn_blufi_xfer.h" // 包含Blufi批量传输
+#include "xn_storage.h" // 包含存储组件（批量传输 NVS 目标）
+#include "esp_partition.h" // 包含分区操作（批量传输分区目标）
 #include "wifi_manager.h" // 包含WiFi管理器库
 
 static const char *TAG = "blufi_manager";
@@ -28,7 +35,209 @@ static const char *TAG = "blufi_manager";
 
 static bool s_initialized = false;
 static bool s_running = false;
-static xn_blufi_t *s_blufi_instance = NULL;
+static bool s_provisioned = false; // 本次配网期间WiFi已连接成功
+static xn_blufi_t *s_blufi_instance = NULL; // 仅在配网期间存在
+
+// 配网扫描缓存：进入配网即后台扫描，手机请求列表时缓存未过期就直接发送
+typedef struct {
+    xn_blufi_ap_t aps[CONFIG_XN_BLUFI_WIFI_LIST_MAX]; // 压缩后的扫描结果
+    uint16_t count; // 条数
+    int64_t scanned_us; // 扫描完成时间，0 表示尚无结果
+    bool scanning; // 扫描进行中
+    bool requested; // 手机在扫描完成前请求过列表，完成后发送
+} scan_cache_t;
+
+static scan_cache_t *s_scan = NULL; // 仅在配网期间存在
+static SemaphoreHandle_t s_scan_mutex = NULL; // 扫描缓存保护锁（NimBLE Host 任务与事件任务并发访问）
+#define SCAN_LOCK() xSemaphoreTake(s_scan_mutex, portMAX_DELAY)
+#define SCAN_UNLOCK() xSemaphoreGive(s_scan_mutex)
+
+static esp_timer_handle_t s_exit_timer = NULL; // 配网成功后延时退出配网模式
+
+/*===========================================================================
+ *                          扫描缓存
+ *===========================================================================*/
+
+// 发送缓存的列表（需持有 s_scan_mutex）
+static void send_cached_list(void)
+{
+    xn_blufi_send_ap_list(s_scan->aps, s_scan->count);
+}
+
+// 扫描完成回调（事件任务中调用）：压缩后写入缓存，手机等待中则立即发送
+static void on_wifi_scan_done(uint16_t ap_count, wifi_ap_record_t *ap_list)
+{
+    SCAN_LOCK();
+    if (!s_running || !s_scan) { // 扫描期间已退出配网，蓝牙栈已关闭
+        SCAN_UNLOCK();
+        return;
+    }
+    s_scan->count = xn_blufi_compact_ap_list(ap_count, ap_list, s_scan->aps, CONFIG_XN_BLUFI_WIFI_LIST_MAX);
+    s_scan->scanned_us = esp_timer_get_time();
+    s_scan->scanning = false;
+    ESP_LOGI(TAG, "WiFi scan cached: %d APs -> %d SSIDs", ap_count, s_scan->count);
+    if (s_scan->requested) {
+        s_scan->requested = false;
+        send_cached_list();
+    }
+    SCAN_UNLOCK();
+}
+
+// 启动后台扫描（需持有 s_scan_mutex），无法启动时手机等待中就先发送已有的缓存
+static void start_scan(void)
+{
+    if (s_scan->scanning) return;
+    s_scan->scanning = true;
+    if (wifi_manager_scan(on_wifi_scan_done) != ESP_OK) {
+        ESP_LOGW(TAG, "WiFi scan busy, using cached list");
+        s_scan->scanning = false;
+        if (s_scan->requested) {
+            s_scan->requested = false;
+            send_cached_list();
+        }
+    }
+}
+
+// 在缓存中查找SSID的最强BSSID，找到返回true
+static bool find_cached_ap(const char *ssid, xn_blufi_ap_t *ap)
+{
+    bool found = false;
+    SCAN_LOCK();
+    for (uint16_t i = 0; s_scan && i < s_scan->count; i++) {
+        if (strcmp(s_scan->aps[i].ssid, ssid) == 0) {
+            *ap = s_scan->aps[i];
+            found = true;
+            break;
+        }
+    }
+    SCAN_UNLOCK();
+    return found;
+}
+
+// 退出配网：标记停止并释放扫描缓存（此后到达的扫描结果直接丢弃）
+static void free_scan_cache(void)
+{
+    SCAN_LOCK();
+    s_running = false;
+    free(s_scan);
+    s_scan = NULL;
+    SCAN_UNLOCK();
+}
+
+// 配网成功后延时退出（esp_timer 任务中调用），手机有时间收到连接报告
+static void exit_timer_cb(void *arg)
+{
+    (void)arg;
+    ESP_LOGI(TAG, "Provisioned, leaving BluFi mode");
+    xn_event_post(XN_EVT_BLUFI_CONFIG_DONE, XN_EVT_SRC_BLUFI);
+}
+
+/*===========================================================================
+ *                          批量传输目标
+ *===========================================================================*/
+
+// 当前传输的写入目标，只在 NimBLE Host 任务中访问
+typedef struct {
+    uint8_t target; // XN_BLUFI_XFER_TARGET_*
+    char name[33]; // NVS 键名或分区标签
+    uint32_t total; // 总长度
+    uint8_t *buf; // NVS：收齐后一次写入的缓冲
+    const esp_partition_t *part; // 分区
+    uint32_t erased; // 分区：已擦除到的偏移
+} xfer_sink_ctx_t;
+
+static xfer_sink_ctx_t s_xfer_ctx;
+
+// 逗号分隔的允许列表中是否包含 name
+static bool name_allowed(const char *list, const char *name)
+{
+    size_t n = strlen(name);
+    const char *p = list;
+    while (*p) {
+        const char *end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if (len == n && strncmp(p, name, n) == 0) return true;
+        if (!end) break;
+        p = end + 1;
+    }
+    return false;
+}
+
+// 开始写入：只允许配置中列出的键和分区
+static xn_blufi_xfer_status_t xfer_begin(uint8_t target, const char *name, uint32_t total, void *user_data)
+{
+    xfer_sink_ctx_t *ctx = &s_xfer_ctx;
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->target = target;
+    strlcpy(ctx->name, name, sizeof(ctx->name));
+    ctx->total = total;
+
+    if (target == XN_BLUFI_XFER_TARGET_NVS) {
+        if (!name_allowed(CONFIG_XN_BLUFI_XFER_NVS_KEYS, name)) return XN_BLUFI_XFER_ERR_TARGET;
+        if (total == 0 || total > CONFIG_XN_BLUFI_XFER_NVS_MAX) return XN_BLUFI_XFER_ERR_SIZE;
+        ctx->buf = malloc(total);
+        return ctx->buf ? XN_BLUFI_XFER_OK : XN_BLUFI_XFER_ERR_WRITE;
+    }
+    if (target == XN_BLUFI_XFER_TARGET_PARTITION) {
+        if (!name_allowed(CONFIG_XN_BLUFI_XFER_PARTITIONS, name)) return XN_BLUFI_XFER_ERR_TARGET;
+        ctx->part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, name);
+        if (!ctx->part) return XN_BLUFI_XFER_ERR_TARGET;
+        if (total == 0 || total > ctx->part->size) return XN_BLUFI_XFER_ERR_SIZE;
+        return XN_BLUFI_XFER_OK;
+    }
+    return XN_BLUFI_XFER_ERR_TARGET;
+}
+
+// 写入一个分块：分区目标写到哪擦到哪后直接写入，NVS 目标拷贝到缓冲
+static xn_blufi_xfer_status_t xfer_write(uint32_t offset, const uint8_t *data, size_t len, void *user_data)
+{
+    xfer_sink_ctx_t *ctx = &s_xfer_ctx;
+    if (ctx->buf) {
+        memcpy(ctx->buf + offset, data, len);
+        return XN_BLUFI_XFER_OK;
+    }
+    uint32_t sector = ctx->part->erase_size;
+    while (offset + len > ctx->erased) {
+        if (esp_partition_erase_range(ctx->part, ctx->erased, sector) != ESP_OK) return XN_BLUFI_XFER_ERR_WRITE;
+        ctx->erased += sector;
+    }
+    return esp_partition_write(ctx->part, offset, data, len) == ESP_OK ? XN_BLUFI_XFER_OK : XN_BLUFI_XFER_ERR_WRITE;
+}
+
+// 结束写入：校验通过时提交并通知，否则丢弃
+static xn_blufi_xfer_status_t xfer_end(bool ok, void *user_data)
+{
+    xfer_sink_ctx_t *ctx = &s_xfer_ctx;
+    xn_blufi_xfer_status_t status = XN_BLUFI_XFER_OK;
+
+    if (ctx->buf) {
+        if (ok && (xn_storage_set_blob(ctx->name, ctx->buf, ctx->total) != ESP_OK || xn_storage_commit() != ESP_OK)) {
+            status = XN_BLUFI_XFER_ERR_WRITE;
+        }
+        free(ctx->buf);
+        ctx->buf = NULL;
+    } else if (ctx->part && !ok && ctx->erased > 0) {
+        // 擦掉首扇区，使用方按头部校验时不会把半截内容当成有效数据
+        esp_partition_erase_range(ctx->part, 0, ctx->part->erase_size);
+    }
+
+    if (ok && status == XN_BLUFI_XFER_OK) {
+        xn_evt_blufi_xfer_t evt = {
+            .target = ctx->target,
+            .size = ctx->total,
+        };
+        strlcpy(evt.name, ctx->name, sizeof(evt.name));
+        xn_event_post_data(XN_EVT_BLUFI_XFER_DONE, XN_EVT_SRC_BLUFI, &evt, sizeof(evt));
+    }
+    ctx->part = NULL;
+    return status;
+}
+
+static const xn_blufi_xfer_sink_t s_xfer_sink = {
+    .begin = xfer_begin,
+    .write = xfer_write,
+    .end = xfer_end,
+};
 
 /*===========================================================================
  *                          BluFi 回调实现
@@ -38,7 +247,12 @@ static xn_blufi_t *s_blufi_instance = NULL;
 static void on_recv_sta_config(xn_blufi_t *blufi, const char *ssid, const char *password)
 {
     ESP_LOGI(TAG, "BluFi received config: SSID=%s", ssid);
-    // 调用应用层WiFi管理器进行连接（并保存）
+    // 调用应用层WiFi管理器进行连接（并保存）；预扫描见过该SSID时锁定最强的BSSID/信道，跳过全信道扫描
+    xn_blufi_ap_t ap;
+    if (find_cached_ap(ssid, &ap)) {
+        ESP_LOGI(TAG, "Connect via cached AP (ch %d, %d dBm)", ap.channel, ap.rssi);
+        if (wifi_manager_connect_hint(ssid, password, ap.bssid, ap.channel) == ESP_OK) return;
+    }
     wifi_manager_connect(ssid, password);
 }
 
@@ -58,26 +272,32 @@ static void on_disconnect_request(xn_blufi_t *blufi)
     wifi_manager_disconnect();
 }
 
-// 扫描完成中转回调
-static void on_wifi_scan_done(uint16_t ap_count, wifi_ap_record_t *ap_list)
-{
-    ESP_LOGI(TAG, "WiFi scan done, sending to BluFi phone");
-    // 将扫描结果回传给手机
-    xn_blufi_send_wifi_list(ap_count, ap_list);
-}
-
-// 收到扫描请求回调
+// 收到扫描请求回调：缓存未过期直接发送，否则重新扫描，完成后发送
 static void on_scan_request(xn_blufi_t *blufi)
 {
-    ESP_LOGI(TAG, "BluFi requested scan");
-    // 调用WiFi管理器执行扫描
-    wifi_manager_scan(on_wifi_scan_done);
+    SCAN_LOCK();
+    if (!s_scan) {
+        SCAN_UNLOCK();
+        return;
+    }
+    int64_t age_us = esp_timer_get_time() - s_scan->scanned_us;
+    if (s_scan->scanned_us != 0 && age_us < (int64_t)CONFIG_XN_BLUFI_SCAN_CACHE_SEC * 1000000) {
+        ESP_LOGI(TAG, "BluFi requested scan, sending cached list (%d ms old)", (int)(age_us / 1000));
+        send_cached_list();
+    } else {
+        ESP_LOGI(TAG, "BluFi requested scan, cache %s", s_scan->scanning ? "pending" : "stale");
+        s_scan->requested = true;
+        start_scan();
+    }
+    SCAN_UNLOCK();
 }
 
 // 收到自定义数据回调
 static void on_recv_custom_data(xn_blufi_t *blufi, uint8_t *data, size_t len)
 {
-    ESP_LOGI(TAG, "BluFi received custom data len=%d", len);
+    if (xn_blufi_xfer_handle(blufi, data, len)) return; // 批量传输报文
+    
+    ESP_LOGI(TAG, "BluFi received custom data len=%d", (int)len);
     if (len < 1) return;
 
     uint8_t type = data[0];
@@ -150,6 +370,7 @@ static void on_request_wifi_status(xn_blufi_t *blufi)
 static void on_ble_disconnect(xn_blufi_t *blufi)
 {
     ESP_LOGI(TAG, "BluFi BLE disconnected");
+    xn_blufi_xfer_abort(); // 未完成的传输丢弃
     // 发送配网结束事件，退出配网模式
     xn_event_post(XN_EVT_BLUFI_CONFIG_DONE, XN_EVT_SRC_BLUFI);
 }
@@ -181,6 +402,7 @@ static void system_event_handler(const xn_event_t *event, void *user_data)
 
     if (event->id == XN_EVT_WIFI_GOT_IP) {
         ESP_LOGI(TAG, "WiFi Connected (Got IP), reporting to BluFi...");
+        s_provisioned = true;
         
         // 发送报告给手机：连接成功
         // 尝试获取当前实际连接的SSID
@@ -195,12 +417,14 @@ static void system_event_handler(const xn_event_t *event, void *user_data)
         // 带上真实的SSID
         xn_blufi_send_connect_report(true, ssid[0] ? ssid : NULL, 0);
         
-        // 延时一会后停止配网，给手机端一点时间接收报告
-        // 实际工程中可能需要定时器，这里简单发个事件自我停止，或者让FSM控制
-        // 这里的逻辑是：配网成功 -> Report -> Stop
-                 
-         // NEW LOGIC: 等待蓝牙断开回调 (on_ble_disconnect) 再发送 DONE 事件
-         ESP_LOGI(TAG, "Waiting for BLE disconnect to exit BluFi mode...");
+#if CONFIG_XN_BLUFI_EXIT_DELAY_MS > 0
+        // 给手机一点时间接收报告后退出配网，不等手机断开蓝牙；WiFi 连接保持，状态机接着联网
+        esp_timer_stop(s_exit_timer);
+        esp_timer_start_once(s_exit_timer, (uint64_t)CONFIG_XN_BLUFI_EXIT_DELAY_MS * 1000);
+#else
+        // 等待蓝牙断开回调 (on_ble_disconnect) 再发送 DONE 事件
+        ESP_LOGI(TAG, "Waiting for BLE disconnect to exit BluFi mode...");
+#endif
 
     } else if (event->id == XN_EVT_WIFI_DISCONNECTED) {
         // 如果正在连接中失败
@@ -231,14 +455,20 @@ esp_err_t blufi_manager_init(void)
 {
     if (s_initialized) return ESP_ERR_INVALID_STATE;
     
-    // 创建底层 BluFi 实例
-    s_blufi_instance = xn_blufi_create(BLUFI_DEVICE_NAME);
-    if (!s_blufi_instance) {
-        ESP_LOGE(TAG, "Failed to create BluFi instance");
-        return ESP_FAIL;
+    s_scan_mutex = xSemaphoreCreateMutex();
+    if (!s_scan_mutex) return ESP_ERR_NO_MEM;
+    const esp_timer_create_args_t timer_args = {
+        .callback = exit_timer_cb,
+        .name = "blufi_exit",
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &s_exit_timer);
+    if (ret != ESP_OK) {
+        vSemaphoreDelete(s_scan_mutex);
+        s_scan_mutex = NULL;
+        return ret;
     }
-
-    // 订阅事件
+    
+    // 只订阅事件；BluFi实例和蓝牙栈在进入配网时才创建，退出时全部释放
     xn_event_subscribe(XN_CMD_BLUFI_START, cmd_event_handler, NULL);
     xn_event_subscribe(XN_CMD_BLUFI_STOP, cmd_event_handler, NULL);
     xn_event_subscribe(XN_EVT_WIFI_GOT_IP, system_event_handler, NULL);
@@ -258,12 +488,13 @@ esp_err_t blufi_manager_deinit(void)
         blufi_manager_stop();
     }
     
-    xn_blufi_destroy(s_blufi_instance);
-    s_blufi_instance = NULL;
-    
     xn_event_unsubscribe_all(cmd_event_handler);
     xn_event_unsubscribe_all(system_event_handler);
     
+    esp_timer_delete(s_exit_timer);
+    s_exit_timer = NULL;
+    vSemaphoreDelete(s_scan_mutex);
+    s_scan_mutex = NULL;
     s_initialized = false;
     return ESP_OK;
 }
@@ -271,7 +502,7 @@ esp_err_t blufi_manager_deinit(void)
 // 启动管理器
 esp_err_t blufi_manager_start(void)
 {
-    if (!s_initialized || !s_blufi_instance) return ESP_ERR_INVALID_STATE;
+    if (!s_initialized) return ESP_ERR_INVALID_STATE;
     if (s_running) {
         ESP_LOGW(TAG, "BluFi already running");
         return ESP_OK;
@@ -279,14 +510,36 @@ esp_err_t blufi_manager_start(void)
     
     ESP_LOGI(TAG, "Starting BluFi...");
     
+    // 先开始后台扫描，与蓝牙栈启动、手机连接并行；手机请求列表时多半已有结果
+    scan_cache_t *scan = calloc(1, sizeof(scan_cache_t));
+    if (!scan) return ESP_ERR_NO_MEM;
+    SCAN_LOCK();
+    s_scan = scan;
+    s_running = true; // 扫描回调据此判断是否仍在配网
+    start_scan();
+    SCAN_UNLOCK();
+    
+    xn_blufi_xfer_set_sink(&s_xfer_sink);
+    
+    // 创建底层 BluFi 实例
+    s_blufi_instance = xn_blufi_create(BLUFI_DEVICE_NAME);
+    if (!s_blufi_instance) {
+        ESP_LOGE(TAG, "Failed to create BluFi instance");
+        free_scan_cache();
+        return ESP_ERR_NO_MEM;
+    }
+    
     // 初始化并启动底层组件
     esp_err_t ret = xn_blufi_init(s_blufi_instance, &s_blufi_callbacks);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to start xn_blufi: %s", esp_err_to_name(ret));
+        xn_blufi_destroy(s_blufi_instance);
+        s_blufi_instance = NULL;
+        free_scan_cache();
         return ret;
     }
     
-    s_running = true;
+    s_provisioned = false;
     // 通知系统配网准备好
     xn_event_post(XN_EVT_BLUFI_INIT_DONE, XN_EVT_SRC_BLUFI);
     
@@ -299,9 +552,20 @@ esp_err_t blufi_manager_stop(void)
     if (!s_initialized || !s_running) return ESP_ERR_INVALID_STATE;
     
     ESP_LOGI(TAG, "Stopping BluFi...");
-    // 底层deinit会停止蓝牙
+    esp_timer_stop(s_exit_timer);
+    free_scan_cache();
+    // 底层deinit会停止蓝牙并释放控制器
     xn_blufi_deinit(s_blufi_instance);
-    s_running = false;
+    xn_blufi_xfer_abort(); // Host 任务已停止，未完成的传输丢弃
+    xn_blufi_destroy(s_blufi_instance);
+    s_blufi_instance = NULL;
+    
+#if CONFIG_XN_BLUFI_RELEASE_MEM_AFTER_PROVISION
+    // 配网成功后不再需要蓝牙，内存永久交给WiFi/TLS和显示
+    if (s_provisioned && xn_blufi_release_memory() == ESP_OK) {
+        ESP_LOGI(TAG, "BT memory released after provisioning");
+    }
+#endif
     
     return ESP_OK;
 }
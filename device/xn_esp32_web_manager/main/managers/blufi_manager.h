@@ -22,7 +22,6 @@ extern "C" { // 使用C链接约定
 /**
  * @brief 初始化BluFi管理器
  * 
- * - 创建BluFi组件实例
  * - 订阅相关的命令事件 (如 CMD_BLUFI_START)
  * - 订阅系统状态事件 (如 WIFI_GOT_IP)
  * 
@@ -35,7 +34,6 @@ esp_err_t blufi_manager_init(void);
  * 
  * - 停止运行中的服务
  * - 取消事件订阅
- * - 销毁BluFi组件实例
  * 
  * @return esp_err_t 反初始化结果
  */
@@ -44,7 +42,7 @@ esp_err_t blufi_manager_deinit(void);
 /**
  * @brief 启动BluFi配网服务
  * 
- * - 初始化底层蓝牙栈
+ * - 创建BluFi组件实例并初始化底层蓝牙栈
  * - 注册回调并开启广播
  * - 通知系统配网就绪
  * 
@@ -55,8 +53,9 @@ esp_err_t blufi_manager_start(void);
 /**
  * @brief 停止BluFi配网服务
  * 
- * - 停止蓝牙广播
- * - 释放蓝牙资源
+ * - 停止蓝牙广播，关闭NimBLE和控制器
+ * - 销毁BluFi组件实例，释放蓝牙占用的内存
+ * - 开启 CONFIG_XN_BLUFI_RELEASE_MEM_AFTER_PROVISION 且本次配网成功时永久释放蓝牙内存
  * 
  * @return esp_err_t 停止结果
  */
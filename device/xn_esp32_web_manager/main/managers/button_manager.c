@@ -2,70 +2,68 @@
  * @Author: xingnian jixingnian@gmail.com
  * @Date: 2026-01-23 09:48:00
  * @LastEditors: xingnian jixingnian@gmail.com
- * @LastEditTime: 2026-01-23 09:48:43
+ * @LastEditTime: 2026-01-25 14:00:00
  * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\button_manager.c
- * @Description: 按键管理器实现 - Boot按键长按检测
+ * @Description: 按键管理器实现 - 板载按键手势转换为事件总线事件
  * VX:Jxingnian
  * Copyright (c) 2026 by xingnian, All Rights Reserved. 
  */
 
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "driver/gpio.h"
 #include "esp_log.h"
+#include "xn_button.h"
 #include "xn_event_bus.h"
 #include "button_manager.h"
 
 static const char *TAG = "button_manager";
 
-// 配置参数
-#define BUTTON_GPIO             GPIO_NUM_0      // Boot按键 GPIO
-#define BUTTON_ACTIVE_LEVEL     0               // 按下电平 (0为按下)
-#define SCAN_INTERVAL_MS        50              // 扫描周期 (ms)
-#define LONG_PRESS_TIME_MS      1000            // 长按判定时间 (ms)
-#define DEBOUNCE_TICKS          (SCAN_INTERVAL_MS / portTICK_PERIOD_MS)
+// 按键表，下标即事件数据中的 button_id
+static const xn_button_config_t s_buttons[] = {
+    {
+        .gpio = GPIO_NUM_0,             // Boot按键 GPIO
+        .active_level = 0,              // 按下电平 (0为按下)
+        .pull_up = true,                // 启用内部上拉
+        .debounce_ms = 20,              // 消抖时间 (ms)
+        .long_press_ms = 1000,          // 长按判定时间 (ms)
+        .repeat_ms = 500,               // 长按后重复间隔 (ms)
+        .double_click_ms = 300,         // 双击窗口 (ms)
+    },
+};
+
+// 驱动事件到事件总线事件的映射
+static const uint16_t s_event_map[] = {
+    [XN_BUTTON_EVT_PRESS]        = XN_EVT_BUTTON_PRESSED,
+    [XN_BUTTON_EVT_RELEASE]      = XN_EVT_BUTTON_RELEASED,
+    [XN_BUTTON_EVT_CLICK]        = XN_EVT_BUTTON_CLICK,
+    [XN_BUTTON_EVT_DOUBLE_CLICK] = XN_EVT_BUTTON_DOUBLE_CLICK,
+    [XN_BUTTON_EVT_LONG_PRESS]   = XN_EVT_BUTTON_LONG_PRESS,
+    [XN_BUTTON_EVT_HOLD_REPEAT]  = XN_EVT_BUTTON_HOLD_REPEAT,
+};
 
 // 内部状态
 static bool s_initialized = false;
 
 /**
- * @brief 按键扫描任务
+ * @brief 按键驱动回调（esp_timer 任务中执行，只投递事件）
  */
-static void button_scan_task(void *arg)
+static void button_event_cb(uint8_t id, xn_button_event_t event, uint32_t duration_ms, void *user_data)
 {
-    uint32_t press_duration = 0;
-    bool long_press_triggered = false;
-
-    while (1) {
-        // 读取按键电平
-        int level = gpio_get_level(BUTTON_GPIO);
-
-        if (level == BUTTON_ACTIVE_LEVEL) {
-            // 按键按下
-            press_duration += SCAN_INTERVAL_MS;
+    (void)user_data;
 
-            // 检查是否达到长按阈值
-            if (press_duration >= LONG_PRESS_TIME_MS && !long_press_triggered) {
-                ESP_LOGI(TAG, "Button long press detected (%d ms)", press_duration);
-                // 触发长按事件
-                xn_event_post(XN_EVT_BUTTON_LONG_PRESS, XN_EVT_SRC_BUTTON);
-                // 标记已触发，避免重复触发
-                long_press_triggered = true;
-            }
-        } else {
-            // 按键释放
-            if (press_duration > 0) {
-                // 如果需要单击事件，可以在这里判断 press_duration < LONG_PRESS_TIME_MS
-                ESP_LOGD(TAG, "Button released (held for %d ms)", press_duration);
-            }
-            // 重置计数器和标志位
-            press_duration = 0;
-            long_press_triggered = false;
-        }
+    if ((size_t)event >= sizeof(s_event_map) / sizeof(s_event_map[0])) {
+        return;
+    }
 
-        // 延时等待下一次扫描
-        vTaskDelay(pdMS_TO_TICKS(SCAN_INTERVAL_MS));
+    if (event == XN_BUTTON_EVT_LONG_PRESS) {
+        ESP_LOGI(TAG, "Button %u long press detected (%u ms)", id, (unsigned)duration_ms);
+    } else {
+        ESP_LOGD(TAG, "Button %u event %d (%u ms)", id, event, (unsigned)duration_ms);
     }
+
+    xn_evt_button_t data = {
+        .button_id = id,
+        .duration_ms = duration_ms,
+    };
+    xn_event_post_data(s_event_map[event], XN_EVT_SRC_BUTTON, &data, sizeof(data));
 }
 
 esp_err_t button_manager_init(void)
@@ -74,31 +72,15 @@ esp_err_t button_manager_init(void)
         return ESP_OK;
     }
 
-    // 配置 GPIO
-    gpio_config_t io_conf = {
-        .pin_bit_mask = (1ULL << BUTTON_GPIO),
-        .mode = GPIO_MODE_INPUT,
-        .pull_up_en = GPIO_PULLUP_ENABLE,       // 启用内部上拉
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
-    };
-    
-    esp_err_t ret = gpio_config(&io_conf);
+    esp_err_t ret = xn_button_init(s_buttons, sizeof(s_buttons) / sizeof(s_buttons[0]),
+                                   button_event_cb, NULL);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure GPIO");
+        ESP_LOGE(TAG, "Failed to init button driver: %s", esp_err_to_name(ret));
         return ret;
     }
 
-    // 创建扫描任务
-    // 堆栈大小 2048 字节，优先级 10 (由系统具体情况调整)
-    BaseType_t task_ret = xTaskCreate(button_scan_task, "btn_scan", 2048, NULL, 10, NULL);
-    if (task_ret != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create scan task");
-        return ESP_FAIL;
-    }
-
     s_initialized = true;
-    ESP_LOGI(TAG, "Button manager initialized (GPIO %d)", BUTTON_GPIO);
+    ESP_LOGI(TAG, "Button manager initialized (GPIO %d)", s_buttons[0].gpio);
     
     return ESP_OK;
 }
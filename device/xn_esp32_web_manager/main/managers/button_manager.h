@@ -21,8 +21,9 @@ extern "C" {
 /**
  * @brief 初始化按键管理器
  * 
- * - 配置 GPIO 0 (BOOT键) 为输入模式
- * - 创建按键扫描任务
+ * - 通过 xn_button 驱动配置 GPIO 0 (BOOT键)，中断触发，无扫描任务
+ * - 按下/松开/单击/双击/长按/长按重复分别投递 XN_EVT_BUTTON_* 事件，
+ *   事件数据为 xn_evt_button_t
  * 
  * @return esp_err_t 初始化结果
  */
@@ -0,0 +1,280 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-28 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-28 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\crash_manager.c
+ * @Description: 崩溃上报管理器实现 - 就绪后上报崩溃报告与 coredump 分片
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "crash_manager.h"
+
+#if CONFIG_XN_CRASH_REPORT_ENABLE
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_app_desc.h"
+#include "esp_system.h"
+#include "xn_crash.h"
+#include "xn_event_bus.h"
+#include "mqtt_manager.h"
+#endif
+
+static const char *TAG = "crash_manager";
+
+#if CONFIG_XN_CRASH_REPORT_ENABLE
+
+#define CRASH_MANAGER_TASK_STACK    3072    // 上报任务栈（JSON 与分片缓冲在堆上）
+#define CRASH_MANAGER_TASK_PRIO     1       // 上报任务优先级（只比空闲任务高）
+#define CRASH_MANAGER_JSON_MAX      1536    // 崩溃报告 JSON 最大长度
+#define CRASH_MANAGER_HISTORY_MAX   32      // 报告中最多携带的复位前事件数
+#define CRASH_MANAGER_POLL_MS       50      // 等待确认的轮询间隔
+
+static TaskHandle_t s_task;
+static char s_report_topic[128];
+static char s_dump_topic[128];
+static esp_reset_reason_t s_reason;
+static bool s_report_pending;           // 崩溃报告尚未送达
+static size_t s_dump_size;              // 待上传的 coredump 字节数，0 表示没有
+
+/**
+ * @brief 追加格式化内容到 JSON 缓冲区
+ * @return bool 缓冲区不足时返回 false
+ */
+static bool json_append(char *buf, size_t len, size_t *off, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int w = vsnprintf(buf + *off, len - *off, fmt, args);
+    va_end(args);
+    if (w < 0 || (size_t)w >= len - *off) {
+        return false;
+    }
+    *off += (size_t)w;
+    return true;
+}
+
+/**
+ * @brief 生成崩溃报告 JSON
+ * @return int 长度，缓冲区不足时返回 -1
+ */
+static int build_report(char *buf, size_t len)
+{
+    size_t off = 0;
+    bool ok = json_append(buf, len, &off, "{\"reason\":\"%s\",\"rst\":%d,\"fw\":\"%s\",\"dump\":%u",
+                          xn_crash_reset_reason_name(s_reason), (int)s_reason,
+                          esp_app_get_description()->version, (unsigned)s_dump_size);
+
+    xn_crash_summary_t summary;
+    if (ok && s_dump_size > 0 && xn_crash_get_summary(&summary) == ESP_OK) {
+        ok = json_append(buf, len, &off, ",\"task\":\"%s\",\"pc\":\"0x%08x\",\"cause\":%u,\"vaddr\":\"0x%08x\",\"bt_corrupt\":%s,\"bt\":[",
+                         summary.task, (unsigned)summary.pc, (unsigned)summary.cause,
+                         (unsigned)summary.vaddr, summary.corrupted ? "true" : "false");
+        for (uint8_t i = 0; ok && i < summary.depth; i++) {
+            ok = json_append(buf, len, &off, "%s\"0x%08x\"", (i > 0) ? "," : "", (unsigned)summary.backtrace[i]);
+        }
+        ok = ok && json_append(buf, len, &off, "]");
+    }
+
+    // 复位前最后分发的事件，[事件ID, 事件源, 时间戳ms]，从旧到新
+    xn_event_history_entry_t history[CRASH_MANAGER_HISTORY_MAX];
+    size_t count = 0;
+    if (ok && xn_event_history_get_previous(history, CRASH_MANAGER_HISTORY_MAX, &count) == ESP_OK) {
+        ok = json_append(buf, len, &off, ",\"events\":[");
+        for (size_t i = 0; ok && i < count; i++) {
+            ok = json_append(buf, len, &off, "%s[%u,%u,%u]", (i > 0) ? "," : "",
+                             history[i].event_id, history[i].source, (unsigned)history[i].timestamp);
+        }
+        ok = ok && json_append(buf, len, &off, "]");
+    }
+
+    ok = ok && json_append(buf, len, &off, "}");
+    return ok ? (int)off : -1;
+}
+
+/**
+ * @brief 等待已发布的消息全部确认
+ * @return bool 超时或断线返回 false
+ */
+static bool wait_drained(void)
+{
+    TickType_t start = xTaskGetTickCount();
+    const TickType_t timeout = pdMS_TO_TICKS(CONFIG_XN_CRASH_ACK_TIMEOUT_SEC * 1000);
+
+    while (!mqtt_manager_is_drained()) {
+        if (!mqtt_manager_is_connected() || xTaskGetTickCount() - start >= timeout) {
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(CRASH_MANAGER_POLL_MS));
+    }
+    return true;
+}
+
+/**
+ * @brief 发布崩溃报告并等待确认
+ */
+static esp_err_t publish_report(void)
+{
+    char *json = malloc(CRASH_MANAGER_JSON_MAX);
+    if (json == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    int len = build_report(json, CRASH_MANAGER_JSON_MAX);
+    esp_err_t ret = ESP_ERR_INVALID_SIZE;
+    if (len > 0) {
+        ret = mqtt_manager_publish(s_report_topic, json, (size_t)len, 1);
+    } else {
+        ESP_LOGW(TAG, "Crash report JSON too large");
+    }
+    free(json);
+
+    if (ret == ESP_OK && !wait_drained()) {
+        ret = ESP_ERR_TIMEOUT;
+    }
+    return ret;
+}
+
+/**
+ * @brief 逐片上传 coredump，每片确认后再读下一片，全部确认后擦除
+ *
+ * 中断后下次从头重传，接收端按分片头中的 offset 覆盖写入。
+ */
+static esp_err_t upload_coredump(void)
+{
+    uint8_t *packet = malloc(XN_CRASH_PACKET_MAX);
+    if (packet == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = ESP_OK;
+    size_t offset = 0;
+    size_t sent = 0;
+    while (ret == ESP_OK && offset < s_dump_size) {
+        size_t len = 0;
+        ret = xn_crash_read_chunk(offset, packet, XN_CRASH_PACKET_MAX, &len);
+        if (ret == ESP_OK) {
+            ret = mqtt_manager_publish(s_dump_topic, packet, len, 1);
+        }
+        if (ret == ESP_OK && !wait_drained()) {
+            ret = ESP_ERR_TIMEOUT;
+        }
+        if (ret == ESP_OK) {
+            offset += ((const xn_crash_chunk_header_t *)packet)->raw_len;
+            sent += len;
+        }
+    }
+    free(packet);
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Coredump upload stopped at %u/%u: %s",
+                 (unsigned)offset, (unsigned)s_dump_size, esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Coredump uploaded: %u bytes as %u", (unsigned)s_dump_size, (unsigned)sent);
+    ret = xn_crash_erase();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Coredump erase failed: %s", esp_err_to_name(ret));
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 系统就绪事件：通知上报任务
+ */
+static void on_system_ready(const xn_event_t *event, void *user_data)
+{
+    (void)event;
+    (void)user_data;
+
+    if (s_task != NULL) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+/**
+ * @brief 上报任务：每次就绪时尝试一次，全部完成后退出
+ */
+static void crash_task(void *arg)
+{
+    (void)arg;
+
+    while (s_report_pending || s_dump_size > 0) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!mqtt_manager_is_connected()) {
+            continue;
+        }
+
+        if (s_report_pending) {
+            esp_err_t ret = publish_report();
+            if (ret != ESP_OK) {
+                ESP_LOGW(TAG, "Crash report failed: %s", esp_err_to_name(ret));
+                continue;
+            }
+            s_report_pending = false;
+        }
+        if (s_dump_size > 0 && upload_coredump() == ESP_OK) {
+            s_dump_size = 0;
+        }
+    }
+
+    s_task = NULL;
+    xn_event_unsubscribe(XN_EVT_SYSTEM_READY, on_system_ready);
+    ESP_LOGI(TAG, "Crash report done");
+    vTaskDelete(NULL);
+}
+
+#endif
+
+esp_err_t crash_manager_init(void)
+{
+#if CONFIG_XN_CRASH_REPORT_ENABLE
+    s_reason = esp_reset_reason();
+    s_report_pending = xn_crash_reset_is_abnormal(s_reason);
+#if CONFIG_XN_CRASH_UPLOAD_COREDUMP
+    (void)xn_crash_coredump_size(&s_dump_size);
+#endif
+    // coredump 可能是更早的崩溃留下的，即使本次是正常复位也补传一次报告
+    if (s_dump_size > 0) {
+        s_report_pending = true;
+    }
+    if (!s_report_pending) {
+        ESP_LOGI(TAG, "Reset reason: %s", xn_crash_reset_reason_name(s_reason));
+        return ESP_OK;
+    }
+    ESP_LOGW(TAG, "Reset reason: %s, coredump %u bytes",
+             xn_crash_reset_reason_name(s_reason), (unsigned)s_dump_size);
+
+    const char *base_topic = mqtt_manager_get_base_topic();
+    const char *client_id = mqtt_manager_get_client_id();
+    if (base_topic == NULL || base_topic[0] == '\0' || client_id == NULL) {
+        ESP_LOGW(TAG, "MQTT base topic not set, crash report disabled");
+        return ESP_OK;
+    }
+    int n = snprintf(s_report_topic, sizeof(s_report_topic), "%s/%s/crash", base_topic, client_id);
+    int m = snprintf(s_dump_topic, sizeof(s_dump_topic), "%s/%s/coredump", base_topic, client_id);
+    if (n < 0 || n >= (int)sizeof(s_report_topic) || m < 0 || m >= (int)sizeof(s_dump_topic)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    if (xTaskCreate(crash_task, "crash_report", CRASH_MANAGER_TASK_STACK, NULL,
+                    CRASH_MANAGER_TASK_PRIO, &s_task) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t ret = xn_event_subscribe(XN_EVT_SYSTEM_READY, on_system_ready, NULL);
+    if (ret != ESP_OK) {
+        vTaskDelete(s_task);
+        s_task = NULL;
+        return ret;
+    }
+#else
+    ESP_LOGI(TAG, "Crash report disabled");
+#endif
+    return ESP_OK;
+}
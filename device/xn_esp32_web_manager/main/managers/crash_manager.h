@@ -0,0 +1,42 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-28 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-28 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\crash_manager.h
+ * @Description: 崩溃上报管理器 - 异常复位后上报复位原因、coredump 摘要、崩溃前事件与压缩的 coredump
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#ifndef CRASH_MANAGER_H
+#define CRASH_MANAGER_H
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 初始化崩溃上报管理器
+ * 
+ * - 未开启 CONFIG_XN_CRASH_REPORT_ENABLE 时直接返回成功
+ * - 需在事件总线与 MQTT 管理器之后调用
+ * - 复位原因为 panic/看门狗/掉电，或 flash 中留有 coredump 时，在 MQTT 已连接后的
+ *   第一个 XN_EVT_SYSTEM_READY 开始上报，未完成时下一次 READY 继续：
+ *   - 崩溃报告 JSON 发布到 <base_topic>/<client_id>/crash（QoS1）：复位原因、固件版本、
+ *     coredump 大小与摘要（任务、PC、回溯）、复位前最后分发的事件
+ *   - coredump 按 xn_crash_chunk_header_t 分片（LZ4 压缩）发布到
+ *     <base_topic>/<client_id>/coredump（QoS1），每片收到确认后再发下一片，
+ *     全部确认后擦除 flash 中的 coredump
+ * 
+ * @return esp_err_t 初始化结果
+ */
+esp_err_t crash_manager_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CRASH_MANAGER_H */
@@ -11,10 +11,14 @@
 
 #include "display_manager.h"
 #include "xn_display.h"
+#include "xn_font.h"
+#include "xn_assets.h"
 #include "xn_event_bus.h"
 #include "xn_event_types.h"
 #include "ui.h"  // SquareLine Studio 生成的 UI 头文件
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
 
 static const char *TAG = "display_mgr";
 
@@ -22,13 +26,63 @@ static const char *TAG = "display_mgr";
  *                          内部数据结构
  *===========================================================================*/
 
+/**
+ * @brief 界面数据变更标志
+ */
+enum {
+    UI_DIRTY_PAGE  = 1 << 0,            ///< 页面切换
+    UI_DIRTY_HOME  = 1 << 1,            ///< 主页面数据
+    UI_DIRTY_WIFI  = 1 << 2,            ///< WiFi 页面数据
+    UI_DIRTY_OTA   = 1 << 3,            ///< OTA 进度
+    UI_DIRTY_TOAST = 1 << 4,            ///< 新的 Toast
+    UI_DIRTY_ERROR = 1 << 5,            ///< 新的错误消息
+};
+
+/**
+ * @brief 界面视图模型
+ * 
+ * 生产者（任意任务）只写模型并置变更标志，LVGL 任务每帧开始时取走一份快照，
+ * 与上次已显示的数据比较后只更新变化的部分。同一帧内多次更新只保留最新值，
+ * Toast 和错误消息同样只显示最新一条。
+ */
+typedef struct {
+    uint32_t dirty;                     ///< 变更标志 UI_DIRTY_*
+    ui_page_t page;                     ///< 目标页面
+    struct {
+        app_state_t state;              ///< 系统状态
+        char ssid[33];                  ///< WiFi SSID
+        int8_t rssi;                    ///< 信号强度
+        uint32_t ip_addr;               ///< IP 地址
+        bool mqtt_connected;            ///< MQTT 连接状态
+    } home;
+    struct {
+        char ssid[33];                  ///< WiFi SSID
+        int8_t rssi;                    ///< 信号强度
+        char status[32];                ///< 状态文本
+    } wifi;
+    struct {
+        uint8_t progress;               ///< 进度百分比
+        char status[32];                ///< 状态文本
+    } ota;
+    char toast[64];                     ///< Toast 文本
+    uint32_t toast_ms;                  ///< Toast 显示时长
+    char error[96];                     ///< 错误消息
+} ui_model_t;
+
 typedef struct {
     bool initialized;                   ///< 初始化标志
-    ui_page_t current_page;             ///< 当前页面
+    bool model_ready;                   ///< 视图模型可写（订阅事件后即可写入，早于屏幕就绪）
+    ui_page_t current_page;             ///< 当前页面（LVGL 任务维护）
     xn_event_handler_t event_handler;   ///< 事件处理函数
+    portMUX_TYPE model_lock;            ///< 模型自旋锁，只保护拷贝，不涉及 LVGL
+    ui_model_t model;                   ///< 待应用的数据（生产者写）
+    ui_model_t frame;                   ///< 本帧快照（LVGL 任务独占）
+    ui_model_t shown;                   ///< 已显示的数据（LVGL 任务独占）
 } display_manager_ctx_t;
 
-static display_manager_ctx_t s_ctx = {0};
+static display_manager_ctx_t s_ctx = {
+    .model_lock = portMUX_INITIALIZER_UNLOCKED,
+};
 
 /*===========================================================================
  *                          内部函数声明
@@ -38,6 +92,15 @@ static void on_event_received(const xn_event_t *event, void *user_data);
 static void handle_wifi_event(uint16_t event_id, void *event_data);
 static void handle_mqtt_event(uint16_t event_id, void *event_data);
 static void handle_system_event(uint16_t event_id, void *event_data);
+static void handle_cmd_event(uint16_t event_id, void *event_data);
+static void ui_model_commit(uint32_t dirty);
+static void ui_apply_frame(void *user_data);
+static void ui_apply_page(ui_page_t page);
+static void ui_apply_home(void);
+static void ui_apply_wifi(void);
+static void ui_apply_ota(void);
+static void ui_apply_toast(const char *msg, uint32_t duration_ms);
+static void ui_apply_error(const char *error_msg);
 
 /*===========================================================================
  *                          API 实现
@@ -52,7 +115,15 @@ esp_err_t display_manager_init(void)
     
     ESP_LOGI(TAG, "Initializing display manager...");
     
-    // 1. 初始化 xn_display 组件
+    // 1. 先订阅事件总线：屏幕初始化期间 WiFi 等模块已在并行启动，状态变化先记入视图模型，
+    //    屏幕就绪后第一帧统一显示（回调只写视图模型、不持 LVGL 锁，可直接在分发任务中执行）
+    s_ctx.model_ready = true;
+    esp_err_t ret = xn_event_subscribe(XN_EVT_ANY, on_event_received, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to subscribe to events: %s", esp_err_to_name(ret));
+    }
+    
+    // 2. 初始化 xn_display 组件
     xn_display_config_t config = xn_display_get_default_config();
     
     // 根据你的硬件配置
@@ -76,24 +147,46 @@ esp_err_t display_manager_init(void)
     config.offset_x = 0;
     config.offset_y = 0;
     config.backlight_output_invert = false;
+    // 本板未启用 PSRAM，使用内部 RAM 分块渲染；有 PSRAM 的产品可改为直接模式
+    config.render_mode = XN_DISPLAY_RENDER_PARTIAL;
+    config.buffer_mem = XN_DISPLAY_BUF_INTERNAL;
     
-    esp_err_t ret = xn_display_init(&config);
+    ret = xn_display_init(&config);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize display: %s", esp_err_to_name(ret));
+        xn_event_unsubscribe(XN_EVT_ANY, on_event_received);
+        s_ctx.model_ready = false;
         return ret;
     }
     
-    // 2. 初始化 UI 系统
+    // 3. 加载分区图片，需在构建界面前完成，页面通过 xn_assets_get() 取图片；
+    //    失败时对应的图片对象不显示，不影响其他界面元素
+    xn_assets_config_t assets_config = xn_assets_get_default_config();
+    ret = xn_assets_init(&assets_config);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Assets partition not loaded, UI images unavailable: %s", esp_err_to_name(ret));
+    }
+    
+    // 4. 初始化 UI 系统
     ESP_LOGI(TAG, "Initializing UI...");
     ui_init();  // SquareLine Studio 生成的初始化函数（返回 void）
     
-    // 3. 订阅事件总线
-    ret = xn_event_subscribe(XN_EVT_ANY, on_event_received, NULL);
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to subscribe to events: %s", esp_err_to_name(ret));
+    // 5. 加载分区中文字体，失败时保持 LVGL 默认字体（只能显示 ASCII）
+    xn_font_config_t font_config = xn_font_get_default_config();
+    font_config.fallback = LV_FONT_DEFAULT;
+    ret = xn_font_init(&font_config);
+    if (ret == ESP_OK && xn_display_lock(1000)) {
+        // 设置在屏幕上，未单独指定字体的子对象继承
+        lv_obj_set_style_text_font(lv_screen_active(), xn_font_get(), 0);
+        xn_display_unlock();
+    } else if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Font partition not loaded, CJK text unavailable: %s", esp_err_to_name(ret));
     }
     
-    // 4. 显示主页面（如果有）
+    // 6. 界面数据由 LVGL 任务每帧统一应用，其他任务只写视图模型
+    xn_display_set_frame_cb(ui_apply_frame, NULL);
+    
+    // 7. 显示主页面（如果有）
     // 注意：SquareLine Studio 会自动加载第一个屏幕
     s_ctx.current_page = UI_PAGE_HOME;
     
@@ -115,10 +208,16 @@ esp_err_t display_manager_deinit(void)
     // 取消订阅事件
     xn_event_unsubscribe(XN_EVT_ANY, on_event_received);
     
+    // 停止应用视图模型
+    xn_display_set_frame_cb(NULL, NULL);
+    
     // 反初始化显示
     xn_display_deinit();
+    xn_font_deinit();
+    xn_assets_deinit();
     
     s_ctx.initialized = false;
+    s_ctx.model_ready = false;
     
     ESP_LOGI(TAG, "Display manager deinitialized");
     
@@ -127,7 +226,7 @@ esp_err_t display_manager_deinit(void)
 
 esp_err_t display_manager_show_page(ui_page_t page)
 {
-    if (!s_ctx.initialized) {
+    if (!s_ctx.model_ready) {
         return ESP_ERR_INVALID_STATE;
     }
     
@@ -137,43 +236,10 @@ esp_err_t display_manager_show_page(ui_page_t page)
     
     ESP_LOGI(TAG, "Switching to page: %d", page);
     
-    // 锁定 LVGL
-    if (!xn_display_lock(1000)) {
-        ESP_LOGE(TAG, "Failed to lock display");
-        return ESP_ERR_TIMEOUT;
-    }
-    
-    // 切换页面
-    // 注意：这里需要根据你的 SquareLine Studio 设计来实现
-    // 例如：lv_screen_load(ui_Screen1);
-    switch (page) {
-        case UI_PAGE_HOME:
-            // 加载主屏幕（根据你的 SquareLine 设计）
-            // lv_screen_load(ui_Screen1);
-            break;
-        case UI_PAGE_WIFI:
-            // lv_screen_load(ui_ScreenWiFi);
-            break;
-        case UI_PAGE_STATUS:
-            // lv_screen_load(ui_ScreenStatus);
-            break;
-        case UI_PAGE_SETTINGS:
-            // lv_screen_load(ui_ScreenSettings);
-            break;
-        case UI_PAGE_OTA:
-            // lv_screen_load(ui_ScreenOTA);
-            break;
-        case UI_PAGE_ERROR:
-            // 错误页面通过 display_manager_show_error() 显示
-            break;
-        default:
-            break;
-    }
-    
-    s_ctx.current_page = page;
-    
-    // 解锁 LVGL
-    xn_display_unlock();
+    taskENTER_CRITICAL(&s_ctx.model_lock);
+    s_ctx.model.page = page;
+    taskEXIT_CRITICAL(&s_ctx.model_lock);
+    ui_model_commit(UI_DIRTY_PAGE);
     
     return ESP_OK;
 }
@@ -185,23 +251,18 @@ esp_err_t display_manager_update_home(
     uint32_t ip_addr,
     bool mqtt_connected)
 {
-    if (!s_ctx.initialized) {
+    if (!s_ctx.model_ready) {
         return ESP_ERR_INVALID_STATE;
     }
     
-    // 锁定 LVGL
-    if (!xn_display_lock(1000)) {
-        return ESP_ERR_TIMEOUT;
-    }
-    
-    // 更新主页面数据
-    // 注意：这里需要根据你的 SquareLine Studio 设计来实现
-    // 例如：更新标签文本
-    // lv_label_set_text(ui_LabelWiFi, wifi_ssid);
-    // lv_label_set_text_fmt(ui_LabelIP, "%d.%d.%d.%d", ...);
-    
-    // 解锁 LVGL
-    xn_display_unlock();
+    taskENTER_CRITICAL(&s_ctx.model_lock);
+    s_ctx.model.home.state = state;
+    strlcpy(s_ctx.model.home.ssid, wifi_ssid ? wifi_ssid : "", sizeof(s_ctx.model.home.ssid));
+    s_ctx.model.home.rssi = wifi_rssi;
+    s_ctx.model.home.ip_addr = ip_addr;
+    s_ctx.model.home.mqtt_connected = mqtt_connected;
+    taskEXIT_CRITICAL(&s_ctx.model_lock);
+    ui_model_commit(UI_DIRTY_HOME);
     
     return ESP_OK;
 }
@@ -211,20 +272,31 @@ esp_err_t display_manager_update_wifi(
     int8_t rssi,
     const char *status)
 {
-    if (!s_ctx.initialized) {
+    if (!s_ctx.model_ready) {
         return ESP_ERR_INVALID_STATE;
     }
     
-    // 锁定 LVGL
-    if (!xn_display_lock(1000)) {
-        return ESP_ERR_TIMEOUT;
-    }
+    taskENTER_CRITICAL(&s_ctx.model_lock);
+    strlcpy(s_ctx.model.wifi.ssid, ssid ? ssid : "", sizeof(s_ctx.model.wifi.ssid));
+    s_ctx.model.wifi.rssi = rssi;
+    strlcpy(s_ctx.model.wifi.status, status ? status : "", sizeof(s_ctx.model.wifi.status));
+    taskEXIT_CRITICAL(&s_ctx.model_lock);
+    ui_model_commit(UI_DIRTY_WIFI);
     
-    // 更新 WiFi 页面数据
-    // 根据你的 SquareLine Studio 设计实现
+    return ESP_OK;
+}
+
+esp_err_t display_manager_update_rssi(int8_t rssi)
+{
+    if (!s_ctx.model_ready) {
+        return ESP_ERR_INVALID_STATE;
+    }
     
-    // 解锁 LVGL
-    xn_display_unlock();
+    taskENTER_CRITICAL(&s_ctx.model_lock);
+    s_ctx.model.home.rssi = rssi;
+    s_ctx.model.wifi.rssi = rssi;
+    taskEXIT_CRITICAL(&s_ctx.model_lock);
+    ui_model_commit(UI_DIRTY_HOME | UI_DIRTY_WIFI);
     
     return ESP_OK;
 }
@@ -233,75 +305,54 @@ esp_err_t display_manager_update_ota(
     uint8_t progress,
     const char *status)
 {
-    if (!s_ctx.initialized) {
+    if (!s_ctx.model_ready) {
         return ESP_ERR_INVALID_STATE;
     }
     
-    // 锁定 LVGL
-    if (!xn_display_lock(1000)) {
-        return ESP_ERR_TIMEOUT;
-    }
-    
-    // 更新 OTA 页面数据
-    // 根据你的 SquareLine Studio 设计实现
-    
-    // 解锁 LVGL
-    xn_display_unlock();
+    taskENTER_CRITICAL(&s_ctx.model_lock);
+    s_ctx.model.ota.progress = progress;
+    strlcpy(s_ctx.model.ota.status, status ? status : "", sizeof(s_ctx.model.ota.status));
+    taskEXIT_CRITICAL(&s_ctx.model_lock);
+    ui_model_commit(UI_DIRTY_OTA);
     
     return ESP_OK;
 }
 
 esp_err_t display_manager_show_error(const char *error_msg)
 {
-    if (!s_ctx.initialized) {
+    if (!s_ctx.model_ready) {
         return ESP_ERR_INVALID_STATE;
     }
     
-    ESP_LOGE(TAG, "Showing error: %s", error_msg);
-    
-    // 锁定 LVGL
-    if (!xn_display_lock(1000)) {
-        return ESP_ERR_TIMEOUT;
+    if (error_msg == NULL) {
+        return ESP_ERR_INVALID_ARG;
     }
     
-    // 显示错误消息（LVGL 9.x API）
-    lv_obj_t *mbox = lv_msgbox_create(NULL);
-    lv_msgbox_add_title(mbox, "错误");
-    lv_msgbox_add_text(mbox, error_msg);
-    lv_msgbox_add_close_button(mbox);
-    lv_obj_center(mbox);
+    ESP_LOGE(TAG, "Showing error: %s", error_msg);
     
-    // 解锁 LVGL
-    xn_display_unlock();
+    taskENTER_CRITICAL(&s_ctx.model_lock);
+    strlcpy(s_ctx.model.error, error_msg, sizeof(s_ctx.model.error));
+    taskEXIT_CRITICAL(&s_ctx.model_lock);
+    ui_model_commit(UI_DIRTY_ERROR);
     
     return ESP_OK;
 }
 
 esp_err_t display_manager_show_toast(const char *msg, uint32_t duration_ms)
 {
-    if (!s_ctx.initialized) {
+    if (!s_ctx.model_ready) {
         return ESP_ERR_INVALID_STATE;
     }
     
-    // 锁定 LVGL
-    if (!xn_display_lock(1000)) {
-        return ESP_ERR_TIMEOUT;
+    if (msg == NULL) {
+        return ESP_ERR_INVALID_ARG;
     }
     
-    // 创建 Toast 消息（简化实现）
-    lv_obj_t *toast = lv_label_create(lv_scr_act());
-    lv_label_set_text(toast, msg);
-    lv_obj_align(toast, LV_ALIGN_TOP_MID, 0, 10);
-    lv_obj_set_style_bg_color(toast, lv_color_hex(0x000000), 0);
-    lv_obj_set_style_bg_opa(toast, LV_OPA_80, 0);
-    lv_obj_set_style_text_color(toast, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_style_pad_all(toast, 10, 0);
-    
-    // 设置自动删除（需要使用定时器）
-    // 这里简化处理，实际应该使用 lv_anim 或定时器
-    
-    // 解锁 LVGL
-    xn_display_unlock();
+    taskENTER_CRITICAL(&s_ctx.model_lock);
+    strlcpy(s_ctx.model.toast, msg, sizeof(s_ctx.model.toast));
+    s_ctx.model.toast_ms = duration_ms;
+    taskEXIT_CRITICAL(&s_ctx.model_lock);
+    ui_model_commit(UI_DIRTY_TOAST);
     
     return ESP_OK;
 }
@@ -334,6 +385,8 @@ static void on_event_received(const xn_event_t *event, void *user_data)
         handle_mqtt_event(event_id, event_data);
     } else if (event_id < XN_EVT_CAT_WIFI) {
         handle_system_event(event_id, event_data);
+    } else if (event_id >= XN_EVT_CAT_CMD && event_id < XN_EVT_CAT_USER) {
+        handle_cmd_event(event_id, event_data);
     }
 }
 
@@ -355,6 +408,19 @@ static void handle_wifi_event(uint16_t event_id, void *event_data)
             display_manager_update_wifi("", 0, "未连接");
             break;
         
+        case XN_EVT_WIFI_LINK_QUALITY: {
+            xn_evt_wifi_link_t *data = (xn_evt_wifi_link_t *)event_data;
+            display_manager_update_rssi(data->rssi_avg);
+            break;
+        }
+        
+        case XN_EVT_WIFI_ROAMING: {
+            xn_evt_wifi_connected_t *data = (xn_evt_wifi_connected_t *)event_data;
+            ESP_LOGI(TAG, "WiFi roaming to %s", data->ssid);
+            display_manager_update_wifi((char *)data->ssid, data->rssi, "切换中");
+            break;
+        }
+        
         case XN_EVT_WIFI_GOT_IP: {
             xn_evt_wifi_got_ip_t *data = (xn_evt_wifi_got_ip_t *)event_data;
             ESP_LOGI(TAG, "Got IP: %d.%d.%d.%d", 
@@ -416,3 +482,182 @@ static void handle_system_event(uint16_t event_id, void *event_data)
             break;
     }
 }
+
+/**
+ * @brief 处理显示控制命令（背光与面板开关不经过 LVGL，直接在分发任务中执行）
+ */
+static void handle_cmd_event(uint16_t event_id, void *event_data)
+{
+    switch (event_id) {
+        case XN_CMD_DISPLAY_SLEEP:
+            xn_display_sleep(true);
+            break;
+        
+        case XN_CMD_DISPLAY_WAKEUP:
+            xn_display_sleep(false);
+            break;
+        
+        case XN_CMD_DISPLAY_BRIGHTNESS: {
+            xn_cmd_display_brightness_t *data = (xn_cmd_display_brightness_t *)event_data;
+            if (data) {
+                ESP_LOGI(TAG, "Set brightness %u", data->brightness);
+                display_manager_set_brightness(data->brightness);
+            }
+            break;
+        }
+        
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief 置变更标志并唤醒 LVGL 任务
+ */
+static void ui_model_commit(uint32_t dirty)
+{
+    taskENTER_CRITICAL(&s_ctx.model_lock);
+    s_ctx.model.dirty |= dirty;
+    taskEXIT_CRITICAL(&s_ctx.model_lock);
+    xn_display_wakeup();
+}
+
+/**
+ * @brief 帧前回调：取走模型快照，只更新变化的部分（LVGL 任务中执行，已持锁）
+ */
+static void ui_apply_frame(void *user_data)
+{
+    (void)user_data;
+    
+    // 没有更新时不进临界区
+    if (s_ctx.model.dirty == 0) {
+        return;
+    }
+    
+    taskENTER_CRITICAL(&s_ctx.model_lock);
+    s_ctx.frame = s_ctx.model;
+    s_ctx.model.dirty = 0;
+    taskEXIT_CRITICAL(&s_ctx.model_lock);
+    
+    uint32_t dirty = s_ctx.frame.dirty;
+    
+    if ((dirty & UI_DIRTY_PAGE) && s_ctx.frame.page != s_ctx.current_page) {
+        ui_apply_page(s_ctx.frame.page);
+    }
+    if ((dirty & UI_DIRTY_HOME) &&
+        memcmp(&s_ctx.frame.home, &s_ctx.shown.home, sizeof(s_ctx.frame.home)) != 0) {
+        s_ctx.shown.home = s_ctx.frame.home;
+        ui_apply_home();
+    }
+    if ((dirty & UI_DIRTY_WIFI) &&
+        memcmp(&s_ctx.frame.wifi, &s_ctx.shown.wifi, sizeof(s_ctx.frame.wifi)) != 0) {
+        s_ctx.shown.wifi = s_ctx.frame.wifi;
+        ui_apply_wifi();
+    }
+    if ((dirty & UI_DIRTY_OTA) &&
+        memcmp(&s_ctx.frame.ota, &s_ctx.shown.ota, sizeof(s_ctx.frame.ota)) != 0) {
+        s_ctx.shown.ota = s_ctx.frame.ota;
+        ui_apply_ota();
+    }
+    // Toast 和错误消息是一次性通知，即使内容相同也要再显示
+    if (dirty & UI_DIRTY_TOAST) {
+        ui_apply_toast(s_ctx.frame.toast, s_ctx.frame.toast_ms);
+    }
+    if (dirty & UI_DIRTY_ERROR) {
+        ui_apply_error(s_ctx.frame.error);
+    }
+}
+
+/**
+ * @brief 切换页面
+ */
+static void ui_apply_page(ui_page_t page)
+{
+    // 注意：这里需要根据你的 SquareLine Studio 设计来实现
+    // 例如：lv_screen_load(ui_Screen1);
+    switch (page) {
+        case UI_PAGE_HOME:
+            // 加载主屏幕（根据你的 SquareLine 设计）
+            // lv_screen_load(ui_Screen1);
+            break;
+        case UI_PAGE_WIFI:
+            // lv_screen_load(ui_ScreenWiFi);
+            break;
+        case UI_PAGE_STATUS:
+            // lv_screen_load(ui_ScreenStatus);
+            break;
+        case UI_PAGE_SETTINGS:
+            // lv_screen_load(ui_ScreenSettings);
+            break;
+        case UI_PAGE_OTA:
+            // lv_screen_load(ui_ScreenOTA);
+            break;
+        case UI_PAGE_ERROR:
+            // 错误页面通过 display_manager_show_error() 显示
+            break;
+        default:
+            break;
+    }
+    
+    s_ctx.current_page = page;
+}
+
+/**
+ * @brief 更新主页面（数据在 s_ctx.shown.home）
+ */
+static void ui_apply_home(void)
+{
+    // 更新主页面数据
+    // 注意：这里需要根据你的 SquareLine Studio 设计来实现
+    // 例如：更新标签文本
+    // lv_label_set_text(ui_LabelWiFi, s_ctx.shown.home.ssid);
+    // lv_label_set_text_fmt(ui_LabelIP, "%d.%d.%d.%d", ...);
+}
+
+/**
+ * @brief 更新 WiFi 页面（数据在 s_ctx.shown.wifi）
+ */
+static void ui_apply_wifi(void)
+{
+    // 更新 WiFi 页面数据
+    // 根据你的 SquareLine Studio 设计实现
+}
+
+/**
+ * @brief 更新 OTA 页面（数据在 s_ctx.shown.ota）
+ */
+static void ui_apply_ota(void)
+{
+    // 更新 OTA 页面数据
+    // 根据你的 SquareLine Studio 设计实现
+}
+
+/**
+ * @brief 显示 Toast，到时自动删除
+ */
+static void ui_apply_toast(const char *msg, uint32_t duration_ms)
+{
+    lv_obj_t *toast = lv_label_create(lv_screen_active());
+    lv_label_set_text(toast, msg);
+    lv_obj_align(toast, LV_ALIGN_TOP_MID, 0, 10);
+    lv_obj_set_style_bg_color(toast, lv_color_hex(0x000000), 0);
+    lv_obj_set_style_bg_opa(toast, LV_OPA_80, 0);
+    lv_obj_set_style_text_color(toast, lv_color_hex(0xFFFFFF), 0);
+    lv_obj_set_style_pad_all(toast, 10, 0);
+    
+    if (duration_ms > 0) {
+        lv_obj_delete_delayed(toast, duration_ms);
+    }
+}
+
+/**
+ * @brief 显示错误消息框（LVGL 9.x API）
+ */
+static void ui_apply_error(const char *error_msg)
+{
+    lv_obj_t *mbox = lv_msgbox_create(NULL);
+    lv_msgbox_add_title(mbox, "错误");
+    lv_msgbox_add_text(mbox, error_msg);
+    lv_msgbox_add_close_button(mbox);
+    lv_obj_center(mbox);
+}
@@ -40,6 +40,12 @@ typedef enum {
  *                          API
  *===========================================================================*/
 
+/*
+ * 页面切换、数据更新、Toast 和错误提示都只写入视图模型并唤醒 LVGL 任务，
+ * 不获取 LVGL 锁，可在任意任务（包括事件分发任务）中调用且不会阻塞；
+ * 实际界面在下一帧由 LVGL 任务统一更新，同一帧内的多次更新只保留最新值。
+ */
+
 /**
  * @brief 初始化显示管理器
  * 
@@ -74,7 +80,8 @@ esp_err_t display_manager_deinit(void);
  * 
  * @param page 目标页面
  * @return esp_err_t 
- *         - ESP_OK: 切换成功
+ *         - ESP_OK: 已提交，下一帧切换
+ *         - ESP_ERR_INVALID_STATE: 未初始化
  *         - ESP_ERR_INVALID_ARG: 页面参数无效
  */
 esp_err_t display_manager_show_page(ui_page_t page);
@@ -90,8 +97,8 @@ esp_err_t display_manager_show_page(ui_page_t page);
  * @param ip_addr IP 地址（网络字节序）
  * @param mqtt_connected MQTT 连接状态
  * @return esp_err_t 
- *         - ESP_OK: 更新成功
- *         - 其他: 更新失败
+ *         - ESP_OK: 已提交，下一帧更新
+ *         - ESP_ERR_INVALID_STATE: 未初始化
  */
 esp_err_t display_manager_update_home(
     app_state_t state,
@@ -108,8 +115,8 @@ esp_err_t display_manager_update_home(
  * @param rssi 信号强度（dBm）
  * @param status 连接状态文本
  * @return esp_err_t 
- *         - ESP_OK: 更新成功
- *         - 其他: 更新失败
+ *         - ESP_OK: 已提交，下一帧更新
+ *         - ESP_ERR_INVALID_STATE: 未初始化
  */
 esp_err_t display_manager_update_wifi(
     const char *ssid,
@@ -117,14 +124,24 @@ esp_err_t display_manager_update_wifi(
     const char *status
 );
 
+/**
+ * @brief 只更新信号强度（主页面与 WiFi 页面），用于周期性的链路质量采样
+ * 
+ * @param rssi 信号强度（dBm）
+ * @return esp_err_t 
+ *         - ESP_OK: 已提交，下一帧更新
+ *         - ESP_ERR_INVALID_STATE: 未初始化
+ */
+esp_err_t display_manager_update_rssi(int8_t rssi);
+
 /**
  * @brief 更新 OTA 页面进度
  * 
  * @param progress 进度百分比 (0-100)
  * @param status 状态文本
  * @return esp_err_t 
- *         - ESP_OK: 更新成功
- *         - 其他: 更新失败
+ *         - ESP_OK: 已提交，下一帧更新
+ *         - ESP_ERR_INVALID_STATE: 未初始化
  */
 esp_err_t display_manager_update_ota(
     uint8_t progress,
@@ -138,21 +155,23 @@ esp_err_t display_manager_update_ota(
  * 
  * @param error_msg 错误消息
  * @return esp_err_t 
- *         - ESP_OK: 显示成功
- *         - 其他: 显示失败
+ *         - ESP_OK: 已提交，下一帧显示
+ *         - ESP_ERR_INVALID_STATE: 未初始化
+ *         - ESP_ERR_INVALID_ARG: 消息为 NULL
  */
 esp_err_t display_manager_show_error(const char *error_msg);
 
 /**
  * @brief 显示通知消息（Toast）
  * 
- * 在当前页面上方显示一个临时通知消息
+ * 在当前页面上方显示一个临时通知消息，到时自动消失
  * 
  * @param msg 消息内容
  * @param duration_ms 显示时长（毫秒）
  * @return esp_err_t 
- *         - ESP_OK: 显示成功
- *         - 其他: 显示失败
+ *         - ESP_OK: 已提交，下一帧显示
+ *         - ESP_ERR_INVALID_STATE: 未初始化
+ *         - ESP_ERR_INVALID_ARG: 消息为 NULL
  */
 esp_err_t display_manager_show_toast(const char *msg, uint32_t duration_ms);
 
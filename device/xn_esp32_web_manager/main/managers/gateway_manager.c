@@ -0,0 +1,242 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-29 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-29 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\gateway_manager.c
+ * @Description: 网关管理器实现 - 子设备状态/心跳上行转发、控制命令下行转发
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "gateway_manager.h"
+
+#if CONFIG_XN_GATEWAY_ENABLE
+#include "esp_wifi.h"
+#include "xn_gateway.h"
+#include "xn_sched.h"
+#include "xn_event_bus.h"
+#include "mqtt_manager.h"
+#endif
+
+static const char *TAG = "gateway_manager";
+
+#if CONFIG_XN_GATEWAY_ENABLE
+
+#define GATEWAY_MANAGER_RETRY_MS    5000                // 启动失败后的重试间隔
+#define GATEWAY_CONTROL_FILTER      "device/+/control"  // 子设备控制主题（与服务端约定，不带 base_topic）
+#define GATEWAY_HB_BUF_SIZE         (CONFIG_XN_GATEWAY_MAX_DEVICES * 96 + 64)
+
+static xn_sched_job_t s_start_job;      // 启动作业（获取IP后执行）
+static xn_sched_job_t s_rx_job;         // 收包处理作业（收包通知时立即执行）
+static xn_sched_job_t s_hb_job;         // 汇总心跳作业（周期执行）
+static bool s_started;                  // xn_gateway 已启动
+static char s_hb_topic[128];            // 汇总心跳主题
+static char *s_hb_buf;                  // 汇总心跳缓冲
+static uint8_t s_key[XN_GATEWAY_KEY_LEN]; // 主密钥（CONFIG_XN_GATEWAY_KEY）
+
+/**
+ * @brief 解析十六进制密钥，长度必须恰好为 XN_GATEWAY_KEY_LEN 字节
+ */
+static bool gateway_parse_key(const char *hex, uint8_t *key)
+{
+    if (strlen(hex) != XN_GATEWAY_KEY_LEN * 2) {
+        return false;
+    }
+    for (size_t i = 0; i < XN_GATEWAY_KEY_LEN * 2; i++) {
+        char c = hex[i];
+        uint8_t v;
+        if (c >= '0' && c <= '9') {
+            v = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            v = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            v = c - 'A' + 10;
+        } else {
+            return false;
+        }
+        key[i / 2] = (i % 2) ? (key[i / 2] | v) : (uint8_t)(v << 4);
+    }
+    return true;
+}
+
+/**
+ * @brief 收包通知：在 WiFi 任务中执行，只唤醒处理作业
+ */
+static void gateway_notify(void *user_data)
+{
+    (void)user_data;
+    xn_sched_schedule(&s_rx_job, 0);
+}
+
+/**
+ * @brief 状态转发：发布到与直连时相同的 device/{id}/status
+ */
+static void gateway_status(const char *device_id, const uint8_t *payload, size_t len,
+                           void *user_data)
+{
+    (void)user_data;
+    char topic[64];
+    int n = snprintf(topic, sizeof(topic), "device/%s/status", device_id);
+    if (n < 0 || n >= (int)sizeof(topic)) {
+        return;
+    }
+    if (mqtt_manager_publish_status(topic, payload, len, 1) != ESP_OK) {
+        ESP_LOGW(TAG, "Forward status of %s failed", device_id);
+    }
+}
+
+/**
+ * @brief 收包处理作业
+ */
+static void rx_job(void *arg)
+{
+    (void)arg;
+    xn_gateway_process();
+}
+
+/**
+ * @brief 汇总心跳作业：未连接时仍生成一次，离线设备照常移出设备表
+ */
+static void hb_job(void *arg)
+{
+    (void)arg;
+    int len = xn_gateway_heartbeat_to_json(mqtt_manager_get_client_id(), s_hb_buf, GATEWAY_HB_BUF_SIZE);
+    if (len <= 0 || !mqtt_manager_is_connected()) {
+        return;
+    }
+    (void)mqtt_manager_publish_status(s_hb_topic, s_hb_buf, len, 0);
+}
+
+/**
+ * @brief 控制命令路由（device/+/control）：目标设备在本网关下时转发
+ */
+static void gateway_control_handler(const char *topic, int topic_len,
+                                    const uint8_t *payload, int payload_len, void *user_data)
+{
+    (void)user_data;
+
+    // topic 形如 device/{id}/control，不以 '\0' 结尾
+    const char *id = memchr(topic, '/', topic_len);
+    if (id == NULL) {
+        return;
+    }
+    id++;
+    const char *end = memchr(id, '/', topic_len - (id - topic));
+    if (end == NULL || end == id || end - id > XN_GATEWAY_ID_MAX) {
+        return;
+    }
+    char device_id[XN_GATEWAY_ID_MAX + 1];
+    memcpy(device_id, id, end - id);
+    device_id[end - id] = '\0';
+
+    esp_err_t ret = xn_gateway_send_control(device_id, payload, payload_len);
+    if (ret != ESP_OK && ret != ESP_ERR_NOT_FOUND) {
+        ESP_LOGW(TAG, "Forward control to %s failed: %s", device_id, esp_err_to_name(ret));
+    }
+}
+
+/**
+ * @brief 启动作业：初始化 xn_gateway 并开始转发，失败时稍后重试
+ */
+static void start_job(void *arg)
+{
+    (void)arg;
+    if (s_started) {
+        return;
+    }
+
+    // 省电模式下 STA 只在信标间隔醒来，会丢失子设备报文；蓝牙共存时可能不允许关闭，仅告警
+    esp_err_t ret = esp_wifi_set_ps(WIFI_PS_NONE);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Disable WiFi power save failed: %s", esp_err_to_name(ret));
+    }
+
+    xn_gateway_config_t config = xn_gateway_get_default_config();
+    memcpy(config.key, s_key, sizeof(config.key));
+    config.max_devices = CONFIG_XN_GATEWAY_MAX_DEVICES;
+    config.offline_ms = CONFIG_XN_GATEWAY_OFFLINE_SEC * 1000U;
+    config.status_refresh_ms = CONFIG_XN_GATEWAY_STATUS_REFRESH_SEC * 1000U;
+    config.status_cb = gateway_status;
+    config.notify_cb = gateway_notify;
+    ret = xn_gateway_init(&config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Gateway init failed: %s", esp_err_to_name(ret));
+        xn_sched_schedule(&s_start_job, GATEWAY_MANAGER_RETRY_MS);
+        return;
+    }
+
+    ret = xn_sched_start_periodic(&s_hb_job, CONFIG_XN_GATEWAY_HEARTBEAT_SEC * 1000U);
+    if (ret == ESP_OK) {
+        ret = mqtt_manager_route_absolute(GATEWAY_CONTROL_FILTER, 1, gateway_control_handler, NULL);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Gateway start failed: %s", esp_err_to_name(ret));
+        xn_sched_cancel(&s_hb_job);
+        xn_gateway_deinit();
+        xn_sched_schedule(&s_start_job, GATEWAY_MANAGER_RETRY_MS);
+        return;
+    }
+
+    s_started = true;
+    ESP_LOGI(TAG, "Gateway started: %d devices max, heartbeat %ds",
+             CONFIG_XN_GATEWAY_MAX_DEVICES, CONFIG_XN_GATEWAY_HEARTBEAT_SEC);
+}
+
+/**
+ * @brief 获取IP后启动网关（ESP-NOW 使用 STA 当前信道）
+ */
+static void wifi_event_handler(const xn_event_t *event, void *user_data)
+{
+    (void)event;
+    (void)user_data;
+    if (!s_started) {
+        xn_sched_schedule(&s_start_job, 0);
+    }
+}
+#endif
+
+esp_err_t gateway_manager_init(void)
+{
+#if CONFIG_XN_GATEWAY_ENABLE
+    if (!gateway_parse_key(CONFIG_XN_GATEWAY_KEY, s_key)) {
+        ESP_LOGE(TAG, "CONFIG_XN_GATEWAY_KEY must be 32 hex characters, gateway disabled");
+        return ESP_OK;
+    }
+
+    const char *base_topic = mqtt_manager_get_base_topic();
+    const char *client_id = mqtt_manager_get_client_id();
+    if (base_topic == NULL || base_topic[0] == '\0' || client_id == NULL) {
+        ESP_LOGW(TAG, "MQTT base topic not set, gateway disabled");
+        return ESP_OK;
+    }
+    int n = snprintf(s_hb_topic, sizeof(s_hb_topic), "%s/%s/gateway/heartbeat", base_topic, client_id);
+    if (n < 0 || n >= (int)sizeof(s_hb_topic)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    s_hb_buf = malloc(GATEWAY_HB_BUF_SIZE);
+    if (s_hb_buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    xn_sched_job_init(&s_start_job, start_job, NULL, "gw_start");
+    xn_sched_job_init(&s_rx_job, rx_job, NULL, "gw_rx");
+    xn_sched_job_init(&s_hb_job, hb_job, NULL, "gw_heartbeat");
+    esp_err_t ret = xn_event_subscribe(XN_EVT_WIFI_GOT_IP, wifi_event_handler, NULL);
+    if (ret != ESP_OK) {
+        free(s_hb_buf);
+        s_hb_buf = NULL;
+        return ret;
+    }
+    ESP_LOGI(TAG, "Gateway enabled, waiting for WiFi");
+#else
+    ESP_LOGI(TAG, "Gateway disabled");
+#endif
+    return ESP_OK;
+}
@@ -0,0 +1,39 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-29 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-29 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\gateway_manager.h
+ * @Description: 网关管理器 - 经 ESP-NOW 汇聚子设备，由本机 MQTT 连接代为转发
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#ifndef GATEWAY_MANAGER_H
+#define GATEWAY_MANAGER_H
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 初始化网关管理器
+ * 
+ * - 未开启 CONFIG_XN_GATEWAY_ENABLE 时直接返回成功
+ * - 需在 MQTT 管理器之后调用；首次获取IP后启动 xn_gateway，关闭 WiFi 省电以便随时接收子设备报文
+ * - 子设备状态原样发布到 device/{id}/status（同Topic只保留最新值），内容未变化时不重复发布
+ * - 子设备心跳合并为一条，每 CONFIG_XN_GATEWAY_HEARTBEAT_SEC 秒发布到
+ *   <base_topic>/<client_id>/gateway/heartbeat，离线设备在 offline 中列出一次
+ * - 订阅 device/+/control，目标设备在本网关下时经 ESP-NOW 转发，否则忽略
+ * 
+ * @return esp_err_t 初始化结果
+ */
+esp_err_t gateway_manager_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GATEWAY_MANAGER_H */
@@ -0,0 +1,138 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-28 14:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-28 14:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\log_manager.c
+ * @Description: 日志上报管理器实现 - 缓冲裁剪、按需/持续批量上报
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "log_manager.h"
+
+#if CONFIG_XN_LOG_STREAM_ENABLE
+#include "xn_logstream.h"
+#include "xn_sched.h"
+#include "mqtt_manager.h"
+#endif
+
+static const char *TAG = "log_manager";
+
+#if CONFIG_XN_LOG_STREAM_ENABLE
+
+#define LOG_MANAGER_PERIOD_MS       1000    // 裁剪与持续上报周期
+#define LOG_MANAGER_MAX_BACKLOG     8192    // 允许的 MQTT outbox 积压，超出时本批丢弃
+
+static xn_sched_job_t s_job;            // 上报作业（共享调度器中周期执行）
+static volatile bool s_flush_requested; // 下次执行时上报
+static char s_topic[128];
+static volatile bool s_streaming;       // 持续上报
+
+/**
+ * @brief 把缓冲中的日志全部按批次发送；发送失败时该批丢弃，批次序号出现缺口
+ */
+static void flush(uint8_t *buf)
+{
+    size_t len;
+    while (mqtt_manager_is_connected() &&
+           (len = xn_logstream_read_batch(buf, CONFIG_XN_LOG_STREAM_BATCH_BYTES)) > 0) {
+        if (mqtt_manager_publish_stream(s_topic, buf, len, LOG_MANAGER_MAX_BACKLOG) != ESP_OK) {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief 上报作业：每周期裁剪缓冲或持续上报，收到请求时提前执行并上报
+ */
+static void log_job(void *arg)
+{
+    uint8_t *buf = (uint8_t *)arg;
+    const size_t high = CONFIG_XN_LOG_STREAM_RING_SIZE / 4 * 3;
+    bool requested = s_flush_requested;
+    s_flush_requested = false;
+
+    if (requested || s_streaming) {
+        flush(buf);
+    }
+    // 丢弃最早的记录，留出空间给新日志
+    xn_logstream_trim(high);
+}
+
+/**
+ * @brief 上报请求路由（<base>/<client_id>/log/get）："on"/"off" 切换持续上报，其他立即上报一次
+ */
+static void log_get_handler(const char *topic, int topic_len,
+                            const uint8_t *payload, int payload_len, void *user_data)
+{
+    (void)topic;
+    (void)topic_len;
+    (void)user_data;
+
+    if (payload_len == 2 && memcmp(payload, "on", 2) == 0) {
+        s_streaming = true;
+    } else if (payload_len == 3 && memcmp(payload, "off", 3) == 0) {
+        s_streaming = false;
+        return;
+    }
+    s_flush_requested = true;
+    xn_sched_schedule(&s_job, 0);
+}
+#endif
+
+esp_err_t log_manager_init(void)
+{
+#if CONFIG_XN_LOG_STREAM_ENABLE
+    const char *base_topic = mqtt_manager_get_base_topic();
+    const char *client_id = mqtt_manager_get_client_id();
+    if (base_topic == NULL || base_topic[0] == '\0' || client_id == NULL) {
+        ESP_LOGW(TAG, "MQTT base topic not set, log stream disabled");
+        return ESP_OK;
+    }
+    int n = snprintf(s_topic, sizeof(s_topic), "%s/%s/log", base_topic, client_id);
+    if (n < 0 || n >= (int)sizeof(s_topic)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint8_t *buf = malloc(CONFIG_XN_LOG_STREAM_BATCH_BYTES);
+    if (buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    xn_logstream_config_t config = xn_logstream_get_default_config();
+    config.ring_size = CONFIG_XN_LOG_STREAM_RING_SIZE;
+    config.tag_rate = CONFIG_XN_LOG_STREAM_TAG_RATE;
+    config.uart_level = (esp_log_level_t)CONFIG_XN_LOG_STREAM_UART_LEVEL;
+    esp_err_t ret = xn_logstream_init(&config);
+    if (ret != ESP_OK) {
+        free(buf);
+        return ret;
+    }
+
+    // 日志已接管，作业启动失败时缓冲仍保留最早的日志，不影响 UART 输出
+    xn_sched_job_init(&s_job, log_job, buf, "log_stream");
+    ret = xn_sched_start_periodic(&s_job, LOG_MANAGER_PERIOD_MS);
+    if (ret != ESP_OK) {
+        free(buf);
+        return ret;
+    }
+
+    char filter[64];
+    snprintf(filter, sizeof(filter), "%s/log/get", client_id);
+    ret = mqtt_manager_route(filter, 0, log_get_handler, NULL);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Log stream: ring %d bytes, %d/s per tag",
+             CONFIG_XN_LOG_STREAM_RING_SIZE, CONFIG_XN_LOG_STREAM_TAG_RATE);
+#else
+    ESP_LOGI(TAG, "Log stream disabled");
+#endif
+    return ESP_OK;
+}
@@ -0,0 +1,42 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-28 14:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-28 14:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\log_manager.h
+ * @Description: 日志上报管理器 - 二进制日志常驻缓冲，按需经 MQTT 批量上报
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#ifndef LOG_MANAGER_H
+#define LOG_MANAGER_H
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 初始化日志上报管理器
+ * 
+ * - 未开启 CONFIG_XN_LOG_STREAM_ENABLE 时直接返回成功
+ * - 需在 MQTT 管理器之后调用，此前的日志只输出到 UART
+ * - 安装 xn_logstream，日志以二进制记录写入环形缓冲；缓冲区超过 3/4 时丢弃最早的记录，
+ *   始终保留最近的日志
+ * - 向 <base_topic>/<client_id>/log/get 发布消息请求上报，批次发布到
+ *   <base_topic>/<client_id>/log（QoS0，不经过发送队列）：
+ *   - "on"：持续上报，每秒发送新增的日志
+ *   - "off"：停止持续上报
+ *   - 其他：把当前缓冲中的日志发送一次
+ * 
+ * @return esp_err_t 初始化结果
+ */
+esp_err_t log_manager_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOG_MANAGER_H */
@@ -12,13 +12,21 @@
 #include <string.h>                                 // 字符串处理函数
 #include <stdio.h>                                  // 标准输入输出
 #include <stdint.h>                                 // 标准整型定义
+#include <stdlib.h>                                 // 内存分配
+#include "sdkconfig.h"                              // 工程配置
 #include "freertos/FreeRTOS.h"                      // FreeRTOS核心头文件
 #include "freertos/task.h"                          // FreeRTOS任务头文件
 #include "esp_log.h"                                // ESP日志模块
 #include "esp_mac.h"                                // ESP MAC地址获取
 #include "xn_event_bus.h"                           // 事件总线模块
+#include "xn_sched.h"                               // 共享调度器
 #include "mqtt_manager.h"                           // 本模块头文件
+#include "mqtt_outbox.h"                            // 发送队列
+#include "mqtt_router.h"                            // Topic路由
 #include "mqtt_module.h"                            // MQTT底层API模块
+#if CONFIG_XN_DISPLAY_STATS
+#include "xn_display.h"                             // 显示性能统计
+#endif
 
 /* 日志TAG */
 static const char *TAG = "mqtt_manager";            // 本模块日志TAG
@@ -29,9 +37,43 @@ static const char *TAG = "mqtt_manager";            // 本模块日志TAG
 
 static mqtt_manager_config_t s_mgr_cfg;             // 上层传入的管理配置副本
 static mqtt_manager_state_t  s_mgr_state = MQTT_MANAGER_STATE_IDLE; // 当前状态
-static TaskHandle_t          s_mgr_task  = NULL;    // 管理任务句柄
-static TickType_t            s_last_error_ts = 0;   // 最近一次错误/断开的时间戳
+static xn_sched_job_t        s_mgr_job;             // 管理作业（在共享调度器中执行）
+static uint32_t              s_notify_bits = 0;     // 待处理的通知位
+static volatile bool         s_running = false;     // 是否处于启动状态（start 之后、stop 之前）
 static bool                  s_initialized = false; // 初始化标志
+static volatile TickType_t   s_flush_start = 0;     // 当前发送窗口的起始时间
+static TickType_t            s_stats_at = 0;        // 下次统计上报时间
+
+/* 重连调度，仅在管理作业中访问 */
+static bool                  s_retry_pending = false; // 是否已安排重连
+static TickType_t            s_retry_at = 0;        // 计划重连时间
+static uint32_t              s_retry_count = 0;     // 连续重连次数，连接稳定后清零
+static bool                  s_stable_pending = false; // 已连接，等待确认连接稳定
+static TickType_t            s_stable_at = 0;       // 连接稳定的判定时间
+static uint32_t              s_jitter_state = 1;    // 重连抖动随机数状态，由client_id派生
+
+/* 管理作业通知位，累积到下次执行时一并处理 */
+#define MQTT_MANAGER_NOTIFY_START       (1u << 0)   // 请求立即连接（GOT_IP 或手动启动）
+#define MQTT_MANAGER_NOTIFY_STOP        (1u << 1)   // 已停止，取消待执行的重连
+#define MQTT_MANAGER_NOTIFY_CONNECTED   (1u << 2)   // 底层已连接
+#define MQTT_MANAGER_NOTIFY_LOST        (1u << 3)   // 底层断开或出错
+#define MQTT_MANAGER_NOTIFY_FLUSH       (1u << 4)   // 发送队列有新消息
+
+/* 分片消息拼装状态，仅在MQTT客户端任务中访问 */
+static xn_event_buf_t      *s_rx_buf = NULL;        // 正在拼装的消息缓冲区
+static xn_evt_mqtt_data_t  *s_rx_msg = NULL;        // 缓冲区头部的消息描述
+static uint32_t             s_rx_received = 0;      // 已收到的负载字节数
+
+#define MQTT_MANAGER_ROUTE_FILTER_MAX 128           // 拼接 base_topic 后路由过滤器的最大长度
+#define MQTT_MANAGER_STATS_JSON_MAX   2048          // 统计上报JSON的最大长度
+
+#if CONFIG_XN_EVENT_BUS_TRACE
+#define MQTT_MANAGER_TRACE_JSON_MAX  8192           // 事件总线延迟统计JSON的最大长度
+#endif
+
+#if CONFIG_XN_DISPLAY_STATS
+#define MQTT_MANAGER_DISPLAY_JSON_MAX 1024          // 显示性能统计JSON的最大长度
+#endif
 
 /* 若上层未指定client_id，则使用该缓冲区生成一个基于MAC的默认ID */
 static char s_client_id_buf[32];                    // 客户端ID缓冲区
@@ -101,6 +143,290 @@ static void mqtt_manager_ensure_client_id(void)
     s_mgr_cfg.client_id = s_client_id_buf;
 }
 
+/**
+ * @brief 由client_id派生重连抖动的随机数种子
+ *
+ * 同一设备每次启动的退避序列一致，不同设备之间彼此错开，
+ * Broker重启后整个设备群不会在同一时刻集中重连。
+ */
+static void mqtt_manager_seed_jitter(void)
+{
+    // FNV-1a 哈希
+    uint32_t hash = 2166136261u;
+    for (const char *p = s_mgr_cfg.client_id; *p != '\0'; p++) {
+        hash ^= (uint8_t)*p;
+        hash *= 16777619u;
+    }
+    s_jitter_state = (hash != 0) ? hash : 1;        // xorshift 状态不能为0
+}
+
+/**
+ * @brief 计算下一次重连的等待时间
+ *
+ * 间隔从 reconnect_interval_ms 开始逐次翻倍，上限 reconnect_max_ms；
+ * 实际等待在 [间隔/2, 间隔] 内随机取值。
+ *
+ * @return uint32_t 等待时间（ms）
+ */
+static uint32_t mqtt_manager_backoff_ms(void)
+{
+    uint32_t base = (uint32_t)s_mgr_cfg.reconnect_interval_ms;
+    uint32_t cap  = (s_mgr_cfg.reconnect_max_ms > s_mgr_cfg.reconnect_interval_ms)
+                        ? (uint32_t)s_mgr_cfg.reconnect_max_ms : base;
+
+    // 逐次翻倍，先比较再左移避免溢出
+    uint32_t interval = base;
+    for (uint32_t i = 0; i < s_retry_count && interval < cap; i++) {
+        interval = (interval > cap / 2) ? cap : interval * 2;
+    }
+
+    // xorshift32
+    s_jitter_state ^= s_jitter_state << 13;
+    s_jitter_state ^= s_jitter_state >> 17;
+    s_jitter_state ^= s_jitter_state << 5;
+
+    uint32_t half = interval / 2;
+    return half + s_jitter_state % (interval - half + 1);
+}
+
+#if CONFIG_XN_EVENT_BUS_TRACE
+/**
+ * @brief 延迟统计请求路由（<base>/<client_id>/trace/get）：打印到日志并回复JSON到 <base>/<client_id>/trace
+ */
+static void mqtt_manager_trace_handler(const char *topic, int topic_len,
+                                       const uint8_t *payload, int payload_len, void *user_data)
+{
+    (void)payload;
+    (void)payload_len;
+    (void)user_data;
+
+    // 同时输出到串口日志，便于现场查看
+    xn_event_trace_dump();
+
+    char *json = malloc(MQTT_MANAGER_TRACE_JSON_MAX);
+    if (json == NULL) {
+        return;
+    }
+    int len = xn_event_trace_to_json(json, MQTT_MANAGER_TRACE_JSON_MAX);
+    if (len > 0) {
+        // 回复Topic为请求Topic去掉末尾的 "/get"
+        char reply[96];
+        snprintf(reply, sizeof(reply), "%.*s", topic_len - 4, topic);
+        (void)mqtt_module_publish(reply, json, len, 0, false);
+    }
+    free(json);
+}
+#endif
+
+#if CONFIG_XN_DISPLAY_STATS
+/**
+ * @brief 显示统计请求路由（<base>/<client_id>/display/get）：打印到日志并回复JSON到 <base>/<client_id>/display
+ *
+ * 负载为 "reset" 时回复后清空统计，便于按场景分段采样
+ */
+static void mqtt_manager_display_handler(const char *topic, int topic_len,
+                                         const uint8_t *payload, int payload_len, void *user_data)
+{
+    (void)user_data;
+
+    xn_display_stats_dump();
+
+    char *json = malloc(MQTT_MANAGER_DISPLAY_JSON_MAX);
+    if (json == NULL) {
+        return;
+    }
+    int len = xn_display_stats_to_json(json, MQTT_MANAGER_DISPLAY_JSON_MAX);
+    if (len > 0) {
+        // 回复Topic为请求Topic去掉末尾的 "/get"
+        char reply[96];
+        snprintf(reply, sizeof(reply), "%.*s", topic_len - 4, topic);
+        (void)mqtt_module_publish(reply, json, len, 0, false);
+    }
+    free(json);
+
+    if (payload_len == 5 && memcmp(payload, "reset", 5) == 0) {
+        xn_display_stats_reset();
+    }
+}
+#endif
+
+/**
+ * @brief 拼接路由过滤器：base_topic/filter，未配置 base_topic 时原样使用
+ *
+ * @return true 成功，false 超长
+ */
+static bool mqtt_manager_route_filter(const char *filter, char *out, size_t out_size)
+{
+    int n;
+    if (s_mgr_cfg.base_topic == NULL || s_mgr_cfg.base_topic[0] == '\0') {
+        n = snprintf(out, out_size, "%s", filter);
+    } else {
+        n = snprintf(out, out_size, "%s/%s", s_mgr_cfg.base_topic, filter);
+    }
+    return n > 0 && n < (int)out_size;
+}
+
+/**
+ * @brief 发送队列是否启用
+ */
+static bool mqtt_manager_outbox_enabled(void)
+{
+    return s_mgr_cfg.outbox_capacity > 0;
+}
+
+/**
+ * @brief 通知管理作业
+ *
+ * @param bits MQTT_MANAGER_NOTIFY_* 组合
+ */
+static void mqtt_manager_wakeup(uint32_t bits)
+{
+    if (s_mgr_job.cb != NULL) {
+        __atomic_fetch_or(&s_notify_bits, bits, __ATOMIC_RELAXED);
+        xn_sched_schedule(&s_mgr_job, 0);
+    }
+}
+
+/**
+ * @brief 发送队列的发送函数
+ */
+static esp_err_t mqtt_manager_outbox_send(const char *topic, const void *data, int len, int qos)
+{
+    return mqtt_module_publish(topic, data, len, qos, false);
+}
+
+/**
+ * @brief 消息入队；队列由空变为非空时开启发送窗口并唤醒管理作业
+ */
+static esp_err_t mqtt_manager_enqueue(const char *topic, const void *data, size_t len, int qos, bool coalesce)
+{
+    bool was_empty = (mqtt_outbox_pending() == 0);
+    esp_err_t ret = mqtt_outbox_push(topic, data, len, qos, coalesce);
+    if (ret == ESP_OK && was_empty) {
+        s_flush_start = xTaskGetTickCount();
+        mqtt_manager_wakeup(MQTT_MANAGER_NOTIFY_FLUSH);
+    }
+    return ret;
+}
+
+/**
+ * @brief 连接状态下按窗口批量发送队列中的消息
+ *
+ * @param now 当前时间
+ * @return TickType_t 距离下次发送的等待时间，无需发送时返回 portMAX_DELAY
+ */
+static TickType_t mqtt_manager_outbox_service(TickType_t now)
+{
+    if (!mqtt_manager_outbox_enabled() || s_mgr_state != MQTT_MANAGER_STATE_CONNECTED ||
+        mqtt_outbox_pending() == 0) {
+        return portMAX_DELAY;
+    }
+
+    TickType_t window = pdMS_TO_TICKS(s_mgr_cfg.flush_window_ms > 0 ? s_mgr_cfg.flush_window_ms : 0);
+    if (window == 0) {
+        window = 1;                                 // 至少间隔一个Tick，避免发送失败时空转
+    }
+    TickType_t elapsed = now - s_flush_start;
+    if (elapsed < window) {
+        return window - elapsed;                    // 窗口未到，继续攒批
+    }
+
+    int batch = (s_mgr_cfg.drain_batch > 0) ? s_mgr_cfg.drain_batch : MQTT_MANAGER_DRAIN_BATCH;
+    int sent = mqtt_outbox_flush(mqtt_manager_outbox_send, batch);
+    ESP_LOGD(TAG, "Outbox flushed %d, pending %u", sent, (unsigned)mqtt_outbox_pending());
+
+    // 积压未发完时下一个窗口继续，控制补发速率
+    s_flush_start = now;
+    return (mqtt_outbox_pending() > 0) ? window : portMAX_DELAY;
+}
+
+/**
+ * @brief 统计上报是否启用
+ */
+static bool mqtt_manager_stats_enabled(void)
+{
+    return s_mgr_cfg.stats_interval_ms > 0 &&
+           s_mgr_cfg.base_topic != NULL && s_mgr_cfg.base_topic[0] != '\0';
+}
+
+/**
+ * @brief 把统计数据编码为JSON
+ *
+ * @return int JSON长度，缓冲区不足时返回 -1
+ */
+static int mqtt_manager_stats_to_json(const mqtt_module_stats_t *st, char *buf, size_t size)
+{
+    size_t pos;
+    int n = snprintf(buf, size,
+                     "{\"in\":{\"msgs\":%u,\"bytes\":%u},\"out\":{\"msgs\":%u,\"bytes\":%u,\"failed\":%u},"
+                     "\"ack\":{\"count\":%u,\"untracked\":%u,\"avg_ms\":%u,\"max_ms\":%u,\"inflight\":%u},"
+                     "\"outbox\":{\"client_bytes\":%d,\"queued\":%u},\"log_suppressed\":%u,\"topics\":[",
+                     (unsigned)st->msgs_in, (unsigned)st->bytes_in,
+                     (unsigned)st->msgs_out, (unsigned)st->bytes_out, (unsigned)st->publish_failed,
+                     (unsigned)st->acked, (unsigned)st->ack_untracked,
+                     (unsigned)st->ack_latency_avg_ms, (unsigned)st->ack_latency_max_ms, (unsigned)st->inflight,
+                     st->outbox_bytes, (unsigned)(mqtt_manager_outbox_enabled() ? mqtt_outbox_pending() : 0),
+                     (unsigned)st->data_log_suppressed);
+    if (n < 0 || (size_t)n >= size) {
+        return -1;
+    }
+    pos = n;
+
+    for (int i = 0; i < st->topic_count; i++) {
+        const mqtt_module_topic_stats_t *t = &st->topics[i];
+        n = snprintf(buf + pos, size - pos, "%s{\"topic\":\"%s\",\"in\":[%u,%u],\"out\":[%u,%u]}",
+                     (i > 0) ? "," : "", t->topic,
+                     (unsigned)t->msgs_in, (unsigned)t->bytes_in, (unsigned)t->msgs_out, (unsigned)t->bytes_out);
+        if (n < 0 || (size_t)n >= size - pos) {
+            return -1;
+        }
+        pos += n;
+    }
+
+    n = snprintf(buf + pos, size - pos, "]}");
+    if (n < 0 || (size_t)n >= size - pos) {
+        return -1;
+    }
+    return (int)(pos + n);
+}
+
+/**
+ * @brief 在管理作业中按周期发布统计数据
+ *
+ * @return TickType_t 距下次上报的等待时间
+ */
+static TickType_t mqtt_manager_stats_service(TickType_t now)
+{
+    if (!mqtt_manager_stats_enabled() || s_mgr_state != MQTT_MANAGER_STATE_CONNECTED) {
+        return portMAX_DELAY;
+    }
+
+    TickType_t interval = pdMS_TO_TICKS(s_mgr_cfg.stats_interval_ms);
+    if (interval == 0) {
+        interval = 1;
+    }
+    if ((int32_t)(s_stats_at - now) > 0) {
+        return s_stats_at - now;
+    }
+    s_stats_at = now + interval;
+
+    mqtt_module_stats_t *st = malloc(sizeof(mqtt_module_stats_t));
+    char *json = malloc(MQTT_MANAGER_STATS_JSON_MAX);
+    if (st != NULL && json != NULL && mqtt_module_get_stats(st) == ESP_OK) {
+        int len = mqtt_manager_stats_to_json(st, json, MQTT_MANAGER_STATS_JSON_MAX);
+        if (len > 0) {
+            char topic[96];
+            snprintf(topic, sizeof(topic), "%s/%s/stats", s_mgr_cfg.base_topic, s_mgr_cfg.client_id);
+            (void)mqtt_module_publish(topic, json, len, 0, false);
+        } else {
+            ESP_LOGW(TAG, "Stats JSON too large");
+        }
+    }
+    free(json);
+    free(st);
+    return interval;
+}
+
 /**
  * @brief MQTT模块事件回调
  *
@@ -112,118 +438,248 @@ static void mqtt_manager_on_mqtt_event(mqtt_module_event_t event)
         case MQTT_MODULE_EVENT_CONNECTED:           // 底层已连接
             ESP_LOGI(TAG, "MQTT connected");
             mqtt_manager_notify_state(MQTT_MANAGER_STATE_CONNECTED); // 更新为已连接
-            s_last_error_ts = 0;                    // 清空错误时间戳
+            // 会话可能未保留，路由的过滤器按批重新订阅
+            (void)mqtt_router_resubscribe(mqtt_module_subscribe_multiple, MQTT_MODULE_SUBSCRIBE_BATCH_MAX);
+            // 连接后满一个周期再上报统计
+            s_stats_at = xTaskGetTickCount() + pdMS_TO_TICKS(s_mgr_cfg.stats_interval_ms > 0 ? s_mgr_cfg.stats_interval_ms : 0);
+            // 立即开始补发断线期间缓存的消息
+            s_flush_start = xTaskGetTickCount() - pdMS_TO_TICKS(s_mgr_cfg.flush_window_ms > 0 ? s_mgr_cfg.flush_window_ms : 0);
+            mqtt_manager_wakeup(MQTT_MANAGER_NOTIFY_CONNECTED);
             break;
 
         case MQTT_MODULE_EVENT_DISCONNECTED:        // 底层断开
             ESP_LOGW(TAG, "MQTT disconnected");
             mqtt_manager_notify_state(MQTT_MANAGER_STATE_DISCONNECTED); // 更新为断开
-            s_last_error_ts = xTaskGetTickCount();  // 记录断开时间
+            mqtt_manager_wakeup(MQTT_MANAGER_NOTIFY_LOST); // 安排退避重连
             break;
 
         case MQTT_MODULE_EVENT_ERROR:               // 底层错误
         default:
             ESP_LOGE(TAG, "MQTT error");
             mqtt_manager_notify_state(MQTT_MANAGER_STATE_ERROR); // 更新为错误状态
-            s_last_error_ts = xTaskGetTickCount();  // 记录错误时间
+            mqtt_manager_wakeup(MQTT_MANAGER_NOTIFY_LOST); // 安排退避重连
             break;
     }
 }
 
 /**
- * @brief MQTT消息接收回调
+ * @brief 丢弃尚未拼装完成的消息
+ */
+static void mqtt_manager_rx_reset(void)
+{
+    xn_event_buf_release(s_rx_buf);                 // 释放拼装缓冲区的引用
+    s_rx_buf = NULL;
+    s_rx_msg = NULL;
+}
+
+/**
+ * @brief MQTT数据分片接收回调
  *
- * 由底层模块在收到消息时调用
+ * 由底层模块在MQTT客户端任务中调用。首个分片按消息总长一次性分配引用计数
+ * 缓冲区，布局为 [xn_evt_mqtt_data_t][topic\0][payload\0]，其后每个分片
+ * 直接拷贝到其偏移处；整条消息拼装完成后零拷贝发布到事件总线。
  */
-static void mqtt_manager_on_message(const char *topic, int topic_len, 
-                                    const uint8_t *payload, int payload_len)
+static void mqtt_manager_on_data(const char *topic, int topic_len,
+                                 const uint8_t *data, int data_len,
+                                 int offset, int total_len, int msg_id)
 {
-    ESP_LOGD(TAG, "Received data: topic=%.*s", topic_len, topic);
-    
-    // 透传给上层配置的回调
+    // 首个分片：为整条消息分配一次缓冲区
+    if (offset == 0) {
+        if (s_rx_buf != NULL) {
+            ESP_LOGW(TAG, "Drop incomplete message (%u/%u bytes)",
+                     (unsigned)s_rx_received, (unsigned)s_rx_msg->data_len);
+            mqtt_manager_rx_reset();
+        }
+
+        s_rx_buf = xn_event_buf_alloc(sizeof(xn_evt_mqtt_data_t) + topic_len + 1 + total_len + 1);
+        if (s_rx_buf == NULL) {
+            ESP_LOGE(TAG, "No memory for message (%d bytes)", total_len);
+            return;
+        }
+
+        // 负载结构体位于缓冲区头部，topic与data指针指向缓冲区内部
+        s_rx_msg = xn_event_buf_data(s_rx_buf);
+        s_rx_msg->topic = (char *)(s_rx_msg + 1);
+        s_rx_msg->topic_len = topic_len;
+        s_rx_msg->data = s_rx_msg->topic + topic_len + 1;
+        s_rx_msg->data_len = total_len;
+        s_rx_msg->msg_id = msg_id;
+
+        // Topic仅在首个分片中携带，拷贝一次并补结束符
+        if (topic_len > 0) {
+            memcpy(s_rx_msg->topic, topic, topic_len);
+        }
+        s_rx_msg->topic[topic_len] = '\0';
+        s_rx_msg->data[total_len] = '\0';
+        s_rx_received = 0;
+    }
+
+    // 没有进行中的消息（首分片分配失败或已被丢弃），忽略后续分片
+    if (s_rx_buf == NULL) {
+        return;
+    }
+
+    // 分片必须按顺序到达且不越界
+    if (offset != (int)s_rx_received || offset + data_len > (int)s_rx_msg->data_len) {
+        ESP_LOGW(TAG, "Unexpected fragment offset=%d len=%d", offset, data_len);
+        mqtt_manager_rx_reset();
+        return;
+    }
+
+    // 分片直接写入最终位置
+    memcpy(s_rx_msg->data + offset, data, data_len);
+    s_rx_received += data_len;
+
+    // 尚未收齐，等待后续分片
+    if (s_rx_received < s_rx_msg->data_len) {
+        return;
+    }
+
+    ESP_LOGD(TAG, "Received data: topic=%.*s", (int)s_rx_msg->topic_len, s_rx_msg->topic);
+
+    // 命中路由的消息直接交给处理函数，不再回调和广播
+    if (mqtt_router_dispatch(s_rx_msg->topic, (int)s_rx_msg->topic_len,
+                             (const uint8_t *)s_rx_msg->data, (int)s_rx_msg->data_len) > 0) {
+        mqtt_manager_rx_reset();
+        return;
+    }
+
+    // 透传给上层配置的回调（完整消息）
     if (s_mgr_cfg.message_cb) {
-        s_mgr_cfg.message_cb(topic, topic_len, payload, payload_len);
+        s_mgr_cfg.message_cb(s_rx_msg->topic, s_rx_msg->topic_len,
+                             (const uint8_t *)s_rx_msg->data, (int)s_rx_msg->data_len);
     }
 
-    // 封装后发布到事件总线
-    xn_evt_mqtt_data_t data = {
-        .topic = (char *)topic,                     // Topic指针
-        .topic_len = topic_len,                     // Topic长度
-        .data = (char *)payload,                    // 负载数据指针
-        .data_len = payload_len,                    // 负载数据长度
-        .msg_id = 0,                                // 模块层未透传msg_id
-    };
-    xn_event_post_data(XN_EVT_MQTT_DATA, XN_EVT_SRC_MQTT, &data, sizeof(data));
+    // 缓冲区引用转交事件总线，订阅者共享同一份数据
+    xn_event_buf_t *buf = s_rx_buf;
+    s_rx_buf = NULL;
+    s_rx_msg = NULL;
+    xn_event_post_buf(XN_EVT_MQTT_DATA, XN_EVT_SRC_MQTT, buf);
 }
 
 /**
- * @brief 单步执行MQTT管理状态机
+ * @brief 安排一次重连
  *
- * 根据当前状态与配置决定是否发起连接或等待重试
+ * @param now 当前时间
+ * @param delay_ms 等待时间（ms）
  */
-static void mqtt_manager_step(void)
-{
-    switch (s_mgr_state) {                          // 根据当前状态分类
-        case MQTT_MANAGER_STATE_DISCONNECTED:       // 断开状态
-        case MQTT_MANAGER_STATE_ERROR: {            // 错误状态
-            // 小于0表示不自动重连
-            if (s_mgr_cfg.reconnect_interval_ms < 0) {
-                break;
-            }
-
-            // 获取当前时间
-            TickType_t now   = xTaskGetTickCount();
-            // 计算距离上次出错的时间差
-            TickType_t delta = (s_last_error_ts == 0) ? 0 : (now - s_last_error_ts);
-
-            // 计算需要等待的Tick数
-            TickType_t need = pdMS_TO_TICKS(
-                (s_mgr_cfg.reconnect_interval_ms <= 0)
-                    ? 0
-                    : s_mgr_cfg.reconnect_interval_ms);
-
-            // 检查是否已到达重试时间
-            if (delta >= need) {
-                ESP_LOGI(TAG, "try connect MQTT server");
-                mqtt_manager_notify_state(MQTT_MANAGER_STATE_CONNECTING); // 进入连接中
-                (void)mqtt_module_start();          // 发起一次连接尝试
-                
-                // 如果是首次启动，也需要记录时间防止短时间内反复重连
-                if (s_last_error_ts == 0) {
-                    s_last_error_ts = now;
-                }
-            }
-            break;
-        }
+static void mqtt_manager_schedule_retry(TickType_t now, uint32_t delay_ms)
+{
+    s_retry_pending = true;
+    s_retry_at = now + pdMS_TO_TICKS(delay_ms);
+    ESP_LOGI(TAG, "Reconnect in %u ms (attempt %u)", (unsigned)delay_ms, (unsigned)(s_retry_count + 1));
+}
 
-        case MQTT_MANAGER_STATE_CONNECTED:          // 已连接状态
-        case MQTT_MANAGER_STATE_IDLE:               // 空闲状态
-        default:
-            // 已连接状态下，通常由MQTT内部心跳维持，应用层暂不做额外动作
-            break;
+/**
+ * @brief 连接保持 MQTT_MANAGER_STABLE_MS 后清零重连次数
+ *
+ * 连上后立即被断开（如认证被拒、Broker过载踢出）不算成功，
+ * 否则每次都从首次间隔重连，退避失效。
+ *
+ * @param bits 本次收到的通知位
+ * @param now 当前时间
+ * @return TickType_t 距离稳定判定的等待时间，无需判定时返回 portMAX_DELAY
+ */
+static TickType_t mqtt_manager_stable_service(uint32_t bits, TickType_t now)
+{
+    if (bits & (MQTT_MANAGER_NOTIFY_STOP | MQTT_MANAGER_NOTIFY_LOST)) {
+        s_stable_pending = false;
+    }
+    if (bits & MQTT_MANAGER_NOTIFY_CONNECTED) {
+        s_stable_pending = true;
+        s_stable_at = now + pdMS_TO_TICKS(MQTT_MANAGER_STABLE_MS);
+    }
+    if (!s_stable_pending || s_mgr_state != MQTT_MANAGER_STATE_CONNECTED) {
+        s_stable_pending = false;
+        return portMAX_DELAY;
+    }
+    if ((int32_t)(s_stable_at - now) > 0) {
+        return s_stable_at - now;
+    }
+    s_stable_pending = false;
+    s_retry_count = 0;
+    return portMAX_DELAY;
+}
+
+/**
+ * @brief 处理通知并在到期时发起重连
+ *
+ * @param bits 本次收到的通知位
+ * @param now 当前时间
+ * @return TickType_t 距离下次重连的等待时间，无待执行重连时返回 portMAX_DELAY
+ */
+static TickType_t mqtt_manager_reconnect_service(uint32_t bits, TickType_t now)
+{
+    if (bits & MQTT_MANAGER_NOTIFY_STOP) {
+        s_retry_pending = false;
+    }
+    if (bits & MQTT_MANAGER_NOTIFY_CONNECTED) {
+        s_retry_pending = false;
+    }
+    if ((bits & MQTT_MANAGER_NOTIFY_START) && s_running) {
+        // 网络刚恢复，不等待直接连接
+        s_retry_count = 0;
+        mqtt_manager_schedule_retry(now, 0);
+    }
+    if ((bits & MQTT_MANAGER_NOTIFY_LOST) && s_running && !s_retry_pending &&
+        s_mgr_cfg.reconnect_interval_ms >= 0 && s_mgr_state != MQTT_MANAGER_STATE_CONNECTED) {
+        mqtt_manager_schedule_retry(now, mqtt_manager_backoff_ms());
+        s_retry_count++;
+    }
+
+    if (!s_retry_pending) {
+        return portMAX_DELAY;
+    }
+    if ((int32_t)(s_retry_at - now) > 0) {
+        return s_retry_at - now;
+    }
+
+    // 到期：发起一次连接，结果由连接/断开事件通知
+    s_retry_pending = false;
+    ESP_LOGI(TAG, "try connect MQTT server");
+    mqtt_manager_notify_state(MQTT_MANAGER_STATE_CONNECTING); // 进入连接中
+    esp_err_t err = mqtt_module_reconnect();
+    if (err != ESP_OK && s_mgr_cfg.reconnect_interval_ms >= 0) {
+        // 客户端未能发起连接（不会再有断开事件），直接安排下一次
+        mqtt_manager_schedule_retry(now, mqtt_manager_backoff_ms());
+        s_retry_count++;
+        return s_retry_at - now;
     }
+    return portMAX_DELAY;
 }
 
 /**
- * @brief MQTT管理任务：周期性驱动状态机
+ * @brief MQTT管理作业：处理通知驱动重连，并按窗口发送队列中的消息
+ *
+ * 执行完按最近的截止时间重新安排自己；没有待执行的重连或发送时不再安排，
+ * 直到 GOT_IP / 断开 / 入队等通知，不做周期轮询。
  */
-static void mqtt_manager_task(void *arg)
+static void mqtt_manager_job(void *arg)
 {
     (void)arg;
 
-    for (;;) {
-        // 单步执行状态机
-        mqtt_manager_step();
+    uint32_t bits = __atomic_exchange_n(&s_notify_bits, 0, __ATOMIC_RELAXED);
+    TickType_t now = xTaskGetTickCount();
 
-        // 获取休眠间隔
-        int interval_ms = s_mgr_cfg.step_interval_ms;
-        if (interval_ms <= 0) {
-            // 若未配置使用默认值
-            interval_ms = MQTT_MANAGER_STEP_INTERVAL_MS;
-        }
+    TickType_t wait = mqtt_manager_reconnect_service(bits, now);
 
-        // 休眠一段时间
-        vTaskDelay(pdMS_TO_TICKS(interval_ms));
+    TickType_t stable_wait = mqtt_manager_stable_service(bits, now);
+    if (stable_wait < wait) {
+        wait = stable_wait;
+    }
+
+    TickType_t flush_wait = mqtt_manager_outbox_service(now);
+    if (flush_wait < wait) {
+        wait = flush_wait;
+    }
+
+    TickType_t stats_wait = mqtt_manager_stats_service(now);
+    if (stats_wait < wait) {
+        wait = stats_wait;
+    }
+
+    if (wait != portMAX_DELAY) {
+        xn_sched_schedule(&s_mgr_job, pdTICKS_TO_MS(wait));
     }
 }
 
@@ -284,6 +740,7 @@ esp_err_t mqtt_manager_init(const mqtt_manager_config_t *config)
 
     // 若未指定client_id，则基于MAC生成一个默认client_id
     mqtt_manager_ensure_client_id();
+    mqtt_manager_seed_jitter();
 
     // 组装MQTT模块配置
     mqtt_module_config_t mqtt_cfg = MQTT_MODULE_DEFAULT_CONFIG();
@@ -291,6 +748,7 @@ esp_err_t mqtt_manager_init(const mqtt_manager_config_t *config)
     mqtt_cfg.client_id     = s_mgr_cfg.client_id;   // 设置客户端ID
     mqtt_cfg.username      = s_mgr_cfg.username;    // 设置用户名
     mqtt_cfg.password      = s_mgr_cfg.password;    // 设置密码
+    mqtt_cfg.disable_auto_reconnect = true;         // 重连由管理器按退避策略调度
 
     // 设置keepalive
     if (s_mgr_cfg.keepalive_sec > 0) {
@@ -299,7 +757,7 @@ esp_err_t mqtt_manager_init(const mqtt_manager_config_t *config)
 
     // 绑定内部回调，用于将MQTT底层事件转换为Manager状态更新
     mqtt_cfg.event_cb   = mqtt_manager_on_mqtt_event;
-    mqtt_cfg.message_cb = mqtt_manager_on_message;
+    mqtt_cfg.data_cb    = mqtt_manager_on_data;
 
     // 初始化底层MQTT模块
     esp_err_t ret = mqtt_module_init(&mqtt_cfg);
@@ -308,27 +766,37 @@ esp_err_t mqtt_manager_init(const mqtt_manager_config_t *config)
         return ret;
     }
 
-    // 初始化状态
-    s_mgr_state     = MQTT_MANAGER_STATE_IDLE;
-    s_last_error_ts = 0;
-
-    // 创建管理任务（仅创建一次）
-    if (s_mgr_task == NULL) {
-        BaseType_t ret_task = xTaskCreate(
-            mqtt_manager_task,                      // 任务函数
-            "mqtt_mgr",                             // 任务名称
-            4096,                                   // 栈大小
-            NULL,                                   // 任务参数
-            tskIDLE_PRIORITY + 1,                   // 任务优先级
-            &s_mgr_task);                           // 任务句柄
-
-        if (ret_task != pdPASS) {
-            ESP_LOGE(TAG, "Create task failed");
-            s_mgr_task = NULL;
-            return ESP_ERR_NO_MEM;
+    // 初始化发送队列（必须先于管理作业）
+    if (mqtt_manager_outbox_enabled()) {
+        mqtt_outbox_config_t outbox_cfg = {
+            .capacity        = s_mgr_cfg.outbox_capacity,
+            .spill_partition = s_mgr_cfg.spill_partition,
+        };
+        ret = mqtt_outbox_init(&outbox_cfg);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "mqtt_outbox_init failed: %s", esp_err_to_name(ret));
+            return ret;
         }
     }
 
+    // 初始化Topic路由表
+    ret = mqtt_router_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "mqtt_router_init failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // 初始化状态
+    s_mgr_state     = MQTT_MANAGER_STATE_IDLE;
+    s_running       = false;
+    s_retry_pending = false;
+    s_retry_count   = 0;
+    s_stable_pending = false;
+
+    // 初始化管理作业（共享调度器的工作任务中执行，不再单独占一个任务栈）
+    s_notify_bits = 0;
+    xn_sched_job_init(&s_mgr_job, mqtt_manager_job, NULL, "mqtt_mgr");
+
     // 订阅系统事件 - 关注WiFi状态
     xn_event_subscribe(XN_EVT_WIFI_GOT_IP, system_event_handler, NULL);
     xn_event_subscribe(XN_EVT_WIFI_DISCONNECTED, system_event_handler, NULL);
@@ -336,6 +804,24 @@ esp_err_t mqtt_manager_init(const mqtt_manager_config_t *config)
     // 标记初始化完成
     s_initialized = true;
 
+#if CONFIG_XN_EVENT_BUS_TRACE
+    // 延迟统计请求：未配置基础Topic时不提供远程读取
+    if (s_mgr_cfg.base_topic != NULL && s_mgr_cfg.base_topic[0] != '\0') {
+        char trace_filter[64];
+        snprintf(trace_filter, sizeof(trace_filter), "%s/trace/get", s_mgr_cfg.client_id);
+        (void)mqtt_manager_route(trace_filter, 0, mqtt_manager_trace_handler, NULL);
+    }
+#endif
+
+#if CONFIG_XN_DISPLAY_STATS
+    // 显示性能统计请求，同样只在配置了基础Topic时提供
+    if (s_mgr_cfg.base_topic != NULL && s_mgr_cfg.base_topic[0] != '\0') {
+        char display_filter[64];
+        snprintf(display_filter, sizeof(display_filter), "%s/display/get", s_mgr_cfg.client_id);
+        (void)mqtt_manager_route(display_filter, 0, mqtt_manager_display_handler, NULL);
+    }
+#endif
+
     ESP_LOGI(TAG, "MQTT manager initialized");
     return ESP_OK;
 }
@@ -352,18 +838,25 @@ esp_err_t mqtt_manager_deinit(void)
     xn_event_unsubscribe(XN_EVT_WIFI_GOT_IP, system_event_handler);
     xn_event_unsubscribe(XN_EVT_WIFI_DISCONNECTED, system_event_handler);
 
-    // 停止管理任务
-    if (s_mgr_task != NULL) {
-        vTaskDelete(s_mgr_task);
-        s_mgr_task = NULL;
-    }
+    // 停止管理作业
+    xn_sched_cancel(&s_mgr_job);
+    s_mgr_job.cb = NULL;
 
     // 停止MQTT
     mqtt_module_stop();
 
+    // 丢弃未拼装完成的消息
+    mqtt_manager_rx_reset();
+
+    // 释放发送队列（已落盘的消息保留到下次启动）
+    mqtt_outbox_deinit();
+
+    // 释放路由表
+    mqtt_router_deinit();
+
     // 重置状态
     s_mgr_state = MQTT_MANAGER_STATE_IDLE;
-    s_last_error_ts = 0;
+    s_running = false;
     s_initialized = false;
 
     ESP_LOGI(TAG, "MQTT manager deinitialized");
@@ -377,11 +870,12 @@ esp_err_t mqtt_manager_start(void)
         return ESP_ERR_INVALID_STATE;
     }
 
-    // 重置错误时间戳以触发立即连接
-    s_last_error_ts = 0;
+    // 由管理作业立即发起连接，退避计数清零
+    s_running = true;
     s_mgr_state = MQTT_MANAGER_STATE_DISCONNECTED;
+    mqtt_manager_wakeup(MQTT_MANAGER_NOTIFY_START);
 
-    return mqtt_module_start();
+    return ESP_OK;
 }
 
 /* 手动停止MQTT连接 */
@@ -391,6 +885,10 @@ esp_err_t mqtt_manager_stop(void)
         return ESP_ERR_INVALID_STATE;
     }
 
+    // 先清除运行标志，停止过程中上报的断开事件不再安排重连
+    s_running = false;
+    mqtt_manager_wakeup(MQTT_MANAGER_NOTIFY_STOP);
+
     esp_err_t ret = mqtt_module_stop();
     if (ret == ESP_OK) {
         s_mgr_state = MQTT_MANAGER_STATE_IDLE;
@@ -405,7 +903,44 @@ esp_err_t mqtt_manager_publish(const char *topic, const void *data, size_t len,
         return ESP_ERR_INVALID_STATE;
     }
     
-    return mqtt_module_publish(topic, data, (int)len, qos, false);
+    // 未启用队列，或无需攒批且没有积压时直接发送
+    if (!mqtt_manager_outbox_enabled() ||
+        (s_mgr_cfg.flush_window_ms <= 0 && mqtt_manager_is_connected() && mqtt_outbox_pending() == 0)) {
+        return mqtt_module_publish(topic, data, (int)len, qos, false);
+    }
+
+    return mqtt_manager_enqueue(topic, data, len, qos, false);
+}
+
+/* 发布状态消息 */
+esp_err_t mqtt_manager_publish_status(const char *topic, const void *data, size_t len, int qos)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (!mqtt_manager_outbox_enabled()) {
+        return mqtt_module_publish(topic, data, (int)len, qos, false);
+    }
+
+    return mqtt_manager_enqueue(topic, data, len, qos, true);
+}
+
+/* 发布实时数据流消息 */
+esp_err_t mqtt_manager_publish_stream(const char *topic, const void *data, size_t len, size_t max_backlog)
+{
+    if (!s_initialized || !mqtt_manager_is_connected()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 链路变差时 outbox 积压，超过上限拒绝新数据
+    int backlog = mqtt_module_get_outbox_size();
+    if (backlog > 0 && (size_t)backlog + len > max_backlog) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = mqtt_module_enqueue(topic, data, (int)len, 0);
+    return (ret == ESP_FAIL) ? ESP_ERR_NO_MEM : ret;
 }
 
 /* 订阅主题 */
@@ -428,6 +963,95 @@ esp_err_t mqtt_manager_unsubscribe(const char *topic)
     return mqtt_module_unsubscribe(topic);
 }
 
+/**
+ * @brief 按完整过滤器登记路由，首次登记且已连接时立即订阅
+ */
+static esp_err_t mqtt_manager_route_full(const char *full, int qos,
+                                         mqtt_manager_topic_handler_t handler, void *user_data)
+{
+    bool first = false;
+    esp_err_t ret = mqtt_router_add(full, qos, handler, user_data, &first);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // 未连接时只登记，连接成功后统一订阅
+    if (first && mqtt_manager_is_connected()) {
+        (void)mqtt_module_subscribe(full, qos);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 按完整过滤器注销路由，最后一个处理函数注销且已连接时取消订阅
+ */
+static esp_err_t mqtt_manager_unroute_full(const char *full, mqtt_manager_topic_handler_t handler)
+{
+    bool last = false;
+    esp_err_t ret = mqtt_router_remove(full, handler, &last);
+    if (ret == ESP_OK && last && mqtt_manager_is_connected()) {
+        (void)mqtt_module_unsubscribe(full);
+    }
+    return ret;
+}
+
+/* 注册Topic路由 */
+esp_err_t mqtt_manager_route(const char *filter, int qos,
+                             mqtt_manager_topic_handler_t handler, void *user_data)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (filter == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char full[MQTT_MANAGER_ROUTE_FILTER_MAX];
+    if (!mqtt_manager_route_filter(filter, full, sizeof(full))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return mqtt_manager_route_full(full, qos, handler, user_data);
+}
+
+/* 注销Topic路由 */
+esp_err_t mqtt_manager_unroute(const char *filter, mqtt_manager_topic_handler_t handler)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    char full[MQTT_MANAGER_ROUTE_FILTER_MAX];
+    if (filter == NULL || !mqtt_manager_route_filter(filter, full, sizeof(full))) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return mqtt_manager_unroute_full(full, handler);
+}
+
+/* 注册完整Topic路由（不拼接 base_topic） */
+esp_err_t mqtt_manager_route_absolute(const char *filter, int qos,
+                                      mqtt_manager_topic_handler_t handler, void *user_data)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (filter == NULL || strlen(filter) >= MQTT_MANAGER_ROUTE_FILTER_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return mqtt_manager_route_full(filter, qos, handler, user_data);
+}
+
+/* 注销完整Topic路由 */
+esp_err_t mqtt_manager_unroute_absolute(const char *filter, mqtt_manager_topic_handler_t handler)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (filter == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return mqtt_manager_unroute_full(filter, handler);
+}
+
 /* 获取当前状态 */
 mqtt_manager_state_t mqtt_manager_get_state(void)
 {
@@ -440,8 +1064,20 @@ bool mqtt_manager_is_connected(void)
     return (s_mgr_state == MQTT_MANAGER_STATE_CONNECTED);
 }
 
+/* 检查已发布的消息是否全部送达 */
+bool mqtt_manager_is_drained(void)
+{
+    return mqtt_outbox_pending() == 0 && mqtt_module_get_outbox_size() <= 0;
+}
+
 /* 获取客户端ID */
 const char *mqtt_manager_get_client_id(void)
 {
     return s_mgr_cfg.client_id;
 }
+
+/* 获取项目基础Topic */
+const char *mqtt_manager_get_base_topic(void)
+{
+    return s_mgr_cfg.base_topic;
+}
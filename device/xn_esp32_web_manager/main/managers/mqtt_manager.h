@@ -25,13 +25,37 @@ extern "C" {                                        // 使用C链接约定
 /* ========================================================================== */
 
 /**
- * @brief MQTT管理器状态机运行周期（单位：ms）
+ * @brief 重连退避默认参数（单位：ms）
  *
- * 管理任务按该间隔周期性驱动内部状态机：
- * - 间隔过小：状态刷新更及时，但占用更多CPU
- * - 间隔过大：重连/心跳响应会变慢
+ * 管理作业在共享调度器（xn_sched）中执行，由 GOT_IP / 断开事件唤醒，不做周期轮询：
+ * - 获取IP后立即连接
+ * - 断开后等待间隔逐次翻倍直至上限，并按client_id加入随机抖动，
+ *   避免Broker重启后所有设备同时重连
+ * - 连接保持 MQTT_MANAGER_STABLE_MS 后才恢复首次间隔，
+ *   连上即被断开（如认证被拒）时仍按退避间隔重连
  */
-#define MQTT_MANAGER_STEP_INTERVAL_MS   5000        // 默认状态机运行间隔（ms）
+#define MQTT_MANAGER_RECONNECT_BASE_MS  2000        // 默认首次重连间隔（ms）
+#define MQTT_MANAGER_RECONNECT_MAX_MS   120000      // 默认最大重连间隔（ms）
+#define MQTT_MANAGER_STABLE_MS          30000       // 连接保持多久视为稳定并清零重连次数（ms）
+
+/**
+ * @brief 发送队列默认参数
+ *
+ * 发布的消息先进入发送队列，由管理作业按窗口批量发出：
+ * - 断线期间消息缓存在RAM环形缓冲，满了转存到溢出分区（若配置）
+ * - 重连后每个窗口最多补发 drain_batch 条，避免瞬间冲击Broker
+ */
+#define MQTT_MANAGER_FLUSH_WINDOW_MS    200         // 默认批量发送窗口（ms）
+#define MQTT_MANAGER_OUTBOX_CAPACITY    64          // 默认RAM缓存消息条数
+#define MQTT_MANAGER_DRAIN_BATCH        16          // 默认每个窗口最多发送条数
+
+/**
+ * @brief 数据通路统计上报默认周期（ms），0 表示不上报
+ *
+ * 开启后已连接时每个周期把 mqtt_module_get_stats 的结果与发送队列深度
+ * 以JSON发布到 <base_topic>/<client_id>/stats（QoS0）。
+ */
+#define MQTT_MANAGER_STATS_INTERVAL_MS  0
 
 /**
  * @brief MQTT管理器状态枚举
@@ -55,6 +79,18 @@ typedef enum {
  */
 typedef void (*mqtt_manager_state_cb_t)(mqtt_manager_state_t state); // 状态回调类型定义
 
+/**
+ * @brief Topic路由处理函数原型（在MQTT客户端任务中调用，消息完整后才调用）
+ *
+ * @param topic       完整Topic（不含结束符）
+ * @param topic_len   Topic长度
+ * @param payload     Payload数据
+ * @param payload_len Payload长度
+ * @param user_data   注册时传入的用户数据
+ */
+typedef void (*mqtt_manager_topic_handler_t)(const char *topic, int topic_len,
+                                             const uint8_t *payload, int payload_len, void *user_data);
+
 /**
  * @brief MQTT管理器配置结构体
  *
@@ -67,8 +103,13 @@ typedef struct {
     const char              *password;              // MQTT密码，可为NULL表示无密码
     const char              *base_topic;            // 项目基础Topic前缀，如 "xn/device"
     int                      keepalive_sec;         // MQTT keepalive保活时间（秒），<=0使用组件默认值
-    int                      reconnect_interval_ms; // 连接失败后自动重连间隔(ms)；<0表示关闭自动重连
-    int                      step_interval_ms;      // 状态机运行周期（ms），<=0使用默认值
+    int                      reconnect_interval_ms; // 首次重连间隔(ms)，之后逐次翻倍；<0表示关闭自动重连
+    int                      reconnect_max_ms;      // 重连间隔上限(ms)，小于首次间隔时按固定间隔重连
+    int                      flush_window_ms;       // 批量发送窗口（ms），<=0表示已连接时直接发送
+    int                      outbox_capacity;       // 发送队列RAM缓存条数，<=0关闭发送队列（断线消息丢失）
+    int                      drain_batch;           // 每个窗口最多发送条数，<=0使用默认值
+    const char              *spill_partition;       // 溢出落盘的数据分区标签，NULL表示只用RAM
+    int                      stats_interval_ms;     // 统计上报周期（ms），<=0不上报；需要配置base_topic
     mqtt_manager_state_cb_t  state_cb;              // 状态变更回调，可为NULL表示不关心
     /**
      * @brief 消息接收回调
@@ -92,8 +133,13 @@ typedef struct {
         .password              = "xn_mqtt_pass",                    \
         .base_topic            = NULL,                              \
         .keepalive_sec         = 60,                                \
-        .reconnect_interval_ms = 5000,                              \
-        .step_interval_ms      = MQTT_MANAGER_STEP_INTERVAL_MS,     \
+        .reconnect_interval_ms = MQTT_MANAGER_RECONNECT_BASE_MS,    \
+        .reconnect_max_ms      = MQTT_MANAGER_RECONNECT_MAX_MS,     \
+        .flush_window_ms       = MQTT_MANAGER_FLUSH_WINDOW_MS,      \
+        .outbox_capacity       = MQTT_MANAGER_OUTBOX_CAPACITY,      \
+        .drain_batch           = MQTT_MANAGER_DRAIN_BATCH,          \
+        .spill_partition       = NULL,                              \
+        .stats_interval_ms     = MQTT_MANAGER_STATS_INTERVAL_MS,    \
         .state_cb              = NULL,                              \
         .message_cb            = NULL,                              \
     }
@@ -107,7 +153,7 @@ typedef struct {
  * 
  * 功能概览：
  * - 初始化内部MQTT客户端及相关资源
- * - 创建管理任务并启动内部状态机
+ * - 初始化管理作业并启动内部状态机
  * - 根据配置自动尝试与服务器建立连接
  *
  * @note 调用前应确保WiFi/以太网已经就绪并具备网络连接
@@ -126,7 +172,7 @@ esp_err_t mqtt_manager_init(const mqtt_manager_config_t *config); // 初始化
  * @brief 反初始化MQTT管理器
  * 
  * - 销毁MQTT Client句柄
- * - 停止管理任务
+ * - 停止管理作业
  * - 取消事件订阅
  * 
  * @return esp_err_t 反初始化结果
@@ -136,7 +182,7 @@ esp_err_t mqtt_manager_deinit(void);                // 反初始化函数声明
 /**
  * @brief 启动MQTT连接
  * 
- * 手动触发连接尝试（通常由状态机自动处理）
+ * 手动触发连接尝试（通常在获取IP时自动调用），清零重连退避并由管理作业立即连接
  * 
  * @return esp_err_t 启动结果
  */
@@ -154,14 +200,51 @@ esp_err_t mqtt_manager_stop(void);                  // 手动停止函数声明
 /**
  * @brief 发布消息
  * 
+ * 启用发送队列时消息先入队，由管理作业批量发出；断线期间缓存，重连后补发。
+ * 
  * @param topic 主题
  * @param data 负载数据
  * @param len 数据长度
  * @param qos 服务质量 (0, 1, 2)
  * @return esp_err_t 发布请求提交结果
+ *      - ESP_OK             : 已发送或已入队
+ *      - ESP_ERR_INVALID_ARG: 超出可缓存的Topic/负载长度
+ *      - ESP_ERR_NO_MEM     : 内存不足
  */
 esp_err_t mqtt_manager_publish(const char *topic, const void *data, size_t len, int qos); // 发布函数声明
 
+/**
+ * @brief 发布状态消息（同Topic只保留最新值）
+ * 
+ * 尚未发出的同Topic状态消息被新负载替换，适合周期上报的状态、属性等
+ * 只关心最新值的数据。未启用发送队列时等同于 mqtt_manager_publish。
+ * 
+ * @param topic 主题
+ * @param data 负载数据
+ * @param len 数据长度
+ * @param qos 服务质量 (0, 1, 2)
+ * @return esp_err_t 同 mqtt_manager_publish
+ */
+esp_err_t mqtt_manager_publish_status(const char *topic, const void *data, size_t len, int qos); // 发布状态函数声明
+
+/**
+ * @brief 发布实时数据流消息（QoS0，不经过发送队列）
+ * 
+ * 消息放入 MQTT 客户端 outbox 后立即返回，不阻塞调用者；断线时不缓存。
+ * outbox 已积压超过 max_backlog 字节时拒绝本条，由调用者丢弃或降级，
+ * 用于音频等过时即无用的数据。
+ * 
+ * @param topic 主题
+ * @param data 负载数据
+ * @param len 数据长度
+ * @param max_backlog 允许的 outbox 积压上限（字节）
+ * @return esp_err_t
+ *      - ESP_OK               : 已放入 outbox
+ *      - ESP_ERR_INVALID_STATE: 未初始化或未连接
+ *      - ESP_ERR_NO_MEM       : 积压超限或入队失败
+ */
+esp_err_t mqtt_manager_publish_stream(const char *topic, const void *data, size_t len, size_t max_backlog); // 发布数据流函数声明
+
 /**
  * @brief 订阅主题
  * 
@@ -179,6 +262,62 @@ esp_err_t mqtt_manager_subscribe(const char *topic, int qos); // 订阅函数声
  */
 esp_err_t mqtt_manager_unsubscribe(const char *topic); // 取消订阅函数声明
 
+/**
+ * @brief 注册Topic路由
+ *
+ * 过滤器相对于 base_topic（未配置时为完整Topic），可使用 '+' 单层通配和末尾的
+ * '#' 多层通配。命中路由的消息直接交给处理函数，不再调用 message_cb，也不再
+ * 广播 XN_EVT_MQTT_DATA。同一过滤器首次注册时发起订阅，重连后所有路由按批
+ * 重新订阅。
+ *
+ * @param filter    Topic过滤器，如 "+/cmd/#"
+ * @param qos       订阅QoS
+ * @param handler   处理函数
+ * @param user_data 用户数据
+ * @return
+ *      - ESP_OK              : 成功
+ *      - ESP_ERR_INVALID_ARG : 过滤器非法或过长
+ *      - ESP_ERR_INVALID_STATE: 未初始化，或同一过滤器已注册该处理函数
+ *      - ESP_ERR_NO_MEM      : 内存不足
+ */
+esp_err_t mqtt_manager_route(const char *filter, int qos,
+                             mqtt_manager_topic_handler_t handler, void *user_data); // 注册路由函数声明
+
+/**
+ * @brief 注销Topic路由，过滤器上已没有处理函数时取消订阅
+ *
+ * @param filter  注册时的过滤器
+ * @param handler 处理函数
+ * @return
+ *      - ESP_OK           : 成功
+ *      - ESP_ERR_NOT_FOUND: 未注册
+ */
+esp_err_t mqtt_manager_unroute(const char *filter, mqtt_manager_topic_handler_t handler); // 注销路由函数声明
+
+/**
+ * @brief 注册完整Topic路由，过滤器不拼接 base_topic
+ *
+ * 用于订阅 base_topic 之外的主题（如网关转发 "device/+/control"），
+ * 其余行为与 mqtt_manager_route 相同。
+ *
+ * @param filter    完整Topic过滤器
+ * @param qos       订阅QoS
+ * @param handler   处理函数
+ * @param user_data 用户数据
+ * @return 同 mqtt_manager_route
+ */
+esp_err_t mqtt_manager_route_absolute(const char *filter, int qos,
+                                      mqtt_manager_topic_handler_t handler, void *user_data); // 注册完整路由函数声明
+
+/**
+ * @brief 注销完整Topic路由
+ *
+ * @param filter  注册时的完整过滤器
+ * @param handler 处理函数
+ * @return 同 mqtt_manager_unroute
+ */
+esp_err_t mqtt_manager_unroute_absolute(const char *filter, mqtt_manager_topic_handler_t handler); // 注销完整路由函数声明
+
 /**
  * @brief 获取当前MQTT管理器状态
  * 
@@ -194,6 +333,17 @@ mqtt_manager_state_t mqtt_manager_get_state(void);  // 获取状态函数声明
  */
 bool mqtt_manager_is_connected(void);               // 检查连接状态函数声明
 
+/**
+ * @brief 检查已发布的消息是否全部送达
+ * 
+ * 发送队列为空且 MQTT 客户端 outbox 为空（QoS1/2 消息均已收到确认）时为 true，
+ * 用于分片上传等需要逐条确认或控制积压的场景。
+ * 
+ * @return true 没有待发送或待确认的消息
+ * @return false 仍有消息在队列或 outbox 中
+ */
+bool mqtt_manager_is_drained(void);                 // 检查发送完成函数声明
+
 /**
  * @brief 获取当前MQTT客户端ID
  * 
@@ -201,6 +351,13 @@ bool mqtt_manager_is_connected(void);               // 检查连接状态函数
  */
 const char *mqtt_manager_get_client_id(void);       // 获取客户端ID函数声明
 
+/**
+ * @brief 获取项目基础Topic
+ * 
+ * @return const char* 基础Topic，未配置时为NULL
+ */
+const char *mqtt_manager_get_base_topic(void);      // 获取基础Topic函数声明
+
 #ifdef __cplusplus                                  // 如果是C++编译器
 }
 #endif                                              // 结束C++编译器判断
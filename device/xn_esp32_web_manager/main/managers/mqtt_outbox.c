@@ -0,0 +1,457 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-24
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\mqtt_outbox.c
+ * @Description: MQTT发送队列实现 - RAM环形缓冲 + 可选Flash溢出日志
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved.
+ */
+
+#include <string.h>                                 // 字符串处理函数
+#include <stdlib.h>                                 // 内存分配
+#include <stdint.h>                                 // 标准整型定义
+#include "freertos/FreeRTOS.h"                      // FreeRTOS核心头文件
+#include "freertos/semphr.h"                        // FreeRTOS互斥锁
+#include "esp_log.h"                                // ESP日志模块
+#include "esp_partition.h"                          // Flash分区读写
+#include "mqtt_outbox.h"                            // 本模块头文件
+
+/* 日志TAG */
+static const char *TAG = "mqtt_outbox";             // 本模块日志TAG
+
+/*
+ * 溢出分区按追加日志使用，每条记录：
+ *   magic(1) | state(1) | topic_len(1) | qos(1) | payload_len(2, 小端) | topic | payload
+ * state 写入时为 0xFF，发出后原地改写为 0x00（Flash 只需把 1 改成 0，无需擦除）。
+ * 全部发出后整片擦除，从头开始写。
+ */
+#define SPILL_MAGIC             0x5A                // 记录起始标识
+#define SPILL_STATE_PENDING     0xFF                // 待发送
+#define SPILL_STATE_SENT        0x00                // 已发送
+#define SPILL_HEADER_SIZE       6                   // 记录头长度
+
+/* ========================================================================== */
+/*                              内部类型与变量                                   */
+/* ========================================================================== */
+
+/**
+ * @brief RAM中的一条待发送消息，topic与负载位于同一块内存：[topic\0][payload]
+ */
+typedef struct {
+    char        *topic;                             // Topic（内存块起始）
+    uint8_t     *data;                              // 负载
+    uint16_t     len;                               // 负载长度
+    uint8_t      qos;                               // 服务质量
+    bool         coalesce;                          // 是否参与同Topic合并
+} outbox_msg_t;
+
+/**
+ * @brief 溢出分区日志状态
+ */
+typedef struct {
+    const esp_partition_t *part;                    // 溢出分区，NULL表示未启用
+    uint32_t     read_off;                          // 最早一条待发送记录的偏移
+    uint32_t     write_off;                         // 下一条记录的写入偏移
+    size_t       count;                             // 待发送记录条数
+    bool         erasing;                           // 正在擦除，期间不接受新记录
+} outbox_spill_t;
+
+static SemaphoreHandle_t s_lock = NULL;             // 队列保护锁
+static outbox_msg_t     *s_ring = NULL;             // RAM环形缓冲
+static int               s_capacity = 0;            // 环形缓冲容量
+static int               s_head = 0;                // 队首下标
+static int               s_count = 0;               // 队列中的消息条数
+static outbox_spill_t    s_spill;                   // 溢出分区状态
+static uint32_t          s_dropped = 0;             // 因队列满而丢弃的消息条数
+
+/* ========================================================================== */
+/*                              内部函数                                        */
+/* ========================================================================== */
+
+/**
+ * @brief 第 i 条消息（从队首算起）
+ */
+static outbox_msg_t *ring_at(int i)
+{
+    return &s_ring[(s_head + i) % s_capacity];
+}
+
+/**
+ * @brief 为消息分配 [topic\0][payload] 内存块
+ */
+static bool msg_fill(outbox_msg_t *msg, const char *topic, const void *data, size_t len, int qos, bool coalesce)
+{
+    size_t topic_len = strlen(topic);
+    char *block = malloc(topic_len + 1 + len);
+    if (block == NULL) {
+        return false;
+    }
+    memcpy(block, topic, topic_len + 1);
+    if (len > 0) {
+        memcpy(block + topic_len + 1, data, len);
+    }
+    msg->topic = block;
+    msg->data = (uint8_t *)block + topic_len + 1;
+    msg->len = (uint16_t)len;
+    msg->qos = (uint8_t)qos;
+    msg->coalesce = coalesce;
+    return true;
+}
+
+/**
+ * @brief 释放消息内存
+ */
+static void msg_free(outbox_msg_t *msg)
+{
+    free(msg->topic);
+    msg->topic = NULL;
+    msg->data = NULL;
+}
+
+/**
+ * @brief 溢出分区是否可用于写入
+ */
+static bool spill_enabled(void)
+{
+    return s_spill.part != NULL && !s_spill.erasing;
+}
+
+/**
+ * @brief 追加一条记录到溢出分区
+ *
+ * @return true 已落盘
+ */
+static bool spill_append(const outbox_msg_t *msg)
+{
+    size_t topic_len = strlen(msg->topic);
+    uint32_t rec_len = SPILL_HEADER_SIZE + topic_len + msg->len;
+    if (s_spill.write_off + rec_len > s_spill.part->size) {
+        return false;
+    }
+
+    uint8_t hdr[SPILL_HEADER_SIZE] = {
+        SPILL_MAGIC, SPILL_STATE_PENDING, (uint8_t)topic_len, msg->qos,
+        (uint8_t)(msg->len & 0xFF), (uint8_t)(msg->len >> 8),
+    };
+    uint32_t off = s_spill.write_off;
+    if (esp_partition_write(s_spill.part, off, hdr, sizeof(hdr)) != ESP_OK ||
+        esp_partition_write(s_spill.part, off + SPILL_HEADER_SIZE, msg->topic, topic_len) != ESP_OK ||
+        (msg->len > 0 &&
+         esp_partition_write(s_spill.part, off + SPILL_HEADER_SIZE + topic_len, msg->data, msg->len) != ESP_OK)) {
+        ESP_LOGE(TAG, "Spill write failed at 0x%x", (unsigned)off);
+        return false;
+    }
+
+    if (s_spill.count == 0) {
+        s_spill.read_off = off;
+    }
+    s_spill.write_off = off + rec_len;
+    s_spill.count++;
+    return true;
+}
+
+/**
+ * @brief 读取溢出分区最早的一条待发送记录
+ *
+ * @param[out] msg 读出的消息（调用方负责释放）
+ * @param[out] rec_len 记录总长度
+ * @return true 读取成功
+ */
+static bool spill_peek(outbox_msg_t *msg, uint32_t *rec_len)
+{
+    uint8_t hdr[SPILL_HEADER_SIZE];
+    if (esp_partition_read(s_spill.part, s_spill.read_off, hdr, sizeof(hdr)) != ESP_OK ||
+        hdr[0] != SPILL_MAGIC) {
+        return false;
+    }
+
+    size_t topic_len = hdr[2];
+    size_t len = hdr[4] | ((size_t)hdr[5] << 8);
+    char *block = malloc(topic_len + 1 + len);
+    if (block == NULL) {
+        return false;
+    }
+    if (esp_partition_read(s_spill.part, s_spill.read_off + SPILL_HEADER_SIZE, block, topic_len + len) != ESP_OK) {
+        free(block);
+        return false;
+    }
+
+    // 记录中topic后紧跟负载，补结束符时把负载后移一个字节
+    memmove(block + topic_len + 1, block + topic_len, len);
+    block[topic_len] = '\0';
+    msg->topic = block;
+    msg->data = (uint8_t *)block + topic_len + 1;
+    msg->len = (uint16_t)len;
+    msg->qos = hdr[3];
+    msg->coalesce = false;
+    *rec_len = SPILL_HEADER_SIZE + topic_len + len;
+    return true;
+}
+
+/**
+ * @brief 扫描溢出分区，恢复读写位置和待发送条数
+ */
+static void spill_scan(void)
+{
+    uint32_t off = 0;
+    bool found = false;
+    s_spill.count = 0;
+
+    while (off + SPILL_HEADER_SIZE <= s_spill.part->size) {
+        uint8_t hdr[SPILL_HEADER_SIZE];
+        if (esp_partition_read(s_spill.part, off, hdr, sizeof(hdr)) != ESP_OK || hdr[0] == 0xFF) {
+            break;
+        }
+        if (hdr[0] != SPILL_MAGIC) {
+            // 写入中途掉电等原因导致日志损坏，清空重来
+            ESP_LOGW(TAG, "Spill log corrupted at 0x%x, erasing", (unsigned)off);
+            esp_partition_erase_range(s_spill.part, 0, s_spill.part->size);
+            off = 0;
+            found = false;
+            s_spill.count = 0;
+            break;
+        }
+        if (hdr[1] == SPILL_STATE_PENDING) {
+            if (!found) {
+                s_spill.read_off = off;
+                found = true;
+            }
+            s_spill.count++;
+        }
+        off += SPILL_HEADER_SIZE + hdr[2] + (hdr[4] | ((uint32_t)hdr[5] << 8));
+    }
+
+    s_spill.write_off = off;
+    if (!found) {
+        s_spill.read_off = off;
+    }
+    if (s_spill.count > 0) {
+        ESP_LOGI(TAG, "Recovered %u spilled messages", (unsigned)s_spill.count);
+    }
+}
+
+/**
+ * @brief 溢出分区已全部发出时整片擦除（在不持锁的情况下执行擦除）
+ */
+static void spill_reset_if_drained(void)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool need = s_spill.part != NULL && s_spill.count == 0 && s_spill.write_off > 0 && !s_spill.erasing;
+    if (need) {
+        s_spill.erasing = true;
+    }
+    xSemaphoreGive(s_lock);
+    if (!need) {
+        return;
+    }
+
+    esp_partition_erase_range(s_spill.part, 0, s_spill.part->size);
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_spill.read_off = 0;
+    s_spill.write_off = 0;
+    s_spill.erasing = false;
+    xSemaphoreGive(s_lock);
+}
+
+/**
+ * @brief RAM已满时腾出队首：转存到溢出分区，否则丢弃
+ */
+static void ring_evict_oldest(void)
+{
+    outbox_msg_t *oldest = ring_at(0);
+    if (!spill_enabled() || !spill_append(oldest)) {
+        s_dropped++;
+        ESP_LOGW(TAG, "Outbox full, drop message on %s (dropped=%u)", oldest->topic, (unsigned)s_dropped);
+    }
+    msg_free(oldest);
+    s_head = (s_head + 1) % s_capacity;
+    s_count--;
+}
+
+/* ========================================================================== */
+/*                                内部API实现                                   */
+/* ========================================================================== */
+
+esp_err_t mqtt_outbox_init(const mqtt_outbox_config_t *config)
+{
+    if (config == NULL || config->capacity <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_ring != NULL) {
+        return ESP_OK;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    s_ring = calloc(config->capacity, sizeof(outbox_msg_t));
+    if (s_lock == NULL || s_ring == NULL) {
+        mqtt_outbox_deinit();
+        return ESP_ERR_NO_MEM;
+    }
+    s_capacity = config->capacity;
+    s_head = 0;
+    s_count = 0;
+
+    memset(&s_spill, 0, sizeof(s_spill));
+    if (config->spill_partition != NULL) {
+        s_spill.part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                config->spill_partition);
+        if (s_spill.part == NULL) {
+            ESP_LOGW(TAG, "Spill partition '%s' not found, RAM only", config->spill_partition);
+        } else {
+            spill_scan();
+        }
+    }
+
+    ESP_LOGI(TAG, "Outbox ready: capacity=%d, spill=%s", s_capacity,
+             (s_spill.part != NULL) ? s_spill.part->label : "none");
+    return ESP_OK;
+}
+
+void mqtt_outbox_deinit(void)
+{
+    if (s_ring != NULL) {
+        for (int i = 0; i < s_count; i++) {
+            msg_free(ring_at(i));
+        }
+        free(s_ring);
+        s_ring = NULL;
+    }
+    if (s_lock != NULL) {
+        vSemaphoreDelete(s_lock);
+        s_lock = NULL;
+    }
+    s_capacity = 0;
+    s_count = 0;
+    s_head = 0;
+    memset(&s_spill, 0, sizeof(s_spill));
+}
+
+esp_err_t mqtt_outbox_push(const char *topic, const void *data, size_t len, int qos, bool coalesce)
+{
+    if (s_ring == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (topic == NULL || strlen(topic) > MQTT_OUTBOX_TOPIC_MAX || len > MQTT_OUTBOX_PAYLOAD_MAX ||
+        (len > 0 && data == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    // 状态类消息只保留最新值，原地替换，保持在队列中的位置
+    if (coalesce) {
+        for (int i = 0; i < s_count; i++) {
+            outbox_msg_t *msg = ring_at(i);
+            if (msg->coalesce && strcmp(msg->topic, topic) == 0) {
+                outbox_msg_t fresh;
+                if (msg_fill(&fresh, topic, data, len, qos, true)) {
+                    msg_free(msg);
+                    *msg = fresh;
+                } else {
+                    ret = ESP_ERR_NO_MEM;
+                }
+                xSemaphoreGive(s_lock);
+                return ret;
+            }
+        }
+    }
+
+    if (s_count == s_capacity) {
+        ring_evict_oldest();
+    }
+    if (!msg_fill(ring_at(s_count), topic, data, len, qos, coalesce)) {
+        ret = ESP_ERR_NO_MEM;
+    } else {
+        s_count++;
+    }
+
+    xSemaphoreGive(s_lock);
+    return ret;
+}
+
+int mqtt_outbox_flush(mqtt_outbox_send_t send, int max)
+{
+    if (s_ring == NULL || send == NULL) {
+        return 0;
+    }
+
+    int sent = 0;
+    while (sent < max) {
+        outbox_msg_t msg;
+        uint32_t rec_len = 0;
+        uint32_t rec_off = 0;
+        bool from_spill = false;
+
+        // 取出队首：落盘的消息更早，先发
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        if (s_spill.part != NULL && s_spill.count > 0 && !s_spill.erasing) {
+            if (!spill_peek(&msg, &rec_len)) {
+                // 记录无法读出，放弃剩余日志
+                ESP_LOGE(TAG, "Spill read failed, discard %u messages", (unsigned)s_spill.count);
+                s_dropped += s_spill.count;
+                s_spill.count = 0;
+                xSemaphoreGive(s_lock);
+                continue;
+            }
+            rec_off = s_spill.read_off;
+            from_spill = true;
+        } else if (s_count > 0) {
+            msg = *ring_at(0);
+            ring_at(0)->topic = NULL;
+            s_head = (s_head + 1) % s_capacity;
+            s_count--;
+        } else {
+            xSemaphoreGive(s_lock);
+            break;
+        }
+        xSemaphoreGive(s_lock);
+
+        // 发送时不持锁，避免网络阻塞发布者
+        esp_err_t err = send(msg.topic, msg.data, msg.len, msg.qos);
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        if (from_spill) {
+            if (err == ESP_OK) {
+                uint8_t state = SPILL_STATE_SENT;
+                esp_partition_write(s_spill.part, rec_off + 1, &state, 1);
+                s_spill.read_off = rec_off + rec_len;
+                s_spill.count--;
+            }
+            msg_free(&msg);
+        } else if (err != ESP_OK) {
+            // 放回队首；期间队列被写满时直接丢弃最旧的这条
+            if (s_count < s_capacity) {
+                s_head = (s_head + s_capacity - 1) % s_capacity;
+                *ring_at(0) = msg;
+                s_count++;
+            } else {
+                s_dropped++;
+                msg_free(&msg);
+            }
+        } else {
+            msg_free(&msg);
+        }
+        xSemaphoreGive(s_lock);
+
+        if (err != ESP_OK) {
+            break;
+        }
+        sent++;
+    }
+
+    spill_reset_if_drained();
+    return sent;
+}
+
+size_t mqtt_outbox_pending(void)
+{
+    if (s_ring == NULL) {
+        return 0;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    size_t pending = (size_t)s_count + s_spill.count;
+    xSemaphoreGive(s_lock);
+    return pending;
+}
@@ -0,0 +1,103 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-24
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\mqtt_outbox.h
+ * @Description: MQTT发送队列头文件 - 离线缓存、状态合并、限速补发（mqtt_manager内部使用）
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved.
+ */
+
+#ifndef MQTT_OUTBOX_H                               // 防止头文件重复包含
+#define MQTT_OUTBOX_H                               // 定义头文件宏
+
+#include "esp_err.h"                                // 包含ESP错误码定义
+#include <stdbool.h>                                // 包含布尔类型定义
+#include <stddef.h>                                 // 包含size_t定义
+
+#ifdef __cplusplus                                  // 如果是C++编译器
+extern "C" {                                        // 使用C链接约定
+#endif                                              // 结束C++编译器判断
+
+/* ========================================================================== */
+/*                              配置与类型定义                                  */
+/* ========================================================================== */
+
+#define MQTT_OUTBOX_TOPIC_MAX       128             // 可缓存消息的Topic最大长度
+#define MQTT_OUTBOX_PAYLOAD_MAX     4096            // 可缓存消息的负载最大长度
+
+/**
+ * @brief 发送队列配置
+ */
+typedef struct {
+    int          capacity;                          // RAM环形缓冲可容纳的消息条数
+    const char  *spill_partition;                   // 溢出落盘的数据分区标签，NULL表示只用RAM
+} mqtt_outbox_config_t;
+
+/**
+ * @brief 消息发送函数原型
+ *
+ * @return ESP_OK 已交给客户端；其他值表示发送失败，消息保留在队列中
+ */
+typedef esp_err_t (*mqtt_outbox_send_t)(const char *topic, const void *data, int len, int qos);
+
+/* ========================================================================== */
+/*                                内部API                                      */
+/* ========================================================================== */
+
+/**
+ * @brief 初始化发送队列
+ *
+ * 配置了溢出分区时扫描分区，恢复上次重启前尚未发出的消息。
+ *
+ * @param config 队列配置
+ * @return
+ *      - ESP_OK              : 成功（溢出分区不存在时仅告警，退化为只用RAM）
+ *      - ESP_ERR_INVALID_ARG : capacity无效
+ *      - ESP_ERR_NO_MEM      : 内存不足
+ */
+esp_err_t mqtt_outbox_init(const mqtt_outbox_config_t *config);
+
+/**
+ * @brief 释放发送队列，丢弃RAM中的消息（已落盘的消息保留）
+ */
+void mqtt_outbox_deinit(void);
+
+/**
+ * @brief 消息入队
+ *
+ * RAM已满时最旧的消息转存到溢出分区；未配置分区或分区已满时丢弃最旧的消息。
+ *
+ * @param topic    Topic
+ * @param data     负载
+ * @param len      负载长度
+ * @param qos      服务质量
+ * @param coalesce 是否合并：队列中已有同Topic的待合并消息时只保留最新负载
+ * @return
+ *      - ESP_OK              : 已入队
+ *      - ESP_ERR_INVALID_ARG : Topic或负载超长
+ *      - ESP_ERR_NO_MEM      : 内存不足
+ *      - ESP_ERR_INVALID_STATE: 未初始化
+ */
+esp_err_t mqtt_outbox_push(const char *topic, const void *data, size_t len, int qos, bool coalesce);
+
+/**
+ * @brief 按先落盘、后RAM的顺序发送最多 max 条消息
+ *
+ * 在发送任务中调用；发送失败的消息保留在队首，下次继续。
+ *
+ * @param send 发送函数
+ * @param max  本次最多发送的条数
+ * @return int 实际发送的条数
+ */
+int mqtt_outbox_flush(mqtt_outbox_send_t send, int max);
+
+/**
+ * @brief 待发送消息条数（RAM与溢出分区之和）
+ */
+size_t mqtt_outbox_pending(void);
+
+#ifdef __cplusplus                                  // 如果是C++编译器
+}
+#endif                                              // 结束C++编译器判断
+
+#endif /* MQTT_OUTBOX_H */                          // 结束头文件保护
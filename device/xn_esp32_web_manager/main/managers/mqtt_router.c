@@ -0,0 +1,400 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-24
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\mqtt_router.c
+ * @Description: MQTT Topic路由实现 - 每个节点对应过滤器的一层
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved.
+ */
+
+#include <string.h>                                 // 字符串处理函数
+#include <stdlib.h>                                 // 内存分配
+#include "freertos/FreeRTOS.h"                      // FreeRTOS核心头文件
+#include "freertos/semphr.h"                        // FreeRTOS互斥锁
+#include "esp_log.h"                                // ESP日志模块
+#include "mqtt_router.h"                            // 本模块头文件
+
+/* 日志TAG */
+static const char *TAG = "mqtt_router";             // 本模块日志TAG
+
+/* ========================================================================== */
+/*                              内部类型与变量                                   */
+/* ========================================================================== */
+
+/**
+ * @brief 过滤器上注册的一个处理函数
+ */
+typedef struct route_handler {
+    mqtt_router_handler_t    handler;               // 处理函数
+    void                    *user_data;             // 用户数据
+    struct route_handler    *next;                  // 同一过滤器的下一个处理函数
+} route_handler_t;
+
+/**
+ * @brief 字典树节点，level 为本层内容（"+"、"#" 或普通字符串）
+ */
+typedef struct route_node {
+    struct route_node       *child;                 // 第一个子节点
+    struct route_node       *next;                  // 下一个兄弟节点
+    route_handler_t         *handlers;              // 在本层结束的过滤器的处理函数
+    char                    *filter;                // 有处理函数时保存完整过滤器，用于重新订阅
+    int                      qos;                   // 订阅QoS
+    char                     level[];               // 本层内容
+} route_node_t;
+
+/**
+ * @brief 一次匹配的结果
+ */
+typedef struct {
+    route_handler_t          hits[MQTT_ROUTER_MAX_MATCH]; // 匹配到的处理函数（拷贝）
+    int                      count;                 // 匹配数量
+} route_match_t;
+
+static SemaphoreHandle_t s_lock = NULL;             // 路由表保护锁
+static route_node_t     *s_root = NULL;             // 根节点（不对应任何层）
+
+/* ========================================================================== */
+/*                              内部函数                                        */
+/* ========================================================================== */
+
+/**
+ * @brief 创建节点
+ */
+static route_node_t *node_new(const char *level, size_t len)
+{
+    route_node_t *node = calloc(1, sizeof(route_node_t) + len + 1);
+    if (node != NULL) {
+        memcpy(node->level, level, len);
+        node->level[len] = '\0';
+    }
+    return node;
+}
+
+/**
+ * @brief 递归释放节点及其子树
+ */
+static void node_free(route_node_t *node)
+{
+    while (node != NULL) {
+        route_node_t *next = node->next;
+        node_free(node->child);
+        for (route_handler_t *h = node->handlers; h != NULL;) {
+            route_handler_t *h_next = h->next;
+            free(h);
+            h = h_next;
+        }
+        free(node->filter);
+        free(node);
+        node = next;
+    }
+}
+
+/**
+ * @brief 本层内容是否与节点相同
+ */
+static bool level_equal(const route_node_t *node, const char *level, size_t len)
+{
+    return strlen(node->level) == len && memcmp(node->level, level, len) == 0;
+}
+
+/**
+ * @brief 查找子节点，create 为 true 时不存在则创建
+ */
+static route_node_t *node_child(route_node_t *parent, const char *level, size_t len, bool create)
+{
+    for (route_node_t *c = parent->child; c != NULL; c = c->next) {
+        if (level_equal(c, level, len)) {
+            return c;
+        }
+    }
+    if (!create) {
+        return NULL;
+    }
+    route_node_t *c = node_new(level, len);
+    if (c != NULL) {
+        c->next = parent->child;
+        parent->child = c;
+    }
+    return c;
+}
+
+/**
+ * @brief 校验过滤器：通配符必须独占一层，'#' 只能在末层
+ */
+static bool filter_valid(const char *filter)
+{
+    if (filter == NULL || filter[0] == '\0') {
+        return false;
+    }
+    const char *level = filter;
+    for (;;) {
+        const char *slash = strchr(level, '/');
+        size_t len = (slash != NULL) ? (size_t)(slash - level) : strlen(level);
+        for (size_t i = 0; i < len; i++) {
+            if ((level[i] == '+' || level[i] == '#') && len != 1) {
+                return false;
+            }
+        }
+        if (len == 1 && level[0] == '#' && slash != NULL) {
+            return false;
+        }
+        if (slash == NULL) {
+            return true;
+        }
+        level = slash + 1;
+    }
+}
+
+/**
+ * @brief 沿过滤器各层找到末层节点
+ */
+static route_node_t *node_lookup(const char *filter, bool create)
+{
+    route_node_t *node = s_root;
+    const char *level = filter;
+    while (node != NULL) {
+        const char *slash = strchr(level, '/');
+        size_t len = (slash != NULL) ? (size_t)(slash - level) : strlen(level);
+        node = node_child(node, level, len, create);
+        if (slash == NULL) {
+            break;
+        }
+        level = slash + 1;
+    }
+    return node;
+}
+
+/**
+ * @brief 收集节点上的处理函数
+ */
+static void match_collect(const route_node_t *node, route_match_t *match)
+{
+    for (const route_handler_t *h = node->handlers; h != NULL; h = h->next) {
+        if (match->count >= MQTT_ROUTER_MAX_MATCH) {
+            ESP_LOGW(TAG, "Too many handlers for one topic, extra ignored");
+            return;
+        }
+        match->hits[match->count++] = *h;
+    }
+}
+
+/**
+ * @brief 从 node 的子节点开始匹配 Topic 剩余的层
+ *
+ * @param node 已匹配到的节点
+ * @param rest 剩余层的起始
+ * @param end  Topic 结尾
+ * @param done 是否已没有剩余层
+ */
+static void match_levels(const route_node_t *node, const char *rest, const char *end, bool done,
+                         route_match_t *match)
+{
+    if (done) {
+        match_collect(node, match);
+        // "a/#" 也匹配 "a" 本身
+        for (const route_node_t *c = node->child; c != NULL; c = c->next) {
+            if (level_equal(c, "#", 1)) {
+                match_collect(c, match);
+            }
+        }
+        return;
+    }
+
+    const char *slash = memchr(rest, '/', end - rest);
+    const char *seg_end = (slash != NULL) ? slash : end;
+    size_t seg_len = seg_end - rest;
+
+    for (const route_node_t *c = node->child; c != NULL; c = c->next) {
+        if (level_equal(c, "#", 1)) {
+            match_collect(c, match);
+        } else if (level_equal(c, "+", 1) || level_equal(c, rest, seg_len)) {
+            match_levels(c, (slash != NULL) ? slash + 1 : end, end, slash == NULL, match);
+        }
+    }
+}
+
+/**
+ * @brief 深度优先收集有处理函数的过滤器并分批订阅
+ */
+static esp_err_t resubscribe_walk(const route_node_t *node, mqtt_router_subscribe_t subscribe,
+                                  const char **filters, int *qos, int *count, int batch_max)
+{
+    esp_err_t ret = ESP_OK;
+    for (; node != NULL; node = node->next) {
+        if (node->handlers != NULL) {
+            filters[*count] = node->filter;
+            qos[*count] = node->qos;
+            if (++(*count) == batch_max) {
+                esp_err_t err = subscribe(filters, qos, *count);
+                ret = (ret == ESP_OK) ? err : ret;
+                *count = 0;
+            }
+        }
+        esp_err_t err = resubscribe_walk(node->child, subscribe, filters, qos, count, batch_max);
+        ret = (ret == ESP_OK) ? err : ret;
+    }
+    return ret;
+}
+
+/* ========================================================================== */
+/*                                内部API实现                                   */
+/* ========================================================================== */
+
+esp_err_t mqtt_router_init(void)
+{
+    if (s_root != NULL) {
+        return ESP_OK;
+    }
+    s_lock = xSemaphoreCreateMutex();
+    s_root = node_new("", 0);
+    if (s_lock == NULL || s_root == NULL) {
+        mqtt_router_deinit();
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void mqtt_router_deinit(void)
+{
+    node_free(s_root);
+    s_root = NULL;
+    if (s_lock != NULL) {
+        vSemaphoreDelete(s_lock);
+        s_lock = NULL;
+    }
+}
+
+esp_err_t mqtt_router_add(const char *filter, int qos, mqtt_router_handler_t handler,
+                          void *user_data, bool *first)
+{
+    if (s_root == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!filter_valid(filter) || handler == NULL || qos < 0 || qos > 2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    *first = false;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    route_node_t *node = node_lookup(filter, true);
+    route_handler_t *h = NULL;
+    if (node == NULL) {
+        ret = ESP_ERR_NO_MEM;
+        goto out;
+    }
+    for (h = node->handlers; h != NULL; h = h->next) {
+        if (h->handler == handler) {
+            ret = ESP_ERR_INVALID_STATE;
+            goto out;
+        }
+    }
+
+    // 第一个处理函数：保存完整过滤器用于重连后重新订阅
+    *first = (node->handlers == NULL);
+    if (*first) {
+        node->filter = strdup(filter);
+        node->qos = qos;
+        if (node->filter == NULL) {
+            ret = ESP_ERR_NO_MEM;
+            goto out;
+        }
+    } else if (qos > node->qos) {
+        node->qos = qos;
+    }
+
+    h = calloc(1, sizeof(route_handler_t));
+    if (h == NULL) {
+        if (*first) {
+            free(node->filter);
+            node->filter = NULL;
+        }
+        ret = ESP_ERR_NO_MEM;
+        goto out;
+    }
+    h->handler = handler;
+    h->user_data = user_data;
+    h->next = node->handlers;
+    node->handlers = h;
+
+out:
+    xSemaphoreGive(s_lock);
+    return ret;
+}
+
+esp_err_t mqtt_router_remove(const char *filter, mqtt_router_handler_t handler, bool *last)
+{
+    if (s_root == NULL || filter == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    *last = false;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    // 节点本身保留，再次注册时复用
+    route_node_t *node = node_lookup(filter, false);
+    if (node != NULL) {
+        for (route_handler_t **pp = &node->handlers; *pp != NULL; pp = &(*pp)->next) {
+            if ((*pp)->handler == handler) {
+                route_handler_t *h = *pp;
+                *pp = h->next;
+                free(h);
+                ret = ESP_OK;
+                break;
+            }
+        }
+        *last = (ret == ESP_OK && node->handlers == NULL);
+        if (*last) {
+            free(node->filter);
+            node->filter = NULL;
+        }
+    }
+
+    xSemaphoreGive(s_lock);
+    return ret;
+}
+
+int mqtt_router_dispatch(const char *topic, int topic_len, const uint8_t *payload, int payload_len)
+{
+    if (s_root == NULL || topic == NULL) {
+        return 0;
+    }
+
+    route_match_t match;
+    match.count = 0;
+
+    // 持锁只做匹配，回调时不持锁，处理函数中可以注册/注销路由
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    match_levels(s_root, topic, topic + topic_len, false, &match);
+    xSemaphoreGive(s_lock);
+
+    for (int i = 0; i < match.count; i++) {
+        match.hits[i].handler(topic, topic_len, payload, payload_len, match.hits[i].user_data);
+    }
+    return match.count;
+}
+
+esp_err_t mqtt_router_resubscribe(mqtt_router_subscribe_t subscribe, int batch_max)
+{
+    if (s_root == NULL || subscribe == NULL || batch_max <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (batch_max > MQTT_ROUTER_BATCH_MAX) {
+        batch_max = MQTT_ROUTER_BATCH_MAX;
+    }
+    const char *filters[MQTT_ROUTER_BATCH_MAX];
+    int qos[MQTT_ROUTER_BATCH_MAX];
+    int count = 0;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    esp_err_t ret = resubscribe_walk(s_root->child, subscribe, filters, qos, &count, batch_max);
+    if (count > 0) {
+        esp_err_t err = subscribe(filters, qos, count);
+        ret = (ret == ESP_OK) ? err : ret;
+    }
+    xSemaphoreGive(s_lock);
+    return ret;
+}
@@ -0,0 +1,110 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-24
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\mqtt_router.h
+ * @Description: MQTT Topic路由头文件 - 按层级字典树匹配 +/# 通配（mqtt_manager内部使用）
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved.
+ */
+
+#ifndef MQTT_ROUTER_H                               // 防止头文件重复包含
+#define MQTT_ROUTER_H                               // 定义头文件宏
+
+#include "esp_err.h"                                // 包含ESP错误码定义
+#include <stdbool.h>                                // 包含布尔类型定义
+#include <stdint.h>                                 // 包含标准整型定义
+
+#ifdef __cplusplus                                  // 如果是C++编译器
+extern "C" {                                        // 使用C链接约定
+#endif                                              // 结束C++编译器判断
+
+/* ========================================================================== */
+/*                              配置与类型定义                                  */
+/* ========================================================================== */
+
+#define MQTT_ROUTER_MAX_MATCH       8               // 单条消息最多分发的处理函数个数
+#define MQTT_ROUTER_BATCH_MAX       16              // 重新订阅时每批最多的过滤器个数
+
+/**
+ * @brief Topic处理函数原型（在MQTT客户端任务中调用）
+ */
+typedef void (*mqtt_router_handler_t)(const char *topic, int topic_len,
+                                      const uint8_t *payload, int payload_len, void *user_data);
+
+/**
+ * @brief 订阅提交函数原型，用于重连后批量重新订阅
+ *
+ * @param filters 过滤器数组
+ * @param qos     对应的QoS数组
+ * @param count   数量
+ */
+typedef esp_err_t (*mqtt_router_subscribe_t)(const char *const *filters, const int *qos, int count);
+
+/* ========================================================================== */
+/*                                内部API                                      */
+/* ========================================================================== */
+
+/**
+ * @brief 初始化路由表
+ *
+ * @return
+ *      - ESP_OK        : 成功
+ *      - ESP_ERR_NO_MEM: 内存不足
+ */
+esp_err_t mqtt_router_init(void);
+
+/**
+ * @brief 释放路由表及所有处理函数
+ */
+void mqtt_router_deinit(void);
+
+/**
+ * @brief 注册处理函数
+ *
+ * @param filter  完整的Topic过滤器，可包含 '+'（单层）和末尾的 '#'（多层）
+ * @param qos     订阅QoS，同一过滤器取最大值
+ * @param handler 处理函数
+ * @param user_data 用户数据
+ * @param[out] first 该过滤器此前是否没有任何处理函数（需要发起订阅）
+ * @return
+ *      - ESP_OK              : 成功
+ *      - ESP_ERR_INVALID_ARG : 过滤器非法（'#' 不在末层、通配符与其他字符混用）
+ *      - ESP_ERR_INVALID_STATE: 同一过滤器已注册相同的处理函数
+ *      - ESP_ERR_NO_MEM      : 内存不足
+ */
+esp_err_t mqtt_router_add(const char *filter, int qos, mqtt_router_handler_t handler,
+                          void *user_data, bool *first);
+
+/**
+ * @brief 注销处理函数
+ *
+ * @param filter  注册时的过滤器
+ * @param handler 处理函数
+ * @param[out] last 该过滤器是否已没有处理函数（需要取消订阅）
+ * @return
+ *      - ESP_OK           : 成功
+ *      - ESP_ERR_NOT_FOUND: 未注册
+ */
+esp_err_t mqtt_router_remove(const char *filter, mqtt_router_handler_t handler, bool *last);
+
+/**
+ * @brief 把消息分发给所有匹配的处理函数
+ *
+ * @return int 调用的处理函数个数，0 表示没有匹配的路由
+ */
+int mqtt_router_dispatch(const char *topic, int topic_len, const uint8_t *payload, int payload_len);
+
+/**
+ * @brief 把所有已注册的过滤器分批提交订阅
+ *
+ * @param subscribe 订阅提交函数
+ * @param batch_max 每批最多的过滤器个数，超过 MQTT_ROUTER_BATCH_MAX 时按后者
+ * @return esp_err_t 第一个失败批次的错误码，全部成功返回 ESP_OK
+ */
+esp_err_t mqtt_router_resubscribe(mqtt_router_subscribe_t subscribe, int batch_max);
+
+#ifdef __cplusplus                                  // 如果是C++编译器
+}
+#endif                                              // 结束C++编译器判断
+
+#endif /* MQTT_ROUTER_H */                          // 结束头文件保护
@@ -8,15 +8,25 @@
 
 #include "ota_manager.h"
 #include <string.h>
+#include <stdlib.h>
 #include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "xn_event_bus.h"
 #include "xn_ota.h"
+#include "power_manager.h"
 
 /* 日志TAG */
 static const char *TAG = "ota_manager";
 
+/* 后台升级任务配置 */
+#define OTA_MANAGER_BG_TASK_STACK       8192    // 后台升级任务栈大小
+#define OTA_MANAGER_BG_TASK_PRIORITY    1       // 后台升级任务优先级（低于业务任务）
+#define OTA_MANAGER_REBOOT_DELAY_MS     1000    // 发布重启事件后等待订阅者收尾的时间
+
 /* ========================================================================== */
 /*                              内部变量                                        */
 /* ========================================================================== */
@@ -30,6 +40,10 @@ static xn_ota_version_info_t s_latest_version;      // 最新版本信息
 static xn_ota_auth_status_t s_auth_status = XN_OTA_AUTH_UNKNOWN; // 认证状态
 static char s_activation_code[64] = {0};            // 激活码
 static char s_activation_message[256] = {0};        // 激活消息
+static SemaphoreHandle_t s_upgrade_lock = NULL;     // 检查更新与升级互斥，后台下载期间由下载任务持有
+static volatile bool s_staged = false;              // 新固件已下载完成等待重启
+static int64_t s_staged_time = 0;                   // 新固件就绪的时间(us)
+static power_lock_t s_busy_lock = NULL;             // 前台下载期间保持全速
 
 /* ========================================================================== */
 /*                              内部函数                                        */
@@ -61,6 +75,36 @@ static void ota_progress_callback(int progress, size_t speed)
     }
 }
 
+/**
+ * @brief 获取升级互斥，不等待
+ * 
+ * 用二值信号量而不是互斥锁：后台下载由启动它的任务获取、下载任务结束时释放。
+ * 获取失败说明有升级正在进行（含后台下载），本次检查或升级直接跳过，
+ * 不会改写下载中使用的版本信息，也不会启动第二个升级。
+ */
+static bool ota_manager_lock_try(void)
+{
+    if (xSemaphoreTake(s_upgrade_lock, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Upgrade in progress, request skipped");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 前台升级：下载校验期间持有忙碌锁，保证全速下载
+ * 
+ * 调用者已持有升级互斥。未指定版本时使用检查更新得到的版本副本。
+ */
+static esp_err_t ota_manager_upgrade_busy(const char *version)
+{
+    power_lock_acquire(s_busy_lock);
+    esp_err_t ret = (version == NULL && s_has_update) ? xn_ota_upgrade_to(&s_latest_version)
+                                                      : xn_ota_upgrade(version);
+    power_lock_release(s_busy_lock);
+    return ret;
+}
+
 /**
  * @brief 执行 OTA 流程
  */
@@ -135,12 +179,14 @@ static esp_err_t ota_manager_run_flow(void)
         ESP_LOGI(TAG, "New version available: %s", s_latest_version.version);
         ota_manager_notify_state(OTA_MANAGER_STATE_UPDATE_AVAILABLE);
         
-        // 5. 如果配置了自动升级，执行升级
-        if (s_config.auto_upgrade || s_latest_version.force) {
+        // 5. 如果配置了自动升级，执行升级；后台模式下非强制更新由状态机在就绪后启动下载
+        if (s_config.background_upgrade && !s_latest_version.force) {
+            ESP_LOGI(TAG, "Step 5: Upgrade deferred to background download");
+        } else if (s_config.auto_upgrade || s_latest_version.force) {
             ESP_LOGI(TAG, "Step 5: Starting automatic upgrade");
             ota_manager_notify_state(OTA_MANAGER_STATE_UPGRADING);
             
-            ret = xn_ota_upgrade(NULL);
+            ret = ota_manager_upgrade_busy(NULL);
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "Upgrade failed: %s", esp_err_to_name(ret));
                 ota_manager_notify_state(OTA_MANAGER_STATE_ERROR);
@@ -161,6 +207,40 @@ static esp_err_t ota_manager_run_flow(void)
     return ESP_OK;
 }
 
+/**
+ * @brief 后台升级任务：限速下载，完成后等待合适的时机重启
+ * 
+ * @param arg 目标版本副本（任务结束时释放），任务持有升级互斥直到结束
+ */
+static void ota_manager_bg_task(void *arg)
+{
+    xn_ota_version_info_t *target = (xn_ota_version_info_t *)arg;
+    
+    ESP_LOGI(TAG, "Background download started: %s", target->version);
+    ota_manager_notify_state(OTA_MANAGER_STATE_UPGRADING);
+    
+    // 限速下载大部分时间在等待，不持有忙碌锁，间隙里允许降频和 light sleep
+    xn_ota_set_rate_limit(s_config.bg_rate_limit);
+    esp_err_t ret = xn_ota_upgrade_to(target);
+    xn_ota_set_rate_limit(0);
+    free(target);
+    
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "New firmware staged, waiting for reboot window");
+        s_staged_time = esp_timer_get_time();
+        s_staged = true;
+        ota_manager_notify_state(OTA_MANAGER_STATE_STAGED);
+        xn_event_post(XN_EVT_SYSTEM_OTA_STAGED, XN_EVT_SRC_SYSTEM);
+    } else {
+        // 断点已保存，下次进入就绪状态时继续
+        ESP_LOGW(TAG, "Background download failed: %s", esp_err_to_name(ret));
+        ota_manager_notify_state(OTA_MANAGER_STATE_ERROR);
+    }
+    
+    xSemaphoreGive(s_upgrade_lock);
+    vTaskDelete(NULL);
+}
+
 /* ========================================================================== */
 /*                              公共API实现                                     */
 /* ========================================================================== */
@@ -189,6 +269,7 @@ esp_err_t ota_manager_init(const ota_manager_config_t *config)
     ota_config.server_url = s_config.server_url;
     ota_config.device_type = s_config.device_type;
     ota_config.progress_cb = ota_progress_callback;
+    ota_config.check_jitter_ms = s_config.check_jitter_ms;
     
     esp_err_t ret = xn_ota_init(&ota_config);
     if (ret != ESP_OK) {
@@ -196,6 +277,20 @@ esp_err_t ota_manager_init(const ota_manager_config_t *config)
         return ret;
     }
     
+    if (s_busy_lock == NULL) {
+        ret = power_lock_create("ota", &s_busy_lock);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    if (s_upgrade_lock == NULL) {
+        s_upgrade_lock = xSemaphoreCreateBinary();
+        if (s_upgrade_lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        xSemaphoreGive(s_upgrade_lock);
+    }
+    
     // 初始化状态
     s_state = OTA_MANAGER_STATE_IDLE;
     s_has_update = false;
@@ -229,10 +324,17 @@ esp_err_t ota_manager_start(void)
         return ESP_ERR_INVALID_STATE;
     }
     
+    // 后台下载期间不再检查更新，下载完成或失败后由状态机再次触发
+    if (!ota_manager_lock_try()) {
+        ESP_LOGI(TAG, "Background download in progress, OTA flow skipped");
+        return ESP_OK;
+    }
+    
     ESP_LOGI(TAG, "Starting OTA manager flow");
     
     // 执行 OTA 流程
     esp_err_t ret = ota_manager_run_flow();
+    xSemaphoreGive(s_upgrade_lock);
     
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "OTA flow failed: %s", esp_err_to_name(ret));
@@ -261,9 +363,14 @@ esp_err_t ota_manager_check_update(void)
         return ESP_ERR_INVALID_STATE;
     }
     
+    if (!ota_manager_lock_try()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
     ota_manager_notify_state(OTA_MANAGER_STATE_CHECKING);
     
     esp_err_t ret = xn_ota_check_update(&s_has_update, &s_latest_version);
+    xSemaphoreGive(s_upgrade_lock);
     if (ret != ESP_OK) {
         ota_manager_notify_state(OTA_MANAGER_STATE_ERROR);
         return ret;
@@ -284,10 +391,15 @@ esp_err_t ota_manager_upgrade(const char *version)
         return ESP_ERR_INVALID_STATE;
     }
     
+    if (!ota_manager_lock_try()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
     ota_manager_notify_state(OTA_MANAGER_STATE_UPGRADING);
     
-    esp_err_t ret = xn_ota_upgrade(version);
+    esp_err_t ret = ota_manager_upgrade_busy(version);
     if (ret != ESP_OK) {
+        xSemaphoreGive(s_upgrade_lock);
         ota_manager_notify_state(OTA_MANAGER_STATE_ERROR);
         return ret;
     }
@@ -301,6 +413,69 @@ esp_err_t ota_manager_upgrade(const char *version)
     return ESP_OK;
 }
 
+esp_err_t ota_manager_start_background(void)
+{
+    if (!s_initialized || !s_has_update || s_staged) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // 升级互斥交给下载任务，任务结束时释放；已在下载时获取失败
+    if (xSemaphoreTake(s_upgrade_lock, 0) != pdTRUE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // 下载任务使用目标版本的副本，不受之后的检查更新影响
+    xn_ota_version_info_t *target = malloc(sizeof(xn_ota_version_info_t));
+    if (target == NULL) {
+        xSemaphoreGive(s_upgrade_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(target, &s_latest_version, sizeof(xn_ota_version_info_t));
+    
+    if (xTaskCreate(ota_manager_bg_task, "ota_bg", OTA_MANAGER_BG_TASK_STACK, target,
+                    OTA_MANAGER_BG_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create background upgrade task");
+        free(target);
+        xSemaphoreGive(s_upgrade_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    return ESP_OK;
+}
+
+bool ota_manager_is_staged(void)
+{
+    return s_staged;
+}
+
+bool ota_manager_reboot_allowed(void)
+{
+    if (!s_staged) {
+        return false;
+    }
+    if (s_config.idle_cb == NULL || s_config.idle_cb()) {
+        return true;
+    }
+    
+    // 设备一直忙碌时，超过最长推迟时间也要重启
+    int64_t waited_ms = (esp_timer_get_time() - s_staged_time) / 1000;
+    return s_config.reboot_max_delay_ms > 0 && waited_ms >= s_config.reboot_max_delay_ms;
+}
+
+esp_err_t ota_manager_apply_staged(void)
+{
+    if (!s_staged) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    ESP_LOGI(TAG, "Rebooting to apply firmware %s", s_latest_version.version);
+    xn_event_post(XN_EVT_SYSTEM_REBOOT, XN_EVT_SRC_SYSTEM);
+    vTaskDelay(pdMS_TO_TICKS(OTA_MANAGER_REBOOT_DELAY_MS));
+    esp_restart();
+    
+    return ESP_OK;
+}
+
 ota_manager_state_t ota_manager_get_state(void)
 {
     return s_state;
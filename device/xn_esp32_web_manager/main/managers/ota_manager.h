@@ -34,6 +34,7 @@ typedef enum {
     OTA_MANAGER_STATE_AUTH_ACTIVATING,  ///< 激活中
     OTA_MANAGER_STATE_COMPLETED,        ///< 完成
     OTA_MANAGER_STATE_ERROR,            ///< 错误
+    OTA_MANAGER_STATE_STAGED,           ///< 新固件已后台下载完成，等待重启
 } ota_manager_state_t;
 
 /**
@@ -41,6 +42,14 @@ typedef enum {
  */
 typedef void (*ota_manager_state_cb_t)(ota_manager_state_t state);
 
+/**
+ * @brief 设备空闲判断回调函数类型
+ * 
+ * @return true 设备空闲，可以重启
+ * @return false 设备正在工作，推迟重启
+ */
+typedef bool (*ota_manager_idle_cb_t)(void);
+
 /**
  * @brief OTA 管理器配置结构体
  */
@@ -51,6 +60,11 @@ typedef struct {
     bool check_on_boot;                 ///< 启动时检查更新
     ota_manager_state_cb_t state_cb;    ///< 状态回调
     xn_ota_progress_cb_t progress_cb;   ///< 升级进度回调
+    uint32_t check_jitter_ms;           ///< 检查更新前的随机等待上限（毫秒）
+    bool background_upgrade;            ///< 非强制更新在后台下载，不阻塞正常业务
+    uint32_t bg_rate_limit;             ///< 后台下载限速（字节/秒），0 不限速
+    ota_manager_idle_cb_t idle_cb;      ///< 设备空闲判断（可选，NULL 视为始终空闲）
+    uint32_t reboot_max_delay_ms;       ///< 固件就绪后最多推迟重启的时间（毫秒），0 表示只在空闲时重启
 } ota_manager_config_t;
 
 /**
@@ -64,6 +78,11 @@ typedef struct {
         .check_on_boot = true, \
         .state_cb = NULL, \
         .progress_cb = NULL, \
+        .check_jitter_ms = 5000, \
+        .background_upgrade = true, \
+        .bg_rate_limit = 32 * 1024, \
+        .idle_cb = NULL, \
+        .reboot_max_delay_ms = 6 * 60 * 60 * 1000, \
     }
 
 /* ========================================================================== */
@@ -97,9 +116,12 @@ esp_err_t ota_manager_deinit(void);
  * 3. 如果需要激活，执行激活流程
  * 4. 检查固件更新
  * 5. 如果有更新且配置了自动升级，执行升级
+ *    （开启 background_upgrade 时非强制更新留给 ota_manager_start_background）
+ * 
+ * 后台下载进行中时跳过整个流程直接返回 ESP_OK。
  * 
  * @return esp_err_t 
- *      - ESP_OK: 成功
+ *      - ESP_OK: 成功（或后台下载进行中，已跳过）
  *      - ESP_FAIL: 失败
  */
 esp_err_t ota_manager_start(void);
@@ -117,6 +139,7 @@ esp_err_t ota_manager_stop(void);
  * 
  * @return esp_err_t 
  *      - ESP_OK: 成功
+ *      - ESP_ERR_INVALID_STATE: 未初始化或有升级正在进行（含后台下载）
  *      - ESP_FAIL: 失败
  */
 esp_err_t ota_manager_check_update(void);
@@ -127,10 +150,54 @@ esp_err_t ota_manager_check_update(void);
  * @param version 目标版本号，NULL 表示升级到最新版本
  * @return esp_err_t 
  *      - ESP_OK: 成功
+ *      - ESP_ERR_INVALID_STATE: 未初始化或有升级正在进行（含后台下载）
  *      - ESP_FAIL: 失败
  */
 esp_err_t ota_manager_upgrade(const char *version);
 
+/**
+ * @brief 在后台下载可用更新
+ * 
+ * 创建低优先级任务并按 bg_rate_limit 限速下载，调用方立即返回。
+ * 下载完成后进入 OTA_MANAGER_STATE_STAGED 并发布 XN_EVT_SYSTEM_OTA_STAGED，
+ * 新固件在下次重启时生效；下载失败时断点保留，再次调用从断点继续。
+ * 下载使用调用时的最新版本副本；下载期间检查更新与其他升级请求都被拒绝。
+ * 
+ * @return esp_err_t 
+ *      - ESP_OK: 后台任务已启动
+ *      - ESP_ERR_INVALID_STATE: 未初始化、没有可用更新、已在下载或已下载完成
+ *      - ESP_ERR_NO_MEM: 任务创建失败
+ */
+esp_err_t ota_manager_start_background(void);
+
+/**
+ * @brief 新固件是否已下载完成等待重启
+ * 
+ * @return true 已就绪
+ * @return false 未就绪
+ */
+bool ota_manager_is_staged(void);
+
+/**
+ * @brief 现在是否适合重启以应用新固件
+ * 
+ * idle_cb 返回空闲，或固件就绪后已推迟超过 reboot_max_delay_ms 时允许重启。
+ * 
+ * @return true 允许重启
+ * @return false 固件未就绪或设备正忙
+ */
+bool ota_manager_reboot_allowed(void);
+
+/**
+ * @brief 重启以应用已下载的新固件
+ * 
+ * 发布 XN_EVT_SYSTEM_REBOOT 后稍作等待再重启，成功时不返回。
+ * 
+ * @return esp_err_t 
+ *      - ESP_ERR_INVALID_STATE: 没有已下载完成的固件
+ */
+esp_err_t ota_manager_apply_staged(void);
+
 /**
  * @brief 获取当前状态
  * 
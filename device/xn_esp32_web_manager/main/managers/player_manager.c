@@ -0,0 +1,117 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-26 14:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-26 14:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\player_manager.c
+ * @Description: 播放管理器实现 - 下行语音包路由到 xn_player，播放状态转换为事件总线事件
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#include <stdio.h>
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "player_manager.h"
+
+#if CONFIG_XN_PLAYER_ENABLE
+#include "xn_player.h"
+#include "xn_event_bus.h"
+#include "mqtt_manager.h"
+#endif
+
+static const char *TAG = "player_manager";
+
+#if CONFIG_XN_PLAYER_ENABLE
+/**
+ * @brief 播放事件回调（播放任务中执行，只投递事件）
+ */
+static void on_player_event(xn_player_event_t event, const xn_player_stats_t *stats, void *user_data)
+{
+    (void)user_data;
+
+    static const uint16_t s_event_map[] = {
+        [XN_PLAYER_EVENT_START]    = XN_EVT_AUDIO_PLAYBACK_START,
+        [XN_PLAYER_EVENT_UNDERRUN] = XN_EVT_AUDIO_PLAYBACK_UNDERRUN,
+        [XN_PLAYER_EVENT_END]      = XN_EVT_AUDIO_PLAYBACK_END,
+    };
+    xn_evt_audio_playback_t data = {
+        .session = stats->session,
+        .frames_played = stats->frames_played,
+        .underruns = stats->underruns,
+        .overruns = stats->overruns,
+        .late = stats->late,
+        .lost = stats->lost,
+        .first_audio_ms = stats->first_audio_ms,
+        .buffer_max_ms = stats->buffer_max_ms,
+    };
+
+    if (event == XN_PLAYER_EVENT_END) {
+        ESP_LOGI(TAG, "Playback %u end: %u frames, underrun %u, overrun %u, late %u, lost %u, first audio %u ms",
+                 stats->session, (unsigned)stats->frames_played, (unsigned)stats->underruns,
+                 (unsigned)stats->overruns, (unsigned)stats->late, (unsigned)stats->lost,
+                 (unsigned)stats->first_audio_ms);
+    }
+    xn_event_post_data(s_event_map[event], XN_EVT_SRC_AUDIO, &data, sizeof(data));
+}
+
+/**
+ * @brief 下行语音包路由处理（MQTT 任务中执行）
+ */
+static void on_tts_packet(const char *topic, int topic_len,
+                          const uint8_t *payload, int payload_len, void *user_data)
+{
+    (void)topic;
+    (void)topic_len;
+    (void)user_data;
+
+    esp_err_t ret = xn_player_feed(payload, (size_t)payload_len);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Drop invalid TTS packet (%d bytes): %s", payload_len, esp_err_to_name(ret));
+    }
+}
+#endif
+
+esp_err_t player_manager_init(void)
+{
+#if CONFIG_XN_PLAYER_ENABLE
+    const char *client_id = mqtt_manager_get_client_id();
+    if (client_id == NULL) {
+        ESP_LOGE(TAG, "MQTT client id not set");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xn_player_config_t config = xn_player_get_default_config();
+    config.pin_bclk = CONFIG_XN_PLAYER_PIN_BCLK;
+    config.pin_ws = CONFIG_XN_PLAYER_PIN_WS;
+    config.pin_dout = CONFIG_XN_PLAYER_PIN_DOUT;
+    config.frame_ms = CONFIG_XN_PLAYER_FRAME_MS;
+    config.prebuffer_frames = CONFIG_XN_PLAYER_PREBUFFER_FRAMES;
+    config.buffer_frames = CONFIG_XN_PLAYER_BUFFER_FRAMES;
+#if CONFIG_FREERTOS_UNICORE
+    config.task_core = 0;
+#endif
+    config.event_cb = on_player_event;
+
+    esp_err_t ret = xn_player_init(&config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to init player: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // 过滤器相对于 base_topic
+    char filter[96];
+    snprintf(filter, sizeof(filter), "%s/tts", client_id);
+    ret = mqtt_manager_route(filter, 0, on_tts_packet, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to route %s: %s", filter, esp_err_to_name(ret));
+        xn_player_deinit();
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Player manager initialized, TTS topic %s", filter);
+#else
+    ESP_LOGI(TAG, "Playback disabled");
+#endif
+    return ESP_OK;
+}
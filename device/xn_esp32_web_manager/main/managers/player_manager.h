@@ -0,0 +1,39 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-26 14:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-26 14:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\player_manager.h
+ * @Description: 播放管理器 - 下行语音（TTS）经 MQTT 接收并流式播放
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#ifndef PLAYER_MANAGER_H
+#define PLAYER_MANAGER_H
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 初始化播放管理器
+ * 
+ * - 未开启 CONFIG_XN_PLAYER_ENABLE 时直接返回成功
+ * - 需在 MQTT 管理器之后调用
+ * - 订阅 <base_topic>/<client_id>/tts，包格式同语音上行（xn_voice.h），
+ *   在 MQTT 任务中直接写入抖动缓冲，缓冲到 CONFIG_XN_PLAYER_PREBUFFER_FRAMES 帧即开始播放
+ * - 播放开始、缓冲耗尽、播放结束分别投递 XN_EVT_AUDIO_PLAYBACK_START /
+ *   XN_EVT_AUDIO_PLAYBACK_UNDERRUN / XN_EVT_AUDIO_PLAYBACK_END，携带 xn_evt_audio_playback_t
+ * 
+ * @return esp_err_t 初始化结果
+ */
+esp_err_t player_manager_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLAYER_MANAGER_H */
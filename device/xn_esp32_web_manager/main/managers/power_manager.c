@@ -0,0 +1,98 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-25 15:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-25 15:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\power_manager.c
+ * @Description: 电源管理器实现 - 按 Kconfig 配置 esp_pm，封装忙碌锁
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "power_manager.h"
+
+static const char *TAG = "power_manager";
+
+esp_err_t power_manager_init(void)
+{
+#if CONFIG_XN_POWER_SAVE
+    esp_pm_config_t pm_cfg = {
+        .max_freq_mhz = CONFIG_XN_POWER_MAX_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_XN_POWER_MIN_FREQ_MHZ,
+#if CONFIG_XN_POWER_LIGHT_SLEEP
+        .light_sleep_enable = true,
+#else
+        .light_sleep_enable = false,
+#endif
+    };
+
+    esp_err_t ret = esp_pm_configure(&pm_cfg);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure PM: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Power save on: %d-%d MHz, light sleep %s", pm_cfg.min_freq_mhz, pm_cfg.max_freq_mhz,
+             pm_cfg.light_sleep_enable ? "on" : "off");
+#else
+    ESP_LOGI(TAG, "Power save off");
+#endif
+    return ESP_OK;
+}
+
+esp_err_t power_lock_create(const char *name, power_lock_t *lock)
+{
+    if (lock == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *lock = NULL;
+
+#if CONFIG_XN_POWER_SAVE
+    // CPU_FREQ_MAX 锁同时阻止自动 light sleep
+    esp_pm_lock_handle_t handle = NULL;
+    esp_err_t ret = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, name, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create lock %s: %s", name, esp_err_to_name(ret));
+        return ret;
+    }
+    *lock = (power_lock_t)handle;
+#else
+    (void)name;
+#endif
+    return ESP_OK;
+}
+
+void power_lock_acquire(power_lock_t lock)
+{
+#if CONFIG_XN_POWER_SAVE
+    if (lock != NULL) {
+        esp_pm_lock_acquire((esp_pm_lock_handle_t)lock);
+    }
+#else
+    (void)lock;
+#endif
+}
+
+void power_lock_release(power_lock_t lock)
+{
+#if CONFIG_XN_POWER_SAVE
+    if (lock != NULL) {
+        esp_pm_lock_release((esp_pm_lock_handle_t)lock);
+    }
+#else
+    (void)lock;
+#endif
+}
+
+void power_manager_dump(void)
+{
+#if CONFIG_PM_ENABLE
+    esp_pm_dump_locks(stdout);
+#else
+    ESP_LOGI(TAG, "PM disabled");
+#endif
+}
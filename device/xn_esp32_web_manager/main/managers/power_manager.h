@@ -0,0 +1,71 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-25 15:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-25 15:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\power_manager.h
+ * @Description: 电源管理器 - 动态调频、自动 light sleep 与忙碌期间的电源锁
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 忙碌锁句柄
+ *
+ * 持有期间CPU保持最高频率且不进入 light sleep；未开启 CONFIG_XN_POWER_SAVE 时为空操作。
+ */
+typedef struct power_lock *power_lock_t;
+
+/**
+ * @brief 初始化电源管理器
+ * 
+ * - 开启 CONFIG_XN_POWER_SAVE 时按 Kconfig 配置 esp_pm（DFS、自动 light sleep）
+ * - 未开启时不做任何配置，直接返回成功
+ * 
+ * @return esp_err_t 初始化结果
+ */
+esp_err_t power_manager_init(void);
+
+/**
+ * @brief 创建忙碌锁
+ * 
+ * @param name 锁名称（esp_pm_dump_locks 中显示）
+ * @param[out] lock 锁句柄，未开启低功耗模式时输出 NULL
+ * @return esp_err_t 创建结果
+ */
+esp_err_t power_lock_create(const char *name, power_lock_t *lock);
+
+/**
+ * @brief 获取忙碌锁（可嵌套，与释放成对调用）
+ * 
+ * @param lock 锁句柄，NULL 时为空操作
+ */
+void power_lock_acquire(power_lock_t lock);
+
+/**
+ * @brief 释放忙碌锁
+ * 
+ * @param lock 锁句柄，NULL 时为空操作
+ */
+void power_lock_release(power_lock_t lock);
+
+/**
+ * @brief 打印电源锁状态（开启 PM_PROFILING 时包含各模式停留时间）
+ */
+void power_manager_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POWER_MANAGER_H */
@@ -0,0 +1,146 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\speech_manager.c
+ * @Description: 本地语音命令管理器实现 - 命令表映射到 XN_CMD_*，播放期间暂停识别
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#include <stdio.h>
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "speech_manager.h"
+
+#if CONFIG_XN_SPEECH_ENABLE
+#include "xn_speech.h"
+#include "xn_event_bus.h"
+#endif
+
+static const char *TAG = "speech_manager";
+
+#if CONFIG_XN_SPEECH_ENABLE
+/**
+ * @brief 命令表项：命令词及识别后发布的控制命令
+ */
+typedef struct {
+    const char *phrase;             ///< 命令词（中文模型为拼音）
+    uint16_t cmd;                   ///< 发布的 XN_CMD_*
+    uint8_t brightness;             ///< XN_CMD_DISPLAY_BRIGHTNESS 的亮度
+} speech_command_entry_t;
+
+// 命令 ID 为表下标 + 1
+static const speech_command_entry_t s_command_table[] = {
+    {"guan bi ping mu",         XN_CMD_DISPLAY_SLEEP,       0},     // 关闭屏幕
+    {"da kai ping mu",          XN_CMD_DISPLAY_WAKEUP,      0},     // 打开屏幕
+    {"tiao liang ping mu",      XN_CMD_DISPLAY_BRIGHTNESS,  100},   // 调亮屏幕
+    {"tiao an ping mu",         XN_CMD_DISPLAY_BRIGHTNESS,  30},    // 调暗屏幕
+    {"jin ru pei wang mo shi",  XN_CMD_BLUFI_START,         0},     // 进入配网模式
+    {"tui chu pei wang mo shi", XN_CMD_BLUFI_STOP,          0},     // 退出配网模式
+};
+
+#define SPEECH_COMMAND_COUNT    (sizeof(s_command_table) / sizeof(s_command_table[0]))
+
+/**
+ * @brief 识别结果回调（识别任务中执行，只投递事件）
+ */
+static void on_speech_result(const xn_speech_result_t *result, void *user_data)
+{
+    (void)user_data;
+
+    xn_evt_audio_command_t data = {
+        .command_id = result->command_id,
+        .prob = result->prob,
+        .latency_ms = result->latency_ms,
+    };
+
+    switch (result->event) {
+        case XN_SPEECH_EVENT_WAKE:
+            ESP_LOGI(TAG, "Wake word %d (%u ms)", result->wake_word, (unsigned)result->latency_ms);
+            xn_event_post_data(XN_EVT_AUDIO_WAKE_WORD, XN_EVT_SRC_AUDIO, &data, sizeof(data));
+            break;
+
+        case XN_SPEECH_EVENT_COMMAND: {
+            if (result->command_id < 1 || result->command_id > (int)SPEECH_COMMAND_COUNT) {
+                break;
+            }
+            const speech_command_entry_t *entry = &s_command_table[result->command_id - 1];
+            ESP_LOGI(TAG, "Command '%s' prob %.2f (%u ms)",
+                     entry->phrase, result->prob, (unsigned)result->latency_ms);
+            xn_event_post_data(XN_EVT_AUDIO_COMMAND, XN_EVT_SRC_AUDIO, &data, sizeof(data));
+
+            if (entry->cmd == XN_CMD_DISPLAY_BRIGHTNESS) {
+                xn_cmd_display_brightness_t brightness = {
+                    .brightness = entry->brightness,
+                };
+                xn_event_post_data(entry->cmd, XN_EVT_SRC_AUDIO, &brightness, sizeof(brightness));
+            } else {
+                xn_event_post(entry->cmd, XN_EVT_SRC_AUDIO);
+            }
+            break;
+        }
+
+        case XN_SPEECH_EVENT_TIMEOUT:
+            ESP_LOGI(TAG, "No command after wake word");
+            xn_event_post(XN_EVT_AUDIO_COMMAND_TIMEOUT, XN_EVT_SRC_AUDIO);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief 下行语音播放期间暂停识别（无回声消除，扬声器声音会被麦克风拾取）
+ */
+static void on_playback_event(const xn_event_t *event, void *user_data)
+{
+    (void)user_data;
+
+    if (event->id == XN_EVT_AUDIO_PLAYBACK_START) {
+        xn_speech_pause(true);
+    } else if (event->id == XN_EVT_AUDIO_PLAYBACK_END) {
+        xn_speech_pause(false);
+    }
+}
+#endif
+
+esp_err_t speech_manager_init(void)
+{
+#if CONFIG_XN_SPEECH_ENABLE
+    xn_speech_command_t commands[SPEECH_COMMAND_COUNT];
+    for (size_t i = 0; i < SPEECH_COMMAND_COUNT; i++) {
+        commands[i].id = (int)i + 1;
+        commands[i].phrase = s_command_table[i].phrase;
+    }
+
+    xn_speech_config_t config = xn_speech_get_default_config();
+    config.command_timeout_ms = CONFIG_XN_SPEECH_COMMAND_TIMEOUT_MS;
+    config.cpu_budget_pct = CONFIG_XN_SPEECH_CPU_BUDGET_PCT;
+    config.commands = commands;
+    config.command_count = SPEECH_COMMAND_COUNT;
+#if CONFIG_FREERTOS_UNICORE
+    config.task_core = 0;
+#else
+    // 与采集任务分开，模型推理不推迟采集
+    config.task_core = CONFIG_XN_AUDIO_TASK_CORE ? 0 : 1;
+#endif
+    config.result_cb = on_speech_result;
+
+    esp_err_t ret = xn_speech_init(&config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to init local speech: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    xn_event_subscribe(XN_EVT_AUDIO_PLAYBACK_START, on_playback_event, NULL);
+    xn_event_subscribe(XN_EVT_AUDIO_PLAYBACK_END, on_playback_event, NULL);
+
+    ESP_LOGI(TAG, "Local speech commands ready (%u commands)", (unsigned)SPEECH_COMMAND_COUNT);
+#else
+    ESP_LOGI(TAG, "Local speech commands disabled");
+#endif
+    return ESP_OK;
+}
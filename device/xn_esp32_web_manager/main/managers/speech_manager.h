@@ -0,0 +1,38 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\speech_manager.h
+ * @Description: 本地语音命令管理器 - 唤醒词 + 命令词识别结果转换为事件总线控制命令
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#ifndef SPEECH_MANAGER_H
+#define SPEECH_MANAGER_H
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 初始化本地语音命令管理器
+ * 
+ * - 未开启 CONFIG_XN_SPEECH_ENABLE 时直接返回成功
+ * - 需在音频管理器之后调用，模型从 model 分区载入 PSRAM
+ * - 唤醒、命令、超时分别发布 XN_EVT_AUDIO_WAKE_WORD / XN_EVT_AUDIO_COMMAND /
+ *   XN_EVT_AUDIO_COMMAND_TIMEOUT，识别到的命令再按命令表发布对应的 XN_CMD_*
+ * - 下行语音播放期间暂停识别，避免扬声器声音触发唤醒
+ * 
+ * @return esp_err_t 初始化结果
+ */
+esp_err_t speech_manager_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPEECH_MANAGER_H */
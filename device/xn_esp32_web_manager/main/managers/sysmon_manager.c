@@ -0,0 +1,197 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 18:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 18:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\sysmon_manager.c
+ * @Description: 系统监控管理器实现 - 周期采样、低内存事件与 MQTT 上报
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "sysmon_manager.h"
+
+#if CONFIG_XN_SYSMON_ENABLE
+#include "esp_heap_caps.h"
+#include "xn_sysmon.h"
+#include "xn_sched.h"
+#include "xn_event_bus.h"
+#include "mqtt_manager.h"
+#endif
+
+static const char *TAG = "sysmon_manager";
+
+#if CONFIG_XN_SYSMON_ENABLE
+
+#define SYSMON_MANAGER_JSON_MAX     1536    // 上报 JSON 最大长度
+
+#ifndef CONFIG_XN_SYSMON_PSRAM_MIN_KB
+#define CONFIG_XN_SYSMON_PSRAM_MIN_KB 0
+#endif
+
+// 各类堆内存的告警阈值（字节），0 表示不检查
+static const uint32_t s_thresholds[XN_SYSMON_HEAP_COUNT] = {
+    [XN_SYSMON_HEAP_INTERNAL] = CONFIG_XN_SYSMON_INTERNAL_MIN_KB * 1024,
+    [XN_SYSMON_HEAP_DMA]      = CONFIG_XN_SYSMON_DMA_MIN_KB * 1024,
+    [XN_SYSMON_HEAP_PSRAM]    = CONFIG_XN_SYSMON_PSRAM_MIN_KB * 1024,
+};
+
+static const uint32_t s_heap_caps[XN_SYSMON_HEAP_COUNT] = {
+    [XN_SYSMON_HEAP_INTERNAL] = MALLOC_CAP_INTERNAL,
+    [XN_SYSMON_HEAP_DMA]      = MALLOC_CAP_DMA,
+    [XN_SYSMON_HEAP_PSRAM]    = MALLOC_CAP_SPIRAM,
+};
+
+static xn_sched_job_t s_job;            // 采样作业（共享调度器中周期执行）
+static volatile bool s_dump_requested;  // 下次采样后打印
+static char s_topic[128];
+static bool s_low[XN_SYSMON_HEAP_COUNT];
+
+/**
+ * @brief 检查堆内存阈值：跌破时发布一次事件，回升到阈值的 125% 以上后重新布防
+ */
+static void check_heap(const xn_sysmon_snapshot_t *snap)
+{
+    for (int i = 0; i < XN_SYSMON_HEAP_COUNT; i++) {
+        const xn_sysmon_heap_t *h = &snap->heap[i];
+        uint32_t threshold = s_thresholds[i];
+        if (threshold == 0 || h->total == 0) {
+            continue;
+        }
+
+        if (!s_low[i] && h->largest < threshold) {
+            s_low[i] = true;
+            ESP_LOGW(TAG, "Low memory: caps 0x%x free %u largest %u < %u",
+                     (unsigned)s_heap_caps[i], (unsigned)h->free, (unsigned)h->largest, (unsigned)threshold);
+            xn_evt_low_memory_t evt = {
+                .caps = s_heap_caps[i],
+                .free = h->free,
+                .largest = h->largest,
+                .threshold = threshold,
+            };
+            xn_event_post_data(XN_EVT_SYSTEM_LOW_MEMORY, XN_EVT_SRC_SYSTEM, &evt, sizeof(evt));
+        } else if (s_low[i] && h->largest >= threshold + threshold / 4) {
+            s_low[i] = false;
+            ESP_LOGI(TAG, "Memory recovered: caps 0x%x largest %u", (unsigned)s_heap_caps[i], (unsigned)h->largest);
+        }
+    }
+}
+
+/**
+ * @brief 检查任务栈余量（快照已按余量从小到大排序）
+ */
+static void check_stacks(const xn_sysmon_snapshot_t *snap)
+{
+    for (uint16_t i = 0; i < snap->task_count; i++) {
+        const xn_sysmon_task_t *t = &snap->tasks[i];
+        if (t->stack_free >= CONFIG_XN_SYSMON_STACK_WARN_BYTES) {
+            break;
+        }
+        ESP_LOGW(TAG, "Task %s stack free %u bytes", t->name, (unsigned)t->stack_free);
+    }
+}
+
+/**
+ * @brief 已连接时上报 JSON
+ */
+static void publish_snapshot(const xn_sysmon_snapshot_t *snap)
+{
+    if (s_topic[0] == '\0' || !mqtt_manager_is_connected()) {
+        return;
+    }
+    char *json = malloc(SYSMON_MANAGER_JSON_MAX);
+    if (json == NULL) {
+        return;
+    }
+    int len = xn_sysmon_to_json(snap, json, SYSMON_MANAGER_JSON_MAX);
+    if (len > 0) {
+        (void)mqtt_manager_publish_status(s_topic, json, (size_t)len, 0);
+    } else {
+        ESP_LOGW(TAG, "Sysmon JSON too large");
+    }
+    free(json);
+}
+
+/**
+ * @brief 采样作业：周期采样，收到请求时提前采样并打印
+ */
+static void sysmon_job(void *arg)
+{
+    xn_sysmon_snapshot_t *snap = (xn_sysmon_snapshot_t *)arg;
+    bool requested = s_dump_requested;
+    s_dump_requested = false;
+
+    if (xn_sysmon_sample(snap) != ESP_OK) {
+        return;
+    }
+    check_heap(snap);
+    check_stacks(snap);
+    publish_snapshot(snap);
+    if (requested) {
+        xn_sysmon_dump(snap);
+    }
+}
+
+/**
+ * @brief 即时采样请求路由（<base>/<client_id>/sysmon/get）：提前执行采样作业
+ */
+static void sysmon_get_handler(const char *topic, int topic_len,
+                               const uint8_t *payload, int payload_len, void *user_data)
+{
+    (void)topic;
+    (void)topic_len;
+    (void)payload;
+    (void)payload_len;
+    (void)user_data;
+
+    s_dump_requested = true;
+    xn_sched_schedule(&s_job, 0);
+}
+#endif
+
+esp_err_t sysmon_manager_init(void)
+{
+#if CONFIG_XN_SYSMON_ENABLE
+    const char *base_topic = mqtt_manager_get_base_topic();
+    const char *client_id = mqtt_manager_get_client_id();
+    if (base_topic != NULL && base_topic[0] != '\0' && client_id != NULL) {
+        int n = snprintf(s_topic, sizeof(s_topic), "%s/%s/sysmon", base_topic, client_id);
+        if (n < 0 || n >= (int)sizeof(s_topic)) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+    } else {
+        ESP_LOGW(TAG, "MQTT base topic not set, sysmon reports disabled");
+    }
+
+    xn_sysmon_snapshot_t *snap = malloc(sizeof(xn_sysmon_snapshot_t));
+    if (snap == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    // 先采样一次：建立 CPU 基线，启动时就已不足的内存立即告警
+    if (xn_sysmon_sample(snap) == ESP_OK) {
+        check_heap(snap);
+    }
+
+    xn_sched_job_init(&s_job, sysmon_job, snap, "sysmon");
+    esp_err_t ret = xn_sched_start_periodic(&s_job, CONFIG_XN_SYSMON_INTERVAL_SEC * 1000);
+    if (ret != ESP_OK) {
+        free(snap);
+        return ret;
+    }
+
+    if (s_topic[0] != '\0') {
+        char filter[64];
+        snprintf(filter, sizeof(filter), "%s/sysmon/get", client_id);
+        (void)mqtt_manager_route(filter, 0, sysmon_get_handler, NULL);
+    }
+
+    ESP_LOGI(TAG, "System monitor every %ds", CONFIG_XN_SYSMON_INTERVAL_SEC);
+#else
+    ESP_LOGI(TAG, "System monitor disabled");
+#endif
+    return ESP_OK;
+}
@@ -0,0 +1,41 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 18:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 18:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\sysmon_manager.h
+ * @Description: 系统监控管理器 - 周期采样任务栈/CPU/堆内存，低内存告警与 MQTT 上报
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#ifndef SYSMON_MANAGER_H
+#define SYSMON_MANAGER_H
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 初始化系统监控管理器
+ * 
+ * - 未开启 CONFIG_XN_SYSMON_ENABLE 时直接返回成功
+ * - 需在事件总线与 MQTT 管理器之后调用
+ * - 每 CONFIG_XN_SYSMON_INTERVAL_SEC 秒采样一次：
+ *   - 某类堆内存的最大可分配块低于阈值时发布一次 XN_EVT_SYSTEM_LOW_MEMORY
+ *     （携带 xn_evt_low_memory_t），回升到阈值的 125% 以上后才会再次发布
+ *   - 栈余量低于 CONFIG_XN_SYSMON_STACK_WARN_BYTES 的任务打印警告
+ *   - 已连接时以 JSON 发布到 <base_topic>/<client_id>/sysmon（QoS0，只保留最新）
+ * - 向 <base_topic>/<client_id>/sysmon/get 发布任意消息立即采样并上报，同时打印到日志
+ * 
+ * @return esp_err_t 初始化结果
+ */
+esp_err_t sysmon_manager_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SYSMON_MANAGER_H */
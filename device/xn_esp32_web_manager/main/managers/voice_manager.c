@@ -0,0 +1,75 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-26 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-26 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\voice_manager.c
+ * @Description: 语音上行管理器实现 - xn_voice 分包发布到设备语音 Topic
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#include <stdio.h>
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "voice_manager.h"
+
+#if CONFIG_XN_VOICE_ENABLE
+#include "xn_voice.h"
+#include "mqtt_manager.h"
+#endif
+
+static const char *TAG = "voice_manager";
+
+#if CONFIG_XN_VOICE_ENABLE
+static char s_topic[128];
+
+/**
+ * @brief 发送回调（编码任务中执行）：放入 MQTT outbox 后立即返回
+ */
+static esp_err_t send_packet(const uint8_t *packet, size_t len, void *user_data)
+{
+    (void)user_data;
+
+    return mqtt_manager_publish_stream(s_topic, packet, len, CONFIG_XN_VOICE_MAX_BACKLOG);
+}
+#endif
+
+esp_err_t voice_manager_init(void)
+{
+#if CONFIG_XN_VOICE_ENABLE
+    const char *base_topic = mqtt_manager_get_base_topic();
+    const char *client_id = mqtt_manager_get_client_id();
+    if (base_topic == NULL || client_id == NULL) {
+        ESP_LOGE(TAG, "MQTT base topic or client id not set");
+        return ESP_ERR_INVALID_STATE;
+    }
+    int n = snprintf(s_topic, sizeof(s_topic), "%s/%s/voice", base_topic, client_id);
+    if (n < 0 || n >= (int)sizeof(s_topic)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    xn_voice_config_t config = xn_voice_get_default_config();
+    config.frame_ms = CONFIG_XN_VOICE_FRAME_MS;
+    config.frames_per_packet = CONFIG_XN_VOICE_FRAMES_PER_PACKET;
+    config.bitrate = CONFIG_XN_VOICE_BITRATE;
+#if CONFIG_FREERTOS_UNICORE
+    config.task_core = 0;
+#else
+    // 与采集任务分开，编码不占用采集所在核心
+    config.task_core = CONFIG_XN_AUDIO_TASK_CORE ? 0 : 1;
+#endif
+    config.send_cb = send_packet;
+
+    esp_err_t ret = xn_voice_init(&config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to init voice uplink: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Voice uplink to %s", s_topic);
+#else
+    ESP_LOGI(TAG, "Voice uplink disabled");
+#endif
+    return ESP_OK;
+}
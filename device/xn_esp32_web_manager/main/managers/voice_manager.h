@@ -0,0 +1,37 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-26 10:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-26 10:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_esp32_web_manager\main\managers\voice_manager.h
+ * @Description: 语音上行管理器 - 语音段 Opus 编码后经 MQTT 实时上行
+ * VX:Jxingnian
+ * Copyright (c) 2026 by xingnian, All Rights Reserved. 
+ */
+
+#ifndef VOICE_MANAGER_H
+#define VOICE_MANAGER_H
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 初始化语音上行管理器
+ * 
+ * - 未开启 CONFIG_XN_VOICE_ENABLE 时直接返回成功
+ * - 需在音频管理器与 MQTT 管理器之后调用
+ * - 语音包以 QoS0 发布到 <base_topic>/<client_id>/voice，包格式见 xn_voice.h；
+ *   未连接或 outbox 积压超过 CONFIG_XN_VOICE_MAX_BACKLOG 时丢包，不缓存
+ * 
+ * @return esp_err_t 初始化结果
+ */
+esp_err_t voice_manager_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VOICE_MANAGER_H */
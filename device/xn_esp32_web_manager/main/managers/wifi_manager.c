@@ -12,29 +12,160 @@
 #include "wifi_manager.h" // 包含WiFi管理器头文件
 #include "xn_wifi.h" // 包含WiFi组件头文件
 #include "xn_storage.h" // 包含存储组件头文件
+#include "nvs.h" // 包含NVS错误码
 #include "xn_event_bus.h" // 包含事件总线头文件
 #include "esp_log.h" // 包含日志库
+#include "esp_timer.h" // 包含高精度定时器
+#include "sdkconfig.h" // 包含工程配置
 #include "freertos/FreeRTOS.h" // 包含FreeRTOS核心
 #include "freertos/task.h" // 包含FreeRTOS任务
 #include "freertos/semphr.h" // 包含FreeRTOS信号量
 #include <string.h> // 包含字符串库
+#include <limits.h> // 包含整型极值
 
 static const char *TAG = "wifi_manager";
 
 // 最大存储WiFi配置数量
 #define MAX_STORED_WIFI_CONFIGS 10
 // 存储键名
+#define NVS_KEY_WIFI_PROFILES "wifi_prof" // 配置列表记录
+#define WIFI_PROFILES_VERSION 1
+#define NVS_KEY_WIFI_FAST "wifi_fast" // 快速重连缓存记录
+#define WIFI_FAST_VERSION 2
+// 旧版本按字段拆分的键名，启动时迁移到配置列表记录后删除
 #define NVS_KEY_WIFI_COUNT "wifi_cnt"
 #define NVS_KEY_PREFIX_SSID "wifi_ssid_"
 #define NVS_KEY_PREFIX_PWD "wifi_pwd_"
+#define NVS_KEY_WIFI_ORDER "wifi_ord"
+#define NVS_KEY_WIFI_STATS "wifi_stat"
+
+// 快速重连缓存：上次成功连接的AP
+typedef struct {
+    char ssid[33]; // 对应的SSID，与待连接的SSID一致时才使用
+    xn_wifi_link_info_t link; // BSSID、信道（IP由DHCP按上次租到的地址请求）
+} wifi_fast_cache_t;
+
+// 单个配置的历史连接结果，计数到上限后减半，近期结果权重更大
+typedef struct {
+    uint8_t ok; // 成功次数
+    uint8_t fail; // 失败次数
+} wifi_profile_stat_t;
+
+// 单个WiFi配置
+typedef struct {
+    char ssid[33]; // SSID
+    char password[65]; // 密码，开放网络为空
+    wifi_profile_stat_t stat; // 历史连接结果
+} wifi_profile_t;
+
+// 配置列表，整体作为一条记录保存；各配置固定在物理槽位中，
+// 使用顺序单独记在顺序表里，调整顺序不搬动配置，扫描选网的候选槽位也保持有效
+typedef struct {
+    uint8_t count; // 配置数量
+    uint8_t order[MAX_STORED_WIFI_CONFIGS]; // LRU顺序表：逻辑下标(0为最久未用) -> 物理槽位
+    wifi_profile_t slots[MAX_STORED_WIFI_CONFIGS]; // 物理槽位
+} wifi_profile_list_t;
+
+#define WIFI_STAT_MAX 15 // 成功+失败计数上限
+#define WIFI_HISTORY_BONUS_DB 20 // 成功率折算的RSSI加分上限(dB)，无历史时加一半
+#define WIFI_ATTEMPT_TIMEOUT_MS 8000 // 单个候选从发起连接到获取IP的期限
 
 static xn_wifi_t *s_wifi_instance = NULL; // WiFi组件实例指针
 static bool s_initialized = false; // 初始化标志
 static uint8_t s_retry_count = 0; // 重连计数
 #define MAX_RETRY_CONNECT 5 // 最大重连次数
 
+// 配置列表在初始化时读入RAM，之后只在修改时整体写回
+static wifi_profile_list_t s_profiles; // 配置列表
+static SemaphoreHandle_t s_profiles_mutex = NULL; // 配置列表保护锁（事件任务与Web接口并发访问）
+#define PROFILES_LOCK() xSemaphoreTake(s_profiles_mutex, portMAX_DELAY)
+#define PROFILES_UNLOCK() xSemaphoreGive(s_profiles_mutex)
+
+// 当前连接参数，仅在事件任务和连接发起处访问
+static char s_conn_ssid[33] = {0}; // 正在连接的SSID
+static char s_conn_pwd[65] = {0}; // 正在连接的密码，快速连接失败时回退使用
+static bool s_fast_attempt = false; // 本次连接是否走快速路径
+
+// 扫描选网状态，仅在事件任务和连接发起处访问
+static uint8_t s_cand[MAX_STORED_WIFI_CONFIGS]; // 候选物理槽位，按优先级排序
+static uint8_t s_cand_count = 0; // 候选数量
+static uint8_t s_cand_next = 0; // 下一个待尝试的候选
+static bool s_selecting = false; // 正在按候选列表依次尝试
+static bool s_scanning = false; // 正在为选网扫描
+static esp_timer_handle_t s_attempt_timer = NULL; // 单次尝试期限定时器
+
+#if CONFIG_XN_WIFI_LINK_MONITOR
+// 链路质量采样：已获取IP期间周期读取RSSI，定点指数平滑（Q4，即 x16）
+#define LINK_EWMA_DIV (1 << CONFIG_XN_WIFI_LINK_EWMA_SHIFT) // 平滑系数 alpha = 1/LINK_EWMA_DIV
+typedef struct {
+    int16_t avg_q4; // 平滑RSSI
+    int16_t dev_q4; // 平滑平均偏差
+    uint32_t samples; // 本次连接以来的采样数
+    uint8_t weak; // 平滑值连续低于漫游阈值的采样数
+    int8_t published_avg; // 上次发布的平滑值，变化不足1dB且状态不变时不发布
+    uint8_t bssid[6]; // 当前AP的BSSID
+    int64_t roam_check_us; // 上次漫游扫描的时间
+} wifi_link_state_t;
+
+static wifi_link_state_t s_link; // 链路质量状态，在采样定时器中更新，漫游扫描回调只读
+static volatile bool s_link_reset = false; // 新连接获取IP后置位，由采样定时器清空上一条链路的状态
+static esp_timer_handle_t s_sample_timer = NULL; // 采样定时器
+
+// 漫游：先断开当前AP，在断开回调中连接目标BSSID
+static bool s_roam_pending = false; // 已主动断开，等待断开回调后连接目标
+static bool s_roam_attempt = false; // 正在连接漫游目标
+static char s_roam_ssid[33] = {0}; // 漫游目标SSID
+static char s_roam_pwd[65] = {0}; // 漫游目标密码
+static xn_wifi_link_info_t s_roam_link; // 漫游目标BSSID/信道
+#endif
+
 // 声明内部函数
 static void load_and_connect_best_wifi(void);
+static void save_fast_cache(void);
+static void start_selection(void);
+static void try_next_candidate(void);
+static void record_profile_result(const char *ssid, bool ok);
+static void load_profiles(void);
+#if CONFIG_XN_WIFI_LINK_MONITOR
+static void link_monitor_start(void);
+static void link_monitor_stop(void);
+static void link_sample_cb(void *arg);
+static void connect_roam_target(void);
+#endif
+
+// 记录当前连接参数
+static void set_conn_params(const char *ssid, const char *password)
+{
+    strlcpy(s_conn_ssid, ssid, sizeof(s_conn_ssid));
+    strlcpy(s_conn_pwd, password ? password : "", sizeof(s_conn_pwd));
+}
+
+// 发布已连接事件，携带当前AP信息
+static void post_connected_event(void)
+{
+    xn_evt_wifi_connected_t evt = {0};
+    xn_wifi_link_quality_t q;
+    strlcpy((char *)evt.ssid, s_conn_ssid, sizeof(evt.ssid));
+    if (xn_wifi_get_link_quality(s_wifi_instance, &q) == ESP_OK) {
+        memcpy(evt.bssid, q.bssid, sizeof(evt.bssid));
+        evt.rssi = q.rssi;
+        evt.channel = q.channel;
+    }
+    xn_event_post_data(XN_EVT_WIFI_CONNECTED, XN_EVT_SRC_WIFI, &evt, sizeof(evt));
+}
+
+// 发布获取IP事件，携带IP信息（显示管理器读取 data->ip）
+static void post_got_ip_event(void)
+{
+    xn_evt_wifi_got_ip_t evt = {0};
+    xn_wifi_link_info_t link;
+    if (xn_wifi_get_link_info(s_wifi_instance, &link) == ESP_OK) {
+        evt.ip = link.ip;
+        evt.netmask = link.netmask;
+        evt.gateway = link.gw;
+    }
+    xn_event_post_data(XN_EVT_WIFI_GOT_IP, XN_EVT_SRC_WIFI, &evt, sizeof(evt));
+}
 
 // WiFi 状态回调
 static void internal_wifi_status_cb(xn_wifi_status_t status)
@@ -43,6 +174,38 @@ static void internal_wifi_status_cb(xn_wifi_status_t status)
     
     switch (status) {
         case XN_WIFI_DISCONNECTED: {
+#if CONFIG_XN_WIFI_LINK_MONITOR
+            link_monitor_stop();
+            if (s_roam_pending) {
+                // 主动离开了旧AP，连接漫游目标；对上层不发布断开，MQTT 在获取IP后恢复
+                s_roam_pending = false;
+                connect_roam_target();
+                break;
+            }
+            if (s_roam_attempt) {
+                // 漫游目标连不上：回到扫描选网，原来的AP也在候选中
+                ESP_LOGW(TAG, "Roam to %s failed, fallback to full scan", s_conn_ssid);
+                s_roam_attempt = false;
+                esp_timer_stop(s_attempt_timer);
+                start_selection();
+                break;
+            }
+#endif
+            if (s_fast_attempt) {
+                // 快速连接失败（AP换了信道/BSSID或不在了）：清掉缓存，回退到扫描选网 + DHCP
+                ESP_LOGW(TAG, "Fast connect to %s failed, fallback to full scan", s_conn_ssid);
+                s_fast_attempt = false;
+                xn_storage_erase(NVS_KEY_WIFI_FAST);
+                start_selection();
+                break;
+            }
+            if (s_selecting) {
+                // 当前候选失败或超时，换下一个
+                esp_timer_stop(s_attempt_timer);
+                record_profile_result(s_conn_ssid, false);
+                try_next_candidate();
+                break;
+            }
             xn_event_post(XN_EVT_WIFI_DISCONNECTED, XN_EVT_SRC_WIFI);
             
             // 简单重连策略：如果非主动断开且重试次数未满
@@ -62,30 +225,54 @@ static void internal_wifi_status_cb(xn_wifi_status_t status)
             }
             break;
         }
-        case XN_WIFI_CONNECTED: 
-            xn_event_post(XN_EVT_WIFI_CONNECTED, XN_EVT_SRC_WIFI);
+        case XN_WIFI_CONNECTED:
+            post_connected_event();
             s_retry_count = 0; // 重置重试计数
             break;
             
         case XN_WIFI_GOT_IP: {
-            // 获取IP信息以便发布完整事件
-            // xn_wifi 组件暂时没暴露直接获取IP信息的API，但通常 GOT_IP 意味着网络通了
-            // 我们可以再次封装 xn_wifi_get_ip_info 或者直接在此处通过 esp_netif 获取，
-            // 但为了保持分层，最好完善 xn_wifi 组件。
-            // 鉴于 xn_wifi 是我们刚写的，这里假设它已经工作。
-            // 实际上 main/managers/wifi_manager.c 原有代码有处理 IP 事件并获取 IP
-            // 新的 xn_wifi_event_handler 也在打 log
-            
-            // 发布 XN_EVT_WIFI_GOT_IP
-            // 这里我们不需要传具体数据，或者如果需要，可以修改 event bus 定义
-            // 原代码传了 ip_info，这里简化处理，只通知事件
-            xn_event_post(XN_EVT_WIFI_GOT_IP, XN_EVT_SRC_WIFI);
+            esp_timer_stop(s_attempt_timer);
+            s_selecting = false;
+            s_fast_attempt = false;
+            record_profile_result(s_conn_ssid, true);
+            save_fast_cache();
+#if CONFIG_XN_WIFI_LINK_MONITOR
+            s_roam_attempt = false;
+            link_monitor_start();
+#endif
+            post_got_ip_event();
             break;
         }
         default: break;
     }
 }
 
+// 取消正在进行的快速连接/扫描选网，之后的断开不再触发下一次尝试
+static void cancel_connect_flow(void)
+{
+    s_fast_attempt = false;
+    s_scanning = false;
+    s_selecting = false;
+    if (s_attempt_timer) esp_timer_stop(s_attempt_timer);
+#if CONFIG_XN_WIFI_LINK_MONITOR
+    s_roam_pending = false;
+    s_roam_attempt = false;
+#endif
+}
+
+// 单次尝试超时：主动断开，在状态回调中换下一个候选
+static void attempt_timeout_cb(void *arg)
+{
+    (void)arg;
+    bool attempting = s_selecting;
+#if CONFIG_XN_WIFI_LINK_MONITOR
+    attempting = attempting || s_roam_attempt;
+#endif
+    if (!attempting || xn_wifi_get_status(s_wifi_instance) == XN_WIFI_GOT_IP) return;
+    ESP_LOGW(TAG, "WiFi %s attempt timed out", s_conn_ssid);
+    xn_wifi_disconnect(s_wifi_instance);
+}
+
 // 命令事件处理回调
 static void cmd_event_handler(const xn_event_t *event, void *user_data)
 {
@@ -95,6 +282,7 @@ static void cmd_event_handler(const xn_event_t *event, void *user_data)
             load_and_connect_best_wifi();
             break;
         case XN_CMD_WIFI_DISCONNECT:
+            cancel_connect_flow();
             xn_wifi_disconnect(s_wifi_instance);
             break;
         default: break;
@@ -108,11 +296,37 @@ esp_err_t wifi_manager_init(void)
 
     xn_storage_init(); // 确保存储已初始化
 
+    s_profiles_mutex = xSemaphoreCreateMutex();
+    if (!s_profiles_mutex) return ESP_ERR_NO_MEM;
+    load_profiles(); // 启动时一次性读取配置列表
+
     s_wifi_instance = xn_wifi_create();
     if (!s_wifi_instance) return ESP_ERR_NO_MEM;
 
     xn_wifi_init(s_wifi_instance);
     xn_wifi_register_status_cb(s_wifi_instance, internal_wifi_status_cb);
+#if CONFIG_XN_POWER_SAVE
+    xn_wifi_set_power_save(s_wifi_instance, CONFIG_XN_POWER_WIFI_LISTEN_INTERVAL); // 低功耗模式：调制解调器睡眠
+#endif
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = attempt_timeout_cb,
+        .name = "wifi_attempt",
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &s_attempt_timer);
+    if (ret != ESP_OK) return ret;
+
+#if CONFIG_XN_WIFI_LINK_MONITOR
+    const esp_timer_create_args_t sample_args = {
+        .callback = link_sample_cb,
+        .name = "wifi_sample",
+        .skip_unhandled_events = true, // light sleep 醒来后不补发错过的采样
+    };
+    ret = esp_timer_create(&sample_args, &s_sample_timer);
+    if (ret != ESP_OK) return ret;
+    // 链路质量只关心最新值，订阅者处理慢时原地替换，不占队列
+    xn_event_set_policy(XN_EVT_WIFI_LINK_QUALITY, &XN_EVENT_POLICY_LATEST());
+#endif
 
     // 订阅内部命令
     xn_event_subscribe(XN_CMD_WIFI_CONNECT, cmd_event_handler, NULL);
@@ -131,6 +345,17 @@ esp_err_t wifi_manager_deinit(void)
     xn_event_unsubscribe(XN_CMD_WIFI_CONNECT, cmd_event_handler);
     xn_event_unsubscribe(XN_CMD_WIFI_DISCONNECT, cmd_event_handler);
 
+    cancel_connect_flow();
+    esp_timer_delete(s_attempt_timer);
+    s_attempt_timer = NULL;
+#if CONFIG_XN_WIFI_LINK_MONITOR
+    esp_timer_stop(s_sample_timer);
+    esp_timer_delete(s_sample_timer);
+    s_sample_timer = NULL;
+#endif
+    vSemaphoreDelete(s_profiles_mutex);
+    s_profiles_mutex = NULL;
+
     xn_wifi_deinit(s_wifi_instance);
     xn_wifi_destroy(s_wifi_instance);
     s_wifi_instance = NULL;
@@ -142,7 +367,22 @@ esp_err_t wifi_manager_deinit(void)
 esp_err_t wifi_manager_start(void)
 {
     if (!s_initialized) return ESP_ERR_INVALID_STATE;
-    // 启动时尝试连接已保存的WiFi
+
+    xn_wifi_status_t status = xn_wifi_get_status(s_wifi_instance);
+    if (status == XN_WIFI_GOT_IP) {
+        // 已联网（如配网期间已连上）：不断开重连，重新发布连接事件让状态机继续
+        ESP_LOGI(TAG, "WiFi already up, skip reconnect");
+        post_connected_event();
+        post_got_ip_event();
+        return ESP_OK;
+    }
+    if (status == XN_WIFI_CONNECTING || s_selecting || s_scanning) {
+        // 连接流程进行中（如配网刚下发的连接），等待其结果
+        ESP_LOGI(TAG, "WiFi connect in progress, wait for result");
+        return ESP_OK;
+    }
+
+    // 尝试连接已保存的WiFi
     load_and_connect_best_wifi();
     return ESP_OK;
 }
@@ -151,77 +391,505 @@ esp_err_t wifi_manager_start(void)
 esp_err_t wifi_manager_stop(void)
 {
     if (!s_initialized) return ESP_ERR_INVALID_STATE;
+    cancel_connect_flow();
     return xn_wifi_disconnect(s_wifi_instance);
 }
 
-// 辅助函数：保存配置到列表（移除旧的，添加新的到末尾）
-static void save_wifi_config_to_nvs(const char *ssid, const char *password)
+/* 配置列表作为一条带版本和CRC的记录保存在RAM中，修改后整体写回。
+ * 旧版本每个字段一个键（wifi_cnt/wifi_ssid_N/wifi_pwd_N/wifi_ord/wifi_stat），
+ * 首次启动时迁移为记录并删除旧键。以下函数除 load_profiles 外均需持有 s_profiles_mutex。 */
+
+// 校验顺序表：数量不越界，有效部分槽位不越界、不重复；无效时按槽位顺序（0 为最旧）重建
+static void sanitize_profile_order(wifi_profile_list_t *list)
+{
+    if (list->count > MAX_STORED_WIFI_CONFIGS) list->count = MAX_STORED_WIFI_CONFIGS;
+    uint16_t used = 0;
+    bool valid = true;
+    for (int i = 0; valid && i < list->count; i++) {
+        if (list->order[i] >= MAX_STORED_WIFI_CONFIGS || (used & (1u << list->order[i]))) valid = false;
+        else used |= 1u << list->order[i];
+    }
+    if (!valid) {
+        for (int i = 0; i < MAX_STORED_WIFI_CONFIGS; i++) list->order[i] = i;
+    }
+    for (int i = 0; i < MAX_STORED_WIFI_CONFIGS; i++) {
+        list->slots[i].ssid[sizeof(list->slots[i].ssid) - 1] = '\0';
+        list->slots[i].password[sizeof(list->slots[i].password) - 1] = '\0';
+    }
+}
+
+// 从旧版本按字段拆分的键读取配置列表，成功读到配置后删除旧键
+static void migrate_legacy_profiles(wifi_profile_list_t *list)
 {
-    char count_key[] = NVS_KEY_WIFI_COUNT;
     uint8_t count = 0;
-    xn_storage_get_u8(count_key, &count);
+    if (xn_storage_get_u8(NVS_KEY_WIFI_COUNT, &count) != ESP_OK) return; // 没有旧数据
+
+    list->count = count;
+    size_t len = sizeof(list->order);
+    if (xn_storage_get_blob(NVS_KEY_WIFI_ORDER, list->order, &len) != ESP_OK || len != sizeof(list->order)) {
+        for (int i = 0; i < MAX_STORED_WIFI_CONFIGS; i++) list->order[i] = i; // 更早的版本没有顺序表
+    }
+    sanitize_profile_order(list);
+
+    wifi_profile_stat_t stats[MAX_STORED_WIFI_CONFIGS] = {0};
+    len = sizeof(stats);
+    if (xn_storage_get_blob(NVS_KEY_WIFI_STATS, stats, &len) != ESP_OK || len != sizeof(stats)) {
+        memset(stats, 0, sizeof(stats));
+    }
 
-    // 检查是否存在
-    int exist_idx = -1;
     char key[32];
-    char val[64];
-    size_t len;
-
-    for (int i = 0; i < count; i++) {
-        snprintf(key, sizeof(key), "%s%d", NVS_KEY_PREFIX_SSID, i);
-        len = sizeof(val);
-        if (xn_storage_get_str(key, val, &len) == ESP_OK) {
-            if (strcmp(val, ssid) == 0) {
-                exist_idx = i;
-                break;
-            }
+    for (int slot = 0; slot < MAX_STORED_WIFI_CONFIGS; slot++) {
+        wifi_profile_t *p = &list->slots[slot];
+        snprintf(key, sizeof(key), "%s%d", NVS_KEY_PREFIX_SSID, slot);
+        len = sizeof(p->ssid);
+        xn_storage_get_str(key, p->ssid, &len);
+        xn_storage_erase(key);
+        snprintf(key, sizeof(key), "%s%d", NVS_KEY_PREFIX_PWD, slot);
+        len = sizeof(p->password);
+        xn_storage_get_str(key, p->password, &len); // 开放网络没有密码
+        xn_storage_erase(key);
+        p->stat = stats[slot];
+    }
+
+    // 丢弃槽位中已经读不到的配置，清空不在顺序表中的槽位
+    uint8_t n = 0;
+    uint16_t used = 0;
+    for (int i = 0; i < list->count; i++) {
+        uint8_t slot = list->order[i];
+        if (list->slots[slot].ssid[0] == '\0') continue;
+        list->order[n++] = slot;
+        used |= 1u << slot;
+    }
+    list->count = n;
+    for (int slot = 0; slot < MAX_STORED_WIFI_CONFIGS; slot++) {
+        if (!(used & (1u << slot))) memset(&list->slots[slot], 0, sizeof(wifi_profile_t));
+    }
+
+    xn_storage_erase(NVS_KEY_WIFI_COUNT);
+    xn_storage_erase(NVS_KEY_WIFI_ORDER);
+    xn_storage_erase(NVS_KEY_WIFI_STATS);
+    ESP_LOGI(TAG, "Migrated %d legacy WiFi configs", n);
+}
+
+// 读取配置列表到RAM（初始化时调用一次）
+static void load_profiles(void)
+{
+    memset(&s_profiles, 0, sizeof(s_profiles));
+    esp_err_t ret = xn_storage_get_record(NVS_KEY_WIFI_PROFILES, WIFI_PROFILES_VERSION,
+                                          &s_profiles, sizeof(s_profiles), NULL);
+    if (ret == ESP_OK) {
+        sanitize_profile_order(&s_profiles);
+        return;
+    }
+
+    memset(&s_profiles, 0, sizeof(s_profiles));
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        migrate_legacy_profiles(&s_profiles);
+        if (s_profiles.count > 0) {
+            xn_storage_set_record(NVS_KEY_WIFI_PROFILES, WIFI_PROFILES_VERSION, &s_profiles, sizeof(s_profiles));
         }
+        xn_storage_commit(); // 新记录与删除旧键一起提交
+    } else {
+        ESP_LOGW(TAG, "Stored WiFi configs unreadable (%s), starting empty", esp_err_to_name(ret));
     }
+}
 
-    int write_idx = count;
-    if (exist_idx >= 0) {
-        // 已存在，不用新增，只需更新密码（如果变了）
-        // 简单起见，可以把它移到最后（表示最近使用），这里简化：直接覆盖原位置或不移动
-        write_idx = exist_idx; 
+// 写回配置列表
+static void save_profiles(void)
+{
+    xn_storage_set_record(NVS_KEY_WIFI_PROFILES, WIFI_PROFILES_VERSION, &s_profiles, sizeof(s_profiles));
+}
+
+// 按SSID查找配置，返回逻辑下标，找不到返回-1
+static int find_profile(const char *ssid)
+{
+    for (int i = 0; i < s_profiles.count; i++) {
+        if (strcmp(s_profiles.slots[s_profiles.order[i]].ssid, ssid) == 0) return i;
+    }
+    return -1;
+}
+
+// 把逻辑下标 idx 移到最近使用的位置（末尾）
+static void move_to_newest(int idx)
+{
+    uint8_t *order = s_profiles.order;
+    uint8_t slot = order[idx];
+    memmove(&order[idx], &order[idx + 1], s_profiles.count - idx - 1);
+    order[s_profiles.count - 1] = slot;
+}
+
+// 记录一次连接结果，成功时同时把该配置标记为最近使用
+static void record_profile_result(const char *ssid, bool ok)
+{
+    PROFILES_LOCK();
+    int idx = find_profile(ssid);
+    if (idx >= 0) {
+        wifi_profile_stat_t *st = &s_profiles.slots[s_profiles.order[idx]].stat;
+        if (ok) st->ok++;
+        else st->fail++;
+        if (st->ok + st->fail > WIFI_STAT_MAX) {
+            st->ok /= 2;
+            st->fail /= 2;
+        }
+        if (ok && idx != s_profiles.count - 1) move_to_newest(idx);
+        save_profiles(); // 统计变化随存储组件的延迟提交批量落盘
+    }
+    PROFILES_UNLOCK();
+}
+
+// 辅助函数：保存配置到LRU环（已存在则更新并移到最近使用，已满则覆盖最久未用的）
+static void save_wifi_config_to_nvs(const char *ssid, const char *password)
+{
+    PROFILES_LOCK();
+    int idx = find_profile(ssid);
+    uint8_t slot;
+
+    if (idx >= 0) {
+        // 已存在：原槽位更新密码，移到最近使用
+        slot = s_profiles.order[idx];
+        move_to_newest(idx);
+    } else if (s_profiles.count < MAX_STORED_WIFI_CONFIGS) {
+        // 未满：取第一个空闲槽位
+        uint16_t used = 0;
+        for (int i = 0; i < s_profiles.count; i++) used |= 1u << s_profiles.order[i];
+        slot = 0;
+        while (used & (1u << slot)) slot++;
+        s_profiles.order[s_profiles.count++] = slot;
+        memset(&s_profiles.slots[slot].stat, 0, sizeof(wifi_profile_stat_t));
     } else {
-        // 新增
-        if (count >= MAX_STORED_WIFI_CONFIGS) {
-            // 满了，删除第一个（最旧的），后移
-            // 这里的移动逻辑较繁琐，为简化代码，建议循环移动
-            // 这里省略移动逻辑实现，实际项目应实现队列结构
-            // 简单策略：覆盖第0个（如果要做LRU需要移动）
-            // 既然是演示，我们采用简单的圆覆盖或者仅支持1个。
-            // 但需求说不能耦合，意味着应用层要实现。
-            // 鉴于篇幅，我们实现：如果满了，覆盖索引0（非LRU but simple fifo replacement without shift)
-            // 或者更好：覆盖 count % MAX
-            // 让我们还是尽量做好一点：覆盖最早的，这里假设 count 就在 0~9 增加
-            // 正确做法：全部前移
-             for (int i = 1; i < count; i++) {
-                // read i, write i-1
-                // ... (implements shift)
-             }
-             write_idx = MAX_STORED_WIFI_CONFIGS - 1;
-        } else {
-            count++;
-            xn_storage_set_u8(count_key, count);
+        // 已满：淘汰最久未用的配置，复用其槽位
+        slot = s_profiles.order[0];
+        move_to_newest(0);
+        memset(&s_profiles.slots[slot].stat, 0, sizeof(wifi_profile_stat_t));
+    }
+
+    strlcpy(s_profiles.slots[slot].ssid, ssid, sizeof(s_profiles.slots[slot].ssid));
+    strlcpy(s_profiles.slots[slot].password, password ? password : "", sizeof(s_profiles.slots[slot].password));
+
+    save_profiles();
+    PROFILES_UNLOCK();
+    xn_storage_commit(); // 配网结果立即落盘
+}
+
+// 历史成功率折算的RSSI加分，成功率拉普拉斯平滑：无历史时为 1/2
+static int history_bonus(const wifi_profile_stat_t *st)
+{
+    return WIFI_HISTORY_BONUS_DB * (st->ok + 1) / (st->ok + st->fail + 2);
+}
+
+// 按扫描结果给已保存的配置排序：扫描到的按 RSSI + 历史成功率加分从高到低，
+// 未扫描到的（可能是隐藏网络）按最近使用顺序排在后面
+static void rank_profiles(const wifi_ap_record_t *ap_list, uint16_t ap_count)
+{
+    int score[MAX_STORED_WIFI_CONFIGS];
+    bool seen[MAX_STORED_WIFI_CONFIGS] = {0};
+    uint8_t n = 0;
+
+    PROFILES_LOCK();
+    const uint8_t *order = s_profiles.order;
+    uint8_t count = s_profiles.count;
+
+    // 从最近使用的开始遍历，得分相同时最近使用的排在前面
+    for (int i = count - 1; i >= 0; i--) {
+        uint8_t slot = order[i];
+        const char *ssid = s_profiles.slots[slot].ssid;
+
+        int rssi = INT_MIN;
+        for (uint16_t k = 0; k < ap_count; k++) {
+            if (strcmp((const char *)ap_list[k].ssid, ssid) == 0 && ap_list[k].rssi > rssi) {
+                rssi = ap_list[k].rssi;
+            }
+        }
+        if (rssi == INT_MIN) continue;
+
+        int sc = rssi + history_bonus(&s_profiles.slots[slot].stat);
+
+        int j = n;
+        while (j > 0 && score[j - 1] < sc) {
+            s_cand[j] = s_cand[j - 1];
+            score[j] = score[j - 1];
+            j--;
         }
+        s_cand[j] = slot;
+        score[j] = sc;
+        seen[slot] = true;
+        n++;
     }
+    for (int i = count - 1; i >= 0; i--) {
+        if (!seen[order[i]]) s_cand[n++] = order[i];
+    }
+    PROFILES_UNLOCK();
 
-    // 写入 SSID 和 PWD
-    snprintf(key, sizeof(key), "%s%d", NVS_KEY_PREFIX_SSID, write_idx);
-    xn_storage_set_str(key, ssid);
-    
-    snprintf(key, sizeof(key), "%s%d", NVS_KEY_PREFIX_PWD, write_idx);
-    xn_storage_set_str(key, password ? password : "");
+    s_cand_count = n;
+    s_cand_next = 0;
+}
+
+// 尝试下一个候选，全部失败时发布断开事件
+static void try_next_candidate(void)
+{
+    char ssid[33];
+    char pwd[65];
+
+    while (s_cand_next < s_cand_count) {
+        uint8_t slot = s_cand[s_cand_next++];
+        PROFILES_LOCK();
+        const wifi_profile_t *p = &s_profiles.slots[slot];
+        bool valid = (p->ssid[0] != '\0'); // 选网期间配置可能已被删除
+        strlcpy(ssid, p->ssid, sizeof(ssid));
+        strlcpy(pwd, p->password, sizeof(pwd));
+        PROFILES_UNLOCK();
+        if (!valid) continue;
+
+        ESP_LOGI(TAG, "Trying WiFi %s (%d/%d)", ssid, s_cand_next, s_cand_count);
+        set_conn_params(ssid, pwd);
+        s_selecting = true;
+        esp_timer_stop(s_attempt_timer);
+        esp_timer_start_once(s_attempt_timer, (uint64_t)WIFI_ATTEMPT_TIMEOUT_MS * 1000);
+        if (xn_wifi_connect(s_wifi_instance, ssid, pwd) == ESP_OK) return;
+        esp_timer_stop(s_attempt_timer);
+    }
+
+    s_selecting = false;
+    ESP_LOGW(TAG, "No stored WiFi reachable");
+    xn_event_post(XN_EVT_WIFI_DISCONNECTED, XN_EVT_SRC_WIFI);
+}
+
+// 选网扫描完成回调（事件任务中调用）
+static void selection_scan_done_cb(uint16_t ap_count, wifi_ap_record_t *ap_list)
+{
+    if (!s_scanning) return;
+    s_scanning = false;
+    rank_profiles(ap_list, ap_list ? ap_count : 0);
+    try_next_candidate();
+}
+
+// 开始扫描选网，扫描无法启动时直接按最近使用顺序尝试
+static void start_selection(void)
+{
+    s_scanning = true;
+    if (xn_wifi_scan(s_wifi_instance, selection_scan_done_cb) != ESP_OK) {
+        ESP_LOGW(TAG, "Scan failed, trying stored WiFi by recency");
+        s_scanning = false;
+        rank_profiles(NULL, 0);
+        try_next_candidate();
+    }
+}
+
+#if CONFIG_XN_WIFI_LINK_MONITOR
+/* 链路质量采样与主动漫游：获取IP后周期读取RSSI并平滑，平滑值连续低于阈值时扫描一次，
+ * 已保存的AP（包括同SSID的其他BSSID）按选网同样的打分，高出当前链路滞回量才切换，
+ * 在掉线之前换到更好的AP，而不是等断开后再扫描选网。 */
+
+// 开始采样（获取IP后调用），上一条链路的平滑状态由定时器在下一次采样时清空
+static void link_monitor_start(void)
+{
+    s_link_reset = true;
+    esp_timer_stop(s_sample_timer);
+    esp_timer_start_periodic(s_sample_timer, (uint64_t)CONFIG_XN_WIFI_LINK_SAMPLE_MS * 1000);
+}
+
+// 停止采样（断开时调用）
+static void link_monitor_stop(void)
+{
+    if (s_sample_timer) esp_timer_stop(s_sample_timer);
+}
+
+// 连接漫游目标（旧AP断开后调用），锁定目标BSSID/信道，IP走DHCP
+static void connect_roam_target(void)
+{
+    set_conn_params(s_roam_ssid, s_roam_pwd);
+    s_roam_attempt = true;
+    esp_timer_stop(s_attempt_timer);
+    esp_timer_start_once(s_attempt_timer, (uint64_t)WIFI_ATTEMPT_TIMEOUT_MS * 1000);
+    if (xn_wifi_connect_fast(s_wifi_instance, s_roam_ssid, s_roam_pwd, &s_roam_link) == ESP_OK) return;
+    esp_timer_stop(s_attempt_timer);
+    s_roam_attempt = false;
+    start_selection();
+}
+
+#if CONFIG_XN_WIFI_ROAM
+// 漫游扫描完成回调（事件任务中调用）：找出比当前链路高出滞回量的已保存AP
+static void roam_scan_done_cb(uint16_t ap_count, wifi_ap_record_t *ap_list)
+{
+    if (!s_scanning) return;
+    s_scanning = false;
+    if (ap_list == NULL || xn_wifi_get_status(s_wifi_instance) != XN_WIFI_GOT_IP) return;
+
+    int rssi_avg = s_link.avg_q4 / 16;
+    int best = -1;
+    int best_score = INT_MIN;
+    uint8_t best_slot = 0;
+    int cur_score;
+
+    PROFILES_LOCK();
+    int idx = find_profile(s_conn_ssid);
+    cur_score = rssi_avg + (idx >= 0 ? history_bonus(&s_profiles.slots[s_profiles.order[idx]].stat)
+                                     : WIFI_HISTORY_BONUS_DB / 2);
+    for (uint16_t k = 0; k < ap_count; k++) {
+        if (memcmp(ap_list[k].bssid, s_link.bssid, sizeof(s_link.bssid)) == 0) continue; // 当前AP
+        int i = find_profile((const char *)ap_list[k].ssid);
+        if (i < 0) continue;
+        int sc = ap_list[k].rssi + history_bonus(&s_profiles.slots[s_profiles.order[i]].stat);
+        if (sc > best_score) {
+            best_score = sc;
+            best = k;
+            best_slot = s_profiles.order[i];
+        }
+    }
+    if (best >= 0 && best_score >= cur_score + CONFIG_XN_WIFI_ROAM_HYSTERESIS_DB) {
+        const wifi_profile_t *p = &s_profiles.slots[best_slot];
+        strlcpy(s_roam_ssid, p->ssid, sizeof(s_roam_ssid));
+        strlcpy(s_roam_pwd, p->password, sizeof(s_roam_pwd));
+    } else {
+        best = -1;
+    }
+    PROFILES_UNLOCK();
+
+    if (best < 0) {
+        ESP_LOGI(TAG, "No better AP than %s (avg %d dBm, score %d)", s_conn_ssid, rssi_avg, cur_score);
+        return;
+    }
+
+    const wifi_ap_record_t *ap = &ap_list[best];
+    memset(&s_roam_link, 0, sizeof(s_roam_link));
+    memcpy(s_roam_link.bssid, ap->bssid, sizeof(s_roam_link.bssid));
+    s_roam_link.channel = ap->primary;
+    ESP_LOGI(TAG, "Roaming %s (avg %d dBm) -> %s (ch %d, %d dBm)",
+             s_conn_ssid, rssi_avg, s_roam_ssid, ap->primary, ap->rssi);
+
+    xn_evt_wifi_connected_t evt = {0};
+    strlcpy((char *)evt.ssid, s_roam_ssid, sizeof(evt.ssid));
+    memcpy(evt.bssid, ap->bssid, sizeof(evt.bssid));
+    evt.rssi = ap->rssi;
+    evt.channel = ap->primary;
+    xn_event_post_data(XN_EVT_WIFI_ROAMING, XN_EVT_SRC_WIFI, &evt, sizeof(evt));
+
+    // 单个 STA 不能同时关联两个AP：先离开旧AP，在断开回调中连接目标
+    s_roam_pending = true;
+    if (xn_wifi_disconnect(s_wifi_instance) != ESP_OK) s_roam_pending = false;
+}
+
+// 链路持续变弱时扫描一次，同一时间只有一个连接流程，冷却期内不重复扫描
+static void roam_check(int rssi_avg)
+{
+    int64_t now = esp_timer_get_time();
+    if (s_link.roam_check_us != 0 &&
+        now - s_link.roam_check_us < (int64_t)CONFIG_XN_WIFI_ROAM_COOLDOWN_SEC * 1000000) return;
+    if (s_scanning || s_selecting || s_fast_attempt || s_roam_pending || s_roam_attempt) return;
+
+    s_link.roam_check_us = now;
+    s_scanning = true;
+    if (xn_wifi_scan(s_wifi_instance, roam_scan_done_cb) != ESP_OK) {
+        s_scanning = false; // 已有扫描进行中（如Web扫描），冷却后再试
+        return;
+    }
+    ESP_LOGI(TAG, "Link weak (avg %d dBm), scanning for a better AP", rssi_avg);
+}
+#endif
+
+// 采样定时器回调（esp_timer 任务中调用）：平滑RSSI，变化时发布链路质量事件
+static void link_sample_cb(void *arg)
+{
+    (void)arg;
+    xn_wifi_link_quality_t q;
+    if (xn_wifi_get_link_quality(s_wifi_instance, &q) != ESP_OK) return;
+
+    if (s_link_reset) {
+        int64_t roam_check_us = s_link.roam_check_us; // 冷却时间跨连接保留，避免在两个AP之间来回切换
+        memset(&s_link, 0, sizeof(s_link));
+        s_link.roam_check_us = roam_check_us;
+        s_link_reset = false;
+    }
+
+    // RSSI 与偏差的指数平滑，偏差用平滑前的误差（与 TCP 的 RTTVAR 相同）
+    int16_t x = (int16_t)q.rssi * 16;
+    if (s_link.samples == 0) {
+        s_link.avg_q4 = x;
+    } else {
+        int16_t err = x - s_link.avg_q4;
+        s_link.avg_q4 += err / LINK_EWMA_DIV;
+        s_link.dev_q4 += ((err < 0 ? -err : err) - s_link.dev_q4) / LINK_EWMA_DIV;
+    }
+    s_link.samples++;
+    memcpy(s_link.bssid, q.bssid, sizeof(s_link.bssid));
+
+    int8_t avg = (int8_t)((s_link.avg_q4 - 8) / 16); // 四舍五入（值为负）
+    bool was_weak = s_link.weak >= CONFIG_XN_WIFI_LINK_WEAK_SAMPLES;
+    if (avg < CONFIG_XN_WIFI_LINK_WEAK_RSSI) {
+        if (s_link.weak < UINT8_MAX) s_link.weak++;
+    } else {
+        s_link.weak = 0;
+    }
+    bool weak = s_link.weak >= CONFIG_XN_WIFI_LINK_WEAK_SAMPLES;
+
+    // 平滑值变化不到1dB且强弱不变时不发布，订阅者处理不及时由 LATEST_ONLY 策略合并
+    if (s_link.samples == 1 || avg != s_link.published_avg || weak != was_weak) {
+        s_link.published_avg = avg;
+        xn_evt_wifi_link_t evt = {
+            .rssi = q.rssi,
+            .rssi_avg = avg,
+            .rssi_dev = (uint8_t)((s_link.dev_q4 + 8) / 16),
+            .channel = q.channel,
+            .phy = q.phy,
+            .weak_samples = s_link.weak,
+            .samples = s_link.samples,
+        };
+        xn_event_post_data(XN_EVT_WIFI_LINK_QUALITY, XN_EVT_SRC_WIFI, &evt, sizeof(evt));
+    }
+
+#if CONFIG_XN_WIFI_ROAM
+    if (weak) roam_check(avg);
+#endif
+}
+#endif
+
+// 保存快速重连缓存（获取IP后调用）
+static void save_fast_cache(void)
+{
+    wifi_fast_cache_t cache = {0};
+    if (xn_wifi_get_link_info(s_wifi_instance, &cache.link) != ESP_OK) return;
+    strlcpy(cache.ssid, s_conn_ssid, sizeof(cache.ssid));
+
+    // 内容不变时存储组件不会产生写入
+    xn_storage_set_record(NVS_KEY_WIFI_FAST, WIFI_FAST_VERSION, &cache, sizeof(cache));
+}
+
+// 尝试按缓存快速连接，缓存不存在或对应的配置已删除时返回false
+static bool try_fast_connect(void)
+{
+    wifi_fast_cache_t cache;
+    if (xn_storage_get_record(NVS_KEY_WIFI_FAST, WIFI_FAST_VERSION, &cache, sizeof(cache), NULL) != ESP_OK) {
+        return false;
+    }
+    cache.ssid[sizeof(cache.ssid) - 1] = '\0';
+    if (cache.link.channel == 0) return false;
+
+    char ssid[33];
+    char pwd[65];
+    PROFILES_LOCK();
+    int idx = find_profile(cache.ssid);
+    if (idx >= 0) {
+        const wifi_profile_t *p = &s_profiles.slots[s_profiles.order[idx]];
+        strlcpy(ssid, p->ssid, sizeof(ssid));
+        strlcpy(pwd, p->password, sizeof(pwd));
+    }
+    PROFILES_UNLOCK();
+    if (idx < 0) return false;
+
+    ESP_LOGI(TAG, "Fast connect to %s (ch %d)", ssid, cache.link.channel);
+    set_conn_params(ssid, pwd);
+    s_fast_attempt = true;
+    if (xn_wifi_connect_fast(s_wifi_instance, ssid, pwd, &cache.link) != ESP_OK) {
+        s_fast_attempt = false;
+        return false;
+    }
+    return true;
 }
 
 // 加载并连接最佳WiFi
 static void load_and_connect_best_wifi(void)
 {
-    // 读取 NVS 中最近的一个配置进行连接
-    // 假设最后一个有效
-    uint8_t count = 0;
-    xn_storage_get_u8(NVS_KEY_WIFI_COUNT, &count);
+    uint8_t count = wifi_manager_get_stored_configs_count();
     
     if (count == 0) {
         ESP_LOGW(TAG, "No saved WiFi config found, requesting provisioning...");
@@ -229,22 +897,13 @@ static void load_and_connect_best_wifi(void)
         return;
     }
 
-    int idx = count - 1; // 尝试最后一个
-    char key[32];
-    char ssid[33] = {0};
-    char pwd[65] = {0};
-    size_t len;
-    
-    snprintf(key, sizeof(key), "%s%d", NVS_KEY_PREFIX_SSID, idx);
-    len = sizeof(ssid);
-    if (xn_storage_get_str(key, ssid, &len) != ESP_OK) return;
-    
-    snprintf(key, sizeof(key), "%s%d", NVS_KEY_PREFIX_PWD, idx);
-    len = sizeof(pwd);
-    xn_storage_get_str(key, pwd, &len);
+    cancel_connect_flow();
+
+    // 优先按上次成功的BSSID/信道快速连接，失败时在断开回调中转入扫描选网
+    if (try_fast_connect()) return;
 
-    ESP_LOGI(TAG, "Connecting to saved WiFi: %s", ssid);
-    xn_wifi_connect(s_wifi_instance, ssid, pwd);
+    ESP_LOGI(TAG, "Scanning for %d saved WiFi networks", count);
+    start_selection();
 }
 
 
@@ -256,14 +915,37 @@ esp_err_t wifi_manager_connect(const char *ssid, const char *password)
     // 1. 保存配置
     save_wifi_config_to_nvs(ssid, password);
     
-    // 2. 执行连接
+    // 2. 执行连接（新配置走完整扫描，成功后刷新快速重连缓存）
+    cancel_connect_flow();
+    set_conn_params(ssid, password);
     return xn_wifi_connect(s_wifi_instance, ssid, password);
 }
 
+// 按已知的BSSID/信道连接WiFi接口
+esp_err_t wifi_manager_connect_hint(const char *ssid, const char *password, const uint8_t bssid[6], uint8_t channel)
+{
+    if (!s_initialized) return ESP_ERR_INVALID_STATE;
+    if (ssid == NULL || bssid == NULL || channel == 0) return ESP_ERR_INVALID_ARG;
+
+    save_wifi_config_to_nvs(ssid, password);
+
+    // 走快速连接路径：失败时在断开回调中回退到扫描选网（新配置已是最近使用）
+    cancel_connect_flow();
+    set_conn_params(ssid, password);
+    xn_wifi_link_info_t link = {0};
+    memcpy(link.bssid, bssid, sizeof(link.bssid));
+    link.channel = channel;
+    s_fast_attempt = true;
+    esp_err_t ret = xn_wifi_connect_fast(s_wifi_instance, ssid, password, &link);
+    if (ret != ESP_OK) s_fast_attempt = false;
+    return ret;
+}
+
 // 断开WiFi接口
 esp_err_t wifi_manager_disconnect(void)
 {
     if (!s_initialized) return ESP_ERR_INVALID_STATE;
+    cancel_connect_flow();
     return xn_wifi_disconnect(s_wifi_instance);
 }
 
@@ -277,91 +959,68 @@ bool wifi_manager_is_connected(void)
 // 获取IP接口
 uint32_t wifi_manager_get_ip(void)
 {
-    // xn_wifi 暂未暴露 get_ip，需补充或通过 esp_netif 获取
-    // 暂时返回0
-    return 0;
+    if (!s_initialized || !s_wifi_instance) return 0;
+    xn_wifi_link_info_t link;
+    if (xn_wifi_get_link_info(s_wifi_instance, &link) != ESP_OK) return 0;
+    return link.ip;
 }
 
 // 扫描WiFi接口
 esp_err_t wifi_manager_scan(xn_wifi_scan_done_cb_t callback)
 {
     if (!s_initialized) return ESP_ERR_INVALID_STATE;
+    if (s_scanning) return ESP_ERR_INVALID_STATE; // 选网扫描进行中，避免替换扫描回调
     return xn_wifi_scan(s_wifi_instance, callback);
 }
 
 // 获取存储的WiFi配置数量
 uint8_t wifi_manager_get_stored_configs_count(void)
 {
-    uint8_t count = 0;
-    xn_storage_get_u8(NVS_KEY_WIFI_COUNT, &count);
+    if (!s_initialized) return 0;
+    PROFILES_LOCK();
+    uint8_t count = s_profiles.count;
+    PROFILES_UNLOCK();
     return count;
 }
 
 // 获取指定索引的WiFi配置
 esp_err_t wifi_manager_get_stored_config(uint8_t index, char *ssid, char *password)
 {
-    uint8_t count = wifi_manager_get_stored_configs_count();
-    if (index >= count) return ESP_ERR_INVALID_ARG;
+    if (!s_initialized) return ESP_ERR_INVALID_STATE;
+    if (ssid == NULL) return ESP_ERR_INVALID_ARG;
 
-    char key[32];
-    size_t len;
-    
-    // 读取SSID
-    snprintf(key, sizeof(key), "%s%d", NVS_KEY_PREFIX_SSID, index);
-    len = 33; // Max SSID len + 1
-    if (xn_storage_get_str(key, ssid, &len) != ESP_OK) return ESP_FAIL;
-    
-    // 读取Password
-    snprintf(key, sizeof(key), "%s%d", NVS_KEY_PREFIX_PWD, index);
-    len = 65; // Max PWD len + 1
-    if (xn_storage_get_str(key, password, &len) != ESP_OK) {
-        // 如果密码读取失败（可能没有密码），设置为空字符串
-        if (password) password[0] = '\0';
+    esp_err_t ret = ESP_ERR_INVALID_ARG;
+    PROFILES_LOCK();
+    if (index < s_profiles.count) {
+        const wifi_profile_t *p = &s_profiles.slots[s_profiles.order[index]];
+        strlcpy(ssid, p->ssid, sizeof(p->ssid));
+        if (password) strlcpy(password, p->password, sizeof(p->password));
+        ret = ESP_OK;
     }
-
-    return ESP_OK;
+    PROFILES_UNLOCK();
+    return ret;
 }
 
 // 删除指定索引的WiFi配置
 esp_err_t wifi_manager_delete_stored_config(uint8_t index)
 {
-    uint8_t count = wifi_manager_get_stored_configs_count();
-    if (index >= count) return ESP_ERR_INVALID_ARG;
-    
-    // 简单的删除逻辑：如果是最后一个，直接减count；如果不是，移动后面的向前填补
-    // 这里为了实现方便，我们只做简单的尾部删除支持，或者支持中间删除但需要移动数据
-    
-    // 实现移动逻辑
-    char key_src[32], key_dst[32];
-    char val_buf[65];
-    size_t len;
-    
-    for (int i = index; i < count - 1; i++) {
-        // 移动SSID
-        snprintf(key_src, sizeof(key_src), "%s%d", NVS_KEY_PREFIX_SSID, i + 1);
-        len = sizeof(val_buf);
-        if (xn_storage_get_str(key_src, val_buf, &len) == ESP_OK) {
-            snprintf(key_dst, sizeof(key_dst), "%s%d", NVS_KEY_PREFIX_SSID, i);
-            xn_storage_set_str(key_dst, val_buf);
-        }
-        
-        // 移动Password
-        snprintf(key_src, sizeof(key_src), "%s%d", NVS_KEY_PREFIX_PWD, i + 1);
-        len = sizeof(val_buf);
-        if (xn_storage_get_str(key_src, val_buf, &len) == ESP_OK) {
-            snprintf(key_dst, sizeof(key_dst), "%s%d", NVS_KEY_PREFIX_PWD, i);
-            xn_storage_set_str(key_dst, val_buf);
-        } else {
-             // 如果源没有密码（空），也要把目的置空
-             snprintf(key_dst, sizeof(key_dst), "%s%d", NVS_KEY_PREFIX_PWD, i);
-             xn_storage_set_str(key_dst, "");
-        }
+    if (!s_initialized) return ESP_ERR_INVALID_STATE;
+
+    PROFILES_LOCK();
+    if (index >= s_profiles.count) {
+        PROFILES_UNLOCK();
+        return ESP_ERR_INVALID_ARG;
     }
-    
-    // 更新数量
-    count--;
-    xn_storage_set_u8(NVS_KEY_WIFI_COUNT, count);
-    
+
+    // 清空槽位并从顺序表中移除，不搬动其他配置
+    uint8_t slot = s_profiles.order[index];
+    memset(&s_profiles.slots[slot], 0, sizeof(wifi_profile_t));
+    memmove(&s_profiles.order[index], &s_profiles.order[index + 1], s_profiles.count - index - 1);
+    s_profiles.count--;
+    save_profiles();
+    PROFILES_UNLOCK();
+    xn_storage_commit();
+
     return ESP_OK;
 }
 
@@ -46,7 +46,12 @@ esp_err_t wifi_manager_deinit(void);
 /**
  * @brief 启动WiFi管理器
  * 
+ * - 已获取IP时不重连，重新发布已连接/获取IP事件；连接流程进行中时等待其结果
  * - 尝试连接最近一次保存的WiFi配置
+ * - 有上次成功连接的缓存时，锁定BSSID/信道并复用上次的IP（跳过扫描和DHCP），
+ *   快速连接失败后自动回退到扫描选网 + DHCP
+ * - 扫描选网：扫描到的配置按 RSSI + 历史成功率排序，未扫描到的（隐藏网络）
+ *   按最近使用顺序排在后面，依次尝试，每个候选限时 8 秒；全部失败后发布断开事件
  * 
  * @return esp_err_t 启动结果
  */
@@ -64,7 +69,7 @@ esp_err_t wifi_manager_stop(void);
 /**
  * @brief 连接指定WiFi
  * 
- * - 保存SSID和密码到NVS
+ * - 保存SSID和密码到NVS（LRU，最多10个，已满时淘汰最久未用的配置）
  * - 调用底层连接接口
  * 
  * @param ssid WiFi名称
@@ -73,6 +78,21 @@ esp_err_t wifi_manager_stop(void);
  */
 esp_err_t wifi_manager_connect(const char *ssid, const char *password);
 
+/**
+ * @brief 按已知的BSSID/信道连接指定WiFi
+ * 
+ * - 保存SSID和密码（同 wifi_manager_connect）
+ * - 锁定BSSID和信道直接关联，跳过全信道扫描，IP走DHCP
+ * - 失败时回退到扫描选网
+ * 
+ * @param ssid WiFi名称
+ * @param password WiFi密码
+ * @param bssid 目标AP的BSSID（如配网扫描得到的最强AP）
+ * @param channel 目标AP所在信道
+ * @return esp_err_t 连接请求结果
+ */
+esp_err_t wifi_manager_connect_hint(const char *ssid, const char *password, const uint8_t bssid[6], uint8_t channel);
+
 /**
  * @brief 断开当前WiFi连接
  * 
@@ -91,7 +111,7 @@ bool wifi_manager_is_connected(void);
 /**
  * @brief 获取当前IP地址
  * 
- * @return uint32_t IP地址（网络字节序或根据具体实现）
+ * @return uint32_t IP地址（网络字节序），未获取IP时返回0
  */
 uint32_t wifi_manager_get_ip(void);
 
@@ -112,7 +132,7 @@ uint8_t wifi_manager_get_stored_configs_count(void);
 /**
  * @brief 获取指定索引的WiFi配置
  * 
- * @param index 索引 (0 ~ count-1)
+ * @param index 索引 (0 ~ count-1)，按使用时间排序，0 为最久未用
  * @param ssid输出缓冲区 (>=33字节)
  * @param password输出缓冲区 (>=65字节)
  * @return esp_err_t 成功返回ESP_OK
@@ -0,0 +1,175 @@
+# -*- coding: utf-8 -*-
+"""
+图片分区镜像生成工具
+
+功能说明：
+    把 UI 用到的图片（PNG / JPG / BMP，SquareLine 工程的 assets 目录）预先转换为
+    显示的渲染格式，打包成写入 assets 数据分区的镜像，由 components/xn_assets
+    通过 esp_partition_mmap 读取。
+
+    LVGL 绘制这些图片时不需要解码，也不需要图片缓存：像素直接从 flash 拷贝到
+    绘制缓冲区，切换页面时没有解码开销。
+    - 不透明图片：RGB565（LV_COLOR_FORMAT_RGB565）
+    - 带透明度的图片：RGB565 平面 + A8 平面（LV_COLOR_FORMAT_RGB565A8）
+
+    像素按 LVGL 的内存格式存放（小端 RGB565），与绘制缓冲区一致，
+    可以整行拷贝，不能预先按面板的 SPI 字节序交换。
+
+用法：
+    python tools/assets/build_assets.py ../../lvgl/assets --partition-size 0x100000 -o build/assets.bin
+
+    图片名为文件名（不含扩展名），固件中用 xn_assets_get("名称") 取得。
+    名称只能包含字母、数字、'_'、'-'、'.'，不超过 31 个字符，目录之间不能重名。
+
+镜像格式（小端）：
+    文件头 32 字节：
+        magic "XNAS" | version u16 | flags u16 | image_count u32 | data_size u32
+        crc32 u32（图片表 + 像素区） | reserved u32 × 3
+    图片表 image_count × 48 字节，按名称升序（字节序比较）：
+        name char[32]（'\\0' 填充） | width u16 | height u16 | cf u8（LVGL 颜色格式）
+        reserved u8 | stride u16（RGB565 平面行跨度） | offset u32 | size u32
+    像素区：
+        每张图片从 4 字节对齐处开始。
+        RGB565：height 行，每行 stride 字节，每像素 2 字节小端
+        RGB565A8：RGB565 平面之后紧跟 A8 平面，每行 stride / 2 字节
+"""
+
+import argparse
+import re
+import struct
+import sys
+import zlib
+from pathlib import Path
+
+try:
+    from PIL import Image
+except ImportError:  # pragma: no cover
+    Image = None
+
+
+# 镜像魔数与版本，与 xn_assets.c 保持一致
+IMAGE_MAGIC = b"XNAS"
+IMAGE_VERSION = 1
+# 名称字段长度（含结束符）
+NAME_MAX = 32
+# LVGL 颜色格式（lv_color_format_t）
+LV_COLOR_FORMAT_RGB565 = 0x12
+LV_COLOR_FORMAT_RGB565A8 = 0x14
+# 像素对齐，与 LV_DRAW_BUF_ALIGN 一致
+DATA_ALIGN = 4
+
+# 读取的图片后缀
+IMAGE_SUFFIXES = (".png", ".jpg", ".jpeg", ".bmp")
+# 名称允许的字符
+NAME_PATTERN = re.compile(r"^[A-Za-z0-9_.-]+$")
+
+
+class AssetError(Exception):
+    """输入图片错误"""
+
+
+def collect_images(paths: list[Path]) -> dict[str, Path]:
+    """收集图片文件，返回 名称 -> 路径"""
+    images = {}
+    for root in paths:
+        if root.is_file():
+            files = [root]
+        elif root.is_dir():
+            files = sorted(p for p in root.rglob("*") if p.suffix.lower() in IMAGE_SUFFIXES)
+        else:
+            raise AssetError(f"{root} 不存在")
+        for f in files:
+            name = f.stem
+            if not NAME_PATTERN.match(name) or len(name.encode("ascii")) >= NAME_MAX:
+                raise AssetError(f"{f}：名称只能包含字母、数字、'_'、'-'、'.'，且不超过 {NAME_MAX - 1} 个字符")
+            if name in images:
+                raise AssetError(f"图片重名：{images[name]} 与 {f}")
+            images[name] = f
+    return images
+
+
+def convert_image(path: Path) -> tuple[int, int, int, int, bytes]:
+    """
+    转换一张图片
+
+    返回：
+        (宽, 高, 颜色格式, 行跨度, 像素数据)
+    """
+    with Image.open(path) as img:
+        img = img.convert("RGBA")
+        width, height = img.size
+        if width > 0xFFFF or height > 0xFFFF or width * 2 > 0xFFFF:
+            raise AssetError(f"{path}：尺寸 {width}x{height} 超出镜像格式范围")
+        pixels = list(img.getdata())
+
+    rgb = bytearray()
+    alpha = bytearray()
+    for r, g, b, a in pixels:
+        # 四舍五入到 5/6/5 位
+        value = (((r * 31 + 127) // 255) << 11) | (((g * 63 + 127) // 255) << 5) | ((b * 31 + 127) // 255)
+        rgb += struct.pack("<H", value)
+        alpha.append(a)
+
+    stride = width * 2
+    if all(a == 0xFF for a in alpha):
+        return width, height, LV_COLOR_FORMAT_RGB565, stride, bytes(rgb)
+    return width, height, LV_COLOR_FORMAT_RGB565A8, stride, bytes(rgb) + bytes(alpha)
+
+
+def build_image(images: dict[str, Path]) -> tuple[bytes, dict[str, tuple[int, int, int]]]:
+    """
+    生成分区镜像
+
+    返回：
+        (镜像内容, 名称 -> (宽, 高, 颜色格式))
+    """
+    names = sorted(images, key=lambda n: n.encode("ascii"))
+    table = bytearray()
+    data = bytearray()
+    summary = {}
+    for name in names:
+        width, height, cf, stride, pixels = convert_image(images[name])
+        data += bytes(-len(data) % DATA_ALIGN)
+        table += struct.pack("<32sHHBBHII", name.encode("ascii"), width, height, cf, 0,
+                             stride, len(data), len(pixels))
+        data += pixels
+        summary[name] = (width, height, cf)
+
+    body = bytes(table) + bytes(data)
+    header = struct.pack("<4sHHIII12s", IMAGE_MAGIC, IMAGE_VERSION, 0,
+                         len(names), len(data), zlib.crc32(body), bytes(12))
+    return header + body, summary
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="生成 xn_assets 图片分区镜像")
+    parser.add_argument("inputs", nargs="+", type=Path, help="图片文件或目录（递归查找）")
+    parser.add_argument("--partition-size", type=lambda s: int(s, 0), default=0, help="分区大小，超出时报错")
+    parser.add_argument("-o", "--output", required=True, type=Path, help="输出镜像")
+    args = parser.parse_args()
+
+    if Image is None:
+        print("错误：需要 Pillow（pip install pillow）", file=sys.stderr)
+        return 1
+
+    try:
+        image, summary = build_image(collect_images(args.inputs))
+    except (OSError, AssetError, ValueError) as e:
+        print(f"错误：{e}", file=sys.stderr)
+        return 1
+
+    if args.partition_size and len(image) > args.partition_size:
+        print(f"错误：镜像 {len(image)} 字节超出分区大小 {args.partition_size}", file=sys.stderr)
+        return 1
+
+    args.output.parent.mkdir(parents=True, exist_ok=True)
+    args.output.write_bytes(image)
+    for name, (width, height, cf) in summary.items():
+        fmt = "RGB565A8" if cf == LV_COLOR_FORMAT_RGB565A8 else "RGB565"
+        print(f"  {name}: {width}x{height} {fmt}")
+    print(f"{len(summary)} 张图片，镜像 {len(image)} 字节")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
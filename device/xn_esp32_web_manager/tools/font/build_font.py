@@ -0,0 +1,353 @@
+# -*- coding: utf-8 -*-
+"""
+字体分区镜像生成工具
+
+功能说明：
+    把 LVGL 二进制字体（lv_font_conv / SquareLine 导出的 .bin）裁剪为实际用到的字形，
+    压缩后生成写入 font 数据分区的镜像，由 components/xn_font 通过 esp_partition_mmap 读取。
+
+    字符集 = ASCII 可见字符
+           + 源码字符串字面量中出现的非 ASCII 字符（--scan，注释不计入）
+           + 常用字表（--charset 文本文件 / --fcfg SquareLine 字体配置中的 symbols）
+
+    输入字体需为未压缩格式（lv_font_conv --no-compress），.ttf 可先用 lv_font_conv 转换：
+        npx lv_font_conv --font PingFangSC-Regular.ttf --size 16 --bpp 1 --format bin \\
+            --no-compress -r 0x20-0x7E --symbols "..." -o font.bin
+
+用法：
+    python tools/font/build_font.py --bin ../../lvgl/assets/ui_font_pingfang16.bin \\
+        --fcfg ../../lvgl/assets/ui_font_pingfang16.fcfg --scan main -o build/font.bin
+
+镜像格式（小端）：
+    文件头 32 字节：
+        magic "XNFT" | version u16 | bpp u8 | flags u8 | line_height u16 | base_line i16
+        underline_position i8 | underline_thickness i8 | reserved u16
+        glyph_count u32 | bitmap_size u32 | crc32 u32（字形表 + 位图） | reserved u32
+    字形表 glyph_count × 16 字节，按 unicode 升序：
+        unicode u32 | offset u32 | length u16 | adv_w u8 | box_w u8 | box_h u8
+        ofs_x i8 | ofs_y i8 | flags u8（bit0：RLE 压缩）
+    位图区：
+        未压缩：bpp 位一个像素，按行连续打包，高位在前
+        RLE：从第二行起每个像素先与上一行同列像素异或，再按游程编码成位流（高位在前）。
+             1 bpp：首位为第一个游程的像素值，之后各游程值交替，只记游程长度；
+             其他：每个游程先记 bpp 位像素值，再记游程长度。
+             游程长度 n 用 k=1 的 Rice 码：(n - 1) >> 1 个 1、一个 0、再 1 位 (n - 1) & 1。
+             1 bpp 的汉字位图本身很密，压缩只能省 10%~15%，主要收益来自裁剪字符集。
+"""
+
+import argparse
+import re
+import struct
+import sys
+import zlib
+from pathlib import Path
+
+
+# 镜像魔数与版本，与 xn_font.c 保持一致
+IMAGE_MAGIC = b"XNFT"
+IMAGE_VERSION = 1
+# 字形标志：RLE 压缩
+GLYPH_FLAG_RLE = 0x01
+
+# 扫描的源码后缀
+SOURCE_SUFFIXES = (".c", ".h", ".cpp")
+
+
+class FontError(Exception):
+    """输入字体格式错误"""
+
+
+class BitReader:
+    """按位读取（高位在前），对应 lv_font_conv 的位流格式"""
+
+    def __init__(self, data: bytes, offset: int):
+        self._data = data
+        self._bit = offset * 8
+
+    def read(self, bits: int, signed: bool = False) -> int:
+        value = 0
+        for _ in range(bits):
+            byte = self._data[self._bit >> 3]
+            value = (value << 1) | ((byte >> (7 - (self._bit & 7))) & 1)
+            self._bit += 1
+        if signed and bits > 0 and value & (1 << (bits - 1)):
+            value -= 1 << bits
+        return value
+
+
+def parse_lvgl_bin(data: bytes) -> tuple[dict, dict[int, dict]]:
+    """
+    解析 LVGL 二进制字体
+
+    返回：
+        (字体参数, unicode -> 字形)，字形包含 adv_w、ofs_x、ofs_y、box_w、box_h、pixels（像素值列表）
+    """
+    tables = {}
+    pos = 0
+    while pos + 8 <= len(data):
+        length, tag = struct.unpack_from("<I4s", data, pos)
+        if length < 8 or pos + length > len(data):
+            raise FontError(f"表 {tag!r} 长度错误")
+        tables[tag.decode("ascii", "replace")] = (pos, length)
+        pos += length
+    for tag in ("head", "cmap", "loca", "glyf"):
+        if tag not in tables:
+            raise FontError(f"缺少 {tag} 表")
+
+    head_pos = tables["head"][0] + 8
+    (_version, _tables, _size, ascent, descent, _typo_asc, _typo_desc, _gap, _min_y, _max_y,
+     _default_adv, _kern_scale, loca_fmt, _gid_fmt, adv_fmt, bpp, xy_bits, wh_bits, adv_bits,
+     compression, _subpx, _pad, ul_pos, ul_thick) = struct.unpack_from("<IHHHhHhHhhHHBBBBBBBBBBhH", data, head_pos)
+    if compression != 0:
+        raise FontError("输入字体已压缩，请使用 lv_font_conv --no-compress 重新导出")
+    if bpp not in (1, 2, 3, 4):
+        raise FontError(f"不支持 {bpp} bpp")
+
+    # loca：glyph id -> 相对 glyf 表起始的偏移
+    loca_pos = tables["loca"][0] + 8
+    (loca_count,) = struct.unpack_from("<I", data, loca_pos)
+    loca_item = "<I" if loca_fmt == 1 else "<H"
+    loca_size = struct.calcsize(loca_item)
+    loca = [struct.unpack_from(loca_item, data, loca_pos + 4 + i * loca_size)[0] for i in range(loca_count)]
+    glyf_pos, glyf_len = tables["glyf"]
+
+    # cmap：unicode -> glyph id
+    cmap_pos = tables["cmap"][0]
+    (sub_count,) = struct.unpack_from("<I", data, cmap_pos + 8)
+    code_to_gid = {}
+    for i in range(sub_count):
+        (data_ofs, range_start, range_len, gid_start, entries, fmt, _pad2) = struct.unpack_from(
+            "<IIHHHBB", data, cmap_pos + 12 + i * 16)
+        sub = cmap_pos + data_ofs
+        if fmt == 0:  # format0 full：每个码位一个 u8 glyph id 偏移
+            for k in range(range_len):
+                gid = gid_start + data[sub + k]
+                if data[sub + k] or k == 0:
+                    code_to_gid[range_start + k] = gid
+        elif fmt == 1:  # sparse full：u16 码位偏移 + u16 glyph id 偏移
+            for k in range(entries):
+                (cofs,) = struct.unpack_from("<H", data, sub + k * 2)
+                (gofs,) = struct.unpack_from("<H", data, sub + entries * 2 + k * 2)
+                code_to_gid[range_start + cofs] = gid_start + gofs
+        elif fmt == 2:  # format0 tiny：连续码位
+            for k in range(range_len):
+                code_to_gid[range_start + k] = gid_start + k
+        elif fmt == 3:  # sparse tiny：u16 码位偏移
+            for k in range(entries):
+                (cofs,) = struct.unpack_from("<H", data, sub + k * 2)
+                code_to_gid[range_start + cofs] = gid_start + k
+        else:
+            raise FontError(f"不支持的 cmap 格式 {fmt}")
+
+    glyphs = {}
+    for code, gid in code_to_gid.items():
+        if gid <= 0 or gid >= loca_count:
+            continue
+        start = glyf_pos + loca[gid]
+        end = glyf_pos + (loca[gid + 1] if gid + 1 < loca_count else glyf_len)
+        reader = BitReader(data, start)
+        adv = reader.read(adv_bits)
+        if adv_fmt == 1:  # FP12.4
+            adv = (adv + 8) >> 4
+        ofs_x = reader.read(xy_bits, signed=True)
+        ofs_y = reader.read(xy_bits, signed=True)
+        box_w = reader.read(wh_bits)
+        box_h = reader.read(wh_bits)
+        if (adv_bits + 2 * xy_bits + 2 * wh_bits + box_w * box_h * bpp + 7) // 8 > end - start:
+            raise FontError(f"U+{code:04X} 位图越界")
+        pixels = [reader.read(bpp) for _ in range(box_w * box_h)]
+        glyphs[code] = dict(adv_w=adv, ofs_x=ofs_x, ofs_y=ofs_y, box_w=box_w, box_h=box_h, pixels=pixels)
+
+    params = dict(bpp=bpp, line_height=ascent - descent, base_line=-descent,
+                  underline_position=ul_pos, underline_thickness=ul_thick)
+    return params, glyphs
+
+
+def pack_raw(pixels: list[int], bpp: int) -> bytes:
+    """按 bpp 把像素值连续打包，高位在前"""
+    out = bytearray()
+    acc = 0
+    nbits = 0
+    for v in pixels:
+        acc = (acc << bpp) | v
+        nbits += bpp
+        while nbits >= 8:
+            nbits -= 8
+            out.append((acc >> nbits) & 0xFF)
+    if nbits:
+        out.append((acc << (8 - nbits)) & 0xFF)
+    return bytes(out)
+
+
+class BitWriter:
+    """按位写入（高位在前）"""
+
+    def __init__(self):
+        self._out = bytearray()
+        self._acc = 0
+        self._nbits = 0
+
+    def write(self, value: int, bits: int):
+        for i in range(bits - 1, -1, -1):
+            self._acc = (self._acc << 1) | ((value >> i) & 1)
+            self._nbits += 1
+            if self._nbits == 8:
+                self._out.append(self._acc)
+                self._acc = 0
+                self._nbits = 0
+
+    def getvalue(self) -> bytes:
+        if self._nbits:
+            return bytes(self._out) + bytes(((self._acc << (8 - self._nbits)) & 0xFF,))
+        return bytes(self._out)
+
+
+def pack_rle(pixels: list[int], width: int, bpp: int) -> bytes:
+    """行间异或后按游程编码"""
+    filtered = list(pixels)
+    for i in range(len(pixels) - 1, width - 1, -1):
+        filtered[i] ^= pixels[i - width]
+
+    writer = BitWriter()
+    if bpp == 1 and filtered:
+        writer.write(filtered[0], 1)
+    i = 0
+    while i < len(filtered):
+        v = filtered[i]
+        run = 1
+        while i + run < len(filtered) and filtered[i + run] == v:
+            run += 1
+        if bpp != 1:
+            writer.write(v, bpp)
+        q = (run - 1) >> 1
+        writer.write((1 << (q + 1)) - 2, q + 1)   # q 个 1 加一个 0
+        writer.write((run - 1) & 1, 1)
+        i += run
+    return writer.getvalue()
+
+
+def unpack_glyph(blob: bytes, flags: int, width: int, count: int, bpp: int) -> list[int]:
+    """解码一个字形，用于生成后自检（与 xn_font.c 的 glyph_decode 一致）"""
+    reader = BitReader(blob, 0)
+    if not flags & GLYPH_FLAG_RLE:
+        return [reader.read(bpp) for _ in range(count)]
+    values = []
+    v = reader.read(1) if bpp == 1 and count else 0
+    while len(values) < count:
+        if bpp != 1:
+            v = reader.read(bpp)
+        q = 0
+        while reader.read(1):
+            q += 1
+        run = (q << 1) + reader.read(1) + 1
+        if len(values) + run > count:
+            raise FontError("RLE 长度不匹配")
+        values.extend([v] * run)
+        if bpp == 1:
+            v ^= 1
+    for i in range(width, count):
+        values[i] ^= values[i - width]
+    return values
+
+
+def scan_sources(paths: list[Path]) -> set[str]:
+    """收集源码字符串字面量中的非 ASCII 字符（跳过注释）"""
+    token = re.compile(r'//[^\n]*|/\*.*?\*/|"(?:\\.|[^"\\\n])*"|\'(?:\\.|[^\'\\\n])*\'', re.S)
+    chars = set()
+    for root in paths:
+        files = [root] if root.is_file() else sorted(p for p in root.rglob("*") if p.suffix in SOURCE_SUFFIXES)
+        for f in files:
+            text = f.read_text(encoding="utf-8", errors="ignore")
+            for m in token.finditer(text):
+                if m.group(0)[0] in "\"'":
+                    chars.update(c for c in m.group(0) if ord(c) > 0x7E)
+    return chars
+
+
+def load_charset(charset_files: list[Path], fcfg_files: list[Path]) -> set[str]:
+    """读取常用字表：文本文件中的所有非空白字符、SquareLine 字体配置的 symbols"""
+    import json
+
+    chars = set()
+    for f in charset_files:
+        chars.update(c for c in f.read_text(encoding="utf-8") if not c.isspace())
+    for f in fcfg_files:
+        cfg = json.loads(f.read_text(encoding="utf-8"))
+        chars.update(c for c in cfg.get("symbols", "") if not c.isspace())
+    return chars
+
+
+def build_image(params: dict, glyphs: dict[int, dict], codes: list[int]) -> tuple[bytes, int]:
+    """
+    生成分区镜像
+
+    返回：
+        (镜像内容, 未压缩时的位图大小)
+    """
+    bpp = params["bpp"]
+    table = bytearray()
+    bitmaps = bytearray()
+    raw_total = 0
+    for code in codes:
+        g = glyphs[code]
+        raw = pack_raw(g["pixels"], bpp)
+        rle = pack_rle(g["pixels"], g["box_w"], bpp) if g["pixels"] else b""
+        blob, flags = (rle, GLYPH_FLAG_RLE) if len(rle) < len(raw) else (raw, 0)
+        if unpack_glyph(blob, flags, g["box_w"], len(g["pixels"]), bpp) != g["pixels"]:
+            raise FontError(f"U+{code:04X} 自检失败")
+        if g["adv_w"] > 0xFF or g["box_w"] > 0xFF or g["box_h"] > 0xFF or len(blob) > 0xFFFF:
+            raise FontError(f"U+{code:04X} 尺寸超出镜像格式范围")
+        table += struct.pack("<IIHBBBbbB", code, len(bitmaps), len(blob),
+                             g["adv_w"], g["box_w"], g["box_h"], g["ofs_x"], g["ofs_y"], flags)
+        bitmaps += blob
+        raw_total += len(raw)
+
+    body = bytes(table) + bytes(bitmaps)
+    header = struct.pack("<4sHBBHhbbHIIII", IMAGE_MAGIC, IMAGE_VERSION, bpp, 0,
+                         params["line_height"], params["base_line"],
+                         max(-128, min(127, params["underline_position"])),
+                         max(-128, min(127, params["underline_thickness"])), 0,
+                         len(codes), len(bitmaps), zlib.crc32(body), 0)
+    return header + body, raw_total
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="生成 xn_font 字体分区镜像")
+    parser.add_argument("--bin", required=True, type=Path, help="LVGL 二进制字体（未压缩）")
+    parser.add_argument("--scan", action="append", default=[], type=Path, help="扫描字符串字面量的源码目录或文件")
+    parser.add_argument("--charset", action="append", default=[], type=Path, help="常用字表文本文件")
+    parser.add_argument("--fcfg", action="append", default=[], type=Path, help="SquareLine 字体配置（读取 symbols）")
+    parser.add_argument("--partition-size", type=lambda s: int(s, 0), default=0, help="分区大小，超出时报错")
+    parser.add_argument("-o", "--output", required=True, type=Path, help="输出镜像")
+    args = parser.parse_args()
+
+    try:
+        params, glyphs = parse_lvgl_bin(args.bin.read_bytes())
+        wanted = {chr(c) for c in range(0x20, 0x7F)}
+        used = scan_sources(args.scan)
+        wanted |= used | load_charset(args.charset, args.fcfg)
+
+        missing = sorted(c for c in used if ord(c) not in glyphs)
+        if missing:
+            print(f"警告：源码用到但字体中没有的字符：{''.join(missing)}", file=sys.stderr)
+
+        codes = sorted(ord(c) for c in wanted if ord(c) in glyphs)
+        image, raw_total = build_image(params, glyphs, codes)
+    except (OSError, FontError, ValueError) as e:
+        print(f"错误：{e}", file=sys.stderr)
+        return 1
+
+    if args.partition_size and len(image) > args.partition_size:
+        print(f"错误：镜像 {len(image)} 字节超出分区大小 {args.partition_size}", file=sys.stderr)
+        return 1
+
+    args.output.parent.mkdir(parents=True, exist_ok=True)
+    args.output.write_bytes(image)
+    bitmap_size = struct.unpack_from("<I", image, 20)[0]
+    print(f"{len(codes)} 个字形（源码用到 {len(used)} 个非 ASCII 字符），"
+          f"位图 {raw_total} -> {bitmap_size} 字节，镜像 {len(image)} 字节")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,198 @@
+# -*- coding: utf-8 -*-
+"""
+二进制日志解码工具
+
+功能说明：
+    把 components/xn_logstream 输出的日志批次（经 MQTT 发布到 <base_topic>/<client_id>/log）
+    还原为文本。格式串与 flash 中的常量字符串只记录了地址，需用同一次构建的固件 ELF 查找。
+
+用法：
+    # 一个文件一个批次，或多个批次首尾相连
+    python tools/logstream/decode_log.py --elf build/xn_esp32_web_manager.elf log_*.bin
+
+    # 直接从 MQTT 订阅（需要 paho-mqtt）
+    python tools/logstream/decode_log.py --elf build/xn_esp32_web_manager.elf \\
+        --mqtt broker.example.com --topic xn/device/<client_id>/log
+
+格式（小端）：
+    批次头 24 字节：
+        magic "XNLG" | version u8 | reserved u8 | count u16 | length u16 | reserved u16
+        seq u32 | dropped u32 | suppressed u32
+    记录（4 字节对齐）：
+        u32 头：bit0~15 记录总长，bit28 格式串内联，bit29 参数被截断
+        格式串：u32 地址，或内联（同 %s）
+        参数：按格式串的转换顺序，4 字节整数/指针，8 字节 ll 整数与 double；
+              %s 首字节 0xFF 后跟 u32 地址，0xFE 为 NULL，其他为内联长度 + 字节
+"""
+
+import argparse
+import re
+import struct
+import sys
+from pathlib import Path
+
+BATCH_MAGIC = 0x474C4E58
+BATCH_HEADER = struct.Struct("<IBBHHHIII")
+REC_LEN_MASK = 0xFFFF
+REC_FMT_INLINE = 1 << 28
+REC_TRUNCATED = 1 << 29
+STR_ADDR = 0xFF
+STR_NULL = 0xFE
+
+# printf 转换：标志/宽度/精度、长度修饰、转换字符
+CONV_RE = re.compile(r"%([-+ #0-9.*]*)([hlLqjzt]*)([diuxXocfFeEgGaAspn%])")
+ANSI_RE = re.compile(r"\x1b\[[0-9;]*m")
+
+
+class Elf:
+    """只读取已分配的 PROGBITS 段，按虚拟地址查找字符串"""
+
+    def __init__(self, path: Path):
+        data = path.read_bytes()
+        if data[:4] != b"\x7fELF" or data[4] != 1:
+            raise ValueError(f"{path}: 不是 32 位 ELF")
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", data, 0x2E)
+        self.data = data
+        self.sections = []
+        for i in range(shnum):
+            _, sh_type, flags, addr, offset, size = struct.unpack_from("<IIIIII", data, shoff + i * shentsize)
+            if sh_type == 1 and flags & 0x2 and size > 0:  # SHT_PROGBITS, SHF_ALLOC
+                self.sections.append((addr, offset, size))
+
+    def string(self, addr: int) -> str:
+        for base, offset, size in self.sections:
+            if base <= addr < base + size:
+                start = offset + addr - base
+                end = self.data.find(b"\0", start, offset + size)
+                return self.data[start:end if end >= 0 else offset + size].decode("utf-8", "replace")
+        return f"<0x{addr:08x}>"
+
+
+class Reader:
+    def __init__(self, data: bytes):
+        self.data = data
+        self.pos = 0
+
+    def take(self, n: int) -> bytes:
+        if self.pos + n > len(self.data):
+            raise EOFError
+        b = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return b
+
+    def u8(self) -> int:
+        return self.take(1)[0]
+
+    def u32(self) -> int:
+        return struct.unpack("<I", self.take(4))[0]
+
+    def string(self, elf: Elf) -> str:
+        mark = self.u8()
+        if mark == STR_ADDR:
+            return elf.string(self.u32())
+        if mark == STR_NULL:
+            return "(null)"
+        return self.take(mark).decode("utf-8", "replace")
+
+
+def format_record(fmt: str, r: Reader, elf: Elf) -> str:
+    """按格式串从记录中取参数并格式化，参数不足时保留剩余格式串原样"""
+    out = []
+    last = 0
+    for m in CONV_RE.finditer(fmt):
+        out.append(fmt[last:m.start()])
+        last = m.end()
+        spec, length, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        try:
+            # '*' 宽度/精度替换为实际值
+            while "*" in spec:
+                spec = spec.replace("*", str(struct.unpack("<i", r.take(4))[0]), 1)
+            longs = 2 if ("ll" in length or "q" in length or "j" in length) else 0
+            if conv in "diuxXoc":
+                if longs:
+                    v = struct.unpack("<q" if conv in "di" else "<Q", r.take(8))[0]
+                else:
+                    v = struct.unpack("<i" if conv in "di" else "<I", r.take(4))[0]
+                out.append(("%" + spec + ("d" if conv in "iu" else conv)) % v)
+            elif conv in "fFeEgGaA":
+                v = struct.unpack("<d", r.take(8))[0]
+                out.append(("%" + spec + ("f" if conv in "aA" else conv)) % v)
+            elif conv == "s":
+                out.append(("%" + spec + "s") % r.string(elf))
+            elif conv == "p":
+                out.append("0x%08x" % r.u32())
+        except EOFError:
+            out.append("<...>" + fmt[m.start():])
+            return "".join(out)
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+def decode_batches(data: bytes, elf: Elf, color: bool, state: dict):
+    pos = 0
+    while pos + BATCH_HEADER.size <= len(data):
+        magic, version, _, count, length, _, seq, dropped, suppressed = BATCH_HEADER.unpack_from(data, pos)
+        if magic != BATCH_MAGIC or length < BATCH_HEADER.size or pos + length > len(data):
+            print(f"# 无效批次 @ {pos}", file=sys.stderr)
+            return
+        if version != 1:
+            print(f"# 不支持的版本 {version}", file=sys.stderr)
+            return
+
+        # 批次序号与丢弃计数的跳变
+        if "seq" in state and seq != state["seq"] + 1:
+            print(f"# 批次丢失：{state['seq'] + 1} .. {seq - 1}")
+        for key, value in (("dropped", dropped), ("suppressed", suppressed)):
+            if value > state.get(key, 0):
+                print(f"# {key} +{value - state.get(key, 0)}")
+            state[key] = value
+        state["seq"] = seq
+
+        rec_pos = pos + BATCH_HEADER.size
+        for _ in range(count):
+            hdr, = struct.unpack_from("<I", data, rec_pos)
+            rec_len = hdr & REC_LEN_MASK
+            r = Reader(data[rec_pos + 4:rec_pos + rec_len])
+            fmt = r.string(elf) if hdr & REC_FMT_INLINE else elf.string(r.u32())
+            text = format_record(fmt, r, elf).rstrip("\n")
+            if hdr & REC_TRUNCATED:
+                text += " <truncated>"
+            print(text if color else ANSI_RE.sub("", text))
+            rec_pos += rec_len
+        pos += length
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="解码 xn_logstream 二进制日志")
+    parser.add_argument("--elf", required=True, type=Path, help="与设备固件同一次构建的 ELF")
+    parser.add_argument("--color", action="store_true", help="保留 ANSI 颜色")
+    parser.add_argument("--mqtt", help="MQTT Broker 地址，指定时从 --topic 订阅")
+    parser.add_argument("--port", type=int, default=1883, help="MQTT 端口")
+    parser.add_argument("--topic", help="日志 Topic，如 xn/device/<client_id>/log")
+    parser.add_argument("inputs", nargs="*", type=Path, help="批次文件")
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    state = {}
+
+    if args.mqtt:
+        import paho.mqtt.client as mqtt
+
+        client = mqtt.Client()
+        client.on_connect = lambda c, u, f, rc: c.subscribe(args.topic)
+        client.on_message = lambda c, u, msg: decode_batches(msg.payload, elf, args.color, state)
+        client.connect(args.mqtt, args.port)
+        client.loop_forever()
+        return 0
+
+    for path in args.inputs:
+        decode_batches(path.read_bytes(), elf, args.color, state)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
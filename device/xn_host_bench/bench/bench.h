@@ -0,0 +1,47 @@
+/**
+ * @file bench.h
+ * @brief 主机微基准入口
+ *
+ * 每项结果按 "BENCH <项目> <数值> <单位>" 打印一行，与 baseline.txt 逐行比较即可发现回退。
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 事件总线微基准
+ *
+ * 测量项目：
+ * - 同步/异步分发每个事件的耗时与吞吐量，订阅者数 1/4/16
+ * - xn_event_post_data 负载 16~1024 字节相对 xn_event_post 的分配开销与池未命中次数
+ *
+ * 需在总线初始化后调用。
+ *
+ * @return esp_err_t
+ *      - ESP_OK: 完成
+ *      - ESP_ERR_TIMEOUT: 异步分发未在超时内完成
+ */
+esp_err_t bench_event_bus(void);
+
+/**
+ * @brief 状态机微基准
+ *
+ * 转换表大小 4/8/16/32 条时分别测量命中第一条、命中最后一条与未命中（经父状态冒泡）
+ * 的单事件处理耗时。测量期间屏蔽状态机组件的转换日志。
+ *
+ * @return esp_err_t
+ *      - ESP_OK: 完成
+ */
+esp_err_t bench_fsm(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_H */
@@ -0,0 +1,257 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 14:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 14:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_host_bench\bench\bench_event_bus.c
+ * @Description: 事件总线微基准 - 同步/异步分发随订阅者数的开销、负载分配开销
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <stdio.h>
+#include "bench.h"
+#include "xn_event_bus.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "xn_event_bench";
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+#define BENCH_EVT_SYNC          (XN_EVT_CAT_USER + 0x0F00)  ///< 同步分发基准事件ID
+#define BENCH_EVT_ASYNC         (XN_EVT_CAT_USER + 0x0F01)  ///< 异步分发基准事件ID
+#define BENCH_SYNC_EVENTS       2000    ///< 同步分发每组事件数
+#define BENCH_ASYNC_EVENTS      2000    ///< 异步分发每组事件数
+#define BENCH_ALLOC_BURST       16      ///< 分配开销每轮连续投递数（不超过普通队列深度）
+#define BENCH_ALLOC_ROUNDS      16      ///< 分配开销轮数
+#define BENCH_TIMEOUT_MS        5000    ///< 等待异步分发完成的超时
+
+typedef struct {
+    SemaphoreHandle_t done;             ///< 收到 target 次回调后释放
+    uint32_t target;                    ///< 期望的回调次数（事件数 x 订阅者数）
+    uint32_t received;                  ///< 已收到的回调次数
+} bench_ctx_t;
+
+static const uint8_t s_sub_counts[] = {1, 4, 16};
+static const uint16_t s_data_sizes[] = {16, 64, 256, 1024};
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 打印一项结果，格式固定为 "BENCH <项目> <数值> <单位>"，便于与基线逐行比较
+ */
+static void bench_print(const char *name, uint32_t value, const char *unit)
+{
+    ESP_LOGI(TAG, "BENCH %-28s %9u %s", name, (unsigned)value, unit);
+}
+
+/**
+ * @brief 基准订阅者：只计数（多个分发任务时原子累加）
+ */
+static void bench_handler(const xn_event_t *event, void *user_data)
+{
+    (void)event;
+    bench_ctx_t *ctx = (bench_ctx_t *)user_data;
+
+    if (__atomic_add_fetch(&ctx->received, 1, __ATOMIC_RELAXED) == ctx->target) {
+        xSemaphoreGive(ctx->done);
+    }
+}
+
+/**
+ * @brief 订阅 n 次基准事件（同一回调，分发时各计一次）
+ */
+static esp_err_t bench_subscribe(uint16_t event_id, uint8_t n, bench_ctx_t *ctx)
+{
+    for (uint8_t i = 0; i < n; i++) {
+        esp_err_t ret = xn_event_subscribe(event_id, bench_handler, ctx);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 同步分发：xn_event_publish_sync 在调用者中查表并执行回调
+ */
+static esp_err_t bench_sync(bench_ctx_t *ctx, uint8_t subs)
+{
+    esp_err_t ret = bench_subscribe(BENCH_EVT_SYNC, subs, ctx);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    xn_event_t event = {
+        .id = BENCH_EVT_SYNC,
+        .source = XN_EVT_SRC_SYSTEM,
+    };
+    ctx->received = 0;
+    ctx->target = 0;
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_SYNC_EVENTS; i++) {
+        xn_event_publish_sync(&event);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+    xn_event_unsubscribe_all(bench_handler);
+
+    char name[32];
+    snprintf(name, sizeof(name), "sync_dispatch_sub%u", subs);
+    bench_print(name, (uint32_t)(elapsed * 1000 / BENCH_SYNC_EVENTS), "ns/event");
+    return ctx->received == (uint32_t)BENCH_SYNC_EVENTS * subs ? ESP_OK : ESP_FAIL;
+}
+
+/**
+ * @brief 异步分发：投递到队列，由分发任务执行回调，测量从第一次投递到最后一次回调的吞吐量
+ *
+ * 基准任务优先级临时降到分发任务之下；队列将满时让出 CPU，不触发队列满丢弃。
+ */
+static esp_err_t bench_async(bench_ctx_t *ctx, uint8_t subs)
+{
+    esp_err_t ret = bench_subscribe(BENCH_EVT_ASYNC, subs, ctx);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ctx->received = 0;
+    ctx->target = (uint32_t)BENCH_ASYNC_EVENTS * subs;
+    xSemaphoreTake(ctx->done, 0);
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_ASYNC_EVENTS; i++) {
+        while (xn_event_pending_count() >= XN_EVENT_QUEUE_SIZE - 1) {
+            taskYIELD();
+        }
+        xn_event_post(BENCH_EVT_ASYNC, XN_EVT_SRC_SYSTEM);
+    }
+    bool done = xSemaphoreTake(ctx->done, pdMS_TO_TICKS(BENCH_TIMEOUT_MS)) == pdTRUE;
+    int64_t elapsed = esp_timer_get_time() - start;
+    xn_event_unsubscribe_all(bench_handler);
+    if (!done) {
+        ESP_LOGW(TAG, "Async dispatch incomplete: %u / %u", (unsigned)ctx->received, (unsigned)ctx->target);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "async_dispatch_sub%u", subs);
+    bench_print(name, (uint32_t)(elapsed * 1000 / BENCH_ASYNC_EVENTS), "ns/event");
+    snprintf(name, sizeof(name), "async_throughput_sub%u", subs);
+    bench_print(name, (uint32_t)((int64_t)BENCH_ASYNC_EVENTS * 1000000 / (elapsed ? elapsed : 1)), "events/s");
+    return ESP_OK;
+}
+
+/**
+ * @brief 等待队列清空（不计时）
+ */
+static void bench_drain(void)
+{
+    while (xn_event_pending_count() > 0) {
+        vTaskDelay(1);
+    }
+}
+
+/**
+ * @brief 测量一轮连续投递的平均耗时
+ *
+ * 投递期间基准任务优先级高于分发任务，同核心上不会被分发抢占，只计投递本身
+ * （无负载时为入队，有负载时加上池分配与拷贝）。
+ *
+ * @param size 负载长度，0 表示 xn_event_post
+ * @param payload 负载内容
+ * @return uint32_t 每次投递的平均耗时(ns)
+ */
+static uint32_t bench_post_cost(size_t size, const uint8_t *payload)
+{
+    UBaseType_t prio = uxTaskPriorityGet(NULL);
+    int64_t total = 0;
+
+    for (int r = 0; r < BENCH_ALLOC_ROUNDS; r++) {
+        bench_drain();
+        vTaskPrioritySet(NULL, XN_EVENT_TASK_PRIORITY + 1);
+        int64_t start = esp_timer_get_time();
+        for (int i = 0; i < BENCH_ALLOC_BURST; i++) {
+            if (size == 0) {
+                xn_event_post(BENCH_EVT_ASYNC, XN_EVT_SRC_SYSTEM);
+            } else {
+                xn_event_post_data(BENCH_EVT_ASYNC, XN_EVT_SRC_SYSTEM, payload, size);
+            }
+        }
+        total += esp_timer_get_time() - start;
+        vTaskPrioritySet(NULL, prio);
+    }
+    bench_drain();
+
+    return (uint32_t)(total * 1000 / (BENCH_ALLOC_ROUNDS * BENCH_ALLOC_BURST));
+}
+
+/**
+ * @brief xn_event_post_data 的分配开销：有负载与无负载投递的耗时差，以及池命中情况
+ */
+static esp_err_t bench_alloc(void)
+{
+    static uint8_t s_payload[1024];
+    char name[32];
+
+    uint32_t base = bench_post_cost(0, NULL);
+    bench_print("post_nodata", base, "ns/post");
+
+    for (size_t i = 0; i < sizeof(s_data_sizes) / sizeof(s_data_sizes[0]); i++) {
+        xn_event_bus_stats_t before;
+        xn_event_bus_stats_t after;
+        xn_event_bus_get_stats(&before);
+        uint32_t cost = bench_post_cost(s_data_sizes[i], s_payload);
+        xn_event_bus_get_stats(&after);
+
+        snprintf(name, sizeof(name), "post_data_%u", s_data_sizes[i]);
+        bench_print(name, cost, "ns/post");
+        snprintf(name, sizeof(name), "post_data_%u_alloc", s_data_sizes[i]);
+        bench_print(name, cost > base ? cost - base : 0, "ns/post");
+        snprintf(name, sizeof(name), "post_data_%u_pool_miss", s_data_sizes[i]);
+        bench_print(name, after.pool_misses - before.pool_misses, "posts");
+    }
+    return ESP_OK;
+}
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+esp_err_t bench_event_bus(void)
+{
+    bench_ctx_t ctx = {
+        .done = xSemaphoreCreateBinary(),
+    };
+    if (ctx.done == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    UBaseType_t prio = uxTaskPriorityGet(NULL);
+    vTaskPrioritySet(NULL, XN_EVENT_TASK_PRIORITY - 1);
+    ESP_LOGI(TAG, "Event bus benchmark: %u workers, queue %u",
+             (unsigned)XN_EVENT_WORKER_COUNT, (unsigned)XN_EVENT_QUEUE_SIZE);
+
+    esp_err_t ret = ESP_OK;
+    for (size_t i = 0; i < sizeof(s_sub_counts) / sizeof(s_sub_counts[0]) && ret == ESP_OK; i++) {
+        ret = bench_sync(&ctx, s_sub_counts[i]);
+    }
+    for (size_t i = 0; i < sizeof(s_sub_counts) / sizeof(s_sub_counts[0]) && ret == ESP_OK; i++) {
+        ret = bench_async(&ctx, s_sub_counts[i]);
+    }
+    if (ret == ESP_OK) {
+        ret = bench_alloc();
+    }
+
+    xn_event_unsubscribe_all(bench_handler);
+    vTaskPrioritySet(NULL, prio);
+    vSemaphoreDelete(ctx.done);
+    return ret;
+}
+
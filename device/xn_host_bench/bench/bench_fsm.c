@@ -0,0 +1,134 @@
+/**
+ * @file bench_fsm.c
+ * @brief 状态机微基准 - 事件处理耗时随转换表大小的变化
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "xn_fsm.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "xn_fsm_bench";
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+#define BENCH_ITERATIONS        10000   ///< 每项测量的事件数
+#define BENCH_EVENT_BASE        0x7F00  ///< 基准事件ID起点
+#define BENCH_EVENT_MISS        0x7FFF  ///< 转换表中不存在的事件
+#define BENCH_FSM_TAG           "xn_fsm"    ///< 状态机组件日志标签（每次转换打印 INFO 日志）
+
+enum {
+    BENCH_STATE_ROOT = 1,               ///< 父状态（无转换，未命中时冒泡经过）
+    BENCH_STATE_A,
+    BENCH_STATE_B,
+};
+
+static const xn_fsm_state_t s_states[] = {
+    {BENCH_STATE_ROOT, "ROOT", NULL, NULL, NULL, NULL,          0, 0},
+    {BENCH_STATE_A,    "A",    NULL, NULL, NULL, &s_states[0],  0, 0},
+    {BENCH_STATE_B,    "B",    NULL, NULL, NULL, &s_states[0],  0, 0},
+};
+
+static const uint8_t s_table_sizes[] = {4, 8, 16, 32};
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 打印一项结果，格式与事件总线基准一致："BENCH <项目> <数值> <单位>"
+ */
+static void bench_print(const char *name, uint32_t value, const char *unit)
+{
+    ESP_LOGI(TAG, "BENCH %-28s %9u %s", name, (unsigned)value, unit);
+}
+
+/**
+ * @brief 连续处理同一事件，返回每个事件的平均耗时(ns)
+ */
+static uint32_t bench_events(xn_fsm_t *fsm, xn_event_id_t event)
+{
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        xn_fsm_process_event(fsm, event);
+    }
+    return (uint32_t)((esp_timer_get_time() - start) * 1000 / BENCH_ITERATIONS);
+}
+
+/**
+ * @brief 构造含 size 条转换的状态机并测量
+ *
+ * 转换表为 A <-> B 之间 size/2 个事件各两条转换。命中第一条与最后一条转换的事件
+ * 分别测量，跳转表查找时两者应当一致；未命中事件经父状态冒泡后返回。
+ */
+static esp_err_t bench_table(xn_fsm_t *fsm, uint8_t size)
+{
+    xn_fsm_transition_t *transitions = calloc(size, sizeof(xn_fsm_transition_t));
+    if (transitions == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint8_t i = 0; i < size / 2; i++) {
+        transitions[i * 2] = (xn_fsm_transition_t){BENCH_STATE_A, BENCH_EVENT_BASE + i, BENCH_STATE_B, NULL, NULL};
+        transitions[i * 2 + 1] = (xn_fsm_transition_t){BENCH_STATE_B, BENCH_EVENT_BASE + i, BENCH_STATE_A, NULL, NULL};
+    }
+
+    xn_fsm_config_t config = {
+        .name = "bench",
+        .initial_state = BENCH_STATE_A,
+        .states = s_states,
+        .state_count = sizeof(s_states) / sizeof(s_states[0]),
+        .transitions = transitions,
+        .transition_count = size,
+    };
+    esp_err_t ret = xn_fsm_init(fsm, &config);
+    if (ret == ESP_OK) {
+        ret = xn_fsm_start(fsm);
+    }
+    if (ret != ESP_OK) {
+        free(transitions);
+        return ret;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "fsm_hit_first_t%u", size);
+    bench_print(name, bench_events(fsm, BENCH_EVENT_BASE), "ns/event");
+    snprintf(name, sizeof(name), "fsm_hit_last_t%u", size);
+    bench_print(name, bench_events(fsm, BENCH_EVENT_BASE + size / 2 - 1), "ns/event");
+    snprintf(name, sizeof(name), "fsm_miss_t%u", size);
+    bench_print(name, bench_events(fsm, BENCH_EVENT_MISS), "ns/event");
+
+    xn_fsm_stop(fsm);
+    free(transitions);
+    return ESP_OK;
+}
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+esp_err_t bench_fsm(void)
+{
+    xn_fsm_t *fsm = malloc(sizeof(xn_fsm_t));
+    if (fsm == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 只测状态机本身：屏蔽每次转换的 INFO 日志与根状态不可达告警
+    esp_log_level_t level = esp_log_level_get(BENCH_FSM_TAG);
+    esp_log_level_set(BENCH_FSM_TAG, ESP_LOG_ERROR);
+    ESP_LOGI(TAG, "FSM benchmark: %d events per case", BENCH_ITERATIONS);
+
+    esp_err_t ret = ESP_OK;
+    for (size_t i = 0; i < sizeof(s_table_sizes) / sizeof(s_table_sizes[0]) && ret == ESP_OK; i++) {
+        ret = bench_table(fsm, s_table_sizes[i]);
+    }
+
+    esp_log_level_set(BENCH_FSM_TAG, level);
+    free(fsm);
+    return ret;
+}
+
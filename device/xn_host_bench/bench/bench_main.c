@@ -0,0 +1,32 @@
+/**
+ * @file bench_main.c
+ * @brief 主机微基准入口：初始化事件总线，依次运行各项基准，任一项失败时返回非 0
+ */
+
+#include <stdio.h>
+#include "bench.h"
+#include "xn_event_bus.h"
+#include "esp_log.h"
+
+static const char *TAG = "xn_host_bench";
+
+int main(void)
+{
+    esp_err_t ret = xn_event_bus_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Event bus init failed: %s", esp_err_to_name(ret));
+        return 1;
+    }
+
+    ret = bench_event_bus();
+    if (ret == ESP_OK) {
+        ret = bench_fsm();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Benchmark failed: %s", esp_err_to_name(ret));
+        return 1;
+    }
+
+    ESP_LOGI(TAG, "Benchmark complete");
+    return 0;
+}
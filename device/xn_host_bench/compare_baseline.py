@@ -0,0 +1,71 @@
+# -*- coding: utf-8 -*-
+"""
+主机基准比较工具
+
+功能说明：
+    逐行比较 xn_host_bench 的输出与 baseline.txt 中的 "BENCH <项目> <数值> <单位>" 行，
+    打印每项的变化比例。ns/* 越大越差，events/s 越小越差，posts（池未命中次数）只打印不判定。
+
+用法：
+    ./build/xn_host_bench | python compare_baseline.py baseline.txt -
+    python compare_baseline.py baseline.txt run.txt --threshold 25
+
+    有任一项变差超过阈值（默认 20%）时退出码为 1。基线只在同一台机器、同一编译器下可比。
+"""
+
+import argparse
+import sys
+
+
+def parse(lines) -> dict[str, tuple[int, str]]:
+    """提取 BENCH 行，返回 项目 -> (数值, 单位)"""
+    results = {}
+    for line in lines:
+        fields = line.split()
+        if "BENCH" not in fields:
+            continue
+        i = fields.index("BENCH")
+        if len(fields) < i + 4:
+            continue
+        results[fields[i + 1]] = (int(fields[i + 2]), fields[i + 3])
+    return results
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="比较 xn_host_bench 输出与基线")
+    parser.add_argument("baseline", help="基线文件")
+    parser.add_argument("run", help="本次输出，'-' 表示标准输入")
+    parser.add_argument("--threshold", type=float, default=20.0, help="判定为回退的变差比例(%%)")
+    args = parser.parse_args()
+
+    with open(args.baseline, encoding="utf-8") as f:
+        baseline = parse(f)
+    if args.run == "-":
+        run = parse(sys.stdin)
+    else:
+        with open(args.run, encoding="utf-8") as f:
+            run = parse(f)
+
+    regressions = 0
+    for name, (base, unit) in baseline.items():
+        if name not in run:
+            print(f"  {name:<28} 缺失")
+            regressions += 1
+            continue
+        value = run[name][0]
+        if unit == "posts" or base == 0:
+            print(f"  {name:<28} {base:>9} -> {value:>9} {unit}")
+            continue
+        change = (value - base) * 100.0 / base
+        worse = change if unit.startswith("ns/") else -change
+        mark = " <- 回退" if worse > args.threshold else ""
+        if mark:
+            regressions += 1
+        print(f"  {name:<28} {base:>9} -> {value:>9} {unit} {change:+7.1f}%{mark}")
+
+    print(f"{len(baseline)} 项，{regressions} 项回退（阈值 {args.threshold:g}%）")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,24 @@
+/**
+ * @file cJSON.h
+ * @brief 主机移植层：OTA 组件构建请求体用到的 cJSON 子集（字符串字段的对象）
+ */
+
+#ifndef cJSON__h
+#define cJSON__h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct cJSON cJSON;
+
+cJSON *cJSON_CreateObject(void);
+cJSON *cJSON_AddStringToObject(cJSON *object, const char *name, const char *string);
+char *cJSON_PrintUnformatted(const cJSON *item);
+void cJSON_Delete(cJSON *item);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* cJSON__h */
@@ -0,0 +1,29 @@
+/**
+ * @file esp_app_format.h
+ * @brief 主机移植层：应用描述
+ */
+
+#ifndef ESP_APP_FORMAT_H
+#define ESP_APP_FORMAT_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_IMAGE_HEADER_MAGIC 0xE9
+
+typedef struct {
+    char version[32];
+    char project_name[32];
+    char time[16];
+    char date[16];
+    char idf_ver[32];
+} esp_app_desc_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESP_APP_FORMAT_H */
@@ -0,0 +1,13 @@
+/**
+ * @file esp_attr.h
+ * @brief 主机移植层：内存段属性在主机上没有意义，全部为空
+ */
+
+#ifndef ESP_ATTR_H
+#define ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_NOINIT_ATTR
+
+#endif /* ESP_ATTR_H */
@@ -0,0 +1,33 @@
+/**
+ * @file esp_chip_info.h
+ * @brief 主机移植层：芯片信息
+ */
+
+#ifndef ESP_CHIP_INFO_H
+#define ESP_CHIP_INFO_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    CHIP_ESP32 = 1,
+    CHIP_ESP32S3 = 9,
+} esp_chip_model_t;
+
+typedef struct {
+    esp_chip_model_t model;
+    uint32_t features;
+    uint16_t revision;
+    uint8_t cores;
+} esp_chip_info_t;
+
+void esp_chip_info(esp_chip_info_t *out_info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESP_CHIP_INFO_H */
@@ -0,0 +1,21 @@
+/**
+ * @file esp_random.h
+ * @brief 主机移植层：随机数
+ */
+
+#ifndef ESP_RANDOM_H
+#define ESP_RANDOM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t esp_random(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESP_RANDOM_H */
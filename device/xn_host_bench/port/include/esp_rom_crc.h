@@ -0,0 +1,21 @@
+/**
+ * @file esp_rom_crc.h
+ * @brief 主机移植层：CRC32（与 zlib crc32 相同）
+ */
+
+#ifndef ESP_ROM_CRC_H
+#define ESP_ROM_CRC_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESP_ROM_CRC_H */
@@ -0,0 +1,29 @@
+/**
+ * @file mbedtls/md5.h
+ * @brief 主机移植层：MD5，由 OpenSSL 实现；上下文为普通结构体，可以按值保存与恢复
+ */
+
+#ifndef MBEDTLS_MD5_H
+#define MBEDTLS_MD5_H
+
+#include <stddef.h>
+#include <openssl/md5.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef MD5_CTX mbedtls_md5_context;
+
+void mbedtls_md5_init(mbedtls_md5_context *ctx);
+void mbedtls_md5_free(mbedtls_md5_context *ctx);
+void mbedtls_md5_clone(mbedtls_md5_context *dst, const mbedtls_md5_context *src);
+int mbedtls_md5_starts(mbedtls_md5_context *ctx);
+int mbedtls_md5_update(mbedtls_md5_context *ctx, const unsigned char *input, size_t ilen);
+int mbedtls_md5_finish(mbedtls_md5_context *ctx, unsigned char output[16]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBEDTLS_MD5_H */
@@ -0,0 +1,11 @@
+/**
+ * @file nvs_flash.h
+ * @brief 主机移植层：NVS 初始化（OTA 组件只需要类型声明）
+ */
+
+#ifndef NVS_FLASH_H
+#define NVS_FLASH_H
+
+#include "nvs.h"
+
+#endif /* NVS_FLASH_H */
@@ -0,0 +1,25 @@
+/**
+ * @file port_newlib.h
+ * @brief 主机移植层：newlib 提供而旧版 glibc 没有的函数（编译 OTA 组件时强制包含）
+ */
+
+#ifndef PORT_NEWLIB_H
+#define PORT_NEWLIB_H
+
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GLIBC__) && !(__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 38))
+#define PORT_NEED_STRLCPY 1
+size_t strlcpy(char *dst, const char *src, size_t size);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORT_NEWLIB_H */
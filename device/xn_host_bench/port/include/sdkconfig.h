@@ -0,0 +1,20 @@
+/**
+ * @file sdkconfig.h
+ * @brief 主机构建的组件配置，与固件默认值一致
+ *
+ * 延迟统计与分发历史默认关闭，可在 cmake 时用 -DXN_HOST_BENCH_TRACE=ON 打开延迟统计，
+ * 比较统计本身的开销。
+ */
+
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+
+#ifndef CONFIG_XN_EVENT_BUS_TRACE
+#define CONFIG_XN_EVENT_BUS_TRACE 0
+#endif
+#define CONFIG_XN_EVENT_BUS_TRACE_MAX_IDS 32
+
+#define CONFIG_XN_EVENT_BUS_HISTORY 0
+#define CONFIG_XN_EVENT_BUS_HISTORY_LEN 32
+
+#endif /* SDKCONFIG_H */
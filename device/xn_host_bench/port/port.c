@@ -0,0 +1,651 @@
+/**
+ * @file port.c
+ * @brief 主机移植层实现 - 用 pthread 实现组件用到的 FreeRTOS / esp_timer / esp_log 子集
+ *
+ * 只追求语义正确，不模拟调度：
+ * - 任务优先级只保存不生效，任务在主机的多个核上并行运行
+ * - 阻塞等待使用 CLOCK_MONOTONIC，1 tick = 1 ms
+ * - 其他任务删除自己以外的任务时用 pthread_cancel，任务只在阻塞等待中响应取消，
+ *   不会在持有锁或临界区时被终止
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+/*===========================================================================
+ *                          时间
+ *===========================================================================*/
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief 计算 ticks 之后的绝对时间（CLOCK_MONOTONIC）
+ */
+static struct timespec deadline_after(TickType_t ticks)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ns = (uint64_t)pdTICKS_TO_MS(ticks) * 1000000 + (uint64_t)ts.tv_nsec;
+    ts.tv_sec += (time_t)(ns / 1000000000);
+    ts.tv_nsec = (long)(ns % 1000000000);
+    return ts;
+}
+
+static void cond_init(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static void unlock_cleanup(void *mutex)
+{
+    pthread_mutex_unlock((pthread_mutex_t *)mutex);
+}
+
+/**
+ * @brief 等待条件变量，此时允许取消（vTaskDelete 其他任务）
+ *
+ * @return bool 超时返回 false
+ */
+static bool cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *deadline)
+{
+    int err = 0;
+    int old;
+
+    pthread_cleanup_push(unlock_cleanup, mutex);
+    pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old);
+    if (deadline == NULL) {
+        err = pthread_cond_wait(cond, mutex);
+    } else {
+        err = pthread_cond_timedwait(cond, mutex, deadline);
+    }
+    pthread_setcancelstate(old, NULL);
+    pthread_cleanup_pop(0);
+
+    return err != ETIMEDOUT;
+}
+
+/*===========================================================================
+ *                          临界区
+ *===========================================================================*/
+
+static pthread_mutex_t s_critical;
+static pthread_once_t s_critical_once = PTHREAD_ONCE_INIT;
+
+static void critical_init(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&s_critical, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+void port_enter_critical(void)
+{
+    pthread_once(&s_critical_once, critical_init);
+    pthread_mutex_lock(&s_critical);
+}
+
+void port_exit_critical(void)
+{
+    pthread_mutex_unlock(&s_critical);
+}
+
+/*===========================================================================
+ *                          任务
+ *===========================================================================*/
+
+struct port_task {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void *arg;
+    UBaseType_t priority;
+};
+
+static struct port_task s_main_task = {.priority = 1};
+static __thread struct port_task *s_current;
+
+static struct port_task *current_task(void)
+{
+    return s_current != NULL ? s_current : &s_main_task;
+}
+
+static void *task_entry(void *arg)
+{
+    struct port_task *task = (struct port_task *)arg;
+
+    // 只在阻塞等待中响应取消
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+    s_current = task;
+    task->fn(task->arg);
+    free(task);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *out_handle, BaseType_t core_id)
+{
+    (void)name;
+    (void)stack_depth;
+    (void)core_id;
+
+    struct port_task *task = calloc(1, sizeof(struct port_task));
+    if (task == NULL) {
+        return pdFAIL;
+    }
+    task->fn = fn;
+    task->arg = arg;
+    task->priority = priority;
+
+    // 句柄在线程启动前写出，与 FreeRTOS 一致（任务可能立即使用自己的句柄）
+    if (out_handle != NULL) {
+        *out_handle = task;
+    }
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int err = pthread_create(&task->thread, &attr, task_entry, task);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        if (out_handle != NULL) {
+            *out_handle = NULL;
+        }
+        free(task);
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *out_handle)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack_depth, arg, priority, out_handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL || task == s_current) {
+        free(s_current);
+        pthread_exit(NULL);
+    }
+    // 被删除的任务在下一次阻塞等待时退出，其 port_task 不再释放（主机进程很快结束）
+    pthread_cancel(task->thread);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    if (ticks == 0) {
+        sched_yield();
+        return;
+    }
+    struct timespec ts = {
+        .tv_sec = pdTICKS_TO_MS(ticks) / 1000,
+        .tv_nsec = (long)(pdTICKS_TO_MS(ticks) % 1000) * 1000000,
+    };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(now_us() / 1000);
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task)
+{
+    return (task != NULL ? task : current_task())->priority;
+}
+
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority)
+{
+    (task != NULL ? task : current_task())->priority = priority;
+}
+
+void vTaskSuspendAll(void)
+{
+    port_enter_critical();
+}
+
+BaseType_t xTaskResumeAll(void)
+{
+    port_exit_critical();
+    return pdFALSE;
+}
+
+void port_yield(void)
+{
+    sched_yield();
+}
+
+/*===========================================================================
+ *                          队列
+ *===========================================================================*/
+
+struct port_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t count;
+    UBaseType_t head;
+    uint8_t *storage;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct port_queue *q = calloc(1, sizeof(struct port_queue));
+    if (q == NULL) {
+        return NULL;
+    }
+    q->storage = malloc((size_t)length * item_size);
+    if (q->storage == NULL) {
+        free(q);
+        return NULL;
+    }
+    pthread_mutex_init(&q->lock, NULL);
+    cond_init(&q->not_empty);
+    cond_init(&q->not_full);
+    q->length = length;
+    q->item_size = item_size;
+    return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks_to_wait)
+{
+    struct timespec deadline = deadline_after(ticks_to_wait);
+
+    pthread_mutex_lock(&q->lock);
+    while (q->count == q->length) {
+        if (ticks_to_wait == 0 ||
+            !cond_wait(&q->not_full, &q->lock, ticks_to_wait == portMAX_DELAY ? NULL : &deadline)) {
+            pthread_mutex_unlock(&q->lock);
+            return pdFAIL;
+        }
+    }
+    UBaseType_t tail = (q->head + q->count) % q->length;
+    memcpy(q->storage + (size_t)tail * q->item_size, item, q->item_size);
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks_to_wait)
+{
+    struct timespec deadline = deadline_after(ticks_to_wait);
+
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0) {
+        if (ticks_to_wait == 0 ||
+            !cond_wait(&q->not_empty, &q->lock, ticks_to_wait == portMAX_DELAY ? NULL : &deadline)) {
+            pthread_mutex_unlock(&q->lock);
+            return pdFAIL;
+        }
+    }
+    memcpy(item, q->storage + (size_t)q->head * q->item_size, q->item_size);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t count = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t spaces = q->length - q->count;
+    pthread_mutex_unlock(&q->lock);
+    return spaces;
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+    if (q == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+    free(q->storage);
+    free(q);
+}
+
+/*===========================================================================
+ *                          信号量
+ *===========================================================================*/
+
+struct port_sem {
+    pthread_mutex_t lock;
+    pthread_cond_t available;
+    UBaseType_t count;
+    UBaseType_t max_count;
+};
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count)
+{
+    struct port_sem *sem = calloc(1, sizeof(struct port_sem));
+    if (sem == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&sem->lock, NULL);
+    cond_init(&sem->available);
+    sem->count = initial_count;
+    sem->max_count = max_count;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return xSemaphoreCreateCounting(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return xSemaphoreCreateCounting(1, 1);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks_to_wait)
+{
+    struct timespec deadline = deadline_after(ticks_to_wait);
+
+    pthread_mutex_lock(&sem->lock);
+    while (sem->count == 0) {
+        if (ticks_to_wait == 0 ||
+            !cond_wait(&sem->available, &sem->lock, ticks_to_wait == portMAX_DELAY ? NULL : &deadline)) {
+            pthread_mutex_unlock(&sem->lock);
+            return pdFAIL;
+        }
+    }
+    sem->count--;
+    pthread_mutex_unlock(&sem->lock);
+    return pdPASS;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    BaseType_t ret = pdFAIL;
+
+    pthread_mutex_lock(&sem->lock);
+    if (sem->count < sem->max_count) {
+        sem->count++;
+        pthread_cond_signal(&sem->available);
+        ret = pdPASS;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ret;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    if (sem == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&sem->lock);
+    pthread_cond_destroy(&sem->available);
+    free(sem);
+}
+
+/*===========================================================================
+ *                          esp_timer
+ *===========================================================================*/
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    int64_t deadline;                   ///< 到期时间(us)，0 表示未启动
+    uint64_t period;                    ///< 周期(us)，0 表示单次
+    struct esp_timer *next;
+};
+
+static pthread_mutex_t s_timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_timer_cond;
+static struct esp_timer *s_timers;
+static bool s_timer_started;
+
+/**
+ * @brief 定时器线程：与 IDF 的 esp_timer 任务一样，所有回调在同一个线程中串行执行
+ */
+static void *timer_thread(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&s_timer_lock);
+    for (;;) {
+        struct esp_timer *due = NULL;
+        for (struct esp_timer *t = s_timers; t != NULL; t = t->next) {
+            if (t->deadline != 0 && (due == NULL || t->deadline < due->deadline)) {
+                due = t;
+            }
+        }
+        if (due == NULL) {
+            pthread_cond_wait(&s_timer_cond, &s_timer_lock);
+            continue;
+        }
+        int64_t now = now_us();
+        if (due->deadline > now) {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            uint64_t ns = (uint64_t)(due->deadline - now) * 1000 + (uint64_t)ts.tv_nsec;
+            ts.tv_sec += (time_t)(ns / 1000000000);
+            ts.tv_nsec = (long)(ns % 1000000000);
+            pthread_cond_timedwait(&s_timer_cond, &s_timer_lock, &ts);
+            continue;
+        }
+
+        due->deadline = due->period != 0 ? now + (int64_t)due->period : 0;
+        esp_timer_cb_t cb = due->callback;
+        void *cb_arg = due->arg;
+        pthread_mutex_unlock(&s_timer_lock);
+        cb(cb_arg);
+        pthread_mutex_lock(&s_timer_lock);
+    }
+    return NULL;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return now_us();
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+    if (create_args == NULL || create_args->callback == NULL || out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct esp_timer *t = calloc(1, sizeof(struct esp_timer));
+    if (t == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    t->callback = create_args->callback;
+    t->arg = create_args->arg;
+
+    pthread_mutex_lock(&s_timer_lock);
+    if (!s_timer_started) {
+        pthread_t thread;
+        cond_init(&s_timer_cond);
+        if (pthread_create(&thread, NULL, timer_thread, NULL) != 0) {
+            pthread_mutex_unlock(&s_timer_lock);
+            free(t);
+            return ESP_ERR_NO_MEM;
+        }
+        pthread_detach(thread);
+        s_timer_started = true;
+    }
+    t->next = s_timers;
+    s_timers = t;
+    pthread_mutex_unlock(&s_timer_lock);
+
+    *out_handle = t;
+    return ESP_OK;
+}
+
+static esp_err_t timer_start(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period)
+{
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&s_timer_lock);
+    if (timer->deadline != 0) {
+        pthread_mutex_unlock(&s_timer_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->deadline = now_us() + (int64_t)(timeout_us ? timeout_us : 1);
+    timer->period = period;
+    pthread_cond_signal(&s_timer_cond);
+    pthread_mutex_unlock(&s_timer_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return timer_start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    return timer_start(timer, period, period);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&s_timer_lock);
+    esp_err_t ret = timer->deadline != 0 ? ESP_OK : ESP_ERR_INVALID_STATE;
+    timer->deadline = 0;
+    pthread_mutex_unlock(&s_timer_lock);
+    return ret;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    if (timer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&s_timer_lock);
+    for (struct esp_timer **p = &s_timers; *p != NULL; p = &(*p)->next) {
+        if (*p == timer) {
+            *p = timer->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_timer_lock);
+    free(timer);
+    return ESP_OK;
+}
+
+/*===========================================================================
+ *                          esp_log / esp_err
+ *===========================================================================*/
+
+#define PORT_LOG_TAGS 16
+
+static struct {
+    const char *tag;
+    esp_log_level_t level;
+} s_log_levels[PORT_LOG_TAGS];
+static pthread_mutex_t s_log_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    pthread_mutex_lock(&s_log_lock);
+    for (int i = 0; i < PORT_LOG_TAGS; i++) {
+        if (s_log_levels[i].tag == NULL || strcmp(s_log_levels[i].tag, tag) == 0) {
+            s_log_levels[i].tag = tag;
+            s_log_levels[i].level = level;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_log_lock);
+}
+
+esp_log_level_t esp_log_level_get(const char *tag)
+{
+    esp_log_level_t level = ESP_LOG_INFO;
+
+    pthread_mutex_lock(&s_log_lock);
+    for (int i = 0; i < PORT_LOG_TAGS && s_log_levels[i].tag != NULL; i++) {
+        if (strcmp(s_log_levels[i].tag, tag) == 0) {
+            level = s_log_levels[i].level;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_log_lock);
+    return level;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    static const char letters[] = "NEWIDV";
+
+    if (level > esp_log_level_get(tag)) {
+        return;
+    }
+
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    pthread_mutex_lock(&s_log_lock);
+    printf("%c (%lu) %s: %s\n", letters[level], (unsigned long)(now_us() / 1000), tag, line);
+    fflush(stdout);
+    pthread_mutex_unlock(&s_log_lock);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK:                return "ESP_OK";
+    case ESP_FAIL:              return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:   return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:  return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:     return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:       return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+    case ESP_ERR_INVALID_CRC:   return "ESP_ERR_INVALID_CRC";
+    case ESP_ERR_NOT_FINISHED:  return "ESP_ERR_NOT_FINISHED";
+    case ESP_ERR_NOT_ALLOWED:   return "ESP_ERR_NOT_ALLOWED";
+    default:                    return "UNKNOWN ERROR";
+    }
+}
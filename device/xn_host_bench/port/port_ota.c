@@ -0,0 +1,218 @@
+/**
+ * @file port_ota.c
+ * @brief 主机移植层实现 - OTA 组件用到的 mbedtls / ROM CRC / cJSON / NVS / 芯片信息子集
+ *
+ * - SHA-256 与 MD5 由 OpenSSL 计算，上下文可以按值复制
+ * - cJSON 只支持字符串字段的对象，输出格式与 cJSON_PrintUnformatted 相同（不做转义）
+ * - NVS 命名空间始终不存在，OTA 组件按未配置处理
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "port_newlib.h"
+#include "esp_err.h"
+#include "esp_app_format.h"
+#include "esp_chip_info.h"
+#include "esp_mac.h"
+#include "esp_random.h"
+#include "esp_rom_crc.h"
+#include "cJSON.h"
+#include "nvs.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/md5.h"
+
+/*===========================================================================
+ *                          newlib
+ *===========================================================================*/
+
+#ifdef PORT_NEED_STRLCPY
+size_t strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = (len < size - 1) ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#endif
+
+/*===========================================================================
+ *                          mbedtls
+ *===========================================================================*/
+
+void mbedtls_sha256_init(mbedtls_sha256_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void mbedtls_sha256_free(mbedtls_sha256_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void mbedtls_sha256_clone(mbedtls_sha256_context *dst, const mbedtls_sha256_context *src)
+{
+    *dst = *src;
+}
+
+int mbedtls_sha256_starts(mbedtls_sha256_context *ctx, int is224)
+{
+    return SHA256_Init(ctx) == 1 ? 0 : -1;
+}
+
+int mbedtls_sha256_update(mbedtls_sha256_context *ctx, const unsigned char *input, size_t ilen)
+{
+    return SHA256_Update(ctx, input, ilen) == 1 ? 0 : -1;
+}
+
+int mbedtls_sha256_finish(mbedtls_sha256_context *ctx, unsigned char *output)
+{
+    return SHA256_Final(output, ctx) == 1 ? 0 : -1;
+}
+
+void mbedtls_md5_init(mbedtls_md5_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void mbedtls_md5_free(mbedtls_md5_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void mbedtls_md5_clone(mbedtls_md5_context *dst, const mbedtls_md5_context *src)
+{
+    *dst = *src;
+}
+
+int mbedtls_md5_starts(mbedtls_md5_context *ctx)
+{
+    return MD5_Init(ctx) == 1 ? 0 : -1;
+}
+
+int mbedtls_md5_update(mbedtls_md5_context *ctx, const unsigned char *input, size_t ilen)
+{
+    return MD5_Update(ctx, input, ilen) == 1 ? 0 : -1;
+}
+
+int mbedtls_md5_finish(mbedtls_md5_context *ctx, unsigned char output[16])
+{
+    return MD5_Final(output, ctx) == 1 ? 0 : -1;
+}
+
+/*===========================================================================
+ *                          ROM / 芯片信息
+ *===========================================================================*/
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+uint32_t esp_random(void)
+{
+    return (uint32_t)rand();
+}
+
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type)
+{
+    static const uint8_t host_mac[6] = {0x02, 0x00, 0x00, 0x12, 0x34, 0x56};
+    memcpy(mac, host_mac, sizeof(host_mac));
+    return ESP_OK;
+}
+
+void esp_chip_info(esp_chip_info_t *out_info)
+{
+    memset(out_info, 0, sizeof(*out_info));
+    out_info->model = CHIP_ESP32S3;
+    out_info->cores = 2;
+}
+
+/*===========================================================================
+ *                          cJSON
+ *===========================================================================*/
+
+struct cJSON {
+    char *text;                             // 已生成的字段，形如 "k":"v","k":"v"
+    size_t len;
+};
+
+cJSON *cJSON_CreateObject(void)
+{
+    return calloc(1, sizeof(cJSON));
+}
+
+cJSON *cJSON_AddStringToObject(cJSON *object, const char *name, const char *string)
+{
+    if (object == NULL) {
+        return NULL;
+    }
+    size_t add = strlen(name) + strlen(string) + 6;
+    char *text = realloc(object->text, object->len + add + 1);
+    if (text == NULL) {
+        return NULL;
+    }
+    object->text = text;
+    object->len += snprintf(text + object->len, add + 1, "%s\"%s\":\"%s\"",
+                            (object->len > 0) ? "," : "", name, string);
+    return object;
+}
+
+char *cJSON_PrintUnformatted(const cJSON *item)
+{
+    if (item == NULL) {
+        return NULL;
+    }
+    char *out = malloc(item->len + 3);
+    if (out != NULL) {
+        sprintf(out, "{%s}", (item->text != NULL) ? item->text : "");
+    }
+    return out;
+}
+
+void cJSON_Delete(cJSON *item)
+{
+    if (item != NULL) {
+        free(item->text);
+        free(item);
+    }
+}
+
+/*===========================================================================
+ *                          NVS
+ *===========================================================================*/
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length)
+{
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+}
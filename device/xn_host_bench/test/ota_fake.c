@@ -0,0 +1,522 @@
+/**
+ * @file ota_fake.c
+ * @brief OTA 测试桩实现
+ *
+ * - Flash：两个 OTA 分区，写入只能把 1 变为 0（与 NOR Flash 相同），目标字节不是 0xFF 时计入 dirty_writes
+ * - esp_ota_begin：OTA_SIZE_UNKNOWN 擦除整个分区，OTA_WITH_SEQUENTIAL_WRITES 不擦除（与 IDF 相同）
+ * - HTTP：检查更新的 POST 返回单个版本；固件 GET 支持 "Range: bytes=N-"，返回 206
+ * - xn_storage：进程内缓存，提交时写入共享状态，未提交的修改在掉电后丢失
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <openssl/sha.h>
+#include <openssl/md5.h>
+
+#include "ota_fake.h"
+#include "esp_err.h"
+#include "esp_http_client.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "nvs.h"
+#include "xn_storage.h"
+
+#define FAKE_RECORD_SLOTS   4
+#define FAKE_RECORD_MAX     1024
+
+typedef struct {
+    bool used;
+    char key[16];
+    uint16_t version;
+    uint32_t length;
+    uint8_t data[FAKE_RECORD_MAX];
+} fake_record_t;
+
+typedef struct {
+    ota_fake_stats_t stats;
+    uint32_t image_size;
+    char check_body[512];
+    uint8_t image[OTA_FAKE_PART_SIZE];
+    uint8_t flash[2][OTA_FAKE_PART_SIZE];
+    fake_record_t records[FAKE_RECORD_SLOTS];   // 已提交到 Flash 的记录
+} fake_world_t;
+
+static fake_world_t *s_world;
+static fake_record_t s_cache[FAKE_RECORD_SLOTS];
+static uint32_t s_sent;                         // 本次启动已发送的固件字节数
+
+static const esp_partition_t s_parts[2] = {
+    { .address = 0x10000, .size = OTA_FAKE_PART_SIZE, .erase_size = OTA_FAKE_SECTOR_SIZE, .label = "ota_0" },
+    { .address = 0x10000 + OTA_FAKE_PART_SIZE, .size = OTA_FAKE_PART_SIZE,
+      .erase_size = OTA_FAKE_SECTOR_SIZE, .label = "ota_1" },
+};
+
+static const esp_app_desc_t s_app_desc = {
+    .version = "1.0.0",
+    .project_name = "xn_host_bench",
+};
+
+/*===========================================================================
+ *                          测试接口
+ *===========================================================================*/
+
+static void to_hex(const uint8_t *bin, size_t len, char *hex)
+{
+    for (size_t i = 0; i < len; i++) {
+        sprintf(hex + i * 2, "%02x", bin[i]);
+    }
+}
+
+int ota_fake_setup(uint32_t image_size)
+{
+    if (image_size == 0 || image_size > OTA_FAKE_PART_SIZE) {
+        return -1;
+    }
+    s_world = mmap(NULL, sizeof(fake_world_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (s_world == MAP_FAILED) {
+        s_world = NULL;
+        return -1;
+    }
+    memset(s_world, 0, sizeof(*s_world));
+    s_world->stats.boot_part = -1;
+    s_world->image_size = image_size;
+
+    srand(1);
+    for (uint32_t i = 0; i < image_size; i++) {
+        s_world->image[i] = (uint8_t)rand();
+    }
+    s_world->image[0] = ESP_IMAGE_HEADER_MAGIC;
+    for (int p = 0; p < 2; p++) {
+        for (uint32_t i = 0; i < OTA_FAKE_PART_SIZE; i++) {
+            s_world->flash[p][i] = (uint8_t)rand();
+        }
+    }
+
+    uint8_t sha[32];
+    uint8_t md5[16];
+    char sha_hex[65];
+    char md5_hex[33];
+    SHA256(s_world->image, image_size, sha);
+    MD5(s_world->image, image_size, md5);
+    to_hex(sha, sizeof(sha), sha_hex);
+    to_hex(md5, sizeof(md5), md5_hex);
+    snprintf(s_world->check_body, sizeof(s_world->check_body),
+             "{\"firmware\":{\"version\":\"1.1.0\",\"url\":\"%s\",\"size\":%u,"
+             "\"md5\":\"%s\",\"sha256\":\"%s\",\"force\":0}}",
+             OTA_FAKE_IMAGE_URL, (unsigned)image_size, md5_hex, sha_hex);
+    return 0;
+}
+
+ota_fake_stats_t *ota_fake_stats(void)
+{
+    return &s_world->stats;
+}
+
+const uint8_t *ota_fake_image(void)
+{
+    return s_world->image;
+}
+
+const uint8_t *ota_fake_flash(void)
+{
+    return s_world->flash[1];
+}
+
+bool ota_fake_storage_has(const char *key)
+{
+    for (int i = 0; i < FAKE_RECORD_SLOTS; i++) {
+        if (s_world->records[i].used && strcmp(s_world->records[i].key, key) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*===========================================================================
+ *                          Flash / OTA
+ *===========================================================================*/
+
+typedef struct {
+    int index;                              // 分区序号
+    uint32_t seq_offset;                    // esp_ota_write 的写入位置
+    bool written;
+} fake_ota_t;
+
+static fake_ota_t s_ota;
+
+static int part_index(const esp_partition_t *partition)
+{
+    return (partition == &s_parts[1]) ? 1 : (partition == &s_parts[0]) ? 0 : -1;
+}
+
+static esp_err_t flash_program(int index, uint32_t offset, const void *src, size_t size)
+{
+    if (offset + size > OTA_FAKE_PART_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint8_t *dst = s_world->flash[index] + offset;
+    const uint8_t *data = (const uint8_t *)src;
+    bool dirty = false;
+    for (size_t i = 0; i < size; i++) {
+        if (dst[i] != 0xFF) {
+            dirty = true;
+        }
+        dst[i] &= data[i];
+    }
+    if (dirty) {
+        s_world->stats.dirty_writes++;
+    }
+    return ESP_OK;
+}
+
+static void flash_erase(int index, uint32_t offset, uint32_t size)
+{
+    memset(s_world->flash[index] + offset, 0xFF, size);
+    s_world->stats.erased_bytes += size;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+    int index = part_index(partition);
+    if (index < 0 || src_offset + size > partition->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(dst, s_world->flash[index] + src_offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size)
+{
+    int index = part_index(partition);
+    if (index < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return flash_program(index, dst_offset, src, size);
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    int index = part_index(partition);
+    if (index < 0 || offset % partition->erase_size != 0 || size % partition->erase_size != 0 ||
+        offset + size > partition->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    flash_erase(index, offset, size);
+    return ESP_OK;
+}
+
+const esp_partition_t *esp_ota_get_running_partition(void)
+{
+    return &s_parts[0];
+}
+
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *start_from)
+{
+    return &s_parts[1];
+}
+
+esp_err_t esp_ota_begin(const esp_partition_t *partition, size_t image_size, esp_ota_handle_t *out_handle)
+{
+    int index = part_index(partition);
+    if (index != 1) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (image_size == OTA_SIZE_UNKNOWN) {
+        flash_erase(index, 0, partition->size);
+    } else if (image_size != OTA_WITH_SEQUENTIAL_WRITES) {
+        uint32_t size = (image_size + OTA_FAKE_SECTOR_SIZE - 1) / OTA_FAKE_SECTOR_SIZE * OTA_FAKE_SECTOR_SIZE;
+        flash_erase(index, 0, size);
+    }
+    s_ota = (fake_ota_t) { .index = index };
+    *out_handle = 1;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size)
+{
+    if (handle != 1) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = flash_program(s_ota.index, s_ota.seq_offset, data, size);
+    if (err == ESP_OK) {
+        s_ota.seq_offset += size;
+        s_ota.written = true;
+    }
+    return err;
+}
+
+esp_err_t esp_ota_write_with_offset(esp_ota_handle_t handle, const void *data, size_t size, uint32_t offset)
+{
+    if (handle != 1 || offset % 16 != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = flash_program(s_ota.index, offset, data, size);
+    if (err == ESP_OK) {
+        s_ota.written = true;
+    }
+    return err;
+}
+
+esp_err_t esp_ota_end(esp_ota_handle_t handle)
+{
+    if (handle != 1) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_ota.written || s_world->flash[s_ota.index][0] != ESP_IMAGE_HEADER_MAGIC) {
+        return ESP_ERR_OTA_VALIDATE_FAILED;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_abort(esp_ota_handle_t handle)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t *partition)
+{
+    s_world->stats.boot_part = part_index(partition);
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_get_state_partition(const esp_partition_t *partition, esp_ota_img_states_t *ota_state)
+{
+    *ota_state = ESP_OTA_IMG_VALID;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback(void)
+{
+    return ESP_OK;
+}
+
+const esp_app_desc_t *esp_app_get_description(void)
+{
+    return &s_app_desc;
+}
+
+/*===========================================================================
+ *                          HTTP
+ *===========================================================================*/
+
+struct esp_http_client {
+    char url[256];
+    http_event_handle_cb handler;
+    void *user_data;
+    bool has_range;
+    uint32_t range_start;
+    uint32_t pos;                           // 固件下一个发送位置
+    int status;
+};
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config)
+{
+    struct esp_http_client *client = calloc(1, sizeof(*client));
+    if (client != NULL) {
+        snprintf(client->url, sizeof(client->url), "%s", config->url);
+        client->handler = config->event_handler;
+        client->user_data = config->user_data;
+    }
+    return client;
+}
+
+esp_err_t esp_http_client_perform(esp_http_client_handle_t client)
+{
+    if (strcmp(client->url, OTA_FAKE_SERVER_URL) != 0) {
+        client->status = 404;
+        return ESP_OK;
+    }
+    client->status = 200;
+    if (client->handler != NULL) {
+        esp_http_client_event_t evt = {
+            .event_id = HTTP_EVENT_ON_DATA,
+            .client = client,
+            .data = s_world->check_body,
+            .data_len = (int)strlen(s_world->check_body),
+            .user_data = client->user_data,
+        };
+        client->handler(&evt);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_open(esp_http_client_handle_t client, int write_len)
+{
+    if (strcmp(client->url, OTA_FAKE_IMAGE_URL) != 0) {
+        client->status = 404;
+        return ESP_OK;
+    }
+    ota_fake_stats_t *stats = &s_world->stats;
+    client->pos = client->has_range ? client->range_start : 0;
+    if (stats->range_count < OTA_FAKE_MAX_RANGES) {
+        stats->range_starts[stats->range_count] = client->pos;
+    }
+    stats->range_count++;
+    client->status = client->has_range ? 206 : 200;
+    return ESP_OK;
+}
+
+int64_t esp_http_client_fetch_headers(esp_http_client_handle_t client)
+{
+    if (client->status != 200 && client->status != 206) {
+        return 0;
+    }
+    return (int64_t)(s_world->image_size - client->pos);
+}
+
+int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len)
+{
+    uint32_t left = s_world->image_size - client->pos;
+    uint32_t n = (len < 1460) ? (uint32_t)len : 1460;
+    if (n > left) {
+        n = left;
+    }
+    uint32_t cut = s_world->stats.cut_after;
+    if (cut > 0 && s_sent + n > cut) {
+        // 掉电：不刷新缓冲、不执行退出处理，Flash 与已提交的记录保留
+        _exit(0);
+    }
+    memcpy(buffer, s_world->image + client->pos, n);
+    client->pos += n;
+    s_sent += n;
+    return (int)n;
+}
+
+bool esp_http_client_is_complete_data_received(esp_http_client_handle_t client)
+{
+    return client->pos == s_world->image_size;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t client)
+{
+    return client->status;
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char *key, const char *value)
+{
+    unsigned start = 0;
+    if (strcmp(key, "Range") == 0 && sscanf(value, "bytes=%u-", &start) == 1) {
+        client->has_range = true;
+        client->range_start = start;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_delete_header(esp_http_client_handle_t client, const char *key)
+{
+    if (strcmp(key, "Range") == 0) {
+        client->has_range = false;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t client, const char *data, int len)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_method(esp_http_client_handle_t client, esp_http_client_method_t method)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char *url)
+{
+    snprintf(client->url, sizeof(client->url), "%s", url);
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_user_data(esp_http_client_handle_t client, void *data)
+{
+    client->user_data = data;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_close(esp_http_client_handle_t client)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client)
+{
+    free(client);
+    return ESP_OK;
+}
+
+/*===========================================================================
+ *                          xn_storage
+ *===========================================================================*/
+
+static fake_record_t *cache_find(const char *key)
+{
+    for (int i = 0; i < FAKE_RECORD_SLOTS; i++) {
+        if (s_cache[i].used && strcmp(s_cache[i].key, key) == 0) {
+            return &s_cache[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t xn_storage_init(void)
+{
+    memcpy(s_cache, s_world->records, sizeof(s_cache));
+    return ESP_OK;
+}
+
+esp_err_t xn_storage_commit(void)
+{
+    memcpy(s_world->records, s_cache, sizeof(s_cache));
+    return ESP_OK;
+}
+
+esp_err_t xn_storage_set_record(const char *key, uint16_t version, const void *data, size_t length)
+{
+    if (strlen(key) >= sizeof(s_cache[0].key) || length > FAKE_RECORD_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    fake_record_t *rec = cache_find(key);
+    for (int i = 0; rec == NULL && i < FAKE_RECORD_SLOTS; i++) {
+        if (!s_cache[i].used) {
+            rec = &s_cache[i];
+        }
+    }
+    if (rec == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    rec->used = true;
+    strcpy(rec->key, key);
+    rec->version = version;
+    rec->length = length;
+    memcpy(rec->data, data, length);
+    return ESP_OK;
+}
+
+esp_err_t xn_storage_get_record(const char *key, uint16_t version, void *out, size_t length,
+                                xn_storage_migrate_cb_t migrate)
+{
+    fake_record_t *rec = cache_find(key);
+    if (rec == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (rec->version != version) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (rec->length != length) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(out, rec->data, length);
+    return ESP_OK;
+}
+
+esp_err_t xn_storage_erase(const char *key)
+{
+    fake_record_t *rec = cache_find(key);
+    if (rec == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    rec->used = false;
+    return ESP_OK;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file ota_fake.h
+ * @brief OTA 测试桩：内存 Flash、OTA 写入、HTTP 服务端与 xn_storage 记录
+ *
+ * 状态放在进程间共享的匿名映射中，fork 出的子进程模拟一次启动，
+ * 子进程在下载途中 _exit() 相当于掉电，Flash 与存储内容保留给下一次启动。
+ */
+
+#ifndef OTA_FAKE_H
+#define OTA_FAKE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OTA_FAKE_SERVER_URL     "http://ota.test/check"
+#define OTA_FAKE_IMAGE_URL      "http://ota.test/firmware.bin"
+#define OTA_FAKE_PART_SIZE      (512 * 1024)
+#define OTA_FAKE_SECTOR_SIZE    4096
+#define OTA_FAKE_MAX_RANGES     16
+
+/**
+ * @brief 测试可观察的模拟环境
+ */
+typedef struct {
+    uint32_t cut_after;                     ///< 固件已发送超过该字节数时模拟掉电（0 不掉电）
+    uint32_t range_starts[OTA_FAKE_MAX_RANGES]; ///< 每次固件请求的起始偏移
+    uint32_t range_count;                   ///< 固件请求次数
+    uint32_t dirty_writes;                  ///< 写入未擦除区域的次数（违反 esp_ota_write_with_offset 的前提）
+    uint32_t erased_bytes;                  ///< 擦除的总字节数
+    int boot_part;                          ///< 设置的启动分区（-1 未设置）
+} ota_fake_stats_t;
+
+/**
+ * @brief 建立共享状态：生成固件镜像，两个 OTA 分区填充随机数据（未擦除）
+ *
+ * @param image_size 固件大小（字节）
+ * @return 0 成功
+ */
+int ota_fake_setup(uint32_t image_size);
+
+/** @brief 共享状态中的统计，子进程的修改对父进程可见 */
+ota_fake_stats_t *ota_fake_stats(void);
+
+/** @brief 固件镜像内容 */
+const uint8_t *ota_fake_image(void);
+
+/** @brief 目标分区（ota_1）的 Flash 内容 */
+const uint8_t *ota_fake_flash(void);
+
+/** @brief xn_storage 中是否存在指定键 */
+bool ota_fake_storage_has(const char *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OTA_FAKE_H */
@@ -0,0 +1,110 @@
+/**
+ * @file test_ota_resume.c
+ * @brief OTA 掉电续传测试：下载途中掉电，重启后从断点续传并校验镜像
+ *
+ * 每次启动用一个子进程模拟。第一次启动在断点之后继续写入了一部分数据时掉电，
+ * 第二次启动必须从最近的断点请求剩余部分，写入前擦除断点之后的区域，
+ * 最终分区内容与镜像一致并通过摘要校验。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "ota_fake.h"
+#include "xn_ota.h"
+#include "esp_log.h"
+
+static const char *TAG = "test_ota_resume";
+
+#define IMAGE_SIZE      (300 * 1024 + 1234)         // 末尾不满一个接收缓冲，也不是16字节的整数倍
+#define CUT_AFTER       (200 * 1024)                // 第三个断点（192 KB）之后掉电
+#define EXPECT_RESUME   (3 * XN_OTA_RESUME_CHECKPOINT)
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            ESP_LOGE(TAG, "Check failed at line %d: %s", __LINE__, #cond); \
+            return 1;                                                   \
+        }                                                               \
+    } while (0)
+
+/**
+ * @brief 模拟一次启动：初始化、检查更新、升级
+ */
+static esp_err_t boot_and_upgrade(void)
+{
+    xn_ota_config_t config = XN_OTA_DEFAULT_CONFIG();
+    config.server_url = OTA_FAKE_SERVER_URL;
+    config.max_retries = 1;
+    config.retry_delay_ms = 10;
+
+    esp_err_t err = xn_ota_init(&config);
+    if (err != ESP_OK) {
+        return err;
+    }
+    bool has_update = false;
+    err = xn_ota_check_update(&has_update, NULL);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (!has_update) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return xn_ota_upgrade(NULL);
+}
+
+/**
+ * @brief 在子进程中启动一次，返回子进程退出码（子进程掉电时为 0）
+ */
+static int run_boot(void)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        return -1;
+    }
+    if (pid == 0) {
+        esp_err_t err = boot_and_upgrade();
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Upgrade failed: %s", esp_err_to_name(err));
+        }
+        fflush(stdout);
+        _exit((err == ESP_OK) ? 0 : 1);
+    }
+    int status = 0;
+    if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) {
+        return -1;
+    }
+    return WEXITSTATUS(status);
+}
+
+int main(void)
+{
+    CHECK(ota_fake_setup(IMAGE_SIZE) == 0);
+    ota_fake_stats_t *stats = ota_fake_stats();
+
+    // 第一次启动：下载到 CUT_AFTER 时掉电
+    stats->cut_after = CUT_AFTER;
+    CHECK(run_boot() == 0);
+    CHECK(stats->range_count == 1);
+    CHECK(stats->range_starts[0] == 0);
+    CHECK(stats->boot_part == -1);
+    CHECK(ota_fake_storage_has("ota_resume"));
+
+    // 第二次启动：不再掉电，从断点续传
+    stats->cut_after = 0;
+    CHECK(run_boot() == 0);
+    CHECK(stats->range_count == 2);
+    CHECK(stats->range_starts[1] == EXPECT_RESUME);
+    CHECK(stats->dirty_writes == 0);
+    CHECK(memcmp(ota_fake_flash(), ota_fake_image(), IMAGE_SIZE) == 0);
+    CHECK(stats->boot_part == 1);
+    CHECK(!ota_fake_storage_has("ota_resume"));
+
+    ESP_LOGI(TAG, "Resume from %u bytes after power loss at %u: PASS",
+             (unsigned)stats->range_starts[1], (unsigned)CUT_AFTER);
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 16:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 16:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_perf_test\main\perf_event_bus.c
+ * @Description: 事件总线分发延迟测试 - 空闲与 WiFi 发送负载下
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include "perf_tests.h"
+#include "perf_report.h"
+#include <stdlib.h>
+#include <string.h>
+#include "xn_event_bus.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+
+#if CONFIG_XN_PERF_TEST_EVENT_BUS
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+#define PERF_EVT_LATENCY        (XN_EVT_CAT_USER + 0x0E00)  ///< 延迟测试事件ID（负载为投递时间戳）
+#define PERF_EVT_TIMEOUT_MS     5000    ///< 等待全部样本的额外超时
+
+typedef struct {
+    SemaphoreHandle_t done;             ///< 样本收满后释放
+    uint32_t *samples;                  ///< 延迟样本(us)
+    uint32_t target;                    ///< 期望样本数
+    volatile uint32_t count;            ///< 已收样本数
+} perf_evt_ctx_t;
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 订阅者：投递时间戳到执行回调的耗时（含入队、排队等待与分发）
+ */
+static void latency_handler(const xn_event_t *event, void *user_data)
+{
+    perf_evt_ctx_t *ctx = (perf_evt_ctx_t *)user_data;
+    int64_t now = esp_timer_get_time();
+    int64_t t0;
+
+    if (event->data == NULL || event->data_len != sizeof(t0) || ctx->count >= ctx->target) {
+        return;
+    }
+    memcpy(&t0, event->data, sizeof(t0));
+    ctx->samples[ctx->count++] = (uint32_t)(now - t0);
+    if (ctx->count == ctx->target) {
+        xSemaphoreGive(ctx->done);
+    }
+}
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+esp_err_t perf_event_bus_run(bool wifi_load)
+{
+    perf_evt_ctx_t ctx = {
+        .done = xSemaphoreCreateBinary(),
+        .samples = malloc(CONFIG_XN_PERF_EVENT_SAMPLES * sizeof(uint32_t)),
+        .target = CONFIG_XN_PERF_EVENT_SAMPLES,
+    };
+    uint32_t load_bytes = 0;
+    xn_event_bus_stats_t before;
+    xn_event_bus_stats_t after;
+
+    perf_report_begin("event_bus_latency");
+    perf_report_str("load", wifi_load ? "mqtt" : "none");
+
+    esp_err_t ret = (ctx.done && ctx.samples) ? ESP_OK : ESP_ERR_NO_MEM;
+    if (ret == ESP_OK) {
+        ret = xn_event_subscribe(PERF_EVT_LATENCY, latency_handler, &ctx);
+    }
+    if (ret == ESP_OK && wifi_load) {
+        ret = perf_mqtt_load(true, NULL);
+        // 等 outbox 填满、WiFi 进入持续发送
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+
+    int64_t start = esp_timer_get_time();
+    if (ret == ESP_OK) {
+        xn_event_bus_get_stats(&before);
+        // 每 tick 投递一次：测的是单个事件的延迟，不让事件在队列里互相排队
+        for (uint32_t i = 0; i < ctx.target; i++) {
+            int64_t t0 = esp_timer_get_time();
+            xn_event_post_data(PERF_EVT_LATENCY, XN_EVT_SRC_SYSTEM, &t0, sizeof(t0));
+            vTaskDelay(1);
+        }
+        if (xSemaphoreTake(ctx.done, pdMS_TO_TICKS(PERF_EVT_TIMEOUT_MS)) != pdTRUE) {
+            ret = ESP_ERR_TIMEOUT;
+        }
+        xn_event_bus_get_stats(&after);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    if (wifi_load) {
+        perf_mqtt_load(false, &load_bytes);
+    }
+    xn_event_unsubscribe_all(latency_handler);
+
+    perf_report_u32("samples", ctx.count);
+    if (ret == ESP_OK) {
+        perf_report_u32("dropped", after.dropped - before.dropped);
+        perf_report_samples("latency_us", ctx.samples, ctx.count);
+        if (wifi_load) {
+            perf_report_u32("load_kib_s", (uint32_t)((uint64_t)load_bytes * 1000000 / 1024 / (elapsed ? elapsed : 1)));
+        }
+    }
+    perf_report_end(ret);
+
+    if (ctx.done) {
+        vSemaphoreDelete(ctx.done);
+    }
+    free(ctx.samples);
+    return ret;
+}
+
+#else
+
+esp_err_t perf_event_bus_run(bool wifi_load)
+{
+    (void)wifi_load;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif /* CONFIG_XN_PERF_TEST_EVENT_BUS */
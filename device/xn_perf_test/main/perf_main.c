@@ -0,0 +1,146 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 16:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 16:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_perf_test\main\perf_main.c
+ * @Description: 板上性能测试固件入口 - 依次执行各项测试，结果逐行输出 "PERF {json}"
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include <string.h>
+#include "perf_tests.h"
+#include "perf_report.h"
+#include "xn_event_bus.h"
+#include "xn_wifi.h"
+#include "nvs_flash.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_flash.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "perf_main";
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+#define PERF_WIFI_TIMEOUT_MS    15000   ///< 等待获取 IP 的超时
+
+static uint32_t s_passed;               ///< 通过的测试数
+static uint32_t s_failed;               ///< 失败的测试数
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 记录测试结果（ESP_ERR_NOT_SUPPORTED 表示未开启，不计数）
+ */
+static void perf_count(const char *name, esp_err_t ret)
+{
+    if (ret == ESP_ERR_NOT_SUPPORTED) {
+        return;
+    }
+    if (ret == ESP_OK) {
+        s_passed++;
+    } else {
+        s_failed++;
+        ESP_LOGE(TAG, "%s failed: %s", name, esp_err_to_name(ret));
+    }
+}
+
+/**
+ * @brief 输出环境信息行，便于区分结果来自哪块板子、哪个固件
+ */
+static void perf_report_env(void)
+{
+    uint32_t flash_size = 0;
+    esp_flash_get_size(NULL, &flash_size);
+
+    perf_report_begin("env");
+    perf_report_u32("flash_size", flash_size);
+    perf_report_u32("heap_internal_free", heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+    perf_report_u32("heap_spiram_free", heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    perf_report_u32("tick_hz", configTICK_RATE_HZ);
+    perf_report_end(ESP_OK);
+}
+
+/**
+ * @brief 连接测试用 WiFi，等待获取 IP
+ */
+static esp_err_t perf_wifi_connect(void)
+{
+    xn_wifi_t *wifi = xn_wifi_create();
+    if (wifi == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t ret = xn_wifi_init(wifi);
+    if (ret == ESP_OK) {
+        ret = xn_wifi_connect(wifi, CONFIG_XN_PERF_WIFI_SSID, CONFIG_XN_PERF_WIFI_PASSWORD);
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    int64_t deadline = esp_timer_get_time() + PERF_WIFI_TIMEOUT_MS * 1000LL;
+    while (xn_wifi_get_status(wifi) != XN_WIFI_GOT_IP) {
+        if (esp_timer_get_time() > deadline) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    return ESP_OK;
+}
+
+/*===========================================================================
+ *                          入口
+ *===========================================================================*/
+
+void app_main(void)
+{
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(ret);
+    ESP_ERROR_CHECK(xn_event_bus_init());
+
+    perf_report_env();
+
+    // 不依赖网络的测试先跑，WiFi 射频空闲时的数据作为基线
+    perf_count("nvs", perf_nvs_run());
+    perf_count("ota", perf_ota_run());
+    perf_count("spi", perf_spi_run());
+    perf_count("event_bus", perf_event_bus_run(false));
+
+    if (strlen(CONFIG_XN_PERF_WIFI_SSID) > 0) {
+        ret = perf_wifi_connect();
+        if (ret == ESP_OK) {
+            ret = perf_mqtt_connect();
+        }
+        if (ret == ESP_OK) {
+            perf_count("mqtt", perf_mqtt_run());
+#if CONFIG_XN_PERF_TEST_EVENT_BUS
+            perf_count("event_bus_load", perf_event_bus_run(true));
+#endif
+        } else {
+            perf_report_begin("network");
+            perf_report_end(ret);
+            perf_count("network", ret);
+        }
+    } else {
+        ESP_LOGW(TAG, "CONFIG_XN_PERF_WIFI_SSID empty, network tests skipped");
+    }
+
+    perf_report_begin("done");
+    perf_report_u32("passed", s_passed);
+    perf_report_u32("failed", s_failed);
+    perf_report_end(s_failed == 0 ? ESP_OK : ESP_FAIL);
+}
@@ -0,0 +1,231 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 16:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 16:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_perf_test\main\perf_mqtt.c
+ * @Description: MQTT 往返延迟测试与 WiFi 发送负载
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include "perf_tests.h"
+#include "perf_report.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mqtt_module.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "perf_mqtt";
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+#define PERF_MQTT_CONNECT_TIMEOUT_MS    10000   ///< 等待连接的超时
+#define PERF_MQTT_ECHO_TIMEOUT_MS       1000    ///< 单次往返超时，超时计为丢失
+#define PERF_MQTT_INTERVAL_MS           20      ///< 两次往返之间的间隔
+#define PERF_MQTT_PAYLOAD_SIZE          32      ///< 往返负载长度
+#define PERF_MQTT_LOAD_SIZE             1024    ///< 负载消息长度
+#define PERF_MQTT_LOAD_OUTBOX_MAX       (8 * 1024)  ///< 负载 outbox 上限，超过后让出 CPU
+#define PERF_MQTT_LOAD_PRIORITY         3       ///< 负载任务优先级（低于事件总线分发任务）
+#define PERF_MQTT_LOAD_STACK            3072    ///< 负载任务栈
+
+typedef struct {
+    bool connected;                     ///< 是否已连接并订阅
+    SemaphoreHandle_t connect_sem;      ///< 连接成功信号
+    SemaphoreHandle_t echo_sem;         ///< 收到期望序号的回环消息
+    volatile uint32_t expect_seq;       ///< 期望收到的序号
+    char echo_topic[48];                ///< 回环 Topic（按 MAC 区分，多板同测不串扰）
+    char load_topic[48];                ///< 负载 Topic（不订阅）
+    TaskHandle_t load_task;             ///< 负载任务句柄，任务退出时置 NULL
+    volatile bool load_run;             ///< 负载任务运行标志
+    volatile uint32_t load_bytes;       ///< 负载期间提交的字节数
+} perf_mqtt_ctx_t;
+
+static perf_mqtt_ctx_t s_ctx = {0};
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+static void mqtt_event_cb(mqtt_module_event_t event)
+{
+    if (event == MQTT_MODULE_EVENT_CONNECTED) {
+        xSemaphoreGive(s_ctx.connect_sem);
+    }
+}
+
+/**
+ * @brief 收到回环消息：序号与当前期望一致才算一次往返，超时后迟到的消息忽略
+ */
+static void mqtt_message_cb(const char *topic, int topic_len, const uint8_t *payload, int payload_len)
+{
+    if (topic_len != (int)strlen(s_ctx.echo_topic) || memcmp(topic, s_ctx.echo_topic, topic_len) != 0) {
+        return;
+    }
+    if (payload_len < (int)sizeof(uint32_t)) {
+        return;
+    }
+    uint32_t seq;
+    memcpy(&seq, payload, sizeof(seq));
+    if (seq == s_ctx.expect_seq) {
+        xSemaphoreGive(s_ctx.echo_sem);
+    }
+}
+
+/**
+ * @brief 负载任务：outbox 未满时连续放入 1KB 消息，满了让出一个 tick
+ */
+static void load_task(void *arg)
+{
+    static uint8_t s_payload[PERF_MQTT_LOAD_SIZE];
+
+    while (s_ctx.load_run) {
+        while (s_ctx.load_run && mqtt_module_get_outbox_size() < PERF_MQTT_LOAD_OUTBOX_MAX) {
+            if (mqtt_module_enqueue(s_ctx.load_topic, s_payload, sizeof(s_payload), 0) != ESP_OK) {
+                break;
+            }
+            s_ctx.load_bytes += sizeof(s_payload);
+        }
+        vTaskDelay(1);
+    }
+    s_ctx.load_task = NULL;
+    vTaskDelete(NULL);
+}
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+esp_err_t perf_mqtt_connect(void)
+{
+    if (s_ctx.connected) {
+        return ESP_OK;
+    }
+
+    s_ctx.connect_sem = xSemaphoreCreateBinary();
+    s_ctx.echo_sem = xSemaphoreCreateBinary();
+    if (s_ctx.connect_sem == NULL || s_ctx.echo_sem == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint8_t mac[6];
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    snprintf(s_ctx.echo_topic, sizeof(s_ctx.echo_topic), "xn_perf/%02x%02x%02x%02x%02x%02x/echo",
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    snprintf(s_ctx.load_topic, sizeof(s_ctx.load_topic), "xn_perf/%02x%02x%02x%02x%02x%02x/load",
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+
+    mqtt_module_config_t config = {
+        .broker_uri = CONFIG_XN_PERF_MQTT_BROKER_URI,
+        .event_cb = mqtt_event_cb,
+        .message_cb = mqtt_message_cb,
+    };
+    esp_err_t ret = mqtt_module_init(&config);
+    if (ret == ESP_OK) {
+        ret = mqtt_module_start();
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (xSemaphoreTake(s_ctx.connect_sem, pdMS_TO_TICKS(PERF_MQTT_CONNECT_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGE(TAG, "Broker %s not reachable", CONFIG_XN_PERF_MQTT_BROKER_URI);
+        return ESP_ERR_TIMEOUT;
+    }
+    ret = mqtt_module_subscribe(s_ctx.echo_topic, 0);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    // 订阅应答不经过模块回调，留出时间让服务器生效
+    vTaskDelay(pdMS_TO_TICKS(500));
+    s_ctx.connected = true;
+    return ESP_OK;
+}
+
+#if CONFIG_XN_PERF_TEST_MQTT
+
+esp_err_t perf_mqtt_run(void)
+{
+    const int n = CONFIG_XN_PERF_MQTT_SAMPLES;
+    uint8_t payload[PERF_MQTT_PAYLOAD_SIZE] = {0};
+    uint32_t lost = 0;
+    size_t count = 0;
+
+    perf_report_begin("mqtt_rtt");
+    perf_report_str("broker", CONFIG_XN_PERF_MQTT_BROKER_URI);
+    perf_report_u32("payload", sizeof(payload));
+
+    uint32_t *rtt_us = malloc(n * sizeof(uint32_t));
+    esp_err_t ret = rtt_us ? perf_mqtt_connect() : ESP_ERR_NO_MEM;
+
+    for (int i = 0; i < n && ret == ESP_OK; i++) {
+        uint32_t seq = (uint32_t)i + 1;
+        memcpy(payload, &seq, sizeof(seq));
+        s_ctx.expect_seq = seq;
+        xSemaphoreTake(s_ctx.echo_sem, 0);
+
+        int64_t t0 = esp_timer_get_time();
+        ret = mqtt_module_publish(s_ctx.echo_topic, payload, sizeof(payload), 0, false);
+        if (ret == ESP_OK) {
+            if (xSemaphoreTake(s_ctx.echo_sem, pdMS_TO_TICKS(PERF_MQTT_ECHO_TIMEOUT_MS)) == pdTRUE) {
+                rtt_us[count++] = (uint32_t)(esp_timer_get_time() - t0);
+            } else {
+                lost++;
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(PERF_MQTT_INTERVAL_MS));
+    }
+    s_ctx.expect_seq = 0;
+
+    if (ret == ESP_OK) {
+        perf_report_u32("sent", (uint32_t)n);
+        perf_report_u32("lost", lost);
+        perf_report_samples("rtt_us", rtt_us, count);
+    }
+    perf_report_end(ret);
+    free(rtt_us);
+    return ret;
+}
+
+#else
+
+esp_err_t perf_mqtt_run(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif /* CONFIG_XN_PERF_TEST_MQTT */
+
+esp_err_t perf_mqtt_load(bool start, uint32_t *sent_bytes)
+{
+    if (!start) {
+        s_ctx.load_run = false;
+        while (s_ctx.load_task != NULL) {
+            vTaskDelay(1);
+        }
+        if (sent_bytes) {
+            *sent_bytes = s_ctx.load_bytes;
+        }
+        return ESP_OK;
+    }
+
+    if (!s_ctx.connected || s_ctx.load_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_ctx.load_bytes = 0;
+    s_ctx.load_run = true;
+    if (xTaskCreate(load_task, "perf_load", PERF_MQTT_LOAD_STACK, NULL,
+                    PERF_MQTT_LOAD_PRIORITY, &s_ctx.load_task) != pdPASS) {
+        s_ctx.load_run = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,115 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 16:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 16:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_perf_test\main\perf_nvs.c
+ * @Description: NVS 读写延迟测试
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include "perf_tests.h"
+#include "perf_report.h"
+#include <stdlib.h>
+#include <string.h>
+#include "nvs.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#if CONFIG_XN_PERF_TEST_NVS
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+#define PERF_NVS_NAMESPACE      "xn_perf"   ///< 测试专用命名空间，测完清空
+#define PERF_NVS_BLOB_SIZE      256         ///< blob 大小（与配置类数据相当）
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 测量一组 set+commit / get，输出一行
+ *
+ * @param test 测试名
+ * @param blob false 测 u32，true 测 PERF_NVS_BLOB_SIZE 字节 blob
+ */
+static esp_err_t nvs_case(nvs_handle_t nvs, const char *test, bool blob,
+                          uint32_t *write_us, uint32_t *read_us)
+{
+    static uint8_t s_blob[PERF_NVS_BLOB_SIZE];
+    const int n = CONFIG_XN_PERF_NVS_ITERATIONS;
+    esp_err_t ret = ESP_OK;
+
+    for (int i = 0; i < n && ret == ESP_OK; i++) {
+        // 每次写入不同的值，避免 NVS 判定内容相同而跳过写入
+        memset(s_blob, i, sizeof(s_blob));
+        int64_t t0 = esp_timer_get_time();
+        ret = blob ? nvs_set_blob(nvs, "blob", s_blob, sizeof(s_blob)) : nvs_set_u32(nvs, "u32", (uint32_t)i);
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs);
+        }
+        write_us[i] = (uint32_t)(esp_timer_get_time() - t0);
+    }
+    for (int i = 0; i < n && ret == ESP_OK; i++) {
+        uint32_t value;
+        size_t len = sizeof(s_blob);
+        int64_t t0 = esp_timer_get_time();
+        ret = blob ? nvs_get_blob(nvs, "blob", s_blob, &len) : nvs_get_u32(nvs, "u32", &value);
+        read_us[i] = (uint32_t)(esp_timer_get_time() - t0);
+    }
+
+    perf_report_begin(test);
+    perf_report_u32("iterations", (uint32_t)n);
+    if (ret == ESP_OK) {
+        perf_report_samples("write_us", write_us, (size_t)n);
+        perf_report_samples("read_us", read_us, (size_t)n);
+    }
+    perf_report_end(ret);
+    return ret;
+}
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+esp_err_t perf_nvs_run(void)
+{
+    const size_t n = CONFIG_XN_PERF_NVS_ITERATIONS;
+    uint32_t *write_us = malloc(n * sizeof(uint32_t));
+    uint32_t *read_us = malloc(n * sizeof(uint32_t));
+    nvs_handle_t nvs;
+    esp_err_t ret = (write_us && read_us) ? ESP_OK : ESP_ERR_NO_MEM;
+
+    if (ret == ESP_OK) {
+        ret = nvs_open(PERF_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    }
+    if (ret == ESP_OK) {
+        esp_err_t r = nvs_case(nvs, "nvs_u32", false, write_us, read_us);
+        ret = nvs_case(nvs, "nvs_blob256", true, write_us, read_us);
+        if (ret == ESP_OK) {
+            ret = r;
+        }
+        nvs_erase_all(nvs);
+        nvs_commit(nvs);
+        nvs_close(nvs);
+    } else {
+        perf_report_begin("nvs_u32");
+        perf_report_end(ret);
+    }
+
+    free(write_us);
+    free(read_us);
+    return ret;
+}
+
+#else
+
+esp_err_t perf_nvs_run(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif /* CONFIG_XN_PERF_TEST_NVS */
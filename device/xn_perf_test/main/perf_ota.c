@@ -0,0 +1,100 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 16:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 16:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_perf_test\main\perf_ota.c
+ * @Description: OTA 分区擦除/写入吞吐测试
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include "perf_tests.h"
+#include "perf_report.h"
+#include <stdlib.h>
+#include "esp_ota_ops.h"
+#include "esp_app_format.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "sdkconfig.h"
+
+#if CONFIG_XN_PERF_TEST_OTA
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+#define PERF_OTA_CHUNK_SIZE     4096    ///< 每次写入长度（与 HTTP 下载缓冲相当，正好一个扇区）
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+esp_err_t perf_ota_run(void)
+{
+    const uint32_t total = CONFIG_XN_PERF_OTA_WRITE_KB * 1024;
+    const esp_partition_t *part = esp_ota_get_next_update_partition(NULL);
+    esp_ota_handle_t handle = 0;
+    uint32_t erase_us = 0;
+    uint32_t write_us = 0;
+    uint32_t chunk_max_us = 0;
+
+    perf_report_begin("ota_write");
+    if (part == NULL) {
+        perf_report_end(ESP_ERR_NOT_FOUND);
+        return ESP_ERR_NOT_FOUND;
+    }
+    perf_report_str("partition", part->label);
+    perf_report_u32("bytes", total);
+
+    // 写入缓冲放内部 RAM，与 OTA 组件下载时一致；内容随意，测完 abort 不会被校验
+    uint8_t *chunk = heap_caps_malloc(PERF_OTA_CHUNK_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (chunk == NULL) {
+        perf_report_end(ESP_ERR_NO_MEM);
+        return ESP_ERR_NO_MEM;
+    }
+    for (int i = 0; i < PERF_OTA_CHUNK_SIZE; i++) {
+        chunk[i] = (uint8_t)i;
+    }
+    // 首字节不是镜像魔数时 esp_ota_write 会拒绝写入
+    chunk[0] = ESP_IMAGE_HEADER_MAGIC;
+
+    // 指定大小时 esp_ota_begin 先擦除对应区域，擦除与写入分开计时
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t ret = esp_ota_begin(part, total, &handle);
+    erase_us = (uint32_t)(esp_timer_get_time() - t0);
+
+    if (ret == ESP_OK) {
+        t0 = esp_timer_get_time();
+        for (uint32_t off = 0; off < total && ret == ESP_OK; off += PERF_OTA_CHUNK_SIZE) {
+            int64_t c0 = esp_timer_get_time();
+            ret = esp_ota_write(handle, chunk, PERF_OTA_CHUNK_SIZE);
+            uint32_t us = (uint32_t)(esp_timer_get_time() - c0);
+            if (us > chunk_max_us) {
+                chunk_max_us = us;
+            }
+        }
+        write_us = (uint32_t)(esp_timer_get_time() - t0);
+        esp_ota_abort(handle);
+    }
+
+    if (ret == ESP_OK) {
+        perf_report_u32("erase_ms", erase_us / 1000);
+        perf_report_u32("erase_kib_s", (uint32_t)((uint64_t)total * 1000000 / 1024 / (erase_us ? erase_us : 1)));
+        perf_report_u32("write_ms", write_us / 1000);
+        perf_report_u32("write_kib_s", (uint32_t)((uint64_t)total * 1000000 / 1024 / (write_us ? write_us : 1)));
+        perf_report_u32("chunk_max_us", chunk_max_us);
+    }
+    perf_report_end(ret);
+    free(chunk);
+    return ret;
+}
+
+#else
+
+esp_err_t perf_ota_run(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif /* CONFIG_XN_PERF_TEST_OTA */
@@ -0,0 +1,119 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 16:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 16:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_perf_test\main\perf_report.c
+ * @Description: 性能测试结果输出 - 每项测试一行 "PERF {json}"
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include "perf_report.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include "esp_system.h"
+#include "esp_chip_info.h"
+#include "sdkconfig.h"
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+#define PERF_LINE_MAX   768             ///< 单行结果最大长度
+
+static char s_line[PERF_LINE_MAX];      ///< 当前行（测试串行执行，单缓冲即可）
+static size_t s_len;                    ///< 当前行长度
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 向当前行追加格式化文本，超长时截断（保留结尾 "}" 的位置）
+ */
+static void line_append(const char *fmt, ...)
+{
+    const size_t cap = sizeof(s_line) - 1;
+    if (s_len >= cap) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(s_line + s_len, cap - s_len, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        s_len += (size_t)n;
+        if (s_len >= cap) {
+            s_len = cap - 1;
+        }
+    }
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+void perf_report_begin(const char *test)
+{
+    esp_chip_info_t chip;
+    esp_chip_info(&chip);
+
+    s_len = 0;
+    line_append("PERF {\"board\":\"%s\",\"idf\":\"%s\",\"chip_rev\":%u,\"cpu_mhz\":%u,\"test\":\"%s\"",
+                CONFIG_XN_PERF_BOARD_REV, esp_get_idf_version(), (unsigned)chip.revision,
+                (unsigned)CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, test);
+}
+
+void perf_report_str(const char *key, const char *value)
+{
+    line_append(",\"%s\":\"%s\"", key, value);
+}
+
+void perf_report_u32(const char *key, uint32_t value)
+{
+    line_append(",\"%s\":%u", key, (unsigned)value);
+}
+
+void perf_report_float(const char *key, float value)
+{
+    line_append(",\"%s\":%.2f", key, (double)value);
+}
+
+void perf_report_samples(const char *prefix, uint32_t *samples, size_t count)
+{
+    if (count == 0) {
+        return;
+    }
+    qsort(samples, count, sizeof(uint32_t), cmp_u32);
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += samples[i];
+    }
+    line_append(",\"%s_avg\":%u,\"%s_p50\":%u,\"%s_p99\":%u,\"%s_max\":%u",
+                prefix, (unsigned)(total / count),
+                prefix, (unsigned)samples[count / 2],
+                prefix, (unsigned)samples[(count * 99) / 100],
+                prefix, (unsigned)samples[count - 1]);
+}
+
+void perf_report_end(esp_err_t result)
+{
+    if (result != ESP_OK) {
+        line_append(",\"error\":\"%s\"", esp_err_to_name(result));
+    }
+    s_line[s_len++] = '}';
+    s_line[s_len] = '\0';
+    // 直接写 stdout，不经过日志前缀，主机脚本按 "PERF " 过滤即可
+    printf("%s\n", s_line);
+    fflush(stdout);
+}
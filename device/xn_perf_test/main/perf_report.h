@@ -0,0 +1,63 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 16:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 16:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_perf_test\main\perf_report.h
+ * @Description: 性能测试结果输出 - 每项测试一行 "PERF {json}"
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef PERF_REPORT_H
+#define PERF_REPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 开始一行结果
+ *
+ * 自动写入 board、idf、chip_rev、cpu_mhz 与 test 字段，每行独立可解析。
+ *
+ * @param test 测试名
+ */
+void perf_report_begin(const char *test);
+
+/**
+ * @brief 写入字符串指标
+ */
+void perf_report_str(const char *key, const char *value);
+
+/**
+ * @brief 写入整数指标
+ */
+void perf_report_u32(const char *key, uint32_t value);
+
+/**
+ * @brief 写入浮点指标（保留两位小数）
+ */
+void perf_report_float(const char *key, float value);
+
+/**
+ * @brief 写入一组样本的统计：<prefix>_avg/_p50/_p99/_max（样本原地排序）
+ */
+void perf_report_samples(const char *prefix, uint32_t *samples, size_t count);
+
+/**
+ * @brief 结束并输出一行结果
+ *
+ * @param result 测试结果，非 ESP_OK 时写入 error 字段
+ */
+void perf_report_end(esp_err_t result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERF_REPORT_H
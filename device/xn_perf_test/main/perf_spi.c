@@ -0,0 +1,164 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 16:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 16:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_perf_test\main\perf_spi.c
+ * @Description: 显示 SPI 刷新吞吐测试 - 不同 spi_clk_hz 下整屏重绘
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include "perf_tests.h"
+#include "perf_report.h"
+#include <stdlib.h>
+#include "xn_display.h"
+#include "lvgl.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#if CONFIG_XN_PERF_TEST_SPI
+
+static const char *TAG = "perf_spi";
+
+/*===========================================================================
+ *                          内部数据结构
+ *===========================================================================*/
+
+#define PERF_SPI_FRAME_TIMEOUT_MS   1000    ///< 单帧最长等待时间
+
+/*===========================================================================
+ *                          内部函数
+ *===========================================================================*/
+
+/**
+ * @brief 等待 LVGL 任务完成第 n 帧（渲染统计计数达到 n）
+ */
+static bool wait_frames(uint32_t n)
+{
+    xn_display_stats_t stats;
+    int64_t deadline = esp_timer_get_time() + PERF_SPI_FRAME_TIMEOUT_MS * 1000;
+
+    while (esp_timer_get_time() < deadline) {
+        if (xn_display_stats_get(&stats) == ESP_OK && stats.render.count >= n) {
+            return true;
+        }
+        vTaskDelay(1);
+    }
+    return false;
+}
+
+/**
+ * @brief 切换屏幕背景色，使下一帧整屏重绘
+ */
+static void invalidate_screen(uint32_t frame)
+{
+    if (xn_display_lock(PERF_SPI_FRAME_TIMEOUT_MS)) {
+        lv_obj_t *screen = lv_screen_active();
+        lv_obj_set_style_bg_opa(screen, LV_OPA_COVER, 0);
+        lv_obj_set_style_bg_color(screen, (frame & 1) ? lv_color_white() : lv_color_black(), 0);
+        xn_display_unlock();
+    }
+}
+
+/**
+ * @brief 在一个 SPI 时钟下测量并输出一行
+ *
+ * 帧耗时与刷新耗时取自显示组件统计：流程与主固件完全一致（分块渲染、双缓冲、DMA）。
+ * 等待帧完成用轮询，帧间隔受 tick 影响，因此不直接报帧率，而是报 fps_max = 1s / 平均帧耗时。
+ */
+static esp_err_t spi_case(uint32_t clk_mhz)
+{
+    xn_display_config_t config = xn_display_get_default_config();
+    config.spi_clk_hz = clk_mhz * 1000 * 1000;
+    const uint32_t frames = CONFIG_XN_PERF_SPI_FRAMES;
+
+    perf_report_begin("spi_flush");
+    perf_report_u32("spi_clk_hz", config.spi_clk_hz);
+    perf_report_u32("width", config.width);
+    perf_report_u32("height", config.height);
+
+    esp_err_t ret = xn_display_init(&config);
+    if (ret == ESP_OK) {
+        // 初始化后的首帧与背景设置帧不计入，等它们刷完再清零统计
+        invalidate_screen(0);
+        wait_frames(1);
+        vTaskDelay(pdMS_TO_TICKS(100));
+        xn_display_stats_reset();
+
+        for (uint32_t i = 0; i < frames && ret == ESP_OK; i++) {
+            invalidate_screen(i + 1);
+            if (!wait_frames(i + 1)) {
+                ret = ESP_ERR_TIMEOUT;
+            }
+        }
+
+        xn_display_stats_t stats;
+        if (ret == ESP_OK) {
+            ret = xn_display_stats_get(&stats);
+        }
+        if (ret == ESP_OK) {
+            uint32_t flush_us = (uint32_t)(stats.flush.total_us ? stats.flush.total_us : 1);
+            uint32_t render_avg_us = (uint32_t)(stats.render.total_us / (stats.render.count ? stats.render.count : 1));
+            uint32_t kib_s = (uint32_t)(stats.flush_bytes * 1000000 / 1024 / flush_us);
+            uint32_t line_kib_s = config.spi_clk_hz / 8 / 1024;
+
+            perf_report_u32("frames", stats.render.count);
+            perf_report_u32("render_avg_us", render_avg_us);
+            perf_report_u32("render_max_us", stats.render.max_us);
+            perf_report_u32("flush_count", stats.flush.count);
+            perf_report_u32("flush_avg_us", (uint32_t)(stats.flush.total_us / (stats.flush.count ? stats.flush.count : 1)));
+            perf_report_u32("flush_max_us", stats.flush.max_us);
+            perf_report_u32("flush_kib_s", kib_s);
+            perf_report_u32("line_kib_s", line_kib_s);
+            perf_report_float("efficiency_pct", line_kib_s ? 100.0f * kib_s / line_kib_s : 0.0f);
+            perf_report_float("fps_max", render_avg_us ? 1000000.0f / render_avg_us : 0.0f);
+        }
+        xn_display_deinit();
+    }
+    perf_report_end(ret);
+    return ret;
+}
+
+/*===========================================================================
+ *                          API 实现
+ *===========================================================================*/
+
+esp_err_t perf_spi_run(void)
+{
+    const char *p = CONFIG_XN_PERF_SPI_CLOCKS_MHZ;
+    esp_err_t result = ESP_OK;
+
+    while (*p != '\0') {
+        char *end;
+        unsigned long mhz = strtoul(p, &end, 10);
+        if (end == p) {
+            // 跳过分隔符
+            p++;
+            continue;
+        }
+        p = end;
+        if (mhz == 0 || mhz > 80) {
+            ESP_LOGW(TAG, "Skip invalid SPI clock: %lu MHz", mhz);
+            continue;
+        }
+        // 某个时钟失败不影响其他时钟，返回第一个错误
+        esp_err_t ret = spi_case((uint32_t)mhz);
+        if (ret != ESP_OK && result == ESP_OK) {
+            result = ret;
+        }
+    }
+    return result;
+}
+
+#else
+
+esp_err_t perf_spi_run(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif /* CONFIG_XN_PERF_TEST_SPI */
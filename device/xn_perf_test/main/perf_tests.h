@@ -0,0 +1,66 @@
+/*
+ * @Author: xingnian jixingnian@gmail.com
+ * @Date: 2026-01-27 16:00:00
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2026-01-27 16:00:00
+ * @FilePath: \xn_smart_dialogue_platform\device\xn_perf_test\main\perf_tests.h
+ * @Description: 各项性能测试入口，每个函数输出一行或多行 PERF 结果
+ * VX:Jxingnian
+ * Copyright (c) 2026 by ${git_name_email}, All Rights Reserved.
+ */
+
+#ifndef PERF_TESTS_H
+#define PERF_TESTS_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief NVS 读写延迟：u32/256 字节 blob 的 set+commit 与 get
+ */
+esp_err_t perf_nvs_run(void);
+
+/**
+ * @brief OTA 吞吐：非运行槽的擦除耗时与顺序写入吞吐，结束时 esp_ota_abort
+ */
+esp_err_t perf_ota_run(void);
+
+/**
+ * @brief 显示 SPI 刷新吞吐：按 CONFIG_XN_PERF_SPI_CLOCKS_MHZ 逐个时钟测量，每个时钟一行
+ */
+esp_err_t perf_spi_run(void);
+
+/**
+ * @brief 事件总线分发延迟：投递时间戳到订阅者收到的耗时
+ *
+ * @param wifi_load true 时测量期间并行持续发送 MQTT 负载（需已连接）
+ */
+esp_err_t perf_event_bus_run(bool wifi_load);
+
+/**
+ * @brief 连接本地 MQTT 服务器（perf_mqtt_run 与 WiFi 负载共用）
+ */
+esp_err_t perf_mqtt_connect(void);
+
+/**
+ * @brief MQTT 往返延迟：发布到自己订阅的 Topic，测量发布到收到的耗时
+ */
+esp_err_t perf_mqtt_run(void);
+
+/**
+ * @brief 启动/停止 MQTT 发送负载任务（1KB QoS0 连续发送，按 outbox 背压）
+ *
+ * @param start true 启动，false 停止并返回
+ * @param sent_bytes 停止时返回负载期间提交的字节数，可为 NULL
+ */
+esp_err_t perf_mqtt_load(bool start, uint32_t *sent_bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERF_TESTS_H